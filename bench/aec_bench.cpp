@@ -0,0 +1,231 @@
+// EchoCancellationStage 基准：测量 AEC3 达到的 ERLE 以及每 10ms 帧的处理耗时
+// 用法：
+//   aec_bench                              使用合成的远端信号和回声路径
+//   aec_bench far.wav near.wav [out.wav]   使用录制的远端/近端文件（采样率需一致）
+
+#include "echo_cancellation_stage.h"
+#include "streaming_wav_writer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Track {
+    int sampleRate = 0;
+    size_t channels = 0;
+    std::vector<float> samples;  // 交织
+
+    size_t Frames() const { return channels ? samples.size() / channels : 0; }
+};
+
+uint32_t ReadU32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint16_t ReadU16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+// 只支持 16 位整数和 32 位浮点 PCM，足够读取本项目写出的文件
+bool LoadWav(const char* path, Track& track) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "无法打开 %s\n", path);
+        return false;
+    }
+    std::vector<uint8_t> bytes;
+    uint8_t chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        bytes.insert(bytes.end(), chunk, chunk + n);
+    }
+    fclose(file);
+
+    if (bytes.size() < 12 || (memcmp(bytes.data(), "RIFF", 4) != 0 && memcmp(bytes.data(), "RF64", 4) != 0) ||
+        memcmp(bytes.data() + 8, "WAVE", 4) != 0) {
+        fprintf(stderr, "%s 不是 WAV 文件\n", path);
+        return false;
+    }
+
+    uint16_t format = 0, bits = 0;
+    size_t pos = 12;
+    while (pos + 8 <= bytes.size()) {
+        const uint8_t* id = bytes.data() + pos;
+        size_t size = ReadU32(id + 4);
+        const uint8_t* body = id + 8;
+        if (memcmp(id, "fmt ", 4) == 0 && size >= 16) {
+            format = ReadU16(body);
+            track.channels = ReadU16(body + 2);
+            track.sampleRate = static_cast<int>(ReadU32(body + 4));
+            bits = ReadU16(body + 14);
+        } else if (memcmp(id, "data", 4) == 0) {
+            // 被截断或 RF64 的文件以实际长度为准
+            size = std::min(size == 0xFFFFFFFFu ? bytes.size() : size, bytes.size() - pos - 8);
+            if (format == 1 && bits == 16) {
+                track.samples.resize(size / 2);
+                for (size_t i = 0; i < track.samples.size(); ++i) {
+                    track.samples[i] = static_cast<int16_t>(ReadU16(body + i * 2)) / 32768.0f;
+                }
+            } else if (format == 3 && bits == 32) {
+                track.samples.resize(size / 4);
+                memcpy(track.samples.data(), body, track.samples.size() * sizeof(float));
+            } else {
+                fprintf(stderr, "%s 的采样格式不受支持 (format=%u, bits=%u)\n", path, format, bits);
+                return false;
+            }
+            return track.channels > 0;
+        }
+        pos += 8 + size + (size & 1);
+    }
+    fprintf(stderr, "%s 缺少 data 块\n", path);
+    return false;
+}
+
+// 合成类似语音的远端信号（带间歇的调制有色噪声），近端为经过稀疏房间冲激响应的回声
+void Synthesize(int sampleRate, double seconds, Track& far, Track& near) {
+    const size_t frames = static_cast<size_t>(sampleRate * seconds);
+    far.sampleRate = near.sampleRate = sampleRate;
+    far.channels = near.channels = 1;
+    far.samples.assign(frames, 0.0f);
+    near.samples.assign(frames, 0.0f);
+
+    std::mt19937 rng(1234);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    float lowpass = 0.0f;
+    for (size_t i = 0; i < frames; ++i) {
+        const double t = static_cast<double>(i) / sampleRate;
+        const double syllable = 0.5 + 0.5 * std::sin(2.0 * M_PI * 4.0 * t);
+        const bool talking = std::fmod(t, 3.0) < 2.2;
+        lowpass = 0.85f * lowpass + 0.15f * noise(rng);
+        far.samples[i] = talking ? static_cast<float>(0.3 * syllable) * lowpass : 0.0f;
+    }
+
+    // 40ms 直达延迟 + 60ms 内随机衰减的反射
+    std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+    std::vector<std::pair<size_t, float>> taps;
+    const size_t direct = static_cast<size_t>(sampleRate * 0.040);
+    taps.emplace_back(direct, 0.5f);
+    for (int k = 0; k < 30; ++k) {
+        const size_t offset = static_cast<size_t>((uniform(rng) * 0.5f + 0.5f) * sampleRate * 0.060);
+        const float decay = std::exp(-static_cast<float>(offset) / (sampleRate * 0.02f));
+        taps.emplace_back(direct + offset, 0.2f * decay * uniform(rng));
+    }
+    for (size_t i = 0; i < frames; ++i) {
+        float echo = 0.0f;
+        for (const auto& tap : taps) {
+            if (i >= tap.first) {
+                echo += tap.second * far.samples[i - tap.first];
+            }
+        }
+        near.samples[i] = echo + 0.0005f * noise(rng);
+    }
+}
+
+double Energy(const std::vector<float>& samples, size_t begin, size_t end) {
+    double sum = 0.0;
+    for (size_t i = begin; i < end; ++i) {
+        sum += static_cast<double>(samples[i]) * samples[i];
+    }
+    return sum;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Track far, near;
+    if (argc >= 3) {
+        if (!LoadWav(argv[1], far) || !LoadWav(argv[2], near)) {
+            return 1;
+        }
+        if (far.sampleRate != near.sampleRate) {
+            fprintf(stderr, "远端与近端采样率不一致: %d vs %d\n", far.sampleRate, near.sampleRate);
+            return 1;
+        }
+    } else {
+        Synthesize(48000, 20.0, far, near);
+    }
+
+    // 近端按声道拆开，原地处理
+    const size_t frames = std::min(far.Frames(), near.Frames());
+    std::vector<std::vector<float>> capture(near.channels, std::vector<float>(frames));
+    for (size_t i = 0; i < frames; ++i) {
+        for (size_t ch = 0; ch < near.channels; ++ch) {
+            capture[ch][i] = near.samples[i * near.channels + ch];
+        }
+    }
+    const std::vector<std::vector<float>> original = capture;
+
+    EchoCancellationStage stage;
+    EchoCancellationStage::Options options;
+    options.sampleRate = far.sampleRate;
+    options.renderChannels = far.channels;
+    options.captureChannels = near.channels;
+    if (!stage.Initialize(options)) {
+        return 1;
+    }
+
+    // 以 CoreAudio 常见的 512 帧块交替送入远端和近端
+    const size_t block = 512;
+    std::vector<float*> ptrs(near.channels);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t offset = 0; offset < frames; offset += block) {
+        const size_t count = std::min(block, frames - offset);
+        stage.AnalyzeRender(far.samples.data() + offset * far.channels, count);
+        for (size_t ch = 0; ch < near.channels; ++ch) {
+            ptrs[ch] = capture[ch].data() + offset;
+        }
+        stage.ProcessCapture(ptrs.data(), count);
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // 跳过前一半的收敛期，输出相对输入延迟 LatencyFrames() 帧
+    const size_t latency = stage.LatencyFrames();
+    const size_t begin = frames / 2;
+    double inEnergy = 0.0, outEnergy = 0.0;
+    for (size_t ch = 0; ch < near.channels; ++ch) {
+        inEnergy += Energy(original[ch], begin - latency, frames - latency);
+        outEnergy += Energy(capture[ch], begin, frames);
+    }
+    const double erle = 10.0 * std::log10((inEnergy + 1e-12) / (outEnergy + 1e-12));
+
+    const EchoCancellationStage::Stats stats = stage.GetStats();
+    const double audioSeconds = static_cast<double>(frames) / far.sampleRate;
+    printf("采样率 %d Hz, 远端 %zu 声道, 近端 %zu 声道, 时长 %.1f 秒\n",
+           far.sampleRate, far.channels, near.channels, audioSeconds);
+    printf("后半段实测 ERLE:      %6.1f dB\n", erle);
+    printf("AEC3 报告 ERLE:       %6.1f dB, ERL %.1f dB, 估计延迟 %d ms\n",
+           stats.echoReturnLossEnhancementDb, stats.echoReturnLossDb, stats.delayMs);
+    printf("每 10ms 帧处理耗时:   平均 %.1f us, 最大 %.1f us\n",
+           stats.averageProcessNanos / 1000.0, stats.maxProcessNanos / 1000.0);
+    printf("实时倍率:             %.1fx\n", audioSeconds / seconds);
+
+    if (argc >= 4) {
+        StreamingWavWriter writer;
+        StreamingWavWriter::Options writerOptions;
+        writerOptions.sampleRate = static_cast<uint32_t>(near.sampleRate);
+        writerOptions.channels = static_cast<uint16_t>(near.channels);
+        writerOptions.queueMilliseconds = static_cast<uint32_t>(audioSeconds * 1000) + 1000;
+        if (!writer.Open(argv[3], writerOptions)) {
+            return 1;
+        }
+        std::vector<float> interleaved(block * near.channels);
+        for (size_t offset = 0; offset < frames; offset += block) {
+            const size_t count = std::min(block, frames - offset);
+            for (size_t i = 0; i < count; ++i) {
+                for (size_t ch = 0; ch < near.channels; ++ch) {
+                    interleaved[i * near.channels + ch] = capture[ch][offset + i];
+                }
+            }
+            writer.Write(interleaved.data(), count);
+        }
+        writer.Close();
+    }
+    return 0;
+}
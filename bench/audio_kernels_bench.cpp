@@ -0,0 +1,146 @@
+// AudioKernels 基准：输出各内核吞吐量 (GB/s) 和电平统计相对单纯转换的额外开销
+// 各 SIMD 实现与标量参考的逐位一致性由 tests/audio_kernels_test.cpp 校验
+
+#include "audio_kernels.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+using AudioKernels::Isa;
+
+const Isa kAllIsas[] = {Isa::Scalar, Isa::SSE2, Isa::AVX2, Isa::NEON};
+
+// 随机样本里混入边界值：超出 [-1, 1]、正好落在 .5 LSB 上、±0、NaN、无穷
+std::vector<float> MakeInput(size_t samples, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-1.2f, 1.2f);
+    const float specials[] = {
+        0.0f, -0.0f, 1.0f, -1.0f, 1.5f, -1.5f, 0.5f / 32767.0f, -0.5f / 32767.0f,
+        1.5f / 32767.0f, 2.5f / 8388607.0f, std::numeric_limits<float>::quiet_NaN(),
+        std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity()
+    };
+    std::vector<float> data(samples);
+    for (size_t i = 0; i < samples; ++i) {
+        data[i] = (i % 7 == 3) ? specials[(i / 7) % (sizeof(specials) / sizeof(specials[0]))] : dist(rng);
+    }
+    return data;
+}
+
+// 运行 body 直到累计 0.2 秒，返回 GB/s（bytes 为每次调用读写的字节数）
+double MeasureGBps(size_t bytes, const std::function<void()>& body) {
+    using Clock = std::chrono::steady_clock;
+    body();
+    size_t iterations = 0;
+    const auto start = Clock::now();
+    double seconds = 0.0;
+    do {
+        for (int i = 0; i < 16; ++i) {
+            body();
+        }
+        iterations += 16;
+        seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (seconds < 0.2);
+    return static_cast<double>(bytes) * iterations / seconds / 1e9;
+}
+
+} // namespace
+
+int main() {
+    std::vector<Isa> available;
+    for (Isa isa : kAllIsas) {
+        if (AudioKernels::SetIsa(isa)) {
+            available.push_back(isa);
+        }
+    }
+    printf("检测到的最佳实现: %s\n", AudioKernels::IsaName(AudioKernels::DetectedIsa()));
+
+    // 1024 帧立体声，接近一次音频回调的数据量，数据常驻 L1/L2
+    const size_t frames = 1024;
+    const size_t samples = frames * 2;
+    std::vector<float> interleaved = MakeInput(samples, 7);
+    for (float& v : interleaved) {
+        if (std::isnan(v) || std::isinf(v)) {
+            v = 0.0f;
+        }
+    }
+    std::vector<float> left(frames), right(frames), mono(frames), floats(samples);
+    std::vector<int16_t> pcm16(samples);
+    std::vector<uint8_t> pcm24(samples * 3);
+    float* planes[2] = {left.data(), right.data()};
+    const float* constPlanes[2] = {left.data(), right.data()};
+    AudioKernels::DitherState dither;
+
+    struct Kernel {
+        const char* name;
+        size_t bytes;
+        std::function<void()> body;
+    };
+    const Kernel kernels[] = {
+        {"Interleave 2ch", samples * 8, [&] { AudioKernels::Interleave(constPlanes, interleaved.data(), 2, frames); }},
+        {"Deinterleave 2ch", samples * 8, [&] { AudioKernels::Deinterleave(interleaved.data(), planes, 2, frames); }},
+        {"FloatToInt16", samples * 6, [&] { AudioKernels::FloatToInt16(interleaved.data(), pcm16.data(), samples); }},
+        {"FloatToInt16+dither", samples * 6, [&] { AudioKernels::FloatToInt16(interleaved.data(), pcm16.data(), samples, &dither); }},
+        {"FloatToInt24", samples * 7, [&] { AudioKernels::FloatToInt24(interleaved.data(), pcm24.data(), samples); }},
+        {"Int16ToFloat", samples * 6, [&] { AudioKernels::Int16ToFloat(pcm16.data(), floats.data(), samples); }},
+        {"ApplyGain", samples * 8, [&] { AudioKernels::ApplyGain(interleaved.data(), floats.data(), samples, 0.5f); }},
+        {"StereoToMono", samples * 6, [&] { AudioKernels::StereoToMono(interleaved.data(), mono.data(), frames); }},
+        {"MonoToStereo", samples * 6, [&] { AudioKernels::MonoToStereo(mono.data(), floats.data(), frames); }},
+        {"MixAdd ramp", samples * 12, [&] { AudioKernels::MixAdd(interleaved.data(), floats.data(), samples, 0.5f, 1e-4f); }},
+    };
+
+    printf("\n吞吐量 (GB/s, 1024 帧立体声)\n%-22s", "kernel");
+    for (Isa isa : available) {
+        printf("%10s", AudioKernels::IsaName(isa));
+    }
+    printf("\n");
+    for (const Kernel& kernel : kernels) {
+        printf("%-22s", kernel.name);
+        for (Isa isa : available) {
+            AudioKernels::SetIsa(isa);
+            printf("%10.2f", MeasureGBps(kernel.bytes, kernel.body));
+        }
+        printf("\n");
+    }
+
+    // 电平统计的额外开销：同样的数据，融合内核比单纯转换多花的时间
+    const Kernel pairs[][2] = {
+        {{"Interleave 2ch", samples * 8, [&] { AudioKernels::Interleave(constPlanes, interleaved.data(), 2, frames); }},
+         {"", samples * 8, [&] {
+              AudioKernels::LevelStats levels;
+              AudioKernels::InterleaveWithLevels(constPlanes, interleaved.data(), 2, frames, &levels);
+          }}},
+        {{"Int16ToFloat", samples * 6, [&] { AudioKernels::Int16ToFloat(pcm16.data(), floats.data(), samples); }},
+         {"", samples * 6, [&] {
+              AudioKernels::LevelStats levels;
+              AudioKernels::Int16ToFloatWithLevels(pcm16.data(), floats.data(), samples, &levels);
+          }}},
+        {{"Copy", samples * 8, [&] { memcpy(floats.data(), interleaved.data(), samples * sizeof(float)); }},
+         {"", samples * 8, [&] {
+              AudioKernels::LevelStats levels;
+              AudioKernels::CopyWithLevels(interleaved.data(), floats.data(), samples, &levels);
+          }}},
+    };
+    printf("\n电平统计开销 (单纯转换 / 带电平统计 GB/s, 额外耗时)\n%-22s", "kernel");
+    for (Isa isa : available) {
+        printf("%24s", AudioKernels::IsaName(isa));
+    }
+    printf("\n");
+    for (const auto& pair : pairs) {
+        printf("%-22s", pair[0].name);
+        for (Isa isa : available) {
+            AudioKernels::SetIsa(isa);
+            const double plain = MeasureGBps(pair[0].bytes, pair[0].body);
+            const double fused = MeasureGBps(pair[1].bytes, pair[1].body);
+            printf("%8.2f /%6.2f %+6.0f%%", plain, fused, (plain / fused - 1.0) * 100.0);
+        }
+        printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,154 @@
+// AudioMixer 基准：2/4/8 路立体声白噪声（每路 -6 dBFS 峰值，路数越多求和越容易超过满幅），
+// 48kHz 按 10ms 块混合，统计每块耗时以及限幅后的输出峰值；
+// 每 100 块切换一次各路增益，覆盖增益斜坡路径。44.1kHz 一组走内部包络限幅。
+// 另外检查原地混音：单声道 + 立体声输入、output 与立体声输入共用缓冲时，结果与独立输出逐位相同。
+// 输出出现超过满幅的样本或原地混音结果不一致时返回非 0
+//
+// 用法: audio_mixer_bench [每组块数]
+
+#include "audio_mixer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kChannels = 2;
+
+struct Result {
+    double p50Ns;
+    double p99Ns;
+    double outputPeak;
+    AudioMixer::Stats stats;
+};
+
+Result Run(int sampleRate, size_t inputs, size_t blocks) {
+    const size_t frames = static_cast<size_t>(sampleRate / 100);
+
+    AudioMixer mixer;
+    AudioMixer::Options options;
+    options.sampleRate = sampleRate;
+    options.channels = kChannels;
+    options.inputChannels.assign(inputs, kChannels);
+    if (!mixer.Initialize(options)) {
+        exit(2);
+    }
+
+    // 每路预先生成 1 秒数据循环使用，计时只包含混音本身
+    std::mt19937 rng(static_cast<uint32_t>(inputs));
+    std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+    const size_t sourceBlocks = 100;
+    std::vector<std::vector<float>> sources(inputs, std::vector<float>(sourceBlocks * frames * kChannels));
+    for (auto& source : sources) {
+        for (float& sample : source) {
+            sample = noise(rng);
+        }
+    }
+
+    std::vector<const float*> pointers(inputs);
+    std::vector<float> output(frames * kChannels);
+    std::vector<double> nanos;
+    nanos.reserve(blocks);
+    double outputPeak = 0.0;
+    for (size_t block = 0; block < blocks; ++block) {
+        if (block % 100 == 0) {
+            for (size_t i = 0; i < inputs; ++i) {
+                mixer.SetGain(i, (block / 100 + i) % 2 ? 1.0f : 0.5f);
+            }
+        }
+        const size_t offset = (block % sourceBlocks) * frames * kChannels;
+        for (size_t i = 0; i < inputs; ++i) {
+            pointers[i] = sources[i].data() + offset;
+        }
+
+        const auto t0 = Clock::now();
+        mixer.Process(pointers.data(), output.data(), frames);
+        nanos.push_back(std::chrono::duration<double, std::nano>(Clock::now() - t0).count());
+
+        for (float sample : output) {
+            outputPeak = std::max(outputPeak, static_cast<double>(std::fabs(sample)));
+        }
+    }
+
+    Result result{};
+    std::sort(nanos.begin(), nanos.end());
+    result.p50Ns = nanos[nanos.size() / 2];
+    result.p99Ns = nanos[nanos.size() * 99 / 100];
+    result.outputPeak = outputPeak;
+    result.stats = mixer.GetStats();
+    return result;
+}
+
+// 单声道（独立缓冲）+ 立体声（与 output 共用缓冲）两路输入，块大小不是 10ms 的整数倍，
+// 与立体声输入单独存放时的输出逐位比较
+bool CheckInPlace() {
+    const int sampleRate = 48000;
+    const size_t blockFrames = 256;
+    const size_t blocks = 200;
+
+    AudioMixer::Options options;
+    options.sampleRate = sampleRate;
+    options.channels = kChannels;
+    options.inputChannels = {1, kChannels};
+    AudioMixer separate;
+    AudioMixer inPlace;
+    if (!separate.Initialize(options) || !inPlace.Initialize(options)) {
+        exit(2);
+    }
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+    std::vector<float> mono(blockFrames);
+    std::vector<float> stereo(blockFrames * kChannels);
+    std::vector<float> expected(blockFrames * kChannels);
+    std::vector<float> shared(blockFrames * kChannels);
+    for (size_t block = 0; block < blocks; ++block) {
+        for (float& sample : mono) {
+            sample = noise(rng);
+        }
+        for (float& sample : stereo) {
+            sample = noise(rng);
+        }
+        const float* separateInputs[] = {mono.data(), stereo.data()};
+        separate.Process(separateInputs, expected.data(), blockFrames);
+
+        shared = stereo;
+        const float* sharedInputs[] = {mono.data(), shared.data()};
+        inPlace.Process(sharedInputs, shared.data(), blockFrames);
+        if (memcmp(shared.data(), expected.data(), expected.size() * sizeof(float)) != 0) {
+            printf("原地混音结果不一致: 第 %zu 块\n", block);
+            return false;
+        }
+    }
+    printf("原地混音（单声道 + 立体声，output 与立体声输入共用）: 一致\n");
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const size_t blocks = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 6000;
+
+    printf("每组 %zu 个 10ms 块, 立体声\n", blocks);
+    printf("%8s %8s %12s %12s %14s %12s %12s\n",
+           "rate", "inputs", "block p50ns", "block p99ns", "limited/total", "peak in", "peak out");
+    bool clipped = false;
+    for (int sampleRate : {48000, 44100}) {
+        for (size_t inputs : {2, 4, 8}) {
+            const Result r = Run(sampleRate, inputs, blocks);
+            printf("%8d %8zu %12.0f %12.0f %7llu/%-6llu %12.2f %12.4f\n", sampleRate, inputs, r.p50Ns, r.p99Ns,
+                   static_cast<unsigned long long>(r.stats.limitedBlocks),
+                   static_cast<unsigned long long>(r.stats.blocks), r.stats.peak, r.outputPeak);
+            clipped |= r.outputPeak > 1.0;
+        }
+    }
+    const bool inPlaceOk = CheckInPlace();
+    return clipped || !inPlaceOk ? 1 : 0;
+}
@@ -0,0 +1,191 @@
+// CaptureEngine 扇出基准：一个合成采集源（HeadlessCaptureBackend 白噪声，48kHz 立体声，512 帧回调）
+// 按倍速运行，分别挂 1-16 个消费者线程按 10ms 拉取，统计：
+// - 采集回调中写入广播缓冲的耗时（应与消费者数量无关）
+// - 各消费者收到的帧数和因溢出丢弃的样本
+// 最后一组让其中一个消费者每 500ms 才读一次，验证慢消费者不影响其他消费者；
+// 采集结束后各消费者读完剩余数据才退出，任一组中（慢消费者除外）有消费者出现丢弃、
+// 或收到的帧数少于采集帧数时返回非 0
+//
+// 用法: capture_engine_bench [音频秒数] [倍速]
+
+#include "capture_engine.h"
+#include "headless_capture_backend.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kSampleRate = 48000;
+constexpr size_t kChannels = 2;
+constexpr size_t kPullFrames = kSampleRate / 100;
+
+// 包装合成源，记录每次回调中引擎写入的耗时
+class TimedBackend : public CaptureBackend {
+public:
+    explicit TimedBackend(const HeadlessCaptureBackend::Options& options)
+        : inner_(options) {
+    }
+
+    bool Open() { return inner_.Open(); }
+
+    bool Start() override {
+        writeNanos_.clear();
+        writeNanos_.reserve(1 << 16);
+        inner_.SetDataCallback([this](const float* interleaved, size_t frames, const CaptureTimestamp& timestamp) {
+            const auto t0 = Clock::now();
+            callback_(interleaved, frames, timestamp);
+            if (writeNanos_.size() < writeNanos_.capacity()) {
+                writeNanos_.push_back(std::chrono::duration<double, std::nano>(Clock::now() - t0).count());
+            }
+        });
+        return inner_.Start();
+    }
+    void Stop() override { inner_.Stop(); }
+    bool IsRunning() const override { return inner_.IsRunning(); }
+    int SampleRate() const override { return inner_.SampleRate(); }
+    size_t Channels() const override { return inner_.Channels(); }
+
+    bool Finished() const { return inner_.Finished(); }
+    // 只在采集停止后读取
+    std::vector<double> WriteNanos() const { return writeNanos_; }
+
+private:
+    HeadlessCaptureBackend inner_;
+    std::vector<double> writeNanos_;
+};
+
+struct Result {
+    double writeP50Ns;
+    double writeP99Ns;
+    uint64_t producedFrames;
+    uint64_t minReceivedFrames;
+    uint64_t fastDroppedSamples;   // 除慢消费者外的丢弃总数
+    uint64_t slowDroppedSamples;
+    double cpuSeconds;
+};
+
+double ProcessCpuSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+Result Run(size_t consumers, bool stallFirst, double seconds, double speed) {
+    HeadlessCaptureBackend::Options source;
+    source.generator = HeadlessCaptureBackend::Generator::Noise;
+    source.sampleRate = kSampleRate;
+    source.channels = kChannels;
+    source.blockFrames = 512;
+    source.speed = speed;
+    source.durationSeconds = seconds;
+
+    auto backend = std::make_unique<TimedBackend>(source);
+    if (!backend->Open()) {
+        exit(2);
+    }
+    TimedBackend* timed = backend.get();
+    std::shared_ptr<CaptureEngine> engine = CaptureEngine::Create(std::move(backend));
+
+    std::vector<std::unique_ptr<CaptureEngine::Subscription>> subscriptions;
+    for (size_t i = 0; i < consumers; ++i) {
+        // 慢消费者按实时预览的方式订阅，落后时直接跳到最新
+        const auto policy = stallFirst && i == 0 ? BroadcastRing::Reader::OverflowPolicy::SkipToLatest
+                                                 : BroadcastRing::Reader::OverflowPolicy::DropOldest;
+        subscriptions.push_back(engine->Subscribe(policy));
+        if (!subscriptions.back()) {
+            exit(2);
+        }
+    }
+
+    const double cpuStart = ProcessCpuSeconds();
+    std::atomic<bool> sourceDone{false};
+    std::vector<uint64_t> received(consumers, 0);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < consumers; ++i) {
+        threads.emplace_back([&, i] {
+            std::vector<float> block(kPullFrames * kChannels);
+            const auto idle = std::chrono::milliseconds(stallFirst && i == 0 ? 500 : 2);
+            for (;;) {
+                // 先看采集是否结束再读：结束之后读不到数据才说明已经读完，最后不足 10ms 的尾部也读出来
+                const bool done = sourceDone.load(std::memory_order_acquire);
+                const size_t frames = done ? std::min(kPullFrames, subscriptions[i]->AvailableFrames()) : kPullFrames;
+                if (frames > 0 && subscriptions[i]->Read(block.data(), frames)) {
+                    received[i] += frames;
+                    if (!(stallFirst && i == 0) || done) {
+                        continue;
+                    }
+                } else if (done) {
+                    break;
+                }
+                std::this_thread::sleep_for(idle);
+            }
+        });
+    }
+
+    while (!timed->Finished()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    sourceDone.store(true, std::memory_order_release);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    Result result{};
+    result.cpuSeconds = ProcessCpuSeconds() - cpuStart;
+    result.producedFrames = engine->GetStats().samplesWritten / kChannels;
+    result.minReceivedFrames = UINT64_MAX;
+    for (size_t i = 0; i < consumers; ++i) {
+        const uint64_t dropped = subscriptions[i]->GetStats().dropped_samples;
+        if (stallFirst && i == 0) {
+            result.slowDroppedSamples = dropped;
+        } else {
+            result.fastDroppedSamples += dropped;
+            result.minReceivedFrames = std::min(result.minReceivedFrames, received[i]);
+        }
+    }
+    subscriptions.clear();
+
+    std::vector<double> nanos = timed->WriteNanos();
+    std::sort(nanos.begin(), nanos.end());
+    if (!nanos.empty()) {
+        result.writeP50Ns = nanos[nanos.size() / 2];
+        result.writeP99Ns = nanos[nanos.size() * 99 / 100];
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double seconds = argc > 1 ? atof(argv[1]) : 20.0;
+    const double speed = argc > 2 ? atof(argv[2]) : 4.0;
+
+    printf("合成源 %.0f 秒, %.1f 倍速, 每次回调 512 帧\n", seconds, speed);
+    printf("%10s %12s %12s %14s %14s %12s %10s\n",
+           "consumers", "write p50ns", "write p99ns", "produced", "min received", "dropped", "cpu s");
+    bool ok = true;
+    for (size_t consumers : {1, 2, 4, 8, 16}) {
+        const Result r = Run(consumers, false, seconds, speed);
+        printf("%10zu %12.0f %12.0f %14llu %14llu %12llu %10.3f\n", consumers, r.writeP50Ns, r.writeP99Ns,
+               static_cast<unsigned long long>(r.producedFrames),
+               static_cast<unsigned long long>(r.minReceivedFrames),
+               static_cast<unsigned long long>(r.fastDroppedSamples), r.cpuSeconds);
+        ok &= r.fastDroppedSamples == 0 && r.minReceivedFrames == r.producedFrames;
+    }
+
+    const Result stalled = Run(4, true, seconds, speed);
+    printf("\n1 个慢消费者 + 3 个正常消费者: 慢消费者丢弃 %llu 样本, 其他消费者丢弃 %llu 样本, 最少收到 %llu/%llu 帧\n",
+           static_cast<unsigned long long>(stalled.slowDroppedSamples),
+           static_cast<unsigned long long>(stalled.fastDroppedSamples),
+           static_cast<unsigned long long>(stalled.minReceivedFrames),
+           static_cast<unsigned long long>(stalled.producedFrames));
+    ok &= stalled.fastDroppedSamples == 0 && stalled.minReceivedFrames == stalled.producedFrames;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,214 @@
+// 采集轨迹基准
+// 1. CaptureTraceWriter::Record() 在采集线程上的耗时（48 kHz 立体声、10ms 一块）：
+//    按 50 倍速送入时不得丢块；不限速送入时报告吞吐量和队列满丢弃的块数
+// 2. 录制一段带轨迹的无头录音（麦克风晚 30ms 开始、每秒丢 10ms），回放两次：
+//    回放的三路输出必须与录制时逐位一致，轨迹中麦克风的帧数必须与回放送出的帧数一致
+// 不满足时返回非 0
+//
+// 用法: capture_trace_bench [录音秒数]
+
+#include "capture_trace.h"
+#include "crc32c.h"
+#include "headless_recorder.h"
+#include "logger.h"
+#include "pipeline_metrics.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int kSampleRate = 48000;
+constexpr size_t kChannels = 2;
+constexpr size_t kBlockFrames = 480;
+
+struct WriteResult {
+    double blocksPerSecond;
+    uint64_t p50;
+    uint64_t p99;
+    uint64_t max;
+    uint64_t dropped;
+    uint64_t bytes;
+};
+
+// 送入 blocks 块，pause 为两块之间的间隔（0 为不限速）
+WriteResult RunWriter(const std::string& path, size_t blocks, std::chrono::microseconds pause) {
+    std::vector<float> block(kBlockFrames * kChannels);
+    for (size_t i = 0; i < block.size(); ++i) {
+        block[i] = static_cast<float>(i % 97) / 97.0f - 0.5f;
+    }
+    std::vector<uint64_t> latencies;
+    latencies.reserve(blocks);
+
+    CaptureTraceWriter writer;
+    writer.Open(path);
+    const int stream = writer.AddStream("system", kSampleRate, kChannels);
+    const uint64_t start = PipelineMetrics::NowNanoseconds();
+    CaptureTimestamp timestamp;
+    timestamp.flags = CaptureTimestamp::kHostTimeValid | CaptureTimestamp::kSampleTimeValid;
+    for (size_t i = 0; i < blocks; ++i) {
+        timestamp.sampleTime = static_cast<double>(i * kBlockFrames);
+        timestamp.hostNanos = start + i * kBlockFrames * 1000000000ull / kSampleRate;
+        const uint64_t before = PipelineMetrics::NowNanoseconds();
+        writer.Record(stream, block.data(), kBlockFrames, timestamp);
+        latencies.push_back(PipelineMetrics::NowNanoseconds() - before);
+        if (pause.count() > 0) {
+            std::this_thread::sleep_for(pause);
+        }
+    }
+    const uint64_t elapsed = PipelineMetrics::NowNanoseconds() - start;
+    writer.Close();
+
+    const CaptureTraceWriter::Stats stats = writer.GetStats();
+    std::sort(latencies.begin(), latencies.end());
+    WriteResult result;
+    result.blocksPerSecond = elapsed > 0 ? blocks * 1e9 / elapsed : 0.0;
+    result.p50 = latencies[latencies.size() / 2];
+    result.p99 = latencies[latencies.size() * 99 / 100];
+    result.max = latencies.back();
+    result.dropped = stats.droppedBlocks;
+    result.bytes = stats.bytesWritten;
+    return result;
+}
+
+uint32_t FileCrc(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    const std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return Crc32c::Compute(bytes.data(), bytes.size());
+}
+
+struct SessionResult {
+    bool ok;
+    double audioSeconds;
+    double cpuSeconds;
+    uint32_t crc[3];   // 混合、麦克风、系统音频
+};
+
+SessionResult RunSession(HeadlessRecorder::Options options, const std::filesystem::path& output) {
+    SessionResult result{};
+    HeadlessRecorder recorder(nullptr, options);
+    recorder.SetOutputPath(output.string() + ".wav");
+    if (!recorder.Start()) {
+        return result;
+    }
+    recorder.WaitUntilFinished();
+    recorder.Stop();
+    const HeadlessRecorder::Stats stats = recorder.GetStats();
+    result.ok = stats.droppedFrames == 0;
+    result.audioSeconds = stats.audioSeconds;
+    result.cpuSeconds = stats.cpuSeconds;
+    result.crc[0] = FileCrc(output.string() + ".wav");
+    result.crc[1] = FileCrc(output.string() + "_mic.wav");
+    result.crc[2] = FileCrc(output.string() + "_source.wav");
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double seconds = argc > 1 ? atof(argv[1]) : 20.0;
+    if (seconds <= 0.0) {
+        fprintf(stderr, "时长无效\n");
+        return 2;
+    }
+    Logger::init();
+    Logger::setLevel(Logger::Level::WARN);
+
+    const std::filesystem::path outputDir = std::filesystem::temp_directory_path() / "capture_trace_bench";
+    std::filesystem::create_directories(outputDir);
+    bool ok = true;
+
+    printf("Record(): 48 kHz 立体声, %zu 帧/块\n", kBlockFrames);
+    printf("%-10s %8s %12s %9s %9s %9s %8s %10s\n", "节奏", "块数", "块/秒", "p50(ns)", "p99(ns)", "最大(ns)",
+           "丢弃", "写盘(MB)");
+    struct WriterConfig {
+        const char* name;
+        size_t blocks;
+        std::chrono::microseconds pause;
+    };
+    const WriterConfig writerConfigs[] = {
+        {"50 倍速", 3000, std::chrono::microseconds(200)},
+        {"不限速", 30000, std::chrono::microseconds(0)},
+    };
+    for (const WriterConfig& config : writerConfigs) {
+        const WriteResult result = RunWriter((outputDir / "writer.trace").string(), config.blocks, config.pause);
+        printf("%-10s %8zu %12.0f %9llu %9llu %9llu %8llu %10.1f\n", config.name, config.blocks,
+               result.blocksPerSecond, static_cast<unsigned long long>(result.p50),
+               static_cast<unsigned long long>(result.p99), static_cast<unsigned long long>(result.max),
+               static_cast<unsigned long long>(result.dropped), result.bytes / 1048576.0);
+        if (config.pause.count() > 0 && result.dropped > 0) {
+            fprintf(stderr, "按 50 倍速写轨迹丢了 %llu 块\n", static_cast<unsigned long long>(result.dropped));
+            ok = false;
+        }
+    }
+
+    // 录制 -> 回放两次，三路输出逐位比较
+    const std::string tracePath = (outputDir / "session.trace").string();
+    HeadlessRecorder::Options recordOptions;
+    recordOptions.speed = 0.0;
+    recordOptions.system.durationSeconds = recordOptions.microphone.durationSeconds = seconds;
+    recordOptions.microphone.startDelayMilliseconds = 30.0;
+    recordOptions.microphone.dropoutIntervalSeconds = 1.0;
+    recordOptions.microphone.dropoutMilliseconds = 10.0;
+    recordOptions.tracePath = tracePath;
+
+    HeadlessRecorder::Options replayOptions;
+    replayOptions.speed = 0.0;
+    replayOptions.system.tracePath = replayOptions.microphone.tracePath = tracePath;
+    replayOptions.system.traceStream = "system";
+    replayOptions.microphone.traceStream = "microphone";
+
+    printf("\n%-10s %10s %10s %14s %10s %10s %10s\n", "运行", "音频(s)", "CPU(s)", "音频s/CPU s", "混合", "麦克风",
+           "系统音频");
+    const SessionResult runs[] = {
+        RunSession(recordOptions, outputDir / "record"),
+        RunSession(replayOptions, outputDir / "replay1"),
+        RunSession(replayOptions, outputDir / "replay2"),
+    };
+    const char* names[] = {"录制", "回放 1", "回放 2"};
+    for (size_t i = 0; i < 3; ++i) {
+        const SessionResult& run = runs[i];
+        printf("%-10s %10.2f %10.3f %14.1f   %08x   %08x   %08x\n", names[i], run.audioSeconds, run.cpuSeconds,
+               run.cpuSeconds > 0.0 ? run.audioSeconds / run.cpuSeconds : 0.0, run.crc[0], run.crc[1], run.crc[2]);
+        if (!run.ok) {
+            fprintf(stderr, "%s 失败或写盘丢帧\n", names[i]);
+            ok = false;
+        }
+        for (size_t file = 0; file < 3; ++file) {
+            if (run.crc[file] != runs[0].crc[file]) {
+                fprintf(stderr, "%s 的第 %zu 路输出与录制时不一致\n", names[i], file);
+                ok = false;
+            }
+        }
+    }
+
+    CaptureTraceReader trace;
+    if (!trace.Open(tracePath)) {
+        ok = false;
+    } else {
+        const int microphone = trace.FindStream("microphone");
+        const CaptureTraceReader::StreamInfo& info = trace.Streams()[microphone];
+        // 回放的位置只按送出的帧前进，不含录制时模拟丢失的采样时钟
+        const uint64_t replayed = static_cast<uint64_t>(runs[1].audioSeconds * kSampleRate + 0.5);
+        printf("\n轨迹: %.1f MB, %zu 条记录, 麦克风 %llu 块/%llu 帧, 丢失 %llu 帧\n",
+               std::filesystem::file_size(tracePath) / 1048576.0, trace.RecordCount(),
+               static_cast<unsigned long long>(info.blocks), static_cast<unsigned long long>(info.frames),
+               static_cast<unsigned long long>(info.gapFrames));
+        if (info.gapFrames > 0 || info.frames != replayed) {
+            fprintf(stderr, "轨迹丢了数据或回放帧数不符: 轨迹 %llu 帧, 回放 %llu 帧\n",
+                    static_cast<unsigned long long>(info.frames), static_cast<unsigned long long>(replayed));
+            ok = false;
+        }
+    }
+
+    Logger::shutdown();
+    printf("\n%s\n", ok ? "通过" : "失败");
+    return ok ? 0 : 1;
+}
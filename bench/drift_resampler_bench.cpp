@@ -0,0 +1,142 @@
+// DriftCompensatingResampler 基准：模拟系统音频 tap 与麦克风时钟不一致的长时间录制
+// 生产者按实际采样率（与名义值相差若干 ppm）分块送入，消费者按会话时钟拉取 10ms 块，
+// 统计输出与输入之间的对齐误差和每秒音频的 CPU 开销；误差超过一个块时返回非 0
+//
+// 用法: drift_resampler_bench [模拟秒数]
+
+#include "drift_compensating_resampler.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+// 系统音频 IOProc 每次回调的帧数
+constexpr size_t kProducerBlockFrames = 512;
+constexpr size_t kChannels = 2;
+
+struct Scenario {
+    int nominalInputRate;
+    double actualInputRate;
+    int outputRate;
+};
+
+struct Result {
+    double maxErrorFrames;       // 整个过程中的最大对齐误差（输出帧）
+    double settledErrorFrames;   // 第一分钟之后的最大对齐误差
+    double finalCorrectionPpm;
+    double cpuMicrosPerSecond;   // 每秒音频的处理耗时
+    uint64_t underruns;
+    size_t droppedSamples;
+};
+
+Result Run(const Scenario& scenario, double seconds) {
+    DriftCompensatingResampler resampler;
+    DriftCompensatingResampler::Options options;
+    options.inputRate = scenario.nominalInputRate;
+    options.outputRate = scenario.outputRate;
+    options.channels = kChannels;
+    if (!resampler.Initialize(options)) {
+        exit(2);
+    }
+
+    const size_t pullFrames = static_cast<size_t>(scenario.outputRate / 100);
+    const double producerPhaseStep = 2.0 * M_PI * 1000.0 / scenario.actualInputRate;
+    std::vector<float> input(kProducerBlockFrames * kChannels);
+    std::vector<float> output(pullFrames * kChannels);
+
+    uint64_t produced = 0;
+    uint64_t pulled = 0;
+    bool aligned = false;
+    double baseDelay = 0.0;
+    Result result{};
+    double cpuSeconds = 0.0;
+
+    const uint64_t totalPulls = static_cast<uint64_t>(seconds * 100);
+    for (uint64_t k = 0; k < totalPulls; ++k) {
+        const double now = static_cast<double>(pulled + pullFrames) / scenario.outputRate;
+        // 把此刻之前到达的 IOProc 块送入，到达时刻由实际输入采样率决定
+        while (static_cast<double>(produced + kProducerBlockFrames) / scenario.actualInputRate <= now) {
+            for (size_t i = 0; i < kProducerBlockFrames; ++i) {
+                const float v = 0.5f * static_cast<float>(std::sin(producerPhaseStep * static_cast<double>(produced + i)));
+                input[i * kChannels] = v;
+                input[i * kChannels + 1] = -v;
+            }
+            resampler.Push(input.data(), kProducerBlockFrames);
+            produced += kProducerBlockFrames;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        resampler.Pull(output.data(), pullFrames);
+        cpuSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        pulled += pullFrames;
+
+        const DriftCompensatingResampler::Stats stats = resampler.GetStats();
+        if (stats.consumedFrames <= 0.0) {
+            continue;
+        }
+        // 当前输出的最后一帧对应的输入帧在 consumed / actualRate 时刻被采集，两者之差即两路之间的延迟
+        const double delay = now - stats.consumedFrames / scenario.actualInputRate;
+        if (!aligned) {
+            baseDelay = delay;
+            aligned = true;
+            continue;
+        }
+        const double errorFrames = std::fabs(delay - baseDelay) * scenario.outputRate;
+        result.maxErrorFrames = std::max(result.maxErrorFrames, errorFrames);
+        if (now > 60.0) {
+            result.settledErrorFrames = std::max(result.settledErrorFrames, errorFrames);
+        }
+    }
+
+    const DriftCompensatingResampler::Stats stats = resampler.GetStats();
+    result.finalCorrectionPpm = stats.correctionPpm;
+    result.cpuMicrosPerSecond = cpuSeconds * 1e6 / seconds;
+    result.underruns = stats.underruns;
+    result.droppedSamples = stats.droppedSamples;
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double seconds = argc > 1 ? atof(argv[1]) : 3600.0;
+    if (seconds <= 60.0) {
+        fprintf(stderr, "模拟时长需大于 60 秒\n");
+        return 2;
+    }
+
+    const Scenario scenarios[] = {
+        {44100, 44102.0, 48000},
+        {44100, 44102.0, 44100},
+        {44100, 44098.0, 48000},
+        {48000, 48024.0, 48000},
+    };
+
+    printf("模拟时长 %.0f 秒, 生产者块 %zu 帧, 消费者块 10ms, %zu 声道\n\n", seconds, kProducerBlockFrames, kChannels);
+    printf("%-22s %10s %12s %12s %14s %12s %10s\n",
+           "输入 -> 输出", "漂移ppm", "未补偿(帧)", "最大误差", "稳定后误差", "修正ppm", "CPU us/s");
+
+    bool ok = true;
+    for (const Scenario& scenario : scenarios) {
+        const Result result = Run(scenario, seconds);
+        const double driftPpm = (scenario.actualInputRate / scenario.nominalInputRate - 1.0) * 1e6;
+        // 固定比例时输出相对输入累计偏移的帧数
+        const double uncompensated = std::fabs(driftPpm) * 1e-6 * seconds * scenario.outputRate;
+        const double blockFrames = scenario.outputRate / 100.0;
+        char label[64];
+        snprintf(label, sizeof(label), "%.0f -> %d", scenario.actualInputRate, scenario.outputRate);
+        printf("%-22s %10.1f %12.0f %12.1f %14.1f %12.1f %10.0f\n",
+               label, driftPpm, uncompensated, result.maxErrorFrames, result.settledErrorFrames,
+               result.finalCorrectionPpm, result.cpuMicrosPerSecond);
+        if (result.maxErrorFrames >= blockFrames || result.underruns > 0 || result.droppedSamples > 0) {
+            printf("  超出要求: 块 %.0f 帧, 欠载 %llu 次, 丢弃 %zu 样本\n", blockFrames,
+                   static_cast<unsigned long long>(result.underruns), result.droppedSamples);
+            ok = false;
+        }
+    }
+    printf("\n对齐误差以输出帧计，要求小于一个 10ms 块\n");
+    return ok ? 0 : 1;
+}
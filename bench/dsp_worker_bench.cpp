@@ -0,0 +1,145 @@
+// DspWorker 基准：1/2/4/8 个录音会话（48kHz 单声道，高通 + 降噪 + AGC2）共享一组 DSP 工作线程，
+// 一个模拟 IO 线程按倍速每 10ms 给每个会话写入一块数据，统计：
+// - IO 线程每次 Write() 的耗时（只拷贝，应与处理链和会话数无关）
+// - 各处理级每个 10ms 帧的平均耗时
+// - 工作线程负载（处理耗时 / 墙钟）和输入缓冲溢出丢弃的帧数
+// 有会话丢帧或输出帧数与输入不一致时返回非 0
+//
+// 用法: dsp_worker_bench [音频秒数] [倍速] [工作线程数]
+
+#include "dsp_worker.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kSampleRate = 48000;
+constexpr size_t kBlockFrames = kSampleRate / 100;
+
+// 1 秒的测试信号：白噪声底噪上叠加 200ms 通断的谐波"语音"
+std::vector<float> MakeSignal(uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> noise(0.0f, 0.01f);
+    std::vector<float> signal(kSampleRate);
+    for (size_t i = 0; i < signal.size(); ++i) {
+        const double t = static_cast<double>(i) / kSampleRate;
+        const bool voiced = (i / (kSampleRate / 5)) % 2 == 0;
+        float voice = 0.0f;
+        if (voiced) {
+            for (int harmonic = 1; harmonic <= 5; ++harmonic) {
+                voice += 0.05f / harmonic * static_cast<float>(std::sin(2.0 * M_PI * 180.0 * harmonic * t));
+            }
+        }
+        signal[i] = voice + noise(rng);
+    }
+    return signal;
+}
+
+struct Result {
+    double writeP50Ns;
+    double writeP99Ns;
+    double stageNs[DspChain::kStageCount];
+    double frameNs;
+    double maxLoad;
+    uint64_t droppedFrames;
+    bool complete;
+};
+
+Result Run(size_t sessions, size_t threads, double seconds, double speed) {
+    DspWorker::Options workerOptions;
+    workerOptions.threads = threads;
+    DspWorker worker(workerOptions);
+
+    std::vector<std::atomic<uint64_t>> outputFrames(sessions);
+    std::vector<std::unique_ptr<DspWorker::Session>> active;
+    for (size_t i = 0; i < sessions; ++i) {
+        DspWorker::Session::Options options;
+        options.chain.sampleRate = kSampleRate;
+        options.chain.channels = 1;
+        options.sink = [&outputFrames, i](const float*, size_t frames) {
+            outputFrames[i].fetch_add(frames, std::memory_order_relaxed);
+        };
+        active.push_back(worker.AddSession(options));
+        if (!active.back()) {
+            exit(2);
+        }
+    }
+
+    std::vector<std::vector<float>> signals;
+    for (size_t i = 0; i < sessions; ++i) {
+        signals.push_back(MakeSignal(static_cast<uint32_t>(i + 1)));
+    }
+
+    const size_t blocks = static_cast<size_t>(seconds * 100);
+    const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(0.01 / speed));
+    std::vector<double> writeNanos;
+    writeNanos.reserve(blocks * sessions);
+    const auto start = Clock::now();
+    auto next = start;
+    for (size_t block = 0; block < blocks; ++block) {
+        const size_t offset = (block % 100) * kBlockFrames;
+        for (size_t i = 0; i < sessions; ++i) {
+            const auto t0 = Clock::now();
+            active[i]->Write(signals[i].data() + offset, kBlockFrames);
+            writeNanos.push_back(std::chrono::duration<double, std::nano>(Clock::now() - t0).count());
+        }
+        next += period;
+        std::this_thread::sleep_until(next);
+    }
+    const double wall = std::chrono::duration<double>(Clock::now() - start).count();
+
+    Result result{};
+    const DspWorker::Stats workerStats = worker.GetStats();
+    for (uint64_t busy : workerStats.busyNanoseconds) {
+        result.maxLoad = std::max(result.maxLoad, busy / 1e9 / wall);
+    }
+    for (auto& session : active) {
+        const DspWorker::Session::Stats stats = session->GetStats();
+        result.droppedFrames += stats.droppedFrames;
+        for (size_t stage = 0; stage < DspChain::kStageCount; ++stage) {
+            result.stageNs[stage] += stats.chain.stages[stage].averageNanos / static_cast<double>(sessions);
+        }
+        result.frameNs += stats.chain.total.averageNanos / static_cast<double>(sessions);
+    }
+    active.clear();
+
+    result.complete = true;
+    for (size_t i = 0; i < sessions; ++i) {
+        result.complete &= outputFrames[i].load() == blocks * kBlockFrames;
+    }
+    std::sort(writeNanos.begin(), writeNanos.end());
+    result.writeP50Ns = writeNanos[writeNanos.size() / 2];
+    result.writeP99Ns = writeNanos[writeNanos.size() * 99 / 100];
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double seconds = argc > 1 ? atof(argv[1]) : 10.0;
+    const double speed = argc > 2 ? atof(argv[2]) : 4.0;
+    const size_t threads = argc > 3 ? static_cast<size_t>(atoi(argv[3])) : 1;
+
+    printf("%.0f 秒音频, %.1f 倍速, %zu 个工作线程, 每会话 48kHz 单声道 高通+降噪+AGC2\n", seconds, speed, threads);
+    printf("%9s %12s %12s %10s %10s %10s %10s %10s %8s\n", "sessions", "write p50ns", "write p99ns",
+           "hpf ns", "ns ns", "agc2 ns", "frame ns", "max load", "dropped");
+    bool ok = true;
+    for (size_t sessions : {1, 2, 4, 8}) {
+        const Result r = Run(sessions, threads, seconds, speed);
+        printf("%9zu %12.0f %12.0f %10.0f %10.0f %10.0f %10.0f %9.1f%% %8llu%s\n", sessions, r.writeP50Ns,
+               r.writeP99Ns, r.stageNs[DspChain::kHighPass], r.stageNs[DspChain::kNoiseSuppression],
+               r.stageNs[DspChain::kGainControl], r.frameNs, r.maxLoad * 100.0,
+               static_cast<unsigned long long>(r.droppedFrames), r.complete ? "" : " (输出不完整)");
+        ok &= r.droppedFrames == 0 && r.complete;
+    }
+    return ok ? 0 : 1;
+}
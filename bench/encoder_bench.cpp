@@ -0,0 +1,185 @@
+// 压缩编码基准：FLAC（16/24 位、单线程与多线程）和 G.722 语音模式
+// 输出相对 float32 WAV 的压缩比，以及每 CPU 秒处理的输入数据量（MB/s/核）和墙钟吞吐
+// 编码失败时返回非 0
+//
+// 用法:
+//   encoder_bench [秒数]             使用合成信号（类语音、正弦、白噪声）
+//   encoder_bench 秒数 input.wav     从 WAV 文件读取（文件不足时循环）
+
+#include "audio_encoder.h"
+#include "headless_capture_backend.h"
+#include "logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fcntl.h>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+// 和 StreamingWavWriter 写盘线程每次交给编码器的数据量相当
+constexpr size_t kFeedFrames = 4800;
+
+struct Signal {
+    const char* name;
+    HeadlessCaptureBackend::Generator generator;
+    int sampleRate;
+};
+
+struct Config {
+    const char* name;
+    AudioEncoder::Codec codec;
+    uint16_t bitsPerSample;
+    size_t threads;   // 0 为编码器默认值
+};
+
+struct Clip {
+    std::vector<float> samples;
+    int sampleRate = 0;
+    size_t channels = 0;
+};
+
+double ProcessCpuSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+bool Load(HeadlessCaptureBackend::Options options, double seconds, Clip* clip) {
+    options.speed = 0.0;
+    options.durationSeconds = seconds;
+    HeadlessCaptureBackend backend(options);
+    backend.SetDataCallback([clip](const float* interleaved, size_t frames, const CaptureTimestamp&) {
+        clip->samples.insert(clip->samples.end(), interleaved, interleaved + frames * clip->channels);
+    });
+    if (!backend.Open()) {
+        return false;
+    }
+    clip->sampleRate = backend.SampleRate();
+    clip->channels = backend.Channels();
+    while (backend.ProduceBlock()) {
+    }
+    return !clip->samples.empty();
+}
+
+struct Result {
+    bool ok;
+    uint64_t bytes;
+    double wallSeconds;
+    double cpuSeconds;
+};
+
+Result Encode(const Clip& clip, const Config& config, const std::string& path) {
+    Result result = {false, 0, 0.0, 0.0};
+    AudioEncoder::Options options;
+    options.sampleRate = clip.sampleRate;
+    options.channels = clip.channels;
+    options.bitsPerSample = config.bitsPerSample;
+    options.threads = config.threads;
+    std::unique_ptr<AudioEncoder> encoder = AudioEncoder::Create(config.codec, options);
+    const int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (!encoder || fd < 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        return result;
+    }
+
+    const auto wallStart = std::chrono::steady_clock::now();
+    const double cpuStart = ProcessCpuSeconds();
+    bool ok = encoder->Begin(fd);
+    const size_t frames = clip.samples.size() / clip.channels;
+    for (size_t offset = 0; ok && offset < frames; offset += kFeedFrames) {
+        const size_t n = std::min(kFeedFrames, frames - offset);
+        ok = encoder->Encode(clip.samples.data() + offset * clip.channels, n);
+    }
+    ok = ok && encoder->Finish();
+    result.cpuSeconds = ProcessCpuSeconds() - cpuStart;
+    result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    result.ok = ok && encoder->FramesEncoded() == frames;
+    result.bytes = encoder->BytesWritten();
+    close(fd);
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double seconds = argc > 1 ? atof(argv[1]) : 60.0;
+    if (seconds <= 0.0) {
+        fprintf(stderr, "时长无效\n");
+        return 2;
+    }
+    Logger::init();
+    Logger::setLevel(Logger::Level::WARN);
+
+    const std::filesystem::path outputDir = std::filesystem::temp_directory_path() / "encoder_bench";
+    std::filesystem::create_directories(outputDir);
+
+    std::vector<std::pair<std::string, Clip>> clips;
+    if (argc > 2) {
+        HeadlessCaptureBackend::Options options;
+        options.wavPath = argv[2];
+        options.loop = true;
+        Clip clip;
+        if (!Load(options, seconds, &clip)) {
+            fprintf(stderr, "无法读取 %s\n", argv[2]);
+            return 2;
+        }
+        clips.emplace_back(std::filesystem::path(argv[2]).filename().string(), std::move(clip));
+    } else {
+        const Signal signals[] = {
+            {"类语音 48k", HeadlessCaptureBackend::Generator::Speech, 48000},
+            {"正弦 44.1k", HeadlessCaptureBackend::Generator::Sine, 44100},
+            {"白噪声 48k", HeadlessCaptureBackend::Generator::Noise, 48000},
+        };
+        for (const Signal& signal : signals) {
+            HeadlessCaptureBackend::Options options;
+            options.generator = signal.generator;
+            options.sampleRate = signal.sampleRate;
+            Clip clip;
+            if (!Load(options, seconds, &clip)) {
+                fprintf(stderr, "信号生成失败: %s\n", signal.name);
+                return 2;
+            }
+            clips.emplace_back(signal.name, std::move(clip));
+        }
+    }
+
+    const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    const Config configs[] = {
+        {"FLAC 16 位 x1", AudioEncoder::Codec::Flac, 16, 1},
+        {"FLAC 16 位 xN", AudioEncoder::Codec::Flac, 16, 0},
+        {"FLAC 24 位 xN", AudioEncoder::Codec::Flac, 24, 0},
+        {"G.722", AudioEncoder::Codec::G722, 16, 0},
+    };
+
+    printf("音频 %.0f 秒, %zu 核, 压缩比以 float32 WAV 数据量为基准\n\n", seconds, cores);
+    printf("%-16s %-16s %12s %10s %14s %12s\n", "信号", "编码", "输出(KB)", "压缩比", "MB/s/核", "墙钟 MB/s");
+    bool ok = true;
+    for (const auto& entry : clips) {
+        const Clip& clip = entry.second;
+        const double inputMB = clip.samples.size() * sizeof(float) / 1e6;
+        for (const Config& config : configs) {
+            const std::string path = (outputDir / (std::string("out") + AudioEncoder::Extension(config.codec))).string();
+            const Result result = Encode(clip, config, path);
+            if (!result.ok) {
+                printf("%-16s %-16s 编码失败\n", entry.first.c_str(), config.name);
+                ok = false;
+                continue;
+            }
+            printf("%-16s %-16s %12.0f %9.1f%% %14.1f %12.1f\n", entry.first.c_str(), config.name,
+                   result.bytes / 1024.0, result.bytes / 1e4 / inputMB,
+                   inputMB / result.cpuSeconds, inputMB / result.wallSeconds);
+        }
+    }
+    std::filesystem::remove_all(outputDir);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+// HeadlessRecorder 端到端基准：无硬件地跑完整录音管线
+// （漂移补偿重采样、回声消除、三路流式写盘），输出每 CPU 秒处理的音频秒数
+// 最后一组让麦克风晚 30ms 开始并每秒丢 10ms 数据，检查时间戳对齐报告的起始偏差
+// 每组结束后读取两路电平表（采集转换时顺带统计），检查窗口数与音频时长相符；
+// 正弦一组两路改用已知幅度的正弦，检查峰值与 RMS 读数等于幅度与幅度/√2（误差 0.1 dB 内）、没有削波
+// 写盘有丢帧、按倍速回放的节奏偏差超过 10%、起始偏差报告、电平窗口数或电平读数不符时返回非 0
+//
+// 用法:
+//   headless_recorder_bench [秒数]                     使用合成的系统音频和麦克风信号
+//   headless_recorder_bench 秒数 system.wav mic.wav    从 WAV 文件回放（文件不足时循环）
+
+#include "headless_recorder.h"
+#include "logger.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+
+namespace {
+
+struct Config {
+    const char* name;
+    double speed;
+    bool echoCancellation;
+    double micStartDelayMilliseconds;   // 大于 0 时同时模拟麦克风每秒丢 10ms
+    bool sine;                          // 两路都用已知幅度的正弦，检查电平读数
+};
+
+constexpr float kMicrophoneSineAmplitude = 0.25f;
+constexpr float kSystemSineAmplitude = 0.5f;
+
+// 读数与期望值相差不超过 0.1 dB
+bool LevelMatches(const char* name, float actual, float expected) {
+    const double error = LevelMeter::ToDecibels(actual) - LevelMeter::ToDecibels(expected);
+    if (std::fabs(error) <= 0.1) {
+        return true;
+    }
+    printf("  电平读数不符: %s %.2f dBFS, 期望 %.2f dBFS\n", name, LevelMeter::ToDecibels(actual),
+           LevelMeter::ToDecibels(expected));
+    return false;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double seconds = argc > 1 ? atof(argv[1]) : 60.0;
+    if (seconds <= 0.0) {
+        fprintf(stderr, "时长无效\n");
+        return 2;
+    }
+    Logger::init();
+    Logger::setLevel(Logger::Level::WARN);
+
+    const std::filesystem::path outputDir = std::filesystem::temp_directory_path() / "headless_recorder_bench";
+    std::filesystem::create_directories(outputDir);
+
+    // 倍速回放只跑一小段，验证节奏
+    const Config configs[] = {
+        {"不限速 + AEC", 0.0, true, 0.0, false},
+        {"不限速", 0.0, false, 0.0, false},
+        {"10 倍速 + AEC", 10.0, true, 0.0, false},
+        {"不限速 + 偏差丢块", 0.0, false, 30.0, false},
+        {"不限速 + 正弦", 0.0, false, 0.0, true},
+    };
+
+    printf("%-18s %10s %10s %10s %14s %10s %8s\n",
+           "配置", "音频(s)", "墙钟(s)", "CPU(s)", "音频s/CPU s", "实时倍数", "丢帧");
+    bool ok = true;
+    for (const Config& config : configs) {
+        HeadlessRecorder::Options options;
+        options.speed = config.speed;
+        options.echoCancellation = config.echoCancellation;
+        const double duration = config.speed > 0.0 ? std::min(seconds, config.speed * 2.0) : seconds;
+        options.system.durationSeconds = options.microphone.durationSeconds = duration;
+        if (config.micStartDelayMilliseconds > 0.0) {
+            options.microphone.startDelayMilliseconds = config.micStartDelayMilliseconds;
+            options.microphone.dropoutIntervalSeconds = 1.0;
+            options.microphone.dropoutMilliseconds = 10.0;
+        }
+        const bool sine = config.sine && argc <= 3;
+        if (sine) {
+            options.system.generator = options.microphone.generator = HeadlessCaptureBackend::Generator::Sine;
+            options.microphone.amplitude = kMicrophoneSineAmplitude;
+            options.system.amplitude = kSystemSineAmplitude;
+        }
+        if (argc > 3) {
+            options.system.wavPath = argv[2];
+            options.microphone.wavPath = argv[3];
+            options.system.loop = options.microphone.loop = true;
+        }
+
+        HeadlessRecorder recorder(nullptr, options);
+        recorder.SetOutputPath((outputDir / "mix.wav").string());
+        if (!recorder.Start()) {
+            fprintf(stderr, "启动失败: %s\n", config.name);
+            return 2;
+        }
+        recorder.WaitUntilFinished();
+        recorder.Stop();
+
+        const HeadlessRecorder::Stats stats = recorder.GetStats();
+        printf("%-18s %10.1f %10.2f %10.2f %14.1f %10.1f %8llu\n", config.name, stats.audioSeconds,
+               stats.wallSeconds, stats.cpuSeconds, stats.audioSeconds / stats.cpuSeconds,
+               stats.audioSeconds / stats.wallSeconds, static_cast<unsigned long long>(stats.droppedFrames));
+        ok &= stats.droppedFrames == 0;
+        if (config.speed > 0.0) {
+            const double expected = stats.audioSeconds / config.speed;
+            if (std::fabs(stats.wallSeconds - expected) > expected * 0.1) {
+                printf("  节奏偏差: 期望 %.2f 秒, 实际 %.2f 秒\n", expected, stats.wallSeconds);
+                ok = false;
+            }
+        }
+        if (config.micStartDelayMilliseconds > 0.0) {
+            const double skew = stats.startSkewNanos / 1e6;
+            printf("  起始偏差 %.2f ms, 剩余偏差 %.3f ms, 对齐补静音/裁剪 %llu 帧\n", skew,
+                   stats.streamOffsetNanos / 1e6, static_cast<unsigned long long>(stats.alignedFrames));
+            ok &= std::fabs(skew - config.micStartDelayMilliseconds) < 1.0 && stats.alignedFrames > 0;
+        }
+        // 平均 33ms 一个窗口；音频时长包括模拟丢失的数据（不经过电平表），按 2% 容差比较
+        const CaptureLevels levels = recorder.GetLevels();
+        const double expectedWindows = stats.audioSeconds * 1000.0 / 33.0;
+        printf("  电平: 麦克风峰值 %.1f dBFS, RMS %.1f dBFS, 削波 %llu; 系统峰值 %.1f dBFS, RMS %.1f dBFS; 窗口 %llu/%llu\n",
+               LevelMeter::ToDecibels(levels.microphone.peak), LevelMeter::ToDecibels(levels.microphone.rms),
+               static_cast<unsigned long long>(levels.microphone.totalClipped),
+               LevelMeter::ToDecibels(levels.system.peak), LevelMeter::ToDecibels(levels.system.rms),
+               static_cast<unsigned long long>(levels.microphone.windows),
+               static_cast<unsigned long long>(levels.system.windows));
+        for (const LevelMeter::Levels* stream : {&levels.microphone, &levels.system}) {
+            ok &= std::fabs(static_cast<double>(stream->windows) - expectedWindows) <= expectedWindows * 0.02 + 1.0;
+        }
+        if (sine) {
+            const float root2 = std::sqrt(2.0f);
+            ok &= LevelMatches("麦克风峰值", levels.microphone.peak, kMicrophoneSineAmplitude);
+            ok &= LevelMatches("麦克风 RMS", levels.microphone.rms, kMicrophoneSineAmplitude / root2);
+            ok &= LevelMatches("系统峰值", levels.system.peak, kSystemSineAmplitude);
+            ok &= LevelMatches("系统 RMS", levels.system.rms, kSystemSineAmplitude / root2);
+            ok &= levels.microphone.totalClipped == 0 && levels.system.totalClipped == 0;
+        }
+    }
+
+    std::filesystem::remove_all(outputDir);
+    Logger::shutdown();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+// Logger 基准测试：对比原先的同步实现（vsnprintf + 直接写 spdlog sink）与异步二进制队列
+// 模拟音频线程按固定周期打日志，输出单次调用的 p50/p99/最坏延迟，以及突发时的丢弃数
+// 使用 TRACE 级别，只写入日志文件，不刷屏
+
+#include "logger.h"
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/rotating_file_sink.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 原先的实现：调用线程上格式化并同步写 sink，仅用于对比
+class LegacyLogger {
+public:
+    explicit LegacyLogger(const std::string& path) {
+        auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(path, 1024 * 1024 * 5, 3);
+        sink->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%l] [%t] %v");
+        logger_ = std::make_shared<spdlog::logger>("legacy", sink);
+        logger_->set_level(spdlog::level::trace);
+    }
+
+    void trace(const char* fmt, ...) {
+        va_list args;
+        va_start(args, fmt);
+        char buffer[1024];
+        vsnprintf(buffer, sizeof(buffer), fmt, args);
+        va_end(args);
+        logger_->trace(buffer);
+    }
+
+private:
+    std::shared_ptr<spdlog::logger> logger_;
+};
+
+struct LatencyResult {
+    double p50_us;
+    double p99_us;
+    double worst_us;
+};
+
+// 每 periodMicroseconds 调用一次，持续 durationSeconds
+template <typename LogFn>
+LatencyResult PacedLatency(LogFn log, int periodMicroseconds, double durationSeconds) {
+    std::vector<double> latencies;
+    latencies.reserve(static_cast<size_t>(durationSeconds * 1e6 / periodMicroseconds) + 1);
+
+    const auto start = Clock::now();
+    const auto deadline = start + std::chrono::duration<double>(durationSeconds);
+    auto next = start;
+    for (uint64_t i = 0; Clock::now() < deadline; ++i) {
+        const auto t0 = Clock::now();
+        log(i);
+        const auto t1 = Clock::now();
+        latencies.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+        next += std::chrono::microseconds(periodMicroseconds);
+        std::this_thread::sleep_until(next);
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    LatencyResult result;
+    result.p50_us = latencies[latencies.size() / 2];
+    result.p99_us = latencies[latencies.size() * 99 / 100];
+    result.worst_us = latencies.back();
+    return result;
+}
+
+} // namespace
+
+int main() {
+    const std::string logDir = (std::filesystem::temp_directory_path() / "recorder_logger_bench").string();
+    std::filesystem::create_directories(logDir);
+    Logger::init(logDir);
+    Logger::setLevel(Logger::Level::TRACE);
+    LegacyLogger legacy(logDir + "/legacy.log");
+
+    const int periods[] = {1000, 100, 10};
+
+    printf("按周期调用的单次延迟 (微秒)\n");
+    printf("%10s %10s %10s %10s %10s %10s %10s\n",
+           "period us", "legacy p50", "legacy p99", "legacy max", "async p50", "async p99", "async max");
+    for (int period : periods) {
+        LatencyResult a = PacedLatency([&](uint64_t i) {
+            legacy.trace("音频回调 %llu: 帧数 %u, 电平 %.2f dB, 设备 %s",
+                         static_cast<unsigned long long>(i), 512u, -12.5, "BlackHole 2ch");
+        }, period, 0.5);
+        LatencyResult b = PacedLatency([&](uint64_t i) {
+            Logger::trace("音频回调 %llu: 帧数 %u, 电平 %.2f dB, 设备 %s",
+                          static_cast<unsigned long long>(i), 512u, -12.5, "BlackHole 2ch");
+        }, period, 0.5);
+        printf("%10d %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f\n", period,
+               a.p50_us, a.p99_us, a.worst_us, b.p50_us, b.p99_us, b.worst_us);
+    }
+
+    // 不限速突发：队列满后丢弃而不是阻塞调用线程
+    const uint64_t droppedBefore = Logger::droppedCount();
+    const size_t burst = 100000;
+    const auto t0 = Clock::now();
+    for (size_t i = 0; i < burst; ++i) {
+        Logger::trace("突发 %zu", i);
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    printf("\n突发 %zu 条: 每条 %.3f 微秒, 丢弃 %llu 条\n", burst, seconds * 1e6 / burst,
+           static_cast<unsigned long long>(Logger::droppedCount() - droppedBefore));
+
+    Logger::shutdown();
+    std::filesystem::remove_all(logDir);
+    return 0;
+}
@@ -0,0 +1,235 @@
+// PrerollBuffer 基准：48kHz 立体声，由基准线程按倍速向 CaptureEngine 推送数据，统计：
+// - 每分钟历史占用的内存（Int16 / Compressed，类语音信号和接近静音的底噪）和编码耗时
+// - 从 1/2/5 分钟历史中拼接的耗时（解码到空 sink）
+// - 接缝检查：整数精确的锯齿信号，CaptureRecording 带 5 秒预录开始录音，
+//   读回文件验证历史与实时数据之间没有缺口也没有重叠
+// 有丢弃或接缝不连续时返回非 0
+//
+// 用法: preroll_bench [倍速]
+
+#include "capture_recording.h"
+#include "preroll_buffer.h"
+#include "wav_file_reader.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kSampleRate = 48000;
+constexpr size_t kChannels = 2;
+constexpr size_t kPushFrames = kSampleRate / 100;
+
+// 由基准线程直接推送数据的后端
+class PushBackend : public CaptureBackend {
+public:
+    bool Start() override { running_ = true; return true; }
+    void Stop() override { running_ = false; }
+    bool IsRunning() const override { return running_; }
+    int SampleRate() const override { return kSampleRate; }
+    size_t Channels() const override { return kChannels; }
+
+    void Push(const float* interleaved, size_t frames) {
+        if (running_ && callback_) {
+            callback_(interleaved, frames, CaptureTimestamp());
+        }
+    }
+
+private:
+    bool running_ = false;
+};
+
+enum class Content {
+    Speech,    // 底噪上叠加 200ms 通断的谐波
+    Silence,   // 约 -80dBFS 的底噪
+    Ramp       // 整数精确的锯齿，按帧序号可以还原位置
+};
+
+// 第 frame 帧开始的 frames 帧
+void Generate(Content content, uint64_t frame, size_t frames, std::mt19937& rng, float* out) {
+    std::normal_distribution<float> noise(0.0f, content == Content::Speech ? 0.01f : 0.0001f);
+    for (size_t i = 0; i < frames; ++i) {
+        const uint64_t n = frame + i;
+        for (size_t ch = 0; ch < kChannels; ++ch) {
+            float value = 0.0f;
+            if (content == Content::Ramp) {
+                // FloatToInt16 按 32767 缩放，|k| < 8192 时 float -> int16 -> float 往返精确
+                value = static_cast<float>(static_cast<int>((n + ch * 1000) % 16384) - 8192) / 32768.0f;
+            } else {
+                value = noise(rng);
+                if (content == Content::Speech && (n / (kSampleRate / 5)) % 2 == 0) {
+                    const double t = static_cast<double>(n) / kSampleRate;
+                    for (int harmonic = 1; harmonic <= 5; ++harmonic) {
+                        value += 0.05f / harmonic *
+                                 static_cast<float>(std::sin(2.0 * M_PI * (180.0 + 20.0 * ch) * harmonic * t));
+                    }
+                }
+            }
+            out[i * kChannels + ch] = value;
+        }
+    }
+}
+
+// 按倍速推送 seconds 秒，从第 frame 帧开始，返回推送后的帧位置
+uint64_t Feed(PushBackend* backend, Content content, uint64_t frame, double seconds, double speed) {
+    std::mt19937 rng(static_cast<uint32_t>(frame + 1));
+    std::vector<float> block(kPushFrames * kChannels);
+    const size_t blocks = static_cast<size_t>(seconds * 100);
+    const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(0.01 / speed));
+    auto next = Clock::now();
+    for (size_t i = 0; i < blocks; ++i) {
+        Generate(content, frame, kPushFrames, rng, block.data());
+        backend->Push(block.data(), kPushFrames);
+        frame += kPushFrames;
+        next += period;
+        std::this_thread::sleep_until(next);
+    }
+    return frame;
+}
+
+struct Fixture {
+    PushBackend* backend;
+    std::shared_ptr<CaptureEngine> engine;
+
+    Fixture() {
+        std::unique_ptr<PushBackend> owned(new PushBackend());
+        backend = owned.get();
+        CaptureEngine::Options options;
+        options.bufferMilliseconds = 10000;
+        engine = CaptureEngine::Create(std::move(owned), options);
+    }
+};
+
+PrerollBuffer::Options MakeOptions(PrerollBuffer::Codec codec, double seconds) {
+    PrerollBuffer::Options options;
+    options.codec = codec;
+    options.seconds = seconds;
+    options.pollMilliseconds = 5;
+    return options;
+}
+
+// 等预录线程和录音线程各轮询几次，读完已推送的数据
+void Settle() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+}
+
+bool RunMemory(double speed) {
+    printf("每分钟内存（保留 60 秒，推送 70 秒）\n");
+    printf("%-10s %-8s %10s %10s %10s %12s %10s\n", "codec", "content", "MB/min", "alloc MB", "vs int16",
+           "encode ns/f", "dropped");
+    bool ok = true;
+    for (PrerollBuffer::Codec codec : {PrerollBuffer::Codec::Int16, PrerollBuffer::Codec::Compressed}) {
+        for (Content content : {Content::Speech, Content::Silence}) {
+            Fixture fixture;
+            PrerollBuffer preroll(fixture.engine, MakeOptions(codec, 60.0));
+            Feed(fixture.backend, content, 0, 70.0, speed);
+            Settle();
+            const PrerollBuffer::Stats stats = preroll.GetStats();
+            const double minutes = static_cast<double>(stats.historyFrames) / kSampleRate / 60.0;
+            const double mbPerMinute = stats.bytesUsed / minutes / (1 << 20);
+            const double int16PerMinute = 60.0 * kSampleRate * kChannels * 2 / static_cast<double>(1 << 20);
+            printf("%-10s %-8s %10.2f %10.2f %9.0f%% %12.1f %10llu\n",
+                   codec == PrerollBuffer::Codec::Int16 ? "int16" : "compressed",
+                   content == Content::Speech ? "speech" : "silence", mbPerMinute,
+                   stats.bytesAllocated / static_cast<double>(1 << 20), mbPerMinute / int16PerMinute * 100.0,
+                   stats.encodedFrames ? static_cast<double>(stats.encodeNanos) / stats.encodedFrames : 0.0,
+                   static_cast<unsigned long long>(stats.droppedSamples));
+            ok &= stats.droppedSamples == 0;
+        }
+    }
+    return ok;
+}
+
+bool RunSplice(double speed) {
+    printf("\n拼接耗时（保留 5 分钟类语音信号，解码到空 sink）\n");
+    printf("%-10s %10s %12s %12s\n", "codec", "seconds", "splice ms", "x realtime");
+    bool ok = true;
+    for (PrerollBuffer::Codec codec : {PrerollBuffer::Codec::Int16, PrerollBuffer::Codec::Compressed}) {
+        Fixture fixture;
+        PrerollBuffer preroll(fixture.engine, MakeOptions(codec, 300.0));
+        const uint64_t end = Feed(fixture.backend, Content::Speech, 0, 300.0, speed);
+        Settle();
+        for (double seconds : {60.0, 120.0, 300.0}) {
+            uint64_t frames = 0;
+            const auto t0 = Clock::now();
+            preroll.Splice(end, seconds, [&frames](const float*, size_t count) {
+                frames += count;
+                return true;
+            });
+            const double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+            printf("%-10s %10.0f %12.2f %12.0f\n", codec == PrerollBuffer::Codec::Int16 ? "int16" : "compressed",
+                   seconds, ms, seconds * 1000.0 / ms);
+            const uint64_t want = static_cast<uint64_t>(seconds * kSampleRate);
+            if (frames != want) {
+                fprintf(stderr, "拼接 %.0f 秒得到 %llu 帧，应为 %llu 帧\n", seconds,
+                        static_cast<unsigned long long>(frames), static_cast<unsigned long long>(want));
+                ok = false;
+            }
+        }
+        ok &= preroll.GetStats().droppedSamples == 0;
+    }
+    return ok;
+}
+
+bool RunJunction(double speed) {
+    const std::string path = "/tmp/preroll_bench_" + std::to_string(getpid()) + ".wav";
+    Fixture fixture;
+    PrerollBuffer preroll(fixture.engine, MakeOptions(PrerollBuffer::Codec::Compressed, 10.0));
+    uint64_t frame = Feed(fixture.backend, Content::Ramp, 0, 15.0, speed);
+    Settle();
+
+    CaptureRecording recording(fixture.engine);
+    CaptureRecording::Options options;
+    options.preroll = std::shared_ptr<PrerollBuffer>(&preroll, [](PrerollBuffer*) {});
+    options.prerollSeconds = 5.0;
+    if (!recording.Start(path, options)) {
+        return false;
+    }
+    frame = Feed(fixture.backend, Content::Ramp, frame, 2.0, speed);
+    Settle();
+    recording.Stop();
+    const CaptureRecording::Stats stats = recording.GetStats();
+
+    WavFileReader reader;
+    bool ok = reader.Open(path) && reader.Frames() == 7 * kSampleRate;
+    uint64_t mismatches = 0;
+    if (ok) {
+        std::vector<float> expected(kSampleRate * kChannels);
+        std::vector<float> actual(kSampleRate * kChannels);
+        std::mt19937 rng;
+        for (uint64_t offset = 0; offset < reader.Frames(); offset += kSampleRate) {
+            const size_t frames = reader.Read(offset, actual.data(), kSampleRate);
+            Generate(Content::Ramp, stats.startFrame + offset, frames, rng, expected.data());
+            for (size_t i = 0; i < frames * kChannels; ++i) {
+                mismatches += actual[i] != expected[i];
+            }
+        }
+        ok = mismatches == 0 && stats.startFrame == 10 * kSampleRate;
+    }
+    printf("\n接缝：预录 %llu 帧 + 实时 %llu 帧，文件 %llu 帧，起点 %.2f 秒，不一致样本 %llu -> %s\n",
+           static_cast<unsigned long long>(stats.prerollFrames), static_cast<unsigned long long>(stats.liveFrames),
+           static_cast<unsigned long long>(reader.Frames()), static_cast<double>(stats.startFrame) / kSampleRate,
+           static_cast<unsigned long long>(mismatches), ok ? "连续" : "不连续");
+    reader.Close();
+    unlink(path.c_str());
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double speed = argc > 1 ? atof(argv[1]) : 50.0;
+    printf("48kHz 立体声, %.0f 倍速推送\n\n", speed);
+    bool ok = RunMemory(speed);
+    ok &= RunSplice(speed);
+    ok &= RunJunction(speed);
+    return ok ? 0 : 1;
+}
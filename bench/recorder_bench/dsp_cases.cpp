@@ -0,0 +1,168 @@
+// DSP 处理级每 10ms 帧的耗时：AEC3（EchoCancellationStage）、噪声抑制、高通、agc2 限幅器，
+// 以及系统音频的漂移补偿重采样。输入为带回声的合成语音，48kHz
+
+#include "drift_compensating_resampler.h"
+#include "echo_cancellation_stage.h"
+#include "harness.h"
+#include "modules/audio_processing/agc2/limiter.h"
+#include "modules/audio_processing/audio_buffer.h"
+#include "modules/audio_processing/high_pass_filter.h"
+#include "modules/audio_processing/include/audio_processing.h"
+#include "modules/audio_processing/logging/apm_data_dumper.h"
+#include "modules/audio_processing/ns/noise_suppressor.h"
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr int kSampleRate = 48000;
+constexpr size_t kFrameSize = kSampleRate / 100;
+// 预先生成的信号长度，循环使用
+constexpr size_t kSignalFrames = 100;
+
+// 调幅的谐波信号加白噪声，近似语音的能量起伏
+std::vector<float> MakeSpeechLike(size_t samples, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> noise(0.0f, 0.01f);
+    std::vector<float> data(samples);
+    for (size_t i = 0; i < samples; ++i) {
+        const double t = static_cast<double>(i) / kSampleRate;
+        const double envelope = 0.5 + 0.5 * std::sin(2.0 * M_PI * 3.0 * t);
+        const double voice = std::sin(2.0 * M_PI * 180.0 * t) + 0.5 * std::sin(2.0 * M_PI * 360.0 * t) +
+                             0.25 * std::sin(2.0 * M_PI * 720.0 * t);
+        data[i] = static_cast<float>(0.2 * envelope * voice) + noise(rng);
+    }
+    return data;
+}
+
+void EchoCancellation(bench::State& state) {
+    EchoCancellationStage stage;
+    EchoCancellationStage::Options options;
+    options.sampleRate = kSampleRate;
+    options.renderChannels = 2;
+    options.captureChannels = 1;
+    if (!stage.Initialize(options)) {
+        state.SkipWithError("EchoCancellationStage 初始化失败");
+        return;
+    }
+
+    // 远端为立体声合成语音，近端为延迟 20ms、衰减后的远端加本地噪声
+    const std::vector<float> far = MakeSpeechLike(kSignalFrames * kFrameSize, 1);
+    const std::vector<float> local = MakeSpeechLike(kSignalFrames * kFrameSize, 2);
+    std::vector<float> render(kSignalFrames * kFrameSize * 2);
+    std::vector<float> capture(kSignalFrames * kFrameSize);
+    const size_t delay = kSampleRate / 50;
+    for (size_t i = 0; i < far.size(); ++i) {
+        render[i * 2] = render[i * 2 + 1] = far[i];
+        capture[i] = 0.3f * far[(i + far.size() - delay) % far.size()] + 0.1f * local[i];
+    }
+
+    std::vector<float> frame(kFrameSize);
+    float* planes[1] = {frame.data()};
+    size_t index = 0;
+    while (state.KeepRunning()) {
+        const size_t offset = (index++ % kSignalFrames) * kFrameSize;
+        std::copy(capture.begin() + offset, capture.begin() + offset + kFrameSize, frame.begin());
+        stage.AnalyzeRender(render.data() + offset * 2, kFrameSize);
+        stage.ProcessCapture(planes, kFrameSize);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetCounter("realtime_factor", 0.01 * state.iterations() / state.CpuSeconds());
+}
+
+// 噪声抑制与 AudioProcessingImpl 中的调用顺序一致：分频后先 Analyze 再 Process
+void NoiseSuppression(bench::State& state, webrtc::NsConfig::SuppressionLevel level) {
+    webrtc::NsConfig config;
+    config.target_level = level;
+    webrtc::NoiseSuppressor ns(config, kSampleRate, 1);
+    webrtc::AudioBuffer buffer(kSampleRate, 1, kSampleRate, 1, kSampleRate, 1);
+    const webrtc::StreamConfig streamConfig(kSampleRate, 1);
+
+    const std::vector<float> signal = MakeSpeechLike(kSignalFrames * kFrameSize, 3);
+    std::vector<float> output(kFrameSize);
+    float* outputPlanes[1] = {output.data()};
+    size_t index = 0;
+    while (state.KeepRunning()) {
+        const float* input[1] = {signal.data() + (index++ % kSignalFrames) * kFrameSize};
+        buffer.CopyFrom(input, streamConfig);
+        buffer.SplitIntoFrequencyBands();
+        ns.Analyze(buffer);
+        ns.Process(&buffer);
+        buffer.MergeFrequencyBands();
+        buffer.CopyTo(streamConfig, outputPlanes);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetCounter("realtime_factor", 0.01 * state.iterations() / state.CpuSeconds());
+}
+
+void HighPass(bench::State& state) {
+    webrtc::HighPassFilter filter(kSampleRate, 1);
+    const std::vector<float> signal = MakeSpeechLike(kSignalFrames * kFrameSize, 4);
+    std::vector<std::vector<float>> frame(1, std::vector<float>(kFrameSize));
+    size_t index = 0;
+    while (state.KeepRunning()) {
+        const size_t offset = (index++ % kSignalFrames) * kFrameSize;
+        std::copy(signal.begin() + offset, signal.begin() + offset + kFrameSize, frame[0].begin());
+        filter.Process(&frame);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// agc2 限幅器按 int16 量级的浮点样本工作
+void Limiter(bench::State& state) {
+    webrtc::ApmDataDumper dumper(0);
+    webrtc::Limiter limiter(kSampleRate, &dumper, "Bench");
+    std::vector<float> signal = MakeSpeechLike(kSignalFrames * kFrameSize * 2, 5);
+    for (float& sample : signal) {
+        sample *= 32768.0f * 4.0f;
+    }
+    std::vector<float> left(kFrameSize);
+    std::vector<float> right(kFrameSize);
+    float* planes[2] = {left.data(), right.data()};
+    size_t index = 0;
+    while (state.KeepRunning()) {
+        const size_t offset = (index++ % kSignalFrames) * kFrameSize;
+        std::copy(signal.begin() + offset, signal.begin() + offset + kFrameSize, left.begin());
+        std::copy(signal.begin() + offset, signal.begin() + offset + kFrameSize, right.begin());
+        limiter.Process(webrtc::AudioFrameView<float>(planes, 2, kFrameSize));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// 44.1kHz 系统音频以 10ms 为单位推入，按 48kHz 会话时钟拉出
+void DriftResampler(bench::State& state) {
+    DriftCompensatingResampler resampler;
+    DriftCompensatingResampler::Options options;
+    options.inputRate = 44100;
+    options.outputRate = kSampleRate;
+    options.channels = 2;
+    if (!resampler.Initialize(options)) {
+        state.SkipWithError("DriftCompensatingResampler 初始化失败");
+        return;
+    }
+    const size_t inputFrames = 441;
+    const std::vector<float> input(inputFrames * 2, 0.25f);
+    std::vector<float> output(kFrameSize * 2);
+    while (state.KeepRunning()) {
+        resampler.Push(input.data(), inputFrames);
+        resampler.Pull(output.data(), kFrameSize);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetCounter("underruns", static_cast<double>(resampler.GetStats().underruns));
+}
+
+RECORDER_BENCH_REGISTER([] {
+    bench::Register("DSP/EchoCancellation/48k", EchoCancellation);
+    bench::Register("DSP/NoiseSuppression/48k/k12dB", [](bench::State& state) {
+        NoiseSuppression(state, webrtc::NsConfig::SuppressionLevel::k12dB);
+    });
+    bench::Register("DSP/NoiseSuppression/48k/k21dB", [](bench::State& state) {
+        NoiseSuppression(state, webrtc::NsConfig::SuppressionLevel::k21dB);
+    });
+    bench::Register("DSP/HighPassFilter/48k", HighPass);
+    bench::Register("DSP/Limiter/48k", Limiter);
+    bench::Register("DSP/DriftResampler/44k1To48k", DriftResampler);
+});
+
+} // namespace
@@ -0,0 +1,367 @@
+#include "harness.h"
+#include "audio_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <regex>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace bench {
+
+namespace {
+
+struct Entry {
+    std::string name;
+    Function function;
+    Options options;
+};
+
+struct Result {
+    std::string name;
+    uint64_t iterations = 0;
+    double realNanos = 0.0;   // 每次迭代
+    double cpuNanos = 0.0;
+    double bytesPerSecond = 0.0;
+    double itemsPerSecond = 0.0;
+    std::map<std::string, double> counters;
+    std::string error;
+};
+
+struct Flags {
+    std::string filter = ".*";
+    double minSeconds = 0.2;
+    int repetitions = 3;
+    std::string jsonPath;
+    bool list = false;
+};
+
+std::vector<Entry>& Registry() {
+    static std::vector<Entry> registry;
+    return registry;
+}
+
+std::string& TmpfsDir() {
+    static std::string dir;
+    return dir;
+}
+
+std::string& DiskDir() {
+    static std::string dir;
+    return dir;
+}
+
+double ProcessCpuSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+}
+
+bool IsWritableDirectory(const std::string& path) {
+    return !path.empty() && access(path.c_str(), W_OK) == 0;
+}
+
+bool ParseFlags(int argc, char** argv, Flags& flags) {
+#if defined(__linux__)
+    TmpfsDir() = IsWritableDirectory("/dev/shm") ? "/dev/shm" : "";
+#endif
+    DiskDir() = ".";
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto value = [&](const char* prefix) -> const char* {
+            const size_t n = strlen(prefix);
+            return arg.compare(0, n, prefix) == 0 ? argv[i] + n : nullptr;
+        };
+        if (const char* v = value("--filter=")) {
+            flags.filter = v;
+        } else if (const char* v = value("--min_time=")) {
+            flags.minSeconds = atof(v);
+        } else if (const char* v = value("--repetitions=")) {
+            flags.repetitions = std::max(1, atoi(v));
+        } else if (const char* v = value("--json=")) {
+            flags.jsonPath = v;
+        } else if (const char* v = value("--tmpfs_dir=")) {
+            TmpfsDir() = v;
+        } else if (const char* v = value("--disk_dir=")) {
+            DiskDir() = v;
+        } else if (arg == "--list") {
+            flags.list = true;
+        } else {
+            fprintf(stderr,
+                    "用法: %s [--filter=正则] [--min_time=秒] [--repetitions=N] [--json=路径|-]\n"
+                    "          [--tmpfs_dir=目录] [--disk_dir=目录] [--list]\n", argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+Result Summarize(const std::string& name, const std::vector<State>& runs) {
+    Result result;
+    result.name = name;
+    // 按每次迭代的墙钟时间取中位数
+    std::vector<size_t> order(runs.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return runs[a].RealSeconds() / runs[a].iterations() < runs[b].RealSeconds() / runs[b].iterations();
+    });
+    const State& median = runs[order[order.size() / 2]];
+    result.iterations = median.iterations();
+    result.realNanos = median.RealSeconds() * 1e9 / median.iterations();
+    result.cpuNanos = median.CpuSeconds() * 1e9 / median.iterations();
+    if (median.RealSeconds() > 0.0) {
+        result.bytesPerSecond = static_cast<double>(median.BytesProcessed()) / median.RealSeconds();
+        result.itemsPerSecond = static_cast<double>(median.ItemsProcessed()) / median.RealSeconds();
+    }
+    result.counters = median.Counters();
+    return result;
+}
+
+Result RunOne(const Entry& entry, const Flags& flags) {
+    const double minSeconds = entry.options.minSeconds > 0.0 ? entry.options.minSeconds : flags.minSeconds;
+    const int repetitions = entry.options.repetitions > 0 ? entry.options.repetitions : flags.repetitions;
+
+    // 迭代次数按上一轮耗时放大，直到单次运行超过最短时长
+    uint64_t iterations = 1;
+    std::vector<State> runs;
+    while (true) {
+        State state(iterations);
+        entry.function(state);
+        if (!state.Error().empty()) {
+            Result result;
+            result.name = entry.name;
+            result.error = state.Error();
+            return result;
+        }
+        if (state.RealSeconds() >= minSeconds || iterations >= 1000000000ull) {
+            runs.push_back(state);
+            break;
+        }
+        const double scale = state.RealSeconds() > 0.0 ? minSeconds / state.RealSeconds() * 1.4 : 10.0;
+        iterations = static_cast<uint64_t>(std::ceil(iterations * std::min(10.0, std::max(1.5, scale))));
+    }
+    while (static_cast<int>(runs.size()) < repetitions) {
+        State state(iterations);
+        entry.function(state);
+        runs.push_back(state);
+    }
+    return Summarize(entry.name, runs);
+}
+
+std::string FormatTime(double nanos) {
+    char buffer[32];
+    if (nanos >= 1e6) {
+        snprintf(buffer, sizeof(buffer), "%.2f ms", nanos / 1e6);
+    } else if (nanos >= 1e3) {
+        snprintf(buffer, sizeof(buffer), "%.2f us", nanos / 1e3);
+    } else {
+        snprintf(buffer, sizeof(buffer), "%.1f ns", nanos);
+    }
+    return buffer;
+}
+
+std::string FormatRate(const Result& result) {
+    char buffer[48];
+    if (result.bytesPerSecond > 0.0) {
+        snprintf(buffer, sizeof(buffer), "%.2f GB/s", result.bytesPerSecond / 1e9);
+    } else if (result.itemsPerSecond > 0.0) {
+        snprintf(buffer, sizeof(buffer), "%.3g items/s", result.itemsPerSecond);
+    } else {
+        buffer[0] = '\0';
+    }
+    return buffer;
+}
+
+void PrintResult(FILE* out, const Result& result) {
+    if (!result.error.empty()) {
+        fprintf(out, "%-48s 跳过: %s\n", result.name.c_str(), result.error.c_str());
+        return;
+    }
+    fprintf(out, "%-48s %12s %12s %12llu %16s", result.name.c_str(), FormatTime(result.realNanos).c_str(),
+            FormatTime(result.cpuNanos).c_str(), static_cast<unsigned long long>(result.iterations),
+            FormatRate(result).c_str());
+    for (const auto& counter : result.counters) {
+        fprintf(out, " %s=%.4g", counter.first.c_str(), counter.second);
+    }
+    fprintf(out, "\n");
+}
+
+std::string JsonEscape(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        switch (c) {
+        case '"': escaped += "\\\""; break;
+        case '\\': escaped += "\\\\"; break;
+        case '\n': escaped += "\\n"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buffer[8];
+                snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                escaped += buffer;
+            } else {
+                escaped += c;
+            }
+        }
+    }
+    return escaped;
+}
+
+// 字段命名与 Google Benchmark 的 JSON 输出一致，现有的分析工具可以直接读取
+bool WriteJson(const std::string& path, const char* executable, const std::vector<Result>& results) {
+    FILE* out = path == "-" ? stdout : fopen(path.c_str(), "w");
+    if (!out) {
+        fprintf(stderr, "无法写入 %s\n", path.c_str());
+        return false;
+    }
+    char host[256] = {0};
+    gethostname(host, sizeof(host) - 1);
+    char date[64];
+    const time_t now = time(nullptr);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", localtime(&now));
+
+    fprintf(out, "{\n  \"context\": {\n");
+    fprintf(out, "    \"date\": \"%s\",\n", date);
+    fprintf(out, "    \"host_name\": \"%s\",\n", JsonEscape(host).c_str());
+    fprintf(out, "    \"executable\": \"%s\",\n", JsonEscape(executable).c_str());
+    fprintf(out, "    \"num_cpus\": %u,\n", std::thread::hardware_concurrency());
+    fprintf(out, "    \"audio_kernels_isa\": \"%s\",\n", AudioKernels::IsaName(AudioKernels::DetectedIsa()));
+#ifdef NDEBUG
+    fprintf(out, "    \"library_build_type\": \"release\"\n");
+#else
+    fprintf(out, "    \"library_build_type\": \"debug\"\n");
+#endif
+    fprintf(out, "  },\n  \"benchmarks\": [");
+    bool first = true;
+    for (const Result& result : results) {
+        fprintf(out, "%s\n    {\n", first ? "" : ",");
+        first = false;
+        fprintf(out, "      \"name\": \"%s\",\n", JsonEscape(result.name).c_str());
+        fprintf(out, "      \"run_name\": \"%s\",\n", JsonEscape(result.name).c_str());
+        fprintf(out, "      \"run_type\": \"iteration\",\n");
+        if (!result.error.empty()) {
+            fprintf(out, "      \"error_occurred\": true,\n");
+            fprintf(out, "      \"error_message\": \"%s\"\n    }", JsonEscape(result.error).c_str());
+            continue;
+        }
+        fprintf(out, "      \"iterations\": %llu,\n", static_cast<unsigned long long>(result.iterations));
+        fprintf(out, "      \"real_time\": %.6g,\n", result.realNanos);
+        fprintf(out, "      \"cpu_time\": %.6g,\n", result.cpuNanos);
+        fprintf(out, "      \"time_unit\": \"ns\"");
+        if (result.bytesPerSecond > 0.0) {
+            fprintf(out, ",\n      \"bytes_per_second\": %.6g", result.bytesPerSecond);
+        }
+        if (result.itemsPerSecond > 0.0) {
+            fprintf(out, ",\n      \"items_per_second\": %.6g", result.itemsPerSecond);
+        }
+        for (const auto& counter : result.counters) {
+            fprintf(out, ",\n      \"%s\": %.6g", JsonEscape(counter.first).c_str(), counter.second);
+        }
+        fprintf(out, "\n    }");
+    }
+    fprintf(out, "\n  ]\n}\n");
+    if (out != stdout) {
+        fclose(out);
+    }
+    return true;
+}
+
+} // namespace
+
+State::State(uint64_t iterations)
+    : iterations_(iterations)
+    , remaining_(iterations)
+    , started_(false)
+    , running_(false)
+    , cpuStart_(0.0)
+    , realSeconds_(0.0)
+    , cpuSeconds_(0.0)
+    , bytes_(0)
+    , items_(0) {
+}
+
+void State::Start() {
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    realStart_ = std::chrono::steady_clock::now();
+    cpuStart_ = ProcessCpuSeconds();
+}
+
+void State::Stop() {
+    if (!running_) {
+        return;
+    }
+    running_ = false;
+    realSeconds_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - realStart_).count();
+    cpuSeconds_ += ProcessCpuSeconds() - cpuStart_;
+}
+
+void State::PauseTiming() {
+    Stop();
+}
+
+void State::ResumeTiming() {
+    Start();
+}
+
+void Register(const std::string& name, Function function, const Options& options) {
+    Registry().push_back({name, std::move(function), options});
+}
+
+const std::string& TmpfsDirectory() {
+    return TmpfsDir();
+}
+
+const std::string& DiskDirectory() {
+    return DiskDir();
+}
+
+int RunAll(int argc, char** argv) {
+    Flags flags;
+    if (!ParseFlags(argc, argv, flags)) {
+        return 2;
+    }
+    std::regex filter;
+    try {
+        filter = std::regex(flags.filter);
+    } catch (const std::regex_error&) {
+        fprintf(stderr, "过滤表达式无效: %s\n", flags.filter.c_str());
+        return 2;
+    }
+
+    // JSON 输出到标准输出时，表格改写到标准错误
+    FILE* console = flags.jsonPath == "-" ? stderr : stdout;
+    if (!flags.list) {
+        fprintf(console, "%-48s %12s %12s %12s %16s\n", "benchmark", "time", "cpu", "iterations", "throughput");
+    }
+
+    std::vector<Result> results;
+    for (const Entry& entry : Registry()) {
+        if (!std::regex_search(entry.name, filter)) {
+            continue;
+        }
+        if (flags.list) {
+            fprintf(console, "%s\n", entry.name.c_str());
+            continue;
+        }
+        results.push_back(RunOne(entry, flags));
+        PrintResult(console, results.back());
+        fflush(console);
+    }
+
+    if (!flags.jsonPath.empty() && !flags.list) {
+        if (!WriteJson(flags.jsonPath, argv[0], results)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+} // namespace bench
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+
+// recorder_bench 使用的轻量基准框架，接口仿照 Google Benchmark：
+//
+//   RECORDER_BENCH_REGISTER([] {
+//       bench::Register("RingBuffer/WriteRead/256", [](bench::State& state) {
+//           ...准备工作（不计时）...
+//           while (state.KeepRunning()) {
+//               ...被测代码...
+//           }
+//           state.SetBytesProcessed(state.iterations() * 256 * sizeof(float));
+//       });
+//   });
+//
+// 框架自动调整迭代次数直到单次运行超过最短时长，重复多次取中位数，输出控制台表格和 JSON
+namespace bench {
+
+class State {
+public:
+    explicit State(uint64_t iterations);
+
+    // 第一次调用开始计时，完成 iterations() 次迭代后停止计时并返回 false
+    bool KeepRunning() {
+        if (!started_) {
+            started_ = true;
+            Start();
+        }
+        if (remaining_ == 0) {
+            Stop();
+            return false;
+        }
+        --remaining_;
+        return true;
+    }
+
+    uint64_t iterations() const { return iterations_; }
+
+    // 排除迭代内的准备工作
+    void PauseTiming();
+    void ResumeTiming();
+
+    void SetBytesProcessed(uint64_t bytes) { bytes_ = bytes; }
+    void SetItemsProcessed(uint64_t items) { items_ = items; }
+
+    // 自定义指标（例如延迟分位数），原样写入结果
+    void SetCounter(const std::string& name, double value) { counters_[name] = value; }
+
+    // 环境不满足（目录不可写、指令集不支持等）时跳过，并给出原因
+    void SkipWithError(const std::string& message) { error_ = message; }
+
+    double RealSeconds() const { return realSeconds_; }
+    double CpuSeconds() const { return cpuSeconds_; }
+    uint64_t BytesProcessed() const { return bytes_; }
+    uint64_t ItemsProcessed() const { return items_; }
+    const std::map<std::string, double>& Counters() const { return counters_; }
+    const std::string& Error() const { return error_; }
+
+private:
+    void Start();
+    void Stop();
+
+    uint64_t iterations_;
+    uint64_t remaining_;
+    bool started_;
+    bool running_;
+    std::chrono::steady_clock::time_point realStart_;
+    double cpuStart_;
+    double realSeconds_;
+    double cpuSeconds_;
+    uint64_t bytes_;
+    uint64_t items_;
+    std::map<std::string, double> counters_;
+    std::string error_;
+};
+
+using Function = std::function<void(State&)>;
+
+struct Options {
+    double minSeconds = 0.0;   // 0 使用全局 --min_time
+    int repetitions = 0;       // 0 使用全局 --repetitions
+};
+
+void Register(const std::string& name, Function function, const Options& options = Options());
+
+// 运行所有注册的基准，返回进程退出码
+int RunAll(int argc, char** argv);
+
+// 各基准文件的共享参数
+// WAV 写盘基准使用的 tmpfs 目录和磁盘目录，空字符串表示跳过
+const std::string& TmpfsDirectory();
+const std::string& DiskDirectory();
+
+// 阻止编译器把被测循环里没有后续读取的写入当作死代码删除
+inline void ClobberMemory() {
+    asm volatile("" : : : "memory");
+}
+
+} // namespace bench
+
+#define RECORDER_BENCH_CONCAT_INNER(a, b) a##b
+#define RECORDER_BENCH_CONCAT(a, b) RECORDER_BENCH_CONCAT_INNER(a, b)
+
+// 在静态初始化阶段执行注册函数
+// 变参是为了让 lambda 体里的逗号不被预处理器拆开
+#define RECORDER_BENCH_REGISTER(...) \
+    static const int RECORDER_BENCH_CONCAT(recorderBenchRegistered_, __LINE__) = ((__VA_ARGS__)(), 0)
@@ -0,0 +1,174 @@
+// AudioKernels 各内核在每种可用指令集上的吞吐，以及录音管线里的混音循环
+// 块大小取 1024 帧立体声，与 IOProc 常见的回调大小一致
+
+#include "audio_kernels.h"
+#include "harness.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+
+using AudioKernels::Isa;
+
+constexpr size_t kFrames = 1024;
+constexpr size_t kChannels = 2;
+constexpr size_t kSamples = kFrames * kChannels;
+
+std::vector<float> MakeSignal(size_t samples) {
+    std::vector<float> data(samples);
+    for (size_t i = 0; i < samples; ++i) {
+        data[i] = static_cast<float>(static_cast<int>(i * 2654435761u % 2001) - 1000) / 1000.0f;
+    }
+    return data;
+}
+
+// 依次切换到指定指令集运行 body，结束后恢复自动选择的实现
+template <typename Body>
+void WithIsa(bench::State& state, Isa isa, Body body) {
+    if (!AudioKernels::SetIsa(isa)) {
+        state.SkipWithError(std::string("CPU 不支持 ") + AudioKernels::IsaName(isa));
+        return;
+    }
+    body();
+    AudioKernels::SetIsa(AudioKernels::DetectedIsa());
+}
+
+void RegisterKernels(Isa isa) {
+    const std::string suffix = std::string("/") + AudioKernels::IsaName(isa);
+
+    bench::Register("Kernels/Interleave" + suffix, [isa](bench::State& state) {
+        const std::vector<float> input = MakeSignal(kSamples);
+        std::vector<float> output(kSamples);
+        const float* planes[kChannels] = {input.data(), input.data() + kFrames};
+        WithIsa(state, isa, [&] {
+            while (state.KeepRunning()) {
+                AudioKernels::Interleave(planes, output.data(), kChannels, kFrames);
+            }
+        });
+        state.SetBytesProcessed(state.iterations() * kSamples * sizeof(float));
+    });
+
+    bench::Register("Kernels/Deinterleave" + suffix, [isa](bench::State& state) {
+        const std::vector<float> input = MakeSignal(kSamples);
+        std::vector<float> output(kSamples);
+        float* planes[kChannels] = {output.data(), output.data() + kFrames};
+        WithIsa(state, isa, [&] {
+            while (state.KeepRunning()) {
+                AudioKernels::Deinterleave(input.data(), planes, kChannels, kFrames);
+            }
+        });
+        state.SetBytesProcessed(state.iterations() * kSamples * sizeof(float));
+    });
+
+    bench::Register("Kernels/FloatToInt16" + suffix, [isa](bench::State& state) {
+        const std::vector<float> input = MakeSignal(kSamples);
+        std::vector<int16_t> output(kSamples);
+        WithIsa(state, isa, [&] {
+            while (state.KeepRunning()) {
+                AudioKernels::FloatToInt16(input.data(), output.data(), kSamples);
+            }
+        });
+        state.SetBytesProcessed(state.iterations() * kSamples * sizeof(float));
+    });
+
+    bench::Register("Kernels/FloatToInt16Dither" + suffix, [isa](bench::State& state) {
+        const std::vector<float> input = MakeSignal(kSamples);
+        std::vector<int16_t> output(kSamples);
+        AudioKernels::DitherState dither;
+        WithIsa(state, isa, [&] {
+            while (state.KeepRunning()) {
+                AudioKernels::FloatToInt16(input.data(), output.data(), kSamples, &dither);
+            }
+        });
+        state.SetBytesProcessed(state.iterations() * kSamples * sizeof(float));
+    });
+
+    bench::Register("Kernels/FloatToInt24" + suffix, [isa](bench::State& state) {
+        const std::vector<float> input = MakeSignal(kSamples);
+        std::vector<uint8_t> output(kSamples * 3);
+        WithIsa(state, isa, [&] {
+            while (state.KeepRunning()) {
+                AudioKernels::FloatToInt24(input.data(), output.data(), kSamples);
+            }
+        });
+        state.SetBytesProcessed(state.iterations() * kSamples * sizeof(float));
+    });
+
+    bench::Register("Kernels/Int16ToFloat" + suffix, [isa](bench::State& state) {
+        std::vector<int16_t> input(kSamples);
+        for (size_t i = 0; i < kSamples; ++i) {
+            input[i] = static_cast<int16_t>(i * 40503u);
+        }
+        std::vector<float> output(kSamples);
+        WithIsa(state, isa, [&] {
+            while (state.KeepRunning()) {
+                AudioKernels::Int16ToFloat(input.data(), output.data(), kSamples);
+            }
+        });
+        state.SetBytesProcessed(state.iterations() * kSamples * sizeof(float));
+    });
+
+    bench::Register("Kernels/ApplyGain" + suffix, [isa](bench::State& state) {
+        // 不原地处理，避免样本反复衰减成非规格化数
+        const std::vector<float> input = MakeSignal(kSamples);
+        std::vector<float> output(kSamples);
+        WithIsa(state, isa, [&] {
+            while (state.KeepRunning()) {
+                AudioKernels::ApplyGain(input.data(), output.data(), kSamples, 0.999f);
+            }
+        });
+        state.SetBytesProcessed(state.iterations() * kSamples * sizeof(float));
+    });
+
+    bench::Register("Kernels/StereoToMono" + suffix, [isa](bench::State& state) {
+        const std::vector<float> input = MakeSignal(kSamples);
+        std::vector<float> output(kFrames);
+        WithIsa(state, isa, [&] {
+            while (state.KeepRunning()) {
+                AudioKernels::StereoToMono(input.data(), output.data(), kFrames);
+            }
+        });
+        state.SetBytesProcessed(state.iterations() * kSamples * sizeof(float));
+    });
+
+    bench::Register("Kernels/MonoToStereo" + suffix, [isa](bench::State& state) {
+        const std::vector<float> input = MakeSignal(kFrames);
+        std::vector<float> output(kSamples);
+        WithIsa(state, isa, [&] {
+            while (state.KeepRunning()) {
+                AudioKernels::MonoToStereo(input.data(), output.data(), kFrames);
+            }
+        });
+        state.SetBytesProcessed(state.iterations() * kSamples * sizeof(float));
+    });
+}
+
+RECORDER_BENCH_REGISTER([] {
+    for (Isa isa : {Isa::Scalar, Isa::SSE2, Isa::AVX2, Isa::NEON}) {
+        // 只注册当前 CPU 支持的实现，避免结果里出现无意义的跳过项
+        if (!AudioKernels::SetIsa(isa)) {
+            continue;
+        }
+        RegisterKernels(isa);
+    }
+    AudioKernels::SetIsa(AudioKernels::DetectedIsa());
+
+    // 麦克风（单声道转立体声后）与系统音频等权混合，与 HeadlessRecorder/av_engine_taps 的渲染回调相同
+    bench::Register("Mix/MicSystem/1024", [](bench::State& state) {
+        const std::vector<float> mic = MakeSignal(kFrames);
+        const std::vector<float> system = MakeSignal(kSamples);
+        std::vector<float> micStereo(kSamples);
+        std::vector<float> mix(kSamples);
+        while (state.KeepRunning()) {
+            AudioKernels::MonoToStereo(mic.data(), micStereo.data(), kFrames);
+            for (size_t i = 0; i < kSamples; ++i) {
+                mix[i] = 0.5f * (micStereo[i] + system[i]);
+            }
+            bench::ClobberMemory();
+        }
+        state.SetBytesProcessed(state.iterations() * kSamples * sizeof(float));
+    });
+});
+
+} // namespace
@@ -0,0 +1,18 @@
+// recorder_bench：采集到写盘热路径的基准套件
+//
+// 用法:
+//   recorder_bench [--filter=正则] [--min_time=秒] [--repetitions=N] [--json=路径|-]
+//                  [--tmpfs_dir=目录] [--disk_dir=目录] [--list]
+//
+// JSON 输出与 Google Benchmark 格式兼容，可用 scripts/compare-bench.js 对比两次结果
+
+#include "harness.h"
+#include "logger.h"
+
+int main(int argc, char** argv) {
+    Logger::init();
+    Logger::setLevel(Logger::Level::WARN);
+    const int result = bench::RunAll(argc, argv);
+    Logger::shutdown();
+    return result;
+}
@@ -0,0 +1,111 @@
+// RingBuffer：单线程 write+read，以及三种生产者/消费者竞争模式下的吞吐和 write() 延迟
+
+#include "harness.h"
+#include "ring_buffer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 与 SystemCapture 的缓冲区大小一致（44.1k 立体声 4 秒）
+constexpr size_t kCapacity = 352800;
+constexpr size_t kBlocks[] = {32, 256, 1024, 4096};
+
+void WriteRead(bench::State& state, size_t block) {
+    RingBuffer ring(kCapacity);
+    std::vector<float> in(block, 0.5f);
+    std::vector<float> out(block);
+    while (state.KeepRunning()) {
+        ring.write(in.data(), block);
+        ring.read(out.data(), block);
+    }
+    state.SetBytesProcessed(state.iterations() * block * sizeof(float));
+}
+
+enum class Contention {
+    Balanced,        // 消费者持续轮询
+    BurstyConsumer,  // 消费者每 5ms 醒来一次取走全部数据，模拟写线程的批量排空
+    Overflow         // 消费者读得比生产者写得慢，DropOldest 持续覆盖
+};
+
+void ProducerConsumer(bench::State& state, size_t block, Contention contention) {
+    RingBuffer ring(kCapacity, contention == Contention::Overflow ? RingBuffer::OverflowPolicy::DropOldest
+                                                                  : RingBuffer::OverflowPolicy::DropNewest);
+    std::atomic<bool> done(false);
+    std::thread consumer([&] {
+        std::vector<float> out(ring.capacity());
+        while (!done.load(std::memory_order_relaxed)) {
+            switch (contention) {
+            case Contention::Balanced:
+                if (!ring.read(out.data(), block)) {
+                    std::this_thread::yield();
+                }
+                break;
+            case Contention::BurstyConsumer:
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                ring.read(out.data(), ring.available_read());
+                break;
+            case Contention::Overflow:
+                ring.read(out.data(), block / 2);
+                std::this_thread::yield();
+                break;
+            }
+        }
+    });
+
+    std::vector<float> in(block, 0.25f);
+    std::vector<double> latencies;
+    latencies.reserve(std::min<uint64_t>(state.iterations(), 1u << 20));
+    uint64_t accepted = 0;
+    while (state.KeepRunning()) {
+        const auto t0 = Clock::now();
+        accepted += ring.write(in.data(), block) ? 1 : 0;
+        const auto t1 = Clock::now();
+        if (latencies.size() < latencies.capacity()) {
+            latencies.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+        }
+    }
+    done.store(true);
+    consumer.join();
+
+    std::sort(latencies.begin(), latencies.end());
+    if (!latencies.empty()) {
+        state.SetCounter("write_p99_us", latencies[latencies.size() * 99 / 100]);
+        state.SetCounter("write_max_us", latencies.back());
+    }
+    state.SetCounter("accepted_ratio", static_cast<double>(accepted) / static_cast<double>(state.iterations()));
+    // 只计被接受的写入，DropNewest 下被拒绝的块不算吞吐
+    state.SetBytesProcessed(accepted * block * sizeof(float));
+}
+
+RECORDER_BENCH_REGISTER([] {
+    for (size_t block : kBlocks) {
+        bench::Register("RingBuffer/WriteRead/" + std::to_string(block),
+                        [block](bench::State& state) { WriteRead(state, block); });
+    }
+    const struct {
+        const char* name;
+        Contention contention;
+    } patterns[] = {
+        {"Balanced", Contention::Balanced},
+        {"BurstyConsumer", Contention::BurstyConsumer},
+        {"Overflow", Contention::Overflow},
+    };
+    for (const auto& pattern : patterns) {
+        for (size_t block : kBlocks) {
+            const Contention contention = pattern.contention;
+            bench::Register("RingBuffer/" + std::string(pattern.name) + "/" + std::to_string(block),
+                            [block, contention](bench::State& state) {
+                                ProducerConsumer(state, block, contention);
+                            });
+        }
+    }
+});
+
+} // namespace
@@ -0,0 +1,167 @@
+// StreamingWavWriter 写 tmpfs 和真实磁盘的吞吐
+// 每次迭代录制 1 秒 48kHz 立体声：Open、按 10ms 调用 Write、Close（排空队列并写最终头部），
+// 与一次短录音的完整落盘过程相同。tmpfs 结果反映写线程的转换和系统调用开销，磁盘结果再叠加设备带宽；
+// Segmented 为分段模式（写入 mmap 块文件，Close 时封存并拼接成 WAV）
+// ElideSilence 录制 1 分钟近似会议的信号（4 秒语音、6 秒底噪交替），报告静音省略节省的比例和
+// 每音频小时的 VAD CPU 时间
+
+#include "harness.h"
+#include "streaming_wav_writer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t kSampleRate = 48000;
+constexpr uint16_t kChannels = 2;
+constexpr size_t kBlockFrames = kSampleRate / 100;
+constexpr size_t kBlocksPerIteration = 100;
+
+void WriteOneSecond(bench::State& state, const std::string& directory, StreamingWavWriter::SampleFormat format,
+                    uint32_t segmentSeconds) {
+    if (directory.empty()) {
+        state.SkipWithError("没有可用的目录");
+        return;
+    }
+    const std::string path = directory + "/recorder_bench_" + std::to_string(getpid()) + ".wav";
+
+    StreamingWavWriter::Options options;
+    options.sampleRate = kSampleRate;
+    options.channels = kChannels;
+    options.format = format;
+    options.segmentSeconds = segmentSeconds;
+
+    std::vector<float> block(kBlockFrames * kChannels);
+    for (size_t i = 0; i < block.size(); ++i) {
+        block[i] = static_cast<float>(i % 200) / 200.0f - 0.5f;
+    }
+
+    uint64_t dropped = 0;
+    while (state.KeepRunning()) {
+        StreamingWavWriter writer;
+        if (!writer.Open(path, options)) {
+            state.SkipWithError("无法创建 " + path);
+            break;
+        }
+        for (size_t i = 0; i < kBlocksPerIteration; ++i) {
+            writer.Write(block.data(), kBlockFrames);
+        }
+        writer.Close();
+        dropped += writer.DroppedFrames();
+    }
+    unlink(path.c_str());
+
+    const size_t bytesPerSample = format == StreamingWavWriter::SampleFormat::Float32 ? 4 : 2;
+    state.SetBytesProcessed(state.iterations() * kBlocksPerIteration * kBlockFrames * kChannels * bytesPerSample);
+    state.SetCounter("dropped_frames", static_cast<double>(dropped));
+}
+
+constexpr size_t kMeetingSeconds = 60;
+
+// 语音段为 4Hz 音节包络调制的有色噪声，停顿段为 -60dBFS 左右的底噪
+std::vector<float> MeetingSignal() {
+    std::vector<float> signal(kMeetingSeconds * kSampleRate * kChannels);
+    uint32_t noise = 1;
+    float lowpass = 0.0f;
+    for (size_t i = 0; i < kMeetingSeconds * kSampleRate; ++i) {
+        noise ^= noise << 13;
+        noise ^= noise >> 17;
+        noise ^= noise << 5;
+        const float white = static_cast<float>(static_cast<int32_t>(noise)) * (1.0f / 2147483648.0f);
+        lowpass = 0.85f * lowpass + 0.15f * white;
+        const double t = static_cast<double>(i) / kSampleRate;
+        const float syllable = static_cast<float>(0.5 + 0.5 * std::sin(2.0 * M_PI * 4.0 * t));
+        const float v = std::fmod(t, 10.0) < 4.0 ? 0.5f * syllable * lowpass : 0.001f * white;
+        signal[i * kChannels] = v;
+        signal[i * kChannels + 1] = v;
+    }
+    return signal;
+}
+
+void WriteMeeting(bench::State& state, const std::string& directory) {
+    if (directory.empty()) {
+        state.SkipWithError("没有可用的目录");
+        return;
+    }
+    const std::string path = directory + "/recorder_bench_elide_" + std::to_string(getpid()) + ".wav";
+
+    StreamingWavWriter::Options options;
+    options.sampleRate = kSampleRate;
+    options.channels = kChannels;
+    options.format = StreamingWavWriter::SampleFormat::Int16;
+    options.elideSilence = true;
+
+    const std::vector<float> signal = MeetingSignal();
+    const size_t totalFrames = signal.size() / kChannels;
+
+    SilenceElider::Stats total{};
+    while (state.KeepRunning()) {
+        StreamingWavWriter writer;
+        if (!writer.Open(path, options)) {
+            state.SkipWithError("无法创建 " + path);
+            break;
+        }
+        // 一次写入的音频超过队列容量，按队列水位等待写线程
+        for (size_t frame = 0; frame < totalFrames; frame += kBlockFrames) {
+            while (writer.QueuedFrames() > writer.QueueCapacityFrames() / 2) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            writer.Write(signal.data() + frame * kChannels, std::min(kBlockFrames, totalFrames - frame));
+        }
+        writer.Close();
+        SilenceElider::Stats stats;
+        if (writer.GetSilenceStats(&stats)) {
+            total.originalFrames += stats.originalFrames;
+            total.storedFrames += stats.storedFrames;
+            total.cpuNanoseconds += stats.cpuNanoseconds;
+            total.gaps += stats.gaps;
+        }
+    }
+    unlink(path.c_str());
+    unlink(SilenceElider::EditListPath(path).c_str());
+
+    state.SetBytesProcessed(state.iterations() * totalFrames * kChannels * sizeof(int16_t));
+    if (total.originalFrames > 0) {
+        const double hours = static_cast<double>(total.originalFrames) / kSampleRate / 3600.0;
+        state.SetCounter("saved_percent",
+                         (total.originalFrames - total.storedFrames) * 100.0 / total.originalFrames);
+        state.SetCounter("vad_cpu_s_per_hour", total.cpuNanoseconds / 1e9 / hours);
+        state.SetCounter("gaps_per_iteration", static_cast<double>(total.gaps) / state.iterations());
+    }
+}
+
+RECORDER_BENCH_REGISTER([] {
+    const struct {
+        const char* name;
+        StreamingWavWriter::SampleFormat format;
+    } formats[] = {
+        {"Float32", StreamingWavWriter::SampleFormat::Float32},
+        {"Int16", StreamingWavWriter::SampleFormat::Int16},
+    };
+    for (const auto& entry : formats) {
+        const StreamingWavWriter::SampleFormat format = entry.format;
+        // 目录由命令行参数决定，运行时再读取
+        bench::Register(std::string("WavWriter/Tmpfs/") + entry.name, [format](bench::State& state) {
+            WriteOneSecond(state, bench::TmpfsDirectory(), format, 0);
+        });
+        bench::Register(std::string("WavWriter/Disk/") + entry.name, [format](bench::State& state) {
+            WriteOneSecond(state, bench::DiskDirectory(), format, 0);
+        });
+        bench::Register(std::string("WavWriter/Segmented/Tmpfs/") + entry.name, [format](bench::State& state) {
+            WriteOneSecond(state, bench::TmpfsDirectory(), format, 1);
+        });
+        bench::Register(std::string("WavWriter/Segmented/Disk/") + entry.name, [format](bench::State& state) {
+            WriteOneSecond(state, bench::DiskDirectory(), format, 1);
+        });
+    }
+    bench::Register("WavWriter/ElideSilence/Tmpfs/Int16", [](bench::State& state) {
+        WriteMeeting(state, bench::TmpfsDirectory());
+    });
+});
+
+} // namespace
@@ -0,0 +1,291 @@
+// RingBuffer 基准测试：对比无锁 SPSC 实现与原先基于 mutex/condvar 的实现
+// 输出吞吐量（百万样本/秒）以及并发场景下 write() 的最坏延迟；
+// 再对比 CaptureRing 的 float32/int16/int24 存储：内存占用、吞吐量、量化误差，
+// 以及多路录音同时缓冲时（总占用超过缓存）每路的存取开销
+
+#include "capture_ring.h"
+#include "logger.h"
+#include "ring_buffer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 原先的实现（逐样本拷贝 + 取模 + 互斥锁 + 条件变量），仅用于对比
+class LegacyRingBuffer {
+public:
+    explicit LegacyRingBuffer(size_t size)
+        : buffer_(size), read_pos_(0), write_pos_(0), size_(size) {}
+
+    bool write(const float* data, size_t count) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (available_write() < count) {
+            return false;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            buffer_[write_pos_] = data[i];
+            write_pos_ = (write_pos_ + 1) % size_;
+        }
+        cv_.notify_one();
+        return true;
+    }
+
+    bool read(float* data, size_t count) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (available_read() < count) {
+            if (cv_.wait_for(lock, std::chrono::milliseconds(10),
+                             [this, count] { return available_read() >= count; })) {
+                return false;
+            }
+        }
+        for (size_t i = 0; i < count; ++i) {
+            data[i] = buffer_[read_pos_];
+            read_pos_ = (read_pos_ + 1) % size_;
+        }
+        return true;
+    }
+
+private:
+    size_t available_read() const {
+        if (write_pos_ >= read_pos_) {
+            return write_pos_ - read_pos_;
+        }
+        return size_ - read_pos_ + write_pos_;
+    }
+
+    size_t available_write() const {
+        return size_ - available_read() - 1;
+    }
+
+    std::vector<float> buffer_;
+    size_t read_pos_;
+    size_t write_pos_;
+    size_t size_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
+constexpr size_t kCapacity = 352800;
+
+template <typename Ring>
+double SingleThreadThroughput(Ring& ring, size_t block) {
+    std::vector<float> in(block, 0.5f);
+    std::vector<float> out(block);
+    const size_t iterations = std::max<size_t>(1, (64u << 20) / block);
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        ring.write(in.data(), block);
+        ring.read(out.data(), block);
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return static_cast<double>(iterations * block) / seconds / 1e6;
+}
+
+struct ConcurrentResult {
+    double msamples_per_sec;
+    double worst_write_us;
+    double p99_write_us;
+};
+
+template <typename Ring>
+ConcurrentResult ProducerConsumer(Ring& ring, size_t block, double duration_sec) {
+    std::atomic<bool> done(false);
+    std::atomic<size_t> consumed(0);
+
+    std::thread consumer([&] {
+        std::vector<float> out(block);
+        size_t total = 0;
+        while (!done.load(std::memory_order_relaxed)) {
+            if (ring.read(out.data(), block)) {
+                total += block;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        consumed.store(total);
+    });
+
+    std::vector<float> in(block, 0.25f);
+    std::vector<double> latencies;
+    latencies.reserve(1 << 20);
+
+    auto start = Clock::now();
+    auto deadline = start + std::chrono::duration<double>(duration_sec);
+    while (Clock::now() < deadline) {
+        auto t0 = Clock::now();
+        ring.write(in.data(), block);
+        auto t1 = Clock::now();
+        if (latencies.size() < latencies.capacity()) {
+            latencies.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+        }
+    }
+    done.store(true);
+    consumer.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::sort(latencies.begin(), latencies.end());
+    ConcurrentResult result;
+    result.msamples_per_sec = static_cast<double>(consumed.load()) / seconds / 1e6;
+    result.worst_write_us = latencies.empty() ? 0.0 : latencies.back();
+    result.p99_write_us = latencies.empty() ? 0.0 : latencies[latencies.size() * 99 / 100];
+    return result;
+}
+
+// CaptureRing 的测试格式：48kHz 立体声，10ms 一块
+constexpr int kSampleRate = 48000;
+constexpr size_t kChannels = 2;
+constexpr size_t kBlockFrames = 480;
+
+const CaptureRing::Storage kStorages[] = {
+    CaptureRing::Storage::Float32, CaptureRing::Storage::Int16, CaptureRing::Storage::Int24
+};
+
+CaptureRing::Options RingOptions(CaptureRing::Storage storage, uint32_t milliseconds) {
+    CaptureRing::Options options;
+    options.storage = storage;
+    options.capacityMilliseconds = milliseconds;
+    return options;
+}
+
+// 带少量噪声的正弦，幅度不超过 0.9
+std::vector<float> TestSignal(size_t frames) {
+    std::vector<float> signal(frames * kChannels);
+    uint32_t seed = 1;
+    for (size_t i = 0; i < signal.size(); ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        const float noise = static_cast<float>(static_cast<int32_t>(seed)) / 2147483648.0f;
+        signal[i] = 0.8f * std::sin(static_cast<float>(i / kChannels) * 0.0571f) + 0.1f * noise;
+    }
+    return signal;
+}
+
+// 写满一轮再读出，返回最大绝对误差
+double RoundTripError(CaptureRing& ring) {
+    const std::vector<float> in = TestSignal(kBlockFrames * 64);
+    std::vector<float> out(in.size());
+    double worst = 0.0;
+    for (size_t offset = 0; offset < in.size(); offset += kBlockFrames * kChannels) {
+        ring.Write(in.data() + offset, kBlockFrames);
+        ring.Read(out.data() + offset, kBlockFrames);
+    }
+    for (size_t i = 0; i < in.size(); ++i) {
+        worst = std::max(worst, std::fabs(static_cast<double>(in[i]) - out[i]));
+    }
+    return worst;
+}
+
+// 单线程写一块读一块，数据常驻缓存，只比较转换本身的开销
+double CaptureRingThroughput(CaptureRing& ring) {
+    const std::vector<float> in = TestSignal(kBlockFrames);
+    std::vector<float> out(in.size());
+    const size_t iterations = (64u << 20) / in.size();
+    auto start = Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        ring.Write(in.data(), kBlockFrames);
+        ring.Read(out.data(), kBlockFrames);
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return static_cast<double>(iterations * in.size()) / seconds / 1e6;
+}
+
+// 多路录音同时缓冲：每路保持半满，轮流写入、读出一块。
+// 每个样本在写入约 2 秒后才被读出，总占用超过缓存时读写都要访问内存
+double MultiSessionThroughput(CaptureRing::Storage storage, size_t sessions, uint32_t milliseconds,
+                              size_t* totalBytes) {
+    std::vector<std::unique_ptr<CaptureRing>> rings;
+    const std::vector<float> in = TestSignal(kBlockFrames);
+    std::vector<float> out(in.size());
+    *totalBytes = 0;
+    for (size_t i = 0; i < sessions; ++i) {
+        rings.emplace_back(new CaptureRing());
+        rings.back()->Configure(RingOptions(storage, milliseconds), kSampleRate, kChannels);
+        while (rings.back()->AvailableFrames() + kBlockFrames <= rings.back()->CapacityFrames() / 2) {
+            rings.back()->Write(in.data(), kBlockFrames);
+        }
+        *totalBytes += rings.back()->StorageBytes();
+    }
+    // 先转一整圈预热，使每路的读写位置都落在冷数据上
+    const size_t rounds = rings.front()->CapacityFrames() / kBlockFrames;
+    for (size_t round = 0; round < rounds / 2; ++round) {
+        for (auto& ring : rings) {
+            ring->Write(in.data(), kBlockFrames);
+            ring->Read(out.data(), kBlockFrames);
+        }
+    }
+    auto start = Clock::now();
+    for (size_t round = 0; round < rounds; ++round) {
+        for (auto& ring : rings) {
+            ring->Write(in.data(), kBlockFrames);
+            ring->Read(out.data(), kBlockFrames);
+        }
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return static_cast<double>(rounds * sessions * in.size()) / seconds / 1e6;
+}
+
+} // namespace
+
+int main() {
+    Logger::init();
+    Logger::setLevel(Logger::Level::WARN);
+    const size_t blocks[] = {32, 256, 1024, 4096};
+
+    printf("单线程 write+read 吞吐量 (百万样本/秒)\n");
+    printf("%8s %14s %14s %8s\n", "block", "legacy", "spsc", "speedup");
+    for (size_t block : blocks) {
+        LegacyRingBuffer legacy(kCapacity);
+        RingBuffer spsc(kCapacity);
+        double a = SingleThreadThroughput(legacy, block);
+        double b = SingleThreadThroughput(spsc, block);
+        printf("%8zu %14.1f %14.1f %7.1fx\n", block, a, b, b / a);
+    }
+
+    printf("\n生产者/消费者并发 (吞吐量 百万样本/秒, write 延迟 微秒)\n");
+    printf("%8s %10s %12s %12s %10s %12s %12s\n",
+           "block", "legacy", "legacy p99", "legacy max", "spsc", "spsc p99", "spsc max");
+    for (size_t block : blocks) {
+        LegacyRingBuffer legacy(kCapacity);
+        RingBuffer spsc(kCapacity, RingBuffer::OverflowPolicy::DropOldest);
+        ConcurrentResult a = ProducerConsumer(legacy, block, 0.5);
+        ConcurrentResult b = ProducerConsumer(spsc, block, 0.5);
+        printf("%8zu %10.1f %12.2f %12.2f %10.1f %12.2f %12.2f\n", block,
+               a.msamples_per_sec, a.p99_write_us, a.worst_write_us,
+               b.msamples_per_sec, b.p99_write_us, b.worst_write_us);
+    }
+
+    printf("\nCaptureRing 存储格式 (%d Hz, %zu 声道, 4000ms, 每块 %zu 帧)\n", kSampleRate, kChannels, kBlockFrames);
+    printf("%8s %10s %10s %16s %12s\n", "storage", "frames", "KB", "百万样本/秒", "最大误差");
+    for (CaptureRing::Storage storage : kStorages) {
+        CaptureRing ring;
+        ring.Configure(RingOptions(storage, 4000), kSampleRate, kChannels);
+        const double error = RoundTripError(ring);
+        const double throughput = CaptureRingThroughput(ring);
+        printf("%8s %10zu %10zu %16.1f %12.2e\n", CaptureRing::StorageName(storage), ring.CapacityFrames(),
+               ring.StorageBytes() / 1024, throughput, error);
+    }
+
+    printf("\n多路录音同时缓冲 (每路 %d Hz %zu 声道 4000ms，保持半满，轮流存取 %zu 帧)\n",
+           kSampleRate, kChannels, kBlockFrames);
+    printf("%8s %8s %10s %16s %14s\n", "sessions", "storage", "MB", "百万样本/秒", "每块 微秒");
+    for (size_t sessions : {size_t(4), size_t(32)}) {
+        for (CaptureRing::Storage storage : kStorages) {
+            size_t bytes = 0;
+            const double throughput = MultiSessionThroughput(storage, sessions, 4000, &bytes);
+            printf("%8zu %8s %10.1f %16.1f %14.2f\n", sessions, CaptureRing::StorageName(storage),
+                   bytes / 1048576.0, throughput, kBlockFrames * kChannels / throughput);
+        }
+    }
+    Logger::shutdown();
+    return 0;
+}
@@ -0,0 +1,232 @@
+// StreamAligner 基准：用合成的时间戳模拟麦克风（单声道 480 帧/块）和系统音频（立体声 512 帧/块）两路采集，
+// 样本值为该帧相对系统音频起点的真实帧序号 + 1，对齐后输出第 p 帧应为 p + 1，补的静音为 0；
+// 起点按带抖动的主机时间定位，允许整条输出有一个不超过抖动的固定偏移，之后不得再有任何错位。场景：
+// - 起始偏差 + 丢块 + 重复块：麦克风晚 30ms 开始，主机时间带 ±200us 抖动，按采样时间定位
+// - 只有主机时间：麦克风没有采样时间，抖动在容差内视为连续
+// - 采样时间归零：系统音频中途采样时间归零（设备重置），按主机时间重新定位
+// - 到达延迟：按实时节奏推送，每块在采集完 3ms 后到达
+// 统计补静音/裁剪帧数、两路相对偏移和每块 Push 耗时；输出位置不一致或延迟不符时返回非 0
+//
+// 用法: stream_aligner_bench [模拟秒数]
+
+#include "stream_aligner.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int kSampleRate = 48000;
+constexpr uint64_t kBaseNanos = 1000000000000ull;   // 系统音频第一帧的真实采集时刻
+
+struct StreamScenario {
+    size_t channels;
+    size_t blockFrames;
+    double startMilliseconds;   // 相对系统音频起点
+    bool sampleTime;
+    double jitterMicroseconds;
+    size_t dropEvery;           // 每 N 块丢一块（采样时间照常前进），0 表示不丢
+    size_t repeatEvery;         // 每 N 块把上一块末尾 128 帧重发一次（上一块丢了时不重发），0 表示不重发
+    size_t resetAt;             // 从第 N 块起采样时间归零，0 表示不归零
+};
+
+struct Scenario {
+    const char* name;
+    StreamScenario streams[2];
+};
+
+struct Block {
+    size_t stream;
+    uint64_t firstFrame;        // 相对系统音频起点的真实帧序号
+    size_t frames;
+    CaptureTimestamp timestamp;
+};
+
+constexpr size_t kRepeatFrames = 128;
+
+std::vector<Block> MakeBlocks(size_t index, const StreamScenario& s, double seconds, std::mt19937& rng) {
+    std::uniform_real_distribution<double> jitter(-s.jitterMicroseconds, s.jitterMicroseconds);
+    std::vector<Block> blocks;
+    const uint64_t start = static_cast<uint64_t>(s.startMilliseconds * kSampleRate / 1000.0);
+    const uint64_t end = static_cast<uint64_t>(seconds * kSampleRate);
+    double sampleOffset = 1000000.0;   // 设备采样时钟的任意起点
+    size_t n = 0;
+    for (uint64_t frame = start; frame + s.blockFrames <= end; frame += s.blockFrames, ++n) {
+        if (s.resetAt != 0 && n == s.resetAt) {
+            sampleOffset = -static_cast<double>(frame);
+        }
+        if (s.dropEvery != 0 && n % s.dropEvery == s.dropEvery - 1) {
+            continue;
+        }
+        Block block;
+        block.stream = index;
+        block.firstFrame = frame;
+        block.frames = s.blockFrames;
+        const bool previousDropped = s.dropEvery != 0 && n % s.dropEvery == 0;
+        if (s.repeatEvery != 0 && n > 0 && n % s.repeatEvery == 0 && !previousDropped) {
+            block.firstFrame -= kRepeatFrames;
+            block.frames += kRepeatFrames;
+        }
+        const double micros = jitter(rng);
+        block.timestamp.hostNanos = kBaseNanos + block.firstFrame * 1000000000ull / kSampleRate +
+                                    static_cast<int64_t>(micros * 1000.0);
+        block.timestamp.flags = CaptureTimestamp::kHostTimeValid;
+        if (s.sampleTime) {
+            block.timestamp.sampleTime = static_cast<double>(block.firstFrame) + sampleOffset;
+            block.timestamp.flags |= CaptureTimestamp::kSampleTimeValid;
+        }
+        blocks.push_back(block);
+    }
+    return blocks;
+}
+
+bool RunScenario(const Scenario& scenario, double seconds) {
+    std::mt19937 rng(7);
+    std::vector<Block> blocks;
+    size_t expectedTrimmed[2] = {0, 0};
+    for (size_t i = 0; i < 2; ++i) {
+        std::vector<Block> stream = MakeBlocks(i, scenario.streams[i], seconds, rng);
+        for (const Block& block : stream) {
+            expectedTrimmed[i] += block.frames - scenario.streams[i].blockFrames;
+        }
+        blocks.insert(blocks.end(), stream.begin(), stream.end());
+    }
+    // 按采集时刻交替到达，系统音频第一块最先到达，会话零点即系统音频起点
+    std::stable_sort(blocks.begin(), blocks.end(), [](const Block& a, const Block& b) {
+        return a.firstFrame < b.firstFrame;
+    });
+
+    std::vector<float> outputs[2];
+    std::vector<StreamAligner::StreamOptions> streams(2);
+    for (size_t i = 0; i < 2; ++i) {
+        streams[i].name = i == 0 ? "microphone" : "system";
+        streams[i].sampleRate = kSampleRate;
+        streams[i].channels = scenario.streams[i].channels;
+        std::vector<float>* out = &outputs[i];
+        const size_t channels = scenario.streams[i].channels;
+        streams[i].output = [out, channels](const float* data, size_t frames) {
+            out->insert(out->end(), data, data + frames * channels);
+        };
+        // 预先写一遍，Push 耗时里不计缺页
+        outputs[i].assign(static_cast<size_t>(seconds * kSampleRate + kSampleRate) * channels, 0.0f);
+        outputs[i].clear();
+    }
+    StreamAligner aligner;
+    if (!aligner.Initialize(StreamAligner::Options(), streams)) {
+        return false;
+    }
+
+    std::vector<float> data;
+    double pushNanos = 0.0;
+    for (const Block& block : blocks) {
+        const size_t channels = scenario.streams[block.stream].channels;
+        data.resize(block.frames * channels);
+        for (size_t f = 0; f < block.frames; ++f) {
+            for (size_t ch = 0; ch < channels; ++ch) {
+                data[f * channels + ch] = static_cast<float>(block.firstFrame + f + 1);
+            }
+        }
+        const auto t0 = std::chrono::steady_clock::now();
+        aligner.Push(block.stream, data.data(), block.frames, block.timestamp);
+        pushNanos += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+    }
+
+    const StreamAligner::Stats stats = aligner.GetStats();
+    printf("%s\n", scenario.name);
+    printf("  %-12s %10s %10s %10s %8s %8s %10s %10s %10s\n", "stream", "output", "inserted", "trimmed", "discont",
+           "resyncs", "skew ms", "offset", "mismatch");
+    // 会话零点是系统音频第一块带抖动的主机时间
+    const double originError = std::abs(static_cast<double>(static_cast<int64_t>(stats.originHostNanos - kBaseNanos)));
+    bool ok = originError <= scenario.streams[1].jitterMicroseconds * 1000.0;
+    for (size_t i = 0; i < 2; ++i) {
+        const size_t channels = scenario.streams[i].channels;
+        const std::vector<float>& out = outputs[i];
+        uint64_t mismatches = 0;
+        uint64_t zeros = 0;
+        bool located = false;
+        int64_t offset = 0;   // 第一个非静音样本的值减去 p + 1
+        for (size_t p = 0; p < out.size() / channels; ++p) {
+            for (size_t ch = 0; ch < channels; ++ch) {
+                const float value = out[p * channels + ch];
+                if (value == 0.0f) {
+                    zeros += ch == 0;
+                    continue;
+                }
+                if (!located) {
+                    offset = static_cast<int64_t>(value) - static_cast<int64_t>(p + 1);
+                    located = true;
+                }
+                mismatches += value != static_cast<float>(static_cast<int64_t>(p + 1) + offset);
+            }
+        }
+        const double maxOffset = scenario.streams[i].jitterMicroseconds * kSampleRate / 1e6 + 1.0;
+        const StreamAligner::StreamStats& s = stats.streams[i];
+        printf("  %-12s %10llu %10llu %10llu %8llu %8llu %10.2f %10lld %10llu\n", streams[i].name.c_str(),
+               static_cast<unsigned long long>(s.outputFrames), static_cast<unsigned long long>(s.insertedFrames),
+               static_cast<unsigned long long>(s.trimmedFrames), static_cast<unsigned long long>(s.discontinuities),
+               static_cast<unsigned long long>(s.resyncs), s.startSkewNanos / 1e6, static_cast<long long>(offset),
+               static_cast<unsigned long long>(mismatches));
+        ok &= mismatches == 0 && std::abs(static_cast<double>(offset)) <= maxOffset && zeros == s.insertedFrames &&
+              s.trimmedFrames == expectedTrimmed[i];
+    }
+    printf("  相对偏移 %.3f ms, Push %.0f ns/块\n\n", aligner.RelativeOffsetNanos(0, 1) / 1e6,
+           pushNanos / static_cast<double>(blocks.size()));
+    return ok;
+}
+
+// 按实时节奏推送 10ms 块，时间戳比到达时刻早 10ms + 3ms
+bool RunLatency() {
+    std::vector<StreamAligner::StreamOptions> streams(1);
+    streams[0].name = "microphone";
+    streams[0].sampleRate = kSampleRate;
+    streams[0].channels = 1;
+    streams[0].output = [](const float*, size_t) {};
+    StreamAligner aligner;
+    if (!aligner.Initialize(StreamAligner::Options(), streams)) {
+        return false;
+    }
+    constexpr size_t kFrames = kSampleRate / 100;
+    constexpr uint64_t kDelayNanos = 3000000;
+    std::vector<float> data(kFrames, 0.5f);
+    auto next = std::chrono::steady_clock::now();
+    for (size_t n = 0; n < 100; ++n) {
+        next += std::chrono::milliseconds(10);
+        std::this_thread::sleep_until(next);
+        CaptureTimestamp timestamp;
+        timestamp.hostNanos = PipelineMetrics::NowNanoseconds() - 10000000 - kDelayNanos;
+        timestamp.sampleTime = static_cast<double>(n * kFrames);
+        timestamp.flags = CaptureTimestamp::kHostTimeValid | CaptureTimestamp::kSampleTimeValid;
+        aligner.Push(0, data.data(), kFrames, timestamp);
+    }
+    const StreamAligner::StreamStats s = aligner.GetStats().streams[0];
+    const bool ok = s.averageLatencyNanos >= kDelayNanos && s.averageLatencyNanos < kDelayNanos + 2000000;
+    printf("到达延迟：设定 %.2f ms, 平均 %.3f ms, 最大 %.3f ms -> %s\n", kDelayNanos / 1e6,
+           s.averageLatencyNanos / 1e6, s.maxLatencyNanos / 1e6, ok ? "通过" : "不符");
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double seconds = argc > 1 ? atof(argv[1]) : 60.0;
+    printf("48kHz, 模拟 %.0f 秒\n\n", seconds);
+    const Scenario scenarios[] = {
+        {"起始偏差 + 丢块 + 重复块（麦克风晚 30ms，抖动 ±200us）",
+         {{1, 480, 30.0, true, 200.0, 71, 0, 0}, {2, 512, 0.0, true, 200.0, 97, 53, 0}}},
+        {"只有主机时间（麦克风无采样时间，抖动 ±300us）",
+         {{1, 480, 12.0, false, 300.0, 0, 0, 0}, {2, 512, 0.0, true, 0.0, 0, 0, 0}}},
+        {"采样时间归零（系统音频第 300 块起）",
+         {{1, 480, 5.0, true, 0.0, 0, 0, 0}, {2, 512, 0.0, true, 0.0, 0, 0, 300}}},
+    };
+    bool ok = true;
+    for (const Scenario& scenario : scenarios) {
+        ok &= RunScenario(scenario, seconds);
+    }
+    ok &= RunLatency();
+    return ok ? 0 : 1;
+}
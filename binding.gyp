@@ -1,22 +1,13 @@
 {
+  "variables": {
+    "core_build_dir": "<(module_root_dir)/build-core"
+  },
   "targets": [
     {
       "target_name": "recorder",
       "cflags!": [ "-fno-exceptions" ],
       "cflags_cc!": [ "-fno-exceptions" ],
-      "sources": [ 
-        "src/recorder.cpp",
-        "src/recorder.h",
-        "src/mac_recorder.cpp",
-        "src/mac_recorder.h",
-        "src/audio_system_capture.mm",
-        "src/audio_system_capture.h",
-        "src/audio_device_manager.mm",
-        "src/audio_device_manager.h",
-        "src/logger.cpp",
-        "src/logger.h",
-        "src/ring_buffer.cpp",
-        "src/ring_buffer.h",
+      "sources": [
         "src/nodejs/recorder_bindings.cpp"
       ],
       "include_dirs": [
@@ -32,8 +23,20 @@
         "NAPI_DISABLE_CPP_EXCEPTIONS",
         "SPDLOG_HEADER_ONLY"
       ],
+      "libraries": [
+        "<(core_build_dir)/librecorder_core.a",
+        "<(core_build_dir)/libwebrtc_audio_processing.a",
+        "<!@(pkg-config --libs absl_optional absl_strings absl_synchronization)"
+      ],
       "conditions": [
         ["OS=='mac'", {
+          "sources": [
+            "src/recorder.cpp",
+            "src/mac_recorder.cpp",
+            "src/audio_system_capture.mm",
+            "src/system_tap_backend.mm",
+            "src/audio_device_manager.mm"
+          ],
           "xcode_settings": {
             "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
             "CLANG_CXX_LIBRARY": "libc++",
@@ -64,4 +67,4 @@
       }
     }
   ]
-} 
\ No newline at end of file
+}
@@ -0,0 +1,147 @@
+# WebRTC 音频处理子集（third_party/webrtc, M90），不依赖 GN/Chromium 工具链
+# 依赖系统安装的 abseil-cpp（macOS: brew install abseil）
+#
+# 覆盖 APM 基础模块（AudioBuffer、分频、高通、电平/VAD/回声检测）、common_audio
+# （重采样、FIR、VAD、wav_file）、aec3、ns、agc2 的非 RNN 部分以及 G.722 编解码。
+# AudioProcessingImpl、GainController2 的自适应模式和 agc2/rnn_vad 依赖未随仓库
+# 提供的 third_party/rnnoise 与 pffft，因此不在此目标中。
+
+find_package(absl REQUIRED)
+
+set(WEBRTC_DIR ${CMAKE_CURRENT_SOURCE_DIR}/third_party/webrtc)
+
+# 各平台 SIMD 实现的文件名后缀，由下面按架构单独加入
+set(WEBRTC_SIMD_SUFFIX_REGEX "_(mips|arm|armv7|neon|sse|sse2|avx2)\\.(c|cc)$")
+
+# 按目录收集源文件，排除单元测试、mock 以及平台相关的 SIMD 实现
+function(webrtc_collect_sources out_var)
+    set(result)
+    foreach(dir ${ARGN})
+        file(GLOB dir_sources ${WEBRTC_DIR}/${dir}/*.c ${WEBRTC_DIR}/${dir}/*.cc)
+        list(APPEND result ${dir_sources})
+    endforeach()
+    list(FILTER result EXCLUDE REGEX "(_unittest|_test|_unittest_helper|_benchmark|_fuzzer|_testing_common|mock_.*)\\.cc$")
+    list(FILTER result EXCLUDE REGEX "${WEBRTC_SIMD_SUFFIX_REGEX}")
+    set(${out_var} ${result} PARENT_SCOPE)
+endfunction()
+
+set(WEBRTC_SOURCE_DIRS
+    common_audio
+    common_audio/resampler
+    common_audio/signal_processing
+    common_audio/vad
+    common_audio/third_party/ooura/fft_size_128
+    common_audio/third_party/ooura/fft_size_256
+    common_audio/third_party/spl_sqrt_floor
+    modules/audio_processing/aec3
+    modules/audio_processing/agc2
+    modules/audio_processing/ns
+)
+
+webrtc_collect_sources(WEBRTC_SOURCES ${WEBRTC_SOURCE_DIRS})
+
+# 依赖 rnnoise/pffft 的文件，以及 GN 中只属于测试目标的文件
+list(FILTER WEBRTC_SOURCES EXCLUDE REGEX "/agc2/(adaptive_agc|vad_with_level|compute_interpolated_gain_curve)\\.cc$")
+
+# GetCPUInfo(kAVX2) 额外检查 FMA3（CPUID leaf 1 ECX bit 12）：AVX2 文件用 -mfma 编译并用到 FMA3 指令，
+# 只有 AVX2 没有 FMA3 的 CPU 应留在 SSE2 路径。不改动 third_party 中的原始文件，
+# 配置时生成补丁后的副本编译；上游文件变化导致补丁位置找不到时报错
+set(WEBRTC_CPU_FEATURES_ORIGINAL ${WEBRTC_DIR}/system_wrappers/source/cpu_features.cc)
+set(WEBRTC_CPU_FEATURES_SOURCE ${CMAKE_CURRENT_BINARY_DIR}/webrtc_patched/system_wrappers/source/cpu_features.cc)
+file(READ ${WEBRTC_CPU_FEATURES_ORIGINAL} cpu_features_content)
+set(cpu_features_avx_check "    return (cpu_info[2] & 0x10000000) != 0 &&\n")
+string(FIND "${cpu_features_content}" "${cpu_features_avx_check}" cpu_features_avx_check_pos)
+if(cpu_features_avx_check_pos EQUAL -1)
+    message(FATAL_ERROR "cpu_features.cc 中找不到 AVX2 检测代码，无法加入 FMA3 检查")
+endif()
+string(REPLACE "${cpu_features_avx_check}"
+    "${cpu_features_avx_check}           (cpu_info[2] & 0x00001000) != 0 /* FMA3 */ &&\n"
+    cpu_features_content "${cpu_features_content}")
+# 内容不变时不重写，避免每次配置都重新编译
+file(WRITE ${WEBRTC_CPU_FEATURES_SOURCE}.tmp "${cpu_features_content}")
+configure_file(${WEBRTC_CPU_FEATURES_SOURCE}.tmp ${WEBRTC_CPU_FEATURES_SOURCE} COPYONLY)
+set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${WEBRTC_CPU_FEATURES_ORIGINAL})
+
+list(APPEND WEBRTC_SOURCES
+    ${WEBRTC_DIR}/modules/audio_processing/audio_buffer.cc
+    ${WEBRTC_DIR}/modules/audio_processing/high_pass_filter.cc
+    ${WEBRTC_DIR}/modules/audio_processing/level_estimator.cc
+    ${WEBRTC_DIR}/modules/audio_processing/residual_echo_detector.cc
+    ${WEBRTC_DIR}/modules/audio_processing/rms_level.cc
+    ${WEBRTC_DIR}/modules/audio_processing/splitting_filter.cc
+    ${WEBRTC_DIR}/modules/audio_processing/three_band_filter_bank.cc
+    ${WEBRTC_DIR}/modules/audio_processing/voice_detection.cc
+    ${WEBRTC_DIR}/modules/audio_processing/echo_detector/circular_buffer.cc
+    ${WEBRTC_DIR}/modules/audio_processing/echo_detector/mean_variance_estimator.cc
+    ${WEBRTC_DIR}/modules/audio_processing/echo_detector/moving_max.cc
+    ${WEBRTC_DIR}/modules/audio_processing/echo_detector/normalized_covariance_estimator.cc
+    ${WEBRTC_DIR}/modules/audio_processing/include/audio_processing.cc
+    ${WEBRTC_DIR}/modules/audio_processing/logging/apm_data_dumper.cc
+    ${WEBRTC_DIR}/modules/audio_processing/utility/cascaded_biquad_filter.cc
+    ${WEBRTC_DIR}/modules/audio_processing/utility/delay_estimator.cc
+    ${WEBRTC_DIR}/modules/audio_processing/utility/delay_estimator_wrapper.cc
+    ${WEBRTC_DIR}/api/audio/echo_canceller3_config.cc
+    ${WEBRTC_DIR}/rtc_base/checks.cc
+    ${WEBRTC_DIR}/rtc_base/logging.cc
+    ${WEBRTC_DIR}/rtc_base/experiments/field_trial_parser.cc
+    ${WEBRTC_DIR}/rtc_base/memory/aligned_malloc.cc
+    ${WEBRTC_DIR}/rtc_base/race_checker.cc
+    ${WEBRTC_DIR}/rtc_base/platform_thread_types.cc
+    ${WEBRTC_DIR}/rtc_base/string_encode.cc
+    ${WEBRTC_DIR}/rtc_base/string_to_number.cc
+    ${WEBRTC_DIR}/rtc_base/strings/string_builder.cc
+    ${WEBRTC_DIR}/rtc_base/system/file_wrapper.cc
+    ${WEBRTC_DIR}/rtc_base/system_time.cc
+    ${WEBRTC_DIR}/rtc_base/time_utils.cc
+    ${WEBRTC_CPU_FEATURES_SOURCE}
+    ${WEBRTC_DIR}/system_wrappers/source/field_trial.cc
+    ${WEBRTC_DIR}/system_wrappers/source/metrics.cc
+    ${WEBRTC_DIR}/modules/third_party/g722/g722_encode.c
+    ${WEBRTC_DIR}/modules/third_party/g722/g722_decode.c
+)
+
+# SIMD 实现：x86 以 SSE2 为基线，AVX2 文件单独加 -mavx2 -mfma 编译（内核用到 FMA3 指令，不能去掉 -mfma），
+# 运行时由 GetCPUInfo(kAVX2) 选择（FIR 工厂、SincResampler、AEC3 各自分派），kAVX2 同时要求 CPU 支持 FMA3（见上方补丁）；
+# ARM64 上 NEON 为基线，直接编译 NEON 版本
+set(WEBRTC_SIMD_SOURCES)
+set(WEBRTC_AVX2_SOURCES)
+set(WEBRTC_SIMD_DEFINITIONS)
+if(CMAKE_SYSTEM_PROCESSOR MATCHES "^(x86_64|AMD64|i.86)$")
+    foreach(dir ${WEBRTC_SOURCE_DIRS})
+        file(GLOB simd_sources
+            ${WEBRTC_DIR}/${dir}/*_sse.cc
+            ${WEBRTC_DIR}/${dir}/*_sse2.cc)
+        file(GLOB avx2_sources ${WEBRTC_DIR}/${dir}/*_avx2.cc)
+        list(APPEND WEBRTC_SIMD_SOURCES ${simd_sources})
+        list(APPEND WEBRTC_AVX2_SOURCES ${avx2_sources})
+    endforeach()
+    set_source_files_properties(${WEBRTC_AVX2_SOURCES} PROPERTIES COMPILE_OPTIONS "-mavx2;-mfma")
+    list(APPEND WEBRTC_SIMD_SOURCES ${WEBRTC_AVX2_SOURCES})
+    list(APPEND WEBRTC_SIMD_DEFINITIONS WEBRTC_ENABLE_AVX2)
+elseif(CMAKE_SYSTEM_PROCESSOR MATCHES "^(arm64|aarch64)$")
+    foreach(dir ${WEBRTC_SOURCE_DIRS})
+        file(GLOB simd_sources ${WEBRTC_DIR}/${dir}/*_neon.c ${WEBRTC_DIR}/${dir}/*_neon.cc)
+        list(APPEND WEBRTC_SIMD_SOURCES ${simd_sources})
+    endforeach()
+    list(APPEND WEBRTC_SIMD_DEFINITIONS WEBRTC_HAS_NEON)
+endif()
+
+add_library(webrtc_audio_processing STATIC ${WEBRTC_SOURCES} ${WEBRTC_SIMD_SOURCES})
+
+target_include_directories(webrtc_audio_processing PUBLIC ${WEBRTC_DIR})
+
+target_compile_definitions(webrtc_audio_processing PUBLIC
+    WEBRTC_POSIX
+    WEBRTC_APM_DEBUG_DUMP=0
+    RTC_DISABLE_LOGGING
+    $<$<PLATFORM_ID:Linux>:WEBRTC_LINUX>
+    $<$<PLATFORM_ID:Darwin>:WEBRTC_MAC>
+    ${WEBRTC_SIMD_DEFINITIONS}
+)
+
+target_link_libraries(webrtc_audio_processing PUBLIC
+    absl::optional
+    absl::strings
+    absl::synchronization
+    Threads::Threads
+)
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// 写线程上的压缩编码器
+// StreamingWavWriter 把从队列取出的交织 float 样本交给编码器，由编码器负责文件格式和写盘。
+// 所有接口只在写线程调用，可以分配内存、做系统调用，绝不会出现在音频线程上
+class AudioEncoder {
+public:
+    enum class Codec {
+        Pcm,     // 不压缩，由 StreamingWavWriter 直接写 WAV
+        Flac,    // 无损：分块线性预测 + Rice 编码，多个块并行编码
+        G722     // 语音：单声道 16kHz 64kbps G.722，封装为 WAV
+    };
+
+    struct Options {
+        uint32_t sampleRate = 44100;
+        uint16_t channels = 2;
+        uint16_t bitsPerSample = 16;   // FLAC 量化位数：16 或 24
+        bool dither = false;           // 量化为整数时叠加 TPDF 抖动
+        uint32_t blockFrames = 4096;   // FLAC 每帧的采样数
+        size_t threads = 0;            // FLAC 同时编码的块数，0 表示按 CPU 核数
+    };
+
+    // Pcm 返回空指针
+    static std::unique_ptr<AudioEncoder> Create(Codec codec, const Options& options);
+
+    // 按扩展名选择编码：.flac -> Flac，.g722.wav -> G722，其余为 Pcm
+    static Codec CodecForPath(const std::string& path);
+
+    // 各编码对应的扩展名（包括开头的点）
+    static const char* Extension(Codec codec);
+
+    // "pcm"/"wav"、"flac"、"g722"，无法识别时返回 false
+    static bool ParseCodec(const char* name, Codec* codec);
+
+    virtual ~AudioEncoder() = default;
+
+    // fd 由调用方打开和关闭，编码器从偏移 0 开始写入文件头
+    virtual bool Begin(int fd) = 0;
+
+    // 输入交织 float，frames 为帧数；写盘失败时返回 false
+    virtual bool Encode(const float* interleaved, size_t frames) = 0;
+
+    // 把已编码的数据和当前长度写入文件头，进程中途被杀时文件仍可解码
+    virtual bool Flush() = 0;
+
+    // 编码剩余数据并写入最终文件头
+    virtual bool Finish() = 0;
+
+    // 已经编码写盘的输入帧数
+    virtual uint64_t FramesEncoded() const = 0;
+
+    virtual uint64_t BytesWritten() const = 0;
+
+protected:
+    static bool WriteAt(int fd, const void* data, size_t size, uint64_t offset);
+};
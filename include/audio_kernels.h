@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 交织/解交织、采样格式转换、增益和上下混音的向量化内核
+// - 每个内核都有标量参考实现，SSE2/AVX2/NEON 版本与其逐位一致
+// - 首次调用时按 CPU 能力选择实现，之后只是一次函数指针调用
+// - 不分配内存、不加锁，可以在音频回调里直接使用
+// - 交织/解交织对 1、2、4 声道有专门路径，其它声道数（常见 3~8）走按声道数展开的标量循环
+namespace AudioKernels {
+
+enum class Isa {
+    Scalar,
+    SSE2,
+    AVX2,
+    NEON
+};
+
+// TPDF 抖动的随机数状态，每路输出流各持有一个
+struct DitherState {
+    uint32_t state = 0x9E3779B9u;
+};
+
+// int16 满幅（32767/32768）及以上视为削波
+constexpr float kClipLevel = 32767.0f / 32768.0f;
+
+// 一块样本的电平统计，由 *WithLevels 内核在转换的同一遍里顺带算出，不再额外遍历内存；
+// 各实现都按样本下标 mod 16 分 16 路累加、按固定顺序合并，结果与标量参考逐位一致
+struct LevelStats {
+    float peak = 0.0f;        // 最大绝对值，NaN 不计入
+    float sumSquares = 0.0f;  // 输入含 NaN 或无穷时为 NaN/无穷
+    float sum = 0.0f;         // 除以 samples 即直流偏移
+    uint32_t clipped = 0;     // |x| >= kClipLevel 的样本数
+    size_t samples = 0;
+};
+
+// 当前 CPU 上可用的最佳实现
+Isa DetectedIsa();
+
+// 当前生效的实现
+Isa ActiveIsa();
+
+// 强制使用指定实现（基准测试和一致性校验用），CPU 不支持时返回 false
+bool SetIsa(Isa isa);
+
+const char* IsaName(Isa isa);
+
+// planar[channels][frames] -> interleaved[frames * channels]
+void Interleave(const float* const* planar, float* interleaved, size_t channels, size_t frames);
+
+// Interleave 的同时统计输出的电平；1、2 声道在同一遍内完成，其他声道数在交织后统计刚写出（仍在缓存中）的数据
+void InterleaveWithLevels(const float* const* planar, float* interleaved, size_t channels, size_t frames,
+                          LevelStats* levels);
+
+// interleaved[frames * channels] -> planar[channels][frames]
+void Deinterleave(const float* interleaved, float* const* planar, size_t channels, size_t frames);
+
+// float [-1, 1] -> 有符号整数，超出范围饱和；dither 非空时叠加 ±1 LSB 的 TPDF 抖动
+void FloatToInt16(const float* src, int16_t* dst, size_t samples, DitherState* dither = nullptr);
+void FloatToInt24(const float* src, uint8_t* dst, size_t samples, DitherState* dither = nullptr);  // 小端 3 字节
+
+void Int16ToFloat(const int16_t* src, float* dst, size_t samples);
+void Int24ToFloat(const uint8_t* src, float* dst, size_t samples);
+
+// Int16ToFloat / memcpy 的同时统计输出的电平
+void Int16ToFloatWithLevels(const int16_t* src, float* dst, size_t samples, LevelStats* levels);
+void CopyWithLevels(const float* src, float* dst, size_t samples, LevelStats* levels);
+
+// 只统计电平，用于没有转换步骤、数据直接交给下游的路径（例如系统音频 IOProc）
+void MeasureLevels(const float* samples, size_t count, LevelStats* levels);
+
+// dst = src * gain，src 与 dst 可以相同
+void ApplyGain(const float* src, float* dst, size_t samples, float gain);
+
+// 交织立体声 -> 单声道 (L + R) / 2
+void StereoToMono(const float* interleaved, float* mono, size_t frames);
+
+// 单声道 -> 交织立体声（左右声道相同）
+void MonoToStereo(const float* mono, float* interleaved, size_t frames);
+
+// 混音累加：dst[i] += src[i] * (gain + gainStep * i)，gainStep 非 0 时为线性增益斜坡
+// 斜坡下标按 float 计算，samples 不超过 2^24
+void MixAdd(const float* src, float* dst, size_t samples, float gain, float gainStep = 0.0f);
+
+} // namespace AudioKernels
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// N 路输入混音器，替代 AVAudioMixerNode，在各平台上得到相同的混音结果
+// - 每路输入有独立增益，SetGain() 可在任意线程调用，音频线程在 rampMilliseconds 内线性过渡，没有咔哒声
+// - 求和走 AudioKernels::MixAdd（SIMD，增益斜坡在内核里完成）
+// - 求和之后经过 WebRTC AGC2 的限幅器（采样率不满足其 10ms 子帧要求时改用内部的包络限幅），
+//   削波不会进入文件
+// - 内部按 10ms 分帧，输入块大小任意，输出固定延迟 LatencyFrames() 帧；Process 不加锁、不分配内存
+class AudioMixer {
+public:
+    static constexpr size_t kMaxChannels = 8;
+
+    struct Options {
+        int sampleRate = 48000;
+        size_t channels = 2;                 // 输出声道数
+        std::vector<size_t> inputChannels;   // 每路输入的声道数，同时决定输入路数；单声道输入复制到所有输出声道
+        uint32_t rampMilliseconds = 20;      // 增益变化的过渡时长
+        bool limiter = true;
+
+        Options();
+    };
+
+    struct Stats {
+        uint64_t blocks;                 // 已混合的 10ms 帧数
+        uint64_t limitedBlocks;          // 求和峰值超过满幅、需要限幅的帧数
+        float peak;                      // 限幅前的最大峰值（满幅为 1）
+        uint64_t averageProcessNanos;    // 每个 10ms 帧（求和之后的部分）的平均处理耗时
+        uint64_t maxProcessNanos;
+    };
+
+    AudioMixer();
+    ~AudioMixer();
+
+    AudioMixer(const AudioMixer&) = delete;
+    AudioMixer& operator=(const AudioMixer&) = delete;
+
+    // 在音频回调停止时由非实时线程调用；重复调用会重建内部状态，各路增益恢复为 1
+    bool Initialize(const Options& options);
+    void Release();
+
+    bool IsInitialized() const { return initialized_.load(std::memory_order_acquire); }
+
+    size_t Inputs() const;
+
+    // 任意线程调用，设置第 input 路的目标增益
+    void SetGain(size_t input, float gain);
+    float GetGain(size_t input) const;
+
+    // inputs[i] 为第 i 路交织数据（声道数为 inputChannels[i]），nullptr 视为静音；
+    // output 为 channels 声道交织数据，可以与某一路声道数不少于 channels 的输入相同（原地混音）；
+    // 声道数更少的输入（例如单声道）按更大的步长写回时会覆盖尚未读取的输入，不能与 output 共用缓冲
+    void Process(const float* const* inputs, float* output, size_t frames);
+
+    // 10ms 对应的帧数，也是输出相对输入的延迟
+    size_t LatencyFrames() const { return frameSize_; }
+
+    // 任意线程调用
+    Stats GetStats() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+    std::atomic<bool> initialized_;
+    size_t frameSize_;
+};
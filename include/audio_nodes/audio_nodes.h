@@ -1,8 +1,17 @@
 #import <AudioToolbox/AudioToolbox.h>
 #import <AVFoundation/AVFoundation.h>
+#include "echo_cancellation_stage.h"
 
 @interface AECUnit : AUAudioUnit
 
+// 远端参考（系统音频）的格式，需要在分配渲染资源之前设置
+@property (nonatomic) double referenceSampleRate;
+@property (nonatomic) NSUInteger referenceChannelCount;
+
+// 回声消除处理级，生命周期与 AECUnit 相同；
+// 远端参考由系统音频的渲染回调通过 AnalyzeRender() 送入
+@property (nonatomic, readonly) EchoCancellationStage *echoCancellationStage;
+
 - (instancetype)initWithComponentDescription:(AudioComponentDescription)componentDescription
                                      error:(NSError **)outError;
 
@@ -2,7 +2,10 @@
 
 #include <AudioToolbox/AudioToolbox.h>
 #include <CoreAudio/CoreAudio.h>
+#include "capture_backend.h"
 #include "logger.h"
+#include "pipeline_metrics.h"
+#include "capture_ring.h"
 #include <vector>
 #include <memory>
 #include <functional>
@@ -27,10 +30,12 @@ public:
     // 停止循环播放
     void StopLoopback();
     
-    // 设置音频数据回调
-    void SetAudioDataCallback(std::function<void(const AudioBufferList*, UInt32)> callback);
+    // 设置音频数据回调，在 IOProc 上调用，带 inInputTime 换算出的时间戳
+    using AudioDataCallback = std::function<void(const AudioBufferList*, UInt32, const CaptureTimestamp&)>;
+    void SetAudioDataCallback(AudioDataCallback callback);
     
     bool CreateTapDevice();
+    // count 为交织样本数，必须是声道数的整数倍
     bool ReadAudioData(float* buffer, size_t count);
     
     // 获取设备 ID
@@ -38,6 +43,15 @@ public:
     
     // 清理环形缓冲区
     void ClearRingBuffer();
+
+    // 环形缓冲区的溢出/欠载统计，以帧为单位
+    RingBufferBase::Stats GetRingBufferStats() const;
+
+    // 环形缓冲的存储格式和时长，默认取自 CaptureRing::Options::FromEnvironment()；只能在第一次 StartRecording() 之前设置
+    void SetRingOptions(const CaptureRing::Options& options);
+
+    // 在 metrics 中注册 IOProc 的回调耗时、抖动和环形缓冲水位，只能在 StartRecording() 之前调用
+    void SetMetrics(PipelineMetrics* metrics);
     
     // 获取音频格式
     bool GetAudioFormat(AudioStreamBasicDescription& format) {
@@ -100,5 +114,5 @@ private:
     bool recordingEnabled_;
     bool loopbackEnabled_;
     AudioDeviceIOProcID ioProcID_;
-    std::function<void(const AudioBufferList*, UInt32)> audioDataCallback_;
+    AudioDataCallback audioDataCallback_;
 }; 
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "headless_recorder.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// 离线批处理：把归档的会话（麦克风 + 系统音频两个 WAV）按实时录音的同一条管线
+// （时间戳对齐、漂移补偿重采样、回声消除、可选的高通/降噪/AGC2、混音、编码写盘）重新处理
+// - 每个会话由一个不限速的 HeadlessRecorder 处理：输入按块从内存映射读取并交还读过的页，
+//   写入队列有界，每个工作线程的内存占用与文件长短无关
+// - 每个工作线程有自己的会话队列，按输入大小从大到小轮流分配；自己的队列取空后
+//   从剩余最多的队列尾部窃取，长会话不会都压在同一个线程上
+class BatchProcessor {
+public:
+    struct Session {
+        std::string name;
+        std::string microphonePath;
+        std::string systemPath;
+        std::string outputPath;   // 混合音频路径，另两路写在同目录（见 HeadlessRecorder::SetOutputPath）
+    };
+
+    struct SessionResult {
+        size_t index;             // 在输入列表中的位置
+        size_t worker;
+        bool stolen;              // 由其他线程的队列窃取而来
+        bool ok;
+        double audioSeconds;
+        double wallSeconds;
+        uint64_t droppedFrames;
+    };
+
+    struct Options {
+        size_t workers = 0;                        // 0 表示 CPU 核数
+        HeadlessRecorder::Options recorder;        // 管线配置，speed 和输入路径由批处理覆盖
+        std::function<void(const Session&, const SessionResult&)> onSessionDone;   // 在工作线程上调用
+
+        Options();
+    };
+
+    struct Report {
+        std::vector<SessionResult> sessions;
+        size_t failed;
+        uint64_t steals;
+        double audioSeconds;
+        double wallSeconds;
+        double cpuSeconds;                         // 进程 CPU 时间，包括写线程和 DSP 工作线程
+    };
+
+    // 清单每行一个会话：麦克风路径、系统音频路径和可选的会话名，以制表符分隔；
+    // 空行和 # 开头的行忽略，相对路径相对清单所在目录
+    static bool LoadManifest(const std::string& path, std::vector<Session>* sessions);
+
+    // 按 HeadlessRecorder 的输出命名配对目录中的 <名称>_mic.wav 和 <名称>_source.wav
+    static bool ScanDirectory(const std::string& directory, std::vector<Session>* sessions);
+
+    // 输出写到 outputDirectory/<名称><extension>，extension 决定编码（见 AudioEncoder::CodecForPath）
+    static bool AssignOutputs(const std::string& outputDirectory, const std::string& extension,
+                              std::vector<Session>* sessions);
+
+    explicit BatchProcessor(const Options& options);
+    ~BatchProcessor();
+
+    BatchProcessor(const BatchProcessor&) = delete;
+    BatchProcessor& operator=(const BatchProcessor&) = delete;
+
+    // 处理全部会话后返回
+    Report Run(const std::vector<Session>& sessions);
+
+private:
+    Options options_;
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "ring_buffer.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// 单生产者/多消费者广播环形缓冲区
+// - 生产者写入从不等待、不感知消费者：数据总是写入，最旧的数据被覆盖
+// - 每个消费者持有独立的 Reader（读位置、溢出策略、统计），读取不修改共享状态，
+//   慢消费者只会让自己丢数据，不影响生产者和其他消费者
+// - 读取按顺序锁（seqlock）方式校验：先拷贝，再确认这段数据在拷贝期间没有被覆盖，否则按溢出处理；
+//   拷贝与覆盖之间的竞争是有意的（结果会被丢弃），ThreadSanitizer 会把它报告为数据竞争
+// - 容量向上取整为 2 的幂；写入/读取最多分两段 memcpy 完成，不加锁、不分配内存
+class BroadcastRing {
+public:
+    class Reader {
+    public:
+        enum class OverflowPolicy {
+            DropOldest,   // 只丢弃已被覆盖的部分，从仍然有效的最旧数据继续读（不丢多余数据，延迟最大）
+            SkipToLatest  // 丢弃全部积压，从最新写入的位置继续（延迟最小，适合实时预览和转写）
+        };
+
+        struct Stats {
+            size_t overflow_count;    // 被生产者追上的次数
+            size_t underflow_count;   // 数据不足的读取次数
+            size_t dropped_samples;   // 因溢出丢弃的样本数
+            size_t max_used_size;     // 最大积压量
+        };
+
+        // 从创建时刻的写位置开始读，只看到之后写入的数据
+        Reader(const BroadcastRing& ring, OverflowPolicy policy);
+
+        // 仅由该 Reader 的所有者线程调用，数据不足 count 时立即返回 false
+        bool read(float* data, size_t count);
+
+        // 尚未读取的样本数，已被覆盖时返回容量
+        size_t available_read() const;
+
+        // 下一次读取的起点，以生产者累计写入的样本数计（与 write_position() 同一坐标）
+        uint64_t position() const { return read_pos_.load(std::memory_order_acquire); }
+
+        Stats get_stats() const;
+
+        // 跳过积压，下次从最新位置读
+        void skip_to_latest();
+
+    private:
+        // 被追上时按策略推进读位置，返回新的读位置
+        uint64_t handle_overflow(uint64_t w);
+
+        const BroadcastRing& ring_;
+        const OverflowPolicy policy_;
+
+        alignas(kCacheLineSize) std::atomic<uint64_t> read_pos_;
+        std::atomic<size_t> overflow_count_;
+        std::atomic<size_t> underflow_count_;
+        std::atomic<size_t> dropped_samples_;
+        std::atomic<size_t> max_used_size_;
+    };
+
+    // granularity 为读位置跳跃时对齐的样本数，交织数据应取声道数，保证丢弃后仍从帧首开始读
+    explicit BroadcastRing(size_t size, size_t granularity = 1);
+
+    // 仅由生产者线程调用；一次写入超过容量时只保留最后 capacity() 个样本
+    void write(const float* data, size_t count);
+
+    size_t capacity() const { return capacity_; }
+
+    // 累计写入的样本数
+    uint64_t write_position() const { return write_pos_.load(std::memory_order_acquire); }
+
+private:
+    void copy_in(uint64_t pos, const float* data, size_t count);
+    void copy_out(uint64_t pos, float* data, size_t count) const;
+
+    // 已发布的写位置，读者据此判断可读范围
+    alignas(kCacheLineSize) std::atomic<uint64_t> write_pos_;
+    // 正在写入的区间终点，写数据之前发布，读者据此判断拷贝是否被覆盖
+    alignas(kCacheLineSize) std::atomic<uint64_t> claim_pos_;
+
+    alignas(kCacheLineSize) std::unique_ptr<float[]> buffer_;
+    size_t capacity_;
+    size_t mask_;
+    size_t granularity_;
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+class CaptureTraceWriter;
+class LevelMeter;
+
+// 一块采集数据的时间戳（对应 AudioTimeStamp / AVAudioTime）
+// - hostNanos：第一帧的采集时刻，与 PipelineMetrics::NowNanoseconds() 同一单调时钟；
+//   macOS 上由 AudioConvertHostTimeToNanos(mHostTime) 得到，与 steady_clock 同源
+// - sampleTime：第一帧在设备采样时钟上的序号，以本流的帧为单位；相邻两块不连续说明中间丢了数据
+struct CaptureTimestamp {
+    enum Flags : uint32_t {
+        kHostTimeValid = 1u << 0,
+        kSampleTimeValid = 1u << 1
+    };
+
+    uint64_t hostNanos = 0;
+    double sampleTime = 0.0;
+    uint32_t flags = 0;
+
+    bool HasHostTime() const { return (flags & kHostTimeValid) != 0; }
+    bool HasSampleTime() const { return (flags & kSampleTimeValid) != 0; }
+};
+
+// 采集后端接口
+// 数据回调的形状与 AudioSystemCapture::IOProc（单 buffer 交织的 AudioBufferList）
+// 和 MicrophoneCapture::InputCallback（AudioUnitRender 得到的交织数据）一致：
+// 每次回调一块交织 float32 数据、帧数和这块数据的时间戳，在采集线程上调用，回调内不得阻塞
+class CaptureBackend {
+public:
+    using DataCallback = std::function<void(const float* interleaved, size_t frames, const CaptureTimestamp& timestamp)>;
+
+    virtual ~CaptureBackend() = default;
+
+    // 只能在 Start() 之前设置
+    void SetDataCallback(DataCallback callback) { callback_ = std::move(callback); }
+
+    // 每块数据在转换时顺带统计电平交给 meter（见 LevelMeter），传 nullptr 关闭；只能在 Start() 之前设置
+    void SetLevelMeter(LevelMeter* meter) { levelMeter_ = meter; }
+
+    // 每块数据在回调之前写入采集轨迹 trace 的第 stream 路（见 CaptureTraceWriter），传 nullptr 关闭；只能在 Start() 之前设置
+    void SetTrace(CaptureTraceWriter* trace, int stream) {
+        trace_ = trace;
+        traceStream_ = stream;
+    }
+
+    virtual bool Start() = 0;
+    virtual void Stop() = 0;
+    virtual bool IsRunning() const = 0;
+
+    virtual int SampleRate() const = 0;
+    virtual size_t Channels() const = 0;
+
+protected:
+    DataCallback callback_;
+    LevelMeter* levelMeter_ = nullptr;
+    CaptureTraceWriter* trace_ = nullptr;
+    int traceStream_ = -1;
+};
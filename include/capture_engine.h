@@ -0,0 +1,106 @@
+#pragma once
+
+#include "broadcast_ring.h"
+#include "capture_backend.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// 引用计数的共享采集引擎：一个采集后端（设备）扇出给多个消费者
+// - 后端的数据回调只把数据写进一个 BroadcastRing，采集开销与消费者数量无关
+// - 每个消费者通过 Subscribe() 得到独立的 Subscription（读位置、溢出策略、统计），
+//   在自己的线程上拉取数据；慢消费者只会自己丢数据，不拖慢后端和其他消费者
+// - 第一个订阅启动后端，最后一个订阅释放时停止后端
+// - Shared() 按名称在进程内复用同一个引擎，多个录音或录音加实时转写共享一个设备，
+//   不再各自重建聚合设备
+class CaptureEngine : public std::enable_shared_from_this<CaptureEngine> {
+public:
+    using BackendFactory = std::function<std::unique_ptr<CaptureBackend>()>;
+
+    struct Options {
+        uint32_t bufferMilliseconds = 2000;   // 广播环形缓冲的容量
+
+        Options();
+    };
+
+    struct Stats {
+        uint64_t callbacks;         // 后端回调次数
+        uint64_t samplesWritten;    // 写入广播缓冲的样本数
+        size_t subscribers;
+    };
+
+    // 一个消费者的读端，销毁时自动退订
+    class Subscription {
+    public:
+        ~Subscription();
+
+        Subscription(const Subscription&) = delete;
+        Subscription& operator=(const Subscription&) = delete;
+
+        // 读取 frames 帧交织数据，数据不足时立即返回 false
+        bool Read(float* interleaved, size_t frames);
+
+        size_t AvailableFrames() const;
+        BroadcastRing::Reader::Stats GetStats() const;
+
+        // 下一次读取的第一帧在引擎采集流中的绝对位置（帧），不同订阅之间可以直接比较
+        uint64_t Position() const;
+
+        int SampleRate() const { return sampleRate_; }
+        size_t Channels() const { return channels_; }
+
+    private:
+        friend class CaptureEngine;
+        Subscription(std::shared_ptr<CaptureEngine> engine, BroadcastRing::Reader::OverflowPolicy policy);
+
+        std::shared_ptr<CaptureEngine> engine_;
+        BroadcastRing::Reader reader_;
+        int sampleRate_;
+        size_t channels_;
+    };
+
+    // backend 的 SampleRate()/Channels() 此时必须已经有效（例如 HeadlessCaptureBackend 已 Open()），
+    // 广播缓冲按它们一次性分配
+    static std::shared_ptr<CaptureEngine> Create(std::unique_ptr<CaptureBackend> backend,
+                                                 const Options& options = Options());
+
+    // 取得名为 name 的共享引擎，不存在时用 factory 创建；引擎在最后一个引用释放后销毁
+    static std::shared_ptr<CaptureEngine> Shared(const std::string& name, const BackendFactory& factory,
+                                                 const Options& options = Options());
+
+    ~CaptureEngine();
+
+    CaptureEngine(const CaptureEngine&) = delete;
+    CaptureEngine& operator=(const CaptureEngine&) = delete;
+
+    // 注册消费者，必要时启动后端；后端启动失败返回 nullptr
+    // 新订阅只看到订阅之后采集的数据
+    std::unique_ptr<Subscription> Subscribe(
+        BroadcastRing::Reader::OverflowPolicy policy = BroadcastRing::Reader::OverflowPolicy::DropOldest);
+
+    bool IsRunning() const;
+    int SampleRate() const { return backend_->SampleRate(); }
+    size_t Channels() const { return backend_->Channels(); }
+
+    Stats GetStats() const;
+
+private:
+    CaptureEngine(std::unique_ptr<CaptureBackend> backend, const Options& options);
+
+    void Unsubscribe();
+    void OnData(const float* interleaved, size_t frames);
+
+    std::unique_ptr<CaptureBackend> backend_;
+    Options options_;
+
+    mutable std::mutex mutex_;   // 保护订阅计数和后端的启停
+    size_t subscribers_;
+    std::unique_ptr<BroadcastRing> ring_;
+
+    // 只由后端回调线程写入
+    std::atomic<uint64_t> callbacks_;
+    std::atomic<uint64_t> samplesWritten_;
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "capture_engine.h"
+#include "preroll_buffer.h"
+#include "streaming_wav_writer.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// 把一个 CaptureEngine 订阅流式写盘的录音，可选从预录缓冲中取开始前的历史
+// - Start() 先订阅，以新订阅的起点为截止位置把 PrerollBuffer 中的历史写在文件开头，
+//   之后接着写订阅读到的实时数据，接缝处样本连续
+// - 拼接和实时数据都在录音自己的线程上写入，写入队列满时等待（背压）而不是丢弃；
+//   拼接期间实时数据留在广播缓冲中，缓冲容量需大于拼接耗时，否则按 DropOldest 丢弃
+// - 系统音频和麦克风各由一个引擎提供时，各自建一个 PrerollBuffer 和 CaptureRecording
+class CaptureRecording {
+public:
+    struct Options {
+        StreamingWavWriter::Options writer;      // sampleRate/channels 取自引擎
+        std::shared_ptr<PrerollBuffer> preroll;  // 为空时不拼接历史
+        double prerollSeconds = 0.0;             // 从开始前多少秒开始录
+        uint32_t pollMilliseconds = 10;
+
+        Options();
+    };
+
+    struct Stats {
+        uint64_t startFrame;      // 文件第一帧在引擎采集流中的绝对位置
+        uint64_t prerollFrames;   // 从历史中拼接的帧数
+        uint64_t liveFrames;      // Start() 之后采集的帧数
+        uint64_t droppedSamples;  // 订阅被广播缓冲覆盖丢弃的样本数
+    };
+
+    explicit CaptureRecording(std::shared_ptr<CaptureEngine> engine);
+    ~CaptureRecording();
+
+    CaptureRecording(const CaptureRecording&) = delete;
+    CaptureRecording& operator=(const CaptureRecording&) = delete;
+
+    bool Start(const std::string& path, const Options& options);
+    // 写完订阅中已到达的数据后关闭文件
+    void Stop();
+    bool IsRecording() const { return thread_.joinable(); }
+
+    Stats GetStats() const;
+
+private:
+    void RecordLoop();
+    // 等待写入队列有空间后写入；abortOnStop 为 true 时停止请求会中断等待并返回 false（用于拼接历史）
+    bool WriteBlocking(const float* interleaved, size_t frames, bool abortOnStop);
+
+    std::shared_ptr<CaptureEngine> engine_;
+    Options options_;
+    std::unique_ptr<CaptureEngine::Subscription> subscription_;
+    StreamingWavWriter writer_;
+    uint64_t endFrame_;   // 历史的截止位置，即订阅的起点
+
+    std::atomic<uint64_t> startFrame_;
+    std::atomic<uint64_t> prerollFrames_;
+    std::atomic<uint64_t> liveFrames_;
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopRequested_;
+};
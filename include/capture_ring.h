@@ -0,0 +1,78 @@
+#pragma once
+
+#include "ring_buffer.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// 采集线程到消费者之间的环形缓冲，存储格式和声道数在运行时按协商出的设备格式确定
+// - 容量按毫秒指定，Configure() 时按采样率换算为帧数（向上取整为 2 的幂），不同采样率/声道数下缓冲时长一致
+// - Int16/Int24 在写入的拷贝中量化、在读取的拷贝中还原为 float，同样时长的内存占用和带宽为 Float32 的 1/2 和 3/4；
+//   量化误差分别约 -96 dBFS 和 -144 dBFS，不加抖动，超出 [-1, 1) 的样本削波
+// - 读写和丢弃都以整帧为单位，内部按声道数（1~8）选择 BasicRingBuffer<Sample, 声道数> 的实例
+// - Write()/Read() 分别只由一个线程调用，与 BasicRingBuffer 相同，不加锁、不分配
+class CaptureRing {
+public:
+    enum class Storage {
+        Float32,
+        Int16,
+        Int24
+    };
+
+    struct Options {
+        Storage storage = Storage::Float32;
+        uint32_t capacityMilliseconds = 4000;
+        RingBufferBase::OverflowPolicy policy = RingBufferBase::OverflowPolicy::DropOldest;
+
+        Options();
+
+        // RECORDER_RING_FORMAT=float32/int16/int24，RECORDER_RING_MS=缓冲时长
+        static Options FromEnvironment();
+    };
+
+    static constexpr size_t kMaxChannels = 8;
+
+    CaptureRing();
+    ~CaptureRing();
+
+    CaptureRing(const CaptureRing&) = delete;
+    CaptureRing& operator=(const CaptureRing&) = delete;
+
+    // 分配缓冲区，丢弃已缓冲的数据；不能与 Write()/Read() 并发。声道数超出 1~8 或采样率无效时返回 false
+    bool Configure(const Options& options, int sampleRate, size_t channels);
+    bool IsConfigured() const { return ring_ != nullptr; }
+
+    int SampleRate() const { return sampleRate_; }
+    size_t Channels() const { return channels_; }
+    Storage GetStorage() const { return options_.storage; }
+
+    // frames 帧交织的 float 样本；未配置时 Write() 丢弃数据并返回 false
+    bool Write(const float* interleaved, size_t frames);
+    bool Read(float* interleaved, size_t frames);
+
+    size_t AvailableFrames() const;
+    size_t CapacityFrames() const;
+    size_t StorageBytes() const;
+
+    // 统计以帧为单位
+    RingBufferBase::Stats GetStats() const;
+
+    // 只能在生产者和消费者都停止时调用
+    void Clear();
+
+    static const char* StorageName(Storage storage);
+    static bool ParseStorage(const char* name, Storage* storage);
+
+private:
+    class Ring;
+    template <typename Sample, size_t Channels>
+    class TypedRing;
+
+    template <typename Sample>
+    static Ring* NewRing(size_t channels, size_t frames, RingBufferBase::OverflowPolicy policy);
+
+    Options options_;
+    int sampleRate_;
+    size_t channels_;
+    std::unique_ptr<Ring> ring_;
+};
@@ -0,0 +1,218 @@
+#pragma once
+
+#include "capture_backend.h"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 采集轨迹：把管线实际收到的每一块采集数据连同时间戳、块大小、格式变化和设备事件写入二进制文件，
+// 用于复现现场问题和跨版本做逐位一致的回放对比（类似 WebRTC 的 aec_dump），见 recorder_replay
+//
+// 文件格式（小端）：16 字节文件头（"RECTRACE" + 版本号），之后是一条条 8 字节对齐的记录；
+// 每条记录以 RecordHeader 开头，size 为含头部和填充的总长度，arrivalNanos 是采集线程交出这块数据的时刻
+// （PipelineMetrics::NowNanoseconds()），回放按它恢复各路回调的先后顺序和节奏
+namespace CaptureTrace {
+
+enum class RecordType : uint8_t {
+    Stream = 1,   // 注册一路流：StreamHeader + 名称
+    Format = 2,   // 格式变化：StreamHeader，之后的块按新格式
+    Block = 3,    // 一块交织 float32 数据：BlockHeader + 样本
+    Gap = 4,      // 写入队列满丢掉的数据：GapHeader
+    Event = 5     // 设备事件等文本：名称字段存放文本，stream 为 kNoStream 时不属于任何一路
+};
+
+constexpr uint8_t kNoStream = 0xFF;
+constexpr size_t kMaxStreams = 8;
+constexpr uint32_t kVersion = 1;
+
+struct FileHeader {
+    char magic[8];        // "RECTRACE"
+    uint32_t version;
+    uint32_t reserved;
+};
+
+struct RecordHeader {
+    uint32_t size;
+    uint8_t type;
+    uint8_t stream;
+    uint16_t reserved;
+    uint64_t arrivalNanos;
+};
+
+struct StreamHeader {
+    uint32_t sampleRate;
+    uint16_t channels;
+    uint16_t textLength;  // 紧随其后的名称（或事件文本）字节数
+};
+
+struct BlockHeader {
+    uint32_t frames;
+    uint32_t sampleRate;
+    uint16_t channels;
+    uint16_t reserved;
+    uint32_t timestampFlags;   // CaptureTimestamp::flags
+    uint64_t hostNanos;
+    double sampleTime;
+};
+
+struct GapHeader {
+    uint64_t frames;
+};
+
+} // namespace CaptureTrace
+
+// 写入采集轨迹
+// - 每一路流有自己的无锁单生产者队列，Record() 只做一次拷贝，不加锁、不分配、不做系统调用；
+//   队列满时丢弃这块数据，下一次写入成功时先补一条 Gap 记录
+// - 后台线程定期把各队列和事件按整条记录批量写盘
+// - Event() 可以在任意非实时线程调用（加锁）
+class CaptureTraceWriter {
+public:
+    struct Options {
+        uint32_t queueMilliseconds = 2000;   // 每路队列按注册时的格式能缓存的时长
+        uint32_t pollMilliseconds = 10;      // 写线程轮询间隔
+        size_t batchBytes = 256 * 1024;      // 单次写盘的目标大小
+
+        Options();
+    };
+
+    struct Stats {
+        uint64_t blocks;          // 写入队列的块数
+        uint64_t droppedBlocks;   // 队列满丢弃的块数
+        uint64_t bytesWritten;    // 已经写盘的字节数
+    };
+
+    CaptureTraceWriter();
+    ~CaptureTraceWriter();
+
+    CaptureTraceWriter(const CaptureTraceWriter&) = delete;
+    CaptureTraceWriter& operator=(const CaptureTraceWriter&) = delete;
+
+    // 创建文件并启动写线程
+    bool Open(const std::string& path, const Options& options = Options());
+
+    // 注册一路流，返回流号，失败返回 -1；在该流第一次 Record() 之前、非实时线程上调用
+    int AddStream(const std::string& name, int sampleRate, size_t channels);
+
+    // 格式变化，由该流的采集线程调用（与 Record() 同一线程），之后的块按新格式记录
+    bool SetFormat(int stream, int sampleRate, size_t channels);
+
+    // 采集线程调用，frames 帧交织 float；未打开或队列满时返回 false
+    bool Record(int stream, const float* interleaved, size_t frames, const CaptureTimestamp& timestamp);
+
+    // 设备事件，stream 为 -1 时不属于任何一路
+    void Event(int stream, const std::string& text);
+
+    // 写完队列中剩余的数据并关闭文件
+    void Close();
+
+    bool IsOpen() const { return open_.load(std::memory_order_acquire); }
+
+    Stats GetStats() const;
+
+private:
+    class Queue;
+    struct Stream;
+
+    void WriterLoop();
+    bool DrainQueues();
+    bool Append(const void* data, size_t size);
+    bool Flush();
+
+    Options options_;
+    std::string path_;
+    int fd_;
+    std::array<std::unique_ptr<Stream>, CaptureTrace::kMaxStreams> streams_;
+    std::atomic<size_t> streamCount_;
+
+    std::thread thread_;
+    std::mutex mutex_;                 // 保护 events_、stopRequested_ 和流的注册
+    std::condition_variable cv_;
+    std::vector<uint8_t> events_;      // 尚未写盘的事件记录
+    bool stopRequested_;
+    std::atomic<bool> open_;
+
+    // 以下成员只在写线程访问（Close() 在写线程退出后访问）
+    std::vector<uint8_t> staging_;
+    uint64_t fileOffset_;
+    bool writeFailed_;
+
+    std::atomic<uint64_t> bytesWritten_;
+};
+
+// 读取采集轨迹：内存映射整个文件，按到达时刻建立记录索引；块数据直接指向映射区，不拷贝
+// 文件末尾被截断的记录（进程中途退出）忽略
+class CaptureTraceReader {
+public:
+    struct StreamInfo {
+        std::string name;
+        int sampleRate;            // 注册时的格式
+        size_t channels;
+        size_t maxBlockFrames;     // 按注册时的格式记录的块中最大的帧数
+        uint64_t blocks;
+        uint64_t frames;
+        uint64_t gapFrames;        // 写轨迹时队列满丢掉的帧数
+        uint64_t formatChanges;
+    };
+
+    struct Record {
+        CaptureTrace::RecordType type;
+        int stream;                 // 不属于任何一路时为 -1
+        uint64_t arrivalNanos;
+        // Stream/Format/Block
+        int sampleRate;
+        size_t channels;
+        // Block
+        const float* samples;
+        size_t frames;
+        CaptureTimestamp timestamp;
+        // Gap
+        uint64_t gapFrames;
+        // Stream 的名称或 Event 的文本，指向映射区，不以 0 结尾
+        const char* text;
+        size_t textLength;
+    };
+
+    CaptureTraceReader();
+    ~CaptureTraceReader();
+
+    CaptureTraceReader(const CaptureTraceReader&) = delete;
+    CaptureTraceReader& operator=(const CaptureTraceReader&) = delete;
+
+    bool Open(const std::string& path);
+    void Close();
+
+    bool IsOpen() const { return mapping_ != nullptr; }
+
+    const std::vector<StreamInfo>& Streams() const { return streams_; }
+
+    // 按名称查找流号，找不到返回 -1
+    int FindStream(const std::string& name) const;
+
+    // 按到达时刻排序（同一时刻保持文件中的顺序）的记录
+    size_t RecordCount() const { return index_.size(); }
+    Record GetRecord(size_t index) const;
+
+    // 第一条和最后一条记录的到达时刻之差
+    uint64_t DurationNanos() const;
+
+private:
+    struct Entry {
+        uint64_t arrivalNanos;
+        uint64_t offset;
+    };
+
+    bool BuildIndex(const std::string& path);
+
+    void* mapping_;
+    size_t mappingSize_;
+    std::vector<Entry> index_;
+    std::vector<StreamInfo> streams_;
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 分段录音的块文件存储，一个目录对应一路录音
+// - 音频按固定帧数切成块文件，每个块在创建时预分配并整体 mmap，写入只是内存拷贝，稳态下没有系统调用
+// - 块头（文件前 4KB）里的帧数随每次提交更新，进程崩溃后仍能知道最后一块写到了哪里
+// - 块写满后计算数据的 CRC32C、msync，再向索引文件原子追加一条带自校验的记录
+// - 崩溃恢复只需读取索引和最后一个块头，耗时与块数成正比，不需要扫描整个文件
+// 只允许一个线程使用写入接口
+class ChunkStore {
+public:
+    struct Format {
+        uint32_t sampleRate = 0;
+        uint16_t channels = 0;
+        uint16_t bytesPerSample = 0;   // 4 为 float32，2 为 int16
+        uint32_t chunkFrames = 0;      // 每个块的帧数
+    };
+
+    struct Chunk {
+        std::string path;
+        uint32_t sequence;
+        uint64_t frames;
+        uint32_t crc;
+        bool indexed;      // 索引中有记录；否则是崩溃时正在写的块
+        bool intact;       // CRC 校验通过，或未要求校验
+    };
+
+    // Load() 的结果
+    struct Listing {
+        Format format;
+        std::vector<Chunk> chunks;
+        uint64_t frames = 0;
+        size_t corruptChunks = 0;   // CRC 不一致的块，数据仍会保留
+    };
+
+    // 块文件中音频数据的起始偏移
+    static constexpr size_t kDataOffset = 4096;
+
+    ChunkStore();
+    ~ChunkStore();
+
+    ChunkStore(const ChunkStore&) = delete;
+    ChunkStore& operator=(const ChunkStore&) = delete;
+
+    // 创建目录、索引文件和第一个块；目录必须不存在或为空
+    bool Create(const std::string& directory, const Format& format);
+
+    // 当前块的写入位置和剩余帧数
+    uint8_t* WritePointer() const;
+    size_t WritableFrames() const;
+
+    // 提交已写入 WritePointer() 的帧；块写满时封存并映射下一个块，失败返回 false
+    bool Commit(size_t frames);
+
+    // 封存当前块并关闭索引，之后不能再写入
+    bool Close();
+
+    uint64_t Frames() const { return sealedFrames_ + activeFrames_; }
+    const std::string& Directory() const { return directory_; }
+
+    // 读取目录中的索引和块头；verify 为 true 时重新计算每个块的 CRC32C
+    static bool Load(const std::string& directory, bool verify, Listing* listing);
+
+    // 把所有块的音频数据按顺序拷贝到 fd 的 offset 处（内核内拷贝，不经过用户态缓冲时最快）
+    static bool Export(const Listing& listing, int fd, uint64_t offset);
+
+    // 删除块文件、索引和目录
+    static bool Remove(const std::string& directory);
+
+private:
+    bool MapChunk(uint32_t sequence);
+    bool SealChunk();
+    void UnmapChunk();
+
+    std::string directory_;
+    Format format_;
+    size_t bytesPerFrame_;
+    int indexFd_;
+
+    int chunkFd_;              // 当前块的文件，封存最后一个不满的块时用来截断
+    uint8_t* mapping_;
+    size_t mappingSize_;
+    uint32_t sequence_;
+    uint64_t activeFrames_;
+    uint64_t sealedFrames_;
+};
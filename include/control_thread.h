@@ -0,0 +1,40 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// 串行执行控制命令的专用线程
+// 启动/停止录音要做设备协商、HAL 往返和文件收尾，耗时可达数百毫秒，
+// 调用方（例如 JS 主线程）只负责投递，命令按投递顺序在本线程上逐个执行
+class ControlThread {
+public:
+    using Task = std::function<void()>;
+
+    ControlThread();
+
+    // 执行完已投递的命令后退出
+    ~ControlThread();
+
+    ControlThread(const ControlThread&) = delete;
+    ControlThread& operator=(const ControlThread&) = delete;
+
+    // 任意线程调用，不等待执行
+    void Post(Task task);
+
+    // 不等待线程退出：执行完已投递的命令后由线程自己释放本对象，用于不能阻塞的调用方（如 GC 终结器）；
+    // 对象必须由 new 创建，调用后不能再访问
+    void Detach();
+
+private:
+    void Loop();
+
+    std::deque<Task> tasks_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopRequested_;
+    bool detached_;
+    std::thread thread_;
+};
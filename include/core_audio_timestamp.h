@@ -0,0 +1,22 @@
+#pragma once
+
+#include "capture_backend.h"
+#include <CoreAudio/CoreAudio.h>
+
+// AudioTimeStamp（IOProc 的 inInputTime、AUHAL 的 inTimeStamp、AVAudioTime.audioTimeStamp）转为 CaptureTimestamp，
+// 只取标记为有效的主机时间和采样时间；mHostTime 换算为纳秒后与 steady_clock 同源
+inline CaptureTimestamp ToCaptureTimestamp(const AudioTimeStamp* time) {
+    CaptureTimestamp timestamp;
+    if (!time) {
+        return timestamp;
+    }
+    if (time->mFlags & kAudioTimeStampHostTimeValid) {
+        timestamp.hostNanos = AudioConvertHostTimeToNanos(time->mHostTime);
+        timestamp.flags |= CaptureTimestamp::kHostTimeValid;
+    }
+    if (time->mFlags & kAudioTimeStampSampleTimeValid) {
+        timestamp.sampleTime = time->mSampleTime;
+        timestamp.flags |= CaptureTimestamp::kSampleTimeValid;
+    }
+    return timestamp;
+}
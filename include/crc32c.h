@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// CRC32C（Castagnoli 多项式），用于分段录音的块文件和索引校验
+// - x86 上使用 SSE4.2 的 crc32 指令，ARM64 上使用 CRC 扩展指令，首次调用时按 CPU 能力选择
+// - 其余情况使用按 8 字节查表的标量实现，结果与硬件指令一致
+namespace Crc32c {
+
+// 在 crc（前面数据的结果，初始为 0）的基础上继续计算 data
+uint32_t Extend(uint32_t crc, const void* data, size_t size);
+
+inline uint32_t Compute(const void* data, size_t size) {
+    return Extend(0, data, size);
+}
+
+// 当前生效的实现：scalar、sse4.2 或 arm-crc
+const char* ImplementationName();
+
+} // namespace Crc32c
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "ring_buffer.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// 时钟漂移补偿重采样
+// 系统音频 tap 与麦克风来自不同的时钟，名义采样率相同也会慢慢错开。
+// 本类把 tap 数据放进有界 FIFO，由会话时钟（消费者）按需拉取并重采样到会话采样率；
+// 根据 FIFO 水位用 PI 控制器微调重采样比例，使水位（即两路之间的延迟）稳定在目标值。
+// - Push() 只由生产者线程调用（系统音频 IOProc），Pull() 只由消费者线程调用（渲染回调）
+// - 两个接口都不分配内存、不加锁
+class DriftCompensatingResampler {
+public:
+    struct Options {
+        int inputRate = 44100;            // 输入的名义采样率
+        int outputRate = 48000;           // 会话采样率
+        size_t channels = 2;
+        uint32_t targetLatencyMs = 40;    // 启动时 FIFO 预存量，决定两路之间的固定延迟
+        uint32_t capacityMs = 500;        // FIFO 容量，超出时丢弃最旧的数据
+        double maxCorrectionPpm = 1000;   // 比例修正上限
+        size_t requestFrames = 128;       // SincResampler 每次读取的输入帧数，越小水位抖动越小
+        size_t maxPullFrames = 4096;      // 单次 Pull() 的最大帧数
+    };
+
+    struct Stats {
+        double correctionPpm;          // 当前比例修正
+        double latencyFrames;          // 已送入但尚未输出的输入帧数，包括重采样器内部缓存
+        double consumedFrames;         // 当前输出对应的输入位置（含小数，计入启动时跳过和溢出丢弃的帧）
+        uint64_t inputFrames;          // 累计送入的帧数
+        uint64_t outputFrames;         // 累计输出的帧数
+        uint64_t underruns;            // FIFO 数据不足、以静音补齐的次数
+        size_t droppedSamples;         // FIFO 溢出丢弃的样本数
+    };
+
+    DriftCompensatingResampler();
+    ~DriftCompensatingResampler();
+
+    DriftCompensatingResampler(const DriftCompensatingResampler&) = delete;
+    DriftCompensatingResampler& operator=(const DriftCompensatingResampler&) = delete;
+
+    // 首次初始化时生产者可以已在运行（初始化完成前 Push 直接返回）；重新初始化需两个音频线程都停止
+    bool Initialize(const Options& options);
+
+    bool IsInitialized() const { return initialized_.load(std::memory_order_acquire); }
+
+    // 写入交织输入
+    void Push(const float* interleaved, size_t frames);
+
+    // 输出 frames 帧交织数据；FIFO 首次达到目标水位之前输出静音
+    void Pull(float* interleaved, size_t frames);
+
+    Stats GetStats() const;
+
+private:
+    class ChannelReader;
+
+    void ReadChunk(size_t frames);
+    double LatencyFrames() const;
+    void UpdateRatio(size_t frames);
+
+    Options options_;
+    std::atomic<bool> initialized_;
+    std::unique_ptr<RingBuffer> fifo_;
+
+    // 以下成员只在消费者线程访问
+    std::vector<std::unique_ptr<ChannelReader>> readers_;
+    std::vector<float> chunk_;          // 本次从 FIFO 读出的交织输入
+    std::vector<float> planarOut_;      // 单声道重采样输出
+    double nominalRatio_;
+    double ratio_;
+    double integral_;
+    double filteredLatency_;
+    double targetLatency_;
+    double warmupSum_;
+    size_t warmupFrames_;               // 剩余预热帧数，预热期间不调整比例
+    size_t warmupTotal_;
+    size_t sinceRatioUpdate_;           // 距上次更新比例的输出帧数
+    size_t chunkCount_;
+    bool primed_;
+
+    std::atomic<uint64_t> inputFrames_;
+    std::atomic<uint64_t> outputFrames_;
+    std::atomic<uint64_t> underruns_;
+    std::atomic<uint64_t> skippedFrames_;  // 启动时丢弃的积压
+    std::atomic<uint64_t> framesRead_;     // 从 FIFO 读给重采样器的帧数
+    std::atomic<double> consumedFrames_;   // 重采样器按比例实际消耗的帧数
+    std::atomic<double> correctionPpm_;
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "pipeline_metrics.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// 按 AudioProcessingImpl 的顺序运行的 10ms 帧处理链（WebRTC 子集）：
+// 高通滤波 → 回声消除（AEC3，可选）→ 噪声抑制 → AGC2（固定增益、自适应数字增益、限幅）
+// - 高通、回声消除和噪声抑制在 webrtc::AudioBuffer 分频后的子带上处理，AGC2 作用于合并后的全带
+// - 输入输出为非交织 float（满幅 1），非 16k/32k/48k 的采样率在 AudioBuffer 内重采样后处理
+// - 自适应增益的语音概率来自 common_audio 的 VAD（agc2/rnn_vad 未随仓库提供）
+// - 每级耗时单独统计，可同时记入 PipelineMetrics
+// - ProcessFrame/AnalyzeRender 不加锁、不分配内存，但耗时不适合放在音频回调里，见 DspWorker
+class DspChain {
+public:
+    enum Stage : size_t {
+        kHighPass,
+        kEchoCancellation,
+        kNoiseSuppression,
+        kGainControl,
+        kStageCount
+    };
+
+    struct Options {
+        int sampleRate = 48000;
+        size_t channels = 1;
+        bool highPassFilter = true;
+        bool echoCancellation = false;       // 需要通过 AnalyzeRender() 送入远端参考
+        size_t renderChannels = 2;           // 远端参考声道数，采样率与近端相同
+        bool noiseSuppression = true;
+        int noiseSuppressionLevel = 1;       // 0~3 对应抑制 6/12/18/21 dB
+        bool gainControl = true;             // AGC2，包括最后的限幅
+        float fixedGainDb = 0.0f;
+        bool adaptiveGain = true;
+        PipelineMetrics* metrics = nullptr;  // 非空时各级耗时记入 <metricsPrefix>.<级名>_ns
+        std::string metricsPrefix = "dsp";
+
+        Options();
+    };
+
+    struct StageStats {
+        uint64_t frames;
+        uint64_t averageNanos;   // 每个 10ms 帧的平均耗时
+        uint64_t maxNanos;
+    };
+
+    struct Stats {
+        StageStats stages[kStageCount];
+        StageStats total;        // 整帧耗时，包括分频/合并和格式转换
+        float speechLevelDbfs;   // 自适应增益当前的语音电平估计
+    };
+
+    DspChain();
+    ~DspChain();
+
+    DspChain(const DspChain&) = delete;
+    DspChain& operator=(const DspChain&) = delete;
+
+    bool Initialize(const Options& options);
+    void Release();
+
+    bool IsInitialized() const { return initialized_.load(std::memory_order_acquire); }
+
+    // 10ms 对应的帧数
+    size_t FrameSize() const { return frameSize_; }
+
+    // 一个 10ms 远端参考帧，renderChannels 个非交织声道；未开启回声消除时忽略
+    void AnalyzeRender(const float* const* channels);
+
+    // 一个 10ms 近端帧，channels 个非交织声道，原地写回处理结果
+    void ProcessFrame(float* const* channels);
+
+    // 任意线程调用
+    Stats GetStats() const;
+
+    static const char* StageName(Stage stage);
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+    std::atomic<bool> initialized_;
+    size_t frameSize_;
+};
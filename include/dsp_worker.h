@@ -0,0 +1,137 @@
+#pragma once
+
+#include "broadcast_ring.h"
+#include "dsp_chain.h"
+#include "ring_buffer.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class StreamingWavWriter;
+
+// DSP 工作线程池：把 DspChain 的 10ms 帧处理移出音频 IO 线程
+// - IO 线程只调用 Session::Write()/WriteRender()，把样本拷进会话自己的 SPSC 环形缓冲，不做任何处理、不通知
+// - 工作线程按 pollMilliseconds 轮询分到自己名下的会话，凑满 10ms 即运行处理链，
+//   结果交给会话的输出：StreamingWavWriter（写盘）、BroadcastRing（扇出给多个消费者）或回调
+// - 会话按数量均衡分配到各线程，一个会话始终由同一线程处理；多个录音会话共享同一组线程
+// - 工作线程没有实时约束，处理跟不上时只会让会话的输入缓冲溢出（计入 droppedFrames），不影响 IO 线程
+class DspWorker {
+public:
+    struct Options {
+        size_t threads = 1;
+        uint32_t pollMilliseconds = 5;
+
+        Options();
+    };
+
+    struct Stats {
+        size_t sessions;
+        std::vector<uint64_t> busyNanoseconds;   // 各线程累计处理耗时，除以墙钟即为负载
+    };
+
+    class Session {
+    public:
+        using Sink = std::function<void(const float* interleaved, size_t frames)>;
+
+        struct Options {
+            DspChain::Options chain;              // 处理链，chain.channels 同时是输入输出的声道数
+            uint32_t bufferMilliseconds = 500;    // 输入环形缓冲的容量
+            StreamingWavWriter* writer = nullptr; // 以下输出都在工作线程上写入，可以同时设置
+            BroadcastRing* broadcast = nullptr;
+            Sink sink;
+
+            Options();
+        };
+
+        struct Stats {
+            uint64_t inputFrames;       // IO 线程写入的帧数
+            uint64_t processedFrames;   // 已处理并输出的帧数
+            uint64_t droppedFrames;     // 输入缓冲满丢弃的帧数
+            size_t queuedFrames;        // 尚未处理的帧数
+            DspChain::Stats chain;
+        };
+
+        // 销毁时从工作线程摘下，在调用线程上处理完剩余输入（不足 10ms 的尾部补零处理，只输出实际帧数）
+        ~Session();
+
+        Session(const Session&) = delete;
+        Session& operator=(const Session&) = delete;
+
+        // 仅由 IO 线程调用：只拷贝，缓冲满时丢弃本次数据并返回 false
+        bool Write(const float* interleaved, size_t frames);
+
+        // 远端参考（chain.echoCancellation 开启时），声道数为 chain.renderChannels，由另一 IO 线程调用
+        bool WriteRender(const float* interleaved, size_t frames);
+
+        // 输入缓冲中尚未处理的帧数和容量，调用方可据此做背压
+        size_t QueuedFrames() const;
+        size_t QueueCapacityFrames() const;
+
+        Stats GetStats() const;
+
+    private:
+        friend class DspWorker;
+        explicit Session(const Options& options);
+
+        bool Initialize();
+        // 处理所有完整的 10ms 帧，由负责该会话的线程调用
+        void Pump();
+        void ProcessFrame(size_t frames);
+
+        Options options_;
+        DspChain chain_;
+        size_t frameSize_;
+        std::unique_ptr<RingBuffer> input_;
+        std::unique_ptr<RingBuffer> render_;
+        std::vector<float> frame_;
+        std::vector<std::vector<float>> planar_;
+        std::vector<float*> planes_;
+        std::vector<float> renderFrame_;
+        std::vector<std::vector<float>> renderPlanar_;
+        std::vector<float*> renderPlanes_;
+
+        DspWorker* worker_;
+        size_t slot_;
+
+        std::atomic<uint64_t> inputFrames_;
+        std::atomic<uint64_t> processedFrames_;
+        std::atomic<uint64_t> droppedFrames_;
+    };
+
+    explicit DspWorker(const Options& options = Options());
+    ~DspWorker();
+
+    DspWorker(const DspWorker&) = delete;
+    DspWorker& operator=(const DspWorker&) = delete;
+
+    // 进程内共享的工作线程池（线程数为 CPU 核数的一半），最后一个引用释放后线程退出
+    static std::shared_ptr<DspWorker> Shared();
+
+    // 创建会话并分配给当前会话最少的线程；处理链初始化失败返回 nullptr。会话必须先于 DspWorker 销毁
+    std::unique_ptr<Session> AddSession(const Session::Options& options);
+
+    Stats GetStats() const;
+
+private:
+    struct Slot {
+        std::thread thread;
+        std::mutex mutex;                // 保护 sessions，工作线程处理一轮期间持有
+        std::vector<Session*> sessions;
+        std::atomic<uint64_t> busyNanoseconds{0};
+    };
+
+    void WorkerLoop(Slot* slot);
+    void Detach(Session* session);
+
+    Options options_;
+    std::vector<std::unique_ptr<Slot>> slots_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopRequested_;
+};
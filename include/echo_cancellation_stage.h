@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// 基于 WebRTC AEC3 的回声消除处理级
+// - 远端参考（系统音频）通过 AnalyzeRender() 送入，近端（麦克风）通过 ProcessCapture() 原地处理
+// - 内部按 10ms 分帧，输入块大小任意，近端输出固定延迟 LatencyFrames() 帧
+// - 音频线程上的两个接口不加锁、不分配内存；AnalyzeRender 与 ProcessCapture 可以在不同线程调用
+// - 远端与近端采样率可以不同，非 16k/32k/48k 的采样率在内部重采样后处理
+class EchoCancellationStage {
+public:
+    struct Options {
+        int sampleRate = 48000;          // 近端采样率
+        int renderSampleRate = 0;        // 远端采样率，0 表示与近端相同
+        size_t renderChannels = 2;       // 远端参考声道数
+        size_t captureChannels = 1;      // 近端声道数
+        bool highPassFilter = true;      // 回声消除前先做高通滤波
+        int streamDelayMs = -1;          // 已知的系统缓冲延迟提示，<0 表示交给 AEC3 自行估计
+    };
+
+    struct Stats {
+        double echoReturnLossDb;               // ERL
+        double echoReturnLossEnhancementDb;    // ERLE
+        int delayMs;                           // AEC3 估计的回声延迟
+        uint64_t renderFrames;                 // 已送入的远端 10ms 帧数
+        uint64_t captureFrames;                // 已处理的近端 10ms 帧数
+        uint64_t averageProcessNanos;          // 每个近端 10ms 帧的平均处理耗时
+        uint64_t maxProcessNanos;              // 单帧最大处理耗时
+    };
+
+    EchoCancellationStage();
+    ~EchoCancellationStage();
+
+    EchoCancellationStage(const EchoCancellationStage&) = delete;
+    EchoCancellationStage& operator=(const EchoCancellationStage&) = delete;
+
+    // 在音频回调停止时由非实时线程调用；重复调用会重建内部状态
+    bool Initialize(const Options& options);
+    void Release();
+
+    bool IsInitialized() const { return initialized_.load(std::memory_order_acquire); }
+
+    // 远端参考，interleaved 为交织格式，声道数为 renderChannels
+    void AnalyzeRender(const float* interleaved, size_t frames);
+
+    // 近端处理，channels 为 captureChannels 个非交织声道，原地写回处理结果
+    void ProcessCapture(float* const* channels, size_t frames);
+
+    // 10ms 对应的帧数，也是近端输出相对输入的延迟
+    size_t LatencyFrames() const { return frameSize_; }
+
+    // 任意线程调用，返回最近一次刷新的统计；只读本对象上的原子计数，不访问内部状态，
+    // 可以与 Initialize()/Release() 并发，重新初始化期间可能读到新旧混合的值
+    Stats GetStats() const;
+
+private:
+    class Impl;
+
+    // 对外统计放在 Impl 之外，Release() 释放 Impl 时 GetStats() 仍可安全读取
+    struct Counters {
+        std::atomic<uint64_t> renderFrames{0};
+        std::atomic<uint64_t> captureFrames{0};
+        std::atomic<uint64_t> totalProcessNanos{0};
+        std::atomic<uint64_t> maxProcessNanos{0};
+        std::atomic<double> echoReturnLoss{0.0};
+        std::atomic<double> echoReturnLossEnhancement{0.0};
+        std::atomic<int> delayMs{0};
+
+        void Reset();
+    };
+
+    std::unique_ptr<Impl> impl_;
+    Counters counters_;
+    std::atomic<bool> initialized_;
+    size_t frameSize_;
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "audio_encoder.h"
+#include "audio_kernels.h"
+#include <vector>
+
+// FLAC 无损编码器
+// - 每帧固定 blockFrames 个采样，各帧互不依赖：写线程攒够 threads 个块后交给共享线程池并行编码，
+//   再按顺序写盘
+// - 每个声道在常量、固定多项式预测（0~4 阶）和 LPC（最高 8 阶，Levinson-Durbin）之间选最短的编码，
+//   残差用分区 Rice 编码；立体声额外尝试 left/side、right/side、mid/side 去相关
+// - STREAMINFO 中的 MD5 置 0（表示未知），总采样数在 Flush()/Finish() 时更新
+class FlacEncoder : public AudioEncoder {
+public:
+    explicit FlacEncoder(const Options& options);
+    ~FlacEncoder() override;
+
+    bool Begin(int fd) override;
+    bool Encode(const float* interleaved, size_t frames) override;
+    bool Flush() override;
+    bool Finish() override;
+
+    uint64_t FramesEncoded() const override { return framesEncoded_; }
+    uint64_t BytesWritten() const override { return offset_; }
+
+private:
+    struct Block;
+
+    // 编码 pending_ 开头的 count 个块，最后一块可以不满
+    bool EncodeBlocks(size_t count, size_t lastFrames);
+    bool WriteStreamInfo();
+
+    Options options_;
+    size_t threads_;
+    int fd_;
+    uint64_t offset_;
+    bool failed_;
+
+    std::vector<float> pending_;    // 尚未编码的交织样本，最多 threads_ 个块
+    size_t pendingFrames_;
+    std::vector<Block> blocks_;
+    AudioKernels::DitherState dither_;
+
+    uint64_t framesEncoded_;
+    uint64_t frameNumber_;
+    uint32_t minFrameBytes_;
+    uint32_t maxFrameBytes_;
+};
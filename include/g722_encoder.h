@@ -0,0 +1,25 @@
+#pragma once
+
+#include "audio_encoder.h"
+#include <memory>
+
+// G.722 语音编码器（64kbps，约为 44.1kHz 立体声 float 的 1/44）
+// 输入先混成单声道，按 10ms 分块用 Sinc 重采样到 16kHz，再转换成 int16 交给 WebRTC 的 G.722 编码，
+// 输出为格式码 0x028F 的 WAV。输入采样率须为 100 的整数倍
+class G722Encoder : public AudioEncoder {
+public:
+    explicit G722Encoder(const Options& options);
+    ~G722Encoder() override;
+
+    bool Begin(int fd) override;
+    bool Encode(const float* interleaved, size_t frames) override;
+    bool Flush() override;
+    bool Finish() override;
+
+    uint64_t FramesEncoded() const override;
+    uint64_t BytesWritten() const override;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
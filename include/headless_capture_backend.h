@@ -0,0 +1,91 @@
+#pragma once
+
+#include "capture_backend.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// 无硬件的采集后端：从内存映射的 WAV 文件、信号发生器或采集轨迹（见 CaptureTraceReader）产生数据
+// - speed 控制节奏：1 为实时，大于 1 为按倍速加速，0 为不限速（尽快送出）
+// - 既可以 Start() 启动自带的节奏线程，也可以由调用方在自己的线程上反复调用 ProduceBlock()
+//   （例如让多路后端按同一时钟交替推进），两种方式不能混用
+// - 每块的时间戳取自一个按音频时间走的虚拟主机时钟：hostNanos = 时钟零点 + 启动延迟 + 采样时间，
+//   与 speed 无关；可以模拟设备启动延迟和丢失的 IO 周期（采样时间照常前进，数据不送出）
+// - 回放采集轨迹时按记录原样送出每一块：块大小、时间戳和数据都与录制时相同，节奏按记录的到达时刻；
+//   与注册时格式不同的块（录制中途格式变化）跳过
+class HeadlessCaptureBackend : public CaptureBackend {
+public:
+    enum class Generator {
+        Silence,
+        Sine,
+        Noise,   // 白噪声
+        Speech   // 按音节调制、带停顿的有色噪声，近似语音的能量起伏
+    };
+
+    struct Options {
+        std::string wavPath;                // 非空时从 WAV 文件读取，否则使用信号发生器
+        Generator generator = Generator::Sine;
+        int sampleRate = 48000;             // 仅信号发生器使用，文件以头部为准
+        size_t channels = 2;
+        float frequency = 440.0f;
+        float amplitude = 0.25f;
+        uint32_t seed = 1;
+        size_t blockFrames = 512;           // 每次回调的帧数
+        double speed = 1.0;
+        double durationSeconds = 0.0;       // 0 表示文件读完为止，信号发生器则不限时长
+        bool loop = false;                  // 文件读完后从头开始
+        double startDelayMilliseconds = 0.0;   // 第一帧的主机时间相对时钟零点的延迟
+        double dropoutIntervalSeconds = 0.0;   // 大于 0 时每隔这么久丢失 dropoutMilliseconds 的数据
+        double dropoutMilliseconds = 0.0;
+        std::string tracePath;              // 非空时回放采集轨迹中名为 traceStream 的一路，优先于 wavPath
+        std::string traceStream;
+    };
+
+    struct Stats {
+        uint64_t frames;       // 已送出的帧数
+        uint64_t callbacks;    // 回调次数
+        uint64_t lateBlocks;   // 节奏线程落后超过一个块的次数
+        uint64_t lostFrames;   // 模拟丢失的帧数
+        uint64_t skippedBlocks;  // 回放时因格式变化跳过的块数
+    };
+
+    explicit HeadlessCaptureBackend(const Options& options);
+    ~HeadlessCaptureBackend() override;
+
+    // 打开文件或准备信号发生器，失败时返回 false
+    bool Open();
+
+    bool Start() override;
+    void Stop() override;
+    bool IsRunning() const override;
+
+    int SampleRate() const override;
+    size_t Channels() const override;
+
+    // 虚拟主机时钟的零点，多路后端设为同一值时共用一个主机时钟；未设置时取第一块数据时的当前时刻
+    void SetClockOrigin(uint64_t hostNanos);
+
+    // 在调用线程上生成一块数据并回调，数据结束时返回 false
+    bool ProduceBlock();
+
+    // 采样时钟上的位置（秒），包括模拟丢失的数据
+    double Position() const;
+
+    // 数据已经全部送出
+    bool Finished() const;
+
+    // 单次回调的最大帧数，Open() 之后有效
+    size_t MaxBlockFrames() const;
+
+    // 是否在回放采集轨迹
+    bool IsTrace() const;
+
+    // 回放时下一块的到达时刻（录制时的 NowNanoseconds()），数据结束或不是回放时返回 UINT64_MAX
+    uint64_t NextArrivalNanos() const;
+
+    Stats GetStats() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
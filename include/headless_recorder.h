@@ -0,0 +1,118 @@
+#pragma once
+
+#include "headless_capture_backend.h"
+#include "level_meter.h"
+#include "pipeline_metrics.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// 前向声明
+class AudioRecorder;
+class PcmStream;
+
+// 无硬件平台的录音实现，接口与 MacRecorder 一致
+// 系统音频和麦克风各由一个 HeadlessCaptureBackend 提供，单个驱动线程按两路的音频时间交替推进，
+// 两路先按各块的时间戳对齐到同一会话时间线（见 StreamAligner），
+// 之后的处理与 av_engine_taps_main 相同：系统音频经漂移补偿重采样到麦克风采样率，
+// 作为回声消除的远端参考；麦克风经回声消除后与系统音频由 AudioMixer 混合（限幅，延迟 10ms），三路分别流式写盘
+// 两路都回放同一个采集轨迹时（见 recorder_replay），驱动线程按记录的到达时刻交替推进，复现录制时的回调顺序
+class HeadlessRecorder {
+public:
+    struct Options {
+        HeadlessCaptureBackend::Options system;
+        HeadlessCaptureBackend::Options microphone;
+        double speed = 1.0;              // 1 为实时，0 为不限速
+        bool echoCancellation = true;
+        uint32_t segmentSeconds = 0;     // 大于 0 时三路都按分段模式写入（见 StreamingWavWriter）
+        bool elideSilence = false;       // 三路各自省略长静音并写出编辑表（见 SilenceElider）
+        bool micProcessing = false;      // 麦克风轨道在 DSP 工作线程上经高通/降噪/AGC2 处理后写盘（见 DspWorker）
+        bool alignStreams = true;        // 按时间戳补偿两路的起始偏差和丢失的数据
+        uint32_t setupMilliseconds = 0;  // Start() 中模拟设备协商的耗时（对应 CreateTapDevice 的等待和 HAL 往返）
+        float systemAudioVolume = 1.0f;  // 混音中两路的音量，见 SetSystemAudioVolume()
+        float microphoneVolume = 1.0f;
+        std::string tracePath;           // 非空时把两路收到的每一块写入采集轨迹（见 CaptureTraceWriter），流名为 system/microphone
+
+        Options();
+
+        // 从环境变量读取：RECORDER_SYSTEM_WAV、RECORDER_MIC_WAV、RECORDER_SPEED、
+        // RECORDER_DURATION（秒）、RECORDER_AEC（0 关闭回声消除）、RECORDER_SEGMENT_SECONDS、
+        // RECORDER_SETUP_MS、RECORDER_ELIDE_SILENCE（1 开启静音省略）、RECORDER_DSP（1 开启麦克风处理）、
+        // RECORDER_ALIGN（0 关闭时间戳对齐）、RECORDER_TRACE（采集轨迹路径）
+        static Options FromEnvironment();
+    };
+
+    struct Stats {
+        double audioSeconds;             // 已处理的音频时长（麦克风时钟）
+        double wallSeconds;
+        double cpuSeconds;               // 进程 CPU 时间，包括写线程
+        uint64_t droppedFrames;          // 写入队列满丢弃的帧数
+        uint64_t resamplerUnderruns;
+        int64_t startSkewNanos;          // 对齐前麦克风第一帧相对系统音频第一帧的采集时刻差
+        int64_t streamOffsetNanos;       // 对齐后麦克风相对系统音频的剩余偏差（两路时钟漂移）
+        uint64_t alignedFrames;          // 为对齐两路补的静音和裁掉的帧数
+    };
+
+    HeadlessRecorder();
+    explicit HeadlessRecorder(AudioRecorder* recorder);
+    HeadlessRecorder(AudioRecorder* recorder, const Options& options);
+    ~HeadlessRecorder();
+
+    bool Start();
+    void Stop();
+    bool IsRecording() const;
+
+    void Pause();
+    void Resume();
+
+    bool IsRunning() const;
+
+    // 混合音频写入 path，麦克风和系统音频写入同目录的 <名称>_mic.wav、<名称>_source.wav；
+    // 扩展名为 .flac 或 .g722.wav 时三路都按对应编码压缩
+    void SetOutputPath(const std::string& path);
+    std::string GetCurrentMicrophoneApp() const;
+
+    // 混合音频同时送入 stream（见 PcmStream），传 nullptr 取消；只能在未录制时调用。
+    // 流积压时驱动线程与写入队列积压时一样暂停推进
+    void SetPcmStream(PcmStream* stream);
+
+    // 混音中系统音频/麦克风的音量，与 Start()/Stop() 在同一线程调用；录制中修改时平滑过渡
+    void SetSystemAudioVolume(float volume);
+    void SetMicrophoneVolume(float volume);
+
+    // 两路数据都有限时，等待全部处理完成
+    void WaitUntilFinished();
+
+    Stats GetStats() const;
+
+    // 管线指标快照，任意线程可调用；每次 Start() 清零
+    PipelineMetrics::Snapshot GetMetrics() const;
+
+    // 两路采集数据的电平（约 33ms 一个窗口），任意线程可调用，不加锁；每次 Start() 清零
+    CaptureLevels GetLevels() const;
+
+private:
+    class Impl;
+
+    void DriverLoop();
+
+    AudioRecorder* recorder_;
+    Options options_;
+    std::string outputPath_;
+    PcmStream* pcmStream_;
+    PipelineMetrics metrics_;
+    LevelMeter systemLevels_;
+    LevelMeter microphoneLevels_;
+    std::unique_ptr<Impl> impl_;
+
+    std::thread driver_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::atomic<bool> running_;
+    std::atomic<bool> paused_;
+    bool finished_;
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "audio_kernels.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// 一路采集数据的电平表：峰值、RMS、直流偏移和削波计数，供 UI 以 ~30Hz 轮询
+// - 采集线程每块调用一次 Publish()，传入转换内核在同一遍里算出的 LevelStats（见 AudioKernels::*WithLevels），
+//   不再额外遍历音频数据；按累计的样本数每 33ms（默认）发布一次，窗口以块为单位，平均长度等于设定值
+// - 只允许一个写线程，Publish() 不加锁、不分配
+// - Read() 可以在任意线程调用，只读原子量、不唤醒任何线程；按序号校验（seqlock），读到的各项来自同一个窗口
+class LevelMeter {
+public:
+    struct Levels {
+        float peak;              // 窗口内的最大绝对值
+        float rms;
+        float dc;                // 窗口内的均值
+        uint32_t clipped;        // 窗口内削波的样本数
+        uint64_t totalClipped;   // Configure() 以来削波的样本数
+        uint64_t windows;        // 已发布的窗口数，0 表示还没有数据
+    };
+
+    LevelMeter();
+
+    LevelMeter(const LevelMeter&) = delete;
+    LevelMeter& operator=(const LevelMeter&) = delete;
+
+    // 录制开始前调用（不能与 Publish() 并发），清零已发布的电平
+    void Configure(int sampleRate, size_t channels, uint32_t windowMilliseconds = 33);
+
+    // 只由采集线程调用
+    void Publish(const AudioKernels::LevelStats& stats);
+
+    Levels Read() const;
+
+    // 线性幅度转 dBFS，不高于 -120 dB
+    static float ToDecibels(float linear);
+
+private:
+    void Store();
+
+    // 写线程私有的窗口累计
+    uint64_t windowSamples_;
+    uint64_t totalSamples_;
+    uint64_t nextPublish_;     // totalSamples_ 达到这里时发布
+    uint64_t samples_;         // 当前窗口的样本数
+    float peak_;
+    double sumSquares_;
+    double sum_;
+    uint32_t clipped_;
+    uint64_t totalClipped_;
+    uint64_t windows_;
+
+    // 已发布的电平，sequence_ 为奇数时正在写入
+    std::atomic<uint32_t> sequence_;
+    std::atomic<float> peakOut_;
+    std::atomic<float> rmsOut_;
+    std::atomic<float> dcOut_;
+    std::atomic<uint32_t> clippedOut_;
+    std::atomic<uint64_t> totalClippedOut_;
+    std::atomic<uint64_t> windowsOut_;
+};
+
+// 录音的两路采集电平
+struct CaptureLevels {
+    LevelMeter::Levels microphone;
+    LevelMeter::Levels system;
+};
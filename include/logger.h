@@ -1,12 +1,29 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <string>
-#include <memory>
+#include <type_traits>
 
-namespace spdlog {
-    class logger;
-}
+// 编译期日志级别阈值，低于它的调用整个被编译掉（0 = TRACE ... 5 = CRITICAL）
+// 发布构建默认只保留 INFO 及以上，需要调试日志时用 -DRECORDER_LOG_ACTIVE_LEVEL=0 覆盖
+#ifndef RECORDER_LOG_ACTIVE_LEVEL
+#ifdef NDEBUG
+#define RECORDER_LOG_ACTIVE_LEVEL 2
+#else
+#define RECORDER_LOG_ACTIVE_LEVEL 0
+#endif
+#endif
 
+// printf 风格的异步日志
+// - 调用线程只把格式串和参数按二进制拷进预分配的无锁队列，不格式化、不分配、不加锁，
+//   耗时有上界，可以在音频 IO 线程上调用；队列满时丢弃本条并计数
+// - 日志线程取出记录后再格式化，写入 spdlog 的控制台和滚动文件 sink，
+//   时间戳和线程号取自调用时刻
+// - 参数只支持整数、枚举、浮点、C 字符串和指针，字符串按值拷贝（超长截断）
+// - 第一次调用会启动日志线程，音频线程开始前应先调用 init()
+// - shutdown() 之后的日志被丢弃并计入 droppedCount()，不会重新启动日志线程，需要时显式调用 init()
 class Logger {
 public:
     enum class Level {
@@ -18,21 +35,120 @@ public:
         CRITICAL
     };
 
+    // 单条日志最多的参数个数，超出时编译报错
+    static constexpr size_t kMaxArgs = 8;
+
     static void init(const std::string& logDir = "");
+    // 写完队列中剩余的日志后停止日志线程
     static void shutdown();
-    
+
     static void setLevel(Level level);
     static Level getLevel();
-    
-    static void trace(const char* fmt, ...);
-    static void debug(const char* fmt, ...);
-    static void info(const char* fmt, ...);
-    static void warn(const char* fmt, ...);
-    static void error(const char* fmt, ...);
-    static void critical(const char* fmt, ...);
+
+    // 因队列满、争用或 shutdown() 之后调用被丢弃的日志条数
+    static uint64_t droppedCount();
+
+    template <typename... Args>
+    static void trace(const char* fmt, const Args&... args) { log<Level::TRACE>(fmt, args...); }
+    template <typename... Args>
+    static void debug(const char* fmt, const Args&... args) { log<Level::DEBUG>(fmt, args...); }
+    template <typename... Args>
+    static void info(const char* fmt, const Args&... args) { log<Level::INFO>(fmt, args...); }
+    template <typename... Args>
+    static void warn(const char* fmt, const Args&... args) { log<Level::WARN>(fmt, args...); }
+    template <typename... Args>
+    static void error(const char* fmt, const Args&... args) { log<Level::ERROR>(fmt, args...); }
+    template <typename... Args>
+    static void critical(const char* fmt, const Args&... args) { log<Level::CRITICAL>(fmt, args...); }
+
+    // 热点调用处的限流器，通常声明为调用处的 static 局部变量：
+    //   static Logger::RateLimiter limiter(1);
+    //   uint64_t suppressed;
+    //   if (limiter.Allow(&suppressed)) Logger::warn("... (另有 %llu 条被抑制)", ..., suppressed);
+    // Allow() 无锁、不分配，suppressed 返回上次放行以来被抑制的次数
+    class RateLimiter {
+    public:
+        // constexpr 构造，static 局部变量在常量初始化阶段完成，首次调用也不经过初始化守卫
+        constexpr explicit RateLimiter(uint32_t perSecond)
+            : intervalNanoseconds_(1000000000LL / (perSecond > 0 ? perSecond : 1))
+            , nextAllowed_(0)
+            , suppressed_(0) {}
+
+        bool Allow(uint64_t* suppressed = nullptr);
+
+    private:
+        const int64_t intervalNanoseconds_;
+        std::atomic<int64_t> nextAllowed_;
+        std::atomic<uint64_t> suppressed_;
+    };
+
+    // 参数的二进制形式，内部使用
+    struct Arg {
+        enum class Type : uint8_t {
+            Signed,
+            Unsigned,
+            Double,
+            String,
+            Pointer
+        };
+        Type type;
+        union {
+            int64_t i;
+            uint64_t u;
+            double d;
+            const char* s;
+            const void* p;
+        };
+    };
 
 private:
-    static std::shared_ptr<spdlog::logger> logger_;
-    static Level currentLevel_;
-    static bool initialized_;
-}; 
\ No newline at end of file
+    template <Level level, typename... Args>
+    static void log(const char* fmt, const Args&... args) {
+        if constexpr (static_cast<int>(level) >= RECORDER_LOG_ACTIVE_LEVEL) {
+            static_assert(sizeof...(Args) <= kMaxArgs, "Logger 单条日志参数过多");
+            if (static_cast<int>(level) < currentLevel_.load(std::memory_order_relaxed)) {
+                return;
+            }
+            // 多留一个元素，避免没有参数时出现零长度数组
+            const Arg packed[sizeof...(Args) + 1] = {makeArg(args)...};
+            enqueue(level, fmt, packed, sizeof...(Args));
+        }
+    }
+
+    template <typename T>
+    static Arg makeArg(const T& value) {
+        using D = std::decay_t<T>;
+        Arg arg;
+        if constexpr (std::is_same_v<D, bool>) {
+            arg.type = Arg::Type::Unsigned;
+            arg.u = value ? 1 : 0;
+        } else if constexpr (std::is_enum_v<D>) {
+            return makeArg(static_cast<std::underlying_type_t<D>>(value));
+        } else if constexpr (std::is_integral_v<D> && std::is_signed_v<D>) {
+            arg.type = Arg::Type::Signed;
+            arg.i = value;
+        } else if constexpr (std::is_integral_v<D>) {
+            arg.type = Arg::Type::Unsigned;
+            arg.u = value;
+        } else if constexpr (std::is_floating_point_v<D>) {
+            arg.type = Arg::Type::Double;
+            arg.d = static_cast<double>(value);
+        } else if constexpr (std::is_same_v<D, const char*> || std::is_same_v<D, char*>) {
+            arg.type = Arg::Type::String;
+            arg.s = value;
+        } else if constexpr (std::is_null_pointer_v<D>) {
+            arg.type = Arg::Type::Pointer;
+            arg.p = nullptr;
+        } else if constexpr (std::is_pointer_v<D>) {
+            arg.type = Arg::Type::Pointer;
+            arg.p = reinterpret_cast<const void*>(value);
+        } else {
+            static_assert(std::is_pointer_v<D>, "Logger 参数只支持整数、浮点、C 字符串和指针");
+        }
+        return arg;
+    }
+
+    static void enqueue(Level level, const char* fmt, const Arg* args, size_t count);
+
+    static std::atomic<int> currentLevel_;
+};
@@ -7,6 +7,8 @@
 
 #include "audio_system_capture.h"
 #include "audio_device_manager.h"
+#include "level_meter.h"
+#include "pipeline_metrics.h"
 
 #ifdef __OBJC__
 @class MacSystemAudioNode;
@@ -18,6 +20,7 @@
 
 // 前向声明
 class AudioRecorder;
+class PcmStream;
 
 // macOS平台的实现类
 class MacRecorder {
@@ -37,6 +40,11 @@ public:
     
     void SetOutputPath(const std::string& path);
     std::string GetCurrentMicrophoneApp() const;
+
+    // 尚未接入采集管线：不支持实时 PCM 流，指标和电平始终为空（见 AudioRecorder::SupportsMonitoring）
+    void SetPcmStream(PcmStream* stream);
+    PipelineMetrics::Snapshot GetMetrics() const;
+    CaptureLevels GetLevels() const;
     
     // 设置系统音频音量
     void SetSystemAudioVolume(float volume);
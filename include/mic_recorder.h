@@ -2,6 +2,7 @@
 
 #import <AVFoundation/AVFoundation.h>
 #include "logger.h"
+#include "streaming_wav_writer.h"
 
 class MicRecorder {
 public:
@@ -19,9 +20,8 @@ private:
     AVAudioMixerNode* mixerNode_;
     AVAudioFormat* audioFormat_;
     
-    // WAV 文件输出相关
-    ExtAudioFileRef audioFile_;
-    AudioStreamBasicDescription fileFormat_;
+    // WAV 文件输出相关，写盘在后台线程完成
+    StreamingWavWriter writer_;
     NSString* outputPath_;
     
     // 音频数据回调
@@ -3,7 +3,8 @@
 #include <memory>
 #include <string>
 #include <vector>
-#include "ring_buffer.h"
+#include "capture_backend.h"
+#include "capture_ring.h"
 #include <CoreAudio/CoreAudio.h>
 #include <AudioToolbox/AudioToolbox.h>
 
@@ -14,7 +15,14 @@ public:
     
     bool Start();
     void Stop();
+    // count 为交织样本数，必须是声道数的整数倍
     bool ReadAudioData(std::vector<float>& data, size_t count);
+
+    // 环形缓冲的存储格式和时长，默认取自 CaptureRing::Options::FromEnvironment()；只能在 Start() 之前设置
+    void SetRingOptions(const CaptureRing::Options& options);
+
+    // 每块数据写入环形缓冲后在 AUHAL 输入回调上调用，带 inTimeStamp 换算出的时间戳；只能在 Start() 之前设置
+    void SetDataCallback(CaptureBackend::DataCallback callback);
     
 private:
     class Impl;
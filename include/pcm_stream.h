@@ -0,0 +1,130 @@
+#pragma once
+
+#include "ring_buffer.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 把采集到的交织 PCM 按固定大小的块交给非实时消费者（Node.js 插件的 onAudio）
+// - 音频线程通过 Write() 写入无锁队列，不阻塞、不分配
+// - 投递线程攒满 chunkMilliseconds 后从池中取一块缓冲区，队列数据在转换目标格式的同时只复制这一次
+// - 块交给回调后归消费者所有，用完调用 Release() 归还；池在最后一块归还后才释放，
+//   因此消费者（例如 JS 的 GC）可以晚于 PcmStream 销毁才归还
+// - 池耗尽或 SetFlowing(false) 时投递线程不再取数，数据留在队列里，
+//   采集端通过 IsBacklogged() 感知背压；队列满后按 DropNewest 丢弃并计数
+// 每个流只允许一个生产者线程调用 Write()
+class PcmStream {
+public:
+    enum class SampleFormat {
+        Float32,
+        Int16
+    };
+
+    struct Options {
+        SampleFormat format = SampleFormat::Float32;
+        uint32_t chunkMilliseconds = 100;   // 每块的时长
+        size_t poolChunks = 16;             // 池中的块数，即消费者最多同时持有的块数
+        uint32_t queueMilliseconds = 2000;  // 音频线程到投递线程的队列容量
+        uint32_t pollMilliseconds = 10;     // 投递线程轮询间隔
+        uint32_t drainMilliseconds = 1000;  // End() 时池耗尽，最多等待消费者归还块的时间
+    };
+
+    class Pool;
+
+    struct Chunk {
+        uint8_t* data;
+        size_t bytes;
+        size_t frames;
+        uint64_t firstFrame;                // 本段录制中第一帧的序号
+        uint32_t sampleRate;
+        uint16_t channels;
+        SampleFormat format;
+        Pool* pool;
+    };
+
+    struct Stats {
+        uint64_t chunksDelivered;
+        uint64_t chunksRefused;             // 回调拒收、直接回池的块
+        uint64_t framesDelivered;
+        uint64_t bytesCopied;               // 队列到池缓冲区的复制量，每个交付字节恰好一次
+        uint64_t droppedFrames;             // 队列满丢弃的帧数
+        uint64_t poolExhausted;             // 投递时池中无空闲块的次数
+        size_t outstandingChunks;           // 消费者尚未归还的块数
+    };
+
+    // 在投递线程调用；返回 true 表示消费者接管该块，之后必须调用 Release()，返回 false 时块直接回池。
+    // End() 排空队列后以 nullptr 调用一次，表示本段录制结束
+    using ChunkCallback = std::function<bool(Chunk* chunk)>;
+
+    PcmStream(const Options& options, ChunkCallback callback);
+    ~PcmStream();
+
+    PcmStream(const PcmStream&) = delete;
+    PcmStream& operator=(const PcmStream&) = delete;
+
+    // 录音开始前由录音实现调用，按会话格式分配队列和池并启动投递线程
+    bool Begin(uint32_t sampleRate, uint16_t channels);
+
+    // 音频线程调用，frames 为帧数；队列满时丢弃本次数据并返回 false
+    bool Write(const float* interleaved, size_t frames);
+
+    // 采集停止后调用：交付队列中剩余的数据（含不足一块的尾部）后停止投递线程；
+    // 池耗尽时最多等待 drainMilliseconds，仍放不下的数据按丢弃计数
+    void End();
+
+    bool IsActive() const { return active_.load(std::memory_order_acquire); }
+
+    // 消费者暂停/恢复取数（Readable 流的 push 返回 false 时暂停）
+    void SetFlowing(bool flowing);
+
+    // 队列积压过半时返回 true，供离线回放等场景暂停推进；只能在录音实现的线程上调用
+    bool IsBacklogged() const;
+    // 队列中的帧数，同样只能在录音实现的线程上调用，不加锁，供音频线程更新指标
+    size_t PendingFrames() const;
+
+    // 以下可以在任意线程调用，与 Begin() 并发时读到的是其中一段录制的数据
+    size_t QueuedFrames() const;
+    size_t QueueCapacityFrames() const;
+
+    const Options& GetOptions() const { return options_; }
+    Stats GetStats() const;
+
+    // 把块归还到它所属的池，任意非实时线程都可以调用
+    static void Release(Chunk* chunk);
+
+private:
+    void DeliveryLoop();
+    void Deliver(bool final);
+
+    Options options_;
+    ChunkCallback callback_;
+    uint32_t sampleRate_;
+    uint16_t channels_;
+    size_t chunkFrames_;
+
+    std::unique_ptr<RingBuffer> queue_;
+    Pool* pool_;
+    mutable std::mutex stateMutex_;     // Begin() 更换队列和池时持有
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopRequested_;
+    std::atomic<bool> active_;
+    std::atomic<bool> flowing_;
+
+    // 以下成员只在投递线程访问
+    std::vector<float> drainBuffer_;
+    uint64_t nextFrame_;
+
+    std::atomic<uint64_t> chunksDelivered_;
+    std::atomic<uint64_t> chunksRefused_;
+    std::atomic<uint64_t> framesDelivered_;
+    std::atomic<uint64_t> bytesCopied_;
+    std::atomic<uint64_t> droppedFrames_;
+    std::atomic<uint64_t> poolExhausted_;
+};
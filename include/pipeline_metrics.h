@@ -0,0 +1,149 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 采集管线的运行指标：回调耗时、回调间隔抖动、各级缓冲水位、丢弃量、各处理级耗时
+// - 指标在录音开始前注册（加锁、分配），返回的引用在注册表销毁前一直有效
+// - 音频线程只做 relaxed 原子读写，不加锁、不分配；Gauge 和 Histogram 只允许一个写线程，
+//   Counter 可以多线程累加
+// - GetSnapshot() 可以在任意线程调用，读到的各项之间不保证是同一时刻
+// 时间类指标以纳秒为单位，名称以 _ns 结尾；水位类以帧或样本为单位
+class PipelineMetrics {
+public:
+    // 直方图按 2 的幂分桶：第 0 桶为 0，第 i 桶为 [2^(i-1), 2^i)，最后一桶收纳更大的值
+    static constexpr size_t kHistogramBuckets = 32;
+
+    enum class Kind {
+        Counter,
+        Gauge,
+        Histogram
+    };
+
+    class Counter {
+    public:
+        void Add(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+        uint64_t Value() const { return value_.load(std::memory_order_relaxed); }
+        void Reset() { value_.store(0, std::memory_order_relaxed); }
+
+    private:
+        std::atomic<uint64_t> value_{0};
+    };
+
+    // 当前值和历史最大值（高水位）
+    class Gauge {
+    public:
+        void Set(uint64_t value) {
+            value_.store(value, std::memory_order_relaxed);
+            if (value > max_.load(std::memory_order_relaxed)) {
+                max_.store(value, std::memory_order_relaxed);
+            }
+        }
+        uint64_t Value() const { return value_.load(std::memory_order_relaxed); }
+        uint64_t Max() const { return max_.load(std::memory_order_relaxed); }
+        void Reset() {
+            value_.store(0, std::memory_order_relaxed);
+            max_.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<uint64_t> value_{0};
+        std::atomic<uint64_t> max_{0};
+    };
+
+    class Histogram {
+    public:
+        void Record(uint64_t value);
+        // 记录从 startNanoseconds（NowNanoseconds() 的返回值）到现在的耗时
+        void RecordSince(uint64_t startNanoseconds) { Record(NowNanoseconds() - startNanoseconds); }
+        void Reset();
+
+    private:
+        friend class PipelineMetrics;
+        std::array<std::atomic<uint64_t>, kHistogramBuckets> buckets_{};
+        std::atomic<uint64_t> count_{0};
+        std::atomic<uint64_t> sum_{0};
+        std::atomic<uint64_t> max_{0};
+    };
+
+    // 回调计时：每次回调的处理耗时，以及相邻两次回调的间隔与标称周期之差的绝对值（抖动）
+    class CallbackTimer {
+    public:
+        CallbackTimer();
+        // 在录音开始前调用；periodNanoseconds 为 0 时不统计抖动（例如不限速回放）
+        void Attach(Histogram* duration, Histogram* jitter, uint64_t periodNanoseconds);
+        // 回调开头调用，返回的时间戳交给 End()
+        uint64_t Begin();
+        void End(uint64_t startNanoseconds);
+
+    private:
+        Histogram* duration_;
+        Histogram* jitter_;
+        uint64_t periodNanoseconds_;
+        uint64_t lastStart_;
+    };
+
+    struct HistogramSnapshot {
+        uint64_t count;
+        uint64_t sum;
+        uint64_t max;
+        std::array<uint64_t, kHistogramBuckets> buckets;
+
+        double Mean() const { return count > 0 ? static_cast<double>(sum) / static_cast<double>(count) : 0.0; }
+        // 按桶估计的分位数，取所在桶的上界（不超过 max）
+        uint64_t Percentile(double q) const;
+    };
+
+    struct Entry {
+        std::string name;
+        Kind kind;
+        uint64_t value;                  // Counter/Gauge 的当前值，Histogram 的样本数
+        uint64_t max;                    // Gauge 的高水位，Histogram 的最大样本
+        HistogramSnapshot histogram;     // 只对 Histogram 有效
+    };
+
+    struct Snapshot {
+        std::vector<Entry> entries;
+
+        const Entry* Find(const std::string& name) const;
+    };
+
+    PipelineMetrics() = default;
+    PipelineMetrics(const PipelineMetrics&) = delete;
+    PipelineMetrics& operator=(const PipelineMetrics&) = delete;
+
+    // 按名称取得指标，不存在时注册；同名不同类型视为编程错误，返回新注册的匿名指标
+    Counter& GetCounter(const std::string& name);
+    Gauge& GetGauge(const std::string& name);
+    Histogram& GetHistogram(const std::string& name);
+
+    // 所有指标清零，只能在没有线程写入时调用（录音开始前）
+    void Reset();
+
+    Snapshot GetSnapshot() const;
+
+    // 把快照中有数据的指标逐条写入日志
+    static void Log(const Snapshot& snapshot, const char* title);
+
+    // 单调时钟，纳秒
+    static uint64_t NowNanoseconds();
+
+private:
+    struct Slot {
+        std::string name;
+        Kind kind;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+    };
+
+    Slot& GetSlot(const std::string& name, Kind kind);
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Slot>> slots_;
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "capture_engine.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 预录缓冲：持续保留采集流最近 N 秒（可到数分钟）的历史，录音开始时可以从过去的时间点开始
+// - 作为 CaptureEngine 的一个普通订阅者在自己的线程上拉取数据，采集回调没有任何额外工作
+// - 历史按块压缩后存放在固定大小的段（segment）里：Int16 只做量化，Compressed 在量化后
+//   做定阶多项式预测 + Rice 编码（无损，语音约为 int16 的 1/2，静音几乎不占空间）
+// - 段按需分配、淘汰后进入空闲链表复用，总内存不超过 maxBytes；最旧的段整段淘汰
+// - Splice() 输出截止到某个绝对帧位置的历史。该位置取新订阅的 Subscription::Position()，
+//   历史与新订阅读到的第一帧首尾相接，没有缺口也没有重叠
+class PrerollBuffer {
+public:
+    enum class Codec {
+        Int16,
+        Compressed
+    };
+
+    struct Options {
+        double seconds = 60.0;           // 保留的历史时长
+        Codec codec = Codec::Compressed;
+        size_t maxBytes = 0;             // 段内存上限，0 表示按 int16 存满 seconds 所需的段数（含块头和段尾空隙）
+        uint32_t blockFrames = 4096;     // 每个压缩块的帧数
+        uint32_t pollMilliseconds = 20;
+
+        Options();
+    };
+
+    struct Stats {
+        uint64_t historyFrames;          // 当前可用的历史帧数
+        size_t bytesUsed;                // 已写入段中的块数据
+        size_t bytesAllocated;           // 已分配的段内存
+        uint64_t encodedFrames;
+        uint64_t encodeNanos;            // 累计编码耗时
+        uint64_t droppedSamples;         // 预录线程跟不上时被广播缓冲覆盖的样本
+    };
+
+    // 返回 false 时停止输出
+    using Sink = std::function<bool(const float* interleaved, size_t frames)>;
+
+    // 订阅 engine 并启动预录线程；订阅失败时 IsRunning() 为 false
+    PrerollBuffer(std::shared_ptr<CaptureEngine> engine, const Options& options = Options());
+    ~PrerollBuffer();
+
+    PrerollBuffer(const PrerollBuffer&) = delete;
+    PrerollBuffer& operator=(const PrerollBuffer&) = delete;
+
+    bool IsRunning() const { return subscription_ != nullptr; }
+
+    int SampleRate() const { return sampleRate_; }
+    size_t Channels() const { return channels_; }
+
+    // 把 [endFrame - seconds, endFrame) 内仍保留的历史按时间顺序交给 sink，返回输出的帧数。
+    // endFrame 为引擎采集流中的绝对位置，不能晚于采集流的当前位置；
+    // 在调用线程上解码，期间预录线程暂停（积压留在广播缓冲中）
+    uint64_t Splice(uint64_t endFrame, double seconds, const Sink& sink);
+
+    Stats GetStats() const;
+
+private:
+    struct Segment;
+    struct BlockHeader;
+
+    void PollLoop();
+    // 从订阅读取并压缩到 limitFrame 为止；partial 为 true 时不足一块的尾部也编码。调用方持有 mutex_
+    void Ingest(uint64_t limitFrame, bool partial);
+    void AppendBlock(uint64_t startFrame, const float* interleaved, size_t frames);
+    void Evict(uint64_t newestFrame, size_t incomingBytes);
+    size_t EncodeBlock(const float* interleaved, size_t frames, uint8_t* out);
+    void DecodeBlock(const BlockHeader& header, const uint8_t* payload, float* interleaved);
+
+    std::shared_ptr<CaptureEngine> engine_;
+    std::unique_ptr<CaptureEngine::Subscription> subscription_;
+    Options options_;
+    int sampleRate_;
+    size_t channels_;
+    size_t segmentBytes_;
+    size_t maxSegments_;
+
+    mutable std::mutex mutex_;           // 保护订阅读取、段链表和编码缓冲
+    std::deque<std::unique_ptr<Segment>> segments_;
+    std::vector<std::unique_ptr<Segment>> freeSegments_;
+    size_t allocatedSegments_;
+    uint64_t nextFrame_;                 // 下一个要编码的绝对帧位置
+    std::vector<float> pending_;         // 读取出的交织 float，凑满一块后编码
+    std::vector<int16_t> quantized_;
+    std::vector<uint8_t> encoded_;
+    std::vector<float> decoded_;
+    uint64_t encodedFrames_;
+    uint64_t encodeNanos_;
+
+    std::thread thread_;
+    std::mutex stopMutex_;
+    std::condition_variable cv_;
+    bool stopRequested_;
+};
@@ -1,10 +1,23 @@
 #pragma once
 
+#include "level_meter.h"
+#include "pipeline_metrics.h"
+#include <atomic>
 #include <string>
 
 // 前向声明
+class PcmStream;
+#ifdef __APPLE__
 class MacRecorder;
+using PlatformRecorder = MacRecorder;
+#else
+// 其他平台使用文件/信号发生器驱动的无头实现
+class HeadlessRecorder;
+using PlatformRecorder = HeadlessRecorder;
+#endif
 
+// 控制方法不是线程安全的，应由同一线程串行调用（Node.js 插件在专用控制线程上执行）；
+// IsRecording()、GetMetrics() 和 GetLevels() 可以在任意线程查询
 class AudioRecorder {
 public:
     AudioRecorder();
@@ -31,11 +44,23 @@ public:
     // 获取当前占用麦克风的应用
     std::string GetCurrentMicrophoneApp();
 
+    // 把混合音频实时送入 PCM 流，传 nullptr 取消；只能在未录制时调用
+    void SetPcmStream(PcmStream* stream);
+
+    // 管线运行指标（回调耗时与抖动、缓冲水位、丢弃量、各处理级耗时）的快照
+    PipelineMetrics::Snapshot GetMetrics() const;
+
+    // 麦克风和系统音频的峰值/RMS/削波/直流偏移，在采集转换时顺带统计，读取不加锁、不唤醒任何线程
+    CaptureLevels GetLevels() const;
+
+    // 当前平台是否支持上面的实时 PCM 流、管线指标和电平；macOS 的 MacRecorder 还没有接入采集管线，不支持
+    static bool SupportsMonitoring();
+
 private:
-    bool isRecording_;
-    bool isPaused_;
+    std::atomic<bool> isRecording_;
+    std::atomic<bool> isPaused_;
     std::string outputPath_;
     
     // 平台特定实现
-    MacRecorder* platformImpl_;
+    PlatformRecorder* platformImpl_;
 }; 
\ No newline at end of file
@@ -1,28 +1,93 @@
 #pragma once
 
-#include <vector>
-#include <mutex>
-#include <condition_variable>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 
-class RingBuffer {
+// Apple Silicon 的缓存行为 128 字节，其余平台按 64 字节处理
+#if defined(__APPLE__) && defined(__aarch64__)
+constexpr size_t kCacheLineSize = 128;
+#else
+constexpr size_t kCacheLineSize = 64;
+#endif
+
+// 24 位小端整数样本，按 3 字节紧凑存放
+struct PackedInt24 {
+    uint8_t bytes[3];
+};
+
+// 与样本格式无关的溢出策略和统计
+class RingBufferBase {
+public:
+    enum class OverflowPolicy {
+        DropNewest,  // 丢弃本次写入，生产者无等待
+        DropOldest   // 覆盖最旧的数据，始终保留最新音频
+    };
+
+    // 统计信息，以帧为单位（帧宽为 1 时即样本）
+    struct Stats {
+        size_t overflow_count;    // 溢出次数
+        size_t underflow_count;   // 欠载次数
+        size_t dropped_samples;   // 因溢出丢弃的帧数
+        size_t max_used_size;     // 最大使用量
+        size_t capacity;          // 缓冲区容量
+    };
+};
+
+// 单生产者/单消费者无锁环形缓冲区
+// - Sample 为存储格式：float 原样拷贝；int16_t 和 PackedInt24 在写入的拷贝中量化（不加抖动，超出 [-1, 1) 削波）、
+//   在读取的拷贝中还原为 float，内存占用和带宽分别为 float 的 1/2 和 3/4
+// - FrameWidth 为每帧的样本数，读写和丢弃都以整帧为单位，多声道数据不会错位
+// - 容量（帧数）向上取整为 2 的幂，用掩码代替取模
+// - 读写位置为单调递增计数，各自独占缓存行
+// - 写入/读取最多分两段拷贝完成，不加锁、不通知、不分配内存
+// - 缓冲区满时不阻塞，按 OverflowPolicy 丢弃数据
+// 支持的组合在 ring_buffer.cpp 中显式实例化：float/int16_t/PackedInt24，帧宽 1~8
+template <typename Sample, size_t FrameWidth = 1>
+class BasicRingBuffer : public RingBufferBase {
 public:
-    RingBuffer(size_t size);
-    
-    bool write(const float* data, size_t count);
-    bool read(float* data, size_t count);
-    
+    static constexpr size_t kFrameWidth = FrameWidth;
+
+    explicit BasicRingBuffer(size_t frames, OverflowPolicy policy = OverflowPolicy::DropNewest);
+
+    // 仅由生产者线程调用，写入 frames * FrameWidth 个交织样本，返回 false 表示本次数据被丢弃
+    bool write(const float* data, size_t frames);
+
+    // 仅由消费者线程调用，数据不足 frames 帧时立即返回 false
+    bool read(float* data, size_t frames);
+
     size_t available_read() const;
     size_t available_write() const;
-    
+    size_t capacity() const { return capacity_; }
+
+    // 样本存储占用的字节数
+    size_t storage_bytes() const { return capacity_ * FrameWidth * sizeof(Sample); }
+
+    Stats get_stats() const;
+
+    // 只能在生产者和消费者都停止时调用
+    void clear();
+
 private:
-    std::vector<float> buffer_;
-    size_t read_pos_;
-    size_t write_pos_;
-    size_t size_;
-    mutable std::mutex mutex_;
-    std::condition_variable cv_;
-    
-    size_t overflow_count_;
-    size_t underflow_count_;
-    size_t max_used_size_;
-}; 
\ No newline at end of file
+    void copy_in(uint64_t pos, const float* data, size_t frames);
+    void copy_out(uint64_t pos, float* data, size_t frames) const;
+
+    alignas(kCacheLineSize) std::atomic<uint64_t> write_pos_;
+    // 生产者独占的统计
+    std::atomic<size_t> overflow_count_;
+    std::atomic<size_t> dropped_samples_;
+    std::atomic<size_t> max_used_size_;
+
+    alignas(kCacheLineSize) std::atomic<uint64_t> read_pos_;
+    // 消费者独占的统计
+    std::atomic<size_t> underflow_count_;
+
+    alignas(kCacheLineSize) std::unique_ptr<Sample[]> buffer_;
+    size_t capacity_;
+    size_t mask_;
+    OverflowPolicy policy_;
+};
+
+// 管线内部各级之间传递 float 样本的环形缓冲，以样本为单位
+using RingBuffer = BasicRingBuffer<float, 1>;
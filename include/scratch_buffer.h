@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// 实时回调使用的预分配临时缓冲区
+// - Reserve() 只在非实时线程调用（格式协商、设备最大帧数变化通知）
+// - Data() 在音频线程调用，只做一次原子读取，不分配内存
+// 扩容时新缓冲区通过原子指针发布，旧缓冲区保留到对象销毁，
+// 因此音频线程手里的指针永远不会被提前释放
+class ScratchBuffer {
+public:
+    ScratchBuffer() = default;
+    explicit ScratchBuffer(size_t samples);
+
+    ScratchBuffer(const ScratchBuffer&) = delete;
+    ScratchBuffer& operator=(const ScratchBuffer&) = delete;
+
+    // 确保容量至少为 samples 个 float
+    void Reserve(size_t samples);
+
+    // 返回容量不小于 samples 的缓冲区，容量不足时返回 nullptr 并计数
+    float* Data(size_t samples);
+
+    size_t Capacity() const;
+    size_t MissCount() const { return missCount_.load(std::memory_order_relaxed); }
+
+private:
+    struct Block {
+        std::unique_ptr<float[]> data;
+        size_t capacity;
+    };
+
+    std::atomic<Block*> current_{nullptr};
+    std::atomic<size_t> missCount_{0};
+    std::vector<std::unique_ptr<Block>> blocks_;
+    std::mutex reserveMutex_;
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+template <typename Sample, size_t FrameWidth>
+class BasicRingBuffer;
+using RingBuffer = BasicRingBuffer<float, 1>;
+
+// 基于 WebRTC VAD（common_audio/vad）的静音省略
+// - 输入按 10ms 分帧，下混为单声道 int16 后判定是否有语音；8k/16k/32k/48k 以外的采样率先重采样到 16k
+// - 语音帧之后的 hangoverMilliseconds 照常保留；之后的静音先缓存，连续超过
+//   minimumGapMilliseconds + prerollMilliseconds 才开始省略，只保留语音恢复前的 prerollMilliseconds
+// - 每段被省略的静音记为一个 Gap，按 Gap 在存储位置插回同样长度的静音即可逐帧还原原始时间轴
+// - 只在写线程上调用，内部状态不加锁；输出经 RingBuffer 交给原来的写盘路径
+class SilenceElider {
+public:
+    struct Options {
+        int vadMode = 2;                          // VAD 激进程度 0-3，越大越容易判为静音
+        uint32_t hangoverMilliseconds = 300;      // 语音结束后继续保留的时长
+        uint32_t prerollMilliseconds = 100;       // 语音恢复前保留的静音
+        uint32_t minimumGapMilliseconds = 1000;   // 短于此的停顿不省略
+    };
+
+    // 存储文件中 storedFrame 处被省去了原始时间轴上从 originalFrame 开始的 frames 帧
+    struct Gap {
+        uint64_t storedFrame;
+        uint64_t originalFrame;
+        uint64_t frames;
+    };
+
+    struct Stats {
+        uint64_t originalFrames;    // 输入帧数
+        uint64_t storedFrames;      // 输出帧数
+        uint64_t speechFrames;      // VAD 判为语音的帧数（按 10ms 帧折算成采样帧）
+        size_t gaps;
+        uint64_t cpuNanoseconds;    // 处理所用的线程 CPU 时间
+    };
+
+    SilenceElider();
+    ~SilenceElider();
+
+    SilenceElider(const SilenceElider&) = delete;
+    SilenceElider& operator=(const SilenceElider&) = delete;
+
+    bool Initialize(uint32_t sampleRate, uint16_t channels, const Options& options);
+
+    // 处理 frames 帧交织输入，保留的帧写入 output；output 至少要有 MaxOutputFrames(frames) 帧空间
+    void Process(const float* interleaved, size_t frames, RingBuffer* output);
+
+    // 输入结束：写出缓存的静音和不足 10ms 的尾部，结束未闭合的 Gap
+    void Finish(RingBuffer* output);
+
+    size_t MaxOutputFrames(size_t inputFrames) const;
+
+    const std::vector<Gap>& Gaps() const { return gaps_; }
+    Stats GetStats() const;
+
+    // 写出 JSON 编辑表，先写临时文件再改名，录音中途崩溃时保留最近一次写出的版本
+    bool WriteEditList(const std::string& path) const;
+
+    // 编辑表文件名：<音频路径>.edits.json
+    static std::string EditListPath(const std::string& audioPath);
+
+private:
+    void ProcessFrame(const float* frame, RingBuffer* output);
+    bool IsSpeech(const float* frame);
+    void PushPending(const float* frame);
+    void FlushPending(RingBuffer* output);
+    void Emit(const float* data, size_t frames, RingBuffer* output);
+
+    class Vad;
+    std::unique_ptr<Vad> vad_;
+
+    uint32_t sampleRate_;
+    uint16_t channels_;
+    size_t frameSize_;          // 10ms 的帧数
+    size_t hangoverFrames_;     // 以下三项以 10ms 帧为单位
+    size_t prerollFrames_;
+    size_t gapThresholdFrames_;
+
+    std::vector<float> frame_;  // 不足 10ms 的输入
+    size_t frameFill_;
+
+    // 待定的静音，按 10ms 帧组成的环形缓冲
+    std::vector<float> pending_;
+    size_t pendingCapacity_;
+    size_t pendingHead_;
+    size_t pendingCount_;
+    uint64_t pendingOriginalStart_;
+
+    size_t hangoverRemaining_;
+    bool inGap_;
+    Gap openGap_;
+
+    uint64_t originalFrames_;
+    uint64_t storedFrames_;
+    uint64_t speechFrames_;
+    uint64_t cpuNanoseconds_;
+    std::vector<Gap> gaps_;
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "capture_backend.h"
+#include "pipeline_metrics.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 多路采集流的时间戳对齐：把各路数据按 CaptureTimestamp 放到同一条会话时间线上
+// - 会话零点为所有流中第一块数据的主机时间；各流的输出都从零点开始，
+//   晚于零点开始的流在开头补静音，早于零点的部分裁掉（起始偏差）
+// - 之后各流按设备采样时钟推算每块的位置：采样时间跳跃（丢了 IO 周期）时补静音，
+//   回退（重复数据）时裁掉；没有采样时间时按主机时间推算，小于 toleranceMicroseconds 的偏差视为抖动
+// - 采样时钟推算的位置与主机时间偏差超过 resyncMilliseconds（设备重置、采样时间归零）时按主机时间重新定位
+// - 各流的输出仍是各自的采样率；采样时钟相对主机时钟的缓慢漂移不在这里修正（见 DriftCompensatingResampler），
+//   只在 clockErrorNanos 中报告
+// - 每路由各自的采集线程调用 Push()，不同流之间可以并发；不加锁、不分配内存
+class StreamAligner {
+public:
+    using Output = std::function<void(const float* interleaved, size_t frames)>;
+
+    struct StreamOptions {
+        std::string name;              // 指标名称的一部分，例如 "microphone"
+        int sampleRate = 48000;
+        size_t channels = 2;
+        size_t maxBlockFrames = 4096;  // 补静音时每次最多输出的帧数；数据块按原样（裁剪后）输出
+        Output output;
+
+        StreamOptions();
+    };
+
+    struct Options {
+        uint32_t toleranceMicroseconds = 500;
+        uint32_t resyncMilliseconds = 20;
+        PipelineMetrics* metrics = nullptr;   // 注册 <prefix>.<name>.latency_ns 等指标
+        std::string metricsPrefix = "align";
+
+        Options();
+    };
+
+    struct StreamStats {
+        uint64_t inputFrames;
+        uint64_t outputFrames;        // 包括补的静音
+        uint64_t insertedFrames;      // 起始偏差和丢失数据补的静音
+        uint64_t trimmedFrames;       // 早于零点或重复而裁掉的帧
+        uint64_t discontinuities;     // 开始之后补静音或裁剪的次数
+        uint64_t resyncs;             // 按主机时间重新定位的次数
+        int64_t startSkewNanos;       // 第一块的主机时间减去会话零点
+        int64_t clockErrorNanos;      // 最近一块的输出位置减去按主机时间推算的位置
+        double averageLatencyNanos;   // 到达延迟：回调时刻减去块末尾的采集时刻
+        uint64_t maxLatencyNanos;
+    };
+
+    struct Stats {
+        uint64_t originHostNanos;     // 会话零点，尚无数据时为 0
+        std::vector<StreamStats> streams;
+    };
+
+    StreamAligner();
+    ~StreamAligner();
+
+    StreamAligner(const StreamAligner&) = delete;
+    StreamAligner& operator=(const StreamAligner&) = delete;
+
+    bool Initialize(const Options& options, const std::vector<StreamOptions>& streams);
+    void Release();
+    bool IsInitialized() const { return !streams_.empty(); }
+
+    // 只由 stream 的采集线程调用
+    void Push(size_t stream, const float* interleaved, size_t frames, const CaptureTimestamp& timestamp);
+
+    // 两路之间当前的相对偏移（a 的 clockErrorNanos 减去 b 的），正值表示 a 在输出中比实际采集时刻靠后
+    int64_t RelativeOffsetNanos(size_t a, size_t b) const;
+
+    Stats GetStats() const;
+
+private:
+    struct Stream;
+
+    void Emit(Stream& stream, const float* interleaved, size_t frames);
+    void EmitSilence(Stream& stream, uint64_t frames);
+
+    Options options_;
+    std::vector<std::unique_ptr<Stream>> streams_;
+    std::vector<float> silence_;
+    std::atomic<uint64_t> origin_;
+};
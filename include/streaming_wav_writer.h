@@ -0,0 +1,156 @@
+#pragma once
+
+#include "audio_encoder.h"
+#include "audio_kernels.h"
+#include "chunk_store.h"
+#include "ring_buffer.h"
+#include "silence_elider.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 后台流式 WAV 写入器
+// - 音频线程通过 Write() 把交织 float 样本放入无锁队列，不阻塞、不分配、不做系统调用
+// - 独立写线程把数据批量转换成目标格式，以 4KB 对齐的大块 pwrite 写盘
+// - 按块预分配文件空间，定期用 pwrite 刷新头部，进程被杀时文件依然可读
+// - 数据超过 4GB 时自动把头部切换为 RF64
+// - codec 不是 Pcm 时改由写线程上的 AudioEncoder 编码（FLAC/G.722），音频线程的路径不变
+// - segmentSeconds 大于 0 时改为分段模式：数据写入 <path>.chunks/ 下 mmap 的块文件（见 ChunkStore），
+//   Close() 时在内核内拼接成 WAV；进程崩溃后下次 Open() 同一路径会先把残留的块恢复成 <名称>_recovered.wav
+// - elideSilence 为 true 时写线程先用 SilenceElider 省去长静音，再走上述任一路径，
+//   同时写出 <path>.edits.json 记录省去的位置和长度，用于还原原始时间轴
+// 每个写入器只允许一个生产者线程调用 Write()；Close() 会等进行中的 Write() 返回，
+// 因此生产者可以在关闭、重新打开期间继续调用 Write()，期间的数据被丢弃
+class StreamingWavWriter {
+public:
+    enum class SampleFormat {
+        Float32,
+        Int16
+    };
+
+    struct Options {
+        uint32_t sampleRate = 44100;
+        uint16_t channels = 2;
+        SampleFormat format = SampleFormat::Float32;
+        bool dither = false;                        // 转换为 Int16 时叠加 TPDF 抖动
+        uint32_t queueMilliseconds = 2000;          // 音频线程到写线程的队列容量
+        size_t batchBytes = 256 * 1024;             // 单次写盘的目标大小
+        uint64_t preallocateBytes = 64ull << 20;    // 每次预分配的文件空间
+        uint32_t headerRefreshMilliseconds = 1000;  // 头部刷新间隔
+        uint32_t pollMilliseconds = 10;             // 写线程轮询间隔
+        AudioEncoder::Codec codec = AudioEncoder::Codec::Pcm;  // 非 Pcm 时 format 和预分配不生效
+        uint16_t flacBitsPerSample = 16;
+        size_t encoderThreads = 0;                  // FLAC 并行编码的块数，0 表示按 CPU 核数
+        uint32_t segmentSeconds = 0;                // 分段模式每个块的时长，0 为直接写 WAV；只对 Pcm 生效
+        bool elideSilence = false;                  // 在写线程上省略长静音（见 SilenceElider）
+        SilenceElider::Options silence;
+
+        Options();
+
+        // RECORDER_CODEC=wav/flac/g722，RECORDER_SEGMENT_SECONDS=分段时长，RECORDER_ELIDE_SILENCE=1 省略长静音；
+        // 其余字段为默认值，采样率、声道数等由调用方设置
+        static Options FromEnvironment();
+    };
+
+    // 头部固定占用 4KB，音频数据从对齐的偏移开始
+    static constexpr size_t kHeaderSize = 4096;
+
+    StreamingWavWriter();
+    ~StreamingWavWriter();
+
+    StreamingWavWriter(const StreamingWavWriter&) = delete;
+    StreamingWavWriter& operator=(const StreamingWavWriter&) = delete;
+
+    // 创建文件并启动写线程
+    bool Open(const std::string& path, const Options& options);
+
+    // 音频线程调用，frames 为帧数；队列满时丢弃本次数据并返回 false
+    bool Write(const float* interleaved, size_t frames);
+
+    // 排空队列、写入最终头部并关闭文件
+    void Close();
+
+    bool IsOpen() const { return open_.load(std::memory_order_acquire); }
+
+    // 已经落盘的帧数
+    uint64_t FramesWritten() const { return framesWritten_.load(std::memory_order_relaxed); }
+
+    // 因队列满被丢弃的帧数
+    uint64_t DroppedFrames() const { return droppedFrames_.load(std::memory_order_relaxed); }
+
+    // 队列中尚未被写线程取走的帧数，以及队列容量（帧），供离线回放等场景做背压
+    size_t QueuedFrames() const;
+    size_t QueueCapacityFrames() const;
+
+    const std::string& Path() const { return path_; }
+
+    // 静音省略的统计，Close() 之后调用；未开启时返回 false
+    bool GetSilenceStats(SilenceElider::Stats* stats) const;
+
+    // 分段模式下块文件所在的目录
+    static std::string SegmentDirectory(const std::string& path);
+
+    // 把分段目录中的块（含崩溃时未封存的最后一块）校验后合并成 WAV，成功后删除目录
+    static bool RecoverSegments(const std::string& directory, const std::string& path);
+
+    // 生成 kHeaderSize 字节的头部，只记录 totalBytes 中的完整帧；RIFF 长度超过 4GB 时使用 RF64，
+    // 数据长度为奇数时 RIFF 长度计入末尾的填充字节
+    static void BuildHeader(uint8_t* header, uint32_t sampleRate, uint16_t channels, bool isFloat,
+                            uint64_t totalBytes);
+
+private:
+    void WriterLoop();
+    size_t Drain(size_t maxFrames);
+    size_t DrainInput(size_t maxFrames);
+    size_t PumpElider();
+    void FinishElider();
+    void UpdateEditList(bool final);
+    size_t DrainToEncoder(size_t maxFrames);
+    void FinishEncoder();
+    void CheckEncoder(bool ok);
+    size_t DrainToChunks(size_t maxFrames);
+    void CheckChunks(bool ok);
+    bool OpenSegments();
+    static bool FinalizeSegments(const std::string& directory, const std::string& path, bool verify);
+    bool FlushStaging(bool all);
+    bool WriteHeader();
+    void Preallocate(uint64_t end);
+
+    size_t BytesPerSample() const;
+
+    Options options_;
+    std::string path_;
+    int fd_;
+
+    std::unique_ptr<RingBuffer> queue_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopRequested_;
+    std::atomic<bool> open_;
+    mutable std::atomic<uint32_t> activeWriters_;   // 正在访问 queue_ 的 Write() 等调用数
+
+    // 以下成员只在写线程访问
+    RingBuffer* input_;                      // 写盘路径的数据来源：queue_，或开启静音省略时的 elided_
+    std::unique_ptr<SilenceElider> elider_;
+    std::unique_ptr<RingBuffer> elided_;
+    size_t editListGaps_;                    // 上次写出编辑表时的段数
+    std::vector<float> drainBuffer_;
+    uint8_t* staging_;
+    size_t stagingCapacity_;
+    size_t stagingUsed_;
+    uint64_t dataBytes_;
+    uint64_t allocatedEnd_;
+    bool writeFailed_;
+    std::unique_ptr<AudioEncoder> encoder_;
+    std::unique_ptr<ChunkStore> chunks_;
+    AudioKernels::DitherState dither_;
+
+    std::atomic<uint64_t> framesWritten_;
+    std::atomic<uint64_t> droppedFrames_;
+};
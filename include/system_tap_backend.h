@@ -0,0 +1,36 @@
+#pragma once
+
+#include "capture_backend.h"
+#include "capture_engine.h"
+#include <atomic>
+#include <memory>
+
+class AudioSystemCapture;
+
+// 以 AudioSystemCapture（聚合设备 + 进程 tap）为数据源的采集后端，供 CaptureEngine 使用
+// CreateTapDevice() 会删除同名的聚合设备再重建，同一进程内的多个消费者应通过 SharedEngine()
+// 共享同一个设备，而不是各自创建 AudioSystemCapture
+class SystemTapBackend : public CaptureBackend {
+public:
+    SystemTapBackend();
+    ~SystemTapBackend() override;
+
+    // 创建聚合设备和 tap 并读取流格式，失败时返回 false
+    bool Open();
+
+    bool Start() override;
+    void Stop() override;
+    bool IsRunning() const override;
+
+    int SampleRate() const override { return sampleRate_; }
+    size_t Channels() const override { return channels_; }
+
+    // 进程内共享的系统音频采集引擎，创建失败时返回 nullptr
+    static std::shared_ptr<CaptureEngine> SharedEngine();
+
+private:
+    std::unique_ptr<AudioSystemCapture> capture_;
+    int sampleRate_;
+    size_t channels_;
+    std::atomic<bool> running_;
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "audio_kernels.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 以内存映射方式读取 WAV 文件
+// - 支持 16/24 位整数和 32 位浮点 PCM，RIFF 与 RF64 头部
+// - 被截断的文件（录制中途进程退出）以实际文件长度为准
+// - Read() 直接从映射区转换为交织 float，不经过额外的拷贝
+// - 顺序读大文件时可以用 ReleaseBefore() 交还已读过的页，常驻内存不随读取进度增长
+class WavFileReader {
+public:
+    WavFileReader();
+    ~WavFileReader();
+
+    WavFileReader(const WavFileReader&) = delete;
+    WavFileReader& operator=(const WavFileReader&) = delete;
+
+    bool Open(const std::string& path);
+    void Close();
+
+    bool IsOpen() const { return data_ != nullptr; }
+
+    int SampleRate() const { return sampleRate_; }
+    size_t Channels() const { return channels_; }
+    uint64_t Frames() const { return frames_; }
+
+    // 从 frameOffset 开始读取最多 frames 帧交织 float，返回实际读取的帧数；
+    // levels 非空时在转换的同时统计读出数据的电平
+    size_t Read(uint64_t frameOffset, float* interleaved, size_t frames,
+                AudioKernels::LevelStats* levels = nullptr) const;
+
+    // frameOffset 之前的整页交还给内核（MADV_DONTNEED），之后再读这些帧会重新从页缓存映射
+    void ReleaseBefore(uint64_t frameOffset);
+
+private:
+    bool ParseHeader(const std::string& path);
+
+    void* mapping_;
+    size_t mappingSize_;
+    size_t releasedBytes_;   // 映射区开头已交还的字节数
+    const uint8_t* data_;
+    int sampleRate_;
+    size_t channels_;
+    uint16_t bitsPerSample_;
+    bool isFloat_;
+    uint64_t frames_;
+};
@@ -1,6 +1,7 @@
 'use strict';
 
 const path = require('path');
+const { Readable } = require('stream');
 const nodeGypBuild = require('node-gyp-build');
 
 // 尝试加载预编译的二进制文件
@@ -13,4 +14,33 @@ try {
   throw new Error(`会议录制模块加载失败: ${e.message}`);
 }
 
-module.exports = binding; 
\ No newline at end of file
+// 以 Readable 流读取实时混合音频（onAudio 的流式封装）
+// 每个 chunk 是指向原生缓冲池的 Buffer，不做复制；push 返回 false 时暂停原生交付，
+// 积压通过 PcmStream 反馈到采集端。录制停止时流结束，options 与 onAudio 相同
+binding.Recorder.prototype.createAudioStream = function createAudioStream(options = {}) {
+  const recorder = this;
+  const stream = new Readable({
+    highWaterMark: options.highWaterMark,
+    read() {
+      recorder.setAudioFlowing(true);
+    },
+    destroy(error, callback) {
+      recorder.onAudio(null);
+      callback(error);
+    }
+  });
+
+  recorder.onAudio((samples, info) => {
+    if (samples === null) {
+      stream.push(null);
+      return;
+    }
+    const chunk = Buffer.from(samples.buffer, samples.byteOffset, samples.byteLength);
+    if (!stream.push(chunk)) {
+      recorder.setAudioFlowing(false);
+    }
+  }, options);
+  return stream;
+};
+
+module.exports = binding;
@@ -0,0 +1,106 @@
+'use strict';
+
+// 对比两次 recorder_bench（或任意 Google Benchmark）JSON 输出，标出变慢超过阈值的项
+//
+// 用法: node scripts/compare-bench.js base.json new.json [--threshold=5] [--metric=real_time|cpu_time]
+// 有回归时退出码为 1，便于在 CI 中使用
+
+const fs = require('fs');
+
+function parseArgs(argv) {
+  const options = { threshold: 5, metric: 'real_time', files: [] };
+  for (const arg of argv) {
+    if (arg.startsWith('--threshold=')) {
+      options.threshold = Number(arg.slice('--threshold='.length));
+    } else if (arg.startsWith('--metric=')) {
+      options.metric = arg.slice('--metric='.length);
+    } else {
+      options.files.push(arg);
+    }
+  }
+  if (options.files.length !== 2 || !Number.isFinite(options.threshold) ||
+      !['real_time', 'cpu_time'].includes(options.metric)) {
+    console.error('用法: node scripts/compare-bench.js base.json new.json [--threshold=5] [--metric=real_time|cpu_time]');
+    process.exit(2);
+  }
+  return options;
+}
+
+// 时间统一换算成纳秒
+const UNIT_SCALE = { ns: 1, us: 1e3, ms: 1e6, s: 1e9 };
+
+function loadResults(file) {
+  const report = JSON.parse(fs.readFileSync(file, 'utf8'));
+  const results = new Map();
+  for (const entry of report.benchmarks || []) {
+    // 有重复运行时只取逐次结果，忽略聚合行以外的统计项
+    if (entry.run_type === 'aggregate' && entry.aggregate_name !== 'median') {
+      continue;
+    }
+    const name = entry.run_type === 'aggregate' ? entry.run_name : entry.name;
+    if (entry.error_occurred) {
+      results.set(name, { error: entry.error_message || 'error' });
+      continue;
+    }
+    results.set(name, { ...entry, scale: UNIT_SCALE[entry.time_unit || 'ns'] || 1 });
+  }
+  return results;
+}
+
+function formatTime(nanos) {
+  if (nanos >= 1e6) {
+    return `${(nanos / 1e6).toFixed(2)} ms`;
+  }
+  if (nanos >= 1e3) {
+    return `${(nanos / 1e3).toFixed(2)} us`;
+  }
+  return `${nanos.toFixed(1)} ns`;
+}
+
+function main() {
+  const options = parseArgs(process.argv.slice(2));
+  const base = loadResults(options.files[0]);
+  const current = loadResults(options.files[1]);
+
+  const rows = [];
+  let regressions = 0;
+  for (const [name, after] of current) {
+    const before = base.get(name);
+    if (!before) {
+      rows.push([name, '', '', '', '新增']);
+      continue;
+    }
+    if (before.error || after.error) {
+      rows.push([name, '', '', '', '跳过']);
+      continue;
+    }
+    const a = before[options.metric] * before.scale;
+    const b = after[options.metric] * after.scale;
+    const change = (b - a) / a * 100;
+    let status = '';
+    if (change > options.threshold) {
+      status = '回归';
+      regressions++;
+    } else if (change < -options.threshold) {
+      status = '提升';
+    }
+    rows.push([name, formatTime(a), formatTime(b), `${change >= 0 ? '+' : ''}${change.toFixed(1)}%`, status]);
+  }
+  for (const name of base.keys()) {
+    if (!current.has(name)) {
+      rows.push([name, '', '', '', '缺失']);
+    }
+  }
+
+  const header = ['benchmark', 'base', 'new', 'change', ''];
+  const widths = header.map((title, i) => Math.max(title.length, ...rows.map(row => row[i].length)));
+  const format = row => row.map((cell, i) => (i === 0 ? cell.padEnd(widths[i]) : cell.padStart(widths[i]))).join('  ');
+  console.log(format(header));
+  for (const row of rows) {
+    console.log(format(row));
+  }
+  console.log(`\n指标 ${options.metric}，阈值 ${options.threshold}%：${regressions} 项回归`);
+  process.exit(regressions > 0 ? 1 : 0);
+}
+
+main();
@@ -0,0 +1,91 @@
+#include "audio_encoder.h"
+#include "flac_encoder.h"
+#include "g722_encoder.h"
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+namespace {
+
+bool EndsWith(const std::string& text, const char* suffix) {
+    const size_t n = strlen(suffix);
+    if (text.size() < n) {
+        return false;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (tolower(static_cast<unsigned char>(text[text.size() - n + i])) != suffix[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+std::unique_ptr<AudioEncoder> AudioEncoder::Create(Codec codec, const Options& options) {
+    switch (codec) {
+    case Codec::Flac:
+        return std::unique_ptr<AudioEncoder>(new FlacEncoder(options));
+    case Codec::G722:
+        return std::unique_ptr<AudioEncoder>(new G722Encoder(options));
+    case Codec::Pcm:
+        break;
+    }
+    return nullptr;
+}
+
+AudioEncoder::Codec AudioEncoder::CodecForPath(const std::string& path) {
+    if (EndsWith(path, ".flac")) {
+        return Codec::Flac;
+    }
+    if (EndsWith(path, ".g722.wav")) {
+        return Codec::G722;
+    }
+    return Codec::Pcm;
+}
+
+const char* AudioEncoder::Extension(Codec codec) {
+    switch (codec) {
+    case Codec::Flac:
+        return ".flac";
+    case Codec::G722:
+        return ".g722.wav";
+    case Codec::Pcm:
+        break;
+    }
+    return ".wav";
+}
+
+bool AudioEncoder::ParseCodec(const char* name, Codec* codec) {
+    if (!name) {
+        return false;
+    }
+    if (strcmp(name, "pcm") == 0 || strcmp(name, "wav") == 0) {
+        *codec = Codec::Pcm;
+    } else if (strcmp(name, "flac") == 0) {
+        *codec = Codec::Flac;
+    } else if (strcmp(name, "g722") == 0) {
+        *codec = Codec::G722;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool AudioEncoder::WriteAt(int fd, const void* data, size_t size, uint64_t offset) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        ssize_t n = pwrite(fd, bytes, size, static_cast<off_t>(offset));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        bytes += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
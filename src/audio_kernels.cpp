@@ -0,0 +1,530 @@
+#include "audio_kernels.h"
+#include "audio_kernels_internal.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace AudioKernels {
+namespace internal {
+
+namespace {
+
+// 与 SSE 的 maxps/minps 语义一致（NaN 时取第二个操作数），保证各实现逐位相同
+inline float ClampToRange(float y, float lo, float hi) {
+    y = y > lo ? y : lo;
+    y = y < hi ? y : hi;
+    return y;
+}
+
+} // namespace
+
+void Interleave2Scalar(const float* left, const float* right, float* out, size_t frames) {
+    for (size_t i = 0; i < frames; ++i) {
+        out[i * 2] = left[i];
+        out[i * 2 + 1] = right[i];
+    }
+}
+
+void Interleave4Scalar(const float* const* planar, float* out, size_t frames) {
+    for (size_t i = 0; i < frames; ++i) {
+        out[i * 4] = planar[0][i];
+        out[i * 4 + 1] = planar[1][i];
+        out[i * 4 + 2] = planar[2][i];
+        out[i * 4 + 3] = planar[3][i];
+    }
+}
+
+void Deinterleave2Scalar(const float* in, float* left, float* right, size_t frames) {
+    for (size_t i = 0; i < frames; ++i) {
+        left[i] = in[i * 2];
+        right[i] = in[i * 2 + 1];
+    }
+}
+
+void Deinterleave4Scalar(const float* in, float* const* planar, size_t frames) {
+    for (size_t i = 0; i < frames; ++i) {
+        planar[0][i] = in[i * 4];
+        planar[1][i] = in[i * 4 + 1];
+        planar[2][i] = in[i * 4 + 2];
+        planar[3][i] = in[i * 4 + 3];
+    }
+}
+
+void Quantize16Scalar(const float* src, const float* noise, int16_t* dst, size_t samples) {
+    for (size_t i = 0; i < samples; ++i) {
+        float y = src[i] * 32767.0f;
+        if (noise) {
+            y = y + noise[i];
+        }
+        dst[i] = static_cast<int16_t>(std::lrintf(ClampToRange(y, -32768.0f, 32767.0f)));
+    }
+}
+
+void Quantize32Scalar(const float* src, const float* noise, float scale, int32_t* dst, size_t samples) {
+    const float lo = -scale - 1.0f;
+    for (size_t i = 0; i < samples; ++i) {
+        float y = src[i] * scale;
+        if (noise) {
+            y = y + noise[i];
+        }
+        dst[i] = static_cast<int32_t>(std::lrintf(ClampToRange(y, lo, scale)));
+    }
+}
+
+void Int16ToFloatScalar(const int16_t* src, float* dst, size_t samples) {
+    for (size_t i = 0; i < samples; ++i) {
+        dst[i] = static_cast<float>(src[i]) * (1.0f / 32768.0f);
+    }
+}
+
+void ApplyGainScalar(const float* src, float* dst, size_t samples, float gain) {
+    for (size_t i = 0; i < samples; ++i) {
+        dst[i] = src[i] * gain;
+    }
+}
+
+void StereoToMonoScalar(const float* in, float* mono, size_t frames) {
+    for (size_t i = 0; i < frames; ++i) {
+        mono[i] = (in[i * 2] + in[i * 2 + 1]) * 0.5f;
+    }
+}
+
+void MixAddScalar(const float* src, float* dst, size_t samples, float gain, float step, size_t offset) {
+    for (size_t i = 0; i < samples; ++i) {
+        dst[i] = dst[i] + src[i] * (gain + step * static_cast<float>(offset + i));
+    }
+}
+
+namespace {
+
+// 16 路累加器放在局部变量里，不与输入输出指针别名，编译器可以整组放进寄存器或自动向量化，
+// 而不是每个样本都经 lanes 指针读写内存；各路内部的累加顺序不变，结果与 SIMD 实现逐位一致
+struct LevelAccumulator {
+    float peak[kLevelLanes];
+    float sumSquares[kLevelLanes];
+    float sum[kLevelLanes];
+    uint32_t clipped[kLevelLanes];
+
+    explicit LevelAccumulator(const LevelLanes& lanes) {
+        memcpy(peak, lanes.peak, sizeof(peak));
+        memcpy(sumSquares, lanes.sumSquares, sizeof(sumSquares));
+        memcpy(sum, lanes.sum, sizeof(sum));
+        memcpy(clipped, lanes.clipped, sizeof(clipped));
+    }
+
+    void Store(LevelLanes* lanes) const {
+        memcpy(lanes->peak, peak, sizeof(peak));
+        memcpy(lanes->sumSquares, sumSquares, sizeof(sumSquares));
+        memcpy(lanes->sum, sum, sizeof(sum));
+        memcpy(lanes->clipped, clipped, sizeof(clipped));
+    }
+
+    // 比较与 maxps 一致：peak 为 NaN 以外的最大值；取最大值和削波计数都是无分支的选择
+    inline void Add(size_t lane, float v) {
+        const float a = std::fabs(v);
+        peak[lane] = a > peak[lane] ? a : peak[lane];
+        sumSquares[lane] = sumSquares[lane] + v * v;
+        sum[lane] = sum[lane] + v;
+        clipped[lane] += static_cast<uint32_t>(a >= kClipLevel);
+    }
+};
+
+// load(i) 返回第 i 个样本，可以顺带写出转换结果；先补齐到第 0 路，之后按整 16 个样本一组处理，
+// 组内路号是常量，没有逐样本的取模
+template <typename Load>
+inline void AccumulateLevels(size_t samples, size_t offset, LevelLanes* lanes, Load load) {
+    LevelAccumulator acc(*lanes);
+    size_t i = 0;
+    for (; i < samples && (offset + i) % kLevelLanes != 0; ++i) {
+        acc.Add((offset + i) % kLevelLanes, load(i));
+    }
+    for (; i + kLevelLanes <= samples; i += kLevelLanes) {
+        for (size_t lane = 0; lane < kLevelLanes; ++lane) {
+            acc.Add(lane, load(i + lane));
+        }
+    }
+    for (; i < samples; ++i) {
+        acc.Add((offset + i) % kLevelLanes, load(i));
+    }
+    acc.Store(lanes);
+}
+
+} // namespace
+
+void AccumulateLevelsScalar(const float* x, size_t samples, size_t offset, LevelLanes* lanes) {
+    AccumulateLevels(samples, offset, lanes, [x](size_t i) { return x[i]; });
+}
+
+// 复制、转换与统计在同一遍内完成
+void CopyLevelsScalar(const float* src, float* dst, size_t samples, LevelLanes* lanes, size_t offset) {
+    if (!dst) {
+        AccumulateLevelsScalar(src, samples, offset, lanes);
+        return;
+    }
+    AccumulateLevels(samples, offset, lanes, [src, dst](size_t i) {
+        const float v = src[i];
+        dst[i] = v;
+        return v;
+    });
+}
+
+void Int16ToFloatLevelsScalar(const int16_t* src, float* dst, size_t samples, LevelLanes* lanes, size_t offset) {
+    AccumulateLevels(samples, offset, lanes, [src, dst](size_t i) {
+        const float v = static_cast<float>(src[i]) * (1.0f / 32768.0f);
+        dst[i] = v;
+        return v;
+    });
+}
+
+namespace {
+
+void MixAddScalarKernel(const float* src, float* dst, size_t samples, float gain, float step) {
+    MixAddScalar(src, dst, samples, gain, step, 0);
+}
+
+// 交织后统计刚写出、仍在 L1 中的数据，统计本身走按组展开的快速路径
+void Interleave2LevelsScalarKernel(const float* left, const float* right, float* out, size_t frames,
+                                   LevelLanes* lanes) {
+    Interleave2Scalar(left, right, out, frames);
+    AccumulateLevelsScalar(out, frames * 2, 0, lanes);
+}
+
+void CopyLevelsScalarKernel(const float* src, float* dst, size_t samples, LevelLanes* lanes) {
+    CopyLevelsScalar(src, dst, samples, lanes, 0);
+}
+
+void Int16ToFloatLevelsScalarKernel(const int16_t* src, float* dst, size_t samples, LevelLanes* lanes) {
+    Int16ToFloatLevelsScalar(src, dst, samples, lanes, 0);
+}
+
+} // namespace
+
+const KernelTable* ScalarKernels() {
+    static const KernelTable table = {
+        Interleave2Scalar,
+        Interleave4Scalar,
+        Deinterleave2Scalar,
+        Deinterleave4Scalar,
+        Quantize16Scalar,
+        Quantize32Scalar,
+        Int16ToFloatScalar,
+        ApplyGainScalar,
+        StereoToMonoScalar,
+        MixAddScalarKernel,
+        Interleave2LevelsScalarKernel,
+        CopyLevelsScalarKernel,
+        Int16ToFloatLevelsScalarKernel
+    };
+    return &table;
+}
+
+} // namespace internal
+
+namespace {
+
+using internal::KernelTable;
+using internal::LevelLanes;
+
+// 抖动噪声按块生成，块内再交给向量化的量化内核
+constexpr size_t kDitherBlock = 256;
+constexpr float kInt24Scale = 8388607.0f;
+
+std::atomic<const KernelTable*> g_table{nullptr};
+std::atomic<Isa> g_isa{Isa::Scalar};
+
+const KernelTable* TableFor(Isa isa) {
+    switch (isa) {
+        case Isa::SSE2: return internal::Sse2Kernels();
+        case Isa::AVX2: return internal::Avx2Kernels();
+        case Isa::NEON: return internal::NeonKernels();
+        case Isa::Scalar: return internal::ScalarKernels();
+    }
+    return nullptr;
+}
+
+bool CpuSupports(Isa isa) {
+    if (!TableFor(isa)) {
+        return false;
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    if (isa == Isa::AVX2) {
+        return __builtin_cpu_supports("avx2");
+    }
+    if (isa == Isa::SSE2) {
+        return __builtin_cpu_supports("sse2");
+    }
+#endif
+    return true;
+}
+
+const KernelTable& Table() {
+    const KernelTable* table = g_table.load(std::memory_order_acquire);
+    if (!table) {
+        const Isa isa = DetectedIsa();
+        table = TableFor(isa);
+        g_isa.store(isa, std::memory_order_relaxed);
+        g_table.store(table, std::memory_order_release);
+    }
+    return *table;
+}
+
+// xorshift32，两个均匀分布之差得到 (-1, 1) LSB 的三角分布
+void FillTpdfNoise(DitherState& dither, float* noise, size_t count) {
+    uint32_t x = dither.state;
+    for (size_t i = 0; i < count; ++i) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        const float a = static_cast<float>(x >> 8) * (1.0f / 16777216.0f);
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        const float b = static_cast<float>(x >> 8) * (1.0f / 16777216.0f);
+        noise[i] = a - b;
+    }
+    dither.state = x;
+}
+
+// 小端平台上每 4 个样本拼成 3 个 32 位字写出，尾部逐字节处理
+void PackInt24(const int32_t* src, uint8_t* dst, size_t samples) {
+    size_t i = 0;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    for (; i + 4 <= samples; i += 4) {
+        const uint32_t v0 = static_cast<uint32_t>(src[i]);
+        const uint32_t v1 = static_cast<uint32_t>(src[i + 1]);
+        const uint32_t v2 = static_cast<uint32_t>(src[i + 2]);
+        const uint32_t v3 = static_cast<uint32_t>(src[i + 3]);
+        // 逐字写出：先拼到栈上的数组再整体拷贝会被编译成宽度不同的存取，存储转发失败
+        const uint32_t w0 = (v0 & 0xFFFFFFu) | (v1 << 24);
+        const uint32_t w1 = ((v1 >> 8) & 0xFFFFu) | (v2 << 16);
+        const uint32_t w2 = ((v2 >> 16) & 0xFFu) | (v3 << 8);
+        memcpy(dst + i * 3, &w0, sizeof(w0));
+        memcpy(dst + i * 3 + 4, &w1, sizeof(w1));
+        memcpy(dst + i * 3 + 8, &w2, sizeof(w2));
+    }
+#endif
+    for (; i < samples; ++i) {
+        const uint32_t v = static_cast<uint32_t>(src[i]);
+        dst[i * 3] = static_cast<uint8_t>(v);
+        dst[i * 3 + 1] = static_cast<uint8_t>(v >> 8);
+        dst[i * 3 + 2] = static_cast<uint8_t>(v >> 16);
+    }
+}
+
+// 按声道数展开的通用路径，编译器可以把内层循环完全展开
+template <size_t Channels>
+void InterleaveN(const float* const* planar, float* out, size_t frames) {
+    for (size_t i = 0; i < frames; ++i) {
+        for (size_t ch = 0; ch < Channels; ++ch) {
+            out[i * Channels + ch] = planar[ch][i];
+        }
+    }
+}
+
+template <size_t Channels>
+void DeinterleaveN(const float* in, float* const* planar, size_t frames) {
+    for (size_t i = 0; i < frames; ++i) {
+        for (size_t ch = 0; ch < Channels; ++ch) {
+            planar[ch][i] = in[i * Channels + ch];
+        }
+    }
+}
+
+// 各路按固定顺序合并；输入含 NaN 或正负无穷相加时，NaN 的符号位取决于加法操作数的顺序，
+// 统一成同一个 NaN，各实现的结果保持逐位一致
+void ReduceLevels(const LevelLanes& lanes, size_t samples, LevelStats* levels) {
+    LevelStats result;
+    for (size_t lane = 0; lane < internal::kLevelLanes; ++lane) {
+        result.peak = lanes.peak[lane] > result.peak ? lanes.peak[lane] : result.peak;
+        result.sumSquares = result.sumSquares + lanes.sumSquares[lane];
+        result.sum = result.sum + lanes.sum[lane];
+        result.clipped += lanes.clipped[lane];
+    }
+    if (std::isnan(result.sumSquares)) {
+        result.sumSquares = std::numeric_limits<float>::quiet_NaN();
+    }
+    if (std::isnan(result.sum)) {
+        result.sum = std::numeric_limits<float>::quiet_NaN();
+    }
+    result.samples = samples;
+    *levels = result;
+}
+
+} // namespace
+
+Isa DetectedIsa() {
+    for (Isa isa : {Isa::AVX2, Isa::NEON, Isa::SSE2}) {
+        if (CpuSupports(isa)) {
+            return isa;
+        }
+    }
+    return Isa::Scalar;
+}
+
+Isa ActiveIsa() {
+    Table();
+    return g_isa.load(std::memory_order_relaxed);
+}
+
+bool SetIsa(Isa isa) {
+    if (!CpuSupports(isa)) {
+        return false;
+    }
+    g_isa.store(isa, std::memory_order_relaxed);
+    g_table.store(TableFor(isa), std::memory_order_release);
+    return true;
+}
+
+const char* IsaName(Isa isa) {
+    switch (isa) {
+        case Isa::Scalar: return "scalar";
+        case Isa::SSE2: return "sse2";
+        case Isa::AVX2: return "avx2";
+        case Isa::NEON: return "neon";
+    }
+    return "unknown";
+}
+
+void Interleave(const float* const* planar, float* interleaved, size_t channels, size_t frames) {
+    switch (channels) {
+        case 0: return;
+        case 1: memcpy(interleaved, planar[0], frames * sizeof(float)); return;
+        case 2: Table().interleave2(planar[0], planar[1], interleaved, frames); return;
+        case 3: InterleaveN<3>(planar, interleaved, frames); return;
+        case 4: Table().interleave4(planar, interleaved, frames); return;
+        case 5: InterleaveN<5>(planar, interleaved, frames); return;
+        case 6: InterleaveN<6>(planar, interleaved, frames); return;
+        case 7: InterleaveN<7>(planar, interleaved, frames); return;
+        case 8: InterleaveN<8>(planar, interleaved, frames); return;
+    }
+    for (size_t i = 0; i < frames; ++i) {
+        for (size_t ch = 0; ch < channels; ++ch) {
+            interleaved[i * channels + ch] = planar[ch][i];
+        }
+    }
+}
+
+void InterleaveWithLevels(const float* const* planar, float* interleaved, size_t channels, size_t frames,
+                          LevelStats* levels) {
+    const KernelTable& table = Table();
+    LevelLanes lanes = {};
+    if (channels == 1) {
+        table.copyLevels(planar[0], interleaved, frames, &lanes);
+    } else if (channels == 2) {
+        table.interleave2Levels(planar[0], planar[1], interleaved, frames, &lanes);
+    } else {
+        Interleave(planar, interleaved, channels, frames);
+        table.copyLevels(interleaved, nullptr, frames * channels, &lanes);
+    }
+    ReduceLevels(lanes, frames * channels, levels);
+}
+
+void Deinterleave(const float* interleaved, float* const* planar, size_t channels, size_t frames) {
+    switch (channels) {
+        case 0: return;
+        case 1: memcpy(planar[0], interleaved, frames * sizeof(float)); return;
+        case 2: Table().deinterleave2(interleaved, planar[0], planar[1], frames); return;
+        case 3: DeinterleaveN<3>(interleaved, planar, frames); return;
+        case 4: Table().deinterleave4(interleaved, planar, frames); return;
+        case 5: DeinterleaveN<5>(interleaved, planar, frames); return;
+        case 6: DeinterleaveN<6>(interleaved, planar, frames); return;
+        case 7: DeinterleaveN<7>(interleaved, planar, frames); return;
+        case 8: DeinterleaveN<8>(interleaved, planar, frames); return;
+    }
+    for (size_t i = 0; i < frames; ++i) {
+        for (size_t ch = 0; ch < channels; ++ch) {
+            planar[ch][i] = interleaved[i * channels + ch];
+        }
+    }
+}
+
+void FloatToInt16(const float* src, int16_t* dst, size_t samples, DitherState* dither) {
+    const KernelTable& table = Table();
+    if (!dither) {
+        table.quantize16(src, nullptr, dst, samples);
+        return;
+    }
+    float noise[kDitherBlock];
+    for (size_t offset = 0; offset < samples; offset += kDitherBlock) {
+        const size_t count = std::min(kDitherBlock, samples - offset);
+        FillTpdfNoise(*dither, noise, count);
+        table.quantize16(src + offset, noise, dst + offset, count);
+    }
+}
+
+void FloatToInt24(const float* src, uint8_t* dst, size_t samples, DitherState* dither) {
+    const KernelTable& table = Table();
+    float noise[kDitherBlock];
+    int32_t quantized[kDitherBlock];
+    for (size_t offset = 0; offset < samples; offset += kDitherBlock) {
+        const size_t count = std::min(kDitherBlock, samples - offset);
+        if (dither) {
+            FillTpdfNoise(*dither, noise, count);
+        }
+        table.quantize32(src + offset, dither ? noise : nullptr, kInt24Scale, quantized, count);
+        PackInt24(quantized, dst + offset * 3, count);
+    }
+}
+
+void Int16ToFloat(const int16_t* src, float* dst, size_t samples) {
+    Table().int16ToFloat(src, dst, samples);
+}
+
+void Int24ToFloat(const uint8_t* src, float* dst, size_t samples) {
+    constexpr float kScale = 1.0f / 8388608.0f;
+    size_t i = 0;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // 每次读 3 个 32 位字（4 个样本），把每个样本的 3 字节拼到字的高 24 位再算术右移
+    for (; i + 4 <= samples; i += 4) {
+        uint32_t w0, w1, w2;
+        memcpy(&w0, src + i * 3, sizeof(w0));
+        memcpy(&w1, src + i * 3 + 4, sizeof(w1));
+        memcpy(&w2, src + i * 3 + 8, sizeof(w2));
+        dst[i] = static_cast<float>(static_cast<int32_t>(w0 << 8) >> 8) * kScale;
+        dst[i + 1] = static_cast<float>(static_cast<int32_t>((w0 >> 16) | (w1 << 16)) >> 8) * kScale;
+        dst[i + 2] = static_cast<float>(static_cast<int32_t>((w1 >> 8) | (w2 << 24)) >> 8) * kScale;
+        dst[i + 3] = static_cast<float>(static_cast<int32_t>(w2) >> 8) * kScale;
+    }
+#endif
+    for (; i < samples; ++i) {
+        // 先放到高 24 位再算术右移完成符号扩展
+        const int32_t v = static_cast<int32_t>((static_cast<uint32_t>(src[i * 3]) << 8) |
+                                               (static_cast<uint32_t>(src[i * 3 + 1]) << 16) |
+                                               (static_cast<uint32_t>(src[i * 3 + 2]) << 24)) >> 8;
+        dst[i] = static_cast<float>(v) * kScale;
+    }
+}
+
+void Int16ToFloatWithLevels(const int16_t* src, float* dst, size_t samples, LevelStats* levels) {
+    LevelLanes lanes = {};
+    Table().int16ToFloatLevels(src, dst, samples, &lanes);
+    ReduceLevels(lanes, samples, levels);
+}
+
+void CopyWithLevels(const float* src, float* dst, size_t samples, LevelStats* levels) {
+    LevelLanes lanes = {};
+    Table().copyLevels(src, dst, samples, &lanes);
+    ReduceLevels(lanes, samples, levels);
+}
+
+void MeasureLevels(const float* samples, size_t count, LevelStats* levels) {
+    LevelLanes lanes = {};
+    Table().copyLevels(samples, nullptr, count, &lanes);
+    ReduceLevels(lanes, count, levels);
+}
+
+void ApplyGain(const float* src, float* dst, size_t samples, float gain) {
+    Table().applyGain(src, dst, samples, gain);
+}
+
+void StereoToMono(const float* interleaved, float* mono, size_t frames) {
+    Table().stereoToMono(interleaved, mono, frames);
+}
+
+void MonoToStereo(const float* mono, float* interleaved, size_t frames) {
+    Table().interleave2(mono, mono, interleaved, frames);
+}
+
+void MixAdd(const float* src, float* dst, size_t samples, float gain, float gainStep) {
+    Table().mixAdd(src, dst, samples, gain, gainStep);
+}
+
+} // namespace AudioKernels
@@ -0,0 +1,258 @@
+#include "audio_kernels_internal.h"
+
+// 本文件单独以 -mavx2 编译，只有运行时检测到 AVX2 才会被调用
+#if defined(__AVX2__)
+
+#include <immintrin.h>
+
+namespace AudioKernels {
+namespace internal {
+
+namespace {
+
+// 8 个交织的立体声帧拆成左右两路，lanes 内 shuffle 后再跨 lane 重排
+inline void Split8(const float* in, __m256* left, __m256* right) {
+    const __m256 a = _mm256_loadu_ps(in);
+    const __m256 b = _mm256_loadu_ps(in + 8);
+    const __m256 even = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m256 odd = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+    *left = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(even), _MM_SHUFFLE(3, 1, 2, 0)));
+    *right = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(odd), _MM_SHUFFLE(3, 1, 2, 0)));
+}
+
+void Interleave2Avx2(const float* left, const float* right, float* out, size_t frames) {
+    size_t i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        const __m256 l = _mm256_loadu_ps(left + i);
+        const __m256 r = _mm256_loadu_ps(right + i);
+        const __m256 lo = _mm256_unpacklo_ps(l, r);
+        const __m256 hi = _mm256_unpackhi_ps(l, r);
+        _mm256_storeu_ps(out + i * 2, _mm256_permute2f128_ps(lo, hi, 0x20));
+        _mm256_storeu_ps(out + i * 2 + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+    Interleave2Scalar(left + i, right + i, out + i * 2, frames - i);
+}
+
+void Deinterleave2Avx2(const float* in, float* left, float* right, size_t frames) {
+    size_t i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        __m256 l, r;
+        Split8(in + i * 2, &l, &r);
+        _mm256_storeu_ps(left + i, l);
+        _mm256_storeu_ps(right + i, r);
+    }
+    Deinterleave2Scalar(in + i * 2, left + i, right + i, frames - i);
+}
+
+inline __m256i QuantizeAvx2(const float* src, const float* noise, __m256 scale, __m256 lo, __m256 hi) {
+    __m256 y = _mm256_mul_ps(_mm256_loadu_ps(src), scale);
+    if (noise) {
+        y = _mm256_add_ps(y, _mm256_loadu_ps(noise));
+    }
+    y = _mm256_min_ps(_mm256_max_ps(y, lo), hi);
+    return _mm256_cvtps_epi32(y);
+}
+
+void Quantize16Avx2(const float* src, const float* noise, int16_t* dst, size_t samples) {
+    const __m256 scale = _mm256_set1_ps(32767.0f);
+    const __m256 lo = _mm256_set1_ps(-32768.0f);
+    const __m256 hi = _mm256_set1_ps(32767.0f);
+    size_t i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        const __m256i a = QuantizeAvx2(src + i, noise ? noise + i : nullptr, scale, lo, hi);
+        const __m256i b = QuantizeAvx2(src + i + 8, noise ? noise + i + 8 : nullptr, scale, lo, hi);
+        // packs 按 128 位 lane 交错，重排回顺序
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), packed);
+    }
+    Quantize16Scalar(src + i, noise ? noise + i : nullptr, dst + i, samples - i);
+}
+
+void Quantize32Avx2(const float* src, const float* noise, float scale, int32_t* dst, size_t samples) {
+    const __m256 vscale = _mm256_set1_ps(scale);
+    const __m256 lo = _mm256_set1_ps(-scale - 1.0f);
+    const __m256 hi = _mm256_set1_ps(scale);
+    size_t i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                            QuantizeAvx2(src + i, noise ? noise + i : nullptr, vscale, lo, hi));
+    }
+    Quantize32Scalar(src + i, noise ? noise + i : nullptr, scale, dst + i, samples - i);
+}
+
+void Int16ToFloatAvx2(const int16_t* src, float* dst, size_t samples) {
+    const __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+    size_t i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        const __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+    }
+    Int16ToFloatScalar(src + i, dst + i, samples - i);
+}
+
+void ApplyGainAvx2(const float* src, float* dst, size_t samples, float gain) {
+    const __m256 g = _mm256_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(src + i), g));
+    }
+    ApplyGainScalar(src + i, dst + i, samples - i, gain);
+}
+
+void StereoToMonoAvx2(const float* in, float* mono, size_t frames) {
+    const __m256 half = _mm256_set1_ps(0.5f);
+    size_t i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        __m256 l, r;
+        Split8(in + i * 2, &l, &r);
+        _mm256_storeu_ps(mono + i, _mm256_mul_ps(_mm256_add_ps(l, r), half));
+    }
+    StereoToMonoScalar(in + i * 2, mono + i, frames - i);
+}
+
+void MixAddAvx2(const float* src, float* dst, size_t samples, float gain, float step) {
+    const __m256 g = _mm256_set1_ps(gain);
+    const __m256 s = _mm256_set1_ps(step);
+    const __m256 lanes = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+    size_t i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        const __m256 index = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(i)), lanes);
+        const __m256 gains = _mm256_add_ps(g, _mm256_mul_ps(s, index));
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i),
+                                                _mm256_mul_ps(_mm256_loadu_ps(src + i), gains)));
+    }
+    MixAddScalar(src + i, dst + i, samples - i, gain, step, i);
+}
+
+// 16 路电平统计放在两个 8 路寄存器里：第 h 个寄存器是第 8h~8h+7 路
+class LevelsAvx2 {
+public:
+    explicit LevelsAvx2(LevelLanes* lanes)
+        : lanes_(lanes)
+        , absMask_(_mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF)))
+        , clip_(_mm256_set1_ps(kClipLevel)) {
+        for (int h = 0; h < 2; ++h) {
+            peak_[h] = _mm256_loadu_ps(lanes->peak + h * 8);
+            sumSquares_[h] = _mm256_loadu_ps(lanes->sumSquares + h * 8);
+            sum_[h] = _mm256_loadu_ps(lanes->sum + h * 8);
+            clipped_[h] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes->clipped + h * 8));
+        }
+    }
+
+    void Store() {
+        for (int h = 0; h < 2; ++h) {
+            _mm256_storeu_ps(lanes_->peak + h * 8, peak_[h]);
+            _mm256_storeu_ps(lanes_->sumSquares + h * 8, sumSquares_[h]);
+            _mm256_storeu_ps(lanes_->sum + h * 8, sum_[h]);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes_->clipped + h * 8), clipped_[h]);
+        }
+    }
+
+    void Add(int h, __m256 x) {
+        const __m256 a = _mm256_and_ps(x, absMask_);
+        peak_[h] = _mm256_max_ps(a, peak_[h]);
+        sumSquares_[h] = _mm256_add_ps(sumSquares_[h], _mm256_mul_ps(x, x));
+        sum_[h] = _mm256_add_ps(sum_[h], x);
+        clipped_[h] = _mm256_sub_epi32(clipped_[h], _mm256_castps_si256(_mm256_cmp_ps(a, clip_, _CMP_GE_OQ)));
+    }
+
+private:
+    LevelLanes* lanes_;
+    const __m256 absMask_;
+    const __m256 clip_;
+    __m256 peak_[2];
+    __m256 sumSquares_[2];
+    __m256 sum_[2];
+    __m256i clipped_[2];
+};
+
+void Interleave2LevelsAvx2(const float* left, const float* right, float* out, size_t frames, LevelLanes* lanes) {
+    LevelsAvx2 levels(lanes);
+    size_t i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        const __m256 l = _mm256_loadu_ps(left + i);
+        const __m256 r = _mm256_loadu_ps(right + i);
+        const __m256 lo = _mm256_unpacklo_ps(l, r);
+        const __m256 hi = _mm256_unpackhi_ps(l, r);
+        const __m256 first = _mm256_permute2f128_ps(lo, hi, 0x20);
+        const __m256 second = _mm256_permute2f128_ps(lo, hi, 0x31);
+        _mm256_storeu_ps(out + i * 2, first);
+        _mm256_storeu_ps(out + i * 2 + 8, second);
+        levels.Add(0, first);
+        levels.Add(1, second);
+    }
+    levels.Store();
+    Interleave2Scalar(left + i, right + i, out + i * 2, frames - i);
+    AccumulateLevelsScalar(out + i * 2, (frames - i) * 2, i * 2, lanes);
+}
+
+void CopyLevelsAvx2(const float* src, float* dst, size_t samples, LevelLanes* lanes) {
+    LevelsAvx2 levels(lanes);
+    size_t i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        for (int h = 0; h < 2; ++h) {
+            const __m256 v = _mm256_loadu_ps(src + i + h * 8);
+            if (dst) {
+                _mm256_storeu_ps(dst + i + h * 8, v);
+            }
+            levels.Add(h, v);
+        }
+    }
+    levels.Store();
+    CopyLevelsScalar(src + i, dst ? dst + i : nullptr, samples - i, lanes, i);
+}
+
+void Int16ToFloatLevelsAvx2(const int16_t* src, float* dst, size_t samples, LevelLanes* lanes) {
+    const __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+    LevelsAvx2 levels(lanes);
+    size_t i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        for (int h = 0; h < 2; ++h) {
+            const __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + h * 8)));
+            const __m256 x = _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale);
+            _mm256_storeu_ps(dst + i + h * 8, x);
+            levels.Add(h, x);
+        }
+    }
+    levels.Store();
+    Int16ToFloatLevelsScalar(src + i, dst + i, samples - i, lanes, i);
+}
+
+} // namespace
+
+const KernelTable* Avx2Kernels() {
+    // 4 声道的 4x4 转置用 128 位寄存器已经足够，沿用 SSE2 版本
+    static const KernelTable table = {
+        Interleave2Avx2,
+        Sse2Kernels()->interleave4,
+        Deinterleave2Avx2,
+        Sse2Kernels()->deinterleave4,
+        Quantize16Avx2,
+        Quantize32Avx2,
+        Int16ToFloatAvx2,
+        ApplyGainAvx2,
+        StereoToMonoAvx2,
+        MixAddAvx2,
+        Interleave2LevelsAvx2,
+        CopyLevelsAvx2,
+        Int16ToFloatLevelsAvx2
+    };
+    return &table;
+}
+
+} // namespace internal
+} // namespace AudioKernels
+
+#else
+
+namespace AudioKernels {
+namespace internal {
+
+const KernelTable* Avx2Kernels() {
+    return nullptr;
+}
+
+} // namespace internal
+} // namespace AudioKernels
+
+#endif
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "audio_kernels.h"
+#include <cstddef>
+#include <cstdint>
+
+// 各指令集实现共用的内核表，只在 audio_kernels*.cpp 内部使用
+namespace AudioKernels {
+namespace internal {
+
+// 电平统计的 16 路部分结果：第 i 个样本累加到第 i % 16 路，每一路的累加顺序都与标量版相同；
+// SSE2/NEON 用四个 4 路寄存器、AVX2 用两个 8 路寄存器，几条加法依赖链互不等待
+constexpr size_t kLevelLanes = 16;
+
+struct LevelLanes {
+    float peak[kLevelLanes];
+    float sumSquares[kLevelLanes];
+    float sum[kLevelLanes];
+    uint32_t clipped[kLevelLanes];
+};
+
+struct KernelTable {
+    void (*interleave2)(const float* left, const float* right, float* out, size_t frames);
+    void (*interleave4)(const float* const* planar, float* out, size_t frames);
+    void (*deinterleave2)(const float* in, float* left, float* right, size_t frames);
+    void (*deinterleave4)(const float* in, float* const* planar, size_t frames);
+    // y = x * scale + noise，先钳位到 [-scale - 1, scale] 再按就近偶数舍入；noise 可以为空
+    void (*quantize16)(const float* src, const float* noise, int16_t* dst, size_t samples);
+    void (*quantize32)(const float* src, const float* noise, float scale, int32_t* dst, size_t samples);
+    void (*int16ToFloat)(const int16_t* src, float* dst, size_t samples);
+    void (*applyGain)(const float* src, float* dst, size_t samples, float gain);
+    void (*stereoToMono)(const float* in, float* mono, size_t frames);
+    // dst[i] += src[i] * (gain + step * i)，i 按 float 计算
+    void (*mixAdd)(const float* src, float* dst, size_t samples, float gain, float step);
+    // 以下在转换的同时把输出累加进 lanes；dst 为空时 copyLevels 只统计
+    void (*interleave2Levels)(const float* left, const float* right, float* out, size_t frames, LevelLanes* lanes);
+    void (*copyLevels)(const float* src, float* dst, size_t samples, LevelLanes* lanes);
+    void (*int16ToFloatLevels)(const int16_t* src, float* dst, size_t samples, LevelLanes* lanes);
+};
+
+// 标量参考实现，SIMD 版本用它处理尾部样本
+void Interleave2Scalar(const float* left, const float* right, float* out, size_t frames);
+void Interleave4Scalar(const float* const* planar, float* out, size_t frames);
+void Deinterleave2Scalar(const float* in, float* left, float* right, size_t frames);
+void Deinterleave4Scalar(const float* in, float* const* planar, size_t frames);
+void Quantize16Scalar(const float* src, const float* noise, int16_t* dst, size_t samples);
+void Quantize32Scalar(const float* src, const float* noise, float scale, int32_t* dst, size_t samples);
+void Int16ToFloatScalar(const int16_t* src, float* dst, size_t samples);
+void ApplyGainScalar(const float* src, float* dst, size_t samples, float gain);
+void StereoToMonoScalar(const float* in, float* mono, size_t frames);
+// offset 为 src[0] 在整段中的下标，SIMD 版本处理尾部时传入
+void MixAddScalar(const float* src, float* dst, size_t samples, float gain, float step, size_t offset = 0);
+// offset 为 x[0] 在整块中的样本下标，决定从哪一路开始累加
+void AccumulateLevelsScalar(const float* x, size_t samples, size_t offset, LevelLanes* lanes);
+void CopyLevelsScalar(const float* src, float* dst, size_t samples, LevelLanes* lanes, size_t offset = 0);
+void Int16ToFloatLevelsScalar(const int16_t* src, float* dst, size_t samples, LevelLanes* lanes, size_t offset = 0);
+
+// 未针对当前架构编译时返回 nullptr
+const KernelTable* ScalarKernels();
+const KernelTable* Sse2Kernels();
+const KernelTable* Avx2Kernels();
+const KernelTable* NeonKernels();
+
+} // namespace internal
+} // namespace AudioKernels
@@ -0,0 +1,274 @@
+#include "audio_kernels_internal.h"
+
+// ARM64 上 NEON 是基线指令集，不需要运行时检测
+#if defined(__ARM_NEON) && defined(__aarch64__)
+
+#include <arm_neon.h>
+
+namespace AudioKernels {
+namespace internal {
+
+namespace {
+
+void Interleave2Neon(const float* left, const float* right, float* out, size_t frames) {
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        float32x4x2_t v;
+        v.val[0] = vld1q_f32(left + i);
+        v.val[1] = vld1q_f32(right + i);
+        vst2q_f32(out + i * 2, v);
+    }
+    Interleave2Scalar(left + i, right + i, out + i * 2, frames - i);
+}
+
+void Interleave4Neon(const float* const* planar, float* out, size_t frames) {
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        float32x4x4_t v;
+        v.val[0] = vld1q_f32(planar[0] + i);
+        v.val[1] = vld1q_f32(planar[1] + i);
+        v.val[2] = vld1q_f32(planar[2] + i);
+        v.val[3] = vld1q_f32(planar[3] + i);
+        vst4q_f32(out + i * 4, v);
+    }
+    const float* tail[4] = {planar[0] + i, planar[1] + i, planar[2] + i, planar[3] + i};
+    Interleave4Scalar(tail, out + i * 4, frames - i);
+}
+
+void Deinterleave2Neon(const float* in, float* left, float* right, size_t frames) {
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        const float32x4x2_t v = vld2q_f32(in + i * 2);
+        vst1q_f32(left + i, v.val[0]);
+        vst1q_f32(right + i, v.val[1]);
+    }
+    Deinterleave2Scalar(in + i * 2, left + i, right + i, frames - i);
+}
+
+void Deinterleave4Neon(const float* in, float* const* planar, size_t frames) {
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        const float32x4x4_t v = vld4q_f32(in + i * 4);
+        vst1q_f32(planar[0] + i, v.val[0]);
+        vst1q_f32(planar[1] + i, v.val[1]);
+        vst1q_f32(planar[2] + i, v.val[2]);
+        vst1q_f32(planar[3] + i, v.val[3]);
+    }
+    float* const tail[4] = {planar[0] + i, planar[1] + i, planar[2] + i, planar[3] + i};
+    Deinterleave4Scalar(in + i * 4, tail, frames - i);
+}
+
+// vmaxq/vminq 会传播 NaN，用比较加选择复现标量实现的钳位语义
+inline int32x4_t QuantizeNeon(const float* src, const float* noise, float32x4_t scale,
+                              float32x4_t lo, float32x4_t hi) {
+    float32x4_t y = vmulq_f32(vld1q_f32(src), scale);
+    if (noise) {
+        y = vaddq_f32(y, vld1q_f32(noise));
+    }
+    y = vbslq_f32(vcgtq_f32(y, lo), y, lo);
+    y = vbslq_f32(vcltq_f32(y, hi), y, hi);
+    return vcvtnq_s32_f32(y);
+}
+
+void Quantize16Neon(const float* src, const float* noise, int16_t* dst, size_t samples) {
+    const float32x4_t scale = vdupq_n_f32(32767.0f);
+    const float32x4_t lo = vdupq_n_f32(-32768.0f);
+    const float32x4_t hi = vdupq_n_f32(32767.0f);
+    size_t i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        const int32x4_t a = QuantizeNeon(src + i, noise ? noise + i : nullptr, scale, lo, hi);
+        const int32x4_t b = QuantizeNeon(src + i + 4, noise ? noise + i + 4 : nullptr, scale, lo, hi);
+        vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+    }
+    Quantize16Scalar(src + i, noise ? noise + i : nullptr, dst + i, samples - i);
+}
+
+void Quantize32Neon(const float* src, const float* noise, float scale, int32_t* dst, size_t samples) {
+    const float32x4_t vscale = vdupq_n_f32(scale);
+    const float32x4_t lo = vdupq_n_f32(-scale - 1.0f);
+    const float32x4_t hi = vdupq_n_f32(scale);
+    size_t i = 0;
+    for (; i + 4 <= samples; i += 4) {
+        vst1q_s32(dst + i, QuantizeNeon(src + i, noise ? noise + i : nullptr, vscale, lo, hi));
+    }
+    Quantize32Scalar(src + i, noise ? noise + i : nullptr, scale, dst + i, samples - i);
+}
+
+void Int16ToFloatNeon(const int16_t* src, float* dst, size_t samples) {
+    const float32x4_t scale = vdupq_n_f32(1.0f / 32768.0f);
+    size_t i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        const int16x8_t v = vld1q_s16(src + i);
+        vst1q_f32(dst + i, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale));
+        vst1q_f32(dst + i + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale));
+    }
+    Int16ToFloatScalar(src + i, dst + i, samples - i);
+}
+
+void ApplyGainNeon(const float* src, float* dst, size_t samples, float gain) {
+    const float32x4_t g = vdupq_n_f32(gain);
+    size_t i = 0;
+    for (; i + 4 <= samples; i += 4) {
+        vst1q_f32(dst + i, vmulq_f32(vld1q_f32(src + i), g));
+    }
+    ApplyGainScalar(src + i, dst + i, samples - i, gain);
+}
+
+void StereoToMonoNeon(const float* in, float* mono, size_t frames) {
+    const float32x4_t half = vdupq_n_f32(0.5f);
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        const float32x4x2_t v = vld2q_f32(in + i * 2);
+        vst1q_f32(mono + i, vmulq_f32(vaddq_f32(v.val[0], v.val[1]), half));
+    }
+    StereoToMonoScalar(in + i * 2, mono + i, frames - i);
+}
+
+// 乘加分开写，避免合并成 vfma，保持与标量版逐位一致
+void MixAddNeon(const float* src, float* dst, size_t samples, float gain, float step) {
+    const float32x4_t g = vdupq_n_f32(gain);
+    const float32x4_t s = vdupq_n_f32(step);
+    static const float kLanes[4] = {0.0f, 1.0f, 2.0f, 3.0f};
+    const float32x4_t lanes = vld1q_f32(kLanes);
+    size_t i = 0;
+    for (; i + 4 <= samples; i += 4) {
+        const float32x4_t index = vaddq_f32(vdupq_n_f32(static_cast<float>(i)), lanes);
+        const float32x4_t gains = vaddq_f32(g, vmulq_f32(s, index));
+        vst1q_f32(dst + i, vaddq_f32(vld1q_f32(dst + i), vmulq_f32(vld1q_f32(src + i), gains)));
+    }
+    MixAddScalar(src + i, dst + i, samples - i, gain, step, i);
+}
+
+// 16 路电平统计放在四个 4 路寄存器里，第 q 个寄存器是第 4q~4q+3 路；
+// vmaxq 遇到 NaN 会返回 NaN，峰值用比较 + 选择，与 maxps 的语义一致
+class LevelsNeon {
+public:
+    explicit LevelsNeon(LevelLanes* lanes)
+        : lanes_(lanes)
+        , clip_(vdupq_n_f32(kClipLevel)) {
+        for (int q = 0; q < 4; ++q) {
+            peak_[q] = vld1q_f32(lanes->peak + q * 4);
+            sumSquares_[q] = vld1q_f32(lanes->sumSquares + q * 4);
+            sum_[q] = vld1q_f32(lanes->sum + q * 4);
+            clipped_[q] = vld1q_u32(lanes->clipped + q * 4);
+        }
+    }
+
+    void Store() {
+        for (int q = 0; q < 4; ++q) {
+            vst1q_f32(lanes_->peak + q * 4, peak_[q]);
+            vst1q_f32(lanes_->sumSquares + q * 4, sumSquares_[q]);
+            vst1q_f32(lanes_->sum + q * 4, sum_[q]);
+            vst1q_u32(lanes_->clipped + q * 4, clipped_[q]);
+        }
+    }
+
+    void Add(int q, float32x4_t x) {
+        const float32x4_t a = vabsq_f32(x);
+        peak_[q] = vbslq_f32(vcgtq_f32(a, peak_[q]), a, peak_[q]);
+        sumSquares_[q] = vaddq_f32(sumSquares_[q], vmulq_f32(x, x));
+        sum_[q] = vaddq_f32(sum_[q], x);
+        clipped_[q] = vsubq_u32(clipped_[q], vcgeq_f32(a, clip_));
+    }
+
+private:
+    LevelLanes* lanes_;
+    const float32x4_t clip_;
+    float32x4_t peak_[4];
+    float32x4_t sumSquares_[4];
+    float32x4_t sum_[4];
+    uint32x4_t clipped_[4];
+};
+
+void Interleave2LevelsNeon(const float* left, const float* right, float* out, size_t frames, LevelLanes* lanes) {
+    LevelsNeon levels(lanes);
+    size_t i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        for (int k = 0; k < 2; ++k) {
+            const float32x4_t l = vld1q_f32(left + i + k * 4);
+            const float32x4_t r = vld1q_f32(right + i + k * 4);
+            const float32x4_t lo = vzip1q_f32(l, r);
+            const float32x4_t hi = vzip2q_f32(l, r);
+            vst1q_f32(out + i * 2 + k * 8, lo);
+            vst1q_f32(out + i * 2 + k * 8 + 4, hi);
+            levels.Add(k * 2, lo);
+            levels.Add(k * 2 + 1, hi);
+        }
+    }
+    levels.Store();
+    Interleave2Scalar(left + i, right + i, out + i * 2, frames - i);
+    AccumulateLevelsScalar(out + i * 2, (frames - i) * 2, i * 2, lanes);
+}
+
+void CopyLevelsNeon(const float* src, float* dst, size_t samples, LevelLanes* lanes) {
+    LevelsNeon levels(lanes);
+    size_t i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        for (int q = 0; q < 4; ++q) {
+            const float32x4_t v = vld1q_f32(src + i + q * 4);
+            if (dst) {
+                vst1q_f32(dst + i + q * 4, v);
+            }
+            levels.Add(q, v);
+        }
+    }
+    levels.Store();
+    CopyLevelsScalar(src + i, dst ? dst + i : nullptr, samples - i, lanes, i);
+}
+
+void Int16ToFloatLevelsNeon(const int16_t* src, float* dst, size_t samples, LevelLanes* lanes) {
+    const float32x4_t scale = vdupq_n_f32(1.0f / 32768.0f);
+    LevelsNeon levels(lanes);
+    size_t i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        for (int k = 0; k < 2; ++k) {
+            const int16x8_t v = vld1q_s16(src + i + k * 8);
+            const float32x4_t lo = vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale);
+            const float32x4_t hi = vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale);
+            vst1q_f32(dst + i + k * 8, lo);
+            vst1q_f32(dst + i + k * 8 + 4, hi);
+            levels.Add(k * 2, lo);
+            levels.Add(k * 2 + 1, hi);
+        }
+    }
+    levels.Store();
+    Int16ToFloatLevelsScalar(src + i, dst + i, samples - i, lanes, i);
+}
+
+} // namespace
+
+const KernelTable* NeonKernels() {
+    static const KernelTable table = {
+        Interleave2Neon,
+        Interleave4Neon,
+        Deinterleave2Neon,
+        Deinterleave4Neon,
+        Quantize16Neon,
+        Quantize32Neon,
+        Int16ToFloatNeon,
+        ApplyGainNeon,
+        StereoToMonoNeon,
+        MixAddNeon,
+        Interleave2LevelsNeon,
+        CopyLevelsNeon,
+        Int16ToFloatLevelsNeon
+    };
+    return &table;
+}
+
+} // namespace internal
+} // namespace AudioKernels
+
+#else
+
+namespace AudioKernels {
+namespace internal {
+
+const KernelTable* NeonKernels() {
+    return nullptr;
+}
+
+} // namespace internal
+} // namespace AudioKernels
+
+#endif
@@ -0,0 +1,290 @@
+#include "audio_kernels_internal.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <emmintrin.h>
+
+namespace AudioKernels {
+namespace internal {
+
+namespace {
+
+void Interleave2Sse2(const float* left, const float* right, float* out, size_t frames) {
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        const __m128 l = _mm_loadu_ps(left + i);
+        const __m128 r = _mm_loadu_ps(right + i);
+        _mm_storeu_ps(out + i * 2, _mm_unpacklo_ps(l, r));
+        _mm_storeu_ps(out + i * 2 + 4, _mm_unpackhi_ps(l, r));
+    }
+    Interleave2Scalar(left + i, right + i, out + i * 2, frames - i);
+}
+
+void Interleave4Sse2(const float* const* planar, float* out, size_t frames) {
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        __m128 a = _mm_loadu_ps(planar[0] + i);
+        __m128 b = _mm_loadu_ps(planar[1] + i);
+        __m128 c = _mm_loadu_ps(planar[2] + i);
+        __m128 d = _mm_loadu_ps(planar[3] + i);
+        _MM_TRANSPOSE4_PS(a, b, c, d);
+        _mm_storeu_ps(out + i * 4, a);
+        _mm_storeu_ps(out + i * 4 + 4, b);
+        _mm_storeu_ps(out + i * 4 + 8, c);
+        _mm_storeu_ps(out + i * 4 + 12, d);
+    }
+    const float* tail[4] = {planar[0] + i, planar[1] + i, planar[2] + i, planar[3] + i};
+    Interleave4Scalar(tail, out + i * 4, frames - i);
+}
+
+void Deinterleave2Sse2(const float* in, float* left, float* right, size_t frames) {
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        const __m128 a = _mm_loadu_ps(in + i * 2);
+        const __m128 b = _mm_loadu_ps(in + i * 2 + 4);
+        _mm_storeu_ps(left + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+    Deinterleave2Scalar(in + i * 2, left + i, right + i, frames - i);
+}
+
+void Deinterleave4Sse2(const float* in, float* const* planar, size_t frames) {
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        __m128 a = _mm_loadu_ps(in + i * 4);
+        __m128 b = _mm_loadu_ps(in + i * 4 + 4);
+        __m128 c = _mm_loadu_ps(in + i * 4 + 8);
+        __m128 d = _mm_loadu_ps(in + i * 4 + 12);
+        _MM_TRANSPOSE4_PS(a, b, c, d);
+        _mm_storeu_ps(planar[0] + i, a);
+        _mm_storeu_ps(planar[1] + i, b);
+        _mm_storeu_ps(planar[2] + i, c);
+        _mm_storeu_ps(planar[3] + i, d);
+    }
+    float* const tail[4] = {planar[0] + i, planar[1] + i, planar[2] + i, planar[3] + i};
+    Deinterleave4Scalar(in + i * 4, tail, frames - i);
+}
+
+inline __m128i QuantizeSse2(const float* src, const float* noise, __m128 scale, __m128 lo, __m128 hi) {
+    __m128 y = _mm_mul_ps(_mm_loadu_ps(src), scale);
+    if (noise) {
+        y = _mm_add_ps(y, _mm_loadu_ps(noise));
+    }
+    y = _mm_min_ps(_mm_max_ps(y, lo), hi);
+    return _mm_cvtps_epi32(y);
+}
+
+void Quantize16Sse2(const float* src, const float* noise, int16_t* dst, size_t samples) {
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    const __m128 lo = _mm_set1_ps(-32768.0f);
+    const __m128 hi = _mm_set1_ps(32767.0f);
+    size_t i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        const __m128i a = QuantizeSse2(src + i, noise ? noise + i : nullptr, scale, lo, hi);
+        const __m128i b = QuantizeSse2(src + i + 4, noise ? noise + i + 4 : nullptr, scale, lo, hi);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(a, b));
+    }
+    Quantize16Scalar(src + i, noise ? noise + i : nullptr, dst + i, samples - i);
+}
+
+void Quantize32Sse2(const float* src, const float* noise, float scale, int32_t* dst, size_t samples) {
+    const __m128 vscale = _mm_set1_ps(scale);
+    const __m128 lo = _mm_set1_ps(-scale - 1.0f);
+    const __m128 hi = _mm_set1_ps(scale);
+    size_t i = 0;
+    for (; i + 4 <= samples; i += 4) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                         QuantizeSse2(src + i, noise ? noise + i : nullptr, vscale, lo, hi));
+    }
+    Quantize32Scalar(src + i, noise ? noise + i : nullptr, scale, dst + i, samples - i);
+}
+
+void Int16ToFloatSse2(const int16_t* src, float* dst, size_t samples) {
+    const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+    size_t i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        // 把 16 位放到高半部分后算术右移完成符号扩展
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    Int16ToFloatScalar(src + i, dst + i, samples - i);
+}
+
+void ApplyGainSse2(const float* src, float* dst, size_t samples, float gain) {
+    const __m128 g = _mm_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 4 <= samples; i += 4) {
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(src + i), g));
+    }
+    ApplyGainScalar(src + i, dst + i, samples - i, gain);
+}
+
+void StereoToMonoSse2(const float* in, float* mono, size_t frames) {
+    const __m128 half = _mm_set1_ps(0.5f);
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        const __m128 a = _mm_loadu_ps(in + i * 2);
+        const __m128 b = _mm_loadu_ps(in + i * 2 + 4);
+        const __m128 l = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m128 r = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm_storeu_ps(mono + i, _mm_mul_ps(_mm_add_ps(l, r), half));
+    }
+    StereoToMonoScalar(in + i * 2, mono + i, frames - i);
+}
+
+// 下标向量 base + {0,1,2,3} 在 2^24 以内用 float 精确表示，与标量版逐位一致
+void MixAddSse2(const float* src, float* dst, size_t samples, float gain, float step) {
+    const __m128 g = _mm_set1_ps(gain);
+    const __m128 s = _mm_set1_ps(step);
+    const __m128 lanes = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+    size_t i = 0;
+    for (; i + 4 <= samples; i += 4) {
+        const __m128 index = _mm_add_ps(_mm_set1_ps(static_cast<float>(i)), lanes);
+        const __m128 gains = _mm_add_ps(g, _mm_mul_ps(s, index));
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), gains)));
+    }
+    MixAddScalar(src + i, dst + i, samples - i, gain, step, i);
+}
+
+// 16 路电平统计：平方和与和的第 q 个寄存器是第 4q~4q+3 路，与标量版逐路对应；
+// 峰值和削波计数与累加顺序无关，只用两个和一个寄存器（第 0~7 路），16 个 xmm 寄存器放得下，不会溢出到栈上
+class LevelsSse2 {
+public:
+    explicit LevelsSse2(LevelLanes* lanes)
+        : lanes_(lanes)
+        , absMask_(_mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF)))
+        , clip_(_mm_set1_ps(kClipLevel)) {
+        for (int q = 0; q < 4; ++q) {
+            sumSquares_[q] = _mm_loadu_ps(lanes->sumSquares + q * 4);
+            sum_[q] = _mm_loadu_ps(lanes->sum + q * 4);
+        }
+        peak_[0] = _mm_loadu_ps(lanes->peak);
+        peak_[1] = _mm_loadu_ps(lanes->peak + 4);
+        clipped_ = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes->clipped));
+    }
+
+    // 写回后才能交给标量版处理尾部
+    void Store() {
+        for (int q = 0; q < 4; ++q) {
+            _mm_storeu_ps(lanes_->sumSquares + q * 4, sumSquares_[q]);
+            _mm_storeu_ps(lanes_->sum + q * 4, sum_[q]);
+        }
+        _mm_storeu_ps(lanes_->peak, peak_[0]);
+        _mm_storeu_ps(lanes_->peak + 4, peak_[1]);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes_->clipped), clipped_);
+    }
+
+    void Add(int q, __m128 x) {
+        const __m128 a = _mm_and_ps(x, absMask_);
+        peak_[q & 1] = _mm_max_ps(a, peak_[q & 1]);
+        sumSquares_[q] = _mm_add_ps(sumSquares_[q], _mm_mul_ps(x, x));
+        sum_[q] = _mm_add_ps(sum_[q], x);
+        // 比较结果全 1 即 -1，相减等于计数加一
+        clipped_ = _mm_sub_epi32(clipped_, _mm_castps_si128(_mm_cmpge_ps(a, clip_)));
+    }
+
+private:
+    LevelLanes* lanes_;
+    const __m128 absMask_;
+    const __m128 clip_;
+    __m128 peak_[2];
+    __m128 sumSquares_[4];
+    __m128 sum_[4];
+    __m128i clipped_;
+};
+
+void Interleave2LevelsSse2(const float* left, const float* right, float* out, size_t frames, LevelLanes* lanes) {
+    LevelsSse2 levels(lanes);
+    size_t i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        for (int k = 0; k < 2; ++k) {
+            const __m128 l = _mm_loadu_ps(left + i + k * 4);
+            const __m128 r = _mm_loadu_ps(right + i + k * 4);
+            const __m128 lo = _mm_unpacklo_ps(l, r);
+            const __m128 hi = _mm_unpackhi_ps(l, r);
+            _mm_storeu_ps(out + i * 2 + k * 8, lo);
+            _mm_storeu_ps(out + i * 2 + k * 8 + 4, hi);
+            levels.Add(k * 2, lo);
+            levels.Add(k * 2 + 1, hi);
+        }
+    }
+    levels.Store();
+    Interleave2Scalar(left + i, right + i, out + i * 2, frames - i);
+    AccumulateLevelsScalar(out + i * 2, (frames - i) * 2, i * 2, lanes);
+}
+
+void CopyLevelsSse2(const float* src, float* dst, size_t samples, LevelLanes* lanes) {
+    LevelsSse2 levels(lanes);
+    size_t i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        for (int q = 0; q < 4; ++q) {
+            const __m128 v = _mm_loadu_ps(src + i + q * 4);
+            if (dst) {
+                _mm_storeu_ps(dst + i + q * 4, v);
+            }
+            levels.Add(q, v);
+        }
+    }
+    levels.Store();
+    CopyLevelsScalar(src + i, dst ? dst + i : nullptr, samples - i, lanes, i);
+}
+
+void Int16ToFloatLevelsSse2(const int16_t* src, float* dst, size_t samples, LevelLanes* lanes) {
+    const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+    LevelsSse2 levels(lanes);
+    size_t i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        for (int k = 0; k < 2; ++k) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + k * 8));
+            const __m128 lo = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16)), scale);
+            const __m128 hi = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16)), scale);
+            _mm_storeu_ps(dst + i + k * 8, lo);
+            _mm_storeu_ps(dst + i + k * 8 + 4, hi);
+            levels.Add(k * 2, lo);
+            levels.Add(k * 2 + 1, hi);
+        }
+    }
+    levels.Store();
+    Int16ToFloatLevelsScalar(src + i, dst + i, samples - i, lanes, i);
+}
+
+} // namespace
+
+const KernelTable* Sse2Kernels() {
+    static const KernelTable table = {
+        Interleave2Sse2,
+        Interleave4Sse2,
+        Deinterleave2Sse2,
+        Deinterleave4Sse2,
+        Quantize16Sse2,
+        Quantize32Sse2,
+        Int16ToFloatSse2,
+        ApplyGainSse2,
+        StereoToMonoSse2,
+        MixAddSse2,
+        Interleave2LevelsSse2,
+        CopyLevelsSse2,
+        Int16ToFloatLevelsSse2
+    };
+    return &table;
+}
+
+} // namespace internal
+} // namespace AudioKernels
+
+#else
+
+namespace AudioKernels {
+namespace internal {
+
+const KernelTable* Sse2Kernels() {
+    return nullptr;
+}
+
+} // namespace internal
+} // namespace AudioKernels
+
+#endif
@@ -0,0 +1,311 @@
+#include "audio_mixer.h"
+#include "audio_kernels.h"
+#include "logger.h"
+#include "modules/audio_processing/agc2/limiter.h"
+#include "modules/audio_processing/include/audio_frame_view.h"
+#include "modules/audio_processing/logging/apm_data_dumper.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// AGC2 限幅器按 int16 幅度工作
+constexpr float kFloatS16Scale = 32768.0f;
+
+// 内部包络限幅：目标峰值略低于满幅，释放时每个 10ms 帧向 1 靠近 5%（约 200ms）
+constexpr float kFallbackCeiling = 0.98f;
+constexpr float kFallbackRelease = 0.05f;
+
+// AGC2 限幅器要求 10ms 帧能均分为 20 个子帧且不超过 480 帧
+bool LimiterSupportsRate(int sampleRate) {
+    const int frameSize = sampleRate / 100;
+    return frameSize % 20 == 0 && frameSize <= 480;
+}
+
+} // namespace
+
+class AudioMixer::Impl {
+public:
+    explicit Impl(const Options& options)
+        : options(options)
+        , frameSize(static_cast<size_t>(options.sampleRate / 100))
+        , rampFrames(std::max<size_t>(static_cast<size_t>(options.sampleRate) * options.rampMilliseconds / 1000, 1))
+        , gains(new std::atomic<float>[options.inputChannels.size()])
+        , current(options.inputChannels.size(), 1.0f)
+        , target(options.inputChannels.size(), 1.0f)
+        , rampRemaining(options.inputChannels.size(), 0)
+        , pos(0)
+        , fallbackGain(1.0f)
+        , blocks(0)
+        , limitedBlocks(0)
+        , peak(0.0f)
+        , totalProcessNanos(0)
+        , maxProcessNanos(0) {
+        for (size_t i = 0; i < options.inputChannels.size(); ++i) {
+            gains[i].store(1.0f, std::memory_order_relaxed);
+        }
+
+        size_t maxInputChannels = 1;
+        for (size_t channels : options.inputChannels) {
+            maxInputChannels = std::max(maxInputChannels, channels);
+        }
+        accumulator.assign(options.channels, std::vector<float>(frameSize, 0.0f));
+        mixed.assign(options.channels, std::vector<float>(frameSize, 0.0f));
+        scratch.assign(maxInputChannels, std::vector<float>(frameSize, 0.0f));
+        for (size_t ch = 0; ch < options.channels; ++ch) {
+            accumulatorPtrs.push_back(accumulator[ch].data());
+            mixedPtrs.push_back(mixed[ch].data());
+        }
+        for (auto& channel : scratch) {
+            scratchPtrs.push_back(channel.data());
+        }
+
+        if (options.limiter && LimiterSupportsRate(options.sampleRate)) {
+            dumper.reset(new webrtc::ApmDataDumper(0));
+            limiter.reset(new webrtc::Limiter(static_cast<size_t>(options.sampleRate), dumper.get(), "AudioMixer"));
+        }
+    }
+
+    // 第 input 路的 count 帧按当前增益（必要时带斜坡）累加到 accumulator 的 pos 处
+    void Accumulate(size_t input, const float* interleaved, size_t count) {
+        const float want = gains[input].load(std::memory_order_relaxed);
+        if (want != target[input]) {
+            target[input] = want;
+            rampRemaining[input] = rampFrames;
+        }
+
+        const size_t inputChannels = options.inputChannels[input];
+        const float* const* planes = &interleaved;
+        if (inputChannels > 1) {
+            AudioKernels::Deinterleave(interleaved, scratchPtrs.data(), inputChannels, count);
+            planes = scratchPtrs.data();
+        }
+
+        size_t done = 0;
+        while (done < count) {
+            float gain = current[input];
+            float step = 0.0f;
+            size_t n = count - done;
+            if (rampRemaining[input] > 0) {
+                n = std::min(n, rampRemaining[input]);
+                step = (target[input] - gain) / static_cast<float>(rampRemaining[input]);
+            }
+            if (gain != 0.0f || step != 0.0f) {
+                for (size_t ch = 0; ch < options.channels; ++ch) {
+                    const float* src = planes[inputChannels > 1 ? ch % inputChannels : 0] + done;
+                    AudioKernels::MixAdd(src, accumulatorPtrs[ch] + pos + done, n, gain, step);
+                }
+            }
+            if (rampRemaining[input] > 0) {
+                rampRemaining[input] -= n;
+                current[input] = rampRemaining[input] == 0 ? target[input] : gain + step * static_cast<float>(n);
+            }
+            done += n;
+        }
+    }
+
+    // 一个完整的 10ms 求和结果：限幅后放入 mixed，accumulator 清零等待下一帧
+    void ProcessFrame() {
+        const auto start = std::chrono::steady_clock::now();
+
+        float framePeak = 0.0f;
+        for (size_t ch = 0; ch < options.channels; ++ch) {
+            for (size_t i = 0; i < frameSize; ++i) {
+                framePeak = std::max(framePeak, std::fabs(accumulator[ch][i]));
+            }
+        }
+        if (framePeak > 1.0f) {
+            limitedBlocks.store(limitedBlocks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        if (framePeak > peak.load(std::memory_order_relaxed)) {
+            peak.store(framePeak, std::memory_order_relaxed);
+        }
+
+        if (limiter) {
+            for (size_t ch = 0; ch < options.channels; ++ch) {
+                AudioKernels::ApplyGain(accumulatorPtrs[ch], accumulatorPtrs[ch], frameSize, kFloatS16Scale);
+            }
+            limiter->Process(webrtc::AudioFrameView<float>(accumulatorPtrs.data(), options.channels, frameSize));
+            for (size_t ch = 0; ch < options.channels; ++ch) {
+                AudioKernels::ApplyGain(accumulatorPtrs[ch], mixedPtrs[ch], frameSize, 1.0f / kFloatS16Scale);
+            }
+        } else if (options.limiter) {
+            FallbackLimit(framePeak);
+        } else {
+            for (size_t ch = 0; ch < options.channels; ++ch) {
+                memcpy(mixedPtrs[ch], accumulatorPtrs[ch], frameSize * sizeof(float));
+            }
+        }
+        for (auto& channel : accumulator) {
+            std::fill(channel.begin(), channel.end(), 0.0f);
+        }
+
+        const uint64_t elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        blocks.store(blocks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        totalProcessNanos.store(totalProcessNanos.load(std::memory_order_relaxed) + elapsed,
+                                std::memory_order_relaxed);
+        if (elapsed > maxProcessNanos.load(std::memory_order_relaxed)) {
+            maxProcessNanos.store(elapsed, std::memory_order_relaxed);
+        }
+    }
+
+    // 帧内从上一帧的增益线性过渡到本帧目标增益，起音不够快时由最后的硬削波兜底
+    void FallbackLimit(float framePeak) {
+        float want = framePeak > kFallbackCeiling ? kFallbackCeiling / framePeak : 1.0f;
+        if (want > fallbackGain) {
+            want = fallbackGain + (want - fallbackGain) * kFallbackRelease;
+        }
+        const float step = (want - fallbackGain) / static_cast<float>(frameSize);
+        for (size_t ch = 0; ch < options.channels; ++ch) {
+            std::fill(mixed[ch].begin(), mixed[ch].end(), 0.0f);
+            AudioKernels::MixAdd(accumulatorPtrs[ch], mixedPtrs[ch], frameSize, fallbackGain, step);
+            for (float& sample : mixed[ch]) {
+                sample = std::min(std::max(sample, -1.0f), 1.0f);
+            }
+        }
+        fallbackGain = want;
+    }
+
+    Options options;
+    size_t frameSize;
+    size_t rampFrames;
+
+    // 目标增益由任意线程写入；其余增益状态只在音频线程访问
+    std::unique_ptr<std::atomic<float>[]> gains;
+    std::vector<float> current;
+    std::vector<float> target;
+    std::vector<size_t> rampRemaining;
+
+    // 输入累加凑满 10ms 后限幅，输出读取上一帧的结果，因此固定延迟一帧
+    std::vector<std::vector<float>> accumulator;
+    std::vector<std::vector<float>> mixed;
+    std::vector<std::vector<float>> scratch;
+    std::vector<float*> accumulatorPtrs;
+    std::vector<float*> mixedPtrs;
+    std::vector<float*> scratchPtrs;
+    size_t pos;
+
+    std::unique_ptr<webrtc::ApmDataDumper> dumper;
+    std::unique_ptr<webrtc::Limiter> limiter;
+    float fallbackGain;
+
+    std::atomic<uint64_t> blocks;
+    std::atomic<uint64_t> limitedBlocks;
+    std::atomic<float> peak;
+    std::atomic<uint64_t> totalProcessNanos;
+    std::atomic<uint64_t> maxProcessNanos;
+};
+
+AudioMixer::Options::Options() = default;
+
+AudioMixer::AudioMixer()
+    : initialized_(false)
+    , frameSize_(0) {
+}
+
+AudioMixer::~AudioMixer() {
+    Release();
+}
+
+bool AudioMixer::Initialize(const Options& options) {
+    Release();
+
+    if (options.sampleRate < 8000 || options.sampleRate > 384000 || options.sampleRate % 100 != 0) {
+        Logger::error("混音器不支持的采样率: %d", options.sampleRate);
+        return false;
+    }
+    if (options.channels == 0 || options.channels > kMaxChannels || options.inputChannels.empty()) {
+        Logger::error("混音器声道配置无效: 输出 %zu 声道, %zu 路输入", options.channels,
+                      options.inputChannels.size());
+        return false;
+    }
+    for (size_t channels : options.inputChannels) {
+        if (channels == 0 || channels > kMaxChannels) {
+            Logger::error("混音器输入声道数无效: %zu", channels);
+            return false;
+        }
+    }
+
+    frameSize_ = static_cast<size_t>(options.sampleRate / 100);
+    impl_.reset(new Impl(options));
+    initialized_.store(true, std::memory_order_release);
+
+    const char* limiter = !options.limiter ? "关闭" : impl_->limiter ? "AGC2" : "包络限幅";
+    Logger::info("混音器已初始化: %d Hz/%zu 声道, %zu 路输入, 限幅器 %s",
+                 options.sampleRate, options.channels, options.inputChannels.size(), limiter);
+    return true;
+}
+
+void AudioMixer::Release() {
+    initialized_.store(false, std::memory_order_release);
+    impl_.reset();
+    frameSize_ = 0;
+}
+
+size_t AudioMixer::Inputs() const {
+    return IsInitialized() ? impl_->options.inputChannels.size() : 0;
+}
+
+void AudioMixer::SetGain(size_t input, float gain) {
+    if (!IsInitialized() || input >= Inputs()) {
+        return;
+    }
+    impl_->gains[input].store(std::max(gain, 0.0f), std::memory_order_relaxed);
+}
+
+float AudioMixer::GetGain(size_t input) const {
+    if (!IsInitialized() || input >= Inputs()) {
+        return 0.0f;
+    }
+    return impl_->gains[input].load(std::memory_order_relaxed);
+}
+
+void AudioMixer::Process(const float* const* inputs, float* output, size_t frames) {
+    if (!IsInitialized() || !inputs || !output) {
+        return;
+    }
+
+    Impl& impl = *impl_;
+    const size_t channels = impl.options.channels;
+    const size_t inputCount = impl.options.inputChannels.size();
+    const float* outPtrs[kMaxChannels];
+    size_t offset = 0;
+    while (offset < frames) {
+        const size_t count = std::min(frames - offset, frameSize_ - impl.pos);
+        for (size_t input = 0; input < inputCount; ++input) {
+            if (inputs[input]) {
+                impl.Accumulate(input, inputs[input] + offset * impl.options.inputChannels[input], count);
+            }
+        }
+        for (size_t ch = 0; ch < channels; ++ch) {
+            outPtrs[ch] = impl.mixedPtrs[ch] + impl.pos;
+        }
+        AudioKernels::Interleave(outPtrs, output + offset * channels, channels, count);
+        impl.pos += count;
+        offset += count;
+
+        if (impl.pos == frameSize_) {
+            impl.ProcessFrame();
+            impl.pos = 0;
+        }
+    }
+}
+
+AudioMixer::Stats AudioMixer::GetStats() const {
+    Stats stats = {};
+    if (!IsInitialized()) {
+        return stats;
+    }
+
+    const Impl& impl = *impl_;
+    stats.blocks = impl.blocks.load(std::memory_order_relaxed);
+    stats.limitedBlocks = impl.limitedBlocks.load(std::memory_order_relaxed);
+    stats.peak = impl.peak.load(std::memory_order_relaxed);
+    const uint64_t total = impl.totalProcessNanos.load(std::memory_order_relaxed);
+    stats.averageProcessNanos = stats.blocks ? total / stats.blocks : 0;
+    stats.maxProcessNanos = impl.maxProcessNanos.load(std::memory_order_relaxed);
+    return stats;
+}
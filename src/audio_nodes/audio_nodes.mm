@@ -1,5 +1,7 @@
 #import "audio_nodes.h"
 #include "logger.h"
+#include <memory>
+#include <vector>
 
 @implementation AECUnit {
     AudioBufferList *_inputBufferList;
@@ -10,6 +12,9 @@
     AUAudioUnitBusArray *_inputBusArray;
     AUAudioUnitBusArray *_outputBusArray;
     AudioConverterRef _converter;
+    AUAudioFrameCount _maxFrames;
+    std::unique_ptr<EchoCancellationStage> _echoStage;
+    std::vector<float*> _captureChannels;
 }
 
 - (instancetype)initWithComponentDescription:(AudioComponentDescription)componentDescription
@@ -19,6 +24,10 @@
         _inputBufferList = NULL;
         _outputBufferList = NULL;
         _converter = NULL;
+        _maxFrames = 0;
+        _echoStage.reset(new EchoCancellationStage());
+        _referenceSampleRate = 0;
+        _referenceChannelCount = 2;
         
         // 创建输入和输出总线，使用默认格式
         AVAudioFormat *defaultFormat = [[AVAudioFormat alloc] initStandardFormatWithSampleRate:44100 channels:1];
@@ -52,6 +61,16 @@
                 return kAudioUnitErr_FailedInitialization;
             }
             
+            // 超过预分配的最大帧数时拒绝渲染，不在渲染线程上分配内存
+            if (frameCount > strongSelf->_maxFrames) {
+                return kAudioUnitErr_TooManyFramesToProcess;
+            }
+            
+            // 上一次拉取可能改写过 mDataByteSize，每次渲染前复位
+            for (UInt32 channel = 0; channel < strongSelf->_inputBufferList->mNumberBuffers; ++channel) {
+                strongSelf->_inputBufferList->mBuffers[channel].mDataByteSize = frameCount * sizeof(float);
+            }
+            
             // 从输入总线获取音频数据
             AudioUnitRenderActionFlags pullFlags = 0;
             AUAudioUnitStatus status = pullInputBlock(&pullFlags, timestamp, frameCount, 0, strongSelf->_inputBufferList);
@@ -59,6 +78,9 @@
                 return status;
             }
             
+            // 以系统音频为远端参考，对麦克风数据原地做回声消除（未初始化时直接透传）
+            strongSelf->_echoStage->ProcessCapture(strongSelf->_captureChannels.data(), frameCount);
+            
             if (!strongSelf->_converter) {
                 for (UInt32 channel = 0; channel < outputData->mNumberBuffers; ++channel) {
                     memcpy(outputData->mBuffers[channel].mData,
@@ -90,6 +112,10 @@
     [bus setFormat:format error:nil];
 }
 
+- (EchoCancellationStage *)echoCancellationStage {
+    return _echoStage.get();
+}
+
 - (AUAudioUnitBusArray *)inputBusses {
     return _inputBusArray;
 }
@@ -156,10 +182,12 @@
     _inputBufferList->mNumberBuffers = inputFormat.channelCount;
     _outputBufferList->mNumberBuffers = outputFormat.channelCount;
 
-    // 为每个通道分配内存
+    // 按宿主协商的最大渲染帧数为每个通道分配内存
+    const AUAudioFrameCount maxFrames = self.maximumFramesToRender;
+    _maxFrames = maxFrames;
     for (UInt32 i = 0; i < _inputBufferList->mNumberBuffers; ++i) {
         _inputBufferList->mBuffers[i].mNumberChannels = 1;
-        _inputBufferList->mBuffers[i].mDataByteSize = 4096 * sizeof(float);
+        _inputBufferList->mBuffers[i].mDataByteSize = maxFrames * sizeof(float);
         _inputBufferList->mBuffers[i].mData = malloc(_inputBufferList->mBuffers[i].mDataByteSize);
         if (!_inputBufferList->mBuffers[i].mData) {
             if (outError) {
@@ -173,7 +201,7 @@
 
     for (UInt32 i = 0; i < _outputBufferList->mNumberBuffers; ++i) {
         _outputBufferList->mBuffers[i].mNumberChannels = 1;
-        _outputBufferList->mBuffers[i].mDataByteSize = 4096 * sizeof(float);
+        _outputBufferList->mBuffers[i].mDataByteSize = maxFrames * sizeof(float);
         _outputBufferList->mBuffers[i].mData = malloc(_outputBufferList->mBuffers[i].mDataByteSize);
         if (!_outputBufferList->mBuffers[i].mData) {
             if (outError) {
@@ -185,10 +213,28 @@
         }
     }
 
+    _captureChannels.clear();
+    for (UInt32 i = 0; i < _inputBufferList->mNumberBuffers; ++i) {
+        _captureChannels.push_back(static_cast<float*>(_inputBufferList->mBuffers[i].mData));
+    }
+
+    // 回声消除按麦克风格式工作；初始化失败时只透传，不影响录制
+    EchoCancellationStage::Options echoOptions;
+    echoOptions.sampleRate = (int)inputFormat.sampleRate;
+    echoOptions.renderSampleRate = (int)(_referenceSampleRate > 0 ? _referenceSampleRate : inputFormat.sampleRate);
+    echoOptions.renderChannels = _referenceChannelCount;
+    echoOptions.captureChannels = inputFormat.channelCount;
+    if (!_echoStage->Initialize(echoOptions)) {
+        Logger::error("回声消除初始化失败，AECUnit 将直接透传麦克风数据");
+    }
+
     return YES;
 }
 
 - (void)deallocateRenderResources {
+    _maxFrames = 0;
+    _echoStage->Release();
+    _captureChannels.clear();
     if (_converter) {
         AudioConverterDispose(_converter);
         _converter = NULL;
@@ -4,10 +4,10 @@
 #import <CoreAudio/CATapDescription.h>
 #import <Foundation/Foundation.h>
 #include <vector>
-#include <mutex>
-#include <condition_variable>
 #include "audio_device_manager.h"
+#include "core_audio_timestamp.h"
 #include "logger.h"
+#include "ring_buffer.h"
 
 constexpr AudioObjectPropertyAddress PropertyAddress(AudioObjectPropertySelector selector,
                                                      AudioObjectPropertyScope scope = kAudioObjectPropertyScopeGlobal,
@@ -20,126 +20,20 @@ enum class StreamDirection : UInt32 {
     input
 };
 
-class RingBuffer {
-public:
-    RingBuffer(size_t size) 
-        : buffer_(size)
-        , read_pos_(0)
-        , write_pos_(0)
-        , size_(size)
-        , overflow_count_(0)
-        , underflow_count_(0)
-        , max_used_size_(0) {
-    }
-    
-    bool write(const float* data, size_t count) {
-        std::unique_lock<std::mutex> lock(mutex_);
-        
-        // 如果缓冲区已满，直接返回 false
-        if (available_write() < count) {
-            overflow_count_++;
-            if (overflow_count_ % 100 == 0) {
-            }
-            return false;
-        }
-        
-        // 写入数据
-        for (size_t i = 0; i < count; ++i) {
-            buffer_[write_pos_] = data[i];
-            write_pos_ = (write_pos_ + 1) % size_;
-        }
-        
-        // 更新最大使用量
-        size_t used_size = available_read();
-        if (used_size > max_used_size_) {
-            max_used_size_ = used_size;
-        }
-        
-        cv_.notify_one();
-        return true;
-    }
-    
-    bool read(float* data, size_t count) {
-        std::unique_lock<std::mutex> lock(mutex_);
-        
-        // 如果数据不足，等待一段时间
-        if (available_read() < count) {
-            if (cv_.wait_for(lock, std::chrono::milliseconds(10), 
-                           [this, count] { return available_read() >= count; })) {
-                // 超时后仍然没有足够的数据，返回 false
-                underflow_count_++;
-                if (underflow_count_ % 100 == 0) {
-                }
-                return false;
-            }
-        }
-        
-        // 读取数据
-        for (size_t i = 0; i < count; ++i) {
-            data[i] = buffer_[read_pos_];
-            read_pos_ = (read_pos_ + 1) % size_;
-        }
-        return true;
-    }
-    
-    size_t available_read() const {
-        if (write_pos_ >= read_pos_) {
-            return write_pos_ - read_pos_;
-        }
-        return size_ - read_pos_ + write_pos_;
-    }
-    
-    size_t available_write() const {
-        return size_ - available_read() - 1;
-    }
-    
-    // 获取统计信息
-    struct Stats {
-        size_t overflow_count;
-        size_t underflow_count;
-        size_t max_used_size;
-        size_t current_size;
-    };
-    
-    Stats get_stats() const {
-        std::unique_lock<std::mutex> lock(mutex_);
-        return {
-            overflow_count_,
-            underflow_count_,
-            max_used_size_,
-            size_
-        };
-    }
-    
-    void clear() {
-        std::unique_lock<std::mutex> lock(mutex_);
-        read_pos_ = 0;
-        write_pos_ = 0;
-        overflow_count_ = 0;
-        underflow_count_ = 0;
-        max_used_size_ = 0;
-    }
-    
-private:
-    std::vector<float> buffer_;
-    size_t read_pos_;
-    size_t write_pos_;
-    size_t size_;
-    mutable std::mutex mutex_;
-    std::condition_variable cv_;
-    
-    // 统计信息
-    size_t overflow_count_;    // 溢出次数
-    size_t underflow_count_;   // 欠载次数
-    size_t max_used_size_;     // 最大使用量
-};
-
 class AudioSystemCapture::Impl {
 public:
-    Impl() : ring_buffer_(352800) {} // 8秒的缓冲区
+    Impl() : ring_options_(CaptureRing::Options::FromEnvironment()) {}
     
-    RingBuffer ring_buffer_;
+    // 第一次 StartIO() 时按设备格式分配，之后设备切换时保留，声道数不符的数据不写入
+    CaptureRing ring_buffer_;
+    CaptureRing::Options ring_options_;
     AudioDeviceManager device_manager_;
+
+    // IOProc 是以下指标唯一的写线程
+    PipelineMetrics* metrics_ = nullptr;
+    PipelineMetrics::CallbackTimer timer_;
+    PipelineMetrics::Gauge* ring_fill_ = nullptr;
+    PipelineMetrics::Gauge* ring_dropped_ = nullptr;
 };
 
 AudioSystemCapture::AudioSystemCapture() 
@@ -164,7 +58,7 @@ void AudioSystemCapture::SetDeviceID(AudioObjectID deviceID) {
     AdaptToDevice(deviceID);
 }
 
-void AudioSystemCapture::SetAudioDataCallback(std::function<void(const AudioBufferList*, UInt32)> callback) {
+void AudioSystemCapture::SetAudioDataCallback(AudioDataCallback callback) {
     audioDataCallback_ = std::move(callback);
 }
 
@@ -294,6 +188,34 @@ void AudioSystemCapture::CatalogDeviceStreams() {
 }
 
 bool AudioSystemCapture::StartIO() {
+    if (!impl_->ring_buffer_.IsConfigured()) {
+        AudioStreamBasicDescription format;
+        if (!GetAudioFormat(format) ||
+            !impl_->ring_buffer_.Configure(impl_->ring_options_, static_cast<int>(format.mSampleRate),
+                                           format.mChannelsPerFrame)) {
+            Logger::error("无法按设备格式分配环形缓冲区");
+            return false;
+        }
+    }
+
+    if (impl_->metrics_) {
+        // 标称周期 = IO 缓冲帧数 / 采样率，查询失败时不统计抖动
+        const AudioObjectPropertyAddress bufferAddress = PropertyAddress(kAudioDevicePropertyBufferFrameSize);
+        const AudioObjectPropertyAddress rateAddress = PropertyAddress(kAudioDevicePropertyNominalSampleRate);
+        UInt32 bufferFrames = 0;
+        UInt32 bufferSize = sizeof(bufferFrames);
+        Float64 sampleRate = 0.0;
+        UInt32 rateSize = sizeof(sampleRate);
+        uint64_t periodNanoseconds = 0;
+        if (AudioObjectGetPropertyData(deviceID_, &bufferAddress, 0, nullptr, &bufferSize, &bufferFrames) == noErr &&
+            AudioObjectGetPropertyData(deviceID_, &rateAddress, 0, nullptr, &rateSize, &sampleRate) == noErr &&
+            sampleRate > 0.0) {
+            periodNanoseconds = static_cast<uint64_t>(bufferFrames * 1e9 / sampleRate);
+        }
+        impl_->timer_.Attach(&impl_->metrics_->GetHistogram("callback.system_ns"),
+                             &impl_->metrics_->GetHistogram("callback.system_jitter_ns"), periodNanoseconds);
+    }
+
     AudioDeviceIOProcID ioProcID = nullptr;
     auto error = AudioDeviceCreateIOProcID(deviceID_, IOProc, this, &ioProcID);
     if (error != kAudioHardwareNoError) {
@@ -380,6 +302,8 @@ OSStatus AudioSystemCapture::IOProc(
     const AudioTimeStamp* inOutputTime,
     void* inClientData) {
     auto* capture = static_cast<AudioSystemCapture*>(inClientData);
+    Impl* impl = capture->impl_.get();
+    const uint64_t callbackStart = impl->timer_.Begin();
     
     if (inInputData != nullptr && inInputData->mNumberBuffers > 0) {
         const AudioBuffer& inputBuffer = inInputData->mBuffers[0];
@@ -399,37 +323,57 @@ OSStatus AudioSystemCapture::IOProc(
         
         // 将音频数据写入环形缓冲区
         float* audioData = static_cast<float*>(inputBuffer.mData);
-        size_t sampleCount = numberFrames * inputBuffer.mNumberChannels;
-        
-        // 写入数据
-        if (!capture->impl_->ring_buffer_.write(audioData, sampleCount)) {
-            // 写入失败，可能是缓冲区已满，等待一段时间后重试
-            usleep(1000); // 1ms
-            if (!capture->impl_->ring_buffer_.write(audioData, sampleCount)) {
-                Logger::warn("写入环形缓冲区失败，丢弃数据");
-            }
+        // 写入数据，缓冲区满时覆盖最旧的数据，不在 IO 线程上等待；指标换算为样本数
+        if (inputBuffer.mNumberChannels == impl->ring_buffer_.Channels()) {
+            impl->ring_buffer_.Write(audioData, numberFrames);
+        }
+        if (impl->ring_fill_) {
+            const size_t channels = impl->ring_buffer_.Channels();
+            impl->ring_fill_->Set(impl->ring_buffer_.AvailableFrames() * channels);
+            impl->ring_dropped_->Set(impl->ring_buffer_.GetStats().dropped_samples * channels);
         }
         
-        // 如果设置了回调函数，则调用
+        // 如果设置了回调函数，则调用；inInputTime 是这块输入数据第一帧的采集时刻
         if (capture->audioDataCallback_) {
-            capture->audioDataCallback_(inInputData, numberFrames);
+            capture->audioDataCallback_(inInputData, numberFrames, ToCaptureTimestamp(inInputTime));
         }
     }
     
+    impl->timer_.End(callbackStart);
     return kAudioHardwareNoError;
 }
 
 // 添加新方法用于从环形缓冲区读取数据
 bool AudioSystemCapture::ReadAudioData(float* buffer, size_t count) {
-    return impl_->ring_buffer_.read(buffer, count);
+    const size_t channels = impl_->ring_buffer_.Channels();
+    if (channels == 0 || count % channels != 0) {
+        return false;
+    }
+    return impl_->ring_buffer_.Read(buffer, count / channels);
 }
 
 void AudioSystemCapture::ClearRingBuffer() {
-    impl_->ring_buffer_.clear();
+    impl_->ring_buffer_.Clear();
+}
+
+RingBufferBase::Stats AudioSystemCapture::GetRingBufferStats() const {
+    return impl_->ring_buffer_.GetStats();
+}
+
+void AudioSystemCapture::SetRingOptions(const CaptureRing::Options& options) {
+    impl_->ring_options_ = options;
+}
+
+void AudioSystemCapture::SetMetrics(PipelineMetrics* metrics) {
+    impl_->metrics_ = metrics;
+    impl_->timer_.Attach(nullptr, nullptr, 0);
+    impl_->ring_fill_ = metrics ? &metrics->GetGauge("fill.system_ring_samples") : nullptr;
+    impl_->ring_dropped_ = metrics ? &metrics->GetGauge("dropped.system_ring_samples") : nullptr;
 }
 
 bool AudioSystemCapture::CreateTapDevice() {
-    // 查找并删除指定名称的设备
+    // 查找并删除指定名称的设备；会打断本进程内其他正在使用该设备的实例，
+    // 多个消费者应通过 SystemTapBackend::SharedEngine() 共享一个设备
     auto devicesToRemove = impl_->device_manager_.GetAggregateDevicesByName("plaud.ai Aggregate Audio Device");
     for (const auto& deviceID : devicesToRemove) {
         auto taps = impl_->device_manager_.GetDeviceTaps(deviceID);
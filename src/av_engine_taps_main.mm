@@ -3,6 +3,15 @@
 #include "audio_device_manager.h"
 #include "audio_system_capture.h"
 #include "audio_nodes/audio_nodes.h"
+#include "audio_kernels.h"
+#include "capture_trace.h"
+#include "core_audio_timestamp.h"
+#include "drift_compensating_resampler.h"
+#include "level_meter.h"
+#include "pipeline_metrics.h"
+#include "scratch_buffer.h"
+#include "stream_aligner.h"
+#include "streaming_wav_writer.h"
 #import <CoreAudio/CoreAudio.h>
 #import <CoreAudio/CoreAudioTypes.h>
 #import <CoreAudio/AudioHardware.h>
@@ -13,28 +22,61 @@
 #import <AVFoundation/AVFoundation.h>
 #import <AVFAudio/AVAudioSinkNode.h>
 #include <CoreFoundation/CoreFoundation.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
 #include <vector>
 #include <string>
 
-// 全局变量
-ExtAudioFileRef audioFile = nullptr;
-ExtAudioFileRef micAudioFile = nullptr;
-ExtAudioFileRef sourceAudioFile = nullptr;  // 新增 source 音频文件
-ExtAudioFileRef mixAudioFile = nullptr;     // 新增混合音频文件
-AudioStreamBasicDescription outputFormat;
+// 全局变量，写盘都在各自的后台线程完成
+StreamingWavWriter mixWriter;      // 混合音频文件
+StreamingWavWriter micWriter;      // 麦克风音频文件
+StreamingWavWriter sourceWriter;   // source 音频文件
 AudioSystemCapture* systemCapture = nullptr;
+DriftCompensatingResampler systemResampler;  // 系统音频按麦克风时钟重采样
+PipelineMetrics pipelineMetrics;             // IOProc 回调耗时、抖动和环形缓冲水位
+StreamAligner streamAligner;                 // 麦克风 tap 和系统音频按时间戳对齐到同一时间线
+std::atomic<bool> streamAlignerReady(false); // 确定麦克风格式之前系统音频回调直接丢弃数据
+enum AlignStream : size_t { kAlignMicrophone = 0, kAlignSystem = 1 };
+LevelMeter micLevels;                        // 麦克风 tap 交织时顺带统计的电平
+CaptureTraceWriter captureTrace;             // RECORDER_TRACE 设置时记录两路送入对齐器的每一块，见 recorder_replay
+int traceSystem = -1;
+int traceMicrophone = -1;
+double traceMicSampleRate = 0.0;             // 轨迹中麦克风的当前格式，只在 tap 线程访问
+AVAudioChannelCount traceMicChannels = 0;
 UInt64 totalFramesWritten = 0;  // 添加全局计数器
 
-void AudioDataCallback(const AudioBufferList* inInputData, UInt32 inNumberFrames) {
-    if (!audioFile) {
-        return;
+// 各回调使用的预分配临时缓冲区，只在非实时线程上扩容
+static ScratchBuffer micInterleaveScratch;     // 麦克风 tap 交织
+static ScratchBuffer sinkInterleaveScratch;    // sinkNode 交织
+static ScratchBuffer sourceReadScratch;        // sourceNode 从漂移补偿重采样器读取
+static ScratchBuffer sourceInterleaveScratch;  // sourceNode tap 交织
+
+// tap 回调的帧数不受 bufferSize 严格约束，按 200ms 预留
+static AVAudioFrameCount MaxTapFrames(double sampleRate) {
+    return std::max<AVAudioFrameCount>(4096, (AVAudioFrameCount)(sampleRate * 0.2));
+}
+
+// 按协商好的格式和引擎最大渲染帧数预留临时缓冲区
+static void ReserveScratchBuffers(AVAudioEngine* engine, AVAudioFormat* micFormat, AVAudioFormat* sourceFormat) {
+    AVAudioFrameCount maxRenderFrames = std::max<AVAudioFrameCount>(4096, engine.outputNode.AUAudioUnit.maximumFramesToRender);
+    micInterleaveScratch.Reserve((size_t)MaxTapFrames(micFormat.sampleRate) * micFormat.channelCount);
+    sinkInterleaveScratch.Reserve((size_t)maxRenderFrames * 2);
+    sourceReadScratch.Reserve((size_t)maxRenderFrames * sourceFormat.channelCount);
+    sourceInterleaveScratch.Reserve((size_t)MaxTapFrames(sourceFormat.sampleRate) * sourceFormat.channelCount);
+}
+
+// 非交织 AudioBufferList（每个 buffer 一个声道）转交织，声道数超过 8 时返回 false
+static bool InterleaveBufferList(const AudioBufferList* list, UInt32 frames, float* out) {
+    const float* planes[8];
+    if (list->mNumberBuffers > 8) {
+        return false;
     }
-    
-    // 直接写入音频数据
-    OSStatus status = ExtAudioFileWrite(audioFile, inNumberFrames, inInputData);
-    if (status != noErr) {
-        Logger::error("写入音频数据失败: %d", (int)status);
+    for (UInt32 channel = 0; channel < list->mNumberBuffers; ++channel) {
+        planes[channel] = static_cast<const float*>(list->mBuffers[channel].mData);
     }
+    AudioKernels::Interleave(planes, out, list->mNumberBuffers, frames);
+    return true;
 }
 
 void TestAudioEngine() {
@@ -63,7 +105,17 @@ void TestAudioEngine() {
             return;
         }
 
+        // 系统音频按时间戳对齐后送入漂移补偿重采样器；确定会话采样率之前直接丢弃
+        systemCapture->SetAudioDataCallback([](const AudioBufferList* data, UInt32 frames, const CaptureTimestamp& timestamp) {
+            const AudioBuffer& buffer = data->mBuffers[0];
+            if (buffer.mNumberChannels == 2 && streamAlignerReady.load(std::memory_order_acquire)) {
+                captureTrace.Record(traceSystem, static_cast<const float*>(buffer.mData), frames, timestamp);
+                streamAligner.Push(kAlignSystem, static_cast<const float*>(buffer.mData), frames, timestamp);
+            }
+        });
+
         // 启动系统音频捕获以获取格式信息
+        systemCapture->SetMetrics(&pipelineMetrics);
         if (!systemCapture->StartRecording()) {
             Logger::error("启动系统音频捕获失败");
             delete systemCapture;
@@ -157,40 +209,104 @@ void TestAudioEngine() {
         
         AVAudioFormat* micFormat = [inputNode inputFormatForBus:0];
         Logger::info("麦克风格式 - 采样率: %f, 声道数: %d", micFormat.sampleRate, micFormat.channelCount);
+
+        // 系统音频与麦克风时钟不同，统一重采样到麦克风采样率并持续补偿两者的漂移
+        DriftCompensatingResampler::Options resamplerOptions;
+        resamplerOptions.inputRate = (int)asbd.mSampleRate;
+        resamplerOptions.outputRate = (int)micFormat.sampleRate;
+        resamplerOptions.channels = 2;
+        if (!systemResampler.Initialize(resamplerOptions)) {
+            systemCapture->StopRecording();
+            delete systemCapture;
+            systemCapture = nullptr;
+            return;
+        }
+        AVAudioFormat* sessionSourceFormat = [[AVAudioFormat alloc] initStandardFormatWithSampleRate:micFormat.sampleRate channels:2];
+
+        // 两路的起始偏差和丢失的 IO 周期按时间戳补静音或裁剪，麦克风对齐后写盘，系统音频对齐后进入重采样器
+        std::vector<StreamAligner::StreamOptions> alignStreams(2);
+        alignStreams[kAlignMicrophone].name = "microphone";
+        alignStreams[kAlignMicrophone].sampleRate = (int)micFormat.sampleRate;
+        alignStreams[kAlignMicrophone].channels = micFormat.channelCount;
+        alignStreams[kAlignMicrophone].output = [](const float* data, size_t frames) {
+            micWriter.Write(data, frames);
+        };
+        alignStreams[kAlignSystem].name = "system";
+        alignStreams[kAlignSystem].sampleRate = (int)asbd.mSampleRate;
+        alignStreams[kAlignSystem].channels = 2;
+        alignStreams[kAlignSystem].output = [](const float* data, size_t frames) {
+            systemResampler.Push(data, frames);
+        };
+        StreamAligner::Options alignOptions;
+        alignOptions.metrics = &pipelineMetrics;
+        if (!streamAligner.Initialize(alignOptions, alignStreams)) {
+            systemCapture->StopRecording();
+            delete systemCapture;
+            systemCapture = nullptr;
+            return;
+        }
+        // RECORDER_TRACE=路径 时把两路送入对齐器的每一块写入采集轨迹，流名与 HeadlessRecorder 一致
+        if (const char* tracePath = getenv("RECORDER_TRACE")) {
+            if (captureTrace.Open(tracePath)) {
+                traceSystem = captureTrace.AddStream("system", (int)asbd.mSampleRate, 2);
+                traceMicrophone = captureTrace.AddStream("microphone", (int)micFormat.sampleRate, micFormat.channelCount);
+                traceMicSampleRate = micFormat.sampleRate;
+                traceMicChannels = micFormat.channelCount;
+                captureTrace.Event(-1, "start");
+            }
+        }
+        streamAlignerReady.store(true, std::memory_order_release);
+        micLevels.Configure((int)micFormat.sampleRate, micFormat.channelCount);
         
         
         void (^tapBlock)(AVAudioPCMBuffer * _Nonnull, AVAudioTime * _Nonnull) = ^(AVAudioPCMBuffer * _Nonnull buffer, AVAudioTime * _Nonnull when) {
-            if (micAudioFile) {
+            if (micWriter.IsOpen()) {
                 // Logger::info("收到麦克风数据: %d 帧", (int)buffer.frameLength);
-                // 创建临时缓冲区用于格式转换
-                AudioBufferList interleavedBufferList;
-                interleavedBufferList.mNumberBuffers = 1;
-                interleavedBufferList.mBuffers[0].mNumberChannels = buffer.format.channelCount;
-                interleavedBufferList.mBuffers[0].mDataByteSize = buffer.frameLength * sizeof(float) * buffer.format.channelCount;
-                interleavedBufferList.mBuffers[0].mData = malloc(interleavedBufferList.mBuffers[0].mDataByteSize);
-
-                float* interleavedData = (float*)interleavedBufferList.mBuffers[0].mData;
-                for (UInt32 frame = 0; frame < buffer.frameLength; ++frame) {
-                    for (UInt32 channel = 0; channel < buffer.format.channelCount; ++channel) {
-                        float* channelData = (float*)buffer.audioBufferList->mBuffers[channel].mData;
-                        interleavedData[frame * buffer.format.channelCount + channel] = channelData[frame];
-                    }
+                // 使用预分配的缓冲区做格式转换
+                float* interleavedData = micInterleaveScratch.Data(buffer.frameLength * buffer.format.channelCount);
+                if (!interleavedData) {
+                    return;
                 }
 
-                OSStatus status = ExtAudioFileWrite(micAudioFile, buffer.frameLength, &interleavedBufferList);
-                if (status != noErr) {
-                    Logger::error("写入麦克风音频数据失败: %d", (int)status);
+                AudioKernels::LevelStats levels;
+                AudioKernels::InterleaveWithLevels(buffer.floatChannelData, interleavedData,
+                                                   buffer.format.channelCount, buffer.frameLength, &levels);
+                micLevels.Publish(levels);
+                AudioTimeStamp time = when.audioTimeStamp;
+                const CaptureTimestamp timestamp = ToCaptureTimestamp(&time);
+                if (buffer.format.sampleRate != traceMicSampleRate || buffer.format.channelCount != traceMicChannels) {
+                    captureTrace.SetFormat(traceMicrophone, (int)buffer.format.sampleRate, buffer.format.channelCount);
+                    traceMicSampleRate = buffer.format.sampleRate;
+                    traceMicChannels = buffer.format.channelCount;
                 }
-
-                free(interleavedBufferList.mBuffers[0].mData);
+                captureTrace.Record(traceMicrophone, interleavedData, buffer.frameLength, timestamp);
+                streamAligner.Push(kAlignMicrophone, interleavedData, buffer.frameLength, timestamp);
             }
         };
         
         [inputNode installTapOnBus:0 bufferSize:1024 format: micFormat block:tapBlock];
         Logger::info("Tap 已安装到 inputNode");
 
-        // 创建源节点 sourceNode（使用扬声器格式）
-        AVAudioSourceNode* sourceNode = [[AVAudioSourceNode alloc] initWithFormat:standardFormat renderBlock:^OSStatus(BOOL* isSilence, const AudioTimeStamp* timestamp, AVAudioFrameCount frameCount, AudioBufferList* outputData) {
+        AECAudioNode *aecAudioNode = [[AECAudioNode alloc] init];
+        if (![aecAudioNode initializeWithError:&error]) {
+            Logger::error("初始化 AECAudioNode 失败: %s", error.localizedDescription.UTF8String);
+            systemCapture->StopRecording();
+            delete systemCapture;
+            systemCapture = nullptr;
+            return;
+        }
+
+         // 获取 AVAudioUnit
+        AVAudioUnit *aec_audio_unit = aecAudioNode.audioUnit;
+
+        // 系统音频作为回声消除的远端参考，格式在引擎分配渲染资源前确定
+        AECUnit *aecUnit = (AECUnit *)aec_audio_unit.AUAudioUnit;
+        aecUnit.referenceSampleRate = sessionSourceFormat.sampleRate;
+        aecUnit.referenceChannelCount = 2;  // sourceNode 按双声道交织读取系统音频
+        EchoCancellationStage* echoStage = aecUnit.echoCancellationStage;
+
+        // 创建源节点 sourceNode（系统音频声道、会话采样率）
+        AVAudioSourceNode* sourceNode = [[AVAudioSourceNode alloc] initWithFormat:sessionSourceFormat renderBlock:^OSStatus(BOOL* isSilence, const AudioTimeStamp* timestamp, AVAudioFrameCount frameCount, AudioBufferList* outputData) {
             if (!systemCapture) {
                 for (UInt32 i = 0; i < outputData->mNumberBuffers; ++i) {
                     memset(outputData->mBuffers[i].mData, 0, frameCount * sizeof(float));
@@ -201,21 +317,31 @@ void TestAudioEngine() {
 
             // 检查输出缓冲区
             if (!outputData || outputData->mNumberBuffers == 0) {
-                Logger::error("输出缓冲区无效");
+                // 渲染线程上每个周期都可能走到这里，限流到每秒一条
+                static Logger::RateLimiter limiter(1);
+                uint64_t suppressed = 0;
+                if (limiter.Allow(&suppressed)) {
+                    Logger::error("输出缓冲区无效（此前 %llu 条相同错误被抑制）",
+                                  static_cast<unsigned long long>(suppressed));
+                }
                 return kAudio_ParamError;
             }
 
-            // 创建临时缓冲区用于读取数据
-            float* tempBuffer = new float[frameCount * 2];  // 双通道
-            bool success = systemCapture->ReadAudioData(tempBuffer, frameCount * 2);
-            
-            if (success) {
+            // 使用预分配的缓冲区读取数据，水位达到目标前重采样器输出静音
+            float* tempBuffer = sourceReadScratch.Data(frameCount * 2);  // 双通道
+
+            if (tempBuffer) {
+                systemResampler.Pull(tempBuffer, frameCount);
                 *isSilence = NO;
-                for (UInt32 i = 0; i < outputData->mNumberBuffers; ++i) {
-                    float* channelData = static_cast<float*>(outputData->mBuffers[i].mData);
-                    for (UInt32 frame = 0; frame < frameCount; ++frame) {
-                        channelData[frame] = tempBuffer[frame * 2 + i];
-                    }
+                echoStage->AnalyzeRender(tempBuffer, frameCount);
+                if (outputData->mNumberBuffers >= 2) {
+                    float* planes[2] = {
+                        static_cast<float*>(outputData->mBuffers[0].mData),
+                        static_cast<float*>(outputData->mBuffers[1].mData)
+                    };
+                    AudioKernels::Deinterleave(tempBuffer, planes, 2, frameCount);
+                } else {
+                    AudioKernels::StereoToMono(tempBuffer, static_cast<float*>(outputData->mBuffers[0].mData), frameCount);
                 }
             } else {
                 for (UInt32 i = 0; i < outputData->mNumberBuffers; ++i) {
@@ -224,48 +350,23 @@ void TestAudioEngine() {
                 *isSilence = YES;
             }
             
-            delete[] tempBuffer;
             return noErr;
         }];
 
-        AECAudioNode *aecAudioNode = [[AECAudioNode alloc] init];
-        if (![aecAudioNode initializeWithError:&error]) {
-            Logger::error("初始化 AECAudioNode 失败: %s", error.localizedDescription.UTF8String);
-            systemCapture->StopRecording();
-            delete systemCapture;
-            systemCapture = nullptr;
-            return;
-        }
-
-         // 获取 AVAudioUnit
-        AVAudioUnit *aec_audio_unit = aecAudioNode.audioUnit;
-
         // 创建 sinkNode
         AVAudioSinkNode* sinkNode = [[AVAudioSinkNode alloc] initWithReceiverBlock:^OSStatus(const AudioTimeStamp* timestamp,
                                                                                    AVAudioFrameCount frameCount,
                                                                                    const AudioBufferList* outputData) {
-            // 这里写入音频文件
-            if (audioFile) {
-                AudioBufferList interleavedBufferList;
-                interleavedBufferList.mNumberBuffers = 1;
-                interleavedBufferList.mBuffers[0].mNumberChannels = outputData->mNumberBuffers;
-                interleavedBufferList.mBuffers[0].mDataByteSize = frameCount * sizeof(float) * outputData->mNumberBuffers;
-                interleavedBufferList.mBuffers[0].mData = malloc(interleavedBufferList.mBuffers[0].mDataByteSize);
-
-                float* interleavedData = (float*)interleavedBufferList.mBuffers[0].mData;
-                for (UInt32 frame = 0; frame < frameCount; ++frame) {
-                    for (UInt32 channel = 0; channel < outputData->mNumberBuffers; ++channel) {
-                        float* channelData = (float*)outputData->mBuffers[channel].mData;
-                        interleavedData[frame * outputData->mNumberBuffers + channel] = channelData[frame];
-                    }
+            // 这里交给写线程写入音频文件
+            if (mixWriter.IsOpen()) {
+                float* interleavedData = sinkInterleaveScratch.Data(frameCount * outputData->mNumberBuffers);
+                if (!interleavedData) {
+                    return noErr;
                 }
-                
-                OSStatus status = ExtAudioFileWrite(audioFile, frameCount, &interleavedBufferList);
-                if (status != noErr) {
-                    Logger::error("写入音频数据失败: %d", (int)status);
+
+                if (InterleaveBufferList(outputData, frameCount, interleavedData)) {
+                    mixWriter.Write(interleavedData, frameCount);
                 }
-                
-                free(interleavedBufferList.mBuffers[0].mData);
             }
             return noErr;
         }];
@@ -280,7 +381,7 @@ void TestAudioEngine() {
         // 2. 连接节点
         error = nil;
         
-        [audioEngine connect:sourceNode to:mixerNode format:standardFormat];
+        [audioEngine connect:sourceNode to:mixerNode format:sessionSourceFormat];
         
         // 先连接 inputNode 到 aec_audio_unit，使用标准格式
         [audioEngine connect:inputNode to:aec_audio_unit format:micFormat];
@@ -299,182 +400,36 @@ void TestAudioEngine() {
         sourceNode.volume = 0.5;
         mixerNode.outputVolume = 1.0;
 
-        // 4. 创建输出文件
+        // 4. 创建输出文件，编码、分段和静音省略取自环境变量（见 StreamingWavWriter::Options::FromEnvironment）
+        const StreamingWavWriter::Options envOptions = StreamingWavWriter::Options::FromEnvironment();
+        NSString* extension = [NSString stringWithUTF8String:AudioEncoder::Extension(envOptions.codec)];
         NSString* currentDir = [[NSFileManager defaultManager] currentDirectoryPath];
-        // NSString* sourceOutputPath = [currentDir stringByAppendingPathComponent:@"source_audio.wav"];
-        NSString* micOutputPath = [currentDir stringByAppendingPathComponent:@"mic_audio.wav"];
-        NSString* pureSourcePath = [currentDir stringByAppendingPathComponent:@"pure_source.wav"];
-        NSString* mixOutputPath = [currentDir stringByAppendingPathComponent:@"mix_audio.wav"];
-        
-        // NSURL* sourceOutputURL = [NSURL fileURLWithPath:sourceOutputPath];
-        NSURL* micOutputURL = [NSURL fileURLWithPath:micOutputPath];
-        NSURL* pureSourceURL = [NSURL fileURLWithPath:pureSourcePath];
-        NSURL* mixOutputURL = [NSURL fileURLWithPath:mixOutputPath];
-
-        AudioStreamBasicDescription fileFormat;
-        memset(&fileFormat, 0, sizeof(fileFormat));
-        fileFormat.mSampleRate = standardFormat.sampleRate;
-        fileFormat.mFormatID = kAudioFormatLinearPCM;
-        fileFormat.mFormatFlags = kAudioFormatFlagIsFloat | kAudioFormatFlagIsPacked;
-        fileFormat.mBitsPerChannel = 32;
-        fileFormat.mChannelsPerFrame = standardFormat.channelCount;
-        fileFormat.mFramesPerPacket = 1;
-        fileFormat.mBytesPerFrame = fileFormat.mChannelsPerFrame * (fileFormat.mBitsPerChannel / 8);
-        fileFormat.mBytesPerPacket = fileFormat.mBytesPerFrame;
-
-        // 创建源音频文件
-        OSStatus status = ExtAudioFileCreateWithURL((__bridge CFURLRef)mixOutputURL,
-                                                  kAudioFileWAVEType,
-                                                  &fileFormat,
-                                                  NULL,
-                                                  kAudioFileFlags_EraseFile,
-                                                  &audioFile);
-        if (status != noErr) {
-            Logger::error("创建源音频文件失败: %d", (int)status);
-            systemCapture->StopRecording();
-            delete systemCapture;
-            systemCapture = nullptr;
-            return;
-        }
-
-        // 创建麦克风音频文件
-        AudioStreamBasicDescription micFileFormat;
-        memset(&micFileFormat, 0, sizeof(micFileFormat));
-        micFileFormat.mSampleRate = micFormat.sampleRate;
-        micFileFormat.mFormatID = kAudioFormatLinearPCM;
-        micFileFormat.mFormatFlags = kAudioFormatFlagIsFloat | kAudioFormatFlagIsPacked;
-        micFileFormat.mBitsPerChannel = 32;
-        micFileFormat.mChannelsPerFrame = micFormat.channelCount;
-        micFileFormat.mFramesPerPacket = 1;
-        micFileFormat.mBytesPerFrame = micFileFormat.mChannelsPerFrame * (micFileFormat.mBitsPerChannel / 8);
-        micFileFormat.mBytesPerPacket = micFileFormat.mBytesPerFrame;
-
-        status = ExtAudioFileCreateWithURL((__bridge CFURLRef)micOutputURL,
-                                         kAudioFileWAVEType,
-                                         &micFileFormat,
-                                         NULL,
-                                         kAudioFileFlags_EraseFile,
-                                         &micAudioFile);
-        if (status != noErr) {
-            Logger::error("创建麦克风音频文件失败: %d", (int)status);
-            ExtAudioFileDispose(audioFile);
-            audioFile = nullptr;
-            systemCapture->StopRecording();
-            delete systemCapture;
-            systemCapture = nullptr;
-            return;
-        }
-
-        status = ExtAudioFileSetProperty(micAudioFile,
-                                       kExtAudioFileProperty_ClientDataFormat,
-                                       sizeof(micFileFormat),
-                                       &micFileFormat);
-        if (status != noErr) {
-            Logger::error("设置麦克风音频文件客户端格式失败: %d", (int)status);
-            ExtAudioFileDispose(audioFile);
-            ExtAudioFileDispose(micAudioFile);
-            audioFile = nullptr;
-            micAudioFile = nullptr;
-            systemCapture->StopRecording();
-            delete systemCapture;
-            systemCapture = nullptr;
-            return;
-        }
-
-        // 创建 source 音频文件
-        AudioStreamBasicDescription sourceFileFormat;
-        memset(&sourceFileFormat, 0, sizeof(sourceFileFormat));
-        sourceFileFormat.mSampleRate = standardFormat.sampleRate;
-        sourceFileFormat.mFormatID = kAudioFormatLinearPCM;
-        sourceFileFormat.mFormatFlags = kAudioFormatFlagIsFloat | kAudioFormatFlagIsPacked;
-        sourceFileFormat.mBitsPerChannel = 32;
-        sourceFileFormat.mChannelsPerFrame = standardFormat.channelCount;
-        sourceFileFormat.mFramesPerPacket = 1;
-        sourceFileFormat.mBytesPerFrame = sourceFileFormat.mChannelsPerFrame * (sourceFileFormat.mBitsPerChannel / 8);
-        sourceFileFormat.mBytesPerPacket = sourceFileFormat.mBytesPerFrame;
-
-        status = ExtAudioFileCreateWithURL((__bridge CFURLRef)pureSourceURL,
-                                         kAudioFileWAVEType,
-                                         &sourceFileFormat,
-                                         NULL,
-                                         kAudioFileFlags_EraseFile,
-                                         &sourceAudioFile);
-        if (status != noErr) {
-            Logger::error("创建 source 音频文件失败: %d", (int)status);
-            ExtAudioFileDispose(audioFile);
-            ExtAudioFileDispose(micAudioFile);
-            audioFile = nullptr;
-            micAudioFile = nullptr;
-            systemCapture->StopRecording();
-            delete systemCapture;
-            systemCapture = nullptr;
-            return;
-        }
-
-        status = ExtAudioFileSetProperty(sourceAudioFile,
-                                       kExtAudioFileProperty_ClientDataFormat,
-                                       sizeof(sourceFileFormat),
-                                       &sourceFileFormat);
-        if (status != noErr) {
-            Logger::error("设置 source 音频文件客户端格式失败: %d", (int)status);
-            ExtAudioFileDispose(audioFile);
-            ExtAudioFileDispose(micAudioFile);
-            ExtAudioFileDispose(sourceAudioFile);
-            audioFile = nullptr;
-            micAudioFile = nullptr;
-            sourceAudioFile = nullptr;
-            systemCapture->StopRecording();
-            delete systemCapture;
-            systemCapture = nullptr;
-            return;
-        }
-
-        // 创建混合音频文件
-        AudioStreamBasicDescription mixFileFormat;
-        memset(&mixFileFormat, 0, sizeof(mixFileFormat));
-        mixFileFormat.mSampleRate = micFormat.sampleRate;
-        mixFileFormat.mFormatID = kAudioFormatLinearPCM;
-        mixFileFormat.mFormatFlags = kAudioFormatFlagIsFloat | kAudioFormatFlagIsPacked;
-        mixFileFormat.mBitsPerChannel = 32;
-        mixFileFormat.mChannelsPerFrame = 2;  // 立体声
-        mixFileFormat.mFramesPerPacket = 1;
-        mixFileFormat.mBytesPerFrame = mixFileFormat.mChannelsPerFrame * (mixFileFormat.mBitsPerChannel / 8);
-        mixFileFormat.mBytesPerPacket = mixFileFormat.mBytesPerFrame;
-
-        status = ExtAudioFileCreateWithURL((__bridge CFURLRef)mixOutputURL,
-                                         kAudioFileWAVEType,
-                                         &mixFileFormat,
-                                         NULL,
-                                         kAudioFileFlags_EraseFile,
-                                         &mixAudioFile);
-        if (status != noErr) {
-            Logger::error("创建混合音频文件失败: %d", (int)status);
-            ExtAudioFileDispose(audioFile);
-            ExtAudioFileDispose(micAudioFile);
-            ExtAudioFileDispose(sourceAudioFile);
-            audioFile = nullptr;
-            micAudioFile = nullptr;
-            sourceAudioFile = nullptr;
-            systemCapture->StopRecording();
-            delete systemCapture;
-            systemCapture = nullptr;
-            return;
-        }
-
-        status = ExtAudioFileSetProperty(mixAudioFile,
-                                       kExtAudioFileProperty_ClientDataFormat,
-                                       sizeof(mixFileFormat),
-                                       &mixFileFormat);
-        if (status != noErr) {
-            Logger::error("设置混合音频文件客户端格式失败: %d", (int)status);
-            ExtAudioFileDispose(audioFile);
-            ExtAudioFileDispose(micAudioFile);
-            ExtAudioFileDispose(sourceAudioFile);
-            ExtAudioFileDispose(mixAudioFile);
-            audioFile = nullptr;
-            micAudioFile = nullptr;
-            sourceAudioFile = nullptr;
-            mixAudioFile = nullptr;
+        NSString* micOutputPath = [currentDir stringByAppendingPathComponent:[@"mic_audio" stringByAppendingString:extension]];
+        NSString* pureSourcePath = [currentDir stringByAppendingPathComponent:[@"pure_source" stringByAppendingString:extension]];
+        NSString* mixOutputPath = [currentDir stringByAppendingPathComponent:[@"mix_audio" stringByAppendingString:extension]];
+
+        // 混合音频文件（立体声，麦克风采样率）
+        StreamingWavWriter::Options mixOptions = envOptions;
+        mixOptions.sampleRate = (uint32_t)micFormat.sampleRate;
+        mixOptions.channels = 2;
+
+        // 麦克风音频文件
+        StreamingWavWriter::Options micOptions = envOptions;
+        micOptions.sampleRate = (uint32_t)micFormat.sampleRate;
+        micOptions.channels = (uint16_t)micFormat.channelCount;
+
+        // source 音频文件
+        StreamingWavWriter::Options sourceOptions = envOptions;
+        sourceOptions.sampleRate = (uint32_t)sessionSourceFormat.sampleRate;
+        sourceOptions.channels = (uint16_t)sessionSourceFormat.channelCount;
+
+        if (!mixWriter.Open([mixOutputPath UTF8String], mixOptions) ||
+            !micWriter.Open([micOutputPath UTF8String], micOptions) ||
+            !sourceWriter.Open([pureSourcePath UTF8String], sourceOptions)) {
+            Logger::error("创建输出音频文件失败");
+            mixWriter.Close();
+            micWriter.Close();
+            sourceWriter.Close();
             systemCapture->StopRecording();
             delete systemCapture;
             systemCapture = nullptr;
@@ -482,48 +437,43 @@ void TestAudioEngine() {
         }
 
         // 在 sourceNode 上安装 tap
-        [sourceNode installTapOnBus:0 bufferSize:1024 format:standardFormat block:^(AVAudioPCMBuffer * _Nonnull buffer, AVAudioTime * _Nonnull when) {
-            if (sourceAudioFile) {
-                // 创建临时缓冲区用于格式转换
-                AudioBufferList interleavedBufferList;
-                interleavedBufferList.mNumberBuffers = 1;
-                interleavedBufferList.mBuffers[0].mNumberChannels = buffer.format.channelCount;
-                interleavedBufferList.mBuffers[0].mDataByteSize = buffer.frameLength * sizeof(float) * buffer.format.channelCount;
-                interleavedBufferList.mBuffers[0].mData = malloc(interleavedBufferList.mBuffers[0].mDataByteSize);
-
-                float* interleavedData = (float*)interleavedBufferList.mBuffers[0].mData;
-                for (UInt32 frame = 0; frame < buffer.frameLength; ++frame) {
-                    for (UInt32 channel = 0; channel < buffer.format.channelCount; ++channel) {
-                        float* channelData = (float*)buffer.audioBufferList->mBuffers[channel].mData;
-                        interleavedData[frame * buffer.format.channelCount + channel] = channelData[frame];
-                    }
-                }
-
-                OSStatus status = ExtAudioFileWrite(sourceAudioFile, buffer.frameLength, &interleavedBufferList);
-                if (status != noErr) {
-                    Logger::error("写入 source 音频数据失败: %d", (int)status);
+        [sourceNode installTapOnBus:0 bufferSize:1024 format:sessionSourceFormat block:^(AVAudioPCMBuffer * _Nonnull buffer, AVAudioTime * _Nonnull when) {
+            if (sourceWriter.IsOpen()) {
+                // 使用预分配的缓冲区做格式转换
+                float* interleavedData = sourceInterleaveScratch.Data(buffer.frameLength * buffer.format.channelCount);
+                if (!interleavedData) {
+                    return;
                 }
 
-                free(interleavedBufferList.mBuffers[0].mData);
+                AudioKernels::Interleave(buffer.floatChannelData, interleavedData,
+                                         buffer.format.channelCount, buffer.frameLength);
+                sourceWriter.Write(interleavedData, buffer.frameLength);
             }
         }];
 
+        // 格式已确定，在回调开始运行之前预留临时缓冲区
+        ReserveScratchBuffers(audioEngine, micFormat, sessionSourceFormat);
+
+        // 引擎配置变化（设备切换、最大帧数变化）时在通知线程上扩容
+        id configObserver = [[NSNotificationCenter defaultCenter]
+            addObserverForName:AVAudioEngineConfigurationChangeNotification
+                        object:audioEngine
+                         queue:nil
+                    usingBlock:^(NSNotification * _Nonnull note) {
+            AVAudioFormat* inputFormat = [inputNode inputFormatForBus:0];
+            captureTrace.Event(-1, "engine configuration change: input " + std::to_string((int)inputFormat.sampleRate) +
+                                   " Hz, " + std::to_string(inputFormat.channelCount) + " ch");
+            ReserveScratchBuffers(audioEngine, inputFormat, sessionSourceFormat);
+        }];
+
         // 启动音频引擎
         if (![audioEngine startAndReturnError:&error]) {
             Logger::error("启动音频引擎失败: %s", [[error localizedDescription] UTF8String]);
+            [[NSNotificationCenter defaultCenter] removeObserver:configObserver];
             [sourceNode removeTapOnBus:0];
-            if (audioFile) {
-                ExtAudioFileDispose(audioFile);
-                audioFile = nullptr;
-            }
-            if (micAudioFile) {
-                ExtAudioFileDispose(micAudioFile);
-                micAudioFile = nullptr;
-            }
-            if (sourceAudioFile) {
-                ExtAudioFileDispose(sourceAudioFile);
-                sourceAudioFile = nullptr;
-            }
+            mixWriter.Close();
+            micWriter.Close();
+            sourceWriter.Close();
             systemCapture->StopRecording();
             delete systemCapture;
             systemCapture = nullptr;
@@ -545,45 +495,44 @@ void TestAudioEngine() {
 
         // 停止音频引擎
         [audioEngine stop];
+        [[NSNotificationCenter defaultCenter] removeObserver:configObserver];
         Logger::info("音频引擎已停止");
 
+        EchoCancellationStage::Stats echoStats = echoStage->GetStats();
+        Logger::info("回声消除统计: ERLE %.1f dB, ERL %.1f dB, 延迟 %d ms, 每帧平均 %.1f us, 最大 %.1f us",
+                     echoStats.echoReturnLossEnhancementDb, echoStats.echoReturnLossDb, echoStats.delayMs,
+                     echoStats.averageProcessNanos / 1000.0, echoStats.maxProcessNanos / 1000.0);
+
+        DriftCompensatingResampler::Stats driftStats = systemResampler.GetStats();
+        Logger::info("漂移补偿统计: 修正 %.1f ppm, 延迟 %.0f 帧, 欠载 %llu 次, 丢弃 %zu 样本",
+                     driftStats.correctionPpm, driftStats.latencyFrames,
+                     (unsigned long long)driftStats.underruns, driftStats.droppedSamples);
+        StreamAligner::Stats alignStats = streamAligner.GetStats();
+        Logger::info("时间戳对齐: 麦克风相对系统音频起始偏差 %.2f ms, 剩余偏差 %.3f ms, 麦克风到达延迟 %.2f ms, 系统音频到达延迟 %.2f ms",
+                     (alignStats.streams[kAlignMicrophone].startSkewNanos - alignStats.streams[kAlignSystem].startSkewNanos) / 1e6,
+                     streamAligner.RelativeOffsetNanos(kAlignMicrophone, kAlignSystem) / 1e6,
+                     alignStats.streams[kAlignMicrophone].averageLatencyNanos / 1e6,
+                     alignStats.streams[kAlignSystem].averageLatencyNanos / 1e6);
+        LevelMeter::Levels micLevelsAtStop = micLevels.Read();
+        Logger::info("麦克风电平: 最近窗口峰值 %.1f dBFS, RMS %.1f dBFS, 直流偏移 %.5f, 累计削波 %llu 个样本",
+                     LevelMeter::ToDecibels(micLevelsAtStop.peak), LevelMeter::ToDecibels(micLevelsAtStop.rms),
+                     micLevelsAtStop.dc, (unsigned long long)micLevelsAtStop.totalClipped);
+        PipelineMetrics::Log(pipelineMetrics.GetSnapshot(), "系统音频");
+
         // 停止系统音频捕获
         systemCapture->StopRecording();
+        streamAlignerReady.store(false, std::memory_order_release);
         delete systemCapture;
         systemCapture = nullptr;
-
-        // 确保所有数据都已写入文件
-        if (audioFile) {
-            OSStatus status = ExtAudioFileDispose(audioFile);
-            if (status != noErr) {
-                Logger::error("关闭源音频文件失败: %d", (int)status);
-            }
-            audioFile = nullptr;
+        if (captureTrace.IsOpen()) {
+            captureTrace.Event(-1, "stop");
+            captureTrace.Close();
         }
 
-        if (micAudioFile) {
-            OSStatus status = ExtAudioFileDispose(micAudioFile);
-            if (status != noErr) {
-                Logger::error("关闭麦克风音频文件失败: %d", (int)status);
-            }
-            micAudioFile = nullptr;
-        }
-
-        if (sourceAudioFile) {
-            OSStatus status = ExtAudioFileDispose(sourceAudioFile);
-            if (status != noErr) {
-                Logger::error("关闭 source 音频文件失败: %d", (int)status);
-            }
-            sourceAudioFile = nullptr;
-        }
-
-        if (mixAudioFile) {
-            OSStatus status = ExtAudioFileDispose(mixAudioFile);
-            if (status != noErr) {
-                Logger::error("关闭混合音频文件失败: %d", (int)status);
-            }
-            mixAudioFile = nullptr;
-        }
+        // 排空写入队列，写入最终头部并关闭文件
+        mixWriter.Close();
+        micWriter.Close();
+        sourceWriter.Close();
 
         // 最后再释放音频引擎
         sourceNode = nil;
@@ -0,0 +1,112 @@
+// recorder_batch：按实时录音的管线离线重新处理归档的会话，会话分配到所有核上并行处理
+//
+// 用法: recorder_batch [选项] <清单文件|输入目录> <输出目录>
+//   -j N             工作线程数，默认 CPU 核数
+//   --format F       输出编码 wav/flac/g722，默认 wav
+//   --no-aec         关闭回声消除
+//   --dsp            麦克风轨道经高通/降噪/AGC2 处理
+//   --no-align       关闭时间戳对齐
+//   --elide-silence  省略长静音并写出编辑表
+//   -v               输出管线日志
+// 其余管线参数沿用 HeadlessRecorder 的环境变量（RECORDER_AEC、RECORDER_DSP 等），命令行选项优先
+// 输入为目录时配对其中的 <名称>_mic.wav 和 <名称>_source.wav；清单格式见 BatchProcessor::LoadManifest
+
+#include "audio_encoder.h"
+#include "batch_processor.h"
+#include "logger.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+
+void PrintUsage() {
+    fprintf(stderr,
+            "用法: recorder_batch [-j N] [--format wav|flac|g722] [--no-aec] [--dsp] [--no-align] "
+            "[--elide-silence] [-v] <清单文件|输入目录> <输出目录>\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BatchProcessor::Options options;
+    options.recorder = HeadlessRecorder::Options::FromEnvironment();
+    AudioEncoder::Codec codec = AudioEncoder::Codec::Pcm;
+    bool verbose = false;
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "-j") == 0 && i + 1 < argc) {
+            options.workers = static_cast<size_t>(std::max(0, atoi(argv[++i])));
+        } else if (strcmp(arg, "--format") == 0 && i + 1 < argc) {
+            if (!AudioEncoder::ParseCodec(argv[++i], &codec)) {
+                fprintf(stderr, "未知的输出编码: %s\n", argv[i]);
+                return 2;
+            }
+        } else if (strcmp(arg, "--no-aec") == 0) {
+            options.recorder.echoCancellation = false;
+        } else if (strcmp(arg, "--dsp") == 0) {
+            options.recorder.micProcessing = true;
+        } else if (strcmp(arg, "--no-align") == 0) {
+            options.recorder.alignStreams = false;
+        } else if (strcmp(arg, "--elide-silence") == 0) {
+            options.recorder.elideSilence = true;
+        } else if (strcmp(arg, "-v") == 0) {
+            verbose = true;
+        } else if (arg[0] == '-') {
+            PrintUsage();
+            return 2;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() != 2) {
+        PrintUsage();
+        return 2;
+    }
+
+    Logger::init();
+    Logger::setLevel(verbose ? Logger::Level::INFO : Logger::Level::WARN);
+
+    std::vector<BatchProcessor::Session> sessions;
+    std::error_code error;
+    const bool ok = std::filesystem::is_directory(positional[0], error)
+        ? BatchProcessor::ScanDirectory(positional[0], &sessions)
+        : BatchProcessor::LoadManifest(positional[0], &sessions);
+    if (!ok || !BatchProcessor::AssignOutputs(positional[1], AudioEncoder::Extension(codec), &sessions)) {
+        Logger::shutdown();
+        return 2;
+    }
+    if (sessions.empty()) {
+        fprintf(stderr, "没有找到会话: %s\n", positional[0].c_str());
+        Logger::shutdown();
+        return 2;
+    }
+
+    size_t done = 0;
+    options.onSessionDone = [&done, &sessions](const BatchProcessor::Session& session,
+                                               const BatchProcessor::SessionResult& result) {
+        ++done;
+        printf("[%zu/%zu] %-32s %10.1f %8.2f %10.1f %6zu%s %s\n", done, sessions.size(), session.name.c_str(),
+               result.audioSeconds, result.wallSeconds,
+               result.wallSeconds > 0.0 ? result.audioSeconds / result.wallSeconds : 0.0, result.worker,
+               result.stolen ? "*" : " ", result.ok ? "" : "失败");
+        fflush(stdout);
+    };
+
+    printf("%zu 个会话\n", sessions.size());
+    printf("%-9s %-32s %10s %8s %10s %7s\n", "", "会话", "音频(s)", "墙钟(s)", "实时倍数", "线程");
+    BatchProcessor processor(options);
+    const BatchProcessor::Report report = processor.Run(sessions);
+    printf("\n合计: %zu 个会话 (%zu 个失败, %llu 个被窃取), 音频 %.2f 小时, 墙钟 %.1f 秒, CPU %.1f 秒, "
+           "实时倍数 %.1f, 每 CPU 秒处理 %.1f 秒音频\n",
+           report.sessions.size(), report.failed, static_cast<unsigned long long>(report.steals),
+           report.audioSeconds / 3600.0, report.wallSeconds, report.cpuSeconds,
+           report.wallSeconds > 0.0 ? report.audioSeconds / report.wallSeconds : 0.0,
+           report.cpuSeconds > 0.0 ? report.audioSeconds / report.cpuSeconds : 0.0);
+    Logger::shutdown();
+    return report.failed == 0 ? 0 : 1;
+}
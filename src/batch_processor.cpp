@@ -0,0 +1,285 @@
+#include "batch_processor.h"
+#include "logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <time.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr const char* kMicrophoneSuffix = "_mic.wav";
+constexpr const char* kSystemSuffix = "_source.wav";
+
+double ProcessCpuSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+}
+
+bool EndsWith(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+uint64_t InputBytes(const BatchProcessor::Session& session) {
+    std::error_code error;
+    uint64_t bytes = 0;
+    for (const std::string* path : {&session.microphonePath, &session.systemPath}) {
+        const uintmax_t size = fs::file_size(*path, error);
+        bytes += error ? 0 : static_cast<uint64_t>(size);
+    }
+    return bytes;
+}
+
+// 一个工作线程的会话队列；会话粒度是秒到分钟级，用互斥锁保护即可
+struct WorkQueue {
+    std::mutex mutex;
+    std::deque<size_t> items;
+    uint64_t bytes = 0;   // 队列中剩余会话的输入大小
+};
+
+} // namespace
+
+BatchProcessor::Options::Options() = default;
+
+bool BatchProcessor::LoadManifest(const std::string& path, std::vector<Session>* sessions) {
+    std::ifstream in(path);
+    if (!in) {
+        Logger::error("无法打开清单: %s", path.c_str());
+        return false;
+    }
+    const fs::path base = fs::path(path).parent_path();
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::vector<std::string> fields;
+        size_t start = 0;
+        for (;;) {
+            const size_t tab = line.find('\t', start);
+            fields.push_back(line.substr(start, tab == std::string::npos ? std::string::npos : tab - start));
+            if (tab == std::string::npos) {
+                break;
+            }
+            start = tab + 1;
+        }
+        if (fields.size() < 2 || fields[0].empty() || fields[1].empty()) {
+            Logger::error("清单第 %zu 行格式错误，应为 麦克风路径<TAB>系统音频路径[<TAB>名称]", lineNumber);
+            return false;
+        }
+        Session session;
+        session.microphonePath = (base / fields[0]).string();
+        session.systemPath = (base / fields[1]).string();
+        if (fields.size() > 2 && !fields[2].empty()) {
+            session.name = fields[2];
+        } else {
+            session.name = fs::path(fields[0]).stem().string();
+            if (EndsWith(session.name, "_mic")) {
+                session.name.resize(session.name.size() - 4);
+            }
+        }
+        sessions->push_back(session);
+    }
+    return true;
+}
+
+bool BatchProcessor::ScanDirectory(const std::string& directory, std::vector<Session>* sessions) {
+    std::error_code error;
+    fs::directory_iterator it(directory, error);
+    if (error) {
+        Logger::error("无法读取目录 %s: %s", directory.c_str(), error.message().c_str());
+        return false;
+    }
+    // 按名称排序，结果与目录遍历顺序无关
+    std::map<std::string, Session> found;
+    for (const fs::directory_entry& entry : it) {
+        const std::string file = entry.path().filename().string();
+        if (!entry.is_regular_file() || !EndsWith(file, kMicrophoneSuffix)) {
+            continue;
+        }
+        const std::string name = file.substr(0, file.size() - strlen(kMicrophoneSuffix));
+        const fs::path system = entry.path().parent_path() / (name + kSystemSuffix);
+        if (!fs::is_regular_file(system, error)) {
+            Logger::warn("跳过 %s: 缺少 %s", entry.path().c_str(), system.filename().c_str());
+            continue;
+        }
+        Session& session = found[name];
+        session.name = name;
+        session.microphonePath = entry.path().string();
+        session.systemPath = system.string();
+    }
+    for (auto& item : found) {
+        sessions->push_back(std::move(item.second));
+    }
+    return true;
+}
+
+bool BatchProcessor::AssignOutputs(const std::string& outputDirectory, const std::string& extension,
+                                   std::vector<Session>* sessions) {
+    std::error_code error;
+    fs::create_directories(outputDirectory, error);
+    if (error) {
+        Logger::error("无法创建输出目录 %s: %s", outputDirectory.c_str(), error.message().c_str());
+        return false;
+    }
+    std::map<std::string, size_t> names;
+    for (Session& session : *sessions) {
+        // 同名会话加序号，避免互相覆盖
+        const size_t count = names[session.name]++;
+        const std::string name = count == 0 ? session.name : session.name + "_" + std::to_string(count);
+        session.outputPath = (fs::path(outputDirectory) / (name + extension)).string();
+        // 输出的 _mic/_source 与输入同名时会覆盖正在读取的文件
+        const std::string stem = session.outputPath.substr(0, session.outputPath.size() - extension.size());
+        for (const std::string& input : {session.microphonePath, session.systemPath}) {
+            for (const char* suffix : {kMicrophoneSuffix, kSystemSuffix}) {
+                if (fs::equivalent(input, stem + suffix, error)) {
+                    Logger::error("会话 %s 的输出会覆盖输入 %s", session.name.c_str(), input.c_str());
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+BatchProcessor::BatchProcessor(const Options& options)
+    : options_(options) {
+}
+
+BatchProcessor::~BatchProcessor() = default;
+
+BatchProcessor::Report BatchProcessor::Run(const std::vector<Session>& sessions) {
+    Report report{};
+    report.sessions.resize(sessions.size());
+    size_t workers = options_.workers > 0 ? options_.workers : std::thread::hardware_concurrency();
+    workers = std::max<size_t>(1, std::min(workers, sessions.size()));
+
+    // 大的会话先分配，轮流放进各线程的队列
+    std::vector<uint64_t> bytes(sessions.size());
+    std::vector<size_t> order(sessions.size());
+    for (size_t i = 0; i < sessions.size(); ++i) {
+        bytes[i] = InputBytes(sessions[i]);
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&bytes](size_t a, size_t b) { return bytes[a] > bytes[b]; });
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    for (size_t w = 0; w < workers; ++w) {
+        queues.emplace_back(new WorkQueue());
+    }
+    for (size_t i = 0; i < order.size(); ++i) {
+        WorkQueue& queue = *queues[i % workers];
+        queue.items.push_back(order[i]);
+        queue.bytes += bytes[order[i]];
+    }
+
+    // 先取自己队列的头部（最大的），取空后从剩余最多的队列尾部（最小的）窃取
+    auto next = [&](size_t self, size_t* index, bool* stolen) {
+        {
+            WorkQueue& own = *queues[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.items.empty()) {
+                *index = own.items.front();
+                own.items.pop_front();
+                own.bytes -= bytes[*index];
+                *stolen = false;
+                return true;
+            }
+        }
+        for (;;) {
+            size_t victim = workers;
+            uint64_t most = 0;
+            for (size_t w = 0; w < workers; ++w) {
+                std::lock_guard<std::mutex> lock(queues[w]->mutex);
+                if (!queues[w]->items.empty() && (victim == workers || queues[w]->bytes > most)) {
+                    victim = w;
+                    most = queues[w]->bytes;
+                }
+            }
+            if (victim == workers) {
+                return false;
+            }
+            WorkQueue& queue = *queues[victim];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            // 选中之后可能已被别的线程取空，重新挑选
+            if (!queue.items.empty()) {
+                *index = queue.items.back();
+                queue.items.pop_back();
+                queue.bytes -= bytes[*index];
+                *stolen = true;
+                return true;
+            }
+        }
+    };
+
+    std::mutex reportMutex;
+    auto work = [&](size_t self) {
+        size_t index = 0;
+        bool stolen = false;
+        while (next(self, &index, &stolen)) {
+            const Session& session = sessions[index];
+            HeadlessRecorder::Options options = options_.recorder;
+            options.speed = 0.0;
+            options.microphone.wavPath = session.microphonePath;
+            options.system.wavPath = session.systemPath;
+            options.microphone.durationSeconds = options.system.durationSeconds = 0.0;
+            options.microphone.loop = options.system.loop = false;
+
+            SessionResult result{};
+            result.index = index;
+            result.worker = self;
+            result.stolen = stolen;
+            const auto start = std::chrono::steady_clock::now();
+            HeadlessRecorder recorder(nullptr, options);
+            recorder.SetOutputPath(session.outputPath);
+            if (recorder.Start()) {
+                recorder.WaitUntilFinished();
+                recorder.Stop();
+                const HeadlessRecorder::Stats stats = recorder.GetStats();
+                result.ok = stats.droppedFrames == 0;
+                result.audioSeconds = stats.audioSeconds;
+                result.droppedFrames = stats.droppedFrames;
+            } else {
+                Logger::error("会话 %s 处理失败", session.name.c_str());
+            }
+            result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            std::lock_guard<std::mutex> lock(reportMutex);
+            report.sessions[index] = result;
+            if (options_.onSessionDone) {
+                options_.onSessionDone(session, result);
+            }
+        }
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    const double startCpu = ProcessCpuSeconds();
+    std::vector<std::thread> threads;
+    for (size_t w = 0; w < workers; ++w) {
+        threads.emplace_back(work, w);
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    report.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    report.cpuSeconds = ProcessCpuSeconds() - startCpu;
+    for (const SessionResult& result : report.sessions) {
+        report.audioSeconds += result.audioSeconds;
+        report.failed += result.ok ? 0 : 1;
+        report.steals += result.stolen ? 1 : 0;
+    }
+    return report;
+}
@@ -0,0 +1,143 @@
+#include "broadcast_ring.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+size_t RoundUpToPowerOfTwo(size_t size) {
+    size_t capacity = 1;
+    while (capacity < size) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+// 只有所有者线程写入的统计，用 load/store 代替 fetch_add
+void AddRelaxed(std::atomic<size_t>& counter, size_t n) {
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+} // namespace
+
+BroadcastRing::BroadcastRing(size_t size, size_t granularity)
+    : write_pos_(0)
+    , claim_pos_(0)
+    , capacity_(RoundUpToPowerOfTwo(std::max<size_t>(size, 2)))
+    , mask_(capacity_ - 1)
+    , granularity_(std::max<size_t>(granularity, 1)) {
+    buffer_.reset(new float[capacity_]());
+}
+
+void BroadcastRing::copy_in(uint64_t pos, const float* data, size_t count) {
+    size_t offset = static_cast<size_t>(pos) & mask_;
+    size_t first = std::min(count, capacity_ - offset);
+    memcpy(buffer_.get() + offset, data, first * sizeof(float));
+    if (first < count) {
+        memcpy(buffer_.get(), data + first, (count - first) * sizeof(float));
+    }
+}
+
+void BroadcastRing::copy_out(uint64_t pos, float* data, size_t count) const {
+    size_t offset = static_cast<size_t>(pos) & mask_;
+    size_t first = std::min(count, capacity_ - offset);
+    memcpy(data, buffer_.get() + offset, first * sizeof(float));
+    if (first < count) {
+        memcpy(data + first, buffer_.get(), (count - first) * sizeof(float));
+    }
+}
+
+void BroadcastRing::write(const float* data, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    const uint64_t w = write_pos_.load(std::memory_order_relaxed);
+    const size_t skipped = count > capacity_ ? count - capacity_ : 0;
+
+    // 先发布将要覆盖的范围，再写数据；读者拷贝后检查 claim_pos_，发现重叠即丢弃这次拷贝
+    claim_pos_.store(w + count, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    copy_in(w + skipped, data + skipped, count - skipped);
+    write_pos_.store(w + count, std::memory_order_release);
+}
+
+BroadcastRing::Reader::Reader(const BroadcastRing& ring, OverflowPolicy policy)
+    : ring_(ring)
+    , policy_(policy)
+    , read_pos_(ring.write_position())
+    , overflow_count_(0)
+    , underflow_count_(0)
+    , dropped_samples_(0)
+    , max_used_size_(0) {
+}
+
+uint64_t BroadcastRing::Reader::handle_overflow(uint64_t w) {
+    const uint64_t r = read_pos_.load(std::memory_order_relaxed);
+    const uint64_t claim = ring_.claim_pos_.load(std::memory_order_acquire);
+    uint64_t next;
+    if (policy_ == OverflowPolicy::SkipToLatest) {
+        next = std::max(w, r);
+    } else {
+        // 保留 3/4 容量的积压，避免紧贴生产者反复被覆盖
+        next = claim - ring_.capacity_ + ring_.capacity_ / 4;
+        next += (ring_.granularity_ - next % ring_.granularity_) % ring_.granularity_;
+    }
+    AddRelaxed(overflow_count_, 1);
+    AddRelaxed(dropped_samples_, static_cast<size_t>(next - r));
+    read_pos_.store(next, std::memory_order_release);
+    return next;
+}
+
+bool BroadcastRing::Reader::read(float* data, size_t count) {
+    const size_t capacity = ring_.capacity_;
+    if (count > capacity) {
+        AddRelaxed(underflow_count_, 1);
+        return false;
+    }
+    uint64_t r = read_pos_.load(std::memory_order_relaxed);
+    for (;;) {
+        const uint64_t w = ring_.write_pos_.load(std::memory_order_acquire);
+        const size_t used = static_cast<size_t>(w - r);
+        if (used > capacity) {
+            r = handle_overflow(w);
+            continue;
+        }
+        if (used < count) {
+            AddRelaxed(underflow_count_, 1);
+            return false;
+        }
+        if (used > max_used_size_.load(std::memory_order_relaxed)) {
+            max_used_size_.store(used, std::memory_order_relaxed);
+        }
+
+        ring_.copy_out(r, data, count);
+
+        // 拷贝期间生产者若已开始覆盖这段数据，拷贝结果不可用
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t claim = ring_.claim_pos_.load(std::memory_order_relaxed);
+        if (static_cast<size_t>(claim - r) > capacity) {
+            r = handle_overflow(ring_.write_pos_.load(std::memory_order_acquire));
+            continue;
+        }
+        read_pos_.store(r + count, std::memory_order_release);
+        return true;
+    }
+}
+
+size_t BroadcastRing::Reader::available_read() const {
+    const uint64_t r = read_pos_.load(std::memory_order_acquire);
+    const uint64_t w = ring_.write_pos_.load(std::memory_order_acquire);
+    return std::min(static_cast<size_t>(w - r), ring_.capacity_);
+}
+
+void BroadcastRing::Reader::skip_to_latest() {
+    read_pos_.store(ring_.write_position(), std::memory_order_release);
+}
+
+BroadcastRing::Reader::Stats BroadcastRing::Reader::get_stats() const {
+    return {
+        overflow_count_.load(std::memory_order_relaxed),
+        underflow_count_.load(std::memory_order_relaxed),
+        dropped_samples_.load(std::memory_order_relaxed),
+        max_used_size_.load(std::memory_order_relaxed)
+    };
+}
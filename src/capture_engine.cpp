@@ -0,0 +1,128 @@
+#include "capture_engine.h"
+#include "logger.h"
+#include <algorithm>
+#include <map>
+
+CaptureEngine::Options::Options() = default;
+
+CaptureEngine::Subscription::Subscription(std::shared_ptr<CaptureEngine> engine,
+                                          BroadcastRing::Reader::OverflowPolicy policy)
+    : engine_(std::move(engine))
+    , reader_(*engine_->ring_, policy)
+    , sampleRate_(engine_->SampleRate())
+    , channels_(engine_->Channels()) {
+}
+
+CaptureEngine::Subscription::~Subscription() {
+    engine_->Unsubscribe();
+}
+
+bool CaptureEngine::Subscription::Read(float* interleaved, size_t frames) {
+    return reader_.read(interleaved, frames * channels_);
+}
+
+size_t CaptureEngine::Subscription::AvailableFrames() const {
+    return reader_.available_read() / channels_;
+}
+
+uint64_t CaptureEngine::Subscription::Position() const {
+    return reader_.position() / channels_;
+}
+
+BroadcastRing::Reader::Stats CaptureEngine::Subscription::GetStats() const {
+    return reader_.get_stats();
+}
+
+std::shared_ptr<CaptureEngine> CaptureEngine::Create(std::unique_ptr<CaptureBackend> backend,
+                                                     const Options& options) {
+    if (!backend || backend->SampleRate() <= 0 || backend->Channels() == 0) {
+        Logger::error("采集引擎需要已确定格式的后端");
+        return nullptr;
+    }
+    return std::shared_ptr<CaptureEngine>(new CaptureEngine(std::move(backend), options));
+}
+
+std::shared_ptr<CaptureEngine> CaptureEngine::Shared(const std::string& name, const BackendFactory& factory,
+                                                     const Options& options) {
+    // 只保存弱引用，引擎的生命周期由使用者决定
+    static std::mutex registryMutex;
+    static std::map<std::string, std::weak_ptr<CaptureEngine>> registry;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (std::shared_ptr<CaptureEngine> engine = registry[name].lock()) {
+        return engine;
+    }
+    std::shared_ptr<CaptureEngine> engine = Create(factory(), options);
+    if (engine) {
+        registry[name] = engine;
+        Logger::info("创建共享采集引擎: %s (采样率 %d, 声道数 %zu)", name.c_str(), engine->SampleRate(),
+                     engine->Channels());
+    } else {
+        registry.erase(name);
+    }
+    return engine;
+}
+
+CaptureEngine::CaptureEngine(std::unique_ptr<CaptureBackend> backend, const Options& options)
+    : backend_(std::move(backend))
+    , options_(options)
+    , subscribers_(0)
+    , callbacks_(0)
+    , samplesWritten_(0) {
+    const size_t channels = backend_->Channels();
+    const size_t samples = static_cast<size_t>(backend_->SampleRate()) * channels *
+                           std::max<uint32_t>(options_.bufferMilliseconds, 1) / 1000;
+    ring_ = std::make_unique<BroadcastRing>(samples, channels);
+    backend_->SetDataCallback([this](const float* interleaved, size_t frames, const CaptureTimestamp&) {
+        OnData(interleaved, frames);
+    });
+}
+
+CaptureEngine::~CaptureEngine() {
+    // 订阅持有引擎的引用，走到这里时已经没有消费者，后端也已停止
+    if (backend_->IsRunning()) {
+        backend_->Stop();
+    }
+}
+
+std::unique_ptr<CaptureEngine::Subscription> CaptureEngine::Subscribe(BroadcastRing::Reader::OverflowPolicy policy) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (subscribers_ == 0 && !backend_->IsRunning()) {
+        if (!backend_->Start()) {
+            Logger::error("启动采集后端失败");
+            return nullptr;
+        }
+    }
+    ++subscribers_;
+    // 读位置取当前写位置，新订阅不会读到订阅之前的积压
+    return std::unique_ptr<Subscription>(new Subscription(shared_from_this(), policy));
+}
+
+void CaptureEngine::Unsubscribe() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--subscribers_ == 0 && backend_->IsRunning()) {
+        // 后端回调不取这把锁，在锁内停止不会死锁
+        backend_->Stop();
+    }
+}
+
+bool CaptureEngine::IsRunning() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return backend_->IsRunning();
+}
+
+CaptureEngine::Stats CaptureEngine::GetStats() const {
+    Stats stats;
+    stats.callbacks = callbacks_.load(std::memory_order_relaxed);
+    stats.samplesWritten = samplesWritten_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.subscribers = subscribers_;
+    return stats;
+}
+
+void CaptureEngine::OnData(const float* interleaved, size_t frames) {
+    const size_t samples = frames * backend_->Channels();
+    ring_->write(interleaved, samples);
+    callbacks_.store(callbacks_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    samplesWritten_.store(samplesWritten_.load(std::memory_order_relaxed) + samples, std::memory_order_relaxed);
+}
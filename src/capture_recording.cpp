@@ -0,0 +1,112 @@
+#include "capture_recording.h"
+#include "logger.h"
+#include <algorithm>
+#include <vector>
+
+CaptureRecording::Options::Options() = default;
+
+CaptureRecording::CaptureRecording(std::shared_ptr<CaptureEngine> engine)
+    : engine_(std::move(engine))
+    , endFrame_(0)
+    , startFrame_(0)
+    , prerollFrames_(0)
+    , liveFrames_(0)
+    , stopRequested_(false) {
+}
+
+CaptureRecording::~CaptureRecording() {
+    Stop();
+}
+
+bool CaptureRecording::Start(const std::string& path, const Options& options) {
+    if (IsRecording() || !engine_) {
+        return false;
+    }
+    options_ = options;
+    options_.writer.sampleRate = static_cast<uint32_t>(engine_->SampleRate());
+    options_.writer.channels = static_cast<uint16_t>(engine_->Channels());
+
+    subscription_ = engine_->Subscribe();
+    if (!subscription_) {
+        return false;
+    }
+    endFrame_ = subscription_->Position();
+    if (!writer_.Open(path, options_.writer)) {
+        subscription_.reset();
+        return false;
+    }
+
+    startFrame_.store(endFrame_, std::memory_order_relaxed);
+    prerollFrames_.store(0, std::memory_order_relaxed);
+    liveFrames_.store(0, std::memory_order_relaxed);
+    stopRequested_ = false;
+    thread_ = std::thread(&CaptureRecording::RecordLoop, this);
+    Logger::info("录音已开始: %s, 预录 %.1f 秒", path.c_str(), options_.preroll ? options_.prerollSeconds : 0.0);
+    return true;
+}
+
+void CaptureRecording::Stop() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopRequested_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+    writer_.Close();
+    subscription_.reset();
+}
+
+bool CaptureRecording::WriteBlocking(const float* interleaved, size_t frames, bool abortOnStop) {
+    const auto poll = std::chrono::milliseconds(options_.pollMilliseconds);
+    for (;;) {
+        if (writer_.QueueCapacityFrames() - writer_.QueuedFrames() >= frames) {
+            return writer_.Write(interleaved, frames);
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (cv_.wait_for(lock, poll, [this, abortOnStop] { return abortOnStop && stopRequested_; })) {
+            return false;
+        }
+    }
+}
+
+void CaptureRecording::RecordLoop() {
+    if (options_.preroll && options_.prerollSeconds > 0.0) {
+        const uint64_t frames = options_.preroll->Splice(
+            endFrame_, options_.prerollSeconds,
+            [this](const float* interleaved, size_t count) { return WriteBlocking(interleaved, count, true); });
+        prerollFrames_.store(frames, std::memory_order_relaxed);
+        startFrame_.store(endFrame_ - frames, std::memory_order_relaxed);
+    }
+
+    // 一次最多读 100ms
+    const size_t channels = engine_->Channels();
+    const size_t chunkFrames = static_cast<size_t>(engine_->SampleRate()) / 10;
+    std::vector<float> buffer(chunkFrames * channels);
+    const auto poll = std::chrono::milliseconds(options_.pollMilliseconds);
+    bool stopping = false;
+    for (;;) {
+        const size_t frames = std::min(subscription_->AvailableFrames(), chunkFrames);
+        if (frames > 0 && subscription_->Read(buffer.data(), frames)) {
+            WriteBlocking(buffer.data(), frames, false);
+            liveFrames_.store(liveFrames_.load(std::memory_order_relaxed) + frames, std::memory_order_relaxed);
+            continue;
+        }
+        if (stopping) {
+            break;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        stopping = cv_.wait_for(lock, poll, [this] { return stopRequested_; });
+    }
+}
+
+CaptureRecording::Stats CaptureRecording::GetStats() const {
+    Stats stats;
+    stats.startFrame = startFrame_.load(std::memory_order_relaxed);
+    stats.prerollFrames = prerollFrames_.load(std::memory_order_relaxed);
+    stats.liveFrames = liveFrames_.load(std::memory_order_relaxed);
+    stats.droppedSamples = subscription_ ? subscription_->GetStats().dropped_samples : 0;
+    return stats;
+}
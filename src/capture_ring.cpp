@@ -0,0 +1,169 @@
+#include "capture_ring.h"
+#include "logger.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+// 按存储格式和声道数实例化的环形缓冲，接口以帧为单位
+class CaptureRing::Ring {
+public:
+    virtual ~Ring() = default;
+    virtual bool Write(const float* interleaved, size_t frames) = 0;
+    virtual bool Read(float* interleaved, size_t frames) = 0;
+    virtual size_t AvailableFrames() const = 0;
+    virtual size_t CapacityFrames() const = 0;
+    virtual size_t StorageBytes() const = 0;
+    virtual RingBufferBase::Stats GetStats() const = 0;
+    virtual void Clear() = 0;
+};
+
+template <typename Sample, size_t Channels>
+class CaptureRing::TypedRing : public CaptureRing::Ring {
+public:
+    TypedRing(size_t frames, RingBufferBase::OverflowPolicy policy)
+        : ring_(frames, policy) {
+    }
+
+    bool Write(const float* interleaved, size_t frames) override { return ring_.write(interleaved, frames); }
+    bool Read(float* interleaved, size_t frames) override { return ring_.read(interleaved, frames); }
+    size_t AvailableFrames() const override { return ring_.available_read(); }
+    size_t CapacityFrames() const override { return ring_.capacity(); }
+    size_t StorageBytes() const override { return ring_.storage_bytes(); }
+    RingBufferBase::Stats GetStats() const override { return ring_.get_stats(); }
+    void Clear() override { ring_.clear(); }
+
+private:
+    BasicRingBuffer<Sample, Channels> ring_;
+};
+
+template <typename Sample>
+CaptureRing::Ring* CaptureRing::NewRing(size_t channels, size_t frames, RingBufferBase::OverflowPolicy policy) {
+    switch (channels) {
+    case 1:
+        return new TypedRing<Sample, 1>(frames, policy);
+    case 2:
+        return new TypedRing<Sample, 2>(frames, policy);
+    case 3:
+        return new TypedRing<Sample, 3>(frames, policy);
+    case 4:
+        return new TypedRing<Sample, 4>(frames, policy);
+    case 5:
+        return new TypedRing<Sample, 5>(frames, policy);
+    case 6:
+        return new TypedRing<Sample, 6>(frames, policy);
+    case 7:
+        return new TypedRing<Sample, 7>(frames, policy);
+    default:
+        return new TypedRing<Sample, 8>(frames, policy);
+    }
+}
+
+CaptureRing::Options::Options() = default;
+
+CaptureRing::Options CaptureRing::Options::FromEnvironment() {
+    Options options;
+    if (const char* format = getenv("RECORDER_RING_FORMAT")) {
+        if (!ParseStorage(format, &options.storage)) {
+            Logger::warn("未知的环形缓冲格式 %s，使用 float32", format);
+        }
+    }
+    if (const char* milliseconds = getenv("RECORDER_RING_MS")) {
+        options.capacityMilliseconds = static_cast<uint32_t>(std::max(1, atoi(milliseconds)));
+    }
+    return options;
+}
+
+CaptureRing::CaptureRing()
+    : sampleRate_(0)
+    , channels_(0) {
+}
+
+CaptureRing::~CaptureRing() = default;
+
+bool CaptureRing::Configure(const Options& options, int sampleRate, size_t channels) {
+    ring_.reset();
+    options_ = options;
+    sampleRate_ = 0;
+    channels_ = 0;
+    if (sampleRate <= 0 || channels == 0 || channels > kMaxChannels) {
+        Logger::error("环形缓冲不支持的格式: %d Hz, %zu 声道", sampleRate, channels);
+        return false;
+    }
+    const size_t frames = std::max<size_t>(
+        1, static_cast<size_t>(static_cast<uint64_t>(sampleRate) * options.capacityMilliseconds / 1000));
+    switch (options.storage) {
+    case Storage::Int16:
+        ring_.reset(NewRing<int16_t>(channels, frames, options.policy));
+        break;
+    case Storage::Int24:
+        ring_.reset(NewRing<PackedInt24>(channels, frames, options.policy));
+        break;
+    case Storage::Float32:
+        ring_.reset(NewRing<float>(channels, frames, options.policy));
+        break;
+    }
+    sampleRate_ = sampleRate;
+    channels_ = channels;
+    Logger::info("环形缓冲: %d Hz, %zu 声道, %s, %zu 帧 (%.2f 秒, %zu KB)", sampleRate, channels,
+                 StorageName(options.storage), ring_->CapacityFrames(),
+                 static_cast<double>(ring_->CapacityFrames()) / sampleRate, ring_->StorageBytes() / 1024);
+    return true;
+}
+
+bool CaptureRing::Write(const float* interleaved, size_t frames) {
+    return ring_ ? ring_->Write(interleaved, frames) : false;
+}
+
+bool CaptureRing::Read(float* interleaved, size_t frames) {
+    return ring_ ? ring_->Read(interleaved, frames) : false;
+}
+
+size_t CaptureRing::AvailableFrames() const {
+    return ring_ ? ring_->AvailableFrames() : 0;
+}
+
+size_t CaptureRing::CapacityFrames() const {
+    return ring_ ? ring_->CapacityFrames() : 0;
+}
+
+size_t CaptureRing::StorageBytes() const {
+    return ring_ ? ring_->StorageBytes() : 0;
+}
+
+RingBufferBase::Stats CaptureRing::GetStats() const {
+    return ring_ ? ring_->GetStats() : RingBufferBase::Stats{};
+}
+
+void CaptureRing::Clear() {
+    if (ring_) {
+        ring_->Clear();
+    }
+}
+
+const char* CaptureRing::StorageName(Storage storage) {
+    switch (storage) {
+    case Storage::Int16:
+        return "int16";
+    case Storage::Int24:
+        return "int24";
+    case Storage::Float32:
+        break;
+    }
+    return "float32";
+}
+
+bool CaptureRing::ParseStorage(const char* name, Storage* storage) {
+    if (!name) {
+        return false;
+    }
+    if (strcmp(name, "float32") == 0 || strcmp(name, "float") == 0) {
+        *storage = Storage::Float32;
+    } else if (strcmp(name, "int16") == 0) {
+        *storage = Storage::Int16;
+    } else if (strcmp(name, "int24") == 0) {
+        *storage = Storage::Int24;
+    } else {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,612 @@
+#include "capture_trace.h"
+#include "logger.h"
+#include "pipeline_metrics.h"
+#include "ring_buffer.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace CaptureTrace;
+
+namespace {
+
+constexpr char kMagic[8] = {'R', 'E', 'C', 'T', 'R', 'A', 'C', 'E'};
+
+// 队列除样本外为记录头、格式和 Gap 记录预留的空间
+constexpr size_t kQueueSlackBytes = 64 * 1024;
+
+size_t RoundUpToPowerOfTwo(size_t size) {
+    size_t capacity = 1;
+    while (capacity < size) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+bool PWriteAll(int fd, const uint8_t* data, size_t size, uint64_t offset) {
+    while (size > 0) {
+        ssize_t n = pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+size_t Align8(size_t size) {
+    return (size + 7) & ~static_cast<size_t>(7);
+}
+
+// 一条记录由若干段拼成，data 为 nullptr 的段填零（对齐填充）
+struct Part {
+    const void* data;
+    size_t size;
+};
+
+RecordHeader MakeHeader(RecordType type, int stream, size_t size, uint64_t arrivalNanos) {
+    RecordHeader header;
+    header.size = static_cast<uint32_t>(size);
+    header.type = static_cast<uint8_t>(type);
+    header.stream = stream < 0 ? kNoStream : static_cast<uint8_t>(stream);
+    header.reserved = 0;
+    header.arrivalNanos = arrivalNanos;
+    return header;
+}
+
+} // namespace
+
+// 单生产者/单消费者字节队列，生产者按整条记录写入，消费者看到的可读范围总是由完整记录组成
+// 读写位置与 RingBuffer 相同：单调递增计数、各自独占缓存行，数据最多分两段拷贝
+class CaptureTraceWriter::Queue {
+public:
+    explicit Queue(size_t size)
+        : writePos_(0)
+        , readPos_(0)
+        , capacity_(RoundUpToPowerOfTwo(size))
+        , mask_(capacity_ - 1)
+        , buffer_(new uint8_t[capacity_]()) {
+    }
+
+    // 空间不足时整条丢弃并返回 false
+    bool Push(const Part* parts, size_t count) {
+        size_t total = 0;
+        for (size_t i = 0; i < count; ++i) {
+            total += parts[i].size;
+        }
+        const uint64_t w = writePos_.load(std::memory_order_relaxed);
+        const uint64_t r = readPos_.load(std::memory_order_acquire);
+        if (total > capacity_ - static_cast<size_t>(w - r)) {
+            return false;
+        }
+        uint64_t pos = w;
+        for (size_t i = 0; i < count; ++i) {
+            CopyIn(pos, parts[i].data, parts[i].size);
+            pos += parts[i].size;
+        }
+        writePos_.store(pos, std::memory_order_release);
+        return true;
+    }
+
+    // 消费者取得可读范围（最多两段），处理完后调用 Consume()
+    size_t Peek(const uint8_t** first, size_t* firstSize, const uint8_t** second, size_t* secondSize) const {
+        const uint64_t r = readPos_.load(std::memory_order_relaxed);
+        const uint64_t w = writePos_.load(std::memory_order_acquire);
+        const size_t available = static_cast<size_t>(w - r);
+        const size_t offset = static_cast<size_t>(r) & mask_;
+        *first = buffer_.get() + offset;
+        *firstSize = std::min(available, capacity_ - offset);
+        *second = buffer_.get();
+        *secondSize = available - *firstSize;
+        return available;
+    }
+
+    void Consume(size_t bytes) {
+        readPos_.store(readPos_.load(std::memory_order_relaxed) + bytes, std::memory_order_release);
+    }
+
+private:
+    void CopyIn(uint64_t pos, const void* data, size_t size) {
+        const size_t offset = static_cast<size_t>(pos) & mask_;
+        const size_t first = std::min(size, capacity_ - offset);
+        if (data) {
+            memcpy(buffer_.get() + offset, data, first);
+            memcpy(buffer_.get(), static_cast<const uint8_t*>(data) + first, size - first);
+        } else {
+            memset(buffer_.get() + offset, 0, first);
+            memset(buffer_.get(), 0, size - first);
+        }
+    }
+
+    alignas(kCacheLineSize) std::atomic<uint64_t> writePos_;
+    alignas(kCacheLineSize) std::atomic<uint64_t> readPos_;
+    alignas(kCacheLineSize) size_t capacity_;
+    size_t mask_;
+    std::unique_ptr<uint8_t[]> buffer_;
+};
+
+struct CaptureTraceWriter::Stream {
+    std::unique_ptr<Queue> queue;
+    // 以下三项只在该流的采集线程访问
+    int sampleRate = 0;
+    size_t channels = 0;
+    uint64_t pendingGapFrames = 0;   // 已丢弃、尚未写入 Gap 记录的帧数
+    std::atomic<uint64_t> blocks{0};
+    std::atomic<uint64_t> droppedBlocks{0};
+};
+
+CaptureTraceWriter::Options::Options() = default;
+
+CaptureTraceWriter::CaptureTraceWriter()
+    : fd_(-1)
+    , streamCount_(0)
+    , stopRequested_(false)
+    , open_(false)
+    , fileOffset_(0)
+    , writeFailed_(false)
+    , bytesWritten_(0) {
+}
+
+CaptureTraceWriter::~CaptureTraceWriter() {
+    Close();
+}
+
+bool CaptureTraceWriter::Open(const std::string& path, const Options& options) {
+    Close();
+    fd_ = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+        Logger::error("无法创建采集轨迹: %s", path.c_str());
+        return false;
+    }
+    options_ = options;
+    path_ = path;
+    for (auto& stream : streams_) {
+        stream.reset();
+    }
+    streamCount_.store(0, std::memory_order_relaxed);
+    events_.clear();
+    staging_.clear();
+    staging_.reserve(options_.batchBytes * 2);
+    fileOffset_ = 0;
+    writeFailed_ = false;
+    stopRequested_ = false;
+    bytesWritten_.store(0, std::memory_order_relaxed);
+
+    FileHeader header;
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.reserved = 0;
+    Append(&header, sizeof(header));
+
+    open_.store(true, std::memory_order_release);
+    thread_ = std::thread(&CaptureTraceWriter::WriterLoop, this);
+    Logger::info("采集轨迹写入 %s", path.c_str());
+    return true;
+}
+
+int CaptureTraceWriter::AddStream(const std::string& name, int sampleRate, size_t channels) {
+    if (!IsOpen() || sampleRate <= 0 || channels == 0 || channels > 0xFFFF) {
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t index = streamCount_.load(std::memory_order_relaxed);
+    if (index >= kMaxStreams) {
+        Logger::error("采集轨迹最多记录 %zu 路流", kMaxStreams);
+        return -1;
+    }
+    const size_t queueBytes = static_cast<size_t>(static_cast<uint64_t>(sampleRate) * channels * sizeof(float) *
+                                                  options_.queueMilliseconds / 1000) + kQueueSlackBytes;
+    std::unique_ptr<Stream> stream(new Stream());
+    stream->queue.reset(new Queue(queueBytes));
+    stream->sampleRate = sampleRate;
+    stream->channels = channels;
+
+    // 注册记录放进该流自己的队列，保证写在它的第一块数据之前
+    const size_t nameLength = std::min<size_t>(name.size(), 0xFFFF);
+    const size_t size = Align8(sizeof(RecordHeader) + sizeof(StreamHeader) + nameLength);
+    const RecordHeader header = MakeHeader(RecordType::Stream, static_cast<int>(index), size,
+                                           PipelineMetrics::NowNanoseconds());
+    StreamHeader format;
+    format.sampleRate = static_cast<uint32_t>(sampleRate);
+    format.channels = static_cast<uint16_t>(channels);
+    format.textLength = static_cast<uint16_t>(nameLength);
+    const Part parts[] = {
+        {&header, sizeof(header)}, {&format, sizeof(format)}, {name.data(), nameLength},
+        {nullptr, size - sizeof(header) - sizeof(format) - nameLength}
+    };
+    stream->queue->Push(parts, 4);
+    streams_[index] = std::move(stream);
+    streamCount_.store(index + 1, std::memory_order_release);
+    return static_cast<int>(index);
+}
+
+bool CaptureTraceWriter::SetFormat(int stream, int sampleRate, size_t channels) {
+    if (stream < 0 || static_cast<size_t>(stream) >= streamCount_.load(std::memory_order_acquire) ||
+        sampleRate <= 0 || channels == 0 || channels > 0xFFFF) {
+        return false;
+    }
+    Stream& s = *streams_[stream];
+    s.sampleRate = sampleRate;
+    s.channels = channels;
+    const size_t size = Align8(sizeof(RecordHeader) + sizeof(StreamHeader));
+    const RecordHeader header = MakeHeader(RecordType::Format, stream, size, PipelineMetrics::NowNanoseconds());
+    StreamHeader format;
+    format.sampleRate = static_cast<uint32_t>(sampleRate);
+    format.channels = static_cast<uint16_t>(channels);
+    format.textLength = 0;
+    const Part parts[] = {
+        {&header, sizeof(header)}, {&format, sizeof(format)},
+        {nullptr, size - sizeof(header) - sizeof(format)}
+    };
+    return s.queue->Push(parts, 3);
+}
+
+bool CaptureTraceWriter::Record(int stream, const float* interleaved, size_t frames,
+                                const CaptureTimestamp& timestamp) {
+    if (!open_.load(std::memory_order_acquire) || stream < 0 ||
+        static_cast<size_t>(stream) >= streamCount_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    Stream& s = *streams_[stream];
+    const uint64_t now = PipelineMetrics::NowNanoseconds();
+
+    // 之前丢过数据时先补一条 Gap 记录，补不上说明队列仍然是满的，这块也丢掉
+    if (s.pendingGapFrames > 0) {
+        const RecordHeader gapHeader = MakeHeader(RecordType::Gap, stream, sizeof(RecordHeader) + sizeof(GapHeader), now);
+        GapHeader gap;
+        gap.frames = s.pendingGapFrames;
+        const Part gapParts[] = {{&gapHeader, sizeof(gapHeader)}, {&gap, sizeof(gap)}};
+        if (!s.queue->Push(gapParts, 2)) {
+            s.pendingGapFrames += frames;
+            s.droppedBlocks.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        s.pendingGapFrames = 0;
+    }
+
+    const size_t payload = frames * s.channels * sizeof(float);
+    const size_t size = Align8(sizeof(RecordHeader) + sizeof(BlockHeader) + payload);
+    const RecordHeader header = MakeHeader(RecordType::Block, stream, size, now);
+    BlockHeader block;
+    block.frames = static_cast<uint32_t>(frames);
+    block.sampleRate = static_cast<uint32_t>(s.sampleRate);
+    block.channels = static_cast<uint16_t>(s.channels);
+    block.reserved = 0;
+    block.timestampFlags = timestamp.flags;
+    block.hostNanos = timestamp.hostNanos;
+    block.sampleTime = timestamp.sampleTime;
+    const Part parts[] = {
+        {&header, sizeof(header)}, {&block, sizeof(block)}, {interleaved, payload},
+        {nullptr, size - sizeof(header) - sizeof(block) - payload}
+    };
+    if (!s.queue->Push(parts, 4)) {
+        s.pendingGapFrames += frames;
+        s.droppedBlocks.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    s.blocks.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void CaptureTraceWriter::Event(int stream, const std::string& text) {
+    if (!IsOpen()) {
+        return;
+    }
+    const size_t textLength = std::min<size_t>(text.size(), 0xFFFF);
+    const size_t size = Align8(sizeof(RecordHeader) + sizeof(StreamHeader) + textLength);
+    const RecordHeader header = MakeHeader(RecordType::Event, stream, size, PipelineMetrics::NowNanoseconds());
+    StreamHeader body = {};
+    body.textLength = static_cast<uint16_t>(textLength);
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t start = events_.size();
+    events_.resize(start + size, 0);
+    memcpy(events_.data() + start, &header, sizeof(header));
+    memcpy(events_.data() + start + sizeof(header), &body, sizeof(body));
+    memcpy(events_.data() + start + sizeof(header) + sizeof(body), text.data(), textLength);
+}
+
+void CaptureTraceWriter::Close() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopRequested_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+    open_.store(false, std::memory_order_release);
+    close(fd_);
+    fd_ = -1;
+
+    const Stats stats = GetStats();
+    Logger::info("采集轨迹 %s: %llu 块, 丢弃 %llu 块, %.1f MB", path_.c_str(),
+                 static_cast<unsigned long long>(stats.blocks), static_cast<unsigned long long>(stats.droppedBlocks),
+                 stats.bytesWritten / 1048576.0);
+}
+
+CaptureTraceWriter::Stats CaptureTraceWriter::GetStats() const {
+    Stats stats{};
+    const size_t count = streamCount_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i) {
+        stats.blocks += streams_[i]->blocks.load(std::memory_order_relaxed);
+        stats.droppedBlocks += streams_[i]->droppedBlocks.load(std::memory_order_relaxed);
+    }
+    stats.bytesWritten = bytesWritten_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void CaptureTraceWriter::WriterLoop() {
+    const auto poll = std::chrono::milliseconds(options_.pollMilliseconds);
+    for (;;) {
+        bool stop;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait_for(lock, poll, [this] { return stopRequested_; });
+            stop = stopRequested_;
+        }
+        // 停止时各采集线程已经不再写入，取空队列后退出
+        DrainQueues();
+        if (stop) {
+            DrainQueues();
+            Flush();
+            return;
+        }
+    }
+}
+
+bool CaptureTraceWriter::DrainQueues() {
+    std::vector<uint8_t> events;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        events.swap(events_);
+    }
+    Append(events.data(), events.size());
+
+    const size_t count = streamCount_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i) {
+        Queue& queue = *streams_[i]->queue;
+        const uint8_t* first;
+        const uint8_t* second;
+        size_t firstSize;
+        size_t secondSize;
+        const size_t available = queue.Peek(&first, &firstSize, &second, &secondSize);
+        Append(first, firstSize);
+        Append(second, secondSize);
+        queue.Consume(available);
+    }
+    return !writeFailed_;
+}
+
+bool CaptureTraceWriter::Append(const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        const size_t n = std::min(size, options_.batchBytes - std::min(options_.batchBytes, staging_.size()));
+        if (n == 0) {
+            Flush();
+            continue;
+        }
+        staging_.insert(staging_.end(), bytes, bytes + n);
+        bytes += n;
+        size -= n;
+    }
+    if (staging_.size() >= options_.batchBytes) {
+        Flush();
+    }
+    return !writeFailed_;
+}
+
+bool CaptureTraceWriter::Flush() {
+    if (staging_.empty()) {
+        return !writeFailed_;
+    }
+    // 写盘失败后继续取空队列，不让采集线程因为队列满而丢数据，但不再写文件
+    if (!writeFailed_) {
+        if (PWriteAll(fd_, staging_.data(), staging_.size(), fileOffset_)) {
+            fileOffset_ += staging_.size();
+            bytesWritten_.store(fileOffset_, std::memory_order_relaxed);
+        } else {
+            Logger::error("写入采集轨迹失败: %s", path_.c_str());
+            writeFailed_ = true;
+        }
+    }
+    staging_.clear();
+    return !writeFailed_;
+}
+
+CaptureTraceReader::CaptureTraceReader()
+    : mapping_(nullptr)
+    , mappingSize_(0) {
+}
+
+CaptureTraceReader::~CaptureTraceReader() {
+    Close();
+}
+
+bool CaptureTraceReader::Open(const std::string& path) {
+    Close();
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        Logger::error("无法打开采集轨迹: %s", path.c_str());
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(FileHeader)) {
+        Logger::error("采集轨迹过小: %s", path.c_str());
+        close(fd);
+        return false;
+    }
+    mappingSize_ = static_cast<size_t>(st.st_size);
+    mapping_ = mmap(nullptr, mappingSize_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping_ == MAP_FAILED) {
+        Logger::error("映射采集轨迹失败: %s", path.c_str());
+        mapping_ = nullptr;
+        mappingSize_ = 0;
+        return false;
+    }
+    if (!BuildIndex(path)) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void CaptureTraceReader::Close() {
+    if (mapping_) {
+        munmap(mapping_, mappingSize_);
+    }
+    mapping_ = nullptr;
+    mappingSize_ = 0;
+    index_.clear();
+    streams_.clear();
+}
+
+bool CaptureTraceReader::BuildIndex(const std::string& path) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(mapping_);
+    FileHeader file;
+    memcpy(&file, bytes, sizeof(file));
+    if (memcmp(file.magic, kMagic, sizeof(kMagic)) != 0) {
+        Logger::error("%s 不是采集轨迹", path.c_str());
+        return false;
+    }
+    if (file.version != kVersion) {
+        Logger::error("采集轨迹 %s 的版本 %u 不受支持", path.c_str(), file.version);
+        return false;
+    }
+
+    size_t pos = sizeof(FileHeader);
+    bool truncated = false;
+    while (pos + sizeof(RecordHeader) <= mappingSize_) {
+        RecordHeader header;
+        memcpy(&header, bytes + pos, sizeof(header));
+        if (header.size < sizeof(RecordHeader) || header.size % 8 != 0 || header.size > mappingSize_ - pos) {
+            truncated = true;
+            break;
+        }
+        index_.push_back({header.arrivalNanos, pos});
+        const Record record = GetRecord(index_.size() - 1);
+        const size_t body = header.size - sizeof(RecordHeader);
+        bool valid = true;
+        switch (record.type) {
+        case RecordType::Stream:
+        case RecordType::Format:
+        case RecordType::Event:
+            valid = body >= sizeof(StreamHeader) + record.textLength;
+            break;
+        case RecordType::Block:
+            valid = body >= sizeof(BlockHeader) + record.frames * record.channels * sizeof(float);
+            break;
+        case RecordType::Gap:
+            valid = body >= sizeof(GapHeader);
+            break;
+        default:
+            valid = false;
+            break;
+        }
+        if (!valid || (record.stream >= static_cast<int>(kMaxStreams))) {
+            Logger::warn("采集轨迹 %s 在偏移 %zu 处的记录无效，忽略之后的内容", path.c_str(), pos);
+            index_.pop_back();
+            truncated = true;
+            break;
+        }
+
+        if (record.stream >= 0 && static_cast<size_t>(record.stream) >= streams_.size()) {
+            streams_.resize(record.stream + 1, StreamInfo{"", 0, 0, 0, 0, 0, 0, 0});
+        }
+        StreamInfo* info = record.stream >= 0 ? &streams_[record.stream] : nullptr;
+        if (record.type == RecordType::Stream && info) {
+            info->name.assign(record.text, record.textLength);
+            info->sampleRate = record.sampleRate;
+            info->channels = record.channels;
+        } else if (record.type == RecordType::Format && info) {
+            ++info->formatChanges;
+        } else if (record.type == RecordType::Block && info) {
+            ++info->blocks;
+            info->frames += record.frames;
+            if (record.sampleRate == info->sampleRate && record.channels == info->channels) {
+                info->maxBlockFrames = std::max(info->maxBlockFrames, record.frames);
+            }
+        } else if (record.type == RecordType::Gap && info) {
+            info->gapFrames += record.gapFrames;
+        }
+        pos += header.size;
+    }
+    if (truncated || pos != mappingSize_) {
+        Logger::warn("采集轨迹 %s 末尾 %zu 字节不完整，已忽略", path.c_str(), mappingSize_ - pos);
+    }
+
+    // 各路队列分批写盘，文件中的顺序只在同一路内有效
+    std::stable_sort(index_.begin(), index_.end(),
+                     [](const Entry& a, const Entry& b) { return a.arrivalNanos < b.arrivalNanos; });
+    Logger::info("已映射采集轨迹 %s: %zu 路流, %zu 条记录", path.c_str(), streams_.size(), index_.size());
+    return true;
+}
+
+int CaptureTraceReader::FindStream(const std::string& name) const {
+    for (size_t i = 0; i < streams_.size(); ++i) {
+        if (streams_[i].name == name) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+CaptureTraceReader::Record CaptureTraceReader::GetRecord(size_t index) const {
+    const uint8_t* bytes = static_cast<const uint8_t*>(mapping_) + index_[index].offset;
+    RecordHeader header;
+    memcpy(&header, bytes, sizeof(header));
+    const uint8_t* body = bytes + sizeof(RecordHeader);
+
+    Record record = {};
+    record.type = static_cast<RecordType>(header.type);
+    record.stream = header.stream == kNoStream ? -1 : header.stream;
+    record.arrivalNanos = header.arrivalNanos;
+    switch (record.type) {
+    case RecordType::Stream:
+    case RecordType::Format:
+    case RecordType::Event: {
+        StreamHeader stream;
+        memcpy(&stream, body, sizeof(stream));
+        record.sampleRate = static_cast<int>(stream.sampleRate);
+        record.channels = stream.channels;
+        record.text = reinterpret_cast<const char*>(body + sizeof(stream));
+        record.textLength = stream.textLength;
+        break;
+    }
+    case RecordType::Block: {
+        BlockHeader block;
+        memcpy(&block, body, sizeof(block));
+        record.sampleRate = static_cast<int>(block.sampleRate);
+        record.channels = block.channels;
+        record.frames = block.frames;
+        // 记录 8 字节对齐，样本在映射区内按 float 对齐
+        record.samples = reinterpret_cast<const float*>(body + sizeof(block));
+        record.timestamp.flags = block.timestampFlags;
+        record.timestamp.hostNanos = block.hostNanos;
+        record.timestamp.sampleTime = block.sampleTime;
+        break;
+    }
+    case RecordType::Gap: {
+        GapHeader gap;
+        memcpy(&gap, body, sizeof(gap));
+        record.gapFrames = gap.frames;
+        break;
+    }
+    }
+    return record;
+}
+
+uint64_t CaptureTraceReader::DurationNanos() const {
+    return index_.empty() ? 0 : index_.back().arrivalNanos - index_.front().arrivalNanos;
+}
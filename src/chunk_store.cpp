@@ -0,0 +1,549 @@
+#include "chunk_store.h"
+#include "crc32c.h"
+#include "logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint32_t kVersion = 1;
+constexpr size_t kCopyBufferSize = 1 << 20;
+
+// 块文件头，位于文件开头，按本机字节序（小端）存放
+struct ChunkHeader {
+    char magic[4];          // "RCHK"
+    uint32_t version;
+    uint32_t sequence;
+    uint32_t sampleRate;
+    uint16_t channels;
+    uint16_t bytesPerSample;
+    uint32_t chunkFrames;
+    uint64_t frames;        // 已提交的帧数，每次提交后更新
+    uint32_t crc;           // 封存时写入
+    uint32_t sealed;
+};
+
+// 索引文件由一个文件头和若干条块记录组成，每条 32 字节，最后 4 字节是前 28 字节的 CRC32C，
+// 单次 write 追加；断电导致的半条记录在读取时因校验失败被忽略
+struct IndexHeader {
+    char magic[4];          // "RIDX"
+    uint32_t version;
+    uint32_t sampleRate;
+    uint16_t channels;
+    uint16_t bytesPerSample;
+    uint32_t chunkFrames;
+    uint32_t reserved[2];
+    uint32_t check;
+};
+
+struct IndexRecord {
+    char magic[4];          // "RSEG"
+    uint32_t sequence;
+    uint64_t frames;
+    uint32_t crc;
+    uint32_t reserved[2];
+    uint32_t check;
+};
+
+static_assert(sizeof(ChunkHeader) <= ChunkStore::kDataOffset, "块头超出预留空间");
+static_assert(sizeof(IndexHeader) == 32 && sizeof(IndexRecord) == 32, "索引记录必须为 32 字节");
+
+template <typename T>
+uint32_t RecordCheck(const T& record) {
+    return Crc32c::Compute(&record, sizeof(T) - sizeof(uint32_t));
+}
+
+std::string IndexPath(const std::string& directory) {
+    return directory + "/index";
+}
+
+std::string ChunkPath(const std::string& directory, uint32_t sequence) {
+    char name[32];
+    snprintf(name, sizeof(name), "/%08u.chunk", sequence);
+    return directory + name;
+}
+
+size_t PageSize() {
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+bool SyncFile(int fd) {
+#if defined(__APPLE__)
+    return fsync(fd) == 0;
+#else
+    return fdatasync(fd) == 0;
+#endif
+}
+
+// 目录项本身也要落盘，否则断电后新建的文件可能不可见
+void SyncDirectory(const std::string& directory) {
+    const int fd = open(directory.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+bool WriteAll(int fd, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        ssize_t n = write(fd, bytes, size);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        bytes += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool ReadAt(int fd, void* data, size_t size, uint64_t offset) {
+    uint8_t* bytes = static_cast<uint8_t*>(data);
+    while (size > 0) {
+        ssize_t n = pread(fd, bytes, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        bytes += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+// 在文件系统上占好空间，避免写映射内存时因磁盘满收到 SIGBUS
+bool Reserve(int fd, uint64_t size) {
+#if defined(__linux__)
+    const int result = posix_fallocate(fd, 0, static_cast<off_t>(size));
+    if (result != 0 && result != EOPNOTSUPP && result != EINVAL) {
+        errno = result;
+        return false;
+    }
+#elif defined(__APPLE__)
+    fstore_t store = {F_ALLOCATEALL, F_PEOFPOSMODE, 0, static_cast<off_t>(size), 0};
+    if (fcntl(fd, F_PREALLOCATE, &store) == -1 && errno == ENOSPC) {
+        return false;
+    }
+#endif
+    return ftruncate(fd, static_cast<off_t>(size)) == 0;
+}
+
+bool CopyRange(int from, uint64_t fromOffset, int to, uint64_t toOffset, uint64_t size,
+               std::vector<uint8_t>& buffer) {
+#if defined(__linux__)
+    // copy_file_range 在内核内完成，支持的文件系统上还会直接共享数据块
+    while (size > 0) {
+        loff_t in = static_cast<loff_t>(fromOffset);
+        loff_t out = static_cast<loff_t>(toOffset);
+        ssize_t n = copy_file_range(from, &in, to, &out, static_cast<size_t>(size), 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;   // 跨文件系统等情况退回到普通读写
+        }
+        fromOffset += static_cast<uint64_t>(n);
+        toOffset += static_cast<uint64_t>(n);
+        size -= static_cast<uint64_t>(n);
+    }
+#endif
+    if (size > 0 && buffer.empty()) {
+        buffer.resize(kCopyBufferSize);
+    }
+    while (size > 0) {
+        const size_t n = static_cast<size_t>(std::min<uint64_t>(size, buffer.size()));
+        if (!ReadAt(from, buffer.data(), n, fromOffset)) {
+            return false;
+        }
+        const uint8_t* bytes = buffer.data();
+        size_t left = n;
+        uint64_t offset = toOffset;
+        while (left > 0) {
+            ssize_t written = pwrite(to, bytes, left, static_cast<off_t>(offset));
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            bytes += written;
+            left -= static_cast<size_t>(written);
+            offset += static_cast<uint64_t>(written);
+        }
+        fromOffset += n;
+        toOffset += n;
+        size -= n;
+    }
+    return true;
+}
+
+// 重新计算块文件中 bytes 字节音频数据的 CRC32C
+bool ChunkCrc(const std::string& path, uint64_t bytes, uint32_t* crc) {
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    std::vector<uint8_t> buffer(std::min<uint64_t>(bytes, kCopyBufferSize));
+    uint32_t value = 0;
+    uint64_t offset = ChunkStore::kDataOffset;
+    bool ok = true;
+    while (bytes > 0) {
+        const size_t n = static_cast<size_t>(std::min<uint64_t>(bytes, buffer.size()));
+        if (!ReadAt(fd, buffer.data(), n, offset)) {
+            ok = false;
+            break;
+        }
+        value = Crc32c::Extend(value, buffer.data(), n);
+        offset += n;
+        bytes -= n;
+    }
+    close(fd);
+    *crc = value;
+    return ok;
+}
+
+bool ReadChunkHeader(const std::string& path, ChunkHeader* header, uint64_t* fileSize) {
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    const bool ok = fstat(fd, &st) == 0 && ReadAt(fd, header, sizeof(*header), 0);
+    close(fd);
+    *fileSize = ok ? static_cast<uint64_t>(st.st_size) : 0;
+    return ok && memcmp(header->magic, "RCHK", 4) == 0 && header->version == kVersion;
+}
+
+} // namespace
+
+ChunkStore::ChunkStore()
+    : bytesPerFrame_(0)
+    , indexFd_(-1)
+    , chunkFd_(-1)
+    , mapping_(nullptr)
+    , mappingSize_(0)
+    , sequence_(0)
+    , activeFrames_(0)
+    , sealedFrames_(0) {
+}
+
+ChunkStore::~ChunkStore() {
+    Close();
+}
+
+bool ChunkStore::Create(const std::string& directory, const Format& format) {
+    if (format.sampleRate == 0 || format.channels == 0 || format.chunkFrames == 0 ||
+        (format.bytesPerSample != 2 && format.bytesPerSample != 4)) {
+        Logger::error("无效的分段格式");
+        return false;
+    }
+    if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+        Logger::error("创建分段目录失败: %s (%s)", directory.c_str(), strerror(errno));
+        return false;
+    }
+    if (access(IndexPath(directory).c_str(), F_OK) == 0) {
+        Logger::error("分段目录中已有录音: %s", directory.c_str());
+        return false;
+    }
+
+    directory_ = directory;
+    format_ = format;
+    bytesPerFrame_ = static_cast<size_t>(format.channels) * format.bytesPerSample;
+    sequence_ = 0;
+    activeFrames_ = 0;
+    sealedFrames_ = 0;
+
+    indexFd_ = open(IndexPath(directory).c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (indexFd_ < 0) {
+        Logger::error("创建分段索引失败: %s (%s)", directory.c_str(), strerror(errno));
+        return false;
+    }
+    IndexHeader header = {};
+    memcpy(header.magic, "RIDX", 4);
+    header.version = kVersion;
+    header.sampleRate = format.sampleRate;
+    header.channels = format.channels;
+    header.bytesPerSample = format.bytesPerSample;
+    header.chunkFrames = format.chunkFrames;
+    header.check = RecordCheck(header);
+    if (!WriteAll(indexFd_, &header, sizeof(header)) || !SyncFile(indexFd_)) {
+        Logger::error("写入分段索引失败: %s (%s)", directory.c_str(), strerror(errno));
+        close(indexFd_);
+        indexFd_ = -1;
+        return false;
+    }
+    if (!MapChunk(0)) {
+        close(indexFd_);
+        indexFd_ = -1;
+        return false;
+    }
+    SyncDirectory(directory);
+    return true;
+}
+
+uint8_t* ChunkStore::WritePointer() const {
+    return mapping_ ? mapping_ + kDataOffset + activeFrames_ * bytesPerFrame_ : nullptr;
+}
+
+size_t ChunkStore::WritableFrames() const {
+    return mapping_ ? static_cast<size_t>(format_.chunkFrames - activeFrames_) : 0;
+}
+
+bool ChunkStore::Commit(size_t frames) {
+    if (!mapping_) {
+        return false;
+    }
+    activeFrames_ += std::min(frames, WritableFrames());
+    // 数据先于帧数对其它观察者可见；崩溃后由页缓存保留，只靠这一次内存写入
+    ChunkHeader* header = reinterpret_cast<ChunkHeader*>(mapping_);
+    __atomic_store_n(&header->frames, activeFrames_, __ATOMIC_RELEASE);
+    if (activeFrames_ < format_.chunkFrames) {
+        return true;
+    }
+    const bool sealed = SealChunk();
+    UnmapChunk();
+    return sealed && MapChunk(sequence_ + 1);
+}
+
+bool ChunkStore::Close() {
+    if (indexFd_ < 0) {
+        return true;
+    }
+    bool ok = true;
+    if (mapping_) {
+        if (activeFrames_ == 0 && sequence_ > 0) {
+            // 上一个块恰好写满时已映射的空块
+            UnmapChunk();
+            unlink(ChunkPath(directory_, sequence_).c_str());
+        } else {
+            ok = SealChunk();
+            UnmapChunk();
+        }
+    }
+    close(indexFd_);
+    indexFd_ = -1;
+    return ok;
+}
+
+bool ChunkStore::MapChunk(uint32_t sequence) {
+    const std::string path = ChunkPath(directory_, sequence);
+    chunkFd_ = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (chunkFd_ < 0) {
+        Logger::error("创建块文件失败: %s (%s)", path.c_str(), strerror(errno));
+        return false;
+    }
+    const size_t page = PageSize();
+    const size_t size = (kDataOffset + static_cast<size_t>(format_.chunkFrames) * bytesPerFrame_ + page - 1) &
+                        ~(page - 1);
+    if (!Reserve(chunkFd_, size)) {
+        Logger::error("预分配块文件失败: %s (%s)", path.c_str(), strerror(errno));
+        close(chunkFd_);
+        chunkFd_ = -1;
+        return false;
+    }
+
+    int flags = MAP_SHARED;
+#if defined(MAP_POPULATE)
+    flags |= MAP_POPULATE;   // 提前建立页表，写入时不再缺页
+#endif
+    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, chunkFd_, 0);
+    if (mapping == MAP_FAILED) {
+        Logger::error("映射块文件失败: %s (%s)", path.c_str(), strerror(errno));
+        close(chunkFd_);
+        chunkFd_ = -1;
+        return false;
+    }
+    mapping_ = static_cast<uint8_t*>(mapping);
+    mappingSize_ = size;
+    sequence_ = sequence;
+    activeFrames_ = 0;
+
+    ChunkHeader* header = reinterpret_cast<ChunkHeader*>(mapping_);
+    memcpy(header->magic, "RCHK", 4);
+    header->version = kVersion;
+    header->sequence = sequence;
+    header->sampleRate = format_.sampleRate;
+    header->channels = format_.channels;
+    header->bytesPerSample = format_.bytesPerSample;
+    header->chunkFrames = format_.chunkFrames;
+    header->frames = 0;
+    header->crc = 0;
+    header->sealed = 0;
+    return true;
+}
+
+bool ChunkStore::SealChunk() {
+    const uint64_t bytes = activeFrames_ * bytesPerFrame_;
+    const uint32_t crc = Crc32c::Compute(mapping_ + kDataOffset, static_cast<size_t>(bytes));
+    ChunkHeader* header = reinterpret_cast<ChunkHeader*>(mapping_);
+    header->crc = crc;
+    header->sealed = 1;
+
+    const size_t page = PageSize();
+    const size_t used = (kDataOffset + static_cast<size_t>(bytes) + page - 1) & ~(page - 1);
+    bool ok = msync(mapping_, std::min(used, mappingSize_), MS_SYNC) == 0;
+
+    // 不满的块（最后一块）截掉预分配的部分
+    if (activeFrames_ < format_.chunkFrames) {
+        munmap(mapping_, mappingSize_);
+        mapping_ = nullptr;
+        ok = ftruncate(chunkFd_, static_cast<off_t>(kDataOffset + bytes)) == 0 && ok;
+    }
+
+    // 块数据落盘之后才追加索引记录，索引中出现的块一定是完整的
+    IndexRecord record = {};
+    memcpy(record.magic, "RSEG", 4);
+    record.sequence = sequence_;
+    record.frames = activeFrames_;
+    record.crc = crc;
+    record.check = RecordCheck(record);
+    ok = ok && WriteAll(indexFd_, &record, sizeof(record)) && SyncFile(indexFd_);
+    if (!ok) {
+        Logger::error("封存块失败: %s (%s)", ChunkPath(directory_, sequence_).c_str(), strerror(errno));
+        return false;
+    }
+    sealedFrames_ += activeFrames_;
+    activeFrames_ = 0;
+    return true;
+}
+
+void ChunkStore::UnmapChunk() {
+    if (mapping_) {
+        munmap(mapping_, mappingSize_);
+        mapping_ = nullptr;
+    }
+    if (chunkFd_ >= 0) {
+        close(chunkFd_);
+        chunkFd_ = -1;
+    }
+    mappingSize_ = 0;
+}
+
+bool ChunkStore::Load(const std::string& directory, bool verify, Listing* listing) {
+    *listing = Listing();
+    const int fd = open(IndexPath(directory).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        Logger::error("打开分段索引失败: %s (%s)", directory.c_str(), strerror(errno));
+        return false;
+    }
+    struct stat st;
+    IndexHeader header;
+    if (fstat(fd, &st) != 0 || !ReadAt(fd, &header, sizeof(header), 0) ||
+        memcmp(header.magic, "RIDX", 4) != 0 || header.version != kVersion || header.check != RecordCheck(header)) {
+        Logger::error("分段索引已损坏: %s", directory.c_str());
+        close(fd);
+        return false;
+    }
+    Format& format = listing->format;
+    format.sampleRate = header.sampleRate;
+    format.channels = header.channels;
+    format.bytesPerSample = header.bytesPerSample;
+    format.chunkFrames = header.chunkFrames;
+    const uint64_t bytesPerFrame = static_cast<uint64_t>(format.channels) * format.bytesPerSample;
+
+    // 已封存的块：以索引为准，遇到第一条不完整的记录即停止
+    const size_t records = (static_cast<uint64_t>(st.st_size) - sizeof(header)) / sizeof(IndexRecord);
+    std::vector<IndexRecord> entries(records);
+    const bool readOk = records == 0 || ReadAt(fd, entries.data(), records * sizeof(IndexRecord), sizeof(header));
+    close(fd);
+    if (!readOk) {
+        Logger::error("读取分段索引失败: %s", directory.c_str());
+        return false;
+    }
+
+    uint32_t next = 0;
+    for (const IndexRecord& record : entries) {
+        if (memcmp(record.magic, "RSEG", 4) != 0 || record.check != RecordCheck(record) ||
+            record.sequence != next || record.frames > format.chunkFrames) {
+            Logger::warn("分段索引在第 %u 条记录处截断", next);
+            break;
+        }
+        Chunk chunk = {ChunkPath(directory, record.sequence), record.sequence, record.frames, record.crc, true, true};
+        if (verify) {
+            uint32_t crc = 0;
+            chunk.intact = ChunkCrc(chunk.path, record.frames * bytesPerFrame, &crc) && crc == record.crc;
+        }
+        listing->chunks.push_back(chunk);
+        ++next;
+    }
+
+    // 索引之后的块：崩溃时正在写入（或已封存但还没来得及写索引），以块头里的帧数为准
+    for (;; ++next) {
+        const std::string path = ChunkPath(directory, next);
+        ChunkHeader chunkHeader;
+        uint64_t fileSize = 0;
+        if (!ReadChunkHeader(path, &chunkHeader, &fileSize)) {
+            break;
+        }
+        if (chunkHeader.sequence != next || chunkHeader.sampleRate != format.sampleRate ||
+            chunkHeader.channels != format.channels || chunkHeader.bytesPerSample != format.bytesPerSample) {
+            Logger::warn("块文件格式与索引不一致: %s", path.c_str());
+            break;
+        }
+        uint64_t frames = std::min<uint64_t>(chunkHeader.frames, format.chunkFrames);
+        frames = std::min<uint64_t>(frames, fileSize > kDataOffset ? (fileSize - kDataOffset) / bytesPerFrame : 0);
+        if (frames == 0) {
+            break;
+        }
+        Chunk chunk = {path, next, frames, chunkHeader.crc, false, true};
+        if (verify && chunkHeader.sealed) {
+            uint32_t crc = 0;
+            chunk.intact = ChunkCrc(path, frames * bytesPerFrame, &crc) && crc == chunkHeader.crc;
+        }
+        listing->chunks.push_back(chunk);
+    }
+
+    for (const Chunk& chunk : listing->chunks) {
+        listing->frames += chunk.frames;
+        if (!chunk.intact) {
+            ++listing->corruptChunks;
+            Logger::warn("块文件校验失败: %s", chunk.path.c_str());
+        }
+    }
+    return true;
+}
+
+bool ChunkStore::Export(const Listing& listing, int fd, uint64_t offset) {
+    const uint64_t bytesPerFrame = static_cast<uint64_t>(listing.format.channels) * listing.format.bytesPerSample;
+    std::vector<uint8_t> buffer;
+    for (const Chunk& chunk : listing.chunks) {
+        const int chunkFd = open(chunk.path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (chunkFd < 0) {
+            Logger::error("打开块文件失败: %s (%s)", chunk.path.c_str(), strerror(errno));
+            return false;
+        }
+        const uint64_t bytes = chunk.frames * bytesPerFrame;
+        const bool ok = CopyRange(chunkFd, kDataOffset, fd, offset, bytes, buffer);
+        close(chunkFd);
+        if (!ok) {
+            Logger::error("拷贝块文件失败: %s (%s)", chunk.path.c_str(), strerror(errno));
+            return false;
+        }
+        offset += bytes;
+    }
+    return true;
+}
+
+bool ChunkStore::Remove(const std::string& directory) {
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+    if (error) {
+        Logger::warn("删除分段目录失败: %s (%s)", directory.c_str(), error.message().c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,66 @@
+#include "control_thread.h"
+#include "logger.h"
+#include <exception>
+
+ControlThread::ControlThread()
+    : stopRequested_(false)
+    , detached_(false)
+    , thread_(&ControlThread::Loop, this) {
+}
+
+ControlThread::~ControlThread() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopRequested_ = true;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void ControlThread::Post(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+}
+
+void ControlThread::Detach() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopRequested_ = true;
+        detached_ = true;
+    }
+    cv_.notify_one();
+}
+
+void ControlThread::Loop() {
+    for (;;) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stopRequested_ || !tasks_.empty(); });
+            if (tasks_.empty()) {
+                if (detached_) {
+                    // 析构函数不能在本线程上 join 自己，先分离再释放
+                    lock.unlock();
+                    thread_.detach();
+                    delete this;
+                    return;
+                }
+                break;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+
+        // 单条命令失败不影响后续命令
+        try {
+            task();
+        } catch (const std::exception& e) {
+            Logger::error("控制命令异常: %s", e.what());
+        }
+    }
+}
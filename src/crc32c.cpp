@@ -0,0 +1,109 @@
+#include "crc32c.h"
+#include "crc32c_internal.h"
+#include <atomic>
+#include <cstring>
+
+#if defined(__linux__) && defined(__aarch64__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+
+namespace Crc32c {
+namespace internal {
+
+namespace {
+
+constexpr uint32_t kPolynomial = 0x82F63B78u;  // 0x1EDC6F41 的位反转
+
+// slicing-by-8：table[k][b] 为字节 b 之后再跟 k 个零字节的 CRC
+struct Tables {
+    uint32_t table[8][256];
+
+    Tables() {
+        for (uint32_t b = 0; b < 256; ++b) {
+            uint32_t crc = b;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ ((crc & 1) ? kPolynomial : 0);
+            }
+            table[0][b] = crc;
+        }
+        for (uint32_t b = 0; b < 256; ++b) {
+            for (int k = 1; k < 8; ++k) {
+                table[k][b] = (table[k - 1][b] >> 8) ^ table[0][table[k - 1][b] & 0xFF];
+            }
+        }
+    }
+};
+
+const Tables& GetTables() {
+    static const Tables tables;
+    return tables;
+}
+
+} // namespace
+
+uint32_t ExtendScalar(uint32_t state, const uint8_t* data, size_t size) {
+    const auto& t = GetTables().table;
+    while (size >= 8) {
+        uint32_t lo;
+        uint32_t hi;
+        memcpy(&lo, data, 4);
+        memcpy(&hi, data + 4, 4);
+        lo ^= state;
+        state = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+                t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+        data += 8;
+        size -= 8;
+    }
+    while (size-- > 0) {
+        state = (state >> 8) ^ t[0][(state ^ *data++) & 0xFF];
+    }
+    return state;
+}
+
+} // namespace internal
+
+namespace {
+
+using internal::ExtendFunction;
+
+struct Implementation {
+    ExtendFunction extend;
+    const char* name;
+};
+
+Implementation Detect() {
+#if defined(__x86_64__) || defined(__i386__)
+    if (internal::Sse42Extend() && __builtin_cpu_supports("sse4.2")) {
+        return {internal::Sse42Extend(), "sse4.2"};
+    }
+#elif defined(__aarch64__)
+#if defined(__linux__)
+    const bool armCrc = (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+#else
+    const bool armCrc = true;   // Apple Silicon 均支持 CRC 扩展
+#endif
+    if (internal::ArmExtend() && armCrc) {
+        return {internal::ArmExtend(), "arm-crc"};
+    }
+#endif
+    // 小端假设：标量实现按小端读取 8 字节
+    return {internal::ExtendScalar, "scalar"};
+}
+
+const Implementation& Active() {
+    static const Implementation implementation = Detect();
+    return implementation;
+}
+
+} // namespace
+
+uint32_t Extend(uint32_t crc, const void* data, size_t size) {
+    return ~Active().extend(~crc, static_cast<const uint8_t*>(data), size);
+}
+
+const char* ImplementationName() {
+    return Active().name;
+}
+
+} // namespace Crc32c
@@ -0,0 +1,63 @@
+#include "crc32c_internal.h"
+
+// Linux 上本文件单独以 -march=armv8-a+crc 编译，运行时检测到 CRC 扩展才会被调用
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+
+#include <arm_acle.h>
+#include <cstring>
+
+namespace Crc32c {
+namespace internal {
+
+namespace {
+
+uint32_t ExtendArm(uint32_t state, const uint8_t* data, size_t size) {
+    while (size > 0 && (reinterpret_cast<uintptr_t>(data) & 7) != 0) {
+        state = __crc32cb(state, *data++);
+        --size;
+    }
+    while (size >= 32) {
+        uint64_t v[4];
+        memcpy(v, data, sizeof(v));
+        state = __crc32cd(state, v[0]);
+        state = __crc32cd(state, v[1]);
+        state = __crc32cd(state, v[2]);
+        state = __crc32cd(state, v[3]);
+        data += 32;
+        size -= 32;
+    }
+    while (size >= 8) {
+        uint64_t v;
+        memcpy(&v, data, sizeof(v));
+        state = __crc32cd(state, v);
+        data += 8;
+        size -= 8;
+    }
+    while (size-- > 0) {
+        state = __crc32cb(state, *data++);
+    }
+    return state;
+}
+
+} // namespace
+
+ExtendFunction ArmExtend() {
+    return ExtendArm;
+}
+
+} // namespace internal
+} // namespace Crc32c
+
+#else
+
+namespace Crc32c {
+namespace internal {
+
+ExtendFunction ArmExtend() {
+    return nullptr;
+}
+
+} // namespace internal
+} // namespace Crc32c
+
+#endif
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 各指令集实现共用的声明，只在 crc32c*.cpp 内部使用
+namespace Crc32c {
+namespace internal {
+
+// state 为取反后的中间值，调用方负责首尾取反
+using ExtendFunction = uint32_t (*)(uint32_t state, const uint8_t* data, size_t size);
+
+uint32_t ExtendScalar(uint32_t state, const uint8_t* data, size_t size);
+
+// 未针对当前架构编译时返回 nullptr
+ExtendFunction Sse42Extend();
+ExtendFunction ArmExtend();
+
+} // namespace internal
+} // namespace Crc32c
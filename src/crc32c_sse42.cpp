@@ -0,0 +1,74 @@
+#include "crc32c_internal.h"
+
+// 本文件单独以 -msse4.2 编译，只有运行时检测到 SSE4.2 才会被调用
+#if defined(__SSE4_2__)
+
+#include <cstring>
+#include <nmmintrin.h>
+
+namespace Crc32c {
+namespace internal {
+
+namespace {
+
+uint32_t ExtendSse42(uint32_t state, const uint8_t* data, size_t size) {
+    while (size > 0 && (reinterpret_cast<uintptr_t>(data) & 7) != 0) {
+        state = _mm_crc32_u8(state, *data++);
+        --size;
+    }
+#if defined(__x86_64__)
+    uint64_t state64 = state;
+    while (size >= 32) {
+        uint64_t v[4];
+        memcpy(v, data, sizeof(v));
+        state64 = _mm_crc32_u64(state64, v[0]);
+        state64 = _mm_crc32_u64(state64, v[1]);
+        state64 = _mm_crc32_u64(state64, v[2]);
+        state64 = _mm_crc32_u64(state64, v[3]);
+        data += 32;
+        size -= 32;
+    }
+    while (size >= 8) {
+        uint64_t v;
+        memcpy(&v, data, sizeof(v));
+        state64 = _mm_crc32_u64(state64, v);
+        data += 8;
+        size -= 8;
+    }
+    state = static_cast<uint32_t>(state64);
+#endif
+    while (size >= 4) {
+        uint32_t v;
+        memcpy(&v, data, sizeof(v));
+        state = _mm_crc32_u32(state, v);
+        data += 4;
+        size -= 4;
+    }
+    while (size-- > 0) {
+        state = _mm_crc32_u8(state, *data++);
+    }
+    return state;
+}
+
+} // namespace
+
+ExtendFunction Sse42Extend() {
+    return ExtendSse42;
+}
+
+} // namespace internal
+} // namespace Crc32c
+
+#else
+
+namespace Crc32c {
+namespace internal {
+
+ExtendFunction Sse42Extend() {
+    return nullptr;
+}
+
+} // namespace internal
+} // namespace Crc32c
+
+#endif
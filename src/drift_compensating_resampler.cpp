@@ -0,0 +1,294 @@
+#include "drift_compensating_resampler.h"
+#include "logger.h"
+#include "common_audio/resampler/sinc_resampler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// 水位平滑时间常数，需远大于生产者回调间隔，滤掉按块到达造成的锯齿
+constexpr double kFillSmoothingSeconds = 1.0;
+
+// 启动后先以名义比例运行这么久，取平均延迟作为控制目标
+// 生产者按块到达，启动瞬间的水位落在锯齿的哪个位置是随机的，直接当目标会在之后慢慢拉偏对齐
+constexpr double kWarmupSeconds = 2.0;
+
+// PI 控制器参数（误差单位为秒，输出为比例修正）
+// 闭环自然频率约 0.02 rad/s、临界阻尼：调整慢到听不出音高变化，又能在一分钟内跟上漂移
+constexpr double kProportionalGain = 0.1;
+constexpr double kIntegralGain = 0.0025;
+
+// SetRatio 会重算整张 sinc 内核表（开销约为一个 10ms 块重采样的数倍），
+// 控制环带宽远低于 1 Hz，每 100ms 更新一次比例已足够；变化小于 0.1 ppm 时跳过
+constexpr double kRatioUpdateSeconds = 0.1;
+constexpr double kRatioUpdateThreshold = 1e-7;
+
+// 一次子块重采样内 SincResampler 最多回调两次（首次预填充 + 一次补充）
+constexpr size_t kMaxChunksPerBlock = 2;
+
+} // namespace
+
+// 每个声道一个 SincResampler；声道 0 的回调从 FIFO 读数据，其余声道复用同一批数据
+class DriftCompensatingResampler::ChannelReader : public webrtc::SincResamplerCallback {
+public:
+    ChannelReader(DriftCompensatingResampler* owner, size_t channel, double ratio, size_t requestFrames)
+        : owner_(owner)
+        , channel_(channel)
+        , chunkIndex_(0)
+        , resampler_(ratio, requestFrames, this) {
+    }
+
+    void Run(size_t frames, float* destination) override {
+        if (channel_ == 0) {
+            owner_->ReadChunk(frames);
+        }
+        const size_t channels = owner_->options_.channels;
+        const float* chunk = owner_->chunk_.data() + std::min(chunkIndex_, kMaxChunksPerBlock - 1) * frames * channels;
+        for (size_t i = 0; i < frames; ++i) {
+            destination[i] = chunk[i * channels + channel_];
+        }
+        ++chunkIndex_;
+    }
+
+    void Resample(size_t frames, float* destination) {
+        chunkIndex_ = 0;
+        resampler_.Resample(frames, destination);
+    }
+
+    webrtc::SincResampler& resampler() { return resampler_; }
+
+private:
+    DriftCompensatingResampler* owner_;
+    size_t channel_;
+    size_t chunkIndex_;
+    webrtc::SincResampler resampler_;
+};
+
+DriftCompensatingResampler::DriftCompensatingResampler()
+    : initialized_(false)
+    , nominalRatio_(1.0)
+    , ratio_(1.0)
+    , integral_(0.0)
+    , filteredLatency_(0.0)
+    , targetLatency_(0.0)
+    , warmupSum_(0.0)
+    , warmupFrames_(0)
+    , warmupTotal_(0)
+    , sinceRatioUpdate_(0)
+    , chunkCount_(0)
+    , primed_(false)
+    , inputFrames_(0)
+    , outputFrames_(0)
+    , underruns_(0)
+    , skippedFrames_(0)
+    , framesRead_(0)
+    , consumedFrames_(0.0)
+    , correctionPpm_(0.0) {
+}
+
+DriftCompensatingResampler::~DriftCompensatingResampler() = default;
+
+bool DriftCompensatingResampler::Initialize(const Options& options) {
+    initialized_.store(false, std::memory_order_release);
+
+    if (options.inputRate <= 0 || options.outputRate <= 0 || options.channels == 0) {
+        Logger::error("漂移补偿参数无效: %d -> %d Hz, %zu 声道",
+                      options.inputRate, options.outputRate, options.channels);
+        return false;
+    }
+    if (options.requestFrames <= webrtc::SincResampler::kKernelSize || options.maxPullFrames == 0) {
+        Logger::error("漂移补偿请求帧数无效: %zu", options.requestFrames);
+        return false;
+    }
+    const size_t targetFrames = static_cast<size_t>(options.inputRate) * options.targetLatencyMs / 1000;
+    const size_t capacityFrames = static_cast<size_t>(options.inputRate) * options.capacityMs / 1000;
+    if (capacityFrames < targetFrames * 2) {
+        Logger::error("漂移补偿 FIFO 容量 %u ms 不足以容纳目标水位 %u ms 的两倍",
+                      options.capacityMs, options.targetLatencyMs);
+        return false;
+    }
+
+    options_ = options;
+    nominalRatio_ = static_cast<double>(options.inputRate) / options.outputRate;
+    ratio_ = nominalRatio_;
+    integral_ = 0.0;
+    filteredLatency_ = 0.0;
+    targetLatency_ = static_cast<double>(targetFrames);
+    warmupSum_ = 0.0;
+    warmupFrames_ = 0;
+    warmupTotal_ = 0;
+    sinceRatioUpdate_ = 0;
+    chunkCount_ = 0;
+    primed_ = false;
+
+    fifo_.reset(new RingBuffer(capacityFrames * options.channels, RingBuffer::OverflowPolicy::DropOldest));
+    chunk_.assign(kMaxChunksPerBlock * options.requestFrames * options.channels, 0.0f);
+    planarOut_.assign(options.maxPullFrames, 0.0f);
+    readers_.clear();
+    for (size_t ch = 0; ch < options.channels; ++ch) {
+        readers_.emplace_back(new ChannelReader(this, ch, nominalRatio_, options.requestFrames));
+    }
+
+    inputFrames_.store(0, std::memory_order_relaxed);
+    outputFrames_.store(0, std::memory_order_relaxed);
+    underruns_.store(0, std::memory_order_relaxed);
+    skippedFrames_.store(0, std::memory_order_relaxed);
+    framesRead_.store(0, std::memory_order_relaxed);
+    consumedFrames_.store(0.0, std::memory_order_relaxed);
+    correctionPpm_.store(0.0, std::memory_order_relaxed);
+
+    Logger::info("漂移补偿已初始化: %d -> %d Hz, %zu 声道, 目标水位 %u ms",
+                 options.inputRate, options.outputRate, options.channels, options.targetLatencyMs);
+    initialized_.store(true, std::memory_order_release);
+    return true;
+}
+
+void DriftCompensatingResampler::Push(const float* interleaved, size_t frames) {
+    if (!initialized_.load(std::memory_order_acquire) || frames == 0) {
+        return;
+    }
+    fifo_->write(interleaved, frames * options_.channels);
+    inputFrames_.fetch_add(frames, std::memory_order_release);
+}
+
+void DriftCompensatingResampler::ReadChunk(size_t frames) {
+    const size_t channels = options_.channels;
+    if (chunkCount_ >= kMaxChunksPerBlock) {
+        return;
+    }
+    float* dst = chunk_.data() + chunkCount_ * frames * channels;
+    ++chunkCount_;
+    framesRead_.store(framesRead_.load(std::memory_order_relaxed) + frames, std::memory_order_relaxed);
+
+    const size_t wanted = frames * channels;
+    if (fifo_->read(dst, wanted)) {
+        return;
+    }
+    // 数据不足时取出现有的部分，剩余补静音
+    const size_t available = (fifo_->available_read() / channels) * channels;
+    if (available > 0) {
+        fifo_->read(dst, available);
+    }
+    std::fill(dst + available, dst + wanted, 0.0f);
+    underruns_.fetch_add(1, std::memory_order_relaxed);
+}
+
+// FIFO 水位加上重采样器内部已读入但未消耗的部分
+// 只用消费者能看到的量计算，不受生产者写入与计数更新之间的时间差影响
+double DriftCompensatingResampler::LatencyFrames() const {
+    return static_cast<double>(fifo_->available_read() / options_.channels) +
+           static_cast<double>(framesRead_.load(std::memory_order_relaxed)) -
+           consumedFrames_.load(std::memory_order_relaxed);
+}
+
+void DriftCompensatingResampler::UpdateRatio(size_t frames) {
+    const double dt = static_cast<double>(frames) / options_.outputRate;
+    const double latency = LatencyFrames();
+    if (warmupFrames_ > 0) {
+        warmupSum_ += latency * static_cast<double>(frames);
+        warmupFrames_ = frames >= warmupFrames_ ? 0 : warmupFrames_ - frames;
+        warmupTotal_ += frames;
+        if (warmupFrames_ == 0) {
+            targetLatency_ = warmupSum_ / static_cast<double>(warmupTotal_);
+            filteredLatency_ = targetLatency_;
+        }
+        return;
+    }
+    const double alpha = dt / (kFillSmoothingSeconds + dt);
+    filteredLatency_ += alpha * (latency - filteredLatency_);
+
+    // 水位高于目标说明输入时钟偏快，应加快消耗输入
+    const double maxCorrection = options_.maxCorrectionPpm * 1e-6;
+    const double error = (filteredLatency_ - targetLatency_) / options_.inputRate;
+    integral_ += error * dt;
+    integral_ = std::max(-maxCorrection / kIntegralGain, std::min(maxCorrection / kIntegralGain, integral_));
+    const double correction = std::max(-maxCorrection, std::min(maxCorrection,
+        kProportionalGain * error + kIntegralGain * integral_));
+    correctionPpm_.store(correction * 1e6, std::memory_order_relaxed);
+
+    sinceRatioUpdate_ += frames;
+    if (sinceRatioUpdate_ < static_cast<size_t>(kRatioUpdateSeconds * options_.outputRate)) {
+        return;
+    }
+    sinceRatioUpdate_ = 0;
+    const double ratio = nominalRatio_ * (1.0 + correction);
+    if (std::fabs(ratio - ratio_) > nominalRatio_ * kRatioUpdateThreshold) {
+        ratio_ = ratio;
+        for (auto& reader : readers_) {
+            reader->resampler().SetRatio(ratio_);
+        }
+    }
+}
+
+void DriftCompensatingResampler::Pull(float* interleaved, size_t frames) {
+    const size_t channels = options_.channels;
+    if (!initialized_.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    // 水位首次达到目标之前输出静音，之后以此时的延迟作为对齐基准
+    if (!primed_) {
+        const size_t buffered = fifo_->available_read() / channels;
+        const size_t target = static_cast<size_t>(targetLatency_);
+        if (buffered < target) {
+            std::fill(interleaved, interleaved + frames * channels, 0.0f);
+            outputFrames_.fetch_add(frames, std::memory_order_relaxed);
+            return;
+        }
+        // 丢掉目标水位之外的积压，让起始延迟等于目标值
+        size_t skipped = 0;
+        while (skipped < buffered - target) {
+            const size_t n = std::min(buffered - target - skipped, kMaxChunksPerBlock * options_.requestFrames);
+            if (!fifo_->read(chunk_.data(), n * channels)) {
+                break;
+            }
+            skipped += n;
+        }
+        skippedFrames_.store(skipped, std::memory_order_relaxed);
+        warmupFrames_ = static_cast<size_t>(kWarmupSeconds * options_.outputRate);
+        warmupTotal_ = 0;
+        warmupSum_ = 0.0;
+        primed_ = true;
+    }
+
+    size_t done = 0;
+    while (done < frames) {
+        size_t block = std::min(frames - done, readers_[0]->resampler().ChunkSize());
+        block = std::min(block, planarOut_.size());
+        if (block == 0) {
+            block = 1;
+        }
+        chunkCount_ = 0;
+        for (size_t ch = 0; ch < channels; ++ch) {
+            readers_[ch]->Resample(block, planarOut_.data());
+            float* out = interleaved + done * channels + ch;
+            for (size_t i = 0; i < block; ++i) {
+                out[i * channels] = planarOut_[i];
+            }
+        }
+        done += block;
+    }
+
+    consumedFrames_.store(consumedFrames_.load(std::memory_order_relaxed) + frames * ratio_,
+                          std::memory_order_relaxed);
+    outputFrames_.fetch_add(frames, std::memory_order_relaxed);
+    UpdateRatio(frames);
+}
+
+DriftCompensatingResampler::Stats DriftCompensatingResampler::GetStats() const {
+    Stats stats{};
+    if (!fifo_) {
+        return stats;
+    }
+    stats.correctionPpm = correctionPpm_.load(std::memory_order_relaxed);
+    stats.inputFrames = inputFrames_.load(std::memory_order_acquire);
+    stats.outputFrames = outputFrames_.load(std::memory_order_relaxed);
+    stats.latencyFrames = LatencyFrames();
+    stats.underruns = underruns_.load(std::memory_order_relaxed);
+    stats.droppedSamples = fifo_->get_stats().dropped_samples;
+    stats.consumedFrames = static_cast<double>(skippedFrames_.load(std::memory_order_relaxed)) +
+                           static_cast<double>(stats.droppedSamples / options_.channels) +
+                           consumedFrames_.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,380 @@
+#include "dsp_chain.h"
+#include "logger.h"
+#include "common_audio/include/audio_util.h"
+#include "common_audio/vad/include/webrtc_vad.h"
+#include "modules/audio_processing/aec3/echo_canceller3.h"
+#include "modules/audio_processing/agc2/adaptive_digital_gain_applier.h"
+#include "modules/audio_processing/agc2/adaptive_mode_level_estimator.h"
+#include "modules/audio_processing/agc2/agc2_common.h"
+#include "modules/audio_processing/agc2/gain_applier.h"
+#include "modules/audio_processing/agc2/limiter.h"
+#include "modules/audio_processing/agc2/noise_level_estimator.h"
+#include "modules/audio_processing/agc2/saturation_protector.h"
+#include "modules/audio_processing/audio_buffer.h"
+#include "modules/audio_processing/high_pass_filter.h"
+#include "modules/audio_processing/include/audio_frame_view.h"
+#include "modules/audio_processing/include/audio_processing.h"
+#include "modules/audio_processing/logging/apm_data_dumper.h"
+#include "modules/audio_processing/ns/noise_suppressor.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+// 分频后最低子带的采样率，高通滤波作用在这一子带上
+constexpr int kSplitBandRate = 16000;
+
+// 与 AudioProcessing::Config::GainController2::AdaptiveDigital 的默认值一致
+constexpr int kAdjacentSpeechFrames = 12;
+constexpr float kMaxGainChangeDbPerSecond = 3.0f;
+constexpr float kMaxOutputNoiseLevelDbfs = -50.0f;
+
+// common_audio VAD 的激进程度（0~3）
+constexpr int kVadMode = 2;
+
+int ProcessingRate(int sampleRate) {
+    for (int rate : {16000, 32000, 48000}) {
+        if (sampleRate <= rate) {
+            return rate;
+        }
+    }
+    return 48000;
+}
+
+bool SupportsMultiBand(int rate) {
+    return rate == 32000 || rate == 48000;
+}
+
+webrtc::NsConfig::SuppressionLevel SuppressionLevel(int level) {
+    switch (std::min(std::max(level, 0), 3)) {
+        case 0: return webrtc::NsConfig::SuppressionLevel::k6dB;
+        case 1: return webrtc::NsConfig::SuppressionLevel::k12dB;
+        case 2: return webrtc::NsConfig::SuppressionLevel::k18dB;
+        default: return webrtc::NsConfig::SuppressionLevel::k21dB;
+    }
+}
+
+// 单线程写入的耗时统计，其他线程只读
+struct StageTimer {
+    std::atomic<uint64_t> frames{0};
+    std::atomic<uint64_t> totalNanos{0};
+    std::atomic<uint64_t> maxNanos{0};
+    PipelineMetrics::Histogram* histogram = nullptr;
+
+    void Record(uint64_t elapsed) {
+        frames.store(frames.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        totalNanos.store(totalNanos.load(std::memory_order_relaxed) + elapsed, std::memory_order_relaxed);
+        if (elapsed > maxNanos.load(std::memory_order_relaxed)) {
+            maxNanos.store(elapsed, std::memory_order_relaxed);
+        }
+        if (histogram) {
+            histogram->Record(elapsed);
+        }
+    }
+
+    DspChain::StageStats Get() const {
+        DspChain::StageStats stats;
+        stats.frames = frames.load(std::memory_order_relaxed);
+        stats.averageNanos = stats.frames ? totalNanos.load(std::memory_order_relaxed) / stats.frames : 0;
+        stats.maxNanos = maxNanos.load(std::memory_order_relaxed);
+        return stats;
+    }
+};
+
+// 对应 webrtc::AdaptiveAgc，语音概率由 common_audio VAD 给出（0 或 1）
+class AdaptiveGain {
+public:
+    AdaptiveGain(webrtc::ApmDataDumper* dumper, int sampleRate, size_t channels)
+        : levelEstimator(dumper, kAdjacentSpeechFrames)
+        , noiseEstimator(webrtc::CreateNoiseFloorEstimator(dumper))
+        , saturationProtector(webrtc::CreateSaturationProtector(webrtc::kSaturationProtectorInitialHeadroomDb,
+                                                                webrtc::kSaturationProtectorExtraHeadroomDb,
+                                                                kAdjacentSpeechFrames, dumper))
+        , gainApplier(dumper, kAdjacentSpeechFrames, kMaxGainChangeDbPerSecond, kMaxOutputNoiseLevelDbfs, false)
+        , sampleRate(sampleRate)
+        , vadFrame(static_cast<size_t>(sampleRate / 100))
+        , vad(WebRtcVad_Create()) {
+        gainApplier.Initialize(sampleRate, static_cast<int>(channels));
+        WebRtcVad_Init(vad);
+        WebRtcVad_set_mode(vad, kVadMode);
+    }
+
+    ~AdaptiveGain() {
+        WebRtcVad_Free(vad);
+    }
+
+    void Process(webrtc::AudioFrameView<float> frame, float limiterEnvelope) {
+        // 电平按第一个声道计算，与 VadLevelAnalyzer 一致
+        float peak = 0.0f;
+        float energy = 0.0f;
+        const rtc::ArrayView<float> first = frame.channel(0);
+        for (size_t i = 0; i < first.size(); ++i) {
+            const float x = first[i];
+            peak = std::max(peak, std::fabs(x));
+            energy += x * x;
+            vadFrame[i] = webrtc::FloatS16ToS16(x);
+        }
+        const int active = WebRtcVad_Process(vad, sampleRate, vadFrame.data(), vadFrame.size());
+
+        webrtc::VadLevelAnalyzer::Result vadResult;
+        vadResult.speech_probability = active == 1 ? 1.0f : 0.0f;
+        vadResult.rms_dbfs = webrtc::FloatS16ToDbfs(std::sqrt(energy / first.size()));
+        vadResult.peak_dbfs = webrtc::FloatS16ToDbfs(peak);
+
+        webrtc::AdaptiveDigitalGainApplier::FrameInfo info;
+        info.speech_probability = vadResult.speech_probability;
+        levelEstimator.Update(vadResult);
+        info.speech_level_dbfs = levelEstimator.level_dbfs();
+        info.speech_level_reliable = levelEstimator.IsConfident();
+        info.noise_rms_dbfs = noiseEstimator->Analyze(frame);
+        saturationProtector->Analyze(info.speech_probability, vadResult.peak_dbfs, info.speech_level_dbfs);
+        info.headroom_db = saturationProtector->HeadroomDb();
+        info.limiter_envelope_dbfs = webrtc::FloatS16ToDbfs(limiterEnvelope);
+        gainApplier.Process(info, frame);
+    }
+
+    float SpeechLevelDbfs() const { return levelEstimator.level_dbfs(); }
+
+private:
+    webrtc::AdaptiveModeLevelEstimator levelEstimator;
+    std::unique_ptr<webrtc::NoiseLevelEstimator> noiseEstimator;
+    std::unique_ptr<webrtc::SaturationProtector> saturationProtector;
+    webrtc::AdaptiveDigitalGainApplier gainApplier;
+    int sampleRate;
+    std::vector<int16_t> vadFrame;
+    VadInst* vad;
+};
+
+} // namespace
+
+class DspChain::Impl {
+public:
+    explicit Impl(const Options& options)
+        : options(options)
+        , processRate(ProcessingRate(options.sampleRate))
+        , config(options.sampleRate, options.channels)
+        , renderConfig(options.sampleRate, options.renderChannels)
+        , dumper(0)
+        , speechLevelDbfs(-90.0f) {
+        captureBuffer.reset(new webrtc::AudioBuffer(
+            options.sampleRate, options.channels,
+            processRate, options.channels,
+            options.sampleRate, options.channels));
+
+        if (options.highPassFilter) {
+            hpf.reset(new webrtc::HighPassFilter(kSplitBandRate, options.channels));
+        }
+        if (options.echoCancellation) {
+            aec.reset(new webrtc::EchoCanceller3(
+                webrtc::EchoCanceller3::CreateDefaultConfig(options.renderChannels, options.channels),
+                processRate, options.renderChannels, options.channels));
+            renderBuffer.reset(new webrtc::AudioBuffer(
+                options.sampleRate, options.renderChannels,
+                processRate, options.renderChannels,
+                processRate, options.renderChannels));
+        }
+        if (options.noiseSuppression) {
+            webrtc::NsConfig nsConfig;
+            nsConfig.target_level = SuppressionLevel(options.noiseSuppressionLevel);
+            ns.reset(new webrtc::NoiseSuppressor(nsConfig, processRate, options.channels));
+        }
+        if (options.gainControl) {
+            fixedGain.reset(new webrtc::GainApplier(false, webrtc::DbToRatio(options.fixedGainDb)));
+            if (options.adaptiveGain) {
+                adaptiveGain.reset(new AdaptiveGain(&dumper, processRate, options.channels));
+            }
+            limiter.reset(new webrtc::Limiter(static_cast<size_t>(processRate), &dumper, "DspChain"));
+        }
+
+        if (options.metrics) {
+            static const char* kMetricNames[kStageCount] = {
+                "high_pass_ns", "echo_cancellation_ns", "noise_suppression_ns", "agc2_ns"
+            };
+            for (size_t stage = 0; stage < kStageCount; ++stage) {
+                if (Enabled(static_cast<Stage>(stage))) {
+                    timers[stage].histogram =
+                        &options.metrics->GetHistogram(options.metricsPrefix + "." + kMetricNames[stage]);
+                }
+            }
+            total.histogram = &options.metrics->GetHistogram(options.metricsPrefix + ".frame_ns");
+        }
+    }
+
+    bool Enabled(Stage stage) const {
+        switch (stage) {
+            case kHighPass: return hpf != nullptr;
+            case kEchoCancellation: return aec != nullptr;
+            case kNoiseSuppression: return ns != nullptr;
+            case kGainControl: return limiter != nullptr;
+            default: return false;
+        }
+    }
+
+    // 把从 start 到现在的耗时记到 stage，返回现在的时间
+    uint64_t Lap(Stage stage, uint64_t start) {
+        const uint64_t now = PipelineMetrics::NowNanoseconds();
+        timers[stage].Record(now - start);
+        return now;
+    }
+
+    void AnalyzeRender(const float* const* channels) {
+        renderBuffer->CopyFrom(channels, renderConfig);
+        if (SupportsMultiBand(processRate)) {
+            renderBuffer->SplitIntoFrequencyBands();
+        }
+        aec->AnalyzeRender(renderBuffer.get());
+    }
+
+    // 与 AudioProcessingImpl::ProcessCaptureStreamLocked 的顺序一致
+    void ProcessFrame(float* const* channels) {
+        const uint64_t start = PipelineMetrics::NowNanoseconds();
+        captureBuffer->CopyFrom(channels, config);
+        uint64_t lap = PipelineMetrics::NowNanoseconds();
+        if (aec) {
+            aec->AnalyzeCapture(captureBuffer.get());
+            lap = Lap(kEchoCancellation, lap);
+        }
+        const bool multiBand = SupportsMultiBand(processRate);
+        if (multiBand) {
+            captureBuffer->SplitIntoFrequencyBands();
+            lap = PipelineMetrics::NowNanoseconds();
+        }
+        if (hpf) {
+            hpf->Process(captureBuffer.get(), true);
+            lap = Lap(kHighPass, lap);
+        }
+        // 降噪在回声消除之前分析，避免把舒适噪声计入噪声估计
+        uint64_t nsNanos = 0;
+        if (ns) {
+            ns->Analyze(*captureBuffer);
+            const uint64_t now = PipelineMetrics::NowNanoseconds();
+            nsNanos = now - lap;
+            lap = now;
+        }
+        if (aec) {
+            aec->ProcessCapture(captureBuffer.get(), false);
+            lap = Lap(kEchoCancellation, lap);
+        }
+        if (ns) {
+            ns->Process(captureBuffer.get());
+            const uint64_t now = PipelineMetrics::NowNanoseconds();
+            timers[kNoiseSuppression].Record(nsNanos + now - lap);
+            lap = now;
+        }
+        if (multiBand) {
+            captureBuffer->MergeFrequencyBands();
+            lap = PipelineMetrics::NowNanoseconds();
+        }
+        if (limiter) {
+            // 与 GainController2::Process 一致：固定增益 → 自适应增益 → 限幅
+            webrtc::AudioFrameView<float> frame(captureBuffer->channels(), captureBuffer->num_channels(),
+                                                captureBuffer->num_frames());
+            fixedGain->ApplyGain(frame);
+            if (adaptiveGain) {
+                adaptiveGain->Process(frame, limiter->LastAudioLevel());
+                speechLevelDbfs.store(adaptiveGain->SpeechLevelDbfs(), std::memory_order_relaxed);
+            }
+            limiter->Process(frame);
+            Lap(kGainControl, lap);
+        }
+        captureBuffer->CopyTo(config, channels);
+        total.Record(PipelineMetrics::NowNanoseconds() - start);
+    }
+
+    Options options;
+    int processRate;
+    webrtc::StreamConfig config;
+    webrtc::StreamConfig renderConfig;
+    webrtc::ApmDataDumper dumper;
+
+    std::unique_ptr<webrtc::AudioBuffer> captureBuffer;
+    std::unique_ptr<webrtc::AudioBuffer> renderBuffer;
+    std::unique_ptr<webrtc::HighPassFilter> hpf;
+    std::unique_ptr<webrtc::EchoCanceller3> aec;
+    std::unique_ptr<webrtc::NoiseSuppressor> ns;
+    std::unique_ptr<webrtc::GainApplier> fixedGain;
+    std::unique_ptr<AdaptiveGain> adaptiveGain;
+    std::unique_ptr<webrtc::Limiter> limiter;
+
+    StageTimer timers[kStageCount];
+    StageTimer total;
+    std::atomic<float> speechLevelDbfs;
+};
+
+DspChain::Options::Options() = default;
+
+DspChain::DspChain()
+    : initialized_(false)
+    , frameSize_(0) {
+}
+
+DspChain::~DspChain() {
+    Release();
+}
+
+bool DspChain::Initialize(const Options& options) {
+    Release();
+
+    if (options.sampleRate < 8000 || options.sampleRate > 384000 || options.sampleRate % 100 != 0) {
+        Logger::error("DSP 处理链不支持的采样率: %d", options.sampleRate);
+        return false;
+    }
+    if (options.channels == 0 || (options.echoCancellation && options.renderChannels == 0)) {
+        Logger::error("DSP 处理链声道数无效: capture=%zu, render=%zu", options.channels, options.renderChannels);
+        return false;
+    }
+
+    frameSize_ = static_cast<size_t>(options.sampleRate / 100);
+    impl_.reset(new Impl(options));
+    initialized_.store(true, std::memory_order_release);
+
+    Logger::info("DSP 处理链已初始化: %d Hz/%zu 声道, 处理采样率 %d Hz, 高通 %s, 回声消除 %s, 降噪 %s, AGC2 %s",
+                 options.sampleRate, options.channels, impl_->processRate,
+                 impl_->hpf ? "开" : "关", impl_->aec ? "开" : "关", impl_->ns ? "开" : "关",
+                 !impl_->limiter ? "关" : impl_->adaptiveGain ? "自适应" : "固定增益");
+    return true;
+}
+
+void DspChain::Release() {
+    initialized_.store(false, std::memory_order_release);
+    impl_.reset();
+    frameSize_ = 0;
+}
+
+void DspChain::AnalyzeRender(const float* const* channels) {
+    if (!IsInitialized() || !channels || !impl_->aec) {
+        return;
+    }
+    impl_->AnalyzeRender(channels);
+}
+
+void DspChain::ProcessFrame(float* const* channels) {
+    if (!IsInitialized() || !channels) {
+        return;
+    }
+    impl_->ProcessFrame(channels);
+}
+
+DspChain::Stats DspChain::GetStats() const {
+    Stats stats = {};
+    if (!IsInitialized()) {
+        return stats;
+    }
+    for (size_t stage = 0; stage < kStageCount; ++stage) {
+        stats.stages[stage] = impl_->timers[stage].Get();
+    }
+    stats.total = impl_->total.Get();
+    stats.speechLevelDbfs = impl_->speechLevelDbfs.load(std::memory_order_relaxed);
+    return stats;
+}
+
+const char* DspChain::StageName(Stage stage) {
+    switch (stage) {
+        case kHighPass: return "high_pass";
+        case kEchoCancellation: return "echo_cancellation";
+        case kNoiseSuppression: return "noise_suppression";
+        case kGainControl: return "agc2";
+        default: return "unknown";
+    }
+}
@@ -0,0 +1,236 @@
+#include "dsp_worker.h"
+#include "audio_kernels.h"
+#include "logger.h"
+#include "pipeline_metrics.h"
+#include "streaming_wav_writer.h"
+#include <algorithm>
+
+DspWorker::Options::Options() = default;
+DspWorker::Session::Options::Options() = default;
+
+DspWorker::Session::Session(const Options& options)
+    : options_(options)
+    , frameSize_(0)
+    , worker_(nullptr)
+    , slot_(0)
+    , inputFrames_(0)
+    , processedFrames_(0)
+    , droppedFrames_(0) {
+}
+
+bool DspWorker::Session::Initialize() {
+    if (!chain_.Initialize(options_.chain)) {
+        return false;
+    }
+    frameSize_ = chain_.FrameSize();
+
+    const DspChain::Options& chain = options_.chain;
+    const size_t bufferFrames = std::max<size_t>(
+        static_cast<size_t>(chain.sampleRate) * options_.bufferMilliseconds / 1000, frameSize_ * 2);
+    input_.reset(new RingBuffer(bufferFrames * chain.channels));
+    frame_.assign(frameSize_ * chain.channels, 0.0f);
+    planar_.assign(chain.channels, std::vector<float>(frameSize_, 0.0f));
+    for (auto& plane : planar_) {
+        planes_.push_back(plane.data());
+    }
+
+    if (chain.echoCancellation) {
+        render_.reset(new RingBuffer(bufferFrames * chain.renderChannels));
+        renderFrame_.assign(frameSize_ * chain.renderChannels, 0.0f);
+        renderPlanar_.assign(chain.renderChannels, std::vector<float>(frameSize_, 0.0f));
+        for (auto& plane : renderPlanar_) {
+            renderPlanes_.push_back(plane.data());
+        }
+    }
+    return true;
+}
+
+DspWorker::Session::~Session() {
+    if (!input_) {
+        return;
+    }
+    if (worker_) {
+        worker_->Detach(this);
+    }
+    // 此后只有当前线程访问会话，按工作线程的方式处理完剩余输入
+    Pump();
+    const size_t tail = input_->available_read();
+    if (tail > 0 && input_->read(frame_.data(), tail)) {
+        std::fill(frame_.begin() + tail, frame_.end(), 0.0f);
+        ProcessFrame(tail / options_.chain.channels);
+    }
+}
+
+bool DspWorker::Session::Write(const float* interleaved, size_t frames) {
+    inputFrames_.store(inputFrames_.load(std::memory_order_relaxed) + frames, std::memory_order_relaxed);
+    if (!input_->write(interleaved, frames * options_.chain.channels)) {
+        droppedFrames_.store(droppedFrames_.load(std::memory_order_relaxed) + frames, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+bool DspWorker::Session::WriteRender(const float* interleaved, size_t frames) {
+    return render_ && render_->write(interleaved, frames * options_.chain.renderChannels);
+}
+
+void DspWorker::Session::Pump() {
+    const size_t samples = frameSize_ * options_.chain.channels;
+    for (;;) {
+        // 远端参考先于同一时刻的近端送入
+        if (render_) {
+            const size_t renderSamples = frameSize_ * options_.chain.renderChannels;
+            while (render_->available_read() >= renderSamples && render_->read(renderFrame_.data(), renderSamples)) {
+                AudioKernels::Deinterleave(renderFrame_.data(), renderPlanes_.data(),
+                                           options_.chain.renderChannels, frameSize_);
+                chain_.AnalyzeRender(renderPlanes_.data());
+            }
+        }
+        if (input_->available_read() < samples || !input_->read(frame_.data(), samples)) {
+            break;
+        }
+        ProcessFrame(frameSize_);
+    }
+}
+
+void DspWorker::Session::ProcessFrame(size_t frames) {
+    const size_t channels = options_.chain.channels;
+    AudioKernels::Deinterleave(frame_.data(), planes_.data(), channels, frameSize_);
+    chain_.ProcessFrame(planes_.data());
+    AudioKernels::Interleave(planes_.data(), frame_.data(), channels, frameSize_);
+
+    if (options_.writer) {
+        options_.writer->Write(frame_.data(), frames);
+    }
+    if (options_.broadcast) {
+        options_.broadcast->write(frame_.data(), frames * channels);
+    }
+    if (options_.sink) {
+        options_.sink(frame_.data(), frames);
+    }
+    processedFrames_.store(processedFrames_.load(std::memory_order_relaxed) + frames, std::memory_order_relaxed);
+}
+
+size_t DspWorker::Session::QueuedFrames() const {
+    return input_->available_read() / options_.chain.channels;
+}
+
+size_t DspWorker::Session::QueueCapacityFrames() const {
+    return input_->capacity() / options_.chain.channels;
+}
+
+DspWorker::Session::Stats DspWorker::Session::GetStats() const {
+    Stats stats;
+    stats.inputFrames = inputFrames_.load(std::memory_order_relaxed);
+    stats.processedFrames = processedFrames_.load(std::memory_order_relaxed);
+    stats.droppedFrames = droppedFrames_.load(std::memory_order_relaxed);
+    stats.queuedFrames = QueuedFrames();
+    stats.chain = chain_.GetStats();
+    return stats;
+}
+
+DspWorker::DspWorker(const Options& options)
+    : options_(options)
+    , stopRequested_(false) {
+    const size_t threads = std::max<size_t>(options_.threads, 1);
+    for (size_t i = 0; i < threads; ++i) {
+        slots_.push_back(std::make_unique<Slot>());
+    }
+    for (auto& slot : slots_) {
+        slot->thread = std::thread(&DspWorker::WorkerLoop, this, slot.get());
+    }
+    Logger::info("DSP 工作线程已启动: %zu 个线程, 轮询间隔 %u 毫秒", threads, options_.pollMilliseconds);
+}
+
+DspWorker::~DspWorker() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopRequested_ = true;
+    }
+    cv_.notify_all();
+    for (auto& slot : slots_) {
+        if (slot->thread.joinable()) {
+            slot->thread.join();
+        }
+    }
+}
+
+std::shared_ptr<DspWorker> DspWorker::Shared() {
+    static std::mutex sharedMutex;
+    static std::weak_ptr<DspWorker> shared;
+
+    std::lock_guard<std::mutex> lock(sharedMutex);
+    std::shared_ptr<DspWorker> worker = shared.lock();
+    if (!worker) {
+        Options options;
+        options.threads = std::max(1u, std::thread::hardware_concurrency() / 2);
+        worker = std::make_shared<DspWorker>(options);
+        shared = worker;
+    }
+    return worker;
+}
+
+std::unique_ptr<DspWorker::Session> DspWorker::AddSession(const Session::Options& options) {
+    std::unique_ptr<Session> session(new Session(options));
+    if (!session->Initialize()) {
+        return nullptr;
+    }
+
+    // 会话数可能同时被其他线程修改，这里只需要大致均衡
+    size_t best = 0;
+    size_t bestCount = SIZE_MAX;
+    for (size_t i = 0; i < slots_.size(); ++i) {
+        std::lock_guard<std::mutex> lock(slots_[i]->mutex);
+        if (slots_[i]->sessions.size() < bestCount) {
+            best = i;
+            bestCount = slots_[i]->sessions.size();
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(slots_[best]->mutex);
+        slots_[best]->sessions.push_back(session.get());
+    }
+    session->worker_ = this;
+    session->slot_ = best;
+    return session;
+}
+
+void DspWorker::Detach(Session* session) {
+    Slot& slot = *slots_[session->slot_];
+    std::lock_guard<std::mutex> lock(slot.mutex);
+    slot.sessions.erase(std::remove(slot.sessions.begin(), slot.sessions.end(), session), slot.sessions.end());
+}
+
+DspWorker::Stats DspWorker::GetStats() const {
+    Stats stats;
+    stats.sessions = 0;
+    for (const auto& slot : slots_) {
+        {
+            std::lock_guard<std::mutex> lock(slot->mutex);
+            stats.sessions += slot->sessions.size();
+        }
+        stats.busyNanoseconds.push_back(slot->busyNanoseconds.load(std::memory_order_relaxed));
+    }
+    return stats;
+}
+
+void DspWorker::WorkerLoop(Slot* slot) {
+    const auto poll = std::chrono::milliseconds(options_.pollMilliseconds);
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait_for(lock, poll, [this] { return stopRequested_; });
+            if (stopRequested_) {
+                break;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(slot->mutex);
+        const uint64_t start = PipelineMetrics::NowNanoseconds();
+        for (Session* session : slot->sessions) {
+            session->Pump();
+        }
+        slot->busyNanoseconds.store(slot->busyNanoseconds.load(std::memory_order_relaxed) +
+                                    PipelineMetrics::NowNanoseconds() - start, std::memory_order_relaxed);
+    }
+}
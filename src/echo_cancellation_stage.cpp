@@ -0,0 +1,272 @@
+#include "echo_cancellation_stage.h"
+#include "logger.h"
+#include "modules/audio_processing/aec3/echo_canceller3.h"
+#include "modules/audio_processing/audio_buffer.h"
+#include "modules/audio_processing/high_pass_filter.h"
+#include "modules/audio_processing/include/audio_processing.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// AEC3 在 16k 以上按 16k 子带处理，高通滤波作用在最低子带上
+constexpr int kSplitBandRate = 16000;
+
+// 近端每处理多少个 10ms 帧刷新一次对外统计
+constexpr uint64_t kMetricsIntervalFrames = 10;
+
+// 选择不低于输入采样率的 AEC3 原生采样率，最高 48k
+int ProcessingRate(int sampleRate) {
+    for (int rate : {16000, 32000, 48000}) {
+        if (sampleRate <= rate) {
+            return rate;
+        }
+    }
+    return 48000;
+}
+
+bool SupportsMultiBand(int rate) {
+    return rate == 32000 || rate == 48000;
+}
+
+} // namespace
+
+class EchoCancellationStage::Impl {
+public:
+    Impl(const Options& options, int renderRate, Counters& counters)
+        : options(options)
+        , processRate(ProcessingRate(options.sampleRate))
+        , renderFrameSize(static_cast<size_t>(renderRate / 100))
+        , renderConfig(renderRate, options.renderChannels)
+        , captureConfig(options.sampleRate, options.captureChannels)
+        , renderFill(0)
+        , capturePos(0)
+        , counters(counters) {
+        aec.reset(new webrtc::EchoCanceller3(
+            webrtc::EchoCanceller3::CreateDefaultConfig(options.renderChannels, options.captureChannels),
+            processRate, options.renderChannels, options.captureChannels));
+
+        renderBuffer.reset(new webrtc::AudioBuffer(
+            renderRate, options.renderChannels,
+            processRate, options.renderChannels,
+            processRate, options.renderChannels));
+        captureBuffer.reset(new webrtc::AudioBuffer(
+            options.sampleRate, options.captureChannels,
+            processRate, options.captureChannels,
+            options.sampleRate, options.captureChannels));
+
+        if (options.highPassFilter) {
+            hpf.reset(new webrtc::HighPassFilter(kSplitBandRate, options.captureChannels));
+        }
+
+        const size_t captureFrameSize = static_cast<size_t>(options.sampleRate / 100);
+        renderFifo.assign(options.renderChannels, std::vector<float>(renderFrameSize, 0.0f));
+        captureIn.assign(options.captureChannels, std::vector<float>(captureFrameSize, 0.0f));
+        captureOut.assign(options.captureChannels, std::vector<float>(captureFrameSize, 0.0f));
+        for (auto& channel : renderFifo) {
+            renderPtrs.push_back(channel.data());
+        }
+        for (size_t ch = 0; ch < options.captureChannels; ++ch) {
+            captureInPtrs.push_back(captureIn[ch].data());
+            captureOutPtrs.push_back(captureOut[ch].data());
+        }
+    }
+
+    void ProcessRenderFrame() {
+        renderBuffer->CopyFrom(renderPtrs.data(), renderConfig);
+        if (SupportsMultiBand(processRate)) {
+            renderBuffer->SplitIntoFrequencyBands();
+        }
+        aec->AnalyzeRender(renderBuffer.get());
+        counters.renderFrames.store(counters.renderFrames.load(std::memory_order_relaxed) + 1,
+                                    std::memory_order_relaxed);
+    }
+
+    // 与 AudioProcessingImpl::ProcessCaptureStreamLocked 中 AEC3 相关的步骤保持一致
+    void ProcessCaptureFrame() {
+        const auto start = std::chrono::steady_clock::now();
+
+        captureBuffer->CopyFrom(captureInPtrs.data(), captureConfig);
+        aec->AnalyzeCapture(captureBuffer.get());
+        if (SupportsMultiBand(processRate)) {
+            captureBuffer->SplitIntoFrequencyBands();
+        }
+        if (hpf) {
+            hpf->Process(captureBuffer.get(), true);
+        }
+        if (options.streamDelayMs >= 0) {
+            aec->SetAudioBufferDelay(options.streamDelayMs);
+        }
+        aec->ProcessCapture(captureBuffer.get(), false);
+        if (SupportsMultiBand(processRate)) {
+            captureBuffer->MergeFrequencyBands();
+        }
+        captureBuffer->CopyTo(captureConfig, captureOutPtrs.data());
+
+        const uint64_t elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        const uint64_t frames = counters.captureFrames.load(std::memory_order_relaxed) + 1;
+        counters.captureFrames.store(frames, std::memory_order_relaxed);
+        counters.totalProcessNanos.store(counters.totalProcessNanos.load(std::memory_order_relaxed) + elapsed,
+                                         std::memory_order_relaxed);
+        if (elapsed > counters.maxProcessNanos.load(std::memory_order_relaxed)) {
+            counters.maxProcessNanos.store(elapsed, std::memory_order_relaxed);
+        }
+
+        // GetMetrics 只能在近端线程调用，这里定期拷贝给其他线程读取
+        if (frames % kMetricsIntervalFrames == 0) {
+            const webrtc::EchoControl::Metrics metrics = aec->GetMetrics();
+            counters.echoReturnLoss.store(metrics.echo_return_loss, std::memory_order_relaxed);
+            counters.echoReturnLossEnhancement.store(metrics.echo_return_loss_enhancement, std::memory_order_relaxed);
+            counters.delayMs.store(metrics.delay_ms, std::memory_order_relaxed);
+        }
+    }
+
+    Options options;
+    int processRate;
+    size_t renderFrameSize;
+
+    std::unique_ptr<webrtc::EchoCanceller3> aec;
+    std::unique_ptr<webrtc::HighPassFilter> hpf;
+    std::unique_ptr<webrtc::AudioBuffer> renderBuffer;
+    std::unique_ptr<webrtc::AudioBuffer> captureBuffer;
+    webrtc::StreamConfig renderConfig;
+    webrtc::StreamConfig captureConfig;
+
+    // 远端：凑满 10ms 后送入 AEC3
+    std::vector<std::vector<float>> renderFifo;
+    std::vector<float*> renderPtrs;
+    size_t renderFill;
+
+    // 近端：输入凑满 10ms 后处理，输出读取上一帧的处理结果，因此固定延迟一帧
+    std::vector<std::vector<float>> captureIn;
+    std::vector<std::vector<float>> captureOut;
+    std::vector<const float*> captureInPtrs;
+    std::vector<float*> captureOutPtrs;
+    size_t capturePos;
+
+    Counters& counters;   // 属于外层对象，只在音频线程上写
+};
+
+void EchoCancellationStage::Counters::Reset() {
+    renderFrames.store(0, std::memory_order_relaxed);
+    captureFrames.store(0, std::memory_order_relaxed);
+    totalProcessNanos.store(0, std::memory_order_relaxed);
+    maxProcessNanos.store(0, std::memory_order_relaxed);
+    echoReturnLoss.store(0.0, std::memory_order_relaxed);
+    echoReturnLossEnhancement.store(0.0, std::memory_order_relaxed);
+    delayMs.store(0, std::memory_order_relaxed);
+}
+
+EchoCancellationStage::EchoCancellationStage()
+    : initialized_(false)
+    , frameSize_(0) {
+}
+
+EchoCancellationStage::~EchoCancellationStage() {
+    Release();
+}
+
+bool EchoCancellationStage::Initialize(const Options& options) {
+    Release();
+
+    const int renderRate = options.renderSampleRate > 0 ? options.renderSampleRate : options.sampleRate;
+    for (int rate : {options.sampleRate, renderRate}) {
+        if (rate < 8000 || rate > 384000 || rate % 100 != 0) {
+            Logger::error("回声消除不支持的采样率: %d", rate);
+            return false;
+        }
+    }
+    if (options.renderChannels == 0 || options.captureChannels == 0) {
+        Logger::error("回声消除声道数无效: render=%zu, capture=%zu",
+                      options.renderChannels, options.captureChannels);
+        return false;
+    }
+
+    frameSize_ = static_cast<size_t>(options.sampleRate / 100);
+    counters_.Reset();
+    impl_.reset(new Impl(options, renderRate, counters_));
+    initialized_.store(true, std::memory_order_release);
+
+    Logger::info("回声消除已初始化: 近端 %d Hz/%zu 声道, 远端 %d Hz/%zu 声道, 处理采样率 %d Hz",
+                 options.sampleRate, options.captureChannels, renderRate, options.renderChannels,
+                 impl_->processRate);
+    return true;
+}
+
+void EchoCancellationStage::Release() {
+    initialized_.store(false, std::memory_order_release);
+    impl_.reset();
+    frameSize_ = 0;
+}
+
+void EchoCancellationStage::AnalyzeRender(const float* interleaved, size_t frames) {
+    if (!IsInitialized() || !interleaved) {
+        return;
+    }
+
+    Impl& impl = *impl_;
+    const size_t channels = impl.options.renderChannels;
+    size_t offset = 0;
+    while (offset < frames) {
+        const size_t count = std::min(frames - offset, impl.renderFrameSize - impl.renderFill);
+        const float* src = interleaved + offset * channels;
+        for (size_t ch = 0; ch < channels; ++ch) {
+            float* dst = impl.renderPtrs[ch] + impl.renderFill;
+            for (size_t i = 0; i < count; ++i) {
+                dst[i] = src[i * channels + ch];
+            }
+        }
+        impl.renderFill += count;
+        offset += count;
+
+        if (impl.renderFill == impl.renderFrameSize) {
+            impl.ProcessRenderFrame();
+            impl.renderFill = 0;
+        }
+    }
+}
+
+void EchoCancellationStage::ProcessCapture(float* const* channels, size_t frames) {
+    if (!IsInitialized() || !channels) {
+        return;
+    }
+
+    Impl& impl = *impl_;
+    const size_t channelCount = impl.options.captureChannels;
+    size_t offset = 0;
+    while (offset < frames) {
+        const size_t count = std::min(frames - offset, frameSize_ - impl.capturePos);
+        for (size_t ch = 0; ch < channelCount; ++ch) {
+            float* io = channels[ch] + offset;
+            memcpy(impl.captureIn[ch].data() + impl.capturePos, io, count * sizeof(float));
+            memcpy(io, impl.captureOut[ch].data() + impl.capturePos, count * sizeof(float));
+        }
+        impl.capturePos += count;
+        offset += count;
+
+        if (impl.capturePos == frameSize_) {
+            impl.ProcessCaptureFrame();
+            impl.capturePos = 0;
+        }
+    }
+}
+
+EchoCancellationStage::Stats EchoCancellationStage::GetStats() const {
+    Stats stats = {};
+    if (!IsInitialized()) {
+        return stats;
+    }
+
+    stats.echoReturnLossDb = counters_.echoReturnLoss.load(std::memory_order_relaxed);
+    stats.echoReturnLossEnhancementDb = counters_.echoReturnLossEnhancement.load(std::memory_order_relaxed);
+    stats.delayMs = counters_.delayMs.load(std::memory_order_relaxed);
+    stats.renderFrames = counters_.renderFrames.load(std::memory_order_relaxed);
+    stats.captureFrames = counters_.captureFrames.load(std::memory_order_relaxed);
+    const uint64_t total = counters_.totalProcessNanos.load(std::memory_order_relaxed);
+    stats.averageProcessNanos = stats.captureFrames ? total / stats.captureFrames : 0;
+    stats.maxProcessNanos = counters_.maxProcessNanos.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,851 @@
+#include "flac_encoder.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+constexpr size_t kMaxLpcOrder = 8;
+constexpr int kMaxFixedOrder = 4;
+constexpr int kMaxPartitionOrder = 8;
+constexpr int kMaxRiceParameter = 30;       // RICE2 的 5 位参数，31 为转义
+constexpr int kMaxRice1Parameter = 14;      // RICE 的 4 位参数，15 为转义
+constexpr size_t kStreamInfoOffset = 8;     // "fLaC" + 元数据块头
+
+// 编码器之间共享的线程池：提交线程自己也参与执行，1 核机器上没有工作线程，直接串行
+class ThreadPool {
+public:
+    static ThreadPool& Shared() {
+        static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+        return pool;
+    }
+
+    // 并行执行 task(0) ... task(count - 1)，全部完成后返回
+    void Run(size_t count, const std::function<void(size_t)>& task) {
+        Batch batch;
+        batch.task = &task;
+        batch.count = count;
+        const bool shared = count > 1 && !workers_.empty();
+        if (shared) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                batches_.push_back(&batch);
+            }
+            cv_.notify_all();
+        }
+
+        size_t completed = 0;
+        for (size_t i; (i = batch.next.fetch_add(1, std::memory_order_relaxed)) < count;) {
+            task(i);
+            ++completed;
+        }
+        if (!shared) {
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        Remove(&batch);
+        batch.done += completed;
+        batch.finished.wait(lock, [&batch] { return batch.done == batch.count; });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (std::thread& worker : workers_) {
+            worker.join();
+        }
+    }
+
+private:
+    struct Batch {
+        const std::function<void(size_t)>* task = nullptr;
+        size_t count = 0;
+        std::atomic<size_t> next{0};
+        size_t done = 0;                     // 受 mutex_ 保护
+        std::condition_variable finished;
+    };
+
+    explicit ThreadPool(unsigned workers) {
+        for (unsigned i = 0; i < workers; ++i) {
+            workers_.emplace_back(&ThreadPool::WorkerLoop, this);
+        }
+    }
+
+    void Remove(Batch* batch) {
+        auto it = std::find(batches_.begin(), batches_.end(), batch);
+        if (it != batches_.end()) {
+            batches_.erase(it);
+        }
+    }
+
+    // 批次在 done 达到 count 之前不会被提交线程销毁，持锁看到的批次指针总是有效
+    void WorkerLoop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            cv_.wait(lock, [this] { return stop_ || !batches_.empty(); });
+            if (batches_.empty()) {
+                return;
+            }
+            Batch* batch = batches_.front();
+            const size_t index = batch->next.fetch_add(1, std::memory_order_relaxed);
+            if (index >= batch->count) {
+                Remove(batch);
+                continue;
+            }
+            lock.unlock();
+            (*batch->task)(index);
+            lock.lock();
+            if (++batch->done == batch->count) {
+                batch->finished.notify_one();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Batch*> batches_;
+    bool stop_ = false;
+};
+
+// 高位在前的位写入器
+class BitWriter {
+public:
+    void Reset(size_t reserveBytes) {
+        bytes_.clear();
+        bytes_.reserve(reserveBytes);
+        accum_ = 0;
+        bits_ = 0;
+    }
+
+    // bits 不超过 32
+    void Write(uint32_t value, int bits) {
+        if (bits == 0) {
+            return;
+        }
+        const uint64_t mask = (bits == 32) ? 0xFFFFFFFFull : ((1ull << bits) - 1);
+        accum_ = (accum_ << bits) | (value & mask);
+        bits_ += bits;
+        while (bits_ >= 8) {
+            bits_ -= 8;
+            bytes_.push_back(static_cast<uint8_t>(accum_ >> bits_));
+        }
+    }
+
+    void WriteSigned(int32_t value, int bits) {
+        Write(static_cast<uint32_t>(value), bits);
+    }
+
+    // q 个 0 后跟一个 1，再写 k 位余数
+    void WriteRice(uint32_t folded, int k) {
+        uint32_t q = folded >> k;
+        const uint32_t low = k == 0 ? 0 : (folded & ((1u << k) - 1));
+        if (q + 1 + k <= 32) {
+            Write((1u << k) | low, static_cast<int>(q) + 1 + k);
+            return;
+        }
+        while (q >= 32) {
+            Write(0, 32);
+            q -= 32;
+        }
+        Write(1, static_cast<int>(q) + 1);
+        Write(low, k);
+    }
+
+    void AlignToByte() {
+        if (bits_ > 0) {
+            Write(0, 8 - bits_);
+        }
+    }
+
+    std::vector<uint8_t>& Bytes() { return bytes_; }
+
+private:
+    std::vector<uint8_t> bytes_;
+    uint64_t accum_ = 0;
+    int bits_ = 0;
+};
+
+uint8_t Crc8(const uint8_t* data, size_t size) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = static_cast<uint8_t>((crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1));
+        }
+    }
+    return crc;
+}
+
+struct Crc16Table {
+    uint16_t entries[256];
+
+    Crc16Table() {
+        for (int i = 0; i < 256; ++i) {
+            uint16_t crc = static_cast<uint16_t>(i << 8);
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = static_cast<uint16_t>((crc & 0x8000) ? (crc << 1) ^ 0x8005 : (crc << 1));
+            }
+            entries[i] = crc;
+        }
+    }
+};
+
+uint16_t Crc16(const uint8_t* data, size_t size) {
+    static const Crc16Table table;
+    uint16_t crc = 0;
+    for (size_t i = 0; i < size; ++i) {
+        crc = static_cast<uint16_t>((crc << 8) ^ table.entries[(crc >> 8) ^ data[i]]);
+    }
+    return crc;
+}
+
+inline uint32_t Fold(int32_t value) {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+// 分区 Rice 编码的参数选择
+struct RicePlan {
+    int partitionOrder = 0;
+    bool rice2 = false;
+    int parameters[1 << kMaxPartitionOrder];
+    uint64_t bits = std::numeric_limits<uint64_t>::max();
+};
+
+// 按 (s >> k) 估算 floor(u >> k) 之和，估计值不小于实际值
+inline void BestParameter(uint64_t count, uint64_t sum, int* parameter, uint64_t* bits) {
+    if (count == 0) {
+        *parameter = 0;
+        *bits = 0;
+        return;
+    }
+    int k = 0;
+    const uint64_t mean = sum / count;
+    while (k < kMaxRiceParameter && (2ull << k) <= mean) {
+        ++k;
+    }
+    uint64_t best = std::numeric_limits<uint64_t>::max();
+    for (int candidate = std::max(0, k - 1); candidate <= std::min(kMaxRiceParameter, k + 1); ++candidate) {
+        const uint64_t cost = count * static_cast<uint64_t>(candidate + 1) + (sum >> candidate);
+        if (cost < best) {
+            best = cost;
+            *parameter = candidate;
+        }
+    }
+    *bits = best;
+}
+
+// residual[order..frames) 为有效残差
+void PlanResidual(const int32_t* residual, size_t frames, int order, std::vector<uint64_t>& sums, RicePlan& plan) {
+    int maxOrder = 0;
+    while (maxOrder < kMaxPartitionOrder && frames % (size_t(2) << maxOrder) == 0 &&
+           (frames >> (maxOrder + 1)) > static_cast<size_t>(order)) {
+        ++maxOrder;
+    }
+
+    // 最细一级的各分区和，逐级两两合并
+    const size_t partitions = size_t(1) << maxOrder;
+    const size_t partitionSize = frames >> maxOrder;
+    sums.assign(partitions, 0);
+    for (size_t p = 0; p < partitions; ++p) {
+        const size_t begin = std::max(p * partitionSize, static_cast<size_t>(order));
+        const size_t end = (p + 1) * partitionSize;
+        uint64_t sum = 0;
+        for (size_t i = begin; i < end; ++i) {
+            sum += Fold(residual[i]);
+        }
+        sums[p] = sum;
+    }
+
+    plan.bits = std::numeric_limits<uint64_t>::max();
+    for (int level = maxOrder; level >= 0; --level) {
+        const size_t count = size_t(1) << level;
+        const size_t size = frames >> level;
+        int parameters[1 << kMaxPartitionOrder];
+        uint64_t bits = 0;
+        int maxParameter = 0;
+        for (size_t p = 0; p < count; ++p) {
+            const uint64_t samples = size - (p == 0 ? static_cast<size_t>(order) : 0);
+            uint64_t partitionBits;
+            BestParameter(samples, sums[p], &parameters[p], &partitionBits);
+            bits += partitionBits;
+            maxParameter = std::max(maxParameter, parameters[p]);
+        }
+        const bool rice2 = maxParameter > kMaxRice1Parameter;
+        bits += 2 + 4 + count * (rice2 ? 5 : 4);
+        if (bits < plan.bits) {
+            plan.bits = bits;
+            plan.partitionOrder = level;
+            plan.rice2 = rice2;
+            std::copy(parameters, parameters + count, plan.parameters);
+        }
+        if (level > 0) {
+            for (size_t p = 0; p < count / 2; ++p) {
+                sums[p] = sums[2 * p] + sums[2 * p + 1];
+            }
+        }
+    }
+}
+
+void WriteResidual(BitWriter& writer, const int32_t* residual, size_t frames, int order, const RicePlan& plan) {
+    writer.Write(plan.rice2 ? 1 : 0, 2);
+    writer.Write(static_cast<uint32_t>(plan.partitionOrder), 4);
+    const size_t count = size_t(1) << plan.partitionOrder;
+    const size_t size = frames >> plan.partitionOrder;
+    for (size_t p = 0; p < count; ++p) {
+        const int k = plan.parameters[p];
+        writer.Write(static_cast<uint32_t>(k), plan.rice2 ? 5 : 4);
+        const size_t begin = p == 0 ? static_cast<size_t>(order) : p * size;
+        const size_t end = (p + 1) * size;
+        for (size_t i = begin; i < end; ++i) {
+            writer.WriteRice(Fold(residual[i]), k);
+        }
+    }
+}
+
+// 固定多项式预测的残差，返回 false 表示残差超出 32 位
+bool FixedResidual(const int32_t* x, size_t frames, int order, int32_t* residual) {
+    for (size_t i = static_cast<size_t>(order); i < frames; ++i) {
+        int64_t r;
+        switch (order) {
+        case 0: r = x[i]; break;
+        case 1: r = int64_t(x[i]) - x[i - 1]; break;
+        case 2: r = int64_t(x[i]) - 2 * int64_t(x[i - 1]) + x[i - 2]; break;
+        case 3: r = int64_t(x[i]) - 3 * int64_t(x[i - 1]) + 3 * int64_t(x[i - 2]) - x[i - 3]; break;
+        default:
+            r = int64_t(x[i]) - 4 * int64_t(x[i - 1]) + 6 * int64_t(x[i - 2]) - 4 * int64_t(x[i - 3]) + x[i - 4];
+            break;
+        }
+        if (r > std::numeric_limits<int32_t>::max() || r < std::numeric_limits<int32_t>::min()) {
+            return false;
+        }
+        residual[i] = static_cast<int32_t>(r);
+    }
+    return true;
+}
+
+// 一次遍历算出 0~4 阶残差的绝对值之和，选最小的阶数
+int BestFixedOrder(const int32_t* x, size_t frames, uint64_t* sumOut) {
+    const int maxOrder = static_cast<int>(std::min<size_t>(kMaxFixedOrder, frames > 0 ? frames - 1 : 0));
+    uint64_t sums[kMaxFixedOrder + 1] = {0, 0, 0, 0, 0};
+    for (size_t i = static_cast<size_t>(maxOrder); i < frames; ++i) {
+        const int64_t e0 = x[i];
+        const int64_t e1 = i >= 1 ? e0 - x[i - 1] : 0;
+        const int64_t e2 = i >= 2 ? e1 - (int64_t(x[i - 1]) - x[i - 2]) : 0;
+        const int64_t e3 = i >= 3 ? e2 - (int64_t(x[i - 1]) - 2 * int64_t(x[i - 2]) + x[i - 3]) : 0;
+        const int64_t e4 = i >= 4 ? e3 - (int64_t(x[i - 1]) - 3 * int64_t(x[i - 2]) + 3 * int64_t(x[i - 3]) - x[i - 4]) : 0;
+        sums[0] += static_cast<uint64_t>(std::llabs(e0));
+        sums[1] += static_cast<uint64_t>(std::llabs(e1));
+        sums[2] += static_cast<uint64_t>(std::llabs(e2));
+        sums[3] += static_cast<uint64_t>(std::llabs(e3));
+        sums[4] += static_cast<uint64_t>(std::llabs(e4));
+    }
+    int best = 0;
+    for (int order = 1; order <= maxOrder; ++order) {
+        if (sums[order] < sums[best]) {
+            best = order;
+        }
+    }
+    *sumOut = sums[best];
+    return best;
+}
+
+// 与 libFLAC 相同的按块大小选择系数精度
+int QlpPrecision(size_t frames) {
+    if (frames <= 192) return 7;
+    if (frames <= 384) return 8;
+    if (frames <= 576) return 9;
+    if (frames <= 1152) return 10;
+    if (frames <= 2304) return 11;
+    if (frames <= 4608) return 12;
+    return 13;
+}
+
+// 单个声道的编码工作区
+struct SubframeEncoder {
+    std::vector<int32_t> fixedResidual;
+    std::vector<int32_t> lpcResidual;
+    std::vector<double> windowed;
+    std::vector<double> window;
+    std::vector<uint64_t> sums;
+
+    void Encode(BitWriter& writer, const int32_t* x, size_t frames, int bps) {
+        fixedResidual.resize(frames);
+        lpcResidual.resize(frames);
+
+        // 常量
+        bool constant = true;
+        for (size_t i = 1; i < frames && constant; ++i) {
+            constant = x[i] == x[0];
+        }
+        if (constant) {
+            writer.Write(0x00, 8);
+            writer.WriteSigned(x[0], bps);
+            return;
+        }
+
+        const uint64_t verbatimBits = static_cast<uint64_t>(frames) * bps;
+
+        // 固定多项式预测
+        uint64_t fixedSum = 0;
+        int fixedOrder = BestFixedOrder(x, frames, &fixedSum);
+        RicePlan fixedPlan;
+        uint64_t fixedBits = std::numeric_limits<uint64_t>::max();
+        if (FixedResidual(x, frames, fixedOrder, fixedResidual.data())) {
+            PlanResidual(fixedResidual.data(), frames, fixedOrder, sums, fixedPlan);
+            fixedBits = static_cast<uint64_t>(fixedOrder) * bps + fixedPlan.bits;
+        }
+
+        // LPC
+        int lpcOrder = 0;
+        int precision = QlpPrecision(frames);
+        int shift = 0;
+        int32_t coefficients[kMaxLpcOrder];
+        RicePlan lpcPlan;
+        uint64_t lpcBits = std::numeric_limits<uint64_t>::max();
+        if (frames > kMaxLpcOrder * 2 && ComputeLpc(x, frames, bps, precision, &lpcOrder, &shift, coefficients)) {
+            PlanResidual(lpcResidual.data(), frames, lpcOrder, sums, lpcPlan);
+            lpcBits = static_cast<uint64_t>(lpcOrder) * (bps + precision) + 4 + 5 + lpcPlan.bits;
+        }
+
+        if (verbatimBits <= fixedBits && verbatimBits <= lpcBits) {
+            writer.Write(0x02, 8);
+            for (size_t i = 0; i < frames; ++i) {
+                writer.WriteSigned(x[i], bps);
+            }
+        } else if (fixedBits <= lpcBits) {
+            writer.Write(static_cast<uint32_t>((0x08 | fixedOrder) << 1), 8);
+            for (int i = 0; i < fixedOrder; ++i) {
+                writer.WriteSigned(x[i], bps);
+            }
+            WriteResidual(writer, fixedResidual.data(), frames, fixedOrder, fixedPlan);
+        } else {
+            writer.Write(static_cast<uint32_t>((0x20 | (lpcOrder - 1)) << 1), 8);
+            for (int i = 0; i < lpcOrder; ++i) {
+                writer.WriteSigned(x[i], bps);
+            }
+            writer.Write(static_cast<uint32_t>(precision - 1), 4);
+            writer.WriteSigned(shift, 5);
+            for (int i = 0; i < lpcOrder; ++i) {
+                writer.WriteSigned(coefficients[i], precision);
+            }
+            WriteResidual(writer, lpcResidual.data(), frames, lpcOrder, lpcPlan);
+        }
+    }
+
+    // Tukey(0.5) 窗自相关 + Levinson-Durbin，按估计的码长选阶数，量化系数并算出残差
+    bool ComputeLpc(const int32_t* x, size_t frames, int bps, int precision,
+                    int* orderOut, int* shiftOut, int32_t* coefficients) {
+        if (window.size() != frames) {
+            window.resize(frames);
+            const size_t taper = frames / 4;
+            for (size_t i = 0; i < frames; ++i) {
+                double w = 1.0;
+                if (i < taper) {
+                    w = 0.5 - 0.5 * std::cos(M_PI * i / taper);
+                } else if (i >= frames - taper) {
+                    w = 0.5 - 0.5 * std::cos(M_PI * (frames - 1 - i) / taper);
+                }
+                window[i] = w;
+            }
+        }
+        windowed.resize(frames);
+        for (size_t i = 0; i < frames; ++i) {
+            windowed[i] = x[i] * window[i];
+        }
+
+        double autoc[kMaxLpcOrder + 1];
+        for (size_t lag = 0; lag <= kMaxLpcOrder; ++lag) {
+            double sum = 0.0;
+            for (size_t i = lag; i < frames; ++i) {
+                sum += windowed[i] * windowed[i - lag];
+            }
+            autoc[lag] = sum;
+        }
+        if (autoc[0] <= 0.0) {
+            return false;
+        }
+
+        // lpc[o][j]：o+1 阶预测中 x[i-1-j] 的系数
+        double lpc[kMaxLpcOrder][kMaxLpcOrder];
+        double error[kMaxLpcOrder];
+        double current[kMaxLpcOrder] = {0};
+        double err = autoc[0];
+        size_t maxOrder = 0;
+        for (size_t o = 0; o < kMaxLpcOrder; ++o) {
+            double acc = autoc[o + 1];
+            for (size_t j = 0; j < o; ++j) {
+                acc -= current[j] * autoc[o - j];
+            }
+            const double k = acc / err;
+            double next[kMaxLpcOrder];
+            for (size_t j = 0; j < o; ++j) {
+                next[j] = current[j] - k * current[o - 1 - j];
+            }
+            next[o] = k;
+            std::copy(next, next + o + 1, current);
+            err *= (1.0 - k * k);
+            std::copy(current, current + o + 1, lpc[o]);
+            error[o] = err;
+            maxOrder = o + 1;
+            if (err <= 0.0) {
+                break;
+            }
+        }
+
+        // 估计每阶的总码长：残差按高斯近似，每个样本 0.5*log2(误差能量/帧数) 位
+        size_t order = 1;
+        double bestBits = std::numeric_limits<double>::max();
+        for (size_t o = 1; o <= maxOrder; ++o) {
+            const double perSample = error[o - 1] > 0.0
+                ? std::max(0.0, 0.5 * std::log2(error[o - 1] / frames)) : 0.0;
+            const double bits = perSample * (frames - o) + static_cast<double>(o) * (bps + precision);
+            if (bits < bestBits) {
+                bestBits = bits;
+                order = o;
+            }
+        }
+
+        // 量化系数，误差反馈到下一个系数
+        const double* lp = lpc[order - 1];
+        double cmax = 0.0;
+        for (size_t j = 0; j < order; ++j) {
+            cmax = std::max(cmax, std::fabs(lp[j]));
+        }
+        if (cmax <= 0.0) {
+            return false;
+        }
+        int log2cmax;
+        std::frexp(cmax, &log2cmax);
+        --log2cmax;
+        int shift = precision - 1 - log2cmax - 1;
+        if (shift < 0) {
+            return false;
+        }
+        shift = std::min(shift, 15);
+        const int32_t qmax = (1 << (precision - 1)) - 1;
+        const int32_t qmin = -(1 << (precision - 1));
+        double carry = 0.0;
+        for (size_t j = 0; j < order; ++j) {
+            carry += lp[j] * static_cast<double>(1 << shift);
+            const long q = std::lround(carry);
+            coefficients[j] = static_cast<int32_t>(std::max<long>(qmin, std::min<long>(qmax, q)));
+            carry -= coefficients[j];
+        }
+
+        for (size_t i = order; i < frames; ++i) {
+            int64_t sum = 0;
+            for (size_t j = 0; j < order; ++j) {
+                sum += static_cast<int64_t>(coefficients[j]) * x[i - 1 - j];
+            }
+            const int64_t r = x[i] - (sum >> shift);
+            if (r > std::numeric_limits<int32_t>::max() || r < std::numeric_limits<int32_t>::min()) {
+                return false;
+            }
+            lpcResidual[i] = static_cast<int32_t>(r);
+        }
+        *orderOut = static_cast<int>(order);
+        *shiftOut = shift;
+        return true;
+    }
+};
+
+uint32_t BlockSizeCode(size_t frames, int* extraBits) {
+    *extraBits = 0;
+    if (frames == 192) return 1;
+    for (int n = 2; n <= 5; ++n) {
+        if (frames == (size_t(576) << (n - 2))) return static_cast<uint32_t>(n);
+    }
+    for (int n = 8; n <= 15; ++n) {
+        if (frames == (size_t(256) << (n - 8))) return static_cast<uint32_t>(n);
+    }
+    if (frames <= 256) {
+        *extraBits = 8;
+        return 6;
+    }
+    *extraBits = 16;
+    return 7;
+}
+
+// 帧号按 FLAC 规定的类 UTF-8 变长编码
+void WriteFrameNumber(BitWriter& writer, uint64_t value) {
+    if (value < 0x80) {
+        writer.Write(static_cast<uint32_t>(value), 8);
+        return;
+    }
+    int bytes = 2;
+    while (bytes < 7 && value >= (1ull << (5 * bytes + 1))) {
+        ++bytes;
+    }
+    const uint32_t lead = (0xFF00u >> bytes) & 0xFF;
+    writer.Write(lead | static_cast<uint32_t>(value >> (6 * (bytes - 1))), 8);
+    for (int i = bytes - 2; i >= 0; --i) {
+        writer.Write(0x80 | static_cast<uint32_t>((value >> (6 * i)) & 0x3F), 8);
+    }
+}
+
+// 粗略的码长估计，只用于比较声道去相关方式
+double EstimateBits(const int32_t* x, size_t frames) {
+    uint64_t sum = 0;
+    BestFixedOrder(x, frames, &sum);
+    return frames * std::log2(1.0 + static_cast<double>(sum) / frames);
+}
+
+} // namespace
+
+struct FlacEncoder::Block {
+    size_t frames = 0;
+    uint64_t number = 0;
+    std::vector<std::vector<int32_t>> samples;   // 每个声道一组
+    std::vector<int32_t> mid;
+    std::vector<int32_t> side;
+    SubframeEncoder subframe;
+    BitWriter writer;
+};
+
+namespace {
+
+enum ChannelAssignment : uint32_t {
+    kLeftSide = 8,
+    kRightSide = 9,
+    kMidSide = 10
+};
+
+} // namespace
+
+FlacEncoder::FlacEncoder(const Options& options)
+    : options_(options)
+    , threads_(options.threads > 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency()))
+    , fd_(-1)
+    , offset_(0)
+    , failed_(false)
+    , pendingFrames_(0)
+    , framesEncoded_(0)
+    , frameNumber_(0)
+    , minFrameBytes_(0)
+    , maxFrameBytes_(0) {
+    options_.bitsPerSample = options_.bitsPerSample == 24 ? 24 : 16;
+    options_.blockFrames = std::max<uint32_t>(16, std::min<uint32_t>(options_.blockFrames, 65535));
+}
+
+FlacEncoder::~FlacEncoder() = default;
+
+bool FlacEncoder::Begin(int fd) {
+    if (options_.channels == 0 || options_.channels > 8 || options_.sampleRate == 0 ||
+        options_.sampleRate >= (1u << 20)) {
+        return false;
+    }
+    fd_ = fd;
+    pending_.assign(static_cast<size_t>(options_.blockFrames) * options_.channels * threads_, 0.0f);
+    blocks_.resize(threads_);
+    for (Block& block : blocks_) {
+        block.samples.assign(options_.channels, std::vector<int32_t>(options_.blockFrames));
+    }
+
+    uint8_t header[kStreamInfoOffset] = {'f', 'L', 'a', 'C', 0x80, 0, 0, 34};
+    if (!WriteAt(fd_, header, sizeof(header), 0)) {
+        return false;
+    }
+    offset_ = kStreamInfoOffset + 34;
+    return WriteStreamInfo();
+}
+
+bool FlacEncoder::Encode(const float* interleaved, size_t frames) {
+    const size_t channels = options_.channels;
+    const size_t capacity = pending_.size() / channels;
+    while (frames > 0 && !failed_) {
+        const size_t n = std::min(frames, capacity - pendingFrames_);
+        std::copy(interleaved, interleaved + n * channels, pending_.begin() + pendingFrames_ * channels);
+        pendingFrames_ += n;
+        interleaved += n * channels;
+        frames -= n;
+        if (pendingFrames_ == capacity) {
+            EncodeBlocks(threads_, options_.blockFrames);
+            pendingFrames_ = 0;
+        }
+    }
+    return !failed_;
+}
+
+bool FlacEncoder::Flush() {
+    // 只编码完整的块，固定块长的流中只有最后一帧可以不满
+    const size_t full = pendingFrames_ / options_.blockFrames;
+    if (full > 0) {
+        EncodeBlocks(full, options_.blockFrames);
+        const size_t consumed = full * options_.blockFrames * options_.channels;
+        std::copy(pending_.begin() + consumed, pending_.begin() + pendingFrames_ * options_.channels,
+                  pending_.begin());
+        pendingFrames_ -= full * options_.blockFrames;
+    }
+    return WriteStreamInfo() && !failed_;
+}
+
+bool FlacEncoder::Finish() {
+    const size_t full = pendingFrames_ / options_.blockFrames;
+    const size_t rest = pendingFrames_ % options_.blockFrames;
+    const size_t count = full + (rest > 0 ? 1 : 0);
+    if (count > 0) {
+        EncodeBlocks(count, rest > 0 ? rest : options_.blockFrames);
+    }
+    pendingFrames_ = 0;
+    return WriteStreamInfo() && !failed_;
+}
+
+bool FlacEncoder::EncodeBlocks(size_t count, size_t lastFrames) {
+    const size_t channels = options_.channels;
+    const size_t blockFrames = options_.blockFrames;
+    const int bps = options_.bitsPerSample;
+    AudioKernels::DitherState* dither = options_.dither ? &dither_ : nullptr;
+
+    // 量化在写线程上按顺序进行，保证抖动序列与单线程编码一致
+    std::vector<int16_t> pcm16;
+    std::vector<uint8_t> pcm24;
+    for (size_t b = 0; b < count; ++b) {
+        Block& block = blocks_[b];
+        block.frames = (b + 1 == count) ? lastFrames : blockFrames;
+        block.number = frameNumber_ + b;
+        const float* source = pending_.data() + b * blockFrames * channels;
+        const size_t samples = block.frames * channels;
+        if (bps == 16) {
+            pcm16.resize(samples);
+            AudioKernels::FloatToInt16(source, pcm16.data(), samples, dither);
+            for (size_t i = 0; i < block.frames; ++i) {
+                for (size_t ch = 0; ch < channels; ++ch) {
+                    block.samples[ch][i] = pcm16[i * channels + ch];
+                }
+            }
+        } else {
+            pcm24.resize(samples * 3);
+            AudioKernels::FloatToInt24(source, pcm24.data(), samples, dither);
+            for (size_t i = 0; i < block.frames; ++i) {
+                for (size_t ch = 0; ch < channels; ++ch) {
+                    const uint8_t* p = &pcm24[(i * channels + ch) * 3];
+                    const int32_t value = p[0] | (p[1] << 8) | (static_cast<int8_t>(p[2]) * 65536);
+                    block.samples[ch][i] = value;
+                }
+            }
+        }
+    }
+
+    const std::function<void(size_t)> encode = [this, bps, channels](size_t index) {
+        Block& block = blocks_[index];
+        const size_t frames = block.frames;
+        BitWriter& writer = block.writer;
+        writer.Reset(frames * channels * bps / 8 + 64);
+
+        // 立体声按估计码长选择去相关方式
+        uint32_t assignment = static_cast<uint32_t>(channels - 1);
+        if (channels == 2) {
+            const int32_t* left = block.samples[0].data();
+            const int32_t* right = block.samples[1].data();
+            block.mid.resize(frames);
+            block.side.resize(frames);
+            for (size_t i = 0; i < frames; ++i) {
+                block.mid[i] = (left[i] + right[i]) >> 1;
+                block.side[i] = left[i] - right[i];
+            }
+            const double l = EstimateBits(left, frames);
+            const double r = EstimateBits(right, frames);
+            const double m = EstimateBits(block.mid.data(), frames);
+            const double s = EstimateBits(block.side.data(), frames);
+            const double costs[] = {l + r, l + s, s + r, m + s};
+            const uint32_t assignments[] = {1, kLeftSide, kRightSide, kMidSide};
+            size_t best = 0;
+            for (size_t i = 1; i < 4; ++i) {
+                if (costs[i] < costs[best]) {
+                    best = i;
+                }
+            }
+            assignment = assignments[best];
+        }
+
+        // 帧头
+        int extraBits = 0;
+        const uint32_t sizeCode = BlockSizeCode(frames, &extraBits);
+        writer.Write(0x3FFE, 14);
+        writer.Write(0, 1);
+        writer.Write(0, 1);                          // 固定块长
+        writer.Write(sizeCode, 4);
+        writer.Write(0, 4);                          // 采样率取自 STREAMINFO
+        writer.Write(assignment, 4);
+        writer.Write(bps == 16 ? 4 : 6, 3);
+        writer.Write(0, 1);
+        WriteFrameNumber(writer, block.number);
+        writer.Write(static_cast<uint32_t>(frames - 1), extraBits);
+        writer.Write(Crc8(writer.Bytes().data(), writer.Bytes().size()), 8);
+
+        // 子帧，side 声道多 1 位
+        switch (assignment) {
+        case kLeftSide:
+            block.subframe.Encode(writer, block.samples[0].data(), frames, bps);
+            block.subframe.Encode(writer, block.side.data(), frames, bps + 1);
+            break;
+        case kRightSide:
+            block.subframe.Encode(writer, block.side.data(), frames, bps + 1);
+            block.subframe.Encode(writer, block.samples[1].data(), frames, bps);
+            break;
+        case kMidSide:
+            block.subframe.Encode(writer, block.mid.data(), frames, bps);
+            block.subframe.Encode(writer, block.side.data(), frames, bps + 1);
+            break;
+        default:
+            for (size_t ch = 0; ch < channels; ++ch) {
+                block.subframe.Encode(writer, block.samples[ch].data(), frames, bps);
+            }
+            break;
+        }
+
+        writer.AlignToByte();
+        const uint16_t crc = Crc16(writer.Bytes().data(), writer.Bytes().size());
+        writer.Write(crc, 16);
+    };
+    ThreadPool::Shared().Run(count, encode);
+
+    for (size_t b = 0; b < count && !failed_; ++b) {
+        const std::vector<uint8_t>& bytes = blocks_[b].writer.Bytes();
+        if (!WriteAt(fd_, bytes.data(), bytes.size(), offset_)) {
+            failed_ = true;
+            break;
+        }
+        offset_ += bytes.size();
+        framesEncoded_ += blocks_[b].frames;
+        const uint32_t size = static_cast<uint32_t>(bytes.size());
+        minFrameBytes_ = minFrameBytes_ == 0 ? size : std::min(minFrameBytes_, size);
+        maxFrameBytes_ = std::max(maxFrameBytes_, size);
+    }
+    frameNumber_ += count;
+    return !failed_;
+}
+
+bool FlacEncoder::WriteStreamInfo() {
+    BitWriter writer;
+    writer.Reset(34);
+    writer.Write(options_.blockFrames, 16);
+    writer.Write(options_.blockFrames, 16);
+    writer.Write(minFrameBytes_, 24);
+    writer.Write(maxFrameBytes_, 24);
+    writer.Write(options_.sampleRate, 20);
+    writer.Write(options_.channels - 1u, 3);
+    writer.Write(options_.bitsPerSample - 1u, 5);
+    writer.Write(static_cast<uint32_t>(framesEncoded_ >> 32), 4);
+    writer.Write(static_cast<uint32_t>(framesEncoded_), 32);
+    for (int i = 0; i < 4; ++i) {
+        writer.Write(0, 32);                         // MD5 未知
+    }
+    if (failed_ || !WriteAt(fd_, writer.Bytes().data(), writer.Bytes().size(), kStreamInfoOffset)) {
+        failed_ = true;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,189 @@
+#include "g722_encoder.h"
+#include "audio_kernels.h"
+#include "common_audio/resampler/push_sinc_resampler.h"
+#include "modules/third_party/g722/g722_enc_dec.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t kCodecRate = 16000;
+constexpr size_t kCodecChunk = kCodecRate / 100;
+constexpr uint16_t kFormatG722 = 0x028F;
+constexpr size_t kHeaderSize = 60;             // RIFF(12) + fmt(28) + fact(12) + data 块头(8)
+constexpr size_t kWriteBatchBytes = 64 * 1024;
+
+void PutLE16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+void PutLE32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+        p[i] = static_cast<uint8_t>(v >> (8 * i));
+    }
+}
+
+} // namespace
+
+class G722Encoder::Impl {
+public:
+    explicit Impl(const Options& options)
+        : options(options)
+        , chunkFrames(options.sampleRate / 100)
+        , fd(-1)
+        , dataBytes(0)
+        , codecSamples(0)
+        , framesEncoded(0)
+        , failed(false) {
+    }
+
+    // 攒满 10ms 后重采样、量化、编码
+    void EncodeChunk() {
+        const float* wideband = mono.data();
+        if (resampler) {
+            resampler->Resample(mono.data(), chunkFrames, resampled, kCodecChunk);
+            wideband = resampled;
+        }
+        AudioKernels::FloatToInt16(wideband, pcm, kCodecChunk, options.dither ? &dither : nullptr);
+        const size_t bytes = WebRtc_g722_encode(&state, coded, pcm, kCodecChunk);
+        output.insert(output.end(), coded, coded + bytes);
+        codecSamples += kCodecChunk;
+        monoFrames = 0;
+    }
+
+    bool WriteOutput() {
+        if (output.empty() || failed) {
+            return !failed;
+        }
+        if (!G722Encoder::WriteAt(fd, output.data(), output.size(), kHeaderSize + dataBytes)) {
+            failed = true;
+            return false;
+        }
+        dataBytes += output.size();
+        output.clear();
+        return true;
+    }
+
+    bool WriteHeader() {
+        uint8_t header[kHeaderSize];
+        memcpy(header, "RIFF", 4);
+        PutLE32(header + 4, static_cast<uint32_t>(kHeaderSize - 8 + dataBytes));
+        memcpy(header + 8, "WAVE", 4);
+        memcpy(header + 12, "fmt ", 4);
+        PutLE32(header + 16, 20);
+        PutLE16(header + 20, kFormatG722);
+        PutLE16(header + 22, 1);
+        PutLE32(header + 24, kCodecRate);
+        PutLE32(header + 28, kCodecRate / 2);      // 64kbps
+        PutLE16(header + 32, 1);
+        PutLE16(header + 34, 4);
+        PutLE16(header + 36, 2);                   // cbSize
+        PutLE16(header + 38, 0);
+        memcpy(header + 40, "fact", 4);
+        PutLE32(header + 44, 4);
+        PutLE32(header + 48, static_cast<uint32_t>(codecSamples));
+        memcpy(header + 52, "data", 4);
+        PutLE32(header + 56, static_cast<uint32_t>(dataBytes));
+        if (failed || !G722Encoder::WriteAt(fd, header, sizeof(header), 0)) {
+            failed = true;
+            return false;
+        }
+        return true;
+    }
+
+    Options options;
+    size_t chunkFrames;
+    int fd;
+    uint64_t dataBytes;
+    uint64_t codecSamples;
+    uint64_t framesEncoded;
+    bool failed;
+
+    G722EncoderState state;               // 内嵌状态，不能调用 WebRtc_g722_encode_release（会 free）
+    std::unique_ptr<webrtc::PushSincResampler> resampler;
+    std::vector<float> mono;
+    size_t monoFrames = 0;
+    float resampled[kCodecChunk];
+    int16_t pcm[kCodecChunk];
+    uint8_t coded[kCodecChunk];
+    std::vector<uint8_t> output;
+    AudioKernels::DitherState dither;
+};
+
+G722Encoder::G722Encoder(const Options& options)
+    : impl_(new Impl(options)) {
+}
+
+G722Encoder::~G722Encoder() = default;
+
+bool G722Encoder::Begin(int fd) {
+    Impl& s = *impl_;
+    if (s.options.channels == 0 || s.options.sampleRate == 0 || s.options.sampleRate % 100 != 0) {
+        return false;
+    }
+    s.fd = fd;
+    WebRtc_g722_encode_init(&s.state, 64000, 0);
+    if (s.options.sampleRate != kCodecRate) {
+        s.resampler.reset(new webrtc::PushSincResampler(s.chunkFrames, kCodecChunk));
+    }
+    s.mono.assign(s.chunkFrames, 0.0f);
+    s.output.reserve(kWriteBatchBytes + kCodecChunk);
+    return s.WriteHeader();
+}
+
+bool G722Encoder::Encode(const float* interleaved, size_t frames) {
+    Impl& s = *impl_;
+    const size_t channels = s.options.channels;
+    while (frames > 0 && !s.failed) {
+        const size_t n = std::min(frames, s.chunkFrames - s.monoFrames);
+        float* mono = s.mono.data() + s.monoFrames;
+        if (channels == 1) {
+            std::copy(interleaved, interleaved + n, mono);
+        } else if (channels == 2) {
+            AudioKernels::StereoToMono(interleaved, mono, n);
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                float sum = 0.0f;
+                for (size_t ch = 0; ch < channels; ++ch) {
+                    sum += interleaved[i * channels + ch];
+                }
+                mono[i] = sum / channels;
+            }
+        }
+        s.monoFrames += n;
+        s.framesEncoded += n;
+        interleaved += n * channels;
+        frames -= n;
+        if (s.monoFrames == s.chunkFrames) {
+            s.EncodeChunk();
+            if (s.output.size() >= kWriteBatchBytes) {
+                s.WriteOutput();
+            }
+        }
+    }
+    return !s.failed;
+}
+
+bool G722Encoder::Flush() {
+    return impl_->WriteOutput() && impl_->WriteHeader();
+}
+
+bool G722Encoder::Finish() {
+    Impl& s = *impl_;
+    // 最后不足 10ms 的部分补静音
+    if (s.monoFrames > 0) {
+        std::fill(s.mono.begin() + s.monoFrames, s.mono.end(), 0.0f);
+        s.EncodeChunk();
+    }
+    return s.WriteOutput() && s.WriteHeader();
+}
+
+uint64_t G722Encoder::FramesEncoded() const {
+    return impl_->framesEncoded;
+}
+
+uint64_t G722Encoder::BytesWritten() const {
+    return kHeaderSize + impl_->dataBytes + impl_->output.size();
+}
@@ -0,0 +1,435 @@
+#include "headless_capture_backend.h"
+#include "capture_trace.h"
+#include "level_meter.h"
+#include "logger.h"
+#include "pipeline_metrics.h"
+#include "wav_file_reader.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr double kTwoPi = 6.283185307179586;
+
+} // namespace
+
+class HeadlessCaptureBackend::Impl {
+public:
+    Impl(const Options& options, HeadlessCaptureBackend* owner)
+        : options(options)
+        , owner(owner)
+        , sampleRate(options.sampleRate)
+        , channels(options.channels)
+        , limitFrames(0)
+        , filePosition(0)
+        , releasedPosition(0)
+        , phase(0.0)
+        , noiseState(options.seed ? options.seed : 1)
+        , lowpass(0.0f)
+        , dropoutIntervalFrames(0)
+        , dropoutFrames(0)
+        , nextDropout(0)
+        , clockOrigin(0)
+        , running(false)
+        , finished(false)
+        , frames(0)
+        , sampleTime(0)
+        , callbacks(0)
+        , lateBlocks(0)
+        , lostFrames(0)
+        , traceStream(-1)
+        , traceCursor(0)
+        , skippedBlocks(0) {
+    }
+
+    bool Open() {
+        if (!options.tracePath.empty()) {
+            return OpenTrace();
+        }
+        if (!options.wavPath.empty()) {
+            if (!reader.Open(options.wavPath)) {
+                return false;
+            }
+            sampleRate = reader.SampleRate();
+            channels = reader.Channels();
+            if (reader.Frames() == 0) {
+                Logger::error("WAV 文件没有音频数据: %s", options.wavPath.c_str());
+                return false;
+            }
+        } else if (sampleRate <= 0 || channels == 0) {
+            Logger::error("信号发生器参数无效: %d Hz, %zu 声道", sampleRate, channels);
+            return false;
+        }
+        if (options.blockFrames == 0) {
+            Logger::error("无头采集块大小无效");
+            return false;
+        }
+        limitFrames = options.durationSeconds > 0.0
+            ? static_cast<uint64_t>(options.durationSeconds * sampleRate) : 0;
+        block.assign(options.blockFrames * channels, 0.0f);
+        if (options.dropoutIntervalSeconds > 0.0 && options.dropoutMilliseconds > 0.0) {
+            dropoutIntervalFrames = static_cast<uint64_t>(options.dropoutIntervalSeconds * sampleRate);
+            dropoutFrames = static_cast<uint64_t>(options.dropoutMilliseconds * sampleRate / 1000.0);
+            nextDropout = dropoutIntervalFrames;
+        }
+        return true;
+    }
+
+    bool OpenTrace() {
+        if (!trace.Open(options.tracePath)) {
+            return false;
+        }
+        traceStream = trace.FindStream(options.traceStream);
+        if (traceStream < 0) {
+            Logger::error("采集轨迹 %s 中没有名为 %s 的流", options.tracePath.c_str(), options.traceStream.c_str());
+            return false;
+        }
+        const CaptureTraceReader::StreamInfo& info = trace.Streams()[traceStream];
+        if (info.maxBlockFrames == 0) {
+            Logger::error("采集轨迹 %s 的 %s 流没有数据", options.tracePath.c_str(), options.traceStream.c_str());
+            return false;
+        }
+        if (info.gapFrames > 0) {
+            Logger::warn("采集轨迹 %s 的 %s 流录制时丢失 %llu 帧，回放与原始运行不完全一致",
+                         options.tracePath.c_str(), options.traceStream.c_str(),
+                         static_cast<unsigned long long>(info.gapFrames));
+        }
+        sampleRate = info.sampleRate;
+        channels = info.channels;
+        limitFrames = options.durationSeconds > 0.0
+            ? static_cast<uint64_t>(options.durationSeconds * sampleRate) : 0;
+        block.clear();
+        traceCursor = 0;
+        SeekTraceBlock();
+        return true;
+    }
+
+    // 把 traceCursor 移到本路下一块按注册格式记录的数据，没有时移到末尾
+    void SeekTraceBlock() {
+        for (; traceCursor < trace.RecordCount(); ++traceCursor) {
+            const CaptureTraceReader::Record record = trace.GetRecord(traceCursor);
+            if (record.type != CaptureTrace::RecordType::Block || record.stream != traceStream) {
+                continue;
+            }
+            if (record.sampleRate == sampleRate && record.channels == channels) {
+                return;
+            }
+            skippedBlocks.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // 生成 count 帧到 block，返回实际帧数；设置了电平表时在读取/生成的同时统计电平
+    size_t Fill(size_t count) {
+        LevelMeter* meter = owner->levelMeter_;
+        AudioKernels::LevelStats levels;
+        if (reader.IsOpen()) {
+            size_t done = reader.Read(filePosition, block.data(), count, meter ? &levels : nullptr);
+            if (meter) {
+                meter->Publish(levels);
+            }
+            filePosition += done;
+            // 不循环时读过的部分不会再用，每秒交还一次映射页
+            if (!options.loop && filePosition - releasedPosition >= static_cast<uint64_t>(sampleRate)) {
+                reader.ReleaseBefore(filePosition);
+                releasedPosition = filePosition;
+            }
+            while (done < count && options.loop) {
+                filePosition = 0;
+                const size_t n = reader.Read(0, block.data() + done * channels, count - done, meter ? &levels : nullptr);
+                if (meter) {
+                    meter->Publish(levels);
+                }
+                filePosition += n;
+                done += n;
+            }
+            return done;
+        }
+        Generate(count);
+        if (meter) {
+            AudioKernels::MeasureLevels(block.data(), count * channels, &levels);
+            meter->Publish(levels);
+        }
+        return count;
+    }
+
+    void Generate(size_t count) {
+        float* out = block.data();
+        const double step = kTwoPi * options.frequency / sampleRate;
+        for (size_t i = 0; i < count; ++i) {
+            float v = 0.0f;
+            switch (options.generator) {
+            case Generator::Silence:
+                break;
+            case Generator::Sine:
+                v = options.amplitude * static_cast<float>(std::sin(phase));
+                phase += step;
+                if (phase >= kTwoPi) {
+                    phase -= kTwoPi;
+                }
+                break;
+            case Generator::Noise:
+                v = options.amplitude * NextNoise();
+                break;
+            case Generator::Speech: {
+                // 4 Hz 音节包络，每 3 秒停顿 0.8 秒
+                const double t = static_cast<double>(frames.load(std::memory_order_relaxed) + i) / sampleRate;
+                const double syllable = 0.5 + 0.5 * std::sin(kTwoPi * 4.0 * t);
+                lowpass = 0.85f * lowpass + 0.15f * NextNoise();
+                v = std::fmod(t, 3.0) < 2.2 ? options.amplitude * 2.0f * static_cast<float>(syllable) * lowpass : 0.0f;
+                break;
+            }
+            }
+            for (size_t ch = 0; ch < channels; ++ch) {
+                out[i * channels + ch] = v;
+            }
+        }
+    }
+
+    // xorshift32，均匀分布于 [-1, 1)
+    float NextNoise() {
+        noiseState ^= noiseState << 13;
+        noiseState ^= noiseState >> 17;
+        noiseState ^= noiseState << 5;
+        return static_cast<float>(static_cast<int32_t>(noiseState)) * (1.0f / 2147483648.0f);
+    }
+
+    bool ProduceTraceBlock() {
+        const uint64_t delivered = frames.load(std::memory_order_relaxed);
+        if (traceCursor >= trace.RecordCount() || (limitFrames > 0 && delivered >= limitFrames)) {
+            finished.store(true, std::memory_order_release);
+            return false;
+        }
+        const CaptureTraceReader::Record record = trace.GetRecord(traceCursor);
+        size_t count = record.frames;
+        if (limitFrames > 0) {
+            count = static_cast<size_t>(std::min<uint64_t>(count, limitFrames - delivered));
+        }
+        if (LevelMeter* meter = owner->levelMeter_) {
+            AudioKernels::LevelStats levels;
+            AudioKernels::MeasureLevels(record.samples, count * channels, &levels);
+            meter->Publish(levels);
+        }
+        if (owner->trace_) {
+            owner->trace_->Record(owner->traceStream_, record.samples, count, record.timestamp);
+        }
+        if (owner->callback_) {
+            owner->callback_(record.samples, count, record.timestamp);
+        }
+        sampleTime.store(sampleTime.load(std::memory_order_relaxed) + count, std::memory_order_release);
+        frames.store(delivered + count, std::memory_order_release);
+        callbacks.fetch_add(1, std::memory_order_relaxed);
+        ++traceCursor;
+        SeekTraceBlock();
+        if (traceCursor >= trace.RecordCount() || (limitFrames > 0 && delivered + count >= limitFrames)) {
+            finished.store(true, std::memory_order_release);
+        }
+        return true;
+    }
+
+    bool ProduceBlock() {
+        if (finished.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        if (trace.IsOpen()) {
+            return ProduceTraceBlock();
+        }
+        const uint64_t delivered = frames.load(std::memory_order_relaxed);
+        size_t count = options.blockFrames;
+        if (limitFrames > 0) {
+            count = static_cast<size_t>(std::min<uint64_t>(count, limitFrames - delivered));
+        }
+        count = count > 0 ? Fill(count) : 0;
+        if (count == 0) {
+            finished.store(true, std::memory_order_release);
+            return false;
+        }
+
+        // 到了模拟丢失的时刻：采样时钟跳过一段，数据照常从源中接着取
+        uint64_t position = sampleTime.load(std::memory_order_relaxed);
+        if (dropoutIntervalFrames > 0 && position >= nextDropout) {
+            position += dropoutFrames;
+            nextDropout += dropoutIntervalFrames;
+            lostFrames.fetch_add(dropoutFrames, std::memory_order_relaxed);
+        }
+        if (clockOrigin == 0) {
+            clockOrigin = PipelineMetrics::NowNanoseconds();
+        }
+        CaptureTimestamp timestamp;
+        timestamp.sampleTime = static_cast<double>(position);
+        timestamp.hostNanos = clockOrigin + static_cast<uint64_t>(
+            (options.startDelayMilliseconds / 1000.0 + static_cast<double>(position) / sampleRate) * 1e9);
+        timestamp.flags = CaptureTimestamp::kHostTimeValid | CaptureTimestamp::kSampleTimeValid;
+
+        if (owner->trace_) {
+            owner->trace_->Record(owner->traceStream_, block.data(), count, timestamp);
+        }
+        if (owner->callback_) {
+            owner->callback_(block.data(), count, timestamp);
+        }
+        sampleTime.store(position + count, std::memory_order_release);
+        frames.store(delivered + count, std::memory_order_release);
+        callbacks.fetch_add(1, std::memory_order_relaxed);
+        if (limitFrames > 0 && delivered + count >= limitFrames) {
+            finished.store(true, std::memory_order_release);
+        }
+        return true;
+    }
+
+    uint64_t NextArrivalNanos() const {
+        if (!trace.IsOpen() || finished.load(std::memory_order_acquire) || traceCursor >= trace.RecordCount()) {
+            return UINT64_MAX;
+        }
+        return trace.GetRecord(traceCursor).arrivalNanos;
+    }
+
+    // 按 speed 控制节奏：第 n 帧的送出时刻为 n / (sampleRate * speed)；回放轨迹时按记录的到达时刻
+    void Run() {
+        using Clock = std::chrono::steady_clock;
+        const auto start = Clock::now();
+        const uint64_t firstArrival = NextArrivalNanos();
+        const double blockSeconds = static_cast<double>(options.blockFrames) / sampleRate;
+        while (running.load(std::memory_order_acquire)) {
+            if (trace.IsOpen() && options.speed > 0.0 && NextArrivalNanos() != UINT64_MAX) {
+                const double due = (NextArrivalNanos() - firstArrival) / 1e9 / options.speed;
+                std::this_thread::sleep_until(start + std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(due)));
+            }
+            if (!ProduceBlock()) {
+                break;
+            }
+            if (options.speed <= 0.0 || trace.IsOpen()) {
+                continue;
+            }
+            const double due = static_cast<double>(sampleTime.load(std::memory_order_relaxed)) / sampleRate / options.speed;
+            const auto deadline = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(due));
+            const auto now = Clock::now();
+            if (now > deadline + std::chrono::duration_cast<Clock::duration>(
+                                     std::chrono::duration<double>(blockSeconds / options.speed))) {
+                lateBlocks.fetch_add(1, std::memory_order_relaxed);
+            }
+            std::this_thread::sleep_until(deadline);
+        }
+        running.store(false, std::memory_order_release);
+    }
+
+    Options options;
+    HeadlessCaptureBackend* owner;
+    WavFileReader reader;
+    int sampleRate;
+    size_t channels;
+    uint64_t limitFrames;
+    uint64_t filePosition;
+    uint64_t releasedPosition;
+    double phase;
+    uint32_t noiseState;
+    float lowpass;
+    std::vector<float> block;
+    uint64_t dropoutIntervalFrames;
+    uint64_t dropoutFrames;
+    uint64_t nextDropout;         // 下一次模拟丢失的采样时间
+    uint64_t clockOrigin;
+
+    std::thread thread;
+    std::atomic<bool> running;
+    std::atomic<bool> finished;
+    std::atomic<uint64_t> frames;       // 已送出的帧数
+    std::atomic<uint64_t> sampleTime;   // 采样时钟上的位置，包括丢失的帧
+    std::atomic<uint64_t> callbacks;
+    std::atomic<uint64_t> lateBlocks;
+    std::atomic<uint64_t> lostFrames;
+
+    // 回放采集轨迹，只在产生数据的线程访问
+    CaptureTraceReader trace;
+    int traceStream;
+    size_t traceCursor;           // 下一块在轨迹索引中的位置
+    std::atomic<uint64_t> skippedBlocks;
+};
+
+HeadlessCaptureBackend::HeadlessCaptureBackend(const Options& options)
+    : impl_(new Impl(options, this)) {
+}
+
+HeadlessCaptureBackend::~HeadlessCaptureBackend() {
+    Stop();
+}
+
+bool HeadlessCaptureBackend::Open() {
+    return impl_->Open();
+}
+
+bool HeadlessCaptureBackend::Start() {
+    if (impl_->thread.joinable()) {
+        return impl_->running.load(std::memory_order_acquire);
+    }
+    if (impl_->block.empty() && !impl_->trace.IsOpen()) {
+        Logger::error("无头采集后端尚未打开");
+        return false;
+    }
+    impl_->running.store(true, std::memory_order_release);
+    impl_->thread = std::thread([this] { impl_->Run(); });
+    return true;
+}
+
+void HeadlessCaptureBackend::Stop() {
+    impl_->running.store(false, std::memory_order_release);
+    if (impl_->thread.joinable()) {
+        impl_->thread.join();
+    }
+}
+
+bool HeadlessCaptureBackend::IsRunning() const {
+    return impl_->running.load(std::memory_order_acquire);
+}
+
+int HeadlessCaptureBackend::SampleRate() const {
+    return impl_->sampleRate;
+}
+
+size_t HeadlessCaptureBackend::Channels() const {
+    return impl_->channels;
+}
+
+void HeadlessCaptureBackend::SetClockOrigin(uint64_t hostNanos) {
+    impl_->clockOrigin = hostNanos;
+}
+
+bool HeadlessCaptureBackend::ProduceBlock() {
+    return impl_->ProduceBlock();
+}
+
+double HeadlessCaptureBackend::Position() const {
+    return static_cast<double>(impl_->sampleTime.load(std::memory_order_acquire)) / impl_->sampleRate;
+}
+
+bool HeadlessCaptureBackend::Finished() const {
+    return impl_->finished.load(std::memory_order_acquire);
+}
+
+size_t HeadlessCaptureBackend::MaxBlockFrames() const {
+    if (impl_->trace.IsOpen()) {
+        return impl_->trace.Streams()[impl_->traceStream].maxBlockFrames;
+    }
+    return impl_->options.blockFrames;
+}
+
+bool HeadlessCaptureBackend::IsTrace() const {
+    return impl_->trace.IsOpen();
+}
+
+uint64_t HeadlessCaptureBackend::NextArrivalNanos() const {
+    return impl_->NextArrivalNanos();
+}
+
+HeadlessCaptureBackend::Stats HeadlessCaptureBackend::GetStats() const {
+    Stats stats;
+    stats.frames = impl_->frames.load(std::memory_order_acquire);
+    stats.callbacks = impl_->callbacks.load(std::memory_order_relaxed);
+    stats.lateBlocks = impl_->lateBlocks.load(std::memory_order_relaxed);
+    stats.lostFrames = impl_->lostFrames.load(std::memory_order_relaxed);
+    stats.skippedBlocks = impl_->skippedBlocks.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,721 @@
+#include "headless_recorder.h"
+#include "audio_kernels.h"
+#include "audio_mixer.h"
+#include "capture_trace.h"
+#include "drift_compensating_resampler.h"
+#include "dsp_worker.h"
+#include "echo_cancellation_stage.h"
+#include "logger.h"
+#include "pcm_stream.h"
+#include "pipeline_metrics.h"
+#include "stream_aligner.h"
+#include "streaming_wav_writer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+
+namespace {
+
+// 写入队列超过一半时驱动线程暂停推进，不限速回放时避免写线程跟不上而丢数据
+constexpr double kWriterBackpressureRatio = 0.5;
+
+// 与 av_engine_taps_main 中 inputNode/sourceNode 的 0.5 音量一致，音量设置在此基础上缩放
+constexpr float kMixBaseGain = 0.5f;
+enum MixInput : size_t { kMixMicrophone = 0, kMixSystem = 1 };
+enum AlignStream : size_t { kAlignMicrophone = 0, kAlignSystem = 1 };
+
+double ProcessCpuSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+}
+
+double WallSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::string OutputStem(const std::string& path, AudioEncoder::Codec codec) {
+    const std::string suffix = AudioEncoder::Extension(codec);
+    if (path.size() > suffix.size() && path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0) {
+        return path.substr(0, path.size() - suffix.size());
+    }
+    return path;
+}
+
+// 标称回调周期，不限速回放时返回 0（不统计抖动）
+uint64_t CallbackPeriodNanoseconds(size_t blockFrames, int sampleRate, double speed) {
+    if (speed <= 0.0 || sampleRate <= 0) {
+        return 0;
+    }
+    return static_cast<uint64_t>(static_cast<double>(blockFrames) * 1e9 / sampleRate / speed);
+}
+
+// 把上一段到现在的耗时记入 histogram，返回现在的时间作为下一段的起点
+uint64_t Lap(PipelineMetrics::Histogram* histogram, uint64_t start) {
+    const uint64_t now = PipelineMetrics::NowNanoseconds();
+    histogram->Record(now - start);
+    return now;
+}
+
+} // namespace
+
+class HeadlessRecorder::Impl {
+public:
+    Impl(const Options& options, PcmStream* stream, PipelineMetrics& metrics)
+        : system(options.system)
+        , microphone(options.microphone)
+        , pcmStream(stream)
+        , metrics(metrics)
+        , micChannels(0)
+        , startWall(0.0)
+        , startCpu(0.0)
+        , endWall(0.0)
+        , endCpu(0.0) {
+    }
+
+    bool Open(const Options& options, const std::string& mixPath) {
+        if (!system.Open() || !microphone.Open()) {
+            return false;
+        }
+        micChannels = microphone.Channels();
+        if (micChannels > 2 || system.Channels() > 2) {
+            Logger::error("无头录音只支持单声道或立体声输入: 系统 %zu 声道, 麦克风 %zu 声道",
+                          system.Channels(), micChannels);
+            return false;
+        }
+
+        const int sessionRate = microphone.SampleRate();
+        DriftCompensatingResampler::Options resamplerOptions;
+        resamplerOptions.inputRate = system.SampleRate();
+        resamplerOptions.outputRate = sessionRate;
+        resamplerOptions.channels = 2;
+        if (!resampler.Initialize(resamplerOptions)) {
+            return false;
+        }
+
+        if (options.echoCancellation) {
+            EchoCancellationStage::Options echoOptions;
+            echoOptions.sampleRate = sessionRate;
+            echoOptions.renderChannels = 2;
+            echoOptions.captureChannels = micChannels;
+            if (!echo.Initialize(echoOptions)) {
+                Logger::warn("回声消除初始化失败，继续录制未处理的麦克风音频");
+            }
+        }
+
+        AudioMixer::Options mixerOptions;
+        mixerOptions.sampleRate = sessionRate;
+        mixerOptions.channels = 2;
+        mixerOptions.inputChannels = {micChannels, 2};
+        if (!mixer.Initialize(mixerOptions)) {
+            return false;
+        }
+        SetVolume(kMixMicrophone, options.microphoneVolume);
+        SetVolume(kMixSystem, options.systemAudioVolume);
+
+        // 回放轨迹时块大小以记录为准
+        const size_t micBlockFrames = microphone.MaxBlockFrames();
+        const size_t systemBlockFrames = system.MaxBlockFrames();
+        systemStereo.assign(systemBlockFrames * 2, 0.0f);
+        sessionSystem.assign(micBlockFrames * 2, 0.0f);
+        micBlock.assign(micBlockFrames * micChannels, 0.0f);
+        mixBlock.assign(micBlockFrames * 2, 0.0f);
+        micPlanar.assign(micChannels, std::vector<float>(micBlockFrames, 0.0f));
+        micPlanes.clear();
+        for (auto& plane : micPlanar) {
+            micPlanes.push_back(plane.data());
+        }
+
+        RegisterMetrics(options);
+        if (options.alignStreams && !InitializeAligner()) {
+            return false;
+        }
+        // 两路共用一个虚拟主机时钟，时间戳之差只反映模拟的启动延迟和丢失
+        const uint64_t clockOrigin = PipelineMetrics::NowNanoseconds();
+        system.SetClockOrigin(clockOrigin);
+        microphone.SetClockOrigin(clockOrigin);
+        if (!options.tracePath.empty() && !OpenTrace(options.tracePath)) {
+            return false;
+        }
+        system.SetDataCallback([this](const float* data, size_t frames, const CaptureTimestamp& timestamp) {
+            OnSystem(data, frames, timestamp);
+        });
+        microphone.SetDataCallback([this](const float* data, size_t frames, const CaptureTimestamp& timestamp) {
+            OnMicrophone(data, frames, timestamp);
+        });
+
+        // 编码由输出路径的扩展名决定，三路文件使用相同的编码
+        const AudioEncoder::Codec codec = AudioEncoder::CodecForPath(mixPath);
+        const std::string stem = OutputStem(mixPath, codec);
+        const std::string extension = AudioEncoder::Extension(codec);
+        StreamingWavWriter::Options mixOptions;
+        mixOptions.sampleRate = static_cast<uint32_t>(sessionRate);
+        mixOptions.channels = 2;
+        mixOptions.codec = codec;
+        mixOptions.segmentSeconds = options.segmentSeconds;
+        mixOptions.elideSilence = options.elideSilence;
+        StreamingWavWriter::Options micOptions = mixOptions;
+        micOptions.channels = static_cast<uint16_t>(micChannels);
+        StreamingWavWriter::Options sourceOptions = mixOptions;
+        if (!mixWriter.Open(stem + extension, mixOptions) ||
+            !micWriter.Open(stem + "_mic" + extension, micOptions) ||
+            !sourceWriter.Open(stem + "_source" + extension, sourceOptions)) {
+            Logger::error("创建输出音频文件失败");
+            Close();
+            return false;
+        }
+
+        if (options.micProcessing) {
+            DspWorker::Session::Options dspOptions;
+            dspOptions.chain.sampleRate = sessionRate;
+            dspOptions.chain.channels = micChannels;
+            // 开启回声消除时高通滤波已在回声消除级完成
+            dspOptions.chain.highPassFilter = !echo.IsInitialized();
+            dspOptions.chain.metrics = &metrics;
+            dspOptions.chain.metricsPrefix = "dsp.microphone";
+            dspOptions.writer = &micWriter;
+            dspWorker = DspWorker::Shared();
+            micDsp = dspWorker->AddSession(dspOptions);
+            if (!micDsp) {
+                Logger::warn("麦克风 DSP 处理初始化失败，写入未处理的麦克风音频");
+                dspWorker.reset();
+            }
+        }
+        return true;
+    }
+
+    bool OpenTrace(const std::string& path) {
+        if (!trace.Open(path)) {
+            return false;
+        }
+        const int systemStream = trace.AddStream("system", system.SampleRate(), system.Channels());
+        const int microphoneStream = trace.AddStream("microphone", microphone.SampleRate(), microphone.Channels());
+        system.SetTrace(&trace, systemStream);
+        microphone.SetTrace(&trace, microphoneStream);
+        return true;
+    }
+
+    void Close() {
+        if (trace.IsOpen()) {
+            trace.Event(-1, "stop");
+            trace.Close();
+        }
+        // 会话销毁时在当前线程处理完剩余输入，必须先于麦克风文件关闭
+        micDsp.reset();
+        dspWorker.reset();
+        mixWriter.Close();
+        micWriter.Close();
+        sourceWriter.Close();
+        echo.Release();
+        if (aligner.IsInitialized()) {
+            const StreamAligner::Stats alignStats = aligner.GetStats();
+            const StreamAligner::StreamStats& mic = alignStats.streams[kAlignMicrophone];
+            const StreamAligner::StreamStats& source = alignStats.streams[kAlignSystem];
+            Logger::info("时间戳对齐: 起始偏差 %.2f ms, 剩余偏差 %.3f ms; 麦克风补 %llu 帧/裁 %llu 帧, "
+                         "系统音频补 %llu 帧/裁 %llu 帧",
+                         (mic.startSkewNanos - source.startSkewNanos) / 1e6,
+                         aligner.RelativeOffsetNanos(kAlignMicrophone, kAlignSystem) / 1e6,
+                         static_cast<unsigned long long>(mic.insertedFrames),
+                         static_cast<unsigned long long>(mic.trimmedFrames),
+                         static_cast<unsigned long long>(source.insertedFrames),
+                         static_cast<unsigned long long>(source.trimmedFrames));
+        }
+        if (mixer.IsInitialized()) {
+            const AudioMixer::Stats mixStats = mixer.GetStats();
+            Logger::info("混音: %llu 帧中 %llu 帧经过限幅, 限幅前峰值 %.2f",
+                         static_cast<unsigned long long>(mixStats.blocks),
+                         static_cast<unsigned long long>(mixStats.limitedBlocks), mixStats.peak);
+        }
+    }
+
+    // 任意线程调用，增益在混音器内部平滑过渡
+    void SetVolume(MixInput input, float volume) {
+        mixer.SetGain(input, kMixBaseGain * volume);
+    }
+
+    // 系统音频回调的指标名称与 AudioSystemCapture 一致，见 PipelineMetrics
+    void RegisterMetrics(const Options& options) {
+        systemTimer.Attach(&metrics.GetHistogram("callback.system_ns"),
+                           &metrics.GetHistogram("callback.system_jitter_ns"),
+                           CallbackPeriodNanoseconds(system.MaxBlockFrames(), system.SampleRate(), options.speed));
+        microphoneTimer.Attach(&metrics.GetHistogram("callback.microphone_ns"),
+                               &metrics.GetHistogram("callback.microphone_jitter_ns"),
+                               CallbackPeriodNanoseconds(microphone.MaxBlockFrames(), microphone.SampleRate(),
+                                                         options.speed));
+        resampleTime = &metrics.GetHistogram("stage.resample_ns");
+        echoTime = &metrics.GetHistogram("stage.echo_cancellation_ns");
+        mixTime = &metrics.GetHistogram("stage.mix_ns");
+        writeTime = &metrics.GetHistogram("stage.write_ns");
+        resamplerFill = &metrics.GetGauge("fill.resampler_frames");
+        mixQueue = &metrics.GetGauge("fill.writer_mix_frames");
+        micQueue = &metrics.GetGauge("fill.writer_mic_frames");
+        sourceQueue = &metrics.GetGauge("fill.writer_source_frames");
+        pcmQueue = &metrics.GetGauge("fill.pcm_stream_frames");
+        resamplerUnderruns = &metrics.GetGauge("resampler.underruns");
+        resamplerDropped = &metrics.GetGauge("dropped.resampler_samples");
+        writerDropped = &metrics.GetCounter("dropped.writer_frames");
+        pcmDropped = &metrics.GetCounter("dropped.pcm_stream_frames");
+    }
+
+    // 两路的输出分别接到系统音频和麦克风的处理，补的静音按各自的块大小分块送出
+    bool InitializeAligner() {
+        std::vector<StreamAligner::StreamOptions> streams(2);
+        streams[kAlignMicrophone].name = "microphone";
+        streams[kAlignMicrophone].sampleRate = microphone.SampleRate();
+        streams[kAlignMicrophone].channels = micChannels;
+        streams[kAlignMicrophone].maxBlockFrames = microphone.MaxBlockFrames();
+        streams[kAlignMicrophone].output = [this](const float* data, size_t frames) { ProcessMicrophone(data, frames); };
+        streams[kAlignSystem].name = "system";
+        streams[kAlignSystem].sampleRate = system.SampleRate();
+        streams[kAlignSystem].channels = system.Channels();
+        streams[kAlignSystem].maxBlockFrames = system.MaxBlockFrames();
+        streams[kAlignSystem].output = [this](const float* data, size_t frames) { PushSystem(data, frames); };
+        StreamAligner::Options alignOptions;
+        alignOptions.metrics = &metrics;
+        return aligner.Initialize(alignOptions, streams);
+    }
+
+    // 对应系统音频 IOProc：对齐后只送入漂移补偿重采样器
+    void OnSystem(const float* data, size_t frames, const CaptureTimestamp& timestamp) {
+        const uint64_t start = systemTimer.Begin();
+        if (aligner.IsInitialized()) {
+            aligner.Push(kAlignSystem, data, frames, timestamp);
+        } else {
+            PushSystem(data, frames);
+        }
+        systemTimer.End(start);
+    }
+
+    void PushSystem(const float* data, size_t frames) {
+        if (system.Channels() == 1) {
+            AudioKernels::MonoToStereo(data, systemStereo.data(), frames);
+            data = systemStereo.data();
+        }
+        resampler.Push(data, frames);
+    }
+
+    void OnMicrophone(const float* data, size_t frames, const CaptureTimestamp& timestamp) {
+        const uint64_t start = microphoneTimer.Begin();
+        if (aligner.IsInitialized()) {
+            aligner.Push(kAlignMicrophone, data, frames, timestamp);
+        } else {
+            ProcessMicrophone(data, frames);
+        }
+        UpdateLevels();
+        microphoneTimer.End(start);
+    }
+
+    // 对应引擎渲染回调：以麦克风时钟拉取系统音频，回声消除后混合写盘
+    void ProcessMicrophone(const float* data, size_t frames) {
+        const uint64_t start = PipelineMetrics::NowNanoseconds();
+        float* source = sessionSystem.data();
+        resampler.Pull(source, frames);
+        uint64_t lap = Lap(resampleTime, start);
+
+        const size_t micSamples = frames * micChannels;
+        std::copy(data, data + micSamples, micBlock.data());
+        if (echo.IsInitialized()) {
+            echo.AnalyzeRender(source, frames);
+            AudioKernels::Deinterleave(micBlock.data(), micPlanes.data(), micChannels, frames);
+            echo.ProcessCapture(micPlanes.data(), frames);
+            AudioKernels::Interleave(micPlanes.data(), micBlock.data(), micChannels, frames);
+            lap = Lap(echoTime, lap);
+        }
+
+        const float* mixInputs[] = {micBlock.data(), source};
+        mixer.Process(mixInputs, mixBlock.data(), frames);
+        lap = Lap(mixTime, lap);
+
+        uint64_t dropped = 0;
+        if (micDsp) {
+            dropped += micDsp->Write(micBlock.data(), frames) ? 0 : frames;
+        } else {
+            dropped += micWriter.Write(micBlock.data(), frames) ? 0 : frames;
+        }
+        dropped += sourceWriter.Write(source, frames) ? 0 : frames;
+        dropped += mixWriter.Write(mixBlock.data(), frames) ? 0 : frames;
+        if (dropped > 0) {
+            writerDropped->Add(dropped);
+        }
+        if (pcmStream && !pcmStream->Write(mixBlock.data(), frames) && pcmStream->IsActive()) {
+            pcmDropped->Add(frames);
+        }
+        Lap(writeTime, lap);
+    }
+
+    // 各级缓冲的水位，每个麦克风块更新一次
+    void UpdateLevels() {
+        const DriftCompensatingResampler::Stats resamplerStats = resampler.GetStats();
+        resamplerFill->Set(static_cast<uint64_t>(std::max(resamplerStats.latencyFrames, 0.0)));
+        resamplerUnderruns->Set(resamplerStats.underruns);
+        resamplerDropped->Set(resamplerStats.droppedSamples);
+        mixQueue->Set(mixWriter.QueuedFrames());
+        micQueue->Set(micWriter.QueuedFrames());
+        sourceQueue->Set(sourceWriter.QueuedFrames());
+        if (pcmStream) {
+            pcmQueue->Set(pcmStream->PendingFrames());
+        }
+    }
+
+    // 任一写入队列或 PCM 流积压过半时返回 true
+    bool WritersBacklogged() const {
+        for (const StreamingWavWriter* writer : {&mixWriter, &micWriter, &sourceWriter}) {
+            if (writer->QueuedFrames() > writer->QueueCapacityFrames() * kWriterBackpressureRatio) {
+                return true;
+            }
+        }
+        if (micDsp && micDsp->QueuedFrames() > micDsp->QueueCapacityFrames() * kWriterBackpressureRatio) {
+            return true;
+        }
+        return pcmStream && pcmStream->IsBacklogged();
+    }
+
+    uint64_t DroppedFrames() const {
+        return mixWriter.DroppedFrames() + micWriter.DroppedFrames() + sourceWriter.DroppedFrames();
+    }
+
+    HeadlessCaptureBackend system;
+    HeadlessCaptureBackend microphone;
+    CaptureTraceWriter trace;
+    StreamAligner aligner;
+    DriftCompensatingResampler resampler;
+    EchoCancellationStage echo;
+    AudioMixer mixer;
+    StreamingWavWriter mixWriter;
+    StreamingWavWriter micWriter;
+    StreamingWavWriter sourceWriter;
+    std::shared_ptr<DspWorker> dspWorker;
+    std::unique_ptr<DspWorker::Session> micDsp;
+    PcmStream* pcmStream;
+    PipelineMetrics& metrics;
+    size_t micChannels;
+
+    // 驱动线程是各指标唯一的写线程
+    PipelineMetrics::CallbackTimer systemTimer;
+    PipelineMetrics::CallbackTimer microphoneTimer;
+    PipelineMetrics::Histogram* resampleTime = nullptr;
+    PipelineMetrics::Histogram* echoTime = nullptr;
+    PipelineMetrics::Histogram* mixTime = nullptr;
+    PipelineMetrics::Histogram* writeTime = nullptr;
+    PipelineMetrics::Gauge* resamplerFill = nullptr;
+    PipelineMetrics::Gauge* mixQueue = nullptr;
+    PipelineMetrics::Gauge* micQueue = nullptr;
+    PipelineMetrics::Gauge* sourceQueue = nullptr;
+    PipelineMetrics::Gauge* pcmQueue = nullptr;
+    PipelineMetrics::Gauge* resamplerUnderruns = nullptr;
+    PipelineMetrics::Gauge* resamplerDropped = nullptr;
+    PipelineMetrics::Counter* writerDropped = nullptr;
+    PipelineMetrics::Counter* pcmDropped = nullptr;
+
+    // 回调使用的预分配缓冲区，按各自的块大小在 Open() 中分配
+    std::vector<float> systemStereo;
+    std::vector<float> sessionSystem;
+    std::vector<float> micBlock;
+    std::vector<float> mixBlock;
+    std::vector<std::vector<float>> micPlanar;
+    std::vector<float*> micPlanes;
+
+    double startWall;
+    double startCpu;
+    std::atomic<double> endWall;
+    std::atomic<double> endCpu;
+};
+
+HeadlessRecorder::Options::Options() {
+    system.generator = HeadlessCaptureBackend::Generator::Speech;
+    system.sampleRate = 48000;
+    system.channels = 2;
+    system.seed = 1;
+    microphone.generator = HeadlessCaptureBackend::Generator::Speech;
+    microphone.sampleRate = 48000;
+    microphone.channels = 1;
+    microphone.seed = 2;
+    microphone.blockFrames = 480;
+}
+
+HeadlessRecorder::Options HeadlessRecorder::Options::FromEnvironment() {
+    Options options;
+    if (const char* path = getenv("RECORDER_SYSTEM_WAV")) {
+        options.system.wavPath = path;
+    }
+    if (const char* path = getenv("RECORDER_MIC_WAV")) {
+        options.microphone.wavPath = path;
+    }
+    if (const char* speed = getenv("RECORDER_SPEED")) {
+        options.speed = atof(speed);
+    }
+    if (const char* duration = getenv("RECORDER_DURATION")) {
+        options.system.durationSeconds = options.microphone.durationSeconds = atof(duration);
+    }
+    if (const char* aec = getenv("RECORDER_AEC")) {
+        options.echoCancellation = atoi(aec) != 0;
+    }
+    if (const char* segment = getenv("RECORDER_SEGMENT_SECONDS")) {
+        options.segmentSeconds = static_cast<uint32_t>(std::max(0, atoi(segment)));
+    }
+    if (const char* setup = getenv("RECORDER_SETUP_MS")) {
+        options.setupMilliseconds = static_cast<uint32_t>(std::max(0, atoi(setup)));
+    }
+    if (const char* elide = getenv("RECORDER_ELIDE_SILENCE")) {
+        options.elideSilence = atoi(elide) != 0;
+    }
+    if (const char* dsp = getenv("RECORDER_DSP")) {
+        options.micProcessing = atoi(dsp) != 0;
+    }
+    if (const char* align = getenv("RECORDER_ALIGN")) {
+        options.alignStreams = atoi(align) != 0;
+    }
+    if (const char* trace = getenv("RECORDER_TRACE")) {
+        options.tracePath = trace;
+    }
+    return options;
+}
+
+HeadlessRecorder::HeadlessRecorder()
+    : HeadlessRecorder(nullptr, Options::FromEnvironment()) {
+}
+
+HeadlessRecorder::HeadlessRecorder(AudioRecorder* recorder)
+    : HeadlessRecorder(recorder, Options::FromEnvironment()) {
+}
+
+HeadlessRecorder::HeadlessRecorder(AudioRecorder* recorder, const Options& options)
+    : recorder_(recorder)
+    , options_(options)
+    , outputPath_("mix_audio.wav")
+    , pcmStream_(nullptr)
+    , running_(false)
+    , paused_(false)
+    , finished_(false) {
+}
+
+HeadlessRecorder::~HeadlessRecorder() {
+    Stop();
+}
+
+bool HeadlessRecorder::Start() {
+    if (running_.load(std::memory_order_acquire)) {
+        return true;
+    }
+    if (options_.setupMilliseconds > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(options_.setupMilliseconds));
+    }
+    metrics_.Reset();
+    impl_.reset(new Impl(options_, pcmStream_, metrics_));
+    if (!impl_->Open(options_, outputPath_)) {
+        impl_.reset();
+        return false;
+    }
+    if (pcmStream_ && !pcmStream_->Begin(static_cast<uint32_t>(impl_->microphone.SampleRate()), 2)) {
+        impl_->Close();
+        impl_.reset();
+        return false;
+    }
+    systemLevels_.Configure(impl_->system.SampleRate(), impl_->system.Channels());
+    microphoneLevels_.Configure(impl_->microphone.SampleRate(), impl_->microphone.Channels());
+    impl_->system.SetLevelMeter(&systemLevels_);
+    impl_->microphone.SetLevelMeter(&microphoneLevels_);
+
+    Logger::info("无头录音开始: 系统 %d Hz/%zu 声道, 麦克风 %d Hz/%zu 声道, 速度 %s",
+                 impl_->system.SampleRate(), impl_->system.Channels(),
+                 impl_->microphone.SampleRate(), impl_->microphone.Channels(),
+                 options_.speed > 0.0 ? std::to_string(options_.speed).c_str() : "不限");
+
+    finished_ = false;
+    paused_.store(false, std::memory_order_release);
+    running_.store(true, std::memory_order_release);
+    impl_->startWall = WallSeconds();
+    impl_->startCpu = ProcessCpuSeconds();
+    impl_->endWall.store(0.0, std::memory_order_relaxed);
+    if (impl_->trace.IsOpen()) {
+        impl_->trace.Event(-1, "start");
+    }
+    driver_ = std::thread(&HeadlessRecorder::DriverLoop, this);
+    return true;
+}
+
+// 两路后端谁的音频时间落后就先推进谁，按麦克风时钟控制节奏；麦克风数据结束即录制结束
+// 回放采集轨迹时改为谁的下一块先到达就先推进谁，按到达时刻控制节奏
+void HeadlessRecorder::DriverLoop() {
+    using Clock = std::chrono::steady_clock;
+    HeadlessCaptureBackend& system = impl_->system;
+    HeadlessCaptureBackend& microphone = impl_->microphone;
+    const bool replay = system.IsTrace() && microphone.IsTrace();
+    auto origin = Clock::now();
+    double originAudio = 0.0;
+    uint64_t originArrival = std::min(system.NextArrivalNanos(), microphone.NextArrivalNanos());
+
+    while (running_.load(std::memory_order_acquire) && !microphone.Finished()) {
+        if (paused_.load(std::memory_order_acquire)) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] {
+                return !paused_.load(std::memory_order_acquire) || !running_.load(std::memory_order_acquire);
+            });
+            origin = Clock::now();
+            originAudio = microphone.Position();
+            originArrival = std::min(system.NextArrivalNanos(), microphone.NextArrivalNanos());
+            continue;
+        }
+
+        if (replay) {
+            const uint64_t systemArrival = system.NextArrivalNanos();
+            const uint64_t microphoneArrival = microphone.NextArrivalNanos();
+            if (options_.speed > 0.0) {
+                const double due = (std::min(systemArrival, microphoneArrival) - originArrival) / 1e9 / options_.speed;
+                std::this_thread::sleep_until(origin + std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(due)));
+            }
+            if (systemArrival <= microphoneArrival) {
+                system.ProduceBlock();
+            } else {
+                microphone.ProduceBlock();
+            }
+        } else if (!system.Finished() && system.Position() <= microphone.Position()) {
+            system.ProduceBlock();
+        } else {
+            microphone.ProduceBlock();
+        }
+
+        if (options_.speed > 0.0 && !replay) {
+            const double due = (microphone.Position() - originAudio) / options_.speed;
+            std::this_thread::sleep_until(origin + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(due)));
+        }
+        while (impl_->WritersBacklogged() && running_.load(std::memory_order_acquire)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    impl_->endWall.store(WallSeconds(), std::memory_order_relaxed);
+    impl_->endCpu.store(ProcessCpuSeconds(), std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finished_ = true;
+    }
+    cv_.notify_all();
+}
+
+void HeadlessRecorder::WaitUntilFinished() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return finished_ || !running_.load(std::memory_order_acquire); });
+}
+
+void HeadlessRecorder::Stop() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    cv_.notify_all();
+    if (driver_.joinable()) {
+        driver_.join();
+    }
+    impl_->Close();
+    if (pcmStream_) {
+        pcmStream_->End();
+    }
+
+    const Stats stats = GetStats();
+    Logger::info("无头录音结束: 音频 %.1f 秒, 墙钟 %.2f 秒, CPU %.2f 秒, 每 CPU 秒处理 %.1f 秒音频, 丢弃 %llu 帧",
+                 stats.audioSeconds, stats.wallSeconds, stats.cpuSeconds,
+                 stats.cpuSeconds > 0.0 ? stats.audioSeconds / stats.cpuSeconds : 0.0,
+                 static_cast<unsigned long long>(stats.droppedFrames));
+    PipelineMetrics::Log(metrics_.GetSnapshot(), "无头录音");
+}
+
+bool HeadlessRecorder::IsRecording() const {
+    return running_.load(std::memory_order_acquire) && !paused_.load(std::memory_order_acquire);
+}
+
+void HeadlessRecorder::Pause() {
+    paused_.store(true, std::memory_order_release);
+    if (impl_ && impl_->trace.IsOpen()) {
+        impl_->trace.Event(-1, "pause");
+    }
+}
+
+void HeadlessRecorder::Resume() {
+    if (impl_ && impl_->trace.IsOpen()) {
+        impl_->trace.Event(-1, "resume");
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        paused_.store(false, std::memory_order_release);
+    }
+    cv_.notify_all();
+}
+
+bool HeadlessRecorder::IsRunning() const {
+    return running_.load(std::memory_order_acquire);
+}
+
+void HeadlessRecorder::SetOutputPath(const std::string& path) {
+    if (!path.empty()) {
+        outputPath_ = path;
+    }
+}
+
+std::string HeadlessRecorder::GetCurrentMicrophoneApp() const {
+    return "";
+}
+
+void HeadlessRecorder::SetPcmStream(PcmStream* stream) {
+    if (running_.load(std::memory_order_acquire)) {
+        Logger::warn("录制中不能更换 PCM 流");
+        return;
+    }
+    pcmStream_ = stream;
+}
+
+void HeadlessRecorder::SetSystemAudioVolume(float volume) {
+    options_.systemAudioVolume = volume;
+    if (impl_) {
+        impl_->SetVolume(kMixSystem, volume);
+    }
+}
+
+void HeadlessRecorder::SetMicrophoneVolume(float volume) {
+    options_.microphoneVolume = volume;
+    if (impl_) {
+        impl_->SetVolume(kMixMicrophone, volume);
+    }
+}
+
+HeadlessRecorder::Stats HeadlessRecorder::GetStats() const {
+    Stats stats{};
+    if (!impl_) {
+        return stats;
+    }
+    double endWall = impl_->endWall.load(std::memory_order_relaxed);
+    double endCpu = impl_->endCpu.load(std::memory_order_relaxed);
+    if (endWall == 0.0) {
+        endWall = WallSeconds();
+        endCpu = ProcessCpuSeconds();
+    }
+    stats.audioSeconds = impl_->microphone.Position();
+    stats.wallSeconds = endWall - impl_->startWall;
+    stats.cpuSeconds = endCpu - impl_->startCpu;
+    stats.droppedFrames = impl_->DroppedFrames();
+    stats.resamplerUnderruns = impl_->resampler.GetStats().underruns;
+    if (impl_->aligner.IsInitialized()) {
+        const StreamAligner::Stats alignStats = impl_->aligner.GetStats();
+        stats.startSkewNanos = alignStats.streams[kAlignMicrophone].startSkewNanos -
+                               alignStats.streams[kAlignSystem].startSkewNanos;
+        stats.streamOffsetNanos = impl_->aligner.RelativeOffsetNanos(kAlignMicrophone, kAlignSystem);
+        for (const StreamAligner::StreamStats& stream : alignStats.streams) {
+            stats.alignedFrames += stream.insertedFrames + stream.trimmedFrames;
+        }
+    }
+    return stats;
+}
+
+PipelineMetrics::Snapshot HeadlessRecorder::GetMetrics() const {
+    return metrics_.GetSnapshot();
+}
+
+CaptureLevels HeadlessRecorder::GetLevels() const {
+    CaptureLevels levels;
+    levels.microphone = microphoneLevels_.Read();
+    levels.system = systemLevels_.Read();
+    return levels;
+}
@@ -0,0 +1,100 @@
+#include "level_meter.h"
+#include <algorithm>
+#include <cmath>
+
+LevelMeter::LevelMeter()
+    : windowSamples_(0)
+    , totalSamples_(0)
+    , nextPublish_(0)
+    , samples_(0)
+    , peak_(0.0f)
+    , sumSquares_(0.0)
+    , sum_(0.0)
+    , clipped_(0)
+    , totalClipped_(0)
+    , windows_(0)
+    , sequence_(0)
+    , peakOut_(0.0f)
+    , rmsOut_(0.0f)
+    , dcOut_(0.0f)
+    , clippedOut_(0)
+    , totalClippedOut_(0)
+    , windowsOut_(0) {
+}
+
+void LevelMeter::Configure(int sampleRate, size_t channels, uint32_t windowMilliseconds) {
+    windowSamples_ = std::max<uint64_t>(1, static_cast<uint64_t>(sampleRate) * channels * windowMilliseconds / 1000);
+    totalSamples_ = 0;
+    nextPublish_ = windowSamples_;
+    samples_ = 0;
+    peak_ = 0.0f;
+    sumSquares_ = 0.0;
+    sum_ = 0.0;
+    clipped_ = 0;
+    totalClipped_ = 0;
+    windows_ = 0;
+    Store();
+}
+
+void LevelMeter::Publish(const AudioKernels::LevelStats& stats) {
+    if (stats.samples == 0) {
+        return;
+    }
+    peak_ = std::max(peak_, stats.peak);
+    sumSquares_ += stats.sumSquares;
+    sum_ += stats.sum;
+    clipped_ += stats.clipped;
+    totalClipped_ += stats.clipped;
+    samples_ += stats.samples;
+    totalSamples_ += stats.samples;
+    if (totalSamples_ < nextPublish_) {
+        return;
+    }
+    // 一块跨过多个发布点时只发布一次
+    while (nextPublish_ <= totalSamples_) {
+        nextPublish_ += windowSamples_;
+    }
+    ++windows_;
+    Store();
+    samples_ = 0;
+    peak_ = 0.0f;
+    sumSquares_ = 0.0;
+    sum_ = 0.0;
+    clipped_ = 0;
+}
+
+// 写入前后各把序号加一，读者看到奇数或前后序号不同时重读
+void LevelMeter::Store() {
+    const uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    const double n = samples_ > 0 ? static_cast<double>(samples_) : 1.0;
+    peakOut_.store(peak_, std::memory_order_relaxed);
+    rmsOut_.store(static_cast<float>(std::sqrt(sumSquares_ / n)), std::memory_order_relaxed);
+    dcOut_.store(static_cast<float>(sum_ / n), std::memory_order_relaxed);
+    clippedOut_.store(clipped_, std::memory_order_relaxed);
+    totalClippedOut_.store(totalClipped_, std::memory_order_relaxed);
+    windowsOut_.store(windows_, std::memory_order_relaxed);
+    sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+LevelMeter::Levels LevelMeter::Read() const {
+    Levels levels;
+    for (;;) {
+        const uint32_t before = sequence_.load(std::memory_order_acquire);
+        levels.peak = peakOut_.load(std::memory_order_relaxed);
+        levels.rms = rmsOut_.load(std::memory_order_relaxed);
+        levels.dc = dcOut_.load(std::memory_order_relaxed);
+        levels.clipped = clippedOut_.load(std::memory_order_relaxed);
+        levels.totalClipped = totalClippedOut_.load(std::memory_order_relaxed);
+        levels.windows = windowsOut_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if ((before & 1) == 0 && sequence_.load(std::memory_order_relaxed) == before) {
+            return levels;
+        }
+    }
+}
+
+float LevelMeter::ToDecibels(float linear) {
+    return linear > 1e-6f ? std::max(-120.0f, 20.0f * std::log10(linear)) : -120.0f;
+}
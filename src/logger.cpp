@@ -2,186 +2,608 @@
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/sinks/rotating_file_sink.h>
-#include <spdlog/fmt/fmt.h>
+#include <spdlog/details/os.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
 #include <filesystem>
-#include <cstdarg>
+#include <mutex>
+#include <thread>
+#include <vector>
 
-std::shared_ptr<spdlog::logger> Logger::logger_ = nullptr;
-Logger::Level Logger::currentLevel_ = Logger::Level::INFO;
-bool Logger::initialized_ = false;
+std::atomic<int> Logger::currentLevel_(static_cast<int>(Logger::Level::INFO));
+
+namespace {
+
+constexpr size_t kQueueRecords = 1024;     // 必须是 2 的幂
+constexpr size_t kRecordBytes = 512;
+constexpr int kPushAttempts = 16;          // 与其他生产者争用时的最大重试次数
+constexpr auto kPollInterval = std::chrono::milliseconds(5);
+
+// 记录中的参数，字符串以 text 中的偏移和长度保存
+struct StoredArg {
+    Logger::Arg::Type type;
+    union {
+        int64_t i;
+        uint64_t u;
+        double d;
+        const void* p;
+        struct {
+            uint16_t offset;
+            bool null;
+        } s;
+    };
+};
+
+struct RecordHeader {
+    std::atomic<size_t> sequence;
+    int64_t timeNanoseconds;               // 调用时刻，system_clock 纪元以来
+    size_t threadId;
+    uint8_t level;
+    uint8_t argCount;
+    StoredArg args[Logger::kMaxArgs];
+};
+
+// 格式串和字符串参数依次以 '\0' 结尾存放在 text 中，放不下的部分截断
+struct alignas(64) Record : RecordHeader {
+    char text[kRecordBytes - sizeof(RecordHeader)];
+};
+static_assert(sizeof(Record) == kRecordBytes, "日志记录大小必须固定");
+
+// 有界 MPSC 队列（Vyukov 序号法），槽位在构造时一次分配好
+class RecordQueue {
+public:
+    RecordQueue()
+        : records_(new Record[kQueueRecords])
+        , enqueuePos_(0)
+        , dequeuePos_(0) {
+        for (size_t i = 0; i < kQueueRecords; ++i) {
+            records_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // 生产者：取得空槽返回记录，队列满或重试耗尽返回 nullptr；填好后必须调用 Publish()
+    Record* Claim(size_t* position) {
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        for (int attempt = 0; attempt < kPushAttempts; ++attempt) {
+            Record& record = records_[pos & (kQueueRecords - 1)];
+            const size_t sequence = record.sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    *position = pos;
+                    return &record;
+                }
+            } else if (diff < 0) {
+                return nullptr;
+            } else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        return nullptr;
+    }
+
+    static void Publish(Record* record, size_t position) {
+        record->sequence.store(position + 1, std::memory_order_release);
+    }
+
+    // 消费者（只有日志线程）：没有已发布的记录时返回 nullptr，处理完后调用 Pop()
+    Record* Front() {
+        Record& record = records_[dequeuePos_ & (kQueueRecords - 1)];
+        if (record.sequence.load(std::memory_order_acquire) != dequeuePos_ + 1) {
+            return nullptr;
+        }
+        return &record;
+    }
+
+    void Pop() {
+        Record& record = records_[dequeuePos_ & (kQueueRecords - 1)];
+        record.sequence.store(dequeuePos_ + kQueueRecords, std::memory_order_release);
+        ++dequeuePos_;
+    }
+
+private:
+    std::unique_ptr<Record[]> records_;
+    alignas(64) std::atomic<size_t> enqueuePos_;
+    alignas(64) size_t dequeuePos_;
+};
+
+struct Backend {
+    RecordQueue queue;
+    std::atomic<bool> started{false};
+    std::atomic<bool> stopped{false};      // shutdown() 之后、下一次显式 init() 之前为 true
+    std::atomic<uint64_t> dropped{0};
+
+    std::mutex lifecycleMutex;             // init()/shutdown() 持有
+    std::vector<spdlog::sink_ptr> sinks;
+    std::thread thread;
+    std::mutex waitMutex;
+    std::condition_variable cv;
+    bool stopRequested = false;
+    uint64_t reportedDropped = 0;          // 只在日志线程访问，跨 shutdown()/init() 保留
+};
+
+// 第一次使用时创建且永不析构：其他静态对象析构时仍可能写日志，
+// 日志线程由 init() 注册的 atexit 处理函数停止
+Backend& GetBackend() {
+    static Backend* backend = new Backend();
+    return *backend;
+}
+
+spdlog::level::level_enum ToSpdlogLevel(Logger::Level level) {
+    switch (level) {
+        case Logger::Level::TRACE:
+            return spdlog::level::trace;
+        case Logger::Level::DEBUG:
+            return spdlog::level::debug;
+        case Logger::Level::INFO:
+            return spdlog::level::info;
+        case Logger::Level::WARN:
+            return spdlog::level::warn;
+        case Logger::Level::ERROR:
+            return spdlog::level::err;
+        case Logger::Level::CRITICAL:
+            return spdlog::level::critical;
+    }
+    return spdlog::level::info;
+}
+
+// 把最多 length 字节拷进 dst 并补 '\0'，截断时退回到 UTF-8 字符边界
+size_t CopyText(char* dst, size_t capacity, const char* src) {
+    if (capacity == 0) {
+        return 0;
+    }
+    size_t length = strnlen(src, capacity);
+    if (length == capacity) {
+        length = capacity - 1;
+        while (length > 0 && (static_cast<unsigned char>(src[length]) & 0xC0) == 0x80) {
+            --length;
+        }
+    }
+    memcpy(dst, src, length);
+    dst[length] = '\0';
+    return length + 1;
+}
+
+void Append(spdlog::memory_buf_t& out, const char* begin, size_t length) {
+    out.append(begin, begin + length);
+}
+
+template <typename T>
+void AppendFormatted(spdlog::memory_buf_t& out, const char* spec, T value) {
+    char buffer[1024];
+    const int written = snprintf(buffer, sizeof(buffer), spec, value);
+    if (written > 0) {
+        Append(out, buffer, std::min(static_cast<size_t>(written), sizeof(buffer) - 1));
+    }
+}
+
+// 按 printf 长度修饰符截断整数，再统一以 long long 输出，结果与直接传给 printf 一致
+int64_t NarrowSigned(int64_t value, const char* length) {
+    if (strcmp(length, "hh") == 0) return static_cast<signed char>(value);
+    if (strcmp(length, "h") == 0) return static_cast<short>(value);
+    if (length[0] == '\0') return static_cast<int>(value);
+    if (strcmp(length, "l") == 0) return static_cast<long>(value);
+    return value;
+}
+
+uint64_t NarrowUnsigned(uint64_t value, const char* length) {
+    if (strcmp(length, "hh") == 0) return static_cast<unsigned char>(value);
+    if (strcmp(length, "h") == 0) return static_cast<unsigned short>(value);
+    if (length[0] == '\0') return static_cast<unsigned int>(value);
+    if (strcmp(length, "l") == 0) return static_cast<unsigned long>(value);
+    return value;
+}
+
+// 在日志线程上按格式串展开记录；参数类型与转换说明不符或参数不足时输出 <?>
+void FormatRecord(const Record& record, spdlog::memory_buf_t& out) {
+    static const char kMismatch[] = "<?>";
+    const char* p = record.text;
+    size_t nextArg = 0;
+    auto takeArg = [&]() -> const StoredArg* {
+        return nextArg < record.argCount ? &record.args[nextArg++] : nullptr;
+    };
+
+    while (*p) {
+        if (*p != '%') {
+            const char* start = p;
+            while (*p && *p != '%') {
+                ++p;
+            }
+            Append(out, start, p - start);
+            continue;
+        }
+        if (p[1] == '%') {
+            out.push_back('%');
+            p += 2;
+            continue;
+        }
+
+        // 重建不含长度修饰符的转换说明，'*' 宽度/精度替换成参数值
+        const char* specStart = p;
+        char spec[48];
+        size_t specLength = 0;
+        bool valid = true;
+        auto put = [&](char c) {
+            if (specLength + 1 < sizeof(spec)) {
+                spec[specLength++] = c;
+            } else {
+                valid = false;
+            }
+        };
+        auto putStar = [&]() {
+            const StoredArg* arg = takeArg();
+            if (!arg || (arg->type != Logger::Arg::Type::Signed && arg->type != Logger::Arg::Type::Unsigned)) {
+                valid = false;
+                return;
+            }
+            char number[24];
+            const int n = snprintf(number, sizeof(number), "%d", static_cast<int>(arg->i));
+            for (int i = 0; i < n; ++i) {
+                put(number[i]);
+            }
+        };
+
+        put(*p++);
+        while (*p && strchr("-+ #0", *p)) {
+            put(*p++);
+        }
+        if (*p == '*') {
+            putStar();
+            ++p;
+        }
+        while (*p >= '0' && *p <= '9') {
+            put(*p++);
+        }
+        if (*p == '.') {
+            put(*p++);
+            if (*p == '*') {
+                putStar();
+                ++p;
+            }
+            while (*p >= '0' && *p <= '9') {
+                put(*p++);
+            }
+        }
+        char length[3] = {0, 0, 0};
+        size_t lengthSize = 0;
+        while (*p && strchr("hlLqjzt", *p)) {
+            if (lengthSize < 2) {
+                length[lengthSize++] = *p;
+            }
+            ++p;
+        }
+        const char conversion = *p;
+        if (conversion == '\0') {
+            Append(out, specStart, p - specStart);
+            break;
+        }
+        ++p;
+        if (!valid) {
+            Append(out, kMismatch, sizeof(kMismatch) - 1);
+            continue;
+        }
+
+        const StoredArg* arg = conversion == 'n' ? nullptr : takeArg();
+        switch (conversion) {
+            case 'd':
+            case 'i':
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X': {
+                if (!arg || (arg->type != Logger::Arg::Type::Signed && arg->type != Logger::Arg::Type::Unsigned)) {
+                    Append(out, kMismatch, sizeof(kMismatch) - 1);
+                    break;
+                }
+                put('l');
+                put('l');
+                put(conversion);
+                spec[specLength] = '\0';
+                const bool isSigned = conversion == 'd' || conversion == 'i';
+                if (isSigned) {
+                    AppendFormatted(out, spec, static_cast<long long>(NarrowSigned(arg->i, length)));
+                } else {
+                    AppendFormatted(out, spec, static_cast<unsigned long long>(NarrowUnsigned(arg->u, length)));
+                }
+                break;
+            }
+            case 'c': {
+                if (!arg || (arg->type != Logger::Arg::Type::Signed && arg->type != Logger::Arg::Type::Unsigned)) {
+                    Append(out, kMismatch, sizeof(kMismatch) - 1);
+                    break;
+                }
+                put('c');
+                spec[specLength] = '\0';
+                AppendFormatted(out, spec, static_cast<int>(arg->i));
+                break;
+            }
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A': {
+                if (!arg || arg->type != Logger::Arg::Type::Double) {
+                    Append(out, kMismatch, sizeof(kMismatch) - 1);
+                    break;
+                }
+                put(conversion);
+                spec[specLength] = '\0';
+                AppendFormatted(out, spec, arg->d);
+                break;
+            }
+            case 's': {
+                if (!arg || arg->type != Logger::Arg::Type::String) {
+                    Append(out, kMismatch, sizeof(kMismatch) - 1);
+                    break;
+                }
+                put('s');
+                spec[specLength] = '\0';
+                AppendFormatted(out, spec, arg->s.null ? "(null)" : record.text + arg->s.offset);
+                break;
+            }
+            case 'p': {
+                if (!arg || arg->type != Logger::Arg::Type::Pointer) {
+                    Append(out, kMismatch, sizeof(kMismatch) - 1);
+                    break;
+                }
+                put('p');
+                spec[specLength] = '\0';
+                AppendFormatted(out, spec, arg->p);
+                break;
+            }
+            case 'n':
+                // 不支持写回
+                break;
+            default:
+                Append(out, specStart, p - specStart);
+                break;
+        }
+    }
+}
+
+void WriteToSinks(Backend& backend, const spdlog::details::log_msg& msg) {
+    for (auto& sink : backend.sinks) {
+        if (!sink->should_log(msg.level)) {
+            continue;
+        }
+        try {
+            sink->log(msg);
+        } catch (const std::exception& ex) {
+            fprintf(stderr, "写日志失败: %s\n", ex.what());
+        }
+    }
+}
+
+void FlushSinks(Backend& backend) {
+    for (auto& sink : backend.sinks) {
+        try {
+            sink->flush();
+        } catch (const std::exception& ex) {
+            fprintf(stderr, "刷新日志失败: %s\n", ex.what());
+        }
+    }
+}
+
+// 取出队列中已发布的全部记录；批次中有 WARN 及以上级别时刷新 sink
+void Drain(Backend& backend, spdlog::memory_buf_t& buffer) {
+    bool flush = false;
+    while (Record* record = backend.queue.Front()) {
+        buffer.clear();
+        FormatRecord(*record, buffer);
+        const auto level = ToSpdlogLevel(static_cast<Logger::Level>(record->level));
+        const spdlog::log_clock::time_point time(std::chrono::duration_cast<spdlog::log_clock::duration>(
+            std::chrono::nanoseconds(record->timeNanoseconds)));
+        spdlog::details::log_msg msg(time, spdlog::source_loc{}, "recorder", level,
+                                     spdlog::string_view_t(buffer.data(), buffer.size()));
+        msg.thread_id = record->threadId;
+        backend.queue.Pop();
+
+        WriteToSinks(backend, msg);
+        flush = flush || level >= spdlog::level::warn;
+    }
+    if (flush) {
+        FlushSinks(backend);
+    }
+}
+
+void ReportDropped(Backend& backend) {
+    uint64_t* reported = &backend.reportedDropped;
+    const uint64_t dropped = backend.dropped.load(std::memory_order_relaxed);
+    if (dropped == *reported) {
+        return;
+    }
+    char text[128];
+    snprintf(text, sizeof(text), "日志队列已满，丢弃 %llu 条日志（累计 %llu 条）",
+             static_cast<unsigned long long>(dropped - *reported), static_cast<unsigned long long>(dropped));
+    *reported = dropped;
+    spdlog::details::log_msg msg(spdlog::source_loc{}, "recorder", spdlog::level::warn, text);
+    WriteToSinks(backend, msg);
+    FlushSinks(backend);
+}
+
+void LoggingLoop(Backend* backend) {
+    spdlog::memory_buf_t buffer;
+    for (;;) {
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lock(backend->waitMutex);
+            backend->cv.wait_for(lock, kPollInterval, [backend] { return backend->stopRequested; });
+            stopping = backend->stopRequested;
+        }
+        Drain(*backend, buffer);
+        ReportDropped(*backend);
+        if (stopping) {
+            break;
+        }
+    }
+    FlushSinks(*backend);
+}
+
+}  // namespace
 
 void Logger::init(const std::string& logDir) {
-    if (initialized_) {
+    Backend& backend = GetBackend();
+    std::lock_guard<std::mutex> lock(backend.lifecycleMutex);
+    if (backend.started.load(std::memory_order_acquire)) {
         return;
     }
-    
+
+    // 创建控制台和文件日志接收器
+    auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+    console_sink->set_level(spdlog::level::debug);
+    console_sink->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%^%l%$] [%t] %v");
+    backend.sinks.push_back(console_sink);
+
     try {
         // 创建日志目录
         std::string logDirectory = logDir;
         if (logDirectory.empty()) {
             logDirectory = "./logs";
         }
-        
+
         if (!std::filesystem::exists(logDirectory)) {
             std::filesystem::create_directories(logDirectory);
         }
-        
-        // 创建控制台和文件日志接收器
-        auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
-        console_sink->set_level(spdlog::level::debug);
-        console_sink->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%^%l%$] [%t] %v");
-        
+
         auto file_sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
-            logDirectory + "/meeting_recorder.log", 
+            logDirectory + "/meeting_recorder.log",
             1024 * 1024 * 5,  // 5MB
             3                  // 保留3个文件
         );
         file_sink->set_level(spdlog::level::trace);
         file_sink->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%l] [%t] %v");
-        
-        // 创建组合日志记录器
-        std::vector<spdlog::sink_ptr> sinks {console_sink, file_sink};
-        logger_ = std::make_shared<spdlog::logger>("recorder", sinks.begin(), sinks.end());
-        
-        // 设置默认日志级别
-        logger_->set_level(spdlog::level::info);
-        
-        // 注册为默认日志记录器
-        spdlog::register_logger(logger_);
-        spdlog::set_default_logger(logger_);
-        
-        initialized_ = true;
-        
-        // 记录初始日志
-        logger_->info("日志系统初始化成功");
+        backend.sinks.push_back(file_sink);
     }
     catch (const std::exception& ex) {
+        // 文件不可写时只输出到控制台，日志线程照常启动，调用方不会反复重试初始化
         fprintf(stderr, "日志系统初始化失败: %s\n", ex.what());
     }
+
+    backend.stopRequested = false;
+    backend.thread = std::thread(LoggingLoop, &backend);
+    backend.stopped.store(false, std::memory_order_release);
+    backend.started.store(true, std::memory_order_release);
+
+    // 在 sink 依赖的静态对象析构之前写完队列
+    static const bool registered = std::atexit([] { Logger::shutdown(); }) == 0;
+    (void)registered;
+
+    // 记录初始日志
+    info("日志系统初始化成功");
 }
 
 void Logger::shutdown() {
-    if (initialized_) {
-        logger_->info("日志系统关闭");
-        spdlog::shutdown();
-        initialized_ = false;
+    Backend& backend = GetBackend();
+    std::lock_guard<std::mutex> lock(backend.lifecycleMutex);
+    if (!backend.started.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    info("日志系统关闭");
+    // 先置 stopped，enqueue() 看到 started 为 false 时不会把它当作第一次调用而重新启动日志线程
+    backend.stopped.store(true, std::memory_order_release);
+    backend.started.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> waitLock(backend.waitMutex);
+        backend.stopRequested = true;
     }
+    backend.cv.notify_one();
+    backend.thread.join();
+    backend.sinks.clear();
 }
 
 void Logger::setLevel(Level level) {
-    if (!initialized_) {
-        init();
-    }
-    
-    currentLevel_ = level;
-    
-    switch (level) {
-        case Level::TRACE:
-            logger_->set_level(spdlog::level::trace);
-            break;
-        case Level::DEBUG:
-            logger_->set_level(spdlog::level::debug);
-            break;
-        case Level::INFO:
-            logger_->set_level(spdlog::level::info);
-            break;
-        case Level::WARN:
-            logger_->set_level(spdlog::level::warn);
-            break;
-        case Level::ERROR:
-            logger_->set_level(spdlog::level::err);
-            break;
-        case Level::CRITICAL:
-            logger_->set_level(spdlog::level::critical);
-            break;
-    }
+    currentLevel_.store(static_cast<int>(level), std::memory_order_relaxed);
 }
 
 Logger::Level Logger::getLevel() {
-    return currentLevel_;
+    return static_cast<Level>(currentLevel_.load(std::memory_order_relaxed));
 }
 
-// 以下是不同级别日志记录的实现
-void Logger::trace(const char* fmt, ...) {
-    if (!initialized_) {
-        init();
-    }
-    
-    va_list args;
-    va_start(args, fmt);
-    char buffer[1024];
-    vsnprintf(buffer, sizeof(buffer), fmt, args);
-    va_end(args);
-    
-    logger_->trace(buffer);
+uint64_t Logger::droppedCount() {
+    return GetBackend().dropped.load(std::memory_order_relaxed);
 }
 
-void Logger::debug(const char* fmt, ...) {
-    if (!initialized_) {
+// 调用线程上只做定长拷贝，不格式化、不分配
+void Logger::enqueue(Level level, const char* fmt, const Arg* args, size_t count) {
+    Backend& backend = GetBackend();
+    if (!backend.started.load(std::memory_order_acquire)) {
+        if (backend.stopped.load(std::memory_order_acquire)) {
+            // shutdown() 之后（例如 atexit 之后的静态析构）不重启日志线程，也不在调用线程上格式化，丢弃并计数
+            backend.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        // 冷路径：第一次调用时加锁启动日志线程
         init();
     }
-    
-    va_list args;
-    va_start(args, fmt);
-    char buffer[1024];
-    vsnprintf(buffer, sizeof(buffer), fmt, args);
-    va_end(args);
-    
-    logger_->debug(buffer);
-}
 
-void Logger::info(const char* fmt, ...) {
-    if (!initialized_) {
-        init();
+    size_t position;
+    Record* record = backend.queue.Claim(&position);
+    if (!record) {
+        backend.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
     }
-    
-    va_list args;
-    va_start(args, fmt);
-    char buffer[1024];
-    vsnprintf(buffer, sizeof(buffer), fmt, args);
-    va_end(args);
-    
-    logger_->info(buffer);
-}
 
-void Logger::warn(const char* fmt, ...) {
-    if (!initialized_) {
-        init();
-    }
-    
-    va_list args;
-    va_start(args, fmt);
-    char buffer[1024];
-    vsnprintf(buffer, sizeof(buffer), fmt, args);
-    va_end(args);
-    
-    logger_->warn(buffer);
-}
+    record->timeNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        spdlog::log_clock::now().time_since_epoch()).count();
+    record->threadId = spdlog::details::os::thread_id();
+    record->level = static_cast<uint8_t>(level);
+    record->argCount = static_cast<uint8_t>(count);
 
-void Logger::error(const char* fmt, ...) {
-    if (!initialized_) {
-        init();
+    size_t used = CopyText(record->text, sizeof(record->text), fmt ? fmt : "");
+    for (size_t i = 0; i < count; ++i) {
+        StoredArg& stored = record->args[i];
+        stored.type = args[i].type;
+        switch (args[i].type) {
+            case Arg::Type::Signed:
+                stored.i = args[i].i;
+                break;
+            case Arg::Type::Unsigned:
+                stored.u = args[i].u;
+                break;
+            case Arg::Type::Double:
+                stored.d = args[i].d;
+                break;
+            case Arg::Type::Pointer:
+                stored.p = args[i].p;
+                break;
+            case Arg::Type::String:
+                stored.s.null = args[i].s == nullptr;
+                if (used >= sizeof(record->text)) {
+                    // 空间用完时指向格式串末尾的 '\0'，输出空串
+                    stored.s.offset = static_cast<uint16_t>(used - 1);
+                } else {
+                    stored.s.offset = static_cast<uint16_t>(used);
+                    if (!stored.s.null) {
+                        used += CopyText(record->text + used, sizeof(record->text) - used, args[i].s);
+                    }
+                }
+                break;
+        }
     }
-    
-    va_list args;
-    va_start(args, fmt);
-    char buffer[1024];
-    vsnprintf(buffer, sizeof(buffer), fmt, args);
-    va_end(args);
-    
-    logger_->error(buffer);
+
+    RecordQueue::Publish(record, position);
 }
 
-void Logger::critical(const char* fmt, ...) {
-    if (!initialized_) {
-        init();
+bool Logger::RateLimiter::Allow(uint64_t* suppressed) {
+    const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t next = nextAllowed_.load(std::memory_order_relaxed);
+    if (now < next ||
+        !nextAllowed_.compare_exchange_strong(next, now + intervalNanoseconds_, std::memory_order_relaxed)) {
+        suppressed_.fetch_add(1, std::memory_order_relaxed);
+        return false;
     }
-    
-    va_list args;
-    va_start(args, fmt);
-    char buffer[1024];
-    vsnprintf(buffer, sizeof(buffer), fmt, args);
-    va_end(args);
-    
-    logger_->critical(buffer);
-} 
\ No newline at end of file
+    const uint64_t count = suppressed_.exchange(0, std::memory_order_relaxed);
+    if (suppressed) {
+        *suppressed = count;
+    }
+    return true;
+}
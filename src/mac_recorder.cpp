@@ -1,4 +1,5 @@
 #include "mac_recorder.h"
+#include "logger.h"
 
 MacRecorder::MacRecorder()
     : recorder_(nullptr)
@@ -50,6 +51,20 @@ std::string MacRecorder::GetCurrentMicrophoneApp() const {
     return currentMicApp_;
 }
 
+void MacRecorder::SetPcmStream(PcmStream* stream) {
+    if (stream) {
+        Logger::warn("macOS 录音实现不支持实时 PCM 流");
+    }
+}
+
+PipelineMetrics::Snapshot MacRecorder::GetMetrics() const {
+    return PipelineMetrics::Snapshot();
+}
+
+CaptureLevels MacRecorder::GetLevels() const {
+    return CaptureLevels{};
+}
+
 void MacRecorder::SetSystemAudioVolume(float volume) {
     systemAudioVolume_ = volume;
 }
@@ -21,70 +21,42 @@ MicRecorder::MicRecorder() {
         interleaved:NO];
         
     // 初始化 WAV 文件相关变量
-    audioFile_ = nullptr;
     outputPath_ = nil;
 }
 
 MicRecorder::~MicRecorder() {
     [audioEngine_ stop];
-    if (audioFile_) {
-        ExtAudioFileDispose(audioFile_);
-    }
+    writer_.Close();
 }
 
 bool MicRecorder::Start() {
     NSError* error = nil;
     
     // 设置文件输出格式（使用麦克风的实际采样率）
-    memset(&fileFormat_, 0, sizeof(fileFormat_));
-    fileFormat_.mSampleRate = audioFormat_.sampleRate;  // 使用麦克风的实际采样率
-    fileFormat_.mFormatID = kAudioFormatLinearPCM;
-    fileFormat_.mFormatFlags = kAudioFormatFlagIsFloat | kAudioFormatFlagIsPacked;
-    fileFormat_.mBitsPerChannel = 32;
-    fileFormat_.mChannelsPerFrame = 1;
-    fileFormat_.mFramesPerPacket = 1;
-    fileFormat_.mBytesPerFrame = fileFormat_.mChannelsPerFrame * (fileFormat_.mBitsPerChannel / 8);
-    fileFormat_.mBytesPerPacket = fileFormat_.mBytesPerFrame;
+    // 编码、分段和静音省略取自环境变量
+    StreamingWavWriter::Options writerOptions = StreamingWavWriter::Options::FromEnvironment();
+    writerOptions.sampleRate = static_cast<uint32_t>(audioFormat_.sampleRate);  // 使用麦克风的实际采样率
+    writerOptions.channels = 1;
+    writerOptions.format = StreamingWavWriter::SampleFormat::Float32;
     
     // 创建输出文件路径
     NSString* currentDir = [[NSFileManager defaultManager] currentDirectoryPath];
-    outputPath_ = [currentDir stringByAppendingPathComponent:@"microphone_output.wav"];
-    NSURL* outputURL = [NSURL fileURLWithPath:outputPath_];
+    NSString* fileName = [@"microphone_output" stringByAppendingString:
+        [NSString stringWithUTF8String:AudioEncoder::Extension(writerOptions.codec)]];
+    outputPath_ = [currentDir stringByAppendingPathComponent:fileName];
     
-    // 创建音频文件
-    OSStatus status = ExtAudioFileCreateWithURL((__bridge CFURLRef)outputURL,
-                                              kAudioFileWAVEType,
-                                              &fileFormat_,
-                                              NULL,
-                                              kAudioFileFlags_EraseFile,
-                                              &audioFile_);
-    if (status != noErr) {
-        Logger::error("创建音频文件失败: %d", (int)status);
+    // 创建音频文件并启动后台写线程
+    if (!writer_.Open([outputPath_ UTF8String], writerOptions)) {
+        Logger::error("创建音频文件失败: %s", [outputPath_ UTF8String]);
         return false;
     }
     
-    // 设置音频文件的客户端格式
-    status = ExtAudioFileSetProperty(audioFile_,
-                                   kExtAudioFileProperty_ClientDataFormat,
-                                   sizeof(fileFormat_),
-                                   &fileFormat_);
-    if (status != noErr) {
-        Logger::error("设置音频文件客户端格式失败: %d", (int)status);
-        ExtAudioFileDispose(audioFile_);
-        audioFile_ = nullptr;
-        return false;
-    }
-    
-    // 创建 sinkNode
+    // 创建 sinkNode，渲染线程只把第一个声道交给写线程
     sinkNode_ = [[AVAudioSinkNode alloc] initWithReceiverBlock:^OSStatus(const AudioTimeStamp* timestamp,
                                                                        AVAudioFrameCount frameCount,
                                                                        const AudioBufferList* outputData) {
-        if (audioFile_) {
-            // 写入音频数据
-            OSStatus status = ExtAudioFileWrite(audioFile_, frameCount, outputData);
-            if (status != noErr) {
-                Logger::error("写入音频数据失败: %d", (int)status);
-            }
+        if (outputData->mNumberBuffers > 0) {
+            writer_.Write(static_cast<const float*>(outputData->mBuffers[0].mData), frameCount);
         }
         return noErr;
     }];
@@ -107,8 +79,7 @@ bool MicRecorder::Start() {
     // 启动引擎
     if (![audioEngine_ startAndReturnError:&error]) {
         Logger::error("启动 AVAudioEngine 失败: %s", [[error localizedDescription] UTF8String]);
-        ExtAudioFileDispose(audioFile_);
-        audioFile_ = nullptr;
+        writer_.Close();
         return false;
     }
     
@@ -118,11 +89,7 @@ bool MicRecorder::Start() {
 
 void MicRecorder::Stop() {
     [audioEngine_ stop];
-    if (audioFile_) {
-        ExtAudioFileDispose(audioFile_);
-        audioFile_ = nullptr;
-        Logger::info("音频已保存到: %s", [outputPath_ UTF8String]);
-    }
+    writer_.Close();
     Logger::info("AVAudioEngine 已停止");
 }
 
@@ -1,11 +1,13 @@
 #include "microphone_capture.h"
+#include "core_audio_timestamp.h"
 #include "logger.h"
+#include "scratch_buffer.h"
 #include <CoreServices/CoreServices.h>
 #include <iostream>
 
 class MicrophoneCapture::Impl {
 public:
-    Impl() : audioUnit_(nullptr), isRunning_(false), ringBuffer_(1024 * 1024) {
+    Impl() : audioUnit_(nullptr), isRunning_(false), ringOptions_(CaptureRing::Options::FromEnvironment()) {
     }
     
     ~Impl() {
@@ -138,6 +140,32 @@ public:
             return false;
         }
         
+        // 按 AUHAL 单次回调的最大帧数预分配临时缓冲区，回调中不再分配内存
+        UInt32 maxFrames = 0;
+        size = sizeof(maxFrames);
+        status = AudioUnitGetProperty(audioUnit_,
+                                    kAudioUnitProperty_MaximumFramesPerSlice,
+                                    kAudioUnitScope_Global,
+                                    0,
+                                    &maxFrames,
+                                    &size);
+        if (status != noErr || maxFrames == 0) {
+            maxFrames = 4096;
+        }
+        channelCount_ = format.mChannelsPerFrame;
+        scratch_.Reserve(static_cast<size_t>(maxFrames) * channelCount_);
+
+        // 环形缓冲的容量按协商出的采样率和声道数换算
+        if (!ringBuffer_.Configure(ringOptions_, static_cast<int>(format.mSampleRate), channelCount_)) {
+            return false;
+        }
+        
+        // 设备最大帧数变化时在通知线程上扩容
+        AudioUnitAddPropertyListener(audioUnit_,
+                                   kAudioUnitProperty_MaximumFramesPerSlice,
+                                   MaxFramesChangedListener,
+                                   this);
+        
         // 设置回调
         AURenderCallbackStruct callback;
         callback.inputProc = MicrophoneCapture::InputCallback;
@@ -179,6 +207,10 @@ public:
         
         if (audioUnit_) {
             AudioOutputUnitStop(audioUnit_);
+            AudioUnitRemovePropertyListenerWithUserData(audioUnit_,
+                                                       kAudioUnitProperty_MaximumFramesPerSlice,
+                                                       MaxFramesChangedListener,
+                                                       this);
             AudioUnitUninitialize(audioUnit_);
             AudioComponentInstanceDispose(audioUnit_);
             audioUnit_ = nullptr;
@@ -192,8 +224,11 @@ public:
             return false;
         }
         
+        if (count % channelCount_ != 0) {
+            return false;
+        }
         data.resize(count);
-        return ringBuffer_.read(data.data(), count);
+        return ringBuffer_.Read(data.data(), count / channelCount_);
     }
     
     void HandleInput(AudioUnitRenderActionFlags* ioActionFlags,
@@ -205,11 +240,18 @@ public:
             return;
         }
         
+        // 使用预分配的缓冲区，容量不足时丢弃本次数据而不是在 IO 线程上分配
+        size_t sampleCount = static_cast<size_t>(inNumberFrames) * channelCount_;
+        float* samples = scratch_.Data(sampleCount);
+        if (!samples) {
+            return;
+        }
+        
         AudioBufferList bufferList;
         bufferList.mNumberBuffers = 1;
-        bufferList.mBuffers[0].mNumberChannels = 1;
-        bufferList.mBuffers[0].mDataByteSize = inNumberFrames * sizeof(float);
-        bufferList.mBuffers[0].mData = new float[inNumberFrames];
+        bufferList.mBuffers[0].mNumberChannels = channelCount_;
+        bufferList.mBuffers[0].mDataByteSize = static_cast<UInt32>(sampleCount * sizeof(float));
+        bufferList.mBuffers[0].mData = samples;
         
         OSStatus status = AudioUnitRender(audioUnit_,
                                         ioActionFlags,
@@ -219,16 +261,37 @@ public:
                                         &bufferList);
         
         if (status == noErr) {
-            ringBuffer_.write(static_cast<float*>(bufferList.mBuffers[0].mData), inNumberFrames);
+            ringBuffer_.Write(samples, inNumberFrames);
+            if (dataCallback_) {
+                dataCallback_(samples, inNumberFrames, ToCaptureTimestamp(inTimeStamp));
+            }
         }
-        
-        delete[] static_cast<float*>(bufferList.mBuffers[0].mData);
     }
-    
+
+    // 只能在 Start() 之前设置
+    CaptureBackend::DataCallback dataCallback_;
+    CaptureRing::Options ringOptions_;
+
 private:
+    // 在 HAL 通知线程上调用，按新的最大帧数扩容临时缓冲区
+    static void MaxFramesChangedListener(void* inRefCon,
+                                         AudioUnit inUnit,
+                                         AudioUnitPropertyID inID,
+                                         AudioUnitScope inScope,
+                                         AudioUnitElement inElement) {
+        auto impl = static_cast<Impl*>(inRefCon);
+        UInt32 maxFrames = 0;
+        UInt32 size = sizeof(maxFrames);
+        if (AudioUnitGetProperty(inUnit, inID, kAudioUnitScope_Global, 0, &maxFrames, &size) == noErr) {
+            impl->scratch_.Reserve(static_cast<size_t>(maxFrames) * impl->channelCount_);
+        }
+    }
+    
     AudioUnit audioUnit_;
     bool isRunning_;
-    RingBuffer ringBuffer_;
+    CaptureRing ringBuffer_;
+    ScratchBuffer scratch_;
+    UInt32 channelCount_ = 1;
 };
 
 MicrophoneCapture::MicrophoneCapture() : impl_(std::make_unique<Impl>()) {
@@ -245,10 +308,18 @@ void MicrophoneCapture::Stop() {
     impl_->Stop();
 }
 
+void MicrophoneCapture::SetRingOptions(const CaptureRing::Options& options) {
+    impl_->ringOptions_ = options;
+}
+
 bool MicrophoneCapture::ReadAudioData(std::vector<float>& data, size_t count) {
     return impl_->ReadAudioData(data, count);
 }
 
+void MicrophoneCapture::SetDataCallback(CaptureBackend::DataCallback callback) {
+    impl_->dataCallback_ = std::move(callback);
+}
+
 OSStatus MicrophoneCapture::InputCallback(void* inRefCon,
                                         AudioUnitRenderActionFlags* ioActionFlags,
                                         const AudioTimeStamp* inTimeStamp,
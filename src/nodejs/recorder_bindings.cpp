@@ -1,7 +1,214 @@
 #include <napi.h>
-#include "../recorder.h"
+#include "recorder.h"
+#include "control_thread.h"
+#include "pcm_stream.h"
+#include <atomic>
+#include <cstring>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
+namespace {
+
+struct AudioSink;
+void CallAudio(Napi::Env env, Napi::Function callback, AudioSink* sink, void* data);
+using AudioCallback = Napi::TypedThreadSafeFunction<AudioSink, void, CallAudio>;
+
+// onAudio 的投递上下文
+// 投递线程把块放入 pending，只在没有未处理的唤醒时调用一次 TSFN；
+// 主线程一次唤醒把攒下的块全部交给 JS，块数远多于唤醒次数时说明事件循环跟不上、正在批量处理
+struct AudioSink {
+    AudioCallback tsfn;
+    std::mutex mutex;
+    std::vector<PcmStream::Chunk*> pending;     // nullptr 表示一段录制结束
+    std::vector<PcmStream::Chunk*> delivering;  // 只在主线程访问
+    std::atomic<bool> wakeupPending{false};
+    std::atomic<bool> discard{false};
+
+    // 以下只在主线程访问
+    int sessions = 0;          // 已投递 start() 但还没收到结束标记的录制段数，大于 0 时引用 TSFN
+    uint64_t wakeups = 0;
+    uint64_t chunks = 0;
+    uint64_t copiedChunks = 0;
+
+    // 投递线程调用
+    bool Push(PcmStream::Chunk* chunk) {
+        if (discard.load(std::memory_order_acquire)) {
+            return false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.push_back(chunk);
+        }
+        if (!wakeupPending.exchange(true, std::memory_order_acq_rel)) {
+            tsfn.NonBlockingCall();
+        }
+        return true;
+    }
+
+    void ReleaseAll(std::vector<PcmStream::Chunk*>& chunks) {
+        for (PcmStream::Chunk* chunk : chunks) {
+            PcmStream::Release(chunk);
+        }
+        chunks.clear();
+    }
+};
+
+void FinalizeChunk(napi_env, void*, void* hint) {
+    PcmStream::Release(static_cast<PcmStream::Chunk*>(hint));
+}
+
+// 块缓冲区直接作为外部 ArrayBuffer 交给 JS，GC 回收时归还到池；
+// Electron 开启 V8 内存沙箱时不允许外部 ArrayBuffer，此时退回复制一次并立即归还
+Napi::ArrayBuffer WrapChunk(Napi::Env env, AudioSink* sink, PcmStream::Chunk* chunk) {
+    napi_value value;
+    if (napi_create_external_arraybuffer(env, chunk->data, chunk->bytes, FinalizeChunk, chunk, &value) == napi_ok) {
+        return Napi::ArrayBuffer(env, value);
+    }
+    Napi::ArrayBuffer copy = Napi::ArrayBuffer::New(env, chunk->bytes);
+    memcpy(copy.Data(), chunk->data, chunk->bytes);
+    PcmStream::Release(chunk);
+    ++sink->copiedChunks;
+    return copy;
+}
+
+void CallAudio(Napi::Env env, Napi::Function callback, AudioSink* sink, void*) {
+    sink->wakeupPending.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(sink->mutex);
+        sink->delivering.swap(sink->pending);
+    }
+    if (env == nullptr) {
+        sink->ReleaseAll(sink->delivering);
+        return;
+    }
+    ++sink->wakeups;
+
+    size_t index = 0;
+    for (; index < sink->delivering.size(); ++index) {
+        PcmStream::Chunk* chunk = sink->delivering[index];
+        Napi::HandleScope scope(env);
+        if (!chunk) {
+            // 录制结束，不再有数据时不阻止进程退出
+            if (sink->sessions > 0 && --sink->sessions == 0) {
+                sink->tsfn.Unref(env);
+            }
+            callback.Call({env.Null()});
+        } else {
+            const uint64_t firstFrame = chunk->firstFrame;
+            const size_t frames = chunk->frames;
+            const uint32_t sampleRate = chunk->sampleRate;
+            const uint16_t channels = chunk->channels;
+            const size_t samples = frames * channels;
+            const bool isFloat = chunk->format == PcmStream::SampleFormat::Float32;
+
+            Napi::ArrayBuffer buffer = WrapChunk(env, sink, chunk);
+            Napi::Value samplesArray = isFloat
+                ? Napi::Value(Napi::Float32Array::New(env, samples, buffer, 0))
+                : Napi::Value(Napi::Int16Array::New(env, samples, buffer, 0));
+
+            Napi::Object info = Napi::Object::New(env);
+            info.Set("frame", Napi::Number::New(env, static_cast<double>(firstFrame)));
+            info.Set("frames", Napi::Number::New(env, static_cast<double>(frames)));
+            info.Set("sampleRate", Napi::Number::New(env, sampleRate));
+            info.Set("channels", Napi::Number::New(env, channels));
+            ++sink->chunks;
+            callback.Call({samplesArray, info});
+        }
+        if (env.IsExceptionPending()) {
+            ++index;
+            break;
+        }
+    }
+
+    // 回调抛出异常时剩余的块直接归还，异常由 Node 作为未捕获异常报告
+    for (; index < sink->delivering.size(); ++index) {
+        PcmStream::Release(sink->delivering[index]);
+    }
+    sink->delivering.clear();
+}
+
+bool ParseAudioOptions(Napi::Env env, Napi::Value value, PcmStream::Options* options) {
+    if (value.IsUndefined() || value.IsNull()) {
+        return true;
+    }
+    if (!value.IsObject()) {
+        Napi::TypeError::New(env, "Options object expected").ThrowAsJavaScriptException();
+        return false;
+    }
+    Napi::Object object = value.As<Napi::Object>();
+    if (object.Has("chunkMs")) {
+        Napi::Value chunkMs = object.Get("chunkMs");
+        if (!chunkMs.IsNumber() || chunkMs.As<Napi::Number>().Uint32Value() == 0) {
+            Napi::TypeError::New(env, "chunkMs must be a positive number").ThrowAsJavaScriptException();
+            return false;
+        }
+        options->chunkMilliseconds = chunkMs.As<Napi::Number>().Uint32Value();
+    }
+    if (object.Has("poolChunks")) {
+        Napi::Value poolChunks = object.Get("poolChunks");
+        if (!poolChunks.IsNumber() || poolChunks.As<Napi::Number>().Uint32Value() == 0) {
+            Napi::TypeError::New(env, "poolChunks must be a positive number").ThrowAsJavaScriptException();
+            return false;
+        }
+        options->poolChunks = poolChunks.As<Napi::Number>().Uint32Value();
+    }
+    if (object.Has("format")) {
+        Napi::Value format = object.Get("format");
+        std::string name = format.IsString() ? format.As<Napi::String>().Utf8Value() : "";
+        if (name == "f32") {
+            options->format = PcmStream::SampleFormat::Float32;
+        } else if (name == "s16") {
+            options->format = PcmStream::SampleFormat::Int16;
+        } else {
+            Napi::TypeError::New(env, "format must be 'f32' or 's16'").ThrowAsJavaScriptException();
+            return false;
+        }
+    }
+    return true;
+}
+
+// 在控制线程上执行的命令，执行完回到 JS 线程兑现 Promise
+struct ControlCommand {
+    explicit ControlCommand(Napi::Env env) : deferred(Napi::Promise::Deferred::New(env)) {}
+
+    std::function<bool()> run;                                // 控制线程执行
+    std::function<void(Napi::Env, const ControlCommand&)> settle;  // JS 线程上、兑现 Promise 之前调用
+    Napi::Promise::Deferred deferred;
+    bool resolveWithResult = false;                          // 为 true 时以 run() 的返回值兑现，否则为 undefined
+    bool result = false;
+    std::string error;
+};
+
+void CallControl(Napi::Env env, Napi::Function, std::nullptr_t*, ControlCommand* command) {
+    std::unique_ptr<ControlCommand> owned(command);
+    if (env == nullptr) {
+        return;
+    }
+    Napi::HandleScope scope(env);
+    if (command->settle) {
+        command->settle(env, *command);
+    }
+    if (!command->error.empty()) {
+        command->deferred.Reject(Napi::Error::New(env, command->error).Value());
+    } else if (command->resolveWithResult) {
+        command->deferred.Resolve(Napi::Boolean::New(env, command->result));
+    } else {
+        command->deferred.Resolve(env.Undefined());
+    }
+}
+
+using ControlCallback = Napi::TypedThreadSafeFunction<std::nullptr_t, ControlCommand, CallControl>;
+
+} // namespace
+
+// start/stop/pause/resume/setOutputPath 返回 Promise：JS 线程只做参数检查和投递，
+// AudioRecorder 的调用全部在本对象独占的 ControlThread 上按调用顺序串行执行，
+// 设备协商和文件收尾不再阻塞事件循环。isRecording/getCurrentMicrophoneApp 只读状态，仍为同步
+// onAudio/getStats/getLevels 在不支持的平台（AudioRecorder::SupportsMonitoring() 为 false）上直接抛出错误
 class RecorderWrapper : public Napi::ObjectWrap<RecorderWrapper> {
 public:
     static Napi::Object Init(Napi::Env env, Napi::Object exports) {
@@ -12,7 +219,12 @@ public:
             InstanceMethod("resume", &RecorderWrapper::Resume),
             InstanceMethod("isRecording", &RecorderWrapper::IsRecording),
             InstanceMethod("setOutputPath", &RecorderWrapper::SetOutputPath),
-            InstanceMethod("getCurrentMicrophoneApp", &RecorderWrapper::GetCurrentMicrophoneApp)
+            InstanceMethod("getCurrentMicrophoneApp", &RecorderWrapper::GetCurrentMicrophoneApp),
+            InstanceMethod("onAudio", &RecorderWrapper::OnAudio),
+            InstanceMethod("setAudioFlowing", &RecorderWrapper::SetAudioFlowing),
+            InstanceMethod("getAudioStats", &RecorderWrapper::GetAudioStats),
+            InstanceMethod("getStats", &RecorderWrapper::GetStats),
+            InstanceMethod("getLevels", &RecorderWrapper::GetLevels)
         });
 
         exports.Set("Recorder", func);
@@ -25,77 +237,169 @@ public:
             if (!recorder_) {
                 throw std::runtime_error("Failed to create AudioRecorder");
             }
+            control_.reset(new ControlThread());
         } catch (const std::exception& e) {
             Napi::Error::New(info.Env(), e.what()).ThrowAsJavaScriptException();
+            return;
         }
+
+        // 只在有未完成的命令时阻止进程退出
+        controlCallback_ = ControlCallback::New(info.Env(), "recorder.control", 0, 1);
+        controlCallback_.Unref(info.Env());
     }
 
+    // 有未完成的命令时对象被引用住，不会被回收，这里控制线程上只剩停止录音和释放资源；
+    // 终结器在 JS 线程上运行，不等这些完成，控制线程执行完后自行退出
     ~RecorderWrapper() {
-        if (recorder_) {
-            try {
-                delete recorder_;
-                recorder_ = nullptr;
-            } catch (const std::exception& e) {
-            }
+        if (!control_) {
+            delete recorder_;
+            return;
         }
+        AudioRecorder* recorder = recorder_;
+        recorder_ = nullptr;
+        control_->Post([recorder]() { delete recorder; });
+        DetachAudio();
+        control_.release()->Detach();
+        controlCallback_.Release();
     }
 
 private:
-    void CheckRecorder(const Napi::CallbackInfo& info) {
-        if (!recorder_) {
+    bool CheckRecorder(const Napi::CallbackInfo& info) {
+        if (!recorder_ || !control_) {
             Napi::Error::New(info.Env(), "AudioRecorder is not initialized").ThrowAsJavaScriptException();
+            return false;
         }
+        return true;
+    }
+
+    // 投递一条命令，返回在 JS 线程兑现的 Promise
+    Napi::Value Queue(Napi::Env env, std::function<bool(AudioRecorder*)> run, bool resolveWithResult,
+                      std::function<void(Napi::Env, const ControlCommand&)> settle = nullptr) {
+        ControlCommand* command = new ControlCommand(env);
+        AudioRecorder* recorder = recorder_;
+        command->run = [recorder, run]() { return run(recorder); };
+        command->resolveWithResult = resolveWithResult;
+        command->settle = [this, settle](Napi::Env settleEnv, const ControlCommand& done) {
+            if (settle) {
+                settle(settleEnv, done);
+            }
+            if (--pendingCommands_ == 0) {
+                Unref();
+                controlCallback_.Unref(settleEnv);
+                if (detachPending_ && !active_.load(std::memory_order_acquire)) {
+                    DetachAudio();
+                }
+            }
+        };
+        Napi::Value promise = command->deferred.Promise();
+
+        if (pendingCommands_++ == 0) {
+            Ref();
+            controlCallback_.Ref(env);
+        }
+        ControlCallback callback = controlCallback_;
+        control_->Post([command, callback]() {
+            try {
+                command->result = command->run();
+            } catch (const std::exception& e) {
+                command->error = e.what();
+            } catch (...) {
+                command->error = "Unknown error";
+            }
+            callback.NonBlockingCall(command);
+        });
+        return promise;
     }
 
     Napi::Value Start(const Napi::CallbackInfo& info) {
         Napi::Env env = info.Env();
-        CheckRecorder(info);
-        bool success = recorder_->Start();
-        return Napi::Boolean::New(env, success);
+        if (!CheckRecorder(info)) {
+            return env.Undefined();
+        }
+        // 启动成功的每段录制都会以结束标记收尾，在那之前保持 onAudio 的 TSFN 被引用
+        AudioSink* sink = audioSink_;
+        if (sink && sink->sessions++ == 0) {
+            sink->tsfn.Ref(env);
+        }
+        return Queue(env, [this](AudioRecorder* recorder) {
+            bool success = recorder->Start();
+            if (success) {
+                active_.store(true, std::memory_order_release);
+            }
+            return success;
+        }, true, [this, sink](Napi::Env settleEnv, const ControlCommand& done) {
+            if (!done.result && sink && sink == audioSink_ && --sink->sessions == 0) {
+                sink->tsfn.Unref(settleEnv);
+            }
+        });
     }
 
-    void Stop(const Napi::CallbackInfo& info) {
-        CheckRecorder(info);
-        recorder_->Stop();
+    Napi::Value Stop(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (!CheckRecorder(info)) {
+            return env.Undefined();
+        }
+        return Queue(env, [this](AudioRecorder* recorder) {
+            recorder->Stop();
+            active_.store(false, std::memory_order_release);
+            return true;
+        }, false);
     }
 
-    void Pause(const Napi::CallbackInfo& info) {
-        CheckRecorder(info);
-        recorder_->Pause();
+    Napi::Value Pause(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (!CheckRecorder(info)) {
+            return env.Undefined();
+        }
+        return Queue(env, [](AudioRecorder* recorder) {
+            recorder->Pause();
+            return true;
+        }, false);
     }
 
-    void Resume(const Napi::CallbackInfo& info) {
-        CheckRecorder(info);
-        recorder_->Resume();
+    Napi::Value Resume(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (!CheckRecorder(info)) {
+            return env.Undefined();
+        }
+        return Queue(env, [](AudioRecorder* recorder) {
+            recorder->Resume();
+            return true;
+        }, false);
     }
 
     Napi::Value IsRecording(const Napi::CallbackInfo& info) {
         Napi::Env env = info.Env();
-        CheckRecorder(info);
+        if (!CheckRecorder(info)) {
+            return env.Undefined();
+        }
         bool isRecording = recorder_->IsRecording();
         return Napi::Boolean::New(env, isRecording);
     }
 
-    void SetOutputPath(const Napi::CallbackInfo& info) {
+    Napi::Value SetOutputPath(const Napi::CallbackInfo& info) {
         Napi::Env env = info.Env();
-        CheckRecorder(info);
-        
+        if (!CheckRecorder(info)) {
+            return env.Undefined();
+        }
+
         if (info.Length() < 1 || !info[0].IsString()) {
             Napi::TypeError::New(env, "String expected").ThrowAsJavaScriptException();
-            return;
+            return env.Undefined();
         }
 
-        try {
-            std::string path = info[0].As<Napi::String>().Utf8Value();
-            recorder_->SetOutputPath(path);
-        } catch (const std::exception& e) {
-            Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
-        }
+        std::string path = info[0].As<Napi::String>().Utf8Value();
+        return Queue(env, [path](AudioRecorder* recorder) {
+            recorder->SetOutputPath(path);
+            return true;
+        }, false);
     }
 
     Napi::Value GetCurrentMicrophoneApp(const Napi::CallbackInfo& info) {
         Napi::Env env = info.Env();
-        CheckRecorder(info);
+        if (!CheckRecorder(info)) {
+            return env.Undefined();
+        }
         try {
             std::string appName = recorder_->GetCurrentMicrophoneApp();
             return Napi::String::New(env, appName);
@@ -105,11 +409,210 @@ private:
         }
     }
 
+    // onAudio(callback, options) 订阅混合音频，callback(samples, info) 中 samples 为指向原生缓冲池的
+    // Float32Array/Int16Array，录制结束时以 callback(null) 通知；onAudio(null) 取消订阅。
+    // 块格式只能在未录制且没有未完成的命令时更改；录制中取消订阅时先丢弃后续数据，停止后再真正释放
+    void OnAudio(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (!CheckRecorder(info)) {
+            return;
+        }
+        const bool busy = pendingCommands_ > 0 || active_.load(std::memory_order_acquire);
+
+        if (info.Length() < 1 || info[0].IsNull() || info[0].IsUndefined()) {
+            if (busy && audioSink_) {
+                audioSink_->discard.store(true, std::memory_order_release);
+                audioStream_->SetFlowing(true);
+                detachPending_ = true;
+            } else {
+                DetachAudio();
+            }
+            return;
+        }
+        if (!info[0].IsFunction()) {
+            Napi::TypeError::New(env, "Function expected").ThrowAsJavaScriptException();
+            return;
+        }
+        if (!AudioRecorder::SupportsMonitoring()) {
+            Napi::Error::New(env, "onAudio() is unsupported on this platform").ThrowAsJavaScriptException();
+            return;
+        }
+        if (busy) {
+            Napi::Error::New(env, "onAudio() must be called while not recording").ThrowAsJavaScriptException();
+            return;
+        }
+
+        PcmStream::Options options;
+        if (!ParseAudioOptions(env, info.Length() > 1 ? info[1] : env.Undefined(), &options)) {
+            return;
+        }
+
+        DetachAudio();
+        AudioSink* sink = new AudioSink();
+        sink->pending.reserve(options.poolChunks + 1);
+        sink->delivering.reserve(options.poolChunks + 1);
+        sink->tsfn = AudioCallback::New(env, info[0].As<Napi::Function>(), "recorder.onAudio", 0, 1, sink,
+            [](Napi::Env, AudioSink* context) {
+                context->ReleaseAll(context->pending);
+                context->ReleaseAll(context->delivering);
+                delete context;
+            });
+        // 未录制时不阻止进程退出，start() 时再引用
+        sink->tsfn.Unref(env);
+
+        audioSink_ = sink;
+        audioStream_ = std::make_shared<PcmStream>(options, [sink](PcmStream::Chunk* chunk) { return sink->Push(chunk); });
+        AudioRecorder* recorder = recorder_;
+        PcmStream* stream = audioStream_.get();
+        control_->Post([recorder, stream]() { recorder->SetPcmStream(stream); });
+    }
+
+    // Readable 流背压：false 时原生侧停止交付，积压反馈到采集端
+    void SetAudioFlowing(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (info.Length() < 1 || !info[0].IsBoolean()) {
+            Napi::TypeError::New(env, "Boolean expected").ThrowAsJavaScriptException();
+            return;
+        }
+        if (audioStream_ && !detachPending_) {
+            audioStream_->SetFlowing(info[0].As<Napi::Boolean>().Value());
+        }
+    }
+
+    Napi::Value GetAudioStats(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (!audioStream_) {
+            return env.Null();
+        }
+        const PcmStream::Stats stats = audioStream_->GetStats();
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("chunks", Napi::Number::New(env, static_cast<double>(audioSink_->chunks)));
+        result.Set("wakeups", Napi::Number::New(env, static_cast<double>(audioSink_->wakeups)));
+        result.Set("copiedChunks", Napi::Number::New(env, static_cast<double>(audioSink_->copiedChunks)));
+        result.Set("framesDelivered", Napi::Number::New(env, static_cast<double>(stats.framesDelivered)));
+        result.Set("bytesCopied", Napi::Number::New(env, static_cast<double>(stats.bytesCopied)));
+        result.Set("droppedFrames", Napi::Number::New(env, static_cast<double>(stats.droppedFrames)));
+        result.Set("refusedChunks", Napi::Number::New(env, static_cast<double>(stats.chunksRefused)));
+        result.Set("poolExhausted", Napi::Number::New(env, static_cast<double>(stats.poolExhausted)));
+        result.Set("outstandingChunks", Napi::Number::New(env, static_cast<double>(stats.outstandingChunks)));
+        result.Set("queuedFrames", Napi::Number::New(env, static_cast<double>(audioStream_->QueuedFrames())));
+        return result;
+    }
+
+    // 管线指标快照：计数器为数字，水位为 { value, max }，耗时（纳秒）为 { count, mean, p50, p90, p99, max, buckets }，
+    // buckets[i] 为落在 [2^(i-1), 2^i) 的样本数。只读原子量，直接在 JS 线程上执行；{ log: true } 时同时写入日志
+    Napi::Value GetStats(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (!recorder_) {
+            return env.Null();
+        }
+        if (!AudioRecorder::SupportsMonitoring()) {
+            Napi::Error::New(env, "getStats() is unsupported on this platform").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        const PipelineMetrics::Snapshot snapshot = recorder_->GetMetrics();
+        if (info.Length() > 0 && info[0].IsObject() && info[0].As<Napi::Object>().Get("log").ToBoolean().Value()) {
+            PipelineMetrics::Log(snapshot, "getStats");
+        }
+
+        Napi::Object result = Napi::Object::New(env);
+        for (const PipelineMetrics::Entry& entry : snapshot.entries) {
+            switch (entry.kind) {
+                case PipelineMetrics::Kind::Counter:
+                    result.Set(entry.name, Napi::Number::New(env, static_cast<double>(entry.value)));
+                    break;
+                case PipelineMetrics::Kind::Gauge: {
+                    Napi::Object gauge = Napi::Object::New(env);
+                    gauge.Set("value", Napi::Number::New(env, static_cast<double>(entry.value)));
+                    gauge.Set("max", Napi::Number::New(env, static_cast<double>(entry.max)));
+                    result.Set(entry.name, gauge);
+                    break;
+                }
+                case PipelineMetrics::Kind::Histogram: {
+                    const PipelineMetrics::HistogramSnapshot& histogram = entry.histogram;
+                    Napi::Object timing = Napi::Object::New(env);
+                    timing.Set("count", Napi::Number::New(env, static_cast<double>(histogram.count)));
+                    timing.Set("mean", Napi::Number::New(env, histogram.Mean()));
+                    timing.Set("p50", Napi::Number::New(env, static_cast<double>(histogram.Percentile(0.5))));
+                    timing.Set("p90", Napi::Number::New(env, static_cast<double>(histogram.Percentile(0.9))));
+                    timing.Set("p99", Napi::Number::New(env, static_cast<double>(histogram.Percentile(0.99))));
+                    timing.Set("max", Napi::Number::New(env, static_cast<double>(histogram.max)));
+                    Napi::Array buckets = Napi::Array::New(env, histogram.buckets.size());
+                    for (size_t i = 0; i < histogram.buckets.size(); ++i) {
+                        buckets.Set(static_cast<uint32_t>(i), Napi::Number::New(env, static_cast<double>(histogram.buckets[i])));
+                    }
+                    timing.Set("buckets", buckets);
+                    result.Set(entry.name, timing);
+                    break;
+                }
+            }
+        }
+        return result;
+    }
+
+    // 两路采集电平 { microphone, system }，每路为 { peak, rms, peakDb, rmsDb, dc, clipped, totalClipped, windows }，
+    // 窗口约 33ms，windows 为 0 表示还没有数据。只读原子量，直接在 JS 线程上执行，不唤醒采集或控制线程
+    Napi::Value GetLevels(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (!recorder_) {
+            return env.Null();
+        }
+        if (!AudioRecorder::SupportsMonitoring()) {
+            Napi::Error::New(env, "getLevels() is unsupported on this platform").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        const CaptureLevels levels = recorder_->GetLevels();
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("microphone", LevelsObject(env, levels.microphone));
+        result.Set("system", LevelsObject(env, levels.system));
+        return result;
+    }
+
+    static Napi::Object LevelsObject(Napi::Env env, const LevelMeter::Levels& levels) {
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("peak", Napi::Number::New(env, levels.peak));
+        result.Set("rms", Napi::Number::New(env, levels.rms));
+        result.Set("peakDb", Napi::Number::New(env, LevelMeter::ToDecibels(levels.peak)));
+        result.Set("rmsDb", Napi::Number::New(env, LevelMeter::ToDecibels(levels.rms)));
+        result.Set("dc", Napi::Number::New(env, levels.dc));
+        result.Set("clipped", Napi::Number::New(env, levels.clipped));
+        result.Set("totalClipped", Napi::Number::New(env, static_cast<double>(levels.totalClipped)));
+        result.Set("windows", Napi::Number::New(env, static_cast<double>(levels.windows)));
+        return result;
+    }
+
+    // 解除挂接、停止投递线程和释放 TSFN 都在控制线程上按顺序执行，排在之前投递的命令之后；
+    // TSFN 的析构回调归还尚未交给 JS 的块
+    void DetachAudio() {
+        if (!audioSink_) {
+            return;
+        }
+        AudioRecorder* recorder = recorder_;
+        std::shared_ptr<PcmStream> stream = std::move(audioStream_);
+        AudioSink* sink = audioSink_;
+        audioSink_ = nullptr;
+        detachPending_ = false;
+        control_->Post([recorder, stream, sink]() mutable {
+            if (recorder) {
+                recorder->SetPcmStream(nullptr);
+            }
+            stream.reset();
+            sink->tsfn.Release();
+        });
+    }
+
     AudioRecorder* recorder_ = nullptr;
+    std::unique_ptr<ControlThread> control_;
+    ControlCallback controlCallback_;
+    size_t pendingCommands_ = 0;
+    std::atomic<bool> active_{false};   // 控制线程写入：录音已开始且尚未停止（含暂停）
+    std::shared_ptr<PcmStream> audioStream_;
+    AudioSink* audioSink_ = nullptr;
+    bool detachPending_ = false;
 };
 
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
     return RecorderWrapper::Init(env, exports);
 }
 
-NODE_API_MODULE(recorder, Init) 
\ No newline at end of file
+NODE_API_MODULE(recorder, Init)
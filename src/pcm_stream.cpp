@@ -0,0 +1,292 @@
+#include "pcm_stream.h"
+#include "audio_kernels.h"
+#include "logger.h"
+#include <algorithm>
+#include <chrono>
+
+// 固定数量、固定大小的块缓冲区
+// 引用计数 = 持有池的 PcmStream（1）+ 消费者手里的块数，最后一个引用释放时删除自身
+class PcmStream::Pool {
+public:
+    Pool(size_t count, size_t chunkBytes)
+        : chunks_(count)
+        , refs_(1) {
+        const size_t stride = (chunkBytes + kCacheLineSize - 1) & ~(kCacheLineSize - 1);
+        storage_.reset(new uint8_t[count * stride]());
+        free_.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            chunks_[i].data = storage_.get() + i * stride;
+            chunks_[i].pool = this;
+            free_.push_back(&chunks_[i]);
+        }
+    }
+
+    Chunk* Acquire() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_.empty()) {
+            return nullptr;
+        }
+        Chunk* chunk = free_.back();
+        free_.pop_back();
+        refs_.fetch_add(1, std::memory_order_relaxed);
+        return chunk;
+    }
+
+    void Put(Chunk* chunk) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            free_.push_back(chunk);
+        }
+        Unref();
+    }
+
+    void Unref() {
+        if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+    size_t Outstanding() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return chunks_.size() - free_.size();
+    }
+
+private:
+    std::vector<Chunk> chunks_;
+    std::vector<Chunk*> free_;
+    std::unique_ptr<uint8_t[]> storage_;
+    mutable std::mutex mutex_;
+    std::atomic<size_t> refs_;
+};
+
+PcmStream::PcmStream(const Options& options, ChunkCallback callback)
+    : options_(options)
+    , callback_(std::move(callback))
+    , sampleRate_(0)
+    , channels_(0)
+    , chunkFrames_(0)
+    , pool_(nullptr)
+    , stopRequested_(false)
+    , active_(false)
+    , flowing_(true)
+    , nextFrame_(0)
+    , chunksDelivered_(0)
+    , chunksRefused_(0)
+    , framesDelivered_(0)
+    , bytesCopied_(0)
+    , droppedFrames_(0)
+    , poolExhausted_(0) {
+    options_.chunkMilliseconds = std::max<uint32_t>(options_.chunkMilliseconds, 1);
+    options_.poolChunks = std::max<size_t>(options_.poolChunks, 1);
+}
+
+PcmStream::~PcmStream() {
+    End();
+    if (pool_) {
+        pool_->Unref();
+        pool_ = nullptr;
+    }
+}
+
+bool PcmStream::Begin(uint32_t sampleRate, uint16_t channels) {
+    if (IsActive()) {
+        Logger::warn("PCM 流已经开始");
+        return false;
+    }
+    if (sampleRate == 0 || channels == 0) {
+        Logger::error("无效的 PCM 流格式: 采样率 %u, 声道数 %u", sampleRate, channels);
+        return false;
+    }
+
+    sampleRate_ = sampleRate;
+    chunkFrames_ = std::max<size_t>(static_cast<size_t>(sampleRate) * options_.chunkMilliseconds / 1000, 1);
+
+    // 队列至少能放下两块，否则池有空闲时也攒不满一块
+    const size_t queueFrames = std::max(static_cast<size_t>(sampleRate) * options_.queueMilliseconds / 1000,
+                                        chunkFrames_ * 2);
+    drainBuffer_.assign(chunkFrames_ * channels, 0.0f);
+    const size_t bytesPerSample = options_.format == SampleFormat::Float32 ? sizeof(float) : sizeof(int16_t);
+    {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        channels_ = channels;
+        queue_ = std::make_unique<RingBuffer>(queueFrames * channels);
+
+        // 上一段录制的块可能还在消费者手里，旧池等它们归还后自行释放
+        if (pool_) {
+            pool_->Unref();
+        }
+        pool_ = new Pool(options_.poolChunks, chunkFrames_ * channels * bytesPerSample);
+    }
+
+    nextFrame_ = 0;
+    chunksDelivered_.store(0, std::memory_order_relaxed);
+    chunksRefused_.store(0, std::memory_order_relaxed);
+    framesDelivered_.store(0, std::memory_order_relaxed);
+    bytesCopied_.store(0, std::memory_order_relaxed);
+    droppedFrames_.store(0, std::memory_order_relaxed);
+    poolExhausted_.store(0, std::memory_order_relaxed);
+
+    stopRequested_ = false;
+    active_.store(true, std::memory_order_release);
+    thread_ = std::thread(&PcmStream::DeliveryLoop, this);
+
+    Logger::info("PCM 流开始: 采样率 %u, 声道数 %u, 每块 %zu 帧, 池 %zu 块", sampleRate, channels,
+                 chunkFrames_, options_.poolChunks);
+    return true;
+}
+
+bool PcmStream::Write(const float* interleaved, size_t frames) {
+    if (!active_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    if (!queue_->write(interleaved, frames * channels_)) {
+        droppedFrames_.fetch_add(frames, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void PcmStream::End() {
+    if (!active_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopRequested_ = true;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    const Stats stats = GetStats();
+    if (stats.droppedFrames > 0) {
+        Logger::warn("PCM 流队列溢出，共丢弃 %llu 帧", static_cast<unsigned long long>(stats.droppedFrames));
+    }
+    Logger::info("PCM 流结束: 交付 %llu 块 (%llu 帧), 拒收 %llu 块, 池耗尽 %llu 次",
+                 static_cast<unsigned long long>(stats.chunksDelivered),
+                 static_cast<unsigned long long>(stats.framesDelivered),
+                 static_cast<unsigned long long>(stats.chunksRefused),
+                 static_cast<unsigned long long>(stats.poolExhausted));
+}
+
+void PcmStream::SetFlowing(bool flowing) {
+    flowing_.store(flowing, std::memory_order_release);
+    if (flowing) {
+        cv_.notify_one();
+    }
+}
+
+bool PcmStream::IsBacklogged() const {
+    return IsActive() && queue_->available_read() > queue_->capacity() / 2;
+}
+
+size_t PcmStream::PendingFrames() const {
+    return IsActive() ? queue_->available_read() / channels_ : 0;
+}
+
+size_t PcmStream::QueuedFrames() const {
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    return IsActive() ? queue_->available_read() / channels_ : 0;
+}
+
+size_t PcmStream::QueueCapacityFrames() const {
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    return IsActive() ? queue_->capacity() / channels_ : 0;
+}
+
+PcmStream::Stats PcmStream::GetStats() const {
+    Stats stats;
+    stats.chunksDelivered = chunksDelivered_.load(std::memory_order_relaxed);
+    stats.chunksRefused = chunksRefused_.load(std::memory_order_relaxed);
+    stats.framesDelivered = framesDelivered_.load(std::memory_order_relaxed);
+    stats.bytesCopied = bytesCopied_.load(std::memory_order_relaxed);
+    stats.droppedFrames = droppedFrames_.load(std::memory_order_relaxed);
+    stats.poolExhausted = poolExhausted_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    stats.outstandingChunks = pool_ ? pool_->Outstanding() : 0;
+    return stats;
+}
+
+void PcmStream::Release(Chunk* chunk) {
+    if (chunk) {
+        chunk->pool->Put(chunk);
+    }
+}
+
+void PcmStream::DeliveryLoop() {
+    using Clock = std::chrono::steady_clock;
+    const auto poll = std::chrono::milliseconds(options_.pollMilliseconds);
+
+    for (;;) {
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait_for(lock, poll, [this] { return stopRequested_; });
+            stopping = stopRequested_;
+        }
+
+        Deliver(stopping);
+
+        if (stopping) {
+            const auto deadline = Clock::now() + std::chrono::milliseconds(options_.drainMilliseconds);
+            while (queue_->available_read() > 0 && Clock::now() < deadline) {
+                std::this_thread::sleep_for(poll);
+                Deliver(true);
+            }
+            const size_t remaining = queue_->available_read() / channels_;
+            if (remaining > 0) {
+                droppedFrames_.fetch_add(remaining, std::memory_order_relaxed);
+            }
+            callback_(nullptr);
+            break;
+        }
+    }
+}
+
+// 每块只在这里复制一次：Float32 直接从队列读入池缓冲区，Int16 在转换时写入
+void PcmStream::Deliver(bool final) {
+    const size_t chunkSamples = chunkFrames_ * channels_;
+    for (;;) {
+        if (!final && !flowing_.load(std::memory_order_acquire)) {
+            return;
+        }
+        const size_t available = queue_->available_read();
+        if (available == 0 || (available < chunkSamples && !final)) {
+            return;
+        }
+
+        Chunk* chunk = pool_->Acquire();
+        if (!chunk) {
+            poolExhausted_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        const size_t frames = std::min(chunkFrames_, available / channels_);
+        const size_t samples = frames * channels_;
+        if (options_.format == SampleFormat::Float32) {
+            queue_->read(reinterpret_cast<float*>(chunk->data), samples);
+            chunk->bytes = samples * sizeof(float);
+        } else {
+            queue_->read(drainBuffer_.data(), samples);
+            AudioKernels::FloatToInt16(drainBuffer_.data(), reinterpret_cast<int16_t*>(chunk->data), samples);
+            chunk->bytes = samples * sizeof(int16_t);
+        }
+        chunk->frames = frames;
+        chunk->firstFrame = nextFrame_;
+        chunk->sampleRate = sampleRate_;
+        chunk->channels = channels_;
+        chunk->format = options_.format;
+        nextFrame_ += frames;
+        bytesCopied_.fetch_add(chunk->bytes, std::memory_order_relaxed);
+
+        if (callback_(chunk)) {
+            chunksDelivered_.fetch_add(1, std::memory_order_relaxed);
+            framesDelivered_.fetch_add(frames, std::memory_order_relaxed);
+        } else {
+            chunksRefused_.fetch_add(1, std::memory_order_relaxed);
+            Release(chunk);
+        }
+    }
+}
@@ -0,0 +1,230 @@
+#include "pipeline_metrics.h"
+#include "logger.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+size_t BucketIndex(uint64_t value) {
+    size_t bits = 0;
+    while (value != 0) {
+        ++bits;
+        value >>= 1;
+    }
+    return bits < PipelineMetrics::kHistogramBuckets ? bits : PipelineMetrics::kHistogramBuckets - 1;
+}
+
+// 第 i 桶的上界（含）
+uint64_t BucketUpperBound(size_t index) {
+    return index == 0 ? 0 : (uint64_t(1) << index) - 1;
+}
+
+} // namespace
+
+// 单写线程：用读改写代替 fetch_add，避免音频线程上的总线锁
+void PipelineMetrics::Histogram::Record(uint64_t value) {
+    std::atomic<uint64_t>& bucket = buckets_[BucketIndex(value)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    count_.store(count_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    sum_.store(sum_.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    if (value > max_.load(std::memory_order_relaxed)) {
+        max_.store(value, std::memory_order_relaxed);
+    }
+}
+
+void PipelineMetrics::Histogram::Reset() {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+PipelineMetrics::CallbackTimer::CallbackTimer()
+    : duration_(nullptr)
+    , jitter_(nullptr)
+    , periodNanoseconds_(0)
+    , lastStart_(0) {
+}
+
+void PipelineMetrics::CallbackTimer::Attach(Histogram* duration, Histogram* jitter, uint64_t periodNanoseconds) {
+    duration_ = duration;
+    jitter_ = jitter;
+    periodNanoseconds_ = periodNanoseconds;
+    lastStart_ = 0;
+}
+
+uint64_t PipelineMetrics::CallbackTimer::Begin() {
+    const uint64_t now = NowNanoseconds();
+    if (jitter_ && periodNanoseconds_ > 0 && lastStart_ != 0) {
+        const uint64_t interval = now - lastStart_;
+        jitter_->Record(interval > periodNanoseconds_ ? interval - periodNanoseconds_ : periodNanoseconds_ - interval);
+    }
+    lastStart_ = now;
+    return now;
+}
+
+void PipelineMetrics::CallbackTimer::End(uint64_t startNanoseconds) {
+    if (duration_) {
+        duration_->RecordSince(startNanoseconds);
+    }
+}
+
+uint64_t PipelineMetrics::HistogramSnapshot::Percentile(double q) const {
+    if (count == 0) {
+        return 0;
+    }
+    const double target = q * static_cast<double>(count);
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < kHistogramBuckets; ++i) {
+        cumulative += buckets[i];
+        if (static_cast<double>(cumulative) >= target && buckets[i] > 0) {
+            return std::min(BucketUpperBound(i), max);
+        }
+    }
+    return max;
+}
+
+const PipelineMetrics::Entry* PipelineMetrics::Snapshot::Find(const std::string& name) const {
+    for (const Entry& entry : entries) {
+        if (entry.name == name) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+PipelineMetrics::Slot& PipelineMetrics::GetSlot(const std::string& name, Kind kind) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool conflict = false;
+    for (auto& slot : slots_) {
+        if (slot->name == name) {
+            if (slot->kind == kind) {
+                return *slot;
+            }
+            Logger::error("指标 %s 已按其他类型注册", name.c_str());
+            conflict = true;
+            break;
+        }
+    }
+
+    // 类型冲突的指标不进入快照，但仍返回可写的对象，调用方不需要判空
+    auto slot = std::make_unique<Slot>();
+    slot->name = conflict ? std::string() : name;
+    slot->kind = kind;
+    switch (kind) {
+        case Kind::Counter:
+            slot->counter = std::make_unique<Counter>();
+            break;
+        case Kind::Gauge:
+            slot->gauge = std::make_unique<Gauge>();
+            break;
+        case Kind::Histogram:
+            slot->histogram = std::make_unique<Histogram>();
+            break;
+    }
+    slots_.push_back(std::move(slot));
+    return *slots_.back();
+}
+
+PipelineMetrics::Counter& PipelineMetrics::GetCounter(const std::string& name) {
+    return *GetSlot(name, Kind::Counter).counter;
+}
+
+PipelineMetrics::Gauge& PipelineMetrics::GetGauge(const std::string& name) {
+    return *GetSlot(name, Kind::Gauge).gauge;
+}
+
+PipelineMetrics::Histogram& PipelineMetrics::GetHistogram(const std::string& name) {
+    return *GetSlot(name, Kind::Histogram).histogram;
+}
+
+void PipelineMetrics::Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& slot : slots_) {
+        switch (slot->kind) {
+            case Kind::Counter:
+                slot->counter->Reset();
+                break;
+            case Kind::Gauge:
+                slot->gauge->Reset();
+                break;
+            case Kind::Histogram:
+                slot->histogram->Reset();
+                break;
+        }
+    }
+}
+
+PipelineMetrics::Snapshot PipelineMetrics::GetSnapshot() const {
+    Snapshot snapshot;
+    std::lock_guard<std::mutex> lock(mutex_);
+    snapshot.entries.reserve(slots_.size());
+    for (const auto& slot : slots_) {
+        if (slot->name.empty()) {
+            continue;
+        }
+        Entry entry{};
+        entry.name = slot->name;
+        entry.kind = slot->kind;
+        switch (slot->kind) {
+            case Kind::Counter:
+                entry.value = slot->counter->Value();
+                entry.max = entry.value;
+                break;
+            case Kind::Gauge:
+                entry.value = slot->gauge->Value();
+                entry.max = slot->gauge->Max();
+                break;
+            case Kind::Histogram: {
+                const Histogram& histogram = *slot->histogram;
+                for (size_t i = 0; i < kHistogramBuckets; ++i) {
+                    entry.histogram.buckets[i] = histogram.buckets_[i].load(std::memory_order_relaxed);
+                }
+                entry.histogram.count = histogram.count_.load(std::memory_order_relaxed);
+                entry.histogram.sum = histogram.sum_.load(std::memory_order_relaxed);
+                entry.histogram.max = histogram.max_.load(std::memory_order_relaxed);
+                entry.value = entry.histogram.count;
+                entry.max = entry.histogram.max;
+                break;
+            }
+        }
+        snapshot.entries.push_back(std::move(entry));
+    }
+    return snapshot;
+}
+
+void PipelineMetrics::Log(const Snapshot& snapshot, const char* title) {
+    Logger::info("%s 管线指标:", title);
+    for (const Entry& entry : snapshot.entries) {
+        switch (entry.kind) {
+            case Kind::Counter:
+                if (entry.value > 0) {
+                    Logger::info("  %s = %llu", entry.name.c_str(), static_cast<unsigned long long>(entry.value));
+                }
+                break;
+            case Kind::Gauge:
+                if (entry.max > 0) {
+                    Logger::info("  %s = %llu (最大 %llu)", entry.name.c_str(),
+                                 static_cast<unsigned long long>(entry.value),
+                                 static_cast<unsigned long long>(entry.max));
+                }
+                break;
+            case Kind::Histogram:
+                if (entry.histogram.count > 0) {
+                    Logger::info("  %s: %llu 次, 平均 %.0f, p50 %llu, p99 %llu, 最大 %llu", entry.name.c_str(),
+                                 static_cast<unsigned long long>(entry.histogram.count), entry.histogram.Mean(),
+                                 static_cast<unsigned long long>(entry.histogram.Percentile(0.5)),
+                                 static_cast<unsigned long long>(entry.histogram.Percentile(0.99)),
+                                 static_cast<unsigned long long>(entry.histogram.max));
+                }
+                break;
+        }
+    }
+}
+
+uint64_t PipelineMetrics::NowNanoseconds() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
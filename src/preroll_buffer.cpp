@@ -0,0 +1,453 @@
+#include "preroll_buffer.h"
+#include "audio_kernels.h"
+#include "logger.h"
+#include "pipeline_metrics.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// 段大小的下限；段越大淘汰粒度越粗，越小则块尾浪费越多
+constexpr size_t kMinSegmentBytes = 256 * 1024;
+
+// Rice 编码的商超过这个值时改为直接写出折叠后的残差
+constexpr uint32_t kEscapeQuotient = 24;
+constexpr int kEscapeBits = 19;   // 二阶预测残差折叠后小于 2^19
+
+// 压缩后不小于 int16 的块直接存 int16
+constexpr uint32_t kBlockRaw = 1;
+
+inline uint32_t Fold(int32_t value) {
+    return value >= 0 ? static_cast<uint32_t>(value) << 1 : (static_cast<uint32_t>(-(value + 1)) << 1) | 1u;
+}
+
+inline int32_t Unfold(uint32_t value) {
+    return (value & 1u) ? -static_cast<int32_t>(value >> 1) - 1 : static_cast<int32_t>(value >> 1);
+}
+
+inline int32_t Predict(const int16_t* x, size_t i, size_t stride, int order) {
+    switch (order) {
+        case 1: return x[(i - 1) * stride];
+        case 2: return 2 * x[(i - 1) * stride] - x[(i - 2) * stride];
+        default: return 0;
+    }
+}
+
+class BitWriter {
+public:
+    explicit BitWriter(uint8_t* out)
+        : out_(out), size_(0), buffer_(0), bits_(0) {
+    }
+
+    void Write(uint32_t value, int bits) {
+        buffer_ = (buffer_ << bits) | (value & ((1ull << bits) - 1));
+        bits_ += bits;
+        while (bits_ >= 8) {
+            bits_ -= 8;
+            out_[size_++] = static_cast<uint8_t>(buffer_ >> bits_);
+        }
+    }
+
+    void WriteUnary(uint32_t count) {
+        while (count >= 24) {
+            Write(0xFFFFFF, 24);
+            count -= 24;
+        }
+        Write((1u << count) - 1, static_cast<int>(count));
+        Write(0, 1);
+    }
+
+    size_t Finish() {
+        if (bits_ > 0) {
+            out_[size_++] = static_cast<uint8_t>(buffer_ << (8 - bits_));
+            bits_ = 0;
+        }
+        return size_;
+    }
+
+    size_t Size() const { return size_ + (bits_ + 7) / 8; }
+
+private:
+    uint8_t* out_;
+    size_t size_;
+    uint64_t buffer_;
+    int bits_;
+};
+
+class BitReader {
+public:
+    explicit BitReader(const uint8_t* in)
+        : in_(in), pos_(0), buffer_(0), bits_(0) {
+    }
+
+    uint32_t Read(int bits) {
+        while (bits_ < bits) {
+            buffer_ = (buffer_ << 8) | in_[pos_++];
+            bits_ += 8;
+        }
+        bits_ -= bits;
+        return static_cast<uint32_t>(buffer_ >> bits_) & static_cast<uint32_t>((1ull << bits) - 1);
+    }
+
+    // 连续的 1 的个数，遇到 0 时消耗掉这个 0；读满 limit 个 1 时停止（转义，后面没有 0）
+    uint32_t ReadUnary(uint32_t limit) {
+        uint32_t count = 0;
+        for (;;) {
+            if (bits_ == 0) {
+                buffer_ = (buffer_ << 8) | in_[pos_++];
+                bits_ = 8;
+            }
+            // 把未读的位左对齐后按位取反，前导 0 即未读部分的前导 1
+            const uint64_t inverted = ~(buffer_ << (64 - bits_));
+            const uint32_t ones = std::min<uint32_t>(static_cast<uint32_t>(__builtin_clzll(inverted)), bits_);
+            if (count + ones >= limit) {
+                bits_ -= static_cast<int>(limit - count);
+                return limit;
+            }
+            count += ones;
+            bits_ -= static_cast<int>(ones);
+            if (bits_ > 0) {
+                --bits_;
+                return count;
+            }
+        }
+    }
+
+private:
+    const uint8_t* in_;
+    size_t pos_;
+    uint64_t buffer_;
+    int bits_;
+};
+
+} // namespace
+
+struct PrerollBuffer::BlockHeader {
+    uint64_t startFrame;
+    uint32_t frames;
+    uint32_t payloadBytes;
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+struct PrerollBuffer::Segment {
+    explicit Segment(size_t bytes)
+        : data(new uint8_t[bytes])
+        , used(0)
+        , firstFrame(0)
+        , endFrame(0) {
+    }
+
+    std::unique_ptr<uint8_t[]> data;
+    size_t used;
+    uint64_t firstFrame;   // 段内第一个块的起点
+    uint64_t endFrame;     // 段内最后一个块的终点
+};
+
+PrerollBuffer::Options::Options() = default;
+
+PrerollBuffer::PrerollBuffer(std::shared_ptr<CaptureEngine> engine, const Options& options)
+    : engine_(std::move(engine))
+    , options_(options)
+    , sampleRate_(engine_ ? engine_->SampleRate() : 0)
+    , channels_(engine_ ? engine_->Channels() : 0)
+    , segmentBytes_(0)
+    , maxSegments_(0)
+    , allocatedSegments_(0)
+    , nextFrame_(0)
+    , encodedFrames_(0)
+    , encodeNanos_(0)
+    , stopRequested_(false) {
+    if (!engine_) {
+        return;
+    }
+    options_.blockFrames = std::max<uint32_t>(options_.blockFrames, 64);
+
+    const size_t rawBlockBytes = static_cast<size_t>(options_.blockFrames) * channels_ * sizeof(int16_t);
+    const size_t maxBlockBytes = sizeof(BlockHeader) + rawBlockBytes;
+    segmentBytes_ = std::max(kMinSegmentBytes, maxBlockBytes * 4);
+    // 多留一段：最旧的段只有部分落在时间窗口内
+    if (options_.maxBytes > 0) {
+        maxSegments_ = (options_.maxBytes + segmentBytes_ - 1) / segmentBytes_ + 1;
+    } else {
+        // 按整块计：每块带块头，段尾放不下一整块的空间浪费掉
+        const uint64_t windowFrames = static_cast<uint64_t>(options_.seconds * sampleRate_);
+        const uint64_t segmentFrames = static_cast<uint64_t>(segmentBytes_ / maxBlockBytes) * options_.blockFrames;
+        maxSegments_ = static_cast<size_t>((windowFrames + segmentFrames - 1) / segmentFrames) + 1;
+    }
+
+    // 最坏情况下每个样本 Rice 编码占 kEscapeQuotient + 1 + kEscapeBits 位，超过 int16 时改存原始数据
+    encoded_.assign(rawBlockBytes * 4 + channels_ * 8, 0);
+    pending_.reserve(static_cast<size_t>(options_.blockFrames) * channels_);
+    quantized_.assign(static_cast<size_t>(options_.blockFrames) * channels_, 0);
+    decoded_.assign(static_cast<size_t>(options_.blockFrames) * channels_, 0.0f);
+
+    subscription_ = engine_->Subscribe();
+    if (!subscription_) {
+        return;
+    }
+    nextFrame_ = subscription_->Position();
+    thread_ = std::thread(&PrerollBuffer::PollLoop, this);
+    Logger::info("预录已开始: 保留 %.0f 秒, %s, 段 %zu 字节 x 最多 %zu 段",
+                 options_.seconds, options_.codec == Codec::Int16 ? "int16" : "压缩",
+                 segmentBytes_, maxSegments_);
+}
+
+PrerollBuffer::~PrerollBuffer() {
+    {
+        std::lock_guard<std::mutex> lock(stopMutex_);
+        stopRequested_ = true;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    subscription_.reset();
+}
+
+void PrerollBuffer::PollLoop() {
+    const auto poll = std::chrono::milliseconds(options_.pollMilliseconds);
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(stopMutex_);
+            cv_.wait_for(lock, poll, [this] { return stopRequested_; });
+            if (stopRequested_) {
+                break;
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        Ingest(UINT64_MAX, false);
+    }
+}
+
+void PrerollBuffer::Ingest(uint64_t limitFrame, bool partial) {
+    const size_t blockFrames = options_.blockFrames;
+    for (;;) {
+        const uint64_t position = subscription_->Position();
+        const size_t available = subscription_->AvailableFrames();
+        const size_t pendingFrames = pending_.size() / channels_;
+        if (available == 0 || position >= limitFrame) {
+            break;
+        }
+        const size_t count = static_cast<size_t>(std::min<uint64_t>(
+            std::min(available, blockFrames - pendingFrames), limitFrame - position));
+        const size_t offset = pending_.size();
+        pending_.resize(offset + count * channels_);
+        if (!subscription_->Read(pending_.data() + offset, count)) {
+            pending_.resize(offset);
+            break;
+        }
+        // 被广播缓冲覆盖过时读位置会跳跃，已攒下的数据单独成块，新数据从跳跃后的位置开始
+        const uint64_t start = subscription_->Position() - count;
+        if (start != nextFrame_) {
+            if (offset > 0) {
+                std::vector<float> tail(pending_.begin() + offset, pending_.end());
+                pending_.resize(offset);
+                AppendBlock(nextFrame_ - offset / channels_, pending_.data(), offset / channels_);
+                pending_.swap(tail);
+            }
+        }
+        nextFrame_ = start + count;
+        if (pending_.size() == blockFrames * channels_) {
+            AppendBlock(nextFrame_ - blockFrames, pending_.data(), blockFrames);
+            pending_.clear();
+        }
+    }
+    if (partial && !pending_.empty()) {
+        const size_t frames = pending_.size() / channels_;
+        AppendBlock(nextFrame_ - frames, pending_.data(), frames);
+        pending_.clear();
+    }
+}
+
+void PrerollBuffer::AppendBlock(uint64_t startFrame, const float* interleaved, size_t frames) {
+    const uint64_t begin = PipelineMetrics::NowNanoseconds();
+
+    BlockHeader header = {};
+    header.startFrame = startFrame;
+    header.frames = static_cast<uint32_t>(frames);
+    AudioKernels::FloatToInt16(interleaved, quantized_.data(), frames * channels_);
+    const size_t rawBytes = frames * channels_ * sizeof(int16_t);
+    size_t payloadBytes = options_.codec == Codec::Compressed ? EncodeBlock(interleaved, frames, encoded_.data())
+                                                              : rawBytes;
+    if (payloadBytes >= rawBytes) {
+        header.flags = kBlockRaw;
+        payloadBytes = rawBytes;
+        memcpy(encoded_.data(), quantized_.data(), rawBytes);
+    }
+    header.payloadBytes = static_cast<uint32_t>(payloadBytes);
+
+    const size_t blockBytes = sizeof(BlockHeader) + payloadBytes;
+    Evict(startFrame + frames, blockBytes);
+    if (segments_.empty() || segmentBytes_ - segments_.back()->used < blockBytes) {
+        std::unique_ptr<Segment> segment;
+        if (!freeSegments_.empty()) {
+            segment = std::move(freeSegments_.back());
+            freeSegments_.pop_back();
+        } else {
+            segment.reset(new Segment(segmentBytes_));
+            ++allocatedSegments_;
+        }
+        segment->used = 0;
+        segment->firstFrame = startFrame;
+        segments_.push_back(std::move(segment));
+    }
+    Segment& segment = *segments_.back();
+    memcpy(segment.data.get() + segment.used, &header, sizeof(header));
+    memcpy(segment.data.get() + segment.used + sizeof(header), encoded_.data(), payloadBytes);
+    segment.used += blockBytes;
+    segment.endFrame = startFrame + frames;
+
+    encodedFrames_ += frames;
+    encodeNanos_ += PipelineMetrics::NowNanoseconds() - begin;
+}
+
+void PrerollBuffer::Evict(uint64_t newestFrame, size_t incomingBytes) {
+    const uint64_t window = static_cast<uint64_t>(options_.seconds * sampleRate_);
+    const uint64_t oldest = newestFrame > window ? newestFrame - window : 0;
+    // 整段都已移出时间窗口：第二段的起点不晚于窗口起点
+    while (segments_.size() > 1 && segments_[1]->firstFrame <= oldest) {
+        freeSegments_.push_back(std::move(segments_.front()));
+        segments_.pop_front();
+    }
+    // 需要新段但已达到内存上限时淘汰最旧的段
+    const bool needSegment = segments_.empty() || segmentBytes_ - segments_.back()->used < incomingBytes;
+    if (needSegment && freeSegments_.empty() && allocatedSegments_ >= maxSegments_ && !segments_.empty()) {
+        freeSegments_.push_back(std::move(segments_.front()));
+        segments_.pop_front();
+    }
+}
+
+// 每个声道独立选择 0~2 阶定阶预测和 Rice 参数，头部一个字节：阶数 << 5 | 参数
+size_t PrerollBuffer::EncodeBlock(const float*, size_t frames, uint8_t* out) {
+    BitWriter writer(out);
+    const size_t rawBytes = frames * channels_ * sizeof(int16_t);
+    for (size_t ch = 0; ch < channels_; ++ch) {
+        const int16_t* x = quantized_.data() + ch;
+        uint64_t sums[3] = {0, 0, 0};
+        for (size_t i = 2; i < frames; ++i) {
+            for (int order = 0; order < 3; ++order) {
+                sums[order] += Fold(x[i * channels_] - Predict(x, i, channels_, order));
+            }
+        }
+        const int order = static_cast<int>(std::min_element(sums, sums + 3) - sums);
+        const uint64_t mean = frames > 2 ? sums[order] / (frames - 2) : 0;
+        int parameter = 0;
+        while (parameter < 18 && (1ull << (parameter + 1)) <= mean) {
+            ++parameter;
+        }
+
+        writer.Write(static_cast<uint32_t>(order << 5 | parameter), 8);
+        const size_t warmup = std::min<size_t>(static_cast<size_t>(order), frames);
+        for (size_t i = 0; i < warmup; ++i) {
+            writer.Write(static_cast<uint16_t>(x[i * channels_]), 16);
+        }
+        for (size_t i = warmup; i < frames; ++i) {
+            const uint32_t folded = Fold(x[i * channels_] - Predict(x, i, channels_, order));
+            const uint32_t quotient = folded >> parameter;
+            if (quotient < kEscapeQuotient) {
+                writer.WriteUnary(quotient);
+                writer.Write(folded, parameter);
+            } else {
+                // 转义：kEscapeQuotient 个 1 之后不写结束位，直接跟原值
+                writer.Write((1u << kEscapeQuotient) - 1, kEscapeQuotient);
+                writer.Write(folded, kEscapeBits);
+            }
+        }
+        // 已经不比 int16 小，不必继续
+        if (writer.Size() >= rawBytes) {
+            return rawBytes;
+        }
+    }
+    return writer.Finish();
+}
+
+void PrerollBuffer::DecodeBlock(const BlockHeader& header, const uint8_t* payload, float* interleaved) {
+    const size_t frames = header.frames;
+    int16_t* x = quantized_.data();
+    if (header.flags & kBlockRaw) {
+        memcpy(x, payload, frames * channels_ * sizeof(int16_t));
+    } else {
+        BitReader reader(payload);
+        for (size_t ch = 0; ch < channels_; ++ch) {
+            int16_t* channel = x + ch;
+            const uint32_t code = reader.Read(8);
+            const int order = static_cast<int>(code >> 5);
+            const int parameter = static_cast<int>(code & 31u);
+            const size_t warmup = std::min<size_t>(static_cast<size_t>(order), frames);
+            for (size_t i = 0; i < warmup; ++i) {
+                channel[i * channels_] = static_cast<int16_t>(reader.Read(16));
+            }
+            for (size_t i = warmup; i < frames; ++i) {
+                const uint32_t quotient = reader.ReadUnary(kEscapeQuotient);
+                const uint32_t folded = quotient < kEscapeQuotient
+                    ? (quotient << parameter) | (parameter > 0 ? reader.Read(parameter) : 0u)
+                    : reader.Read(kEscapeBits);
+                channel[i * channels_] = static_cast<int16_t>(Unfold(folded) + Predict(channel, i, channels_, order));
+            }
+        }
+    }
+    AudioKernels::Int16ToFloat(x, interleaved, frames * channels_);
+}
+
+uint64_t PrerollBuffer::Splice(uint64_t endFrame, double seconds, const Sink& sink) {
+    if (!subscription_) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    Ingest(endFrame, true);
+
+    const uint64_t span = static_cast<uint64_t>(std::min(seconds, options_.seconds) * sampleRate_);
+    const uint64_t startFrame = endFrame > span ? endFrame - span : 0;
+    uint64_t written = 0;
+    for (const auto& segment : segments_) {
+        if (segment->endFrame <= startFrame) {
+            continue;
+        }
+        size_t offset = 0;
+        while (offset < segment->used) {
+            BlockHeader header;
+            memcpy(&header, segment->data.get() + offset, sizeof(header));
+            const uint8_t* payload = segment->data.get() + offset + sizeof(header);
+            offset += sizeof(header) + header.payloadBytes;
+
+            const uint64_t blockEnd = header.startFrame + header.frames;
+            if (blockEnd <= startFrame) {
+                continue;
+            }
+            if (header.startFrame >= endFrame) {
+                return written;
+            }
+            DecodeBlock(header, payload, decoded_.data());
+            const uint64_t from = std::max(startFrame, header.startFrame);
+            const uint64_t to = std::min(endFrame, blockEnd);
+            const size_t skip = static_cast<size_t>(from - header.startFrame);
+            const size_t frames = static_cast<size_t>(to - from);
+            if (!sink(decoded_.data() + skip * channels_, frames)) {
+                return written;
+            }
+            written += frames;
+        }
+    }
+    return written;
+}
+
+PrerollBuffer::Stats PrerollBuffer::GetStats() const {
+    Stats stats = {};
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!segments_.empty()) {
+        const uint64_t window = static_cast<uint64_t>(options_.seconds * sampleRate_);
+        const uint64_t newest = segments_.back()->endFrame;
+        const uint64_t oldest = std::max(segments_.front()->firstFrame, newest > window ? newest - window : 0);
+        stats.historyFrames = newest - oldest;
+    }
+    for (const auto& segment : segments_) {
+        stats.bytesUsed += segment->used;
+    }
+    stats.bytesAllocated = allocatedSegments_ * segmentBytes_;
+    stats.encodedFrames = encodedFrames_;
+    stats.encodeNanos = encodeNanos_;
+    stats.droppedSamples = subscription_ ? subscription_->GetStats().dropped_samples : 0;
+    return stats;
+}
@@ -1,6 +1,10 @@
 #include "recorder.h"
 #include "logger.h"
+#ifdef __APPLE__
 #include "mac_recorder.h"
+#else
+#include "headless_recorder.h"
+#endif
 
 // 基础实现，后续会根据平台进行具体功能实现
 AudioRecorder::AudioRecorder() 
@@ -16,7 +20,8 @@ AudioRecorder::AudioRecorder()
     platformImpl_ = new MacRecorder(this);
     Logger::info("使用 macOS 录音实现");
 #else
-    Logger::warn("当前平台尚未实现录音功能");
+    platformImpl_ = new HeadlessRecorder(this);
+    Logger::info("使用无头录音实现");
 #endif
 }
 
@@ -28,13 +33,10 @@ AudioRecorder::~AudioRecorder() {
     
     // 清理平台特定资源
     if (platformImpl_) {
-#ifdef __APPLE__
         delete platformImpl_;
-#endif
         platformImpl_ = nullptr;
     }
-    
-    Logger::shutdown();
+    // 日志线程由所有录音器共用，不在这里停止，进程退出时由 Logger::init() 注册的 atexit 处理
 }
 
 bool AudioRecorder::Start() {
@@ -47,9 +49,7 @@ bool AudioRecorder::Start() {
     // 使用平台实现
     bool success = false;
     if (platformImpl_) {
-#ifdef __APPLE__
         success = platformImpl_->Start();
-#endif
     } else {
         Logger::error("平台实现为空，无法开始录制");
         return false;
@@ -75,9 +75,7 @@ void AudioRecorder::Stop() {
     
     // 使用平台实现
     if (platformImpl_) {
-#ifdef __APPLE__
         platformImpl_->Stop();
-#endif
     }
     
     isRecording_ = false;
@@ -94,9 +92,7 @@ void AudioRecorder::Pause() {
     
     // 使用平台实现
     if (platformImpl_) {
-#ifdef __APPLE__
         platformImpl_->Pause();
-#endif
     }
     
     isPaused_ = true;
@@ -112,9 +108,7 @@ void AudioRecorder::Resume() {
     
     // 使用平台实现
     if (platformImpl_) {
-#ifdef __APPLE__
         platformImpl_->Resume();
-#endif
     }
     
     isPaused_ = false;
@@ -133,9 +127,7 @@ void AudioRecorder::SetOutputPath(const std::string& path) {
     
     // 设置平台实现的输出路径
     if (platformImpl_) {
-#ifdef __APPLE__
         platformImpl_->SetOutputPath(path);
-#endif
     }
 }
 
@@ -143,10 +135,38 @@ std::string AudioRecorder::GetCurrentMicrophoneApp() {
     Logger::info("获取当前占用麦克风的应用");
     
     if (platformImpl_) {
-#ifdef __APPLE__
         return platformImpl_->GetCurrentMicrophoneApp();
-#endif
     }
     
     return "Unknown Application";
-} 
\ No newline at end of file
+}
+
+void AudioRecorder::SetPcmStream(PcmStream* stream) {
+    Logger::info("%s PCM 流", stream ? "挂接" : "取消");
+
+    if (platformImpl_) {
+        platformImpl_->SetPcmStream(stream);
+    }
+}
+
+PipelineMetrics::Snapshot AudioRecorder::GetMetrics() const {
+    if (platformImpl_) {
+        return platformImpl_->GetMetrics();
+    }
+    return PipelineMetrics::Snapshot();
+}
+
+bool AudioRecorder::SupportsMonitoring() {
+#ifdef __APPLE__
+    return false;
+#else
+    return true;
+#endif
+}
+
+CaptureLevels AudioRecorder::GetLevels() const {
+    if (platformImpl_) {
+        return platformImpl_->GetLevels();
+    }
+    return CaptureLevels{};
+}
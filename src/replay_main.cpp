@@ -0,0 +1,199 @@
+// recorder_replay：把采集轨迹（见 CaptureTraceWriter，录音时设置 RECORDER_TRACE 得到）送入当前的管线，
+// 按记录原样复现两路回调的块大小、时间戳和先后顺序，报告各级的 CPU 耗时和输出文件的 CRC32C，
+// 用于跨版本对比性能和检查输出是否逐位一致
+//
+// 用法: recorder_replay [选项] <轨迹文件>
+//   --speed X    按录制时的节奏 X 倍速回放，默认 0（不限速）
+//   -o PATH      混合音频输出路径，默认 replay.wav；扩展名决定编码，同目录另写 _mic/_source 两路
+//   --no-aec     关闭回声消除
+//   --dsp        麦克风轨道经高通/降噪/AGC2 处理
+//   --no-align   关闭时间戳对齐
+//   -v           输出管线日志
+// 其余管线参数沿用 HeadlessRecorder 的环境变量，命令行选项优先；轨迹中的流名须为 system 和 microphone
+
+#include "audio_encoder.h"
+#include "capture_trace.h"
+#include "crc32c.h"
+#include "headless_recorder.h"
+#include "logger.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+void PrintUsage() {
+    fprintf(stderr, "用法: recorder_replay [--speed X] [-o 输出路径] [--no-aec] [--dsp] [--no-align] [-v] <轨迹文件>\n");
+}
+
+const char* RecordTypeName(CaptureTrace::RecordType type) {
+    switch (type) {
+    case CaptureTrace::RecordType::Stream:
+        return "stream";
+    case CaptureTrace::RecordType::Format:
+        return "format";
+    case CaptureTrace::RecordType::Block:
+        return "block";
+    case CaptureTrace::RecordType::Gap:
+        return "gap";
+    case CaptureTrace::RecordType::Event:
+        return "event";
+    }
+    return "?";
+}
+
+// 轨迹中各路的统计、格式变化和事件
+bool PrintTraceSummary(const std::string& path) {
+    CaptureTraceReader trace;
+    if (!trace.Open(path)) {
+        return false;
+    }
+    printf("轨迹 %s: %zu 条记录, 时长 %.2f 秒\n", path.c_str(), trace.RecordCount(), trace.DurationNanos() / 1e9);
+    printf("%-3s %-12s %8s %4s %9s %11s %9s %8s %10s %8s\n", "流", "名称", "采样率", "声道", "块数", "帧数",
+           "音频(s)", "最大块", "丢失帧", "格式变化");
+    const std::vector<CaptureTraceReader::StreamInfo>& streams = trace.Streams();
+    for (size_t i = 0; i < streams.size(); ++i) {
+        const CaptureTraceReader::StreamInfo& info = streams[i];
+        printf("%-3zu %-12s %8d %4zu %9llu %11llu %9.2f %8zu %10llu %8llu\n", i, info.name.c_str(),
+               info.sampleRate, info.channels, static_cast<unsigned long long>(info.blocks),
+               static_cast<unsigned long long>(info.frames),
+               info.sampleRate > 0 ? static_cast<double>(info.frames) / info.sampleRate : 0.0, info.maxBlockFrames,
+               static_cast<unsigned long long>(info.gapFrames), static_cast<unsigned long long>(info.formatChanges));
+    }
+    const uint64_t origin = trace.RecordCount() > 0 ? trace.GetRecord(0).arrivalNanos : 0;
+    for (size_t i = 0; i < trace.RecordCount(); ++i) {
+        const CaptureTraceReader::Record record = trace.GetRecord(i);
+        if (record.type == CaptureTrace::RecordType::Format) {
+            printf("  %10.3f s  %-6s 流 %d: %d Hz, %zu 声道\n", (record.arrivalNanos - origin) / 1e9,
+                   RecordTypeName(record.type), record.stream, record.sampleRate, record.channels);
+        } else if (record.type == CaptureTrace::RecordType::Event) {
+            printf("  %10.3f s  %-6s %.*s\n", (record.arrivalNanos - origin) / 1e9, RecordTypeName(record.type),
+                   static_cast<int>(record.textLength), record.text);
+        }
+    }
+    return true;
+}
+
+// 各级处理耗时的直方图（*_ns，不含回调抖动和对齐延迟这类时间间隔），占比相对于回放期间的进程 CPU 时间；
+// 回调耗时包含其中各级的耗时
+void PrintStageTable(const PipelineMetrics::Snapshot& snapshot, double cpuSeconds) {
+    printf("\n%-32s %9s %10s %9s %9s %9s %7s\n", "阶段", "次数", "合计(ms)", "平均(us)", "p99(us)", "最大(us)",
+           "CPU%");
+    for (const PipelineMetrics::Entry& entry : snapshot.entries) {
+        const std::string& name = entry.name;
+        if (entry.kind != PipelineMetrics::Kind::Histogram || entry.histogram.count == 0 ||
+            name.size() < 3 || name.compare(name.size() - 3, 3, "_ns") != 0 ||
+            name.find("jitter") != std::string::npos || name.find("latency") != std::string::npos) {
+            continue;
+        }
+        const PipelineMetrics::HistogramSnapshot& h = entry.histogram;
+        printf("%-32s %9llu %10.1f %9.2f %9.2f %9.2f %6.1f%%\n", name.c_str(),
+               static_cast<unsigned long long>(h.count), h.sum / 1e6, h.Mean() / 1e3, h.Percentile(0.99) / 1e3,
+               h.max / 1e3, cpuSeconds > 0.0 ? h.sum / 1e9 / cpuSeconds * 100.0 : 0.0);
+    }
+}
+
+// 文件不存在时返回 false
+bool FileCrc(const std::string& path, uint32_t* crc, size_t* size) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    const std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    *crc = Crc32c::Compute(bytes.data(), bytes.size());
+    *size = bytes.size();
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    HeadlessRecorder::Options options = HeadlessRecorder::Options::FromEnvironment();
+    options.speed = 0.0;
+    options.tracePath.clear();
+    std::string outputPath = "replay.wav";
+    std::string tracePath;
+    bool verbose = false;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--speed") == 0 && i + 1 < argc) {
+            options.speed = std::max(0.0, atof(argv[++i]));
+        } else if (strcmp(arg, "-o") == 0 && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (strcmp(arg, "--no-aec") == 0) {
+            options.echoCancellation = false;
+        } else if (strcmp(arg, "--dsp") == 0) {
+            options.micProcessing = true;
+        } else if (strcmp(arg, "--no-align") == 0) {
+            options.alignStreams = false;
+        } else if (strcmp(arg, "-v") == 0) {
+            verbose = true;
+        } else if (arg[0] == '-' || !tracePath.empty()) {
+            PrintUsage();
+            return 2;
+        } else {
+            tracePath = arg;
+        }
+    }
+    if (tracePath.empty()) {
+        PrintUsage();
+        return 2;
+    }
+
+    Logger::init();
+    Logger::setLevel(verbose ? Logger::Level::INFO : Logger::Level::WARN);
+    if (!PrintTraceSummary(tracePath)) {
+        Logger::shutdown();
+        return 2;
+    }
+
+    options.system.tracePath = tracePath;
+    options.system.traceStream = "system";
+    options.microphone.tracePath = tracePath;
+    options.microphone.traceStream = "microphone";
+    HeadlessRecorder recorder(nullptr, options);
+    recorder.SetOutputPath(outputPath);
+    if (!recorder.Start()) {
+        fprintf(stderr, "回放启动失败\n");
+        Logger::shutdown();
+        return 1;
+    }
+    recorder.WaitUntilFinished();
+    const HeadlessRecorder::Stats stats = recorder.GetStats();
+    const PipelineMetrics::Snapshot metrics = recorder.GetMetrics();
+    recorder.Stop();
+
+    printf("\n回放: 音频 %.2f 秒, 墙钟 %.3f 秒, CPU %.3f 秒, 实时倍数 %.1f, 每 CPU 秒处理 %.1f 秒音频, 丢弃 %llu 帧\n",
+           stats.audioSeconds, stats.wallSeconds, stats.cpuSeconds,
+           stats.wallSeconds > 0.0 ? stats.audioSeconds / stats.wallSeconds : 0.0,
+           stats.cpuSeconds > 0.0 ? stats.audioSeconds / stats.cpuSeconds : 0.0,
+           static_cast<unsigned long long>(stats.droppedFrames));
+    PrintStageTable(metrics, stats.cpuSeconds);
+
+    // 三路输出的 CRC32C，两次回放（或回放与录制）一致说明处理结果逐位相同
+    const AudioEncoder::Codec codec = AudioEncoder::CodecForPath(outputPath);
+    const std::string extension = AudioEncoder::Extension(codec);
+    std::string stem = outputPath;
+    if (stem.size() > extension.size() && stem.compare(stem.size() - extension.size(), extension.size(), extension) == 0) {
+        stem.resize(stem.size() - extension.size());
+    }
+    printf("\n%-40s %12s %10s\n", "输出", "字节", "CRC32C");
+    bool ok = true;
+    for (const std::string& path : {stem + extension, stem + "_mic" + extension, stem + "_source" + extension}) {
+        uint32_t crc = 0;
+        size_t size = 0;
+        if (FileCrc(path, &crc, &size)) {
+            printf("%-40s %12zu   %08x\n", path.c_str(), size, crc);
+        } else {
+            printf("%-40s %12s   %8s\n", path.c_str(), "-", "-");
+            ok = false;
+        }
+    }
+    Logger::shutdown();
+    return ok ? 0 : 1;
+}
@@ -1,69 +1,208 @@
 #include "ring_buffer.h"
-#include "logger.h"
+#include "audio_kernels.h"
+#include <algorithm>
+#include <cstring>
 
-RingBuffer::RingBuffer(size_t size) 
-    : buffer_(size)
-    , read_pos_(0)
-    , write_pos_(0)
-    , size_(size)
+namespace {
+
+size_t RoundUpToPowerOfTwo(size_t size) {
+    size_t capacity = 1;
+    while (capacity < size) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+// 存储格式与 float 之间的转换，count 为样本数
+void Store(const float* src, float* dst, size_t count) {
+    memcpy(dst, src, count * sizeof(float));
+}
+
+void Store(const float* src, int16_t* dst, size_t count) {
+    AudioKernels::FloatToInt16(src, dst, count);
+}
+
+void Store(const float* src, PackedInt24* dst, size_t count) {
+    AudioKernels::FloatToInt24(src, dst->bytes, count);
+}
+
+void Load(const float* src, float* dst, size_t count) {
+    memcpy(dst, src, count * sizeof(float));
+}
+
+void Load(const int16_t* src, float* dst, size_t count) {
+    AudioKernels::Int16ToFloat(src, dst, count);
+}
+
+void Load(const PackedInt24* src, float* dst, size_t count) {
+    AudioKernels::Int24ToFloat(src->bytes, dst, count);
+}
+
+} // namespace
+
+static_assert(sizeof(PackedInt24) == 3, "PackedInt24 必须紧凑存放");
+
+template <typename Sample, size_t FrameWidth>
+BasicRingBuffer<Sample, FrameWidth>::BasicRingBuffer(size_t frames, OverflowPolicy policy)
+    : write_pos_(0)
     , overflow_count_(0)
+    , dropped_samples_(0)
+    , max_used_size_(0)
+    , read_pos_(0)
     , underflow_count_(0)
-    , max_used_size_(0) {
+    , capacity_(RoundUpToPowerOfTwo(std::max<size_t>(frames, 2)))
+    , mask_(capacity_ - 1)
+    , policy_(policy) {
+    buffer_.reset(new Sample[capacity_ * FrameWidth]());
 }
 
-bool RingBuffer::write(const float* data, size_t count) {
-    std::unique_lock<std::mutex> lock(mutex_);
-    
-    if (available_write() < count) {
-        overflow_count_++;
-        if (overflow_count_ % 100 == 0) {
-            Logger::warn("环形缓冲区溢出次数: %zu", overflow_count_);
-        }
-        return false;
+template <typename Sample, size_t FrameWidth>
+void BasicRingBuffer<Sample, FrameWidth>::copy_in(uint64_t pos, const float* data, size_t frames) {
+    size_t offset = static_cast<size_t>(pos) & mask_;
+    size_t first = std::min(frames, capacity_ - offset);
+    Store(data, buffer_.get() + offset * FrameWidth, first * FrameWidth);
+    if (first < frames) {
+        Store(data + first * FrameWidth, buffer_.get(), (frames - first) * FrameWidth);
     }
-    
-    for (size_t i = 0; i < count; ++i) {
-        buffer_[write_pos_] = data[i];
-        write_pos_ = (write_pos_ + 1) % size_;
-    }
-    
-    size_t used_size = available_read();
-    if (used_size > max_used_size_) {
-        max_used_size_ = used_size;
+}
+
+template <typename Sample, size_t FrameWidth>
+void BasicRingBuffer<Sample, FrameWidth>::copy_out(uint64_t pos, float* data, size_t frames) const {
+    size_t offset = static_cast<size_t>(pos) & mask_;
+    size_t first = std::min(frames, capacity_ - offset);
+    Load(buffer_.get() + offset * FrameWidth, data, first * FrameWidth);
+    if (first < frames) {
+        Load(buffer_.get(), data + first * FrameWidth, (frames - first) * FrameWidth);
     }
-    
-    cv_.notify_one();
-    return true;
 }
 
-bool RingBuffer::read(float* data, size_t count) {
-    std::unique_lock<std::mutex> lock(mutex_);
-    
-    if (available_read() < count) {
-        if (cv_.wait_for(lock, std::chrono::milliseconds(10), 
-                       [this, count] { return available_read() >= count; })) {
-            underflow_count_++;
-            if (underflow_count_ % 100 == 0) {
-                Logger::warn("环形缓冲区欠载次数: %zu", underflow_count_);
-            }
+template <typename Sample, size_t FrameWidth>
+bool BasicRingBuffer<Sample, FrameWidth>::write(const float* data, size_t frames) {
+    if (frames == 0) {
+        return true;
+    }
+
+    // 统计计数只有生产者写入，用 load/store 代替 fetch_add 避免总线锁
+    const uint64_t w = write_pos_.load(std::memory_order_relaxed);
+    uint64_t r = read_pos_.load(std::memory_order_acquire);
+
+    if (frames > capacity_ - static_cast<size_t>(w - r)) {
+        overflow_count_.store(overflow_count_.load(std::memory_order_relaxed) + 1,
+                              std::memory_order_relaxed);
+
+        if (policy_ == OverflowPolicy::DropNewest) {
+            dropped_samples_.store(dropped_samples_.load(std::memory_order_relaxed) + frames,
+                                   std::memory_order_relaxed);
             return false;
         }
+
+        // 一次写入超过容量时只保留最后 capacity_ 帧
+        size_t dropped = 0;
+        if (frames > capacity_) {
+            dropped = frames - capacity_;
+            data += dropped * FrameWidth;
+            frames = capacity_;
+        }
+
+        // 推进读位置腾出空间；与消费者竞争时 CAS 失败会刷新 r 后重试
+        while (frames > capacity_ - static_cast<size_t>(w - r)) {
+            const uint64_t new_r = w + frames - capacity_;
+            if (read_pos_.compare_exchange_weak(r, new_r,
+                                                std::memory_order_acq_rel,
+                                                std::memory_order_acquire)) {
+                dropped += static_cast<size_t>(new_r - r);
+                break;
+            }
+        }
+        dropped_samples_.store(dropped_samples_.load(std::memory_order_relaxed) + dropped,
+                               std::memory_order_relaxed);
+        r = read_pos_.load(std::memory_order_relaxed);
+    }
+
+    copy_in(w, data, frames);
+    write_pos_.store(w + frames, std::memory_order_release);
+
+    size_t used = static_cast<size_t>(w + frames - r);
+    if (used > capacity_) {
+        used = capacity_;
     }
-    
-    for (size_t i = 0; i < count; ++i) {
-        data[i] = buffer_[read_pos_];
-        read_pos_ = (read_pos_ + 1) % size_;
+    if (used > max_used_size_.load(std::memory_order_relaxed)) {
+        max_used_size_.store(used, std::memory_order_relaxed);
     }
     return true;
 }
 
-size_t RingBuffer::available_read() const {
-    if (write_pos_ >= read_pos_) {
-        return write_pos_ - read_pos_;
+template <typename Sample, size_t FrameWidth>
+bool BasicRingBuffer<Sample, FrameWidth>::read(float* data, size_t frames) {
+    uint64_t r = read_pos_.load(std::memory_order_acquire);
+    for (;;) {
+        const uint64_t w = write_pos_.load(std::memory_order_acquire);
+        if (static_cast<size_t>(w - r) < frames) {
+            underflow_count_.store(underflow_count_.load(std::memory_order_relaxed) + 1,
+                                   std::memory_order_relaxed);
+            return false;
+        }
+
+        copy_out(r, data, frames);
+
+        if (policy_ == OverflowPolicy::DropNewest) {
+            read_pos_.store(r + frames, std::memory_order_release);
+            return true;
+        }
+
+        // DropOldest 模式下生产者可能在拷贝期间覆盖了这段数据，
+        // CAS 失败说明读位置已被推进，用新的 r 重新读取
+        if (read_pos_.compare_exchange_strong(r, r + frames,
+                                              std::memory_order_acq_rel,
+                                              std::memory_order_acquire)) {
+            return true;
+        }
     }
-    return size_ - read_pos_ + write_pos_;
 }
 
-size_t RingBuffer::available_write() const {
-    return size_ - available_read() - 1;
-} 
\ No newline at end of file
+template <typename Sample, size_t FrameWidth>
+size_t BasicRingBuffer<Sample, FrameWidth>::available_read() const {
+    const uint64_t r = read_pos_.load(std::memory_order_acquire);
+    const uint64_t w = write_pos_.load(std::memory_order_acquire);
+    return static_cast<size_t>(w - r);
+}
+
+template <typename Sample, size_t FrameWidth>
+size_t BasicRingBuffer<Sample, FrameWidth>::available_write() const {
+    return capacity_ - available_read();
+}
+
+template <typename Sample, size_t FrameWidth>
+RingBufferBase::Stats BasicRingBuffer<Sample, FrameWidth>::get_stats() const {
+    return {
+        overflow_count_.load(std::memory_order_relaxed),
+        underflow_count_.load(std::memory_order_relaxed),
+        dropped_samples_.load(std::memory_order_relaxed),
+        max_used_size_.load(std::memory_order_relaxed),
+        capacity_
+    };
+}
+
+template <typename Sample, size_t FrameWidth>
+void BasicRingBuffer<Sample, FrameWidth>::clear() {
+    read_pos_.store(0, std::memory_order_relaxed);
+    write_pos_.store(0, std::memory_order_relaxed);
+    overflow_count_.store(0, std::memory_order_relaxed);
+    underflow_count_.store(0, std::memory_order_relaxed);
+    dropped_samples_.store(0, std::memory_order_relaxed);
+    max_used_size_.store(0, std::memory_order_relaxed);
+}
+
+#define INSTANTIATE_RING_BUFFER(Sample)          \
+    template class BasicRingBuffer<Sample, 1>;   \
+    template class BasicRingBuffer<Sample, 2>;   \
+    template class BasicRingBuffer<Sample, 3>;   \
+    template class BasicRingBuffer<Sample, 4>;   \
+    template class BasicRingBuffer<Sample, 5>;   \
+    template class BasicRingBuffer<Sample, 6>;   \
+    template class BasicRingBuffer<Sample, 7>;   \
+    template class BasicRingBuffer<Sample, 8>;
+
+INSTANTIATE_RING_BUFFER(float)
+INSTANTIATE_RING_BUFFER(int16_t)
+INSTANTIATE_RING_BUFFER(PackedInt24)
@@ -0,0 +1,40 @@
+#include "scratch_buffer.h"
+
+ScratchBuffer::ScratchBuffer(size_t samples) {
+    Reserve(samples);
+}
+
+void ScratchBuffer::Reserve(size_t samples) {
+    std::lock_guard<std::mutex> lock(reserveMutex_);
+
+    Block* current = current_.load(std::memory_order_relaxed);
+    if (current && current->capacity >= samples) {
+        return;
+    }
+
+    // 按 2 倍增长，保证保留下来的旧缓冲区总量有界
+    size_t capacity = current ? current->capacity * 2 : samples;
+    if (capacity < samples) {
+        capacity = samples;
+    }
+
+    auto block = std::make_unique<Block>();
+    block->data.reset(new float[capacity]());
+    block->capacity = capacity;
+    current_.store(block.get(), std::memory_order_release);
+    blocks_.push_back(std::move(block));
+}
+
+float* ScratchBuffer::Data(size_t samples) {
+    Block* current = current_.load(std::memory_order_acquire);
+    if (!current || current->capacity < samples) {
+        missCount_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    return current->data.get();
+}
+
+size_t ScratchBuffer::Capacity() const {
+    Block* current = current_.load(std::memory_order_acquire);
+    return current ? current->capacity : 0;
+}
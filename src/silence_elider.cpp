@@ -0,0 +1,323 @@
+#include "silence_elider.h"
+#include "audio_kernels.h"
+#include "logger.h"
+#include "ring_buffer.h"
+#include "common_audio/resampler/include/push_resampler.h"
+#include "common_audio/vad/include/webrtc_vad.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+// WebRtcVad 原生支持的采样率，其他采样率重采样到 16k
+constexpr int kVadFallbackRate = 16000;
+
+bool IsNativeVadRate(uint32_t rate) {
+    return rate == 8000 || rate == 16000 || rate == 32000 || rate == 48000;
+}
+
+size_t MillisecondsToFrames(uint32_t milliseconds) {
+    return (milliseconds + 9) / 10;
+}
+
+uint64_t ThreadCpuNanoseconds() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+bool WriteAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+// VAD 句柄及下混、重采样用的缓冲，全部在 Initialize() 时分配
+class SilenceElider::Vad {
+public:
+    Vad()
+        : handle(nullptr)
+        , rate(0) {
+    }
+
+    ~Vad() {
+        if (handle) {
+            WebRtcVad_Free(handle);
+        }
+    }
+
+    VadInst* handle;
+    int rate;
+    std::vector<float> mono;
+    std::vector<int16_t> pcm;
+    std::vector<int16_t> resampled;
+    webrtc::PushResampler<int16_t> resampler;
+};
+
+SilenceElider::SilenceElider()
+    : sampleRate_(0)
+    , channels_(0)
+    , frameSize_(0)
+    , hangoverFrames_(0)
+    , prerollFrames_(0)
+    , gapThresholdFrames_(0)
+    , frameFill_(0)
+    , pendingCapacity_(0)
+    , pendingHead_(0)
+    , pendingCount_(0)
+    , pendingOriginalStart_(0)
+    , hangoverRemaining_(0)
+    , inGap_(false)
+    , openGap_{0, 0, 0}
+    , originalFrames_(0)
+    , storedFrames_(0)
+    , speechFrames_(0)
+    , cpuNanoseconds_(0) {
+}
+
+SilenceElider::~SilenceElider() = default;
+
+bool SilenceElider::Initialize(uint32_t sampleRate, uint16_t channels, const Options& options) {
+    if (sampleRate < 8000 || sampleRate % 100 != 0 || channels == 0) {
+        Logger::error("静音省略不支持的格式: 采样率 %u, 声道数 %u", sampleRate, channels);
+        return false;
+    }
+
+    vad_ = std::make_unique<Vad>();
+    vad_->handle = WebRtcVad_Create();
+    if (!vad_->handle || WebRtcVad_Init(vad_->handle) != 0 ||
+        WebRtcVad_set_mode(vad_->handle, std::clamp(options.vadMode, 0, 3)) != 0) {
+        Logger::error("初始化 VAD 失败");
+        vad_.reset();
+        return false;
+    }
+
+    sampleRate_ = sampleRate;
+    channels_ = channels;
+    frameSize_ = sampleRate / 100;
+    vad_->rate = IsNativeVadRate(sampleRate) ? static_cast<int>(sampleRate) : kVadFallbackRate;
+    vad_->mono.assign(frameSize_, 0.0f);
+    vad_->pcm.assign(frameSize_, 0);
+    if (vad_->rate != static_cast<int>(sampleRate)) {
+        vad_->resampled.assign(static_cast<size_t>(vad_->rate / 100), 0);
+        vad_->resampler.InitializeIfNeeded(static_cast<int>(sampleRate), vad_->rate, 1);
+    }
+
+    hangoverFrames_ = MillisecondsToFrames(options.hangoverMilliseconds);
+    prerollFrames_ = MillisecondsToFrames(options.prerollMilliseconds);
+    gapThresholdFrames_ = prerollFrames_ + std::max<size_t>(1, MillisecondsToFrames(options.minimumGapMilliseconds));
+
+    frame_.assign(frameSize_ * channels_, 0.0f);
+    frameFill_ = 0;
+    pendingCapacity_ = gapThresholdFrames_;
+    pending_.assign(pendingCapacity_ * frameSize_ * channels_, 0.0f);
+    pendingHead_ = 0;
+    pendingCount_ = 0;
+    pendingOriginalStart_ = 0;
+    hangoverRemaining_ = 0;
+    inGap_ = false;
+    originalFrames_ = 0;
+    storedFrames_ = 0;
+    speechFrames_ = 0;
+    cpuNanoseconds_ = 0;
+    gaps_.clear();
+    return true;
+}
+
+size_t SilenceElider::MaxOutputFrames(size_t inputFrames) const {
+    // 一个语音帧最多带出整个待定缓冲，再加上本次输入和上次剩下的不足 10ms 的部分
+    return inputFrames + (pendingCapacity_ + 1) * frameSize_;
+}
+
+void SilenceElider::Process(const float* interleaved, size_t frames, RingBuffer* output) {
+    const uint64_t start = ThreadCpuNanoseconds();
+    while (frames > 0) {
+        const size_t n = std::min(frames, frameSize_ - frameFill_);
+        memcpy(frame_.data() + frameFill_ * channels_, interleaved, n * channels_ * sizeof(float));
+        frameFill_ += n;
+        interleaved += n * channels_;
+        frames -= n;
+        if (frameFill_ == frameSize_) {
+            ProcessFrame(frame_.data(), output);
+            frameFill_ = 0;
+        }
+    }
+    cpuNanoseconds_ += ThreadCpuNanoseconds() - start;
+}
+
+void SilenceElider::Finish(RingBuffer* output) {
+    FlushPending(output);
+    if (frameFill_ > 0) {
+        originalFrames_ += frameFill_;
+        Emit(frame_.data(), frameFill_, output);
+        frameFill_ = 0;
+    }
+}
+
+void SilenceElider::ProcessFrame(const float* frame, RingBuffer* output) {
+    const uint64_t position = originalFrames_;
+    originalFrames_ += frameSize_;
+
+    if (IsSpeech(frame)) {
+        speechFrames_ += frameSize_;
+        hangoverRemaining_ = hangoverFrames_;
+        FlushPending(output);
+        Emit(frame, frameSize_, output);
+        return;
+    }
+    if (hangoverRemaining_ > 0) {
+        --hangoverRemaining_;
+        Emit(frame, frameSize_, output);
+        return;
+    }
+
+    if (pendingCount_ == 0) {
+        pendingOriginalStart_ = position;
+    }
+    PushPending(frame);
+}
+
+bool SilenceElider::IsSpeech(const float* frame) {
+    Vad& vad = *vad_;
+    if (channels_ == 1) {
+        memcpy(vad.mono.data(), frame, frameSize_ * sizeof(float));
+    } else if (channels_ == 2) {
+        AudioKernels::StereoToMono(frame, vad.mono.data(), frameSize_);
+    } else {
+        const float scale = 1.0f / static_cast<float>(channels_);
+        for (size_t i = 0; i < frameSize_; ++i) {
+            float sum = 0.0f;
+            for (size_t c = 0; c < channels_; ++c) {
+                sum += frame[i * channels_ + c];
+            }
+            vad.mono[i] = sum * scale;
+        }
+    }
+    AudioKernels::FloatToInt16(vad.mono.data(), vad.pcm.data(), frameSize_);
+
+    const int16_t* samples = vad.pcm.data();
+    size_t count = frameSize_;
+    if (!vad.resampled.empty()) {
+        const int n = vad.resampler.Resample(vad.pcm.data(), frameSize_, vad.resampled.data(), vad.resampled.size());
+        if (n <= 0) {
+            return true;
+        }
+        samples = vad.resampled.data();
+        count = static_cast<size_t>(n);
+    }
+    // 判定出错时按语音处理，宁可少省也不丢内容
+    return WebRtcVad_Process(vad.handle, vad.rate, samples, count) != 0;
+}
+
+void SilenceElider::PushPending(const float* frame) {
+    const size_t frameSamples = frameSize_ * channels_;
+    // 成段之前缓存到门限为止，成段之后只留 preroll 供语音恢复时衔接
+    const size_t limit = inGap_ ? prerollFrames_ : pendingCapacity_;
+    if (pendingCount_ >= limit) {
+        if (!inGap_) {
+            inGap_ = true;
+            openGap_ = Gap{storedFrames_, pendingOriginalStart_, 0};
+        }
+        // 丢弃最旧的帧，连同本帧之后恰好剩下 preroll
+        const size_t keep = prerollFrames_ > 0 ? prerollFrames_ - 1 : 0;
+        const size_t drop = pendingCount_ - std::min(pendingCount_, keep);
+        openGap_.frames += static_cast<uint64_t>(drop) * frameSize_;
+        pendingOriginalStart_ += static_cast<uint64_t>(drop) * frameSize_;
+        pendingHead_ = (pendingHead_ + drop) % pendingCapacity_;
+        pendingCount_ -= drop;
+        if (prerollFrames_ == 0) {
+            openGap_.frames += frameSize_;
+            pendingOriginalStart_ += frameSize_;
+            return;
+        }
+    }
+    const size_t slot = (pendingHead_ + pendingCount_) % pendingCapacity_;
+    memcpy(pending_.data() + slot * frameSamples, frame, frameSamples * sizeof(float));
+    ++pendingCount_;
+}
+
+void SilenceElider::FlushPending(RingBuffer* output) {
+    if (inGap_) {
+        gaps_.push_back(openGap_);
+        inGap_ = false;
+    }
+    const size_t frameSamples = frameSize_ * channels_;
+    while (pendingCount_ > 0) {
+        const size_t run = std::min(pendingCount_, pendingCapacity_ - pendingHead_);
+        Emit(pending_.data() + pendingHead_ * frameSamples, run * frameSize_, output);
+        pendingHead_ = (pendingHead_ + run) % pendingCapacity_;
+        pendingCount_ -= run;
+    }
+    pendingHead_ = 0;
+}
+
+void SilenceElider::Emit(const float* data, size_t frames, RingBuffer* output) {
+    // output 的空间由调用方按 MaxOutputFrames() 保证
+    output->write(data, frames * channels_);
+    storedFrames_ += frames;
+}
+
+SilenceElider::Stats SilenceElider::GetStats() const {
+    Stats stats;
+    stats.originalFrames = originalFrames_ + frameFill_;
+    stats.storedFrames = storedFrames_;
+    stats.speechFrames = speechFrames_;
+    stats.gaps = gaps_.size() + (inGap_ ? 1 : 0);
+    stats.cpuNanoseconds = cpuNanoseconds_;
+    return stats;
+}
+
+bool SilenceElider::WriteEditList(const std::string& path) const {
+    std::string json;
+    json.reserve(256 + gaps_.size() * 96);
+    char line[160];
+    snprintf(line, sizeof(line),
+             "{\n  \"version\": 1,\n  \"sampleRate\": %u,\n  \"channels\": %u,\n"
+             "  \"originalFrames\": %llu,\n  \"storedFrames\": %llu,\n  \"gaps\": [",
+             sampleRate_, channels_, static_cast<unsigned long long>(originalFrames_),
+             static_cast<unsigned long long>(storedFrames_));
+    json += line;
+    for (size_t i = 0; i < gaps_.size(); ++i) {
+        snprintf(line, sizeof(line), "%s\n    {\"storedFrame\": %llu, \"originalFrame\": %llu, \"frames\": %llu}",
+                 i == 0 ? "" : ",", static_cast<unsigned long long>(gaps_[i].storedFrame),
+                 static_cast<unsigned long long>(gaps_[i].originalFrame),
+                 static_cast<unsigned long long>(gaps_[i].frames));
+        json += line;
+    }
+    json += gaps_.empty() ? "]\n}\n" : "\n  ]\n}\n";
+
+    const std::string temporary = path + ".tmp";
+    const int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        Logger::error("创建编辑表失败: %s (%s)", temporary.c_str(), strerror(errno));
+        return false;
+    }
+    const bool ok = WriteAll(fd, json.data(), json.size());
+    close(fd);
+    if (!ok || rename(temporary.c_str(), path.c_str()) != 0) {
+        Logger::error("写入编辑表失败: %s (%s)", path.c_str(), strerror(errno));
+        unlink(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::string SilenceElider::EditListPath(const std::string& audioPath) {
+    return audioPath + ".edits.json";
+}
@@ -0,0 +1,216 @@
+#include "stream_aligner.h"
+#include "logger.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 单写线程的 relaxed 累加
+template <typename T>
+void AddRelaxed(std::atomic<T>& counter, T n) {
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+} // namespace
+
+struct StreamAligner::Stream {
+    StreamOptions options;
+    PipelineMetrics::Histogram* latency = nullptr;
+    PipelineMetrics::Counter* inserted = nullptr;
+    PipelineMetrics::Counter* trimmed = nullptr;
+
+    // 只由该流的采集线程访问
+    bool started = false;
+    bool anchored = false;
+    double anchorSampleTime = 0.0;   // 采样时钟与时间线的对应点
+    int64_t anchorPosition = 0;
+    uint64_t written = 0;            // 已输出到时间线上的帧数
+
+    std::atomic<uint64_t> inputFrames{0};
+    std::atomic<uint64_t> outputFrames{0};
+    std::atomic<uint64_t> insertedFrames{0};
+    std::atomic<uint64_t> trimmedFrames{0};
+    std::atomic<uint64_t> discontinuities{0};
+    std::atomic<uint64_t> resyncs{0};
+    std::atomic<int64_t> startSkewNanos{0};
+    std::atomic<int64_t> clockErrorNanos{0};
+    std::atomic<uint64_t> latencySum{0};
+    std::atomic<uint64_t> latencyCount{0};
+    std::atomic<uint64_t> maxLatency{0};
+};
+
+StreamAligner::StreamOptions::StreamOptions() = default;
+StreamAligner::Options::Options() = default;
+
+StreamAligner::StreamAligner()
+    : origin_(0) {
+}
+
+StreamAligner::~StreamAligner() = default;
+
+bool StreamAligner::Initialize(const Options& options, const std::vector<StreamOptions>& streams) {
+    Release();
+    size_t silenceSamples = 0;
+    for (const StreamOptions& stream : streams) {
+        if (stream.sampleRate <= 0 || stream.channels == 0 || stream.maxBlockFrames == 0 || !stream.output) {
+            Logger::error("时间戳对齐参数无效: %s, %d Hz, %zu 声道", stream.name.c_str(), stream.sampleRate,
+                          stream.channels);
+            return false;
+        }
+        silenceSamples = std::max(silenceSamples, stream.maxBlockFrames * stream.channels);
+    }
+    options_ = options;
+    silence_.assign(silenceSamples, 0.0f);
+    for (const StreamOptions& streamOptions : streams) {
+        std::unique_ptr<Stream> stream(new Stream());
+        stream->options = streamOptions;
+        if (options_.metrics) {
+            const std::string prefix = options_.metricsPrefix + "." + streamOptions.name;
+            stream->latency = &options_.metrics->GetHistogram(prefix + ".latency_ns");
+            stream->inserted = &options_.metrics->GetCounter(prefix + ".inserted_frames");
+            stream->trimmed = &options_.metrics->GetCounter(prefix + ".trimmed_frames");
+        }
+        streams_.push_back(std::move(stream));
+    }
+    origin_.store(0, std::memory_order_relaxed);
+    return true;
+}
+
+void StreamAligner::Release() {
+    streams_.clear();
+    silence_.clear();
+    origin_.store(0, std::memory_order_relaxed);
+}
+
+void StreamAligner::Push(size_t index, const float* interleaved, size_t frames, const CaptureTimestamp& timestamp) {
+    Stream& stream = *streams_[index];
+    const double rate = stream.options.sampleRate;
+    const uint64_t now = PipelineMetrics::NowNanoseconds();
+    AddRelaxed<uint64_t>(stream.inputFrames, frames);
+
+    // 会话零点取最先到达的一块的主机时间，没有主机时间时取当前时刻
+    uint64_t origin = origin_.load(std::memory_order_acquire);
+    if (origin == 0) {
+        const uint64_t candidate = timestamp.HasHostTime() ? timestamp.hostNanos : now;
+        if (origin_.compare_exchange_strong(origin, candidate, std::memory_order_acq_rel)) {
+            origin = candidate;
+        }
+    }
+
+    // 按主机时间推算的时间线位置（帧，早于零点时为负）
+    const bool hasHost = timestamp.HasHostTime();
+    const int64_t hostOffset = static_cast<int64_t>(timestamp.hostNanos - origin);
+    const double hostPosition = hasHost ? static_cast<double>(hostOffset) * rate / 1e9 : 0.0;
+    const double resyncFrames = options_.resyncMilliseconds * rate / 1000.0;
+    const int64_t written = static_cast<int64_t>(stream.written);
+
+    int64_t target = written;
+    if (!stream.started) {
+        target = hasHost ? std::llround(hostPosition) : 0;
+        stream.startSkewNanos.store(hasHost ? hostOffset : 0, std::memory_order_relaxed);
+    } else if (timestamp.HasSampleTime() && stream.anchored) {
+        target = stream.anchorPosition + std::llround(timestamp.sampleTime - stream.anchorSampleTime);
+        // 采样时间与主机时间对不上（设备重置、采样时间归零）时以主机时间为准；
+        // 没有主机时间时无法判断，过大的跳跃只当作时钟重置，接着上一块继续
+        const bool reset = hasHost ? std::fabs(static_cast<double>(target) - hostPosition) > resyncFrames
+                                   : std::fabs(static_cast<double>(target - written)) > resyncFrames;
+        if (reset) {
+            target = hasHost ? std::llround(hostPosition) : written;
+            stream.anchored = false;
+            AddRelaxed<uint64_t>(stream.resyncs, 1);
+        }
+    } else if (hasHost) {
+        target = std::llround(hostPosition);
+        const double tolerance = options_.toleranceMicroseconds * rate / 1e6;
+        if (std::fabs(static_cast<double>(target - written)) <= tolerance) {
+            target = written;
+        }
+    }
+    if (timestamp.HasSampleTime() && !stream.anchored) {
+        stream.anchorSampleTime = timestamp.sampleTime;
+        stream.anchorPosition = target;
+        stream.anchored = true;
+    }
+    if (hasHost) {
+        stream.clockErrorNanos.store(
+            static_cast<int64_t>((static_cast<double>(target) - hostPosition) * 1e9 / rate), std::memory_order_relaxed);
+    }
+
+    size_t skip = 0;
+    const int64_t delta = target - written;
+    if (delta > 0) {
+        EmitSilence(stream, static_cast<uint64_t>(delta));
+        AddRelaxed<uint64_t>(stream.insertedFrames, static_cast<uint64_t>(delta));
+        if (stream.inserted) {
+            stream.inserted->Add(static_cast<uint64_t>(delta));
+        }
+    } else if (delta < 0) {
+        skip = static_cast<size_t>(std::min<int64_t>(-delta, static_cast<int64_t>(frames)));
+        AddRelaxed<uint64_t>(stream.trimmedFrames, skip);
+        if (stream.trimmed) {
+            stream.trimmed->Add(skip);
+        }
+    }
+    if (delta != 0 && stream.started) {
+        AddRelaxed<uint64_t>(stream.discontinuities, 1);
+    }
+    if (skip < frames) {
+        Emit(stream, interleaved + skip * stream.options.channels, frames - skip);
+    }
+    stream.started = true;
+
+    if (hasHost) {
+        const uint64_t end = timestamp.hostNanos + static_cast<uint64_t>(frames * 1e9 / rate);
+        const uint64_t latency = now > end ? now - end : 0;
+        AddRelaxed<uint64_t>(stream.latencySum, latency);
+        AddRelaxed<uint64_t>(stream.latencyCount, 1);
+        if (latency > stream.maxLatency.load(std::memory_order_relaxed)) {
+            stream.maxLatency.store(latency, std::memory_order_relaxed);
+        }
+        if (stream.latency) {
+            stream.latency->Record(latency);
+        }
+    }
+}
+
+void StreamAligner::Emit(Stream& stream, const float* interleaved, size_t frames) {
+    stream.options.output(interleaved, frames);
+    stream.written += frames;
+    AddRelaxed<uint64_t>(stream.outputFrames, frames);
+}
+
+void StreamAligner::EmitSilence(Stream& stream, uint64_t frames) {
+    while (frames > 0) {
+        const size_t chunk = static_cast<size_t>(std::min<uint64_t>(frames, stream.options.maxBlockFrames));
+        Emit(stream, silence_.data(), chunk);
+        frames -= chunk;
+    }
+}
+
+int64_t StreamAligner::RelativeOffsetNanos(size_t a, size_t b) const {
+    return streams_[a]->clockErrorNanos.load(std::memory_order_relaxed) -
+           streams_[b]->clockErrorNanos.load(std::memory_order_relaxed);
+}
+
+StreamAligner::Stats StreamAligner::GetStats() const {
+    Stats stats;
+    stats.originHostNanos = origin_.load(std::memory_order_acquire);
+    for (const auto& stream : streams_) {
+        StreamStats s;
+        s.inputFrames = stream->inputFrames.load(std::memory_order_relaxed);
+        s.outputFrames = stream->outputFrames.load(std::memory_order_relaxed);
+        s.insertedFrames = stream->insertedFrames.load(std::memory_order_relaxed);
+        s.trimmedFrames = stream->trimmedFrames.load(std::memory_order_relaxed);
+        s.discontinuities = stream->discontinuities.load(std::memory_order_relaxed);
+        s.resyncs = stream->resyncs.load(std::memory_order_relaxed);
+        s.startSkewNanos = stream->startSkewNanos.load(std::memory_order_relaxed);
+        s.clockErrorNanos = stream->clockErrorNanos.load(std::memory_order_relaxed);
+        const uint64_t count = stream->latencyCount.load(std::memory_order_relaxed);
+        s.averageLatencyNanos = count > 0
+            ? static_cast<double>(stream->latencySum.load(std::memory_order_relaxed)) / static_cast<double>(count)
+            : 0.0;
+        s.maxLatencyNanos = stream->maxLatency.load(std::memory_order_relaxed);
+        stats.streams.push_back(s);
+    }
+    return stats;
+}
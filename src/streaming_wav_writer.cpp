@@ -0,0 +1,740 @@
+#include "streaming_wav_writer.h"
+#include "logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t kAlignment = 4096;
+constexpr uint64_t kMaxChunkSize = 0xFFFFFFFFull;
+
+void PutTag(uint8_t* p, const char* tag) {
+    memcpy(p, tag, 4);
+}
+
+void PutLE16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+void PutLE32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+        p[i] = static_cast<uint8_t>(v >> (8 * i));
+    }
+}
+
+void PutLE64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; ++i) {
+        p[i] = static_cast<uint8_t>(v >> (8 * i));
+    }
+}
+
+bool PWriteAll(int fd, const uint8_t* data, size_t size, uint64_t offset) {
+    while (size > 0) {
+        ssize_t n = pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+// RIFF 块的长度为奇数时后面补一个填充字节
+uint64_t PaddedSize(uint64_t dataBytes) {
+    return dataBytes + (dataBytes & 1);
+}
+
+} // namespace
+
+StreamingWavWriter::Options::Options() = default;
+
+StreamingWavWriter::Options StreamingWavWriter::Options::FromEnvironment() {
+    Options options;
+    if (const char* codecName = getenv("RECORDER_CODEC")) {
+        if (!AudioEncoder::ParseCodec(codecName, &options.codec)) {
+            Logger::warn("未知的编码 %s，使用 WAV", codecName);
+        }
+    }
+    if (const char* segment = getenv("RECORDER_SEGMENT_SECONDS")) {
+        options.segmentSeconds = static_cast<uint32_t>(std::max(0, atoi(segment)));
+    }
+    if (const char* elide = getenv("RECORDER_ELIDE_SILENCE")) {
+        options.elideSilence = atoi(elide) != 0;
+    }
+    return options;
+}
+
+StreamingWavWriter::StreamingWavWriter()
+    : fd_(-1)
+    , stopRequested_(false)
+    , open_(false)
+    , activeWriters_(0)
+    , input_(nullptr)
+    , editListGaps_(SIZE_MAX)
+    , staging_(nullptr)
+    , stagingCapacity_(0)
+    , stagingUsed_(0)
+    , dataBytes_(0)
+    , allocatedEnd_(0)
+    , writeFailed_(false)
+    , framesWritten_(0)
+    , droppedFrames_(0) {
+}
+
+StreamingWavWriter::~StreamingWavWriter() {
+    Close();
+    free(staging_);
+}
+
+void StreamingWavWriter::BuildHeader(uint8_t* header, uint32_t sampleRate, uint16_t channels, bool isFloat,
+                                     uint64_t totalBytes) {
+    const size_t bytesPerSample = isFloat ? 4 : 2;
+    const uint16_t bitsPerSample = static_cast<uint16_t>(bytesPerSample * 8);
+    const uint16_t blockAlign = static_cast<uint16_t>(channels * bytesPerSample);
+
+    // 只记录完整的帧
+    const uint64_t dataBytes = totalBytes - totalBytes % blockAlign;
+    const uint64_t frames = dataBytes / blockAlign;
+    const uint64_t riffSize = kHeaderSize - 8 + PaddedSize(dataBytes);
+    const bool rf64 = riffSize > kMaxChunkSize;
+
+    memset(header, 0, kHeaderSize);
+
+    PutTag(header, rf64 ? "RF64" : "RIFF");
+    PutLE32(header + 4, rf64 ? 0xFFFFFFFFu : static_cast<uint32_t>(riffSize));
+    PutTag(header + 8, "WAVE");
+
+    // 预留给 ds64 的 28 字节，普通 WAV 中是 JUNK 块
+    PutTag(header + 12, rf64 ? "ds64" : "JUNK");
+    PutLE32(header + 16, 28);
+    if (rf64) {
+        PutLE64(header + 20, riffSize);
+        PutLE64(header + 28, dataBytes);
+        PutLE64(header + 36, frames);
+        PutLE32(header + 44, 0);
+    }
+
+    size_t pos = 48;
+    const uint32_t fmtSize = isFloat ? 18 : 16;
+    PutTag(header + pos, "fmt ");
+    PutLE32(header + pos + 4, fmtSize);
+    PutLE16(header + pos + 8, isFloat ? 3 : 1);
+    PutLE16(header + pos + 10, channels);
+    PutLE32(header + pos + 12, sampleRate);
+    PutLE32(header + pos + 16, sampleRate * blockAlign);
+    PutLE16(header + pos + 20, blockAlign);
+    PutLE16(header + pos + 22, bitsPerSample);
+    if (isFloat) {
+        PutLE16(header + pos + 24, 0);
+    }
+    pos += 8 + fmtSize;
+
+    if (isFloat) {
+        PutTag(header + pos, "fact");
+        PutLE32(header + pos + 4, 4);
+        PutLE32(header + pos + 8, static_cast<uint32_t>(std::min(frames, kMaxChunkSize)));
+        pos += 12;
+    }
+
+    // 用 JUNK 块把 data 块的数据部分对齐到 kHeaderSize
+    const size_t dataChunk = kHeaderSize - 8;
+    PutTag(header + pos, "JUNK");
+    PutLE32(header + pos + 4, static_cast<uint32_t>(dataChunk - pos - 8));
+
+    PutTag(header + dataChunk, "data");
+    PutLE32(header + dataChunk + 4, rf64 ? 0xFFFFFFFFu : static_cast<uint32_t>(dataBytes));
+}
+
+size_t StreamingWavWriter::BytesPerSample() const {
+    return options_.format == SampleFormat::Float32 ? 4 : 2;
+}
+
+bool StreamingWavWriter::Open(const std::string& path, const Options& options) {
+    if (IsOpen()) {
+        Logger::warn("WAV 写入器已经打开: %s", path_.c_str());
+        return false;
+    }
+    if (options.channels == 0 || options.sampleRate == 0) {
+        Logger::error("无效的 WAV 格式: 采样率 %u, 声道数 %u", options.sampleRate, options.channels);
+        return false;
+    }
+
+    options_ = options;
+    path_ = path;
+    if (options_.segmentSeconds > 0 && options_.codec != AudioEncoder::Codec::Pcm) {
+        Logger::warn("分段模式只支持 PCM，改为直接写入: %s", path.c_str());
+        options_.segmentSeconds = 0;
+    }
+
+    // 分段模式下 path 在 Close() 时才创建
+    if (options_.segmentSeconds == 0) {
+        fd_ = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            Logger::error("创建音频文件失败: %s (%s)", path.c_str(), strerror(errno));
+            return false;
+        }
+    }
+
+    // 队列容量按时长换算，写线程每次最多取出 pollMilliseconds 的几倍
+    size_t queueSamples = static_cast<size_t>(options_.sampleRate) * options_.channels *
+                          options_.queueMilliseconds / 1000;
+    queue_ = std::make_unique<RingBuffer>(queueSamples);
+    drainBuffer_.assign(8192 * static_cast<size_t>(options_.channels), 0.0f);
+    input_ = queue_.get();
+
+    elider_.reset();
+    elided_.reset();
+    editListGaps_ = SIZE_MAX;
+    if (options_.elideSilence) {
+        elider_ = std::make_unique<SilenceElider>();
+        if (elider_->Initialize(options_.sampleRate, options_.channels, options_.silence)) {
+            // 容纳一次取出的输入加上静音段结束时一起放出的缓存
+            const size_t drainFrames = drainBuffer_.size() / options_.channels;
+            elided_ = std::make_unique<RingBuffer>(2 * elider_->MaxOutputFrames(drainFrames) * options_.channels);
+            input_ = elided_.get();
+        } else {
+            Logger::warn("静音省略初始化失败，按原样写入: %s", path.c_str());
+            elider_.reset();
+        }
+    }
+
+    size_t batch = (std::max(options_.batchBytes, kAlignment) + kAlignment - 1) & ~(kAlignment - 1);
+    free(staging_);
+    staging_ = nullptr;
+    stagingCapacity_ = batch + kAlignment;
+    if (posix_memalign(reinterpret_cast<void**>(&staging_), kAlignment, stagingCapacity_) != 0) {
+        staging_ = nullptr;
+        Logger::error("分配写盘缓冲区失败");
+        if (fd_ >= 0) {
+            close(fd_);
+            fd_ = -1;
+        }
+        return false;
+    }
+
+    stagingUsed_ = 0;
+    dataBytes_ = 0;
+    allocatedEnd_ = 0;
+    writeFailed_ = false;
+    dither_ = AudioKernels::DitherState();
+    framesWritten_.store(0, std::memory_order_relaxed);
+    droppedFrames_.store(0, std::memory_order_relaxed);
+
+    encoder_.reset();
+    chunks_.reset();
+    if (options_.segmentSeconds > 0) {
+        if (!OpenSegments()) {
+            return false;
+        }
+    } else if (options_.codec != AudioEncoder::Codec::Pcm) {
+        AudioEncoder::Options encoderOptions;
+        encoderOptions.sampleRate = options_.sampleRate;
+        encoderOptions.channels = options_.channels;
+        encoderOptions.bitsPerSample = options_.flacBitsPerSample;
+        encoderOptions.dither = options_.dither;
+        encoderOptions.threads = options_.encoderThreads;
+        encoder_ = AudioEncoder::Create(options_.codec, encoderOptions);
+        if (!encoder_ || !encoder_->Begin(fd_)) {
+            Logger::error("初始化编码器失败: %s", path.c_str());
+            encoder_.reset();
+            close(fd_);
+            fd_ = -1;
+            return false;
+        }
+    } else {
+        if (!WriteHeader()) {
+            Logger::error("写入 WAV 头失败: %s", path.c_str());
+            close(fd_);
+            fd_ = -1;
+            return false;
+        }
+        Preallocate(kHeaderSize + options_.preallocateBytes);
+    }
+
+    stopRequested_ = false;
+    open_.store(true, std::memory_order_release);
+    thread_ = std::thread(&StreamingWavWriter::WriterLoop, this);
+
+    Logger::info("开始流式写入: %s (采样率 %u, 声道数 %u)", path.c_str(),
+                 options_.sampleRate, options_.channels);
+    return true;
+}
+
+bool StreamingWavWriter::Write(const float* interleaved, size_t frames) {
+    // 先登记再检查 open_，Close() 置位 open_ 后等登记数归零，保证不会有 Write() 还在用旧的队列
+    activeWriters_.fetch_add(1);
+    bool ok = false;
+    if (open_.load()) {
+        ok = queue_->write(interleaved, frames * options_.channels);
+        if (!ok) {
+            droppedFrames_.fetch_add(frames, std::memory_order_relaxed);
+        }
+    }
+    activeWriters_.fetch_sub(1, std::memory_order_release);
+    return ok;
+}
+
+size_t StreamingWavWriter::QueuedFrames() const {
+    activeWriters_.fetch_add(1);
+    const size_t frames = open_.load() ? queue_->available_read() / options_.channels : 0;
+    activeWriters_.fetch_sub(1, std::memory_order_release);
+    return frames;
+}
+
+size_t StreamingWavWriter::QueueCapacityFrames() const {
+    activeWriters_.fetch_add(1);
+    const size_t frames = open_.load() ? queue_->capacity() / options_.channels : 0;
+    activeWriters_.fetch_sub(1, std::memory_order_release);
+    return frames;
+}
+
+bool StreamingWavWriter::GetSilenceStats(SilenceElider::Stats* stats) const {
+    if (!elider_ || IsOpen()) {
+        return false;
+    }
+    *stats = elider_->GetStats();
+    return true;
+}
+
+void StreamingWavWriter::Close() {
+    if (!open_.exchange(false)) {
+        return;
+    }
+    // 等已经进入 Write() 的调用返回，之后 Open() 才能安全地替换队列和格式
+    while (activeWriters_.load(std::memory_order_acquire) > 0) {
+        std::this_thread::yield();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopRequested_ = true;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    if (chunks_) {
+        // 块已在写线程上封存，这里只做内核内拼接
+        const std::string directory = chunks_->Directory();
+        chunks_.reset();
+        if (!writeFailed_ && !FinalizeSegments(directory, path_, false)) {
+            Logger::error("合并分段失败，块文件保留在: %s", directory.c_str());
+        }
+    } else {
+        // 释放多余的预分配空间，编码器按实际长度顺序写入，不需要截断
+        if (!encoder_ && ftruncate(fd_, static_cast<off_t>(kHeaderSize + PaddedSize(dataBytes_))) != 0) {
+            Logger::warn("截断音频文件失败: %s", strerror(errno));
+        }
+        close(fd_);
+        fd_ = -1;
+    }
+
+    uint64_t dropped = droppedFrames_.load(std::memory_order_relaxed);
+    if (dropped > 0) {
+        Logger::warn("写入队列溢出，共丢弃 %llu 帧", static_cast<unsigned long long>(dropped));
+    }
+    Logger::info("音频已保存到: %s (%llu 帧)", path_.c_str(),
+                 static_cast<unsigned long long>(FramesWritten()));
+    // 每帧实际占用的字节数，编码时取平均码率，用于折算静音省略节省的空间
+    double bytesPerFrame = static_cast<double>(BytesPerSample() * options_.channels);
+    if (encoder_ && FramesWritten() > 0) {
+        bytesPerFrame = static_cast<double>(encoder_->BytesWritten()) / FramesWritten();
+    }
+    if (encoder_) {
+        const double rawBytes = static_cast<double>(FramesWritten()) * options_.channels * sizeof(float);
+        Logger::info("编码后 %llu 字节，为 float WAV 的 %.1f%%",
+                     static_cast<unsigned long long>(encoder_->BytesWritten()),
+                     rawBytes > 0.0 ? encoder_->BytesWritten() * 100.0 / rawBytes : 0.0);
+        encoder_.reset();
+    }
+    if (elider_) {
+        const SilenceElider::Stats stats = elider_->GetStats();
+        const double seconds = static_cast<double>(stats.originalFrames) / options_.sampleRate;
+        const uint64_t elided = stats.originalFrames - stats.storedFrames;
+        Logger::info("静音省略: 原始 %.1f 秒, 保留 %.1f 秒, 省去 %zu 段共 %.1f 秒 (%.1f%%, 约 %.0f 字节), "
+                     "CPU 每音频小时 %.2f 秒",
+                     seconds, static_cast<double>(stats.storedFrames) / options_.sampleRate, stats.gaps,
+                     static_cast<double>(elided) / options_.sampleRate,
+                     stats.originalFrames > 0 ? elided * 100.0 / stats.originalFrames : 0.0,
+                     elided * bytesPerFrame,
+                     seconds > 0.0 ? stats.cpuNanoseconds / 1e9 * 3600.0 / seconds : 0.0);
+    }
+}
+
+void StreamingWavWriter::WriterLoop() {
+    using Clock = std::chrono::steady_clock;
+    const auto poll = std::chrono::milliseconds(options_.pollMilliseconds);
+    const auto refresh = std::chrono::milliseconds(options_.headerRefreshMilliseconds);
+    auto lastHeader = Clock::now();
+
+    for (;;) {
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait_for(lock, poll, [this] { return stopRequested_; });
+            stopping = stopRequested_;
+        }
+
+        Drain(SIZE_MAX);
+
+        if (stopping) {
+            if (elider_) {
+                FinishElider();
+            }
+            if (encoder_) {
+                FinishEncoder();
+            } else if (chunks_) {
+                CheckChunks(chunks_->Close());
+            } else {
+                FlushStaging(true);
+                WriteHeader();
+            }
+            break;
+        }
+
+        // 分段模式的块头随每次提交更新，不需要定期刷新
+        auto now = Clock::now();
+        if (!chunks_ && now - lastHeader >= refresh) {
+            if (encoder_) {
+                CheckEncoder(encoder_->Flush());
+            } else {
+                FlushStaging(false);
+                WriteHeader();
+            }
+            if (elider_) {
+                UpdateEditList(false);
+            }
+            lastHeader = now;
+        }
+    }
+}
+
+size_t StreamingWavWriter::Drain(size_t maxFrames) {
+    if (!elider_) {
+        return DrainInput(maxFrames);
+    }
+    // 队列中的数据先经 VAD 筛进 elided_，再按原路径写出，直到队列取空
+    size_t total = 0;
+    for (;;) {
+        const size_t consumed = PumpElider();
+        total += DrainInput(maxFrames - std::min(maxFrames, total));
+        if (consumed == 0 || total >= maxFrames) {
+            break;
+        }
+    }
+    return total;
+}
+
+size_t StreamingWavWriter::PumpElider() {
+    const size_t channels = options_.channels;
+    const size_t chunkFrames = drainBuffer_.size() / channels;
+    size_t total = 0;
+    for (;;) {
+        const size_t available = queue_->available_read() / channels;
+        if (available == 0 || elided_->available_write() / channels < elider_->MaxOutputFrames(chunkFrames)) {
+            break;
+        }
+        const size_t frames = std::min(available, chunkFrames);
+        if (!queue_->read(drainBuffer_.data(), frames * channels)) {
+            break;
+        }
+        elider_->Process(drainBuffer_.data(), frames, elided_.get());
+        total += frames;
+    }
+    return total;
+}
+
+void StreamingWavWriter::FinishElider() {
+    // Drain() 返回时 elided_ 已经取空，足以放下剩余的缓存
+    elider_->Finish(elided_.get());
+    DrainInput(SIZE_MAX);
+    UpdateEditList(true);
+}
+
+void StreamingWavWriter::UpdateEditList(bool final) {
+    // 段数变化时才重写，崩溃后编辑表最多落后一个刷新周期
+    const size_t gaps = elider_->Gaps().size();
+    if (!final && gaps == editListGaps_) {
+        return;
+    }
+    if (elider_->WriteEditList(SilenceElider::EditListPath(path_))) {
+        editListGaps_ = gaps;
+    }
+}
+
+size_t StreamingWavWriter::DrainInput(size_t maxFrames) {
+    if (encoder_) {
+        return DrainToEncoder(maxFrames);
+    }
+    if (chunks_) {
+        return DrainToChunks(maxFrames);
+    }
+    const size_t channels = options_.channels;
+    const size_t bytesPerFrame = BytesPerSample() * channels;
+    const size_t batchBytes = stagingCapacity_ - kAlignment;
+    size_t total = 0;
+
+    while (total < maxFrames) {
+        size_t available = input_->available_read() / channels;
+        if (available == 0) {
+            break;
+        }
+
+        size_t space = (stagingCapacity_ - stagingUsed_) / bytesPerFrame;
+        if (space == 0) {
+            FlushStaging(false);
+            continue;
+        }
+
+        size_t frames = std::min({available, space, drainBuffer_.size() / channels, maxFrames - total});
+        if (!input_->read(drainBuffer_.data(), frames * channels)) {
+            break;
+        }
+
+        uint8_t* out = staging_ + stagingUsed_;
+        const size_t samples = frames * channels;
+        if (options_.format == SampleFormat::Float32) {
+            memcpy(out, drainBuffer_.data(), samples * sizeof(float));
+        } else {
+            AudioKernels::FloatToInt16(drainBuffer_.data(), reinterpret_cast<int16_t*>(out), samples,
+                                       options_.dither ? &dither_ : nullptr);
+        }
+        stagingUsed_ += frames * bytesPerFrame;
+        total += frames;
+
+        if (stagingUsed_ >= batchBytes) {
+            FlushStaging(false);
+        }
+    }
+    return total;
+}
+
+size_t StreamingWavWriter::DrainToEncoder(size_t maxFrames) {
+    const size_t channels = options_.channels;
+    size_t total = 0;
+    while (total < maxFrames) {
+        const size_t available = input_->available_read() / channels;
+        if (available == 0) {
+            break;
+        }
+        const size_t frames = std::min({available, drainBuffer_.size() / channels, maxFrames - total});
+        if (!input_->read(drainBuffer_.data(), frames * channels)) {
+            break;
+        }
+        // 写盘失败后继续排空队列，丢弃数据，不影响采集
+        if (!writeFailed_) {
+            CheckEncoder(encoder_->Encode(drainBuffer_.data(), frames));
+        }
+        total += frames;
+    }
+    framesWritten_.store(encoder_->FramesEncoded(), std::memory_order_relaxed);
+    return total;
+}
+
+void StreamingWavWriter::FinishEncoder() {
+    if (!writeFailed_) {
+        CheckEncoder(encoder_->Finish());
+    }
+    framesWritten_.store(encoder_->FramesEncoded(), std::memory_order_relaxed);
+}
+
+void StreamingWavWriter::CheckEncoder(bool ok) {
+    if (!ok && !writeFailed_) {
+        writeFailed_ = true;
+        Logger::error("写入编码数据失败: %s (%s)", path_.c_str(), strerror(errno));
+    }
+}
+
+size_t StreamingWavWriter::DrainToChunks(size_t maxFrames) {
+    const size_t channels = options_.channels;
+    const bool isFloat = options_.format == SampleFormat::Float32;
+    size_t total = 0;
+    while (total < maxFrames) {
+        const size_t available = input_->available_read() / channels;
+        if (available == 0) {
+            break;
+        }
+        size_t frames = std::min(available, maxFrames - total);
+        uint8_t* out = writeFailed_ ? nullptr : chunks_->WritePointer();
+        if (out) {
+            frames = std::min(frames, chunks_->WritableFrames());
+        }
+        // float 直接从队列读进映射内存；int16 先经中转缓冲转换；写盘失败后只排空队列
+        if (!out || !isFloat) {
+            frames = std::min(frames, drainBuffer_.size() / channels);
+        }
+        const size_t samples = frames * channels;
+        if (out && isFloat) {
+            if (!input_->read(reinterpret_cast<float*>(out), samples)) {
+                break;
+            }
+        } else {
+            if (!input_->read(drainBuffer_.data(), samples)) {
+                break;
+            }
+            if (out) {
+                AudioKernels::FloatToInt16(drainBuffer_.data(), reinterpret_cast<int16_t*>(out), samples,
+                                           options_.dither ? &dither_ : nullptr);
+            }
+        }
+        if (out) {
+            CheckChunks(chunks_->Commit(frames));
+        }
+        total += frames;
+    }
+    framesWritten_.store(chunks_->Frames(), std::memory_order_relaxed);
+    return total;
+}
+
+void StreamingWavWriter::CheckChunks(bool ok) {
+    if (!ok && !writeFailed_) {
+        writeFailed_ = true;
+        Logger::error("写入块文件失败: %s", chunks_->Directory().c_str());
+    }
+}
+
+bool StreamingWavWriter::OpenSegments() {
+    const std::string directory = SegmentDirectory(path_);
+    // 上次录音崩溃留下的块先恢复，避免和本次数据混在一起
+    if (access((directory + "/index").c_str(), F_OK) == 0) {
+        const size_t slash = path_.find_last_of('/');
+        const size_t dot = path_.find_last_of('.');
+        const size_t stemEnd = (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+                                   ? path_.size() : dot;
+        const std::string recovered = path_.substr(0, stemEnd) + "_recovered" + path_.substr(stemEnd);
+        Logger::warn("发现未合并的分段录音，恢复到: %s", recovered.c_str());
+        if (!RecoverSegments(directory, recovered)) {
+            Logger::error("恢复分段录音失败，请手动处理: %s", directory.c_str());
+            return false;
+        }
+    }
+
+    ChunkStore::Format format;
+    format.sampleRate = options_.sampleRate;
+    format.channels = options_.channels;
+    format.bytesPerSample = static_cast<uint16_t>(BytesPerSample());
+    format.chunkFrames = options_.sampleRate * options_.segmentSeconds;
+    chunks_ = std::make_unique<ChunkStore>();
+    if (!chunks_->Create(directory, format)) {
+        Logger::error("创建分段目录失败: %s", directory.c_str());
+        chunks_.reset();
+        return false;
+    }
+    return true;
+}
+
+std::string StreamingWavWriter::SegmentDirectory(const std::string& path) {
+    return path + ".chunks";
+}
+
+bool StreamingWavWriter::RecoverSegments(const std::string& directory, const std::string& path) {
+    return FinalizeSegments(directory, path, true);
+}
+
+bool StreamingWavWriter::FinalizeSegments(const std::string& directory, const std::string& path, bool verify) {
+    ChunkStore::Listing listing;
+    if (!ChunkStore::Load(directory, verify, &listing)) {
+        return false;
+    }
+    const ChunkStore::Format& format = listing.format;
+    const int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        Logger::error("创建音频文件失败: %s (%s)", path.c_str(), strerror(errno));
+        return false;
+    }
+    const uint64_t dataBytes = listing.frames * format.channels * format.bytesPerSample;
+    uint8_t header[kHeaderSize];
+    BuildHeader(header, format.sampleRate, format.channels, format.bytesPerSample == 4, dataBytes);
+    bool ok = ChunkStore::Export(listing, fd, kHeaderSize) && PWriteAll(fd, header, sizeof(header), 0) &&
+              ftruncate(fd, static_cast<off_t>(kHeaderSize + PaddedSize(dataBytes))) == 0 && fsync(fd) == 0;
+    if (!ok) {
+        Logger::error("写入音频文件失败: %s (%s)", path.c_str(), strerror(errno));
+    }
+    close(fd);
+    if (!ok) {
+        return false;
+    }
+    if (listing.corruptChunks > 0) {
+        Logger::warn("%zu 个块校验失败，数据已按原样保留: %s", listing.corruptChunks, path.c_str());
+    }
+    Logger::info("已合并 %zu 个块 (%llu 帧) 到: %s", listing.chunks.size(),
+                 static_cast<unsigned long long>(listing.frames), path.c_str());
+    ChunkStore::Remove(directory);
+    return true;
+}
+
+bool StreamingWavWriter::FlushStaging(bool all) {
+    // 平时只写 4KB 整数倍，剩余部分留到下一批，保证写盘偏移始终对齐
+    size_t bytes = all ? stagingUsed_ : (stagingUsed_ & ~(kAlignment - 1));
+    if (bytes == 0) {
+        return true;
+    }
+
+    const uint64_t offset = kHeaderSize + dataBytes_;
+    Preallocate(offset + bytes);
+
+    if (!writeFailed_) {
+        if (PWriteAll(fd_, staging_, bytes, offset)) {
+            dataBytes_ += bytes;
+            framesWritten_.store(dataBytes_ / (BytesPerSample() * options_.channels),
+                                 std::memory_order_relaxed);
+        } else {
+            // 磁盘写满等错误只记录一次，后续数据直接丢弃，不影响采集
+            writeFailed_ = true;
+            Logger::error("写入音频数据失败: %s (%s)", path_.c_str(), strerror(errno));
+        }
+    }
+
+    stagingUsed_ -= bytes;
+    if (stagingUsed_ > 0) {
+        memmove(staging_, staging_ + bytes, stagingUsed_);
+    }
+    return !writeFailed_;
+}
+
+bool StreamingWavWriter::WriteHeader() {
+    uint8_t header[kHeaderSize];
+    BuildHeader(header, options_.sampleRate, options_.channels, options_.format == SampleFormat::Float32, dataBytes_);
+    return PWriteAll(fd_, header, sizeof(header), 0);
+}
+
+void StreamingWavWriter::Preallocate(uint64_t end) {
+    if (end <= allocatedEnd_ || options_.preallocateBytes == 0) {
+        return;
+    }
+    const uint64_t newEnd = std::max(end, allocatedEnd_ + options_.preallocateBytes);
+    const off_t offset = static_cast<off_t>(allocatedEnd_);
+    const off_t length = static_cast<off_t>(newEnd - allocatedEnd_);
+
+    // 预分配失败不影响写入，只是失去连续空间的好处
+#if defined(__linux__)
+    if (fallocate(fd_, FALLOC_FL_KEEP_SIZE, offset, length) != 0) {
+        Logger::debug("预分配文件空间失败: %s", strerror(errno));
+    }
+#elif defined(__APPLE__)
+    fstore_t store = {F_ALLOCATECONTIG, F_PEOFPOSMODE, 0, length, 0};
+    if (fcntl(fd_, F_PREALLOCATE, &store) == -1) {
+        store.fst_flags = F_ALLOCATEALL;
+        if (fcntl(fd_, F_PREALLOCATE, &store) == -1) {
+            Logger::debug("预分配文件空间失败: %s", strerror(errno));
+        }
+    }
+    (void)offset;
+#else
+    (void)offset;
+    (void)length;
+#endif
+    allocatedEnd_ = newEnd;
+}
@@ -1,6 +1,7 @@
 #include "logger.h"
 #include "audio_device_manager.h"
 #include "audio_system_capture.h"
+#include "streaming_wav_writer.h"
 #import <CoreAudio/CoreAudio.h>
 #import <CoreAudio/CoreAudioTypes.h>
 #import <CoreAudio/AudioHardware.h>
@@ -19,22 +20,13 @@
 #include <unistd.h>
 
 // 静态变量
-static ExtAudioFileRef audioFile = nullptr;
-static AudioStreamBasicDescription outputFormat;
+static StreamingWavWriter audioWriter;
 static AudioStreamBasicDescription inputFormat;
 static std::string outputFilePath;
 
-// 静态函数
-static void AudioDataCallback(const AudioBufferList* inInputData, UInt32 inNumberFrames) {
-    if (!audioFile) {
-        return;
-    }
-    
-    // 写入音频数据
-    OSStatus status = ExtAudioFileWrite(audioFile, inNumberFrames, inInputData);
-    if (status != noErr) {
-        Logger::error("写入音频数据失败: %d", (int)status);
-    }
+// 静态函数，运行在 IO 线程上，只把数据交给后台写线程
+static void AudioDataCallback(const AudioBufferList* inInputData, UInt32 inNumberFrames, const CaptureTimestamp&) {
+    audioWriter.Write(static_cast<const float*>(inInputData->mBuffers[0].mData), inNumberFrames);
 }
 
 void TestSystemCaptureRecorder() {
@@ -60,18 +52,14 @@ void TestSystemCaptureRecorder() {
         Logger::info("AudioSystemCapture 初始化完成");
 
         // 设置输出格式
-        memset(&outputFormat, 0, sizeof(outputFormat));
-        outputFormat.mSampleRate = 44100;
-        outputFormat.mFormatID = kAudioFormatLinearPCM;
-        outputFormat.mFormatFlags = kAudioFormatFlagIsFloat | kAudioFormatFlagIsPacked;
-        outputFormat.mBitsPerChannel = 32;
-        outputFormat.mChannelsPerFrame = 2;
-        outputFormat.mFramesPerPacket = 1;
-        outputFormat.mBytesPerFrame = outputFormat.mChannelsPerFrame * outputFormat.mBitsPerChannel / 8;
-        outputFormat.mBytesPerPacket = outputFormat.mBytesPerFrame;
+        // 编码、分段和静音省略取自环境变量
+        StreamingWavWriter::Options writerOptions = StreamingWavWriter::Options::FromEnvironment();
+        writerOptions.sampleRate = 44100;
+        writerOptions.channels = 2;
+        writerOptions.format = StreamingWavWriter::SampleFormat::Float32;
 
         // 使用固定文件名
-        const char* filename = "system_audio.wav";
+        const std::string filename = std::string("system_audio") + AudioEncoder::Extension(writerOptions.codec);
         
         // 获取当前工作目录
         char cwd[PATH_MAX];
@@ -85,24 +73,9 @@ void TestSystemCaptureRecorder() {
             Logger::info("音频文件将保存到: %s", outputFilePath.c_str());
         }
         
-        // 创建音频文件
-        CFStringRef filenameCF = CFStringCreateWithCString(kCFAllocatorDefault, outputFilePath.c_str(), kCFStringEncodingUTF8);
-        CFURLRef fileURL = CFURLCreateWithFileSystemPath(kCFAllocatorDefault,
-                                                        filenameCF,
-                                                        kCFURLPOSIXPathStyle,
-                                                        false);
-        CFRelease(filenameCF);
-        
-        OSStatus status = ExtAudioFileCreateWithURL(fileURL,
-                                                  kAudioFileWAVEType,
-                                                  &outputFormat,
-                                                  nullptr,
-                                                  kAudioFileFlags_EraseFile,
-                                                  &audioFile);
-        CFRelease(fileURL);
-        
-        if (status != noErr) {
-            Logger::error("创建音频文件失败: %d", (int)status);
+        // 创建音频文件并启动后台写线程
+        if (!audioWriter.Open(outputFilePath, writerOptions)) {
+            Logger::error("创建音频文件失败");
             return;
         }
         
@@ -132,8 +105,7 @@ void TestSystemCaptureRecorder() {
         AudioObjectID deviceID = manager.CreateAggregateDevice("plaud.ai Aggregate Audio Device");
         if (deviceID == kAudioObjectUnknown) {
             Logger::error("创建聚合设备失败");
-            ExtAudioFileDispose(audioFile);
-            audioFile = nullptr;
+            audioWriter.Close();
             return;
         }
         Logger::info("成功创建聚合设备，ID: %u", (unsigned int)deviceID);
@@ -142,8 +114,7 @@ void TestSystemCaptureRecorder() {
         AudioObjectID tapID = manager.CreateTap("plaud.ai tap");
         if (tapID == kAudioObjectUnknown) {
             Logger::error("创建 tap 失败");
-            ExtAudioFileDispose(audioFile);
-            audioFile = nullptr;
+            audioWriter.Close();
             return;
         }
         Logger::info("成功创建 tap，ID: %u", (unsigned int)tapID);
@@ -151,8 +122,7 @@ void TestSystemCaptureRecorder() {
         // 添加 tap 到设备
         if (!manager.AddTapToDevice(tapID, deviceID)) {
             Logger::error("添加 tap 到设备失败");
-            ExtAudioFileDispose(audioFile);
-            audioFile = nullptr;
+            audioWriter.Close();
             return;
         }
         Logger::info("成功将 tap 添加到设备");
@@ -161,8 +131,7 @@ void TestSystemCaptureRecorder() {
         capture.SetDeviceID(deviceID);
         if (!capture.StartRecording()) {
             Logger::error("开始录制失败");
-            ExtAudioFileDispose(audioFile);
-            audioFile = nullptr;
+            audioWriter.Close();
             return;
         }
         Logger::info("开始录制成功");
@@ -174,9 +143,8 @@ void TestSystemCaptureRecorder() {
         capture.StopRecording();
         Logger::info("停止录制");
 
-        // 关闭音频文件
-        ExtAudioFileDispose(audioFile);
-        audioFile = nullptr;
+        // 排空写入队列并关闭音频文件
+        audioWriter.Close();
         printf("音频文件已保存到: %s\n", outputFilePath.c_str());
         Logger::info("音频文件已保存到: %s", outputFilePath.c_str());
 
@@ -0,0 +1,82 @@
+#include "system_tap_backend.h"
+#include "audio_system_capture.h"
+#include "capture_trace.h"
+#include "level_meter.h"
+#include "logger.h"
+
+SystemTapBackend::SystemTapBackend()
+    : capture_(std::make_unique<AudioSystemCapture>())
+    , sampleRate_(0)
+    , channels_(0)
+    , running_(false) {
+}
+
+SystemTapBackend::~SystemTapBackend() {
+    Stop();
+}
+
+bool SystemTapBackend::Open() {
+    if (!capture_->CreateTapDevice()) {
+        Logger::error("创建系统音频 tap 失败");
+        return false;
+    }
+    AudioStreamBasicDescription format;
+    if (!capture_->GetAudioFormat(format) || format.mChannelsPerFrame == 0) {
+        Logger::error("获取系统音频格式失败");
+        return false;
+    }
+    sampleRate_ = static_cast<int>(format.mSampleRate);
+    channels_ = format.mChannelsPerFrame;
+    return true;
+}
+
+bool SystemTapBackend::Start() {
+    if (running_.load(std::memory_order_acquire)) {
+        return true;
+    }
+    // IOProc 上的回调：单 buffer 交织 float32，直接交给引擎写入广播缓冲
+    capture_->SetAudioDataCallback([this](const AudioBufferList* data, UInt32 frames, const CaptureTimestamp& timestamp) {
+        if (data->mNumberBuffers == 0 || !data->mBuffers[0].mData) {
+            return;
+        }
+        const float* interleaved = static_cast<const float*>(data->mBuffers[0].mData);
+        // 数据原样交出，没有转换步骤可以合并，单独统计一遍（只读，刚由 HAL 写入仍在缓存中）
+        if (levelMeter_) {
+            AudioKernels::LevelStats levels;
+            AudioKernels::MeasureLevels(interleaved, frames * channels_, &levels);
+            levelMeter_->Publish(levels);
+        }
+        if (trace_) {
+            trace_->Record(traceStream_, interleaved, frames, timestamp);
+        }
+        if (callback_) {
+            callback_(interleaved, frames, timestamp);
+        }
+    });
+    if (!capture_->StartRecording()) {
+        Logger::error("启动系统音频采集失败");
+        return false;
+    }
+    running_.store(true, std::memory_order_release);
+    return true;
+}
+
+void SystemTapBackend::Stop() {
+    if (running_.exchange(false, std::memory_order_acq_rel)) {
+        capture_->StopRecording();
+    }
+}
+
+bool SystemTapBackend::IsRunning() const {
+    return running_.load(std::memory_order_acquire);
+}
+
+std::shared_ptr<CaptureEngine> SystemTapBackend::SharedEngine() {
+    return CaptureEngine::Shared("system-tap", []() -> std::unique_ptr<CaptureBackend> {
+        auto backend = std::make_unique<SystemTapBackend>();
+        if (!backend->Open()) {
+            return nullptr;
+        }
+        return backend;
+    });
+}
@@ -0,0 +1,186 @@
+#include "wav_file_reader.h"
+#include "audio_kernels.h"
+#include "logger.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint16_t kFormatPcm = 1;
+constexpr uint16_t kFormatFloat = 3;
+constexpr uint16_t kFormatExtensible = 0xFFFE;
+
+uint32_t ReadU32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint16_t ReadU16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint64_t ReadU64(const uint8_t* p) {
+    return ReadU32(p) | (static_cast<uint64_t>(ReadU32(p + 4)) << 32);
+}
+
+} // namespace
+
+WavFileReader::WavFileReader()
+    : mapping_(nullptr)
+    , mappingSize_(0)
+    , releasedBytes_(0)
+    , data_(nullptr)
+    , sampleRate_(0)
+    , channels_(0)
+    , bitsPerSample_(0)
+    , isFloat_(false)
+    , frames_(0) {
+}
+
+WavFileReader::~WavFileReader() {
+    Close();
+}
+
+bool WavFileReader::Open(const std::string& path) {
+    Close();
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        Logger::error("无法打开 WAV 文件: %s", path.c_str());
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < 12) {
+        Logger::error("WAV 文件过小: %s", path.c_str());
+        close(fd);
+        return false;
+    }
+    mappingSize_ = static_cast<size_t>(st.st_size);
+    mapping_ = mmap(nullptr, mappingSize_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping_ == MAP_FAILED) {
+        Logger::error("映射 WAV 文件失败: %s", path.c_str());
+        mapping_ = nullptr;
+        mappingSize_ = 0;
+        return false;
+    }
+    // 按顺序播放，提示内核预读
+    madvise(mapping_, mappingSize_, MADV_SEQUENTIAL);
+
+    if (!ParseHeader(path)) {
+        Close();
+        return false;
+    }
+    Logger::info("已映射 WAV 文件 %s: %d Hz, %zu 声道, %u 位, %llu 帧", path.c_str(), sampleRate_, channels_,
+                 bitsPerSample_, static_cast<unsigned long long>(frames_));
+    return true;
+}
+
+bool WavFileReader::ParseHeader(const std::string& path) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(mapping_);
+    const bool rf64 = memcmp(bytes, "RF64", 4) == 0;
+    if ((!rf64 && memcmp(bytes, "RIFF", 4) != 0) || memcmp(bytes + 8, "WAVE", 4) != 0) {
+        Logger::error("%s 不是 WAV 文件", path.c_str());
+        return false;
+    }
+
+    uint16_t format = 0;
+    uint64_t rf64DataSize = 0;
+    size_t pos = 12;
+    while (pos + 8 <= mappingSize_) {
+        const uint8_t* id = bytes + pos;
+        uint64_t size = ReadU32(id + 4);
+        const uint8_t* body = id + 8;
+        if (memcmp(id, "ds64", 4) == 0 && size >= 16) {
+            rf64DataSize = ReadU64(body + 8);
+        } else if (memcmp(id, "fmt ", 4) == 0 && size >= 16) {
+            format = ReadU16(body);
+            channels_ = ReadU16(body + 2);
+            sampleRate_ = static_cast<int>(ReadU32(body + 4));
+            bitsPerSample_ = ReadU16(body + 14);
+            if (format == kFormatExtensible && size >= 26) {
+                format = ReadU16(body + 24);
+            }
+        } else if (memcmp(id, "data", 4) == 0) {
+            if (rf64 && size == 0xFFFFFFFFu) {
+                size = rf64DataSize;
+            }
+            // 被截断的文件以实际长度为准
+            size = std::min<uint64_t>(size, mappingSize_ - pos - 8);
+            isFloat_ = format == kFormatFloat;
+            const bool supported = (format == kFormatPcm && (bitsPerSample_ == 16 || bitsPerSample_ == 24)) ||
+                                   (isFloat_ && bitsPerSample_ == 32);
+            if (!supported || channels_ == 0 || sampleRate_ <= 0) {
+                Logger::error("%s 的采样格式不受支持 (format=%u, bits=%u, channels=%zu)",
+                              path.c_str(), format, bitsPerSample_, channels_);
+                return false;
+            }
+            data_ = body;
+            frames_ = size / (channels_ * (bitsPerSample_ / 8));
+            return true;
+        }
+        pos += 8 + size + (size & 1);
+    }
+    Logger::error("%s 缺少 data 块", path.c_str());
+    return false;
+}
+
+void WavFileReader::Close() {
+    if (mapping_) {
+        munmap(mapping_, mappingSize_);
+    }
+    mapping_ = nullptr;
+    mappingSize_ = 0;
+    releasedBytes_ = 0;
+    data_ = nullptr;
+    frames_ = 0;
+}
+
+size_t WavFileReader::Read(uint64_t frameOffset, float* interleaved, size_t frames,
+                           AudioKernels::LevelStats* levels) const {
+    if (!data_ || frameOffset >= frames_) {
+        return 0;
+    }
+    frames = static_cast<size_t>(std::min<uint64_t>(frames, frames_ - frameOffset));
+    const size_t samples = frames * channels_;
+    const size_t bytesPerSample = bitsPerSample_ / 8;
+    const uint8_t* src = data_ + frameOffset * channels_ * bytesPerSample;
+    if (isFloat_) {
+        if (levels) {
+            AudioKernels::CopyWithLevels(reinterpret_cast<const float*>(src), interleaved, samples, levels);
+        } else {
+            memcpy(interleaved, src, samples * sizeof(float));
+        }
+    } else if (bitsPerSample_ == 16) {
+        if (levels) {
+            AudioKernels::Int16ToFloatWithLevels(reinterpret_cast<const int16_t*>(src), interleaved, samples, levels);
+        } else {
+            AudioKernels::Int16ToFloat(reinterpret_cast<const int16_t*>(src), interleaved, samples);
+        }
+    } else {
+        // 24 位没有向量化的转换内核，转换后统计刚写出（仍在缓存中）的数据
+        AudioKernels::Int24ToFloat(src, interleaved, samples);
+        if (levels) {
+            AudioKernels::MeasureLevels(interleaved, samples, levels);
+        }
+    }
+    return frames;
+}
+
+void WavFileReader::ReleaseBefore(uint64_t frameOffset) {
+    if (!data_) {
+        return;
+    }
+    frameOffset = std::min(frameOffset, frames_);
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t end = static_cast<size_t>(data_ - static_cast<const uint8_t*>(mapping_)) +
+                       static_cast<size_t>(frameOffset * channels_ * (bitsPerSample_ / 8));
+    const size_t aligned = end / page * page;
+    if (aligned > releasedBytes_) {
+        madvise(static_cast<uint8_t*>(mapping_) + releasedBytes_, aligned - releasedBytes_, MADV_DONTNEED);
+        releasedBytes_ = aligned;
+    }
+}
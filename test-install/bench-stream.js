@@ -0,0 +1,130 @@
+'use strict';
+
+// onAudio 零拷贝 PCM 流的基准：统计每块的复制次数和事件循环唤醒次数
+// 使用无头录音实现（Linux），按 RECORDER_SPEED 倍速回放生成的音频，需先 npm run build
+//
+// 用法: node test-install/bench-stream.js [--duration 秒] [--speed 倍速] [--json 输出文件]
+
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { monitorEventLoopDelay } = require('perf_hooks');
+
+const args = process.argv.slice(2);
+function option(name, fallback) {
+  const index = args.indexOf(`--${name}`);
+  return index >= 0 && index + 1 < args.length ? args[index + 1] : fallback;
+}
+
+const duration = Number(option('duration', '20'));
+const speed = Number(option('speed', '4'));
+const jsonPath = option('json', null);
+
+// 无头录音在构造时读取环境变量，必须在创建 Recorder 之前设置
+process.env.RECORDER_DURATION = String(duration);
+process.env.RECORDER_SPEED = String(speed);
+process.env.RECORDER_AEC = '0';
+
+const { Recorder } = require('..');
+
+const CASES = [
+  { chunkMs: 10, format: 'f32' },
+  { chunkMs: 20, format: 'f32' },
+  { chunkMs: 100, format: 'f32' },
+  { chunkMs: 20, format: 's16' },
+  { chunkMs: 100, format: 's16' }
+];
+
+const sleep = (ms) => new Promise((resolve) => setTimeout(resolve, ms));
+
+async function runCase(config, outputDir) {
+  const recorder = new Recorder();
+  await recorder.setOutputPath(path.join(outputDir, `stream_${config.format}_${config.chunkMs}.wav`));
+
+  let received = 0;
+  let receivedBytes = 0;
+  let ended;
+  const finished = new Promise((resolve) => { ended = resolve; });
+  recorder.onAudio((samples) => {
+    if (samples === null) {
+      ended();
+      return;
+    }
+    received++;
+    receivedBytes += samples.byteLength;
+  }, config);
+
+  const loopDelay = monitorEventLoopDelay({ resolution: 1 });
+  loopDelay.enable();
+  const cpuStart = process.cpuUsage();
+  const wallStart = process.hrtime.bigint();
+
+  if (!(await recorder.start())) {
+    throw new Error('启动录音失败');
+  }
+
+  // 生成的音频播放完后无头录音停在末尾，交付帧数不再增长时停止
+  let lastFrames = -1;
+  for (;;) {
+    await sleep(200);
+    const frames = recorder.getAudioStats().framesDelivered;
+    if (frames > 0 && frames === lastFrames) {
+      break;
+    }
+    lastFrames = frames;
+  }
+  await recorder.stop();
+  await finished;
+
+  const wallSeconds = Number(process.hrtime.bigint() - wallStart) / 1e9;
+  const cpu = process.cpuUsage(cpuStart);
+  loopDelay.disable();
+  const stats = recorder.getAudioStats();
+  recorder.onAudio(null);
+
+  const bytesPerSample = config.format === 'f32' ? 4 : 2;
+  const deliveredBytes = stats.framesDelivered * 2 * bytesPerSample;
+  return {
+    name: `onAudio/${config.format}/${config.chunkMs}ms`,
+    chunks: received,
+    wakeups: stats.wakeups,
+    chunksPerWakeup: stats.wakeups > 0 ? received / stats.wakeups : 0,
+    nativeCopiesPerByte: deliveredBytes > 0 ? stats.bytesCopied / deliveredBytes : 0,
+    fallbackCopiedChunks: stats.copiedChunks,
+    receivedMB: receivedBytes / (1 << 20),
+    droppedFrames: stats.droppedFrames,
+    poolExhausted: stats.poolExhausted,
+    cpuMsPerAudioSecond: (cpu.user + cpu.system) / 1000 / duration,
+    loopDelayP99Ms: loopDelay.percentile(99) / 1e6,
+    loopDelayMaxMs: loopDelay.max / 1e6,
+    wallSeconds
+  };
+}
+
+async function main() {
+  const outputDir = fs.mkdtempSync(path.join(os.tmpdir(), 'recorder-stream-'));
+  const results = [];
+  try {
+    for (const config of CASES) {
+      const result = await runCase(config, outputDir);
+      results.push(result);
+      console.log(
+        `${result.name.padEnd(22)} 块 ${String(result.chunks).padStart(6)}  唤醒 ${String(result.wakeups).padStart(6)}` +
+        `  块/唤醒 ${result.chunksPerWakeup.toFixed(2)}  原生复制/字节 ${result.nativeCopiesPerByte.toFixed(2)}` +
+        `  回退复制 ${result.fallbackCopiedChunks}  丢帧 ${result.droppedFrames}` +
+        `  CPU ${result.cpuMsPerAudioSecond.toFixed(2)} ms/音频秒` +
+        `  事件循环延迟 p99 ${result.loopDelayP99Ms.toFixed(2)} ms, 最大 ${result.loopDelayMaxMs.toFixed(2)} ms`);
+    }
+  } finally {
+    fs.rmSync(outputDir, { recursive: true, force: true });
+  }
+
+  if (jsonPath) {
+    fs.writeFileSync(jsonPath, JSON.stringify({ duration, speed, results }, null, 2));
+  }
+}
+
+main().catch((error) => {
+  console.error(error);
+  process.exit(1);
+});
@@ -0,0 +1,118 @@
+'use strict';
+
+// 控制方法的事件循环延迟测试：start/stop/pause/resume/setOutputPath 期间事件循环不能被阻塞超过 1 ms
+// 使用无头录音实现（Linux），RECORDER_SETUP_MS 模拟 CreateTapDevice 的等待和 HAL 往返，需先 npm run build
+//
+// 用法: node test-install/control-latency.js [--limit 毫秒] [--setup 毫秒]
+
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+
+const args = process.argv.slice(2);
+function option(name, fallback) {
+  const index = args.indexOf(`--${name}`);
+  return index >= 0 && index + 1 < args.length ? args[index + 1] : fallback;
+}
+
+const limitMs = Number(option('limit', '1'));
+const setupMs = Number(option('setup', '150'));
+
+// 无头录音在构造时读取环境变量，必须在创建 Recorder 之前设置
+process.env.RECORDER_SETUP_MS = String(setupMs);
+process.env.RECORDER_SPEED = '1';
+
+const { Recorder } = require('..');
+
+const sleep = (ms) => new Promise((resolve) => setTimeout(resolve, ms));
+
+// 用 setImmediate 持续打点，两次回调之间的最大间隔就是事件循环被阻塞的最长时间
+function startTicker() {
+  const state = { running: true, last: process.hrtime.bigint(), maxGapNs: 0n, ticks: 0 };
+  const tick = () => {
+    const now = process.hrtime.bigint();
+    const gap = now - state.last;
+    if (gap > state.maxGapNs) {
+      state.maxGapNs = gap;
+    }
+    state.last = now;
+    state.ticks++;
+    if (state.running) {
+      setImmediate(tick);
+    }
+  };
+  setImmediate(tick);
+  return state;
+}
+
+// 记录一次调用在 JS 线程上的同步耗时，返回它的 Promise
+function timed(calls, name, fn) {
+  const start = process.hrtime.bigint();
+  const promise = fn();
+  calls.push({ name, ms: Number(process.hrtime.bigint() - start) / 1e6 });
+  return promise;
+}
+
+async function main() {
+  const outputDir = fs.mkdtempSync(path.join(os.tmpdir(), 'recorder-latency-'));
+  const recorder = new Recorder();
+  const calls = [];
+  const failures = [];
+
+  // 让 JIT 和首次调用的开销发生在计时之外
+  await recorder.setOutputPath(path.join(outputDir, 'warmup.wav'));
+
+  const ticker = startTicker();
+  const wallStart = process.hrtime.bigint();
+  try {
+    await timed(calls, 'setOutputPath', () => recorder.setOutputPath(path.join(outputDir, 'latency.wav')));
+    if (!(await timed(calls, 'start', () => recorder.start()))) {
+      failures.push('start() 返回 false');
+    }
+    await sleep(300);
+    await timed(calls, 'pause', () => recorder.pause());
+    await sleep(100);
+    await timed(calls, 'resume', () => recorder.resume());
+    await sleep(300);
+    await timed(calls, 'stop', () => recorder.stop());
+
+    // 不等待地连续调用，命令必须按调用顺序执行
+    const order = [];
+    const started = timed(calls, 'start', () => recorder.start()).then((ok) => order.push(ok ? 'start' : 'start-failed'));
+    const stopped = timed(calls, 'stop', () => recorder.stop()).then(() => order.push('stop'));
+    await Promise.all([started, stopped]);
+    if (order.join(',') !== 'start,stop') {
+      failures.push(`命令未按顺序完成: ${order.join(',')}`);
+    }
+    if (recorder.isRecording()) {
+      failures.push('stop() 完成后仍在录制');
+    }
+  } finally {
+    ticker.running = false;
+    fs.rmSync(outputDir, { recursive: true, force: true });
+  }
+
+  const wallMs = Number(process.hrtime.bigint() - wallStart) / 1e6;
+  const maxGapMs = Number(ticker.maxGapNs) / 1e6;
+  for (const call of calls) {
+    console.log(`${call.name.padEnd(14)} 同步耗时 ${call.ms.toFixed(3)} ms`);
+    if (call.ms > limitMs) {
+      failures.push(`${call.name}() 在 JS 线程上耗时 ${call.ms.toFixed(3)} ms`);
+    }
+  }
+  console.log(`事件循环最大间隔 ${maxGapMs.toFixed(3)} ms（${ticker.ticks} 次打点，总时长 ${wallMs.toFixed(0)} ms，设备协商 ${setupMs} ms）`);
+  if (maxGapMs > limitMs) {
+    failures.push(`事件循环被阻塞 ${maxGapMs.toFixed(3)} ms`);
+  }
+
+  if (failures.length > 0) {
+    console.error(`失败（上限 ${limitMs} ms）:\n  ${failures.join('\n  ')}`);
+    process.exit(1);
+  }
+  console.log('通过');
+}
+
+main().catch((error) => {
+  console.error(error);
+  process.exit(1);
+});
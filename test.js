@@ -9,11 +9,11 @@ async function testRecorder() {
     
     try {
         // 设置输出路径
-        recorder.setOutputPath('./test_output.wav');
+        await recorder.setOutputPath('./test_output.wav');
         
         // 开始录音
         console.log('开始录音...');
-        const success = recorder.start();
+        const success = await recorder.start();
         if (!success) {
             throw new Error('启动录音失败');
         }
@@ -26,21 +26,29 @@ async function testRecorder() {
         
         // 暂停录音
         console.log('暂停录音...');
-        recorder.pause();
+        await recorder.pause();
         
         // 等待2秒
         await new Promise(resolve => setTimeout(resolve, 2000));
         
         // 恢复录音
         console.log('恢复录音...');
-        recorder.resume();
+        await recorder.resume();
         
         // 等待3秒
         await new Promise(resolve => setTimeout(resolve, 3000));
         
+        // 管线指标：回调耗时/抖动、缓冲水位、丢弃量
+        const stats = recorder.getStats({ log: true });
+        console.log('麦克风回调耗时 p99 (ns):', stats['callback.microphone_ns'] && stats['callback.microphone_ns'].p99);
+
+        // 两路电平（约 33ms 一个窗口），只读原子量，UI 可以按 30Hz 轮询
+        const levels = recorder.getLevels();
+        console.log('麦克风峰值 (dBFS):', levels.microphone.peakDb.toFixed(1), '累计削波样本:', levels.microphone.totalClipped);
+
         // 停止录音
         console.log('停止录音...');
-        recorder.stop();
+        await recorder.stop();
         
         // 检查录音状态
         console.log('录音状态:', recorder.isRecording() ? '正在录音' : '已停止');
@@ -0,0 +1,220 @@
+// AudioKernels 单元测试
+// - 每个可用的 SIMD 实现与标量参考逐位一致，包括 *WithLevels 的电平统计
+// - 长度覆盖 0~40、257、4099 以及 1~8 声道，输入混入 NaN、无穷、±0 和 .5 LSB 等边界值
+// 任一检查失败时返回非 0
+
+#include "audio_kernels.h"
+#include "logger.h"
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+using AudioKernels::Isa;
+
+int failures = 0;
+
+#define CHECK(cond)                                                          \
+    do {                                                                     \
+        if (!(cond)) {                                                       \
+            fprintf(stderr, "%s:%d: 检查失败: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures;                                                      \
+        }                                                                    \
+    } while (0)
+
+// 随机样本里混入边界值：超出 [-1, 1]、正好落在 .5 LSB 上、±0、NaN、无穷
+std::vector<float> MakeInput(size_t samples, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-1.2f, 1.2f);
+    const float specials[] = {
+        0.0f, -0.0f, 1.0f, -1.0f, 1.5f, -1.5f, 0.5f / 32767.0f, -0.5f / 32767.0f,
+        1.5f / 32767.0f, 2.5f / 8388607.0f, std::numeric_limits<float>::quiet_NaN(),
+        std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity()
+    };
+    std::vector<float> data(samples);
+    for (size_t i = 0; i < samples; ++i) {
+        data[i] = (i % 7 == 3) ? specials[(i / 7) % (sizeof(specials) / sizeof(specials[0]))] : dist(rng);
+    }
+    return data;
+}
+
+template <typename T>
+bool SameBits(const std::vector<T>& a, const std::vector<T>& b) {
+    return a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+}
+
+// 把电平统计按位追加到输出后面，一起参与比较
+void AppendLevels(const AudioKernels::LevelStats& levels, std::vector<float>* out) {
+    const float fields[] = {levels.peak, levels.sumSquares, levels.sum};
+    out->insert(out->end(), fields, fields + 3);
+    float bits[2];
+    const uint32_t counts[2] = {levels.clipped, static_cast<uint32_t>(levels.samples)};
+    memcpy(bits, counts, sizeof(bits));
+    out->insert(out->end(), bits, bits + 2);
+}
+
+// 用当前实现和标量实现各跑一次，比较输出
+template <typename T>
+bool CheckKernel(Isa isa, const char* name, size_t length,
+                 const std::function<std::vector<T>()>& run) {
+    AudioKernels::SetIsa(Isa::Scalar);
+    const std::vector<T> expected = run();
+    AudioKernels::SetIsa(isa);
+    const std::vector<T> actual = run();
+    if (!SameBits(expected, actual)) {
+        fprintf(stderr, "不一致: %s %s (长度 %zu)\n", AudioKernels::IsaName(isa), name, length);
+        return false;
+    }
+    return true;
+}
+
+bool VerifyIsa(Isa isa) {
+    bool ok = true;
+    std::vector<size_t> lengths;
+    for (size_t n = 0; n <= 40; ++n) {
+        lengths.push_back(n);
+    }
+    lengths.push_back(257);
+    lengths.push_back(4099);
+
+    for (size_t frames : lengths) {
+        for (size_t channels = 1; channels <= 8; ++channels) {
+            const std::vector<float> input = MakeInput(frames * channels, static_cast<uint32_t>(frames * 31 + channels));
+            ok &= CheckKernel<float>(isa, "Interleave", frames, [&] {
+                std::vector<const float*> planes(channels);
+                for (size_t ch = 0; ch < channels; ++ch) {
+                    planes[ch] = input.data() + ch * frames;
+                }
+                std::vector<float> out(frames * channels);
+                AudioKernels::Interleave(planes.data(), out.data(), channels, frames);
+                return out;
+            });
+            ok &= CheckKernel<float>(isa, "InterleaveWithLevels", frames, [&] {
+                std::vector<const float*> planes(channels);
+                for (size_t ch = 0; ch < channels; ++ch) {
+                    planes[ch] = input.data() + ch * frames;
+                }
+                std::vector<float> out(frames * channels);
+                AudioKernels::LevelStats levels;
+                AudioKernels::InterleaveWithLevels(planes.data(), out.data(), channels, frames, &levels);
+                AppendLevels(levels, &out);
+                return out;
+            });
+            ok &= CheckKernel<float>(isa, "Deinterleave", frames, [&] {
+                std::vector<float> out(frames * channels);
+                std::vector<float*> planes(channels);
+                for (size_t ch = 0; ch < channels; ++ch) {
+                    planes[ch] = out.data() + ch * frames;
+                }
+                AudioKernels::Deinterleave(input.data(), planes.data(), channels, frames);
+                return out;
+            });
+        }
+
+        const std::vector<float> input = MakeInput(frames * 2, static_cast<uint32_t>(frames));
+        for (int dithered = 0; dithered < 2; ++dithered) {
+            ok &= CheckKernel<int16_t>(isa, dithered ? "FloatToInt16+dither" : "FloatToInt16", frames, [&] {
+                AudioKernels::DitherState dither;
+                std::vector<int16_t> out(input.size());
+                AudioKernels::FloatToInt16(input.data(), out.data(), input.size(), dithered ? &dither : nullptr);
+                return out;
+            });
+            ok &= CheckKernel<uint8_t>(isa, dithered ? "FloatToInt24+dither" : "FloatToInt24", frames, [&] {
+                AudioKernels::DitherState dither;
+                std::vector<uint8_t> out(input.size() * 3);
+                AudioKernels::FloatToInt24(input.data(), out.data(), input.size(), dithered ? &dither : nullptr);
+                return out;
+            });
+        }
+        ok &= CheckKernel<float>(isa, "Int16ToFloat", frames, [&] {
+            std::vector<int16_t> pcm(input.size());
+            for (size_t i = 0; i < pcm.size(); ++i) {
+                pcm[i] = static_cast<int16_t>(i * 2654435761u >> 16);
+            }
+            std::vector<float> out(pcm.size());
+            AudioKernels::Int16ToFloat(pcm.data(), out.data(), pcm.size());
+            return out;
+        });
+        ok &= CheckKernel<float>(isa, "Int16ToFloatWithLevels", frames, [&] {
+            std::vector<int16_t> pcm(input.size());
+            for (size_t i = 0; i < pcm.size(); ++i) {
+                pcm[i] = static_cast<int16_t>(i * 2654435761u >> 16);
+            }
+            // 混入满幅样本，覆盖削波计数
+            for (size_t i = 5; i < pcm.size(); i += 11) {
+                pcm[i] = (i & 1) ? -32768 : 32767;
+            }
+            std::vector<float> out(pcm.size());
+            AudioKernels::LevelStats levels;
+            AudioKernels::Int16ToFloatWithLevels(pcm.data(), out.data(), pcm.size(), &levels);
+            AppendLevels(levels, &out);
+            return out;
+        });
+        ok &= CheckKernel<float>(isa, "CopyWithLevels", frames, [&] {
+            std::vector<float> out(input.size());
+            AudioKernels::LevelStats levels;
+            AudioKernels::CopyWithLevels(input.data(), out.data(), input.size(), &levels);
+            AppendLevels(levels, &out);
+            return out;
+        });
+        ok &= CheckKernel<float>(isa, "MeasureLevels", frames, [&] {
+            std::vector<float> out;
+            AudioKernels::LevelStats levels;
+            AudioKernels::MeasureLevels(input.data(), input.size(), &levels);
+            AppendLevels(levels, &out);
+            return out;
+        });
+        ok &= CheckKernel<float>(isa, "ApplyGain", frames, [&] {
+            std::vector<float> out(input.size());
+            AudioKernels::ApplyGain(input.data(), out.data(), input.size(), 0.7071f);
+            return out;
+        });
+        ok &= CheckKernel<float>(isa, "StereoToMono", frames, [&] {
+            std::vector<float> out(frames);
+            AudioKernels::StereoToMono(input.data(), out.data(), frames);
+            return out;
+        });
+        ok &= CheckKernel<float>(isa, "MixAdd", frames, [&] {
+            std::vector<float> out(input.rbegin(), input.rend());
+            AudioKernels::MixAdd(input.data(), out.data(), input.size(), 0.25f, 0.5f / 4096.0f);
+            return out;
+        });
+        ok &= CheckKernel<float>(isa, "MonoToStereo", frames, [&] {
+            std::vector<float> out(frames * 2);
+            AudioKernels::MonoToStereo(input.data(), out.data(), frames);
+            return out;
+        });
+    }
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    Logger::init();
+    Logger::setLevel(Logger::Level::WARN);
+
+    CHECK(AudioKernels::SetIsa(Isa::Scalar));
+    for (Isa isa : {Isa::SSE2, Isa::AVX2, Isa::NEON}) {
+        if (!AudioKernels::SetIsa(isa)) {
+            printf("跳过 %s: 当前 CPU 不支持\n", AudioKernels::IsaName(isa));
+            continue;
+        }
+        const bool exact = VerifyIsa(isa);
+        printf("%-6s 与标量实现逐位一致: %s\n", AudioKernels::IsaName(isa), exact ? "是" : "否");
+        CHECK(exact);
+    }
+    AudioKernels::SetIsa(AudioKernels::DetectedIsa());
+
+    Logger::shutdown();
+    if (failures > 0) {
+        fprintf(stderr, "%d 项检查失败\n", failures);
+        return 1;
+    }
+    printf("通过\n");
+    return 0;
+}
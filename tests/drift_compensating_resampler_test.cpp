@@ -0,0 +1,157 @@
+// DriftCompensatingResampler 单元测试
+// - 生产者按比名义值快/慢 500 ppm 的实际采样率送入正交的 100Hz 正弦（左 sin、右 cos），
+//   消费者按会话时钟拉取 10ms 块
+// - 从输出波形本身解出相位，换算成输出相对输入的延迟，与第一帧的延迟比较得到对齐误差；
+//   不依赖重采样器自己报告的 consumedFrames
+// - 全程误差小于一个 10ms 块；最后 kLockedSeconds 内误差不超过 kMaxFinalErrorFrames，且几乎不再变化
+//   （未补偿时每秒累计 24 帧），期间没有欠载和溢出丢弃
+// 任一检查失败时返回非 0
+
+#include "drift_compensating_resampler.h"
+#include "logger.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+constexpr size_t kProducerBlockFrames = 512;   // 系统音频 IOProc 每次回调的帧数
+constexpr size_t kChannels = 2;
+constexpr double kToneHz = 100.0;
+constexpr double kSeconds = 180.0;            // PI 控制器约 2 分钟收敛
+constexpr double kLockedSeconds = 20.0;
+constexpr double kMaxFinalErrorFrames = 48.0;     // 1ms，本机实测约 26 帧
+constexpr double kMaxLockedSpreadFrames = 4.0;
+
+int failures = 0;
+
+#define CHECK(cond)                                                          \
+    do {                                                                     \
+        if (!(cond)) {                                                       \
+            fprintf(stderr, "%s:%d: 检查失败: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures;                                                      \
+        }                                                                    \
+    } while (0)
+
+struct Result {
+    double maxErrorFrames;      // 全程最大对齐误差（输出帧）
+    double lockedMin;           // 最后 kLockedSeconds 内带符号误差的范围
+    double lockedMax;
+    uint64_t underruns;
+    size_t droppedSamples;
+};
+
+Result Run(int nominalInputRate, double driftPpm, int outputRate) {
+    const double actualInputRate = nominalInputRate * (1.0 + driftPpm * 1e-6);
+    DriftCompensatingResampler resampler;
+    DriftCompensatingResampler::Options options;
+    options.inputRate = nominalInputRate;
+    options.outputRate = outputRate;
+    options.channels = kChannels;
+    CHECK(resampler.Initialize(options));
+
+    const size_t pullFrames = static_cast<size_t>(outputRate / 100);
+    const double phaseStep = 2.0 * M_PI * kToneHz / actualInputRate;
+    std::vector<float> input(kProducerBlockFrames * kChannels);
+    std::vector<float> output(pullFrames * kChannels);
+
+    uint64_t produced = 0;
+    uint64_t pulled = 0;
+    bool tracking = false;
+    double unwrapped = 0.0;     // 输出波形的累计相位（弧度）
+    double lastPhase = 0.0;
+    double baseDelay = 0.0;
+    Result result{};
+    result.lockedMin = HUGE_VAL;
+    result.lockedMax = -HUGE_VAL;
+
+    const uint64_t totalPulls = static_cast<uint64_t>(kSeconds * 100);
+    for (uint64_t k = 0; k < totalPulls; ++k) {
+        const double now = static_cast<double>(pulled + pullFrames) / outputRate;
+        while (static_cast<double>(produced + kProducerBlockFrames) / actualInputRate <= now) {
+            for (size_t i = 0; i < kProducerBlockFrames; ++i) {
+                const double phase = phaseStep * static_cast<double>(produced + i);
+                input[i * kChannels] = 0.5f * static_cast<float>(std::sin(phase));
+                input[i * kChannels + 1] = 0.5f * static_cast<float>(std::cos(phase));
+            }
+            resampler.Push(input.data(), kProducerBlockFrames);
+            produced += kProducerBlockFrames;
+        }
+        resampler.Pull(output.data(), pullFrames);
+
+        for (size_t i = 0; i < pullFrames; ++i) {
+            const double s = output[i * kChannels];
+            const double c = output[i * kChannels + 1];
+            const uint64_t frame = pulled + i;
+            // 启动阶段输出静音，等到出现完整幅度的正弦再开始跟踪
+            if (!tracking && s * s + c * c < 0.2) {
+                continue;
+            }
+            const double phase = std::atan2(s, c);
+            if (tracking) {
+                double delta = phase - lastPhase;
+                delta -= 2.0 * M_PI * std::round(delta / (2.0 * M_PI));
+                unwrapped += delta;
+            } else {
+                unwrapped = phase;
+            }
+            lastPhase = phase;
+
+            // 输出第 frame 帧在 frame / outputRate 时刻播放，内容是输入在 unwrapped / (2π·f) 时刻的采样
+            const double delay = static_cast<double>(frame) / outputRate - unwrapped / (2.0 * M_PI * kToneHz);
+            if (!tracking) {
+                baseDelay = delay;
+                tracking = true;
+                continue;
+            }
+            const double errorFrames = (delay - baseDelay) * outputRate;
+            result.maxErrorFrames = std::max(result.maxErrorFrames, std::fabs(errorFrames));
+            if (static_cast<double>(frame) / outputRate > kSeconds - kLockedSeconds) {
+                result.lockedMin = std::min(result.lockedMin, errorFrames);
+                result.lockedMax = std::max(result.lockedMax, errorFrames);
+            }
+        }
+        pulled += pullFrames;
+    }
+    CHECK(tracking);
+
+    const DriftCompensatingResampler::Stats stats = resampler.GetStats();
+    result.underruns = stats.underruns;
+    result.droppedSamples = stats.droppedSamples;
+    return result;
+}
+
+void Check(int nominalInputRate, double driftPpm, int outputRate) {
+    const Result result = Run(nominalInputRate, driftPpm, outputRate);
+    // 固定比例时 kSeconds 内累计的偏移，作为误差上限的参照
+    const double uncompensated = std::fabs(driftPpm) * 1e-6 * kSeconds * outputRate;
+    const double finalError = std::max(std::fabs(result.lockedMin), std::fabs(result.lockedMax));
+    printf("%d %+.0f ppm -> %d: 最大误差 %.1f 帧, 最后 %.0f 秒 %.1f ~ %.1f 帧（未补偿 %.0f 帧）\n", nominalInputRate,
+           driftPpm, outputRate, result.maxErrorFrames, kLockedSeconds, result.lockedMin, result.lockedMax,
+           uncompensated);
+    CHECK(result.maxErrorFrames < outputRate / 100.0);
+    CHECK(finalError < kMaxFinalErrorFrames);
+    CHECK(result.lockedMax - result.lockedMin < kMaxLockedSpreadFrames);
+    CHECK(result.underruns == 0);
+    CHECK(result.droppedSamples == 0);
+}
+
+} // namespace
+
+int main() {
+    Logger::init();
+    Logger::setLevel(Logger::Level::WARN);
+
+    Check(48000, 500.0, 48000);
+    Check(48000, -500.0, 48000);
+    Check(44100, 500.0, 48000);
+
+    Logger::shutdown();
+    if (failures > 0) {
+        fprintf(stderr, "%d 项检查失败\n", failures);
+        return 1;
+    }
+    printf("通过\n");
+    return 0;
+}
@@ -0,0 +1,132 @@
+// EchoCancellationStage 单元测试
+// - 合成的远端信号经稀疏房间冲激响应得到近端回声，收敛后（后半段）实测 ERLE 不低于 kMinErleDb
+// - 远端静音时近端语音不被消除：输出能量与输入相差不超过 kMaxNearEndLossDb
+// 任一检查失败时返回非 0
+
+#include "echo_cancellation_stage.h"
+#include "logger.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr int kSampleRate = 48000;
+constexpr double kSeconds = 10.0;
+constexpr size_t kBlockFrames = 512;   // CoreAudio 常见的回调块大小
+constexpr double kMinErleDb = 20.0;    // 本机实测约 38 dB，留出余量
+constexpr double kMaxNearEndLossDb = 3.0;
+
+int failures = 0;
+
+#define CHECK(cond)                                                          \
+    do {                                                                     \
+        if (!(cond)) {                                                       \
+            fprintf(stderr, "%s:%d: 检查失败: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures;                                                      \
+        }                                                                    \
+    } while (0)
+
+// 类似语音的信号：带间歇、按音节调制的有色噪声
+std::vector<float> Speech(size_t frames, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    std::vector<float> out(frames);
+    float lowpass = 0.0f;
+    for (size_t i = 0; i < frames; ++i) {
+        const double t = static_cast<double>(i) / kSampleRate;
+        const double syllable = 0.5 + 0.5 * std::sin(2.0 * M_PI * 4.0 * t);
+        const bool talking = std::fmod(t, 3.0) < 2.2;
+        lowpass = 0.85f * lowpass + 0.15f * noise(rng);
+        out[i] = talking ? static_cast<float>(0.3 * syllable) * lowpass : 0.0f;
+    }
+    return out;
+}
+
+// 40ms 直达延迟 + 60ms 内随机衰减的反射，叠加微弱底噪
+std::vector<float> Echo(const std::vector<float>& far) {
+    std::mt19937 rng(99);
+    std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    std::vector<std::pair<size_t, float>> taps;
+    const size_t direct = static_cast<size_t>(kSampleRate * 0.040);
+    taps.emplace_back(direct, 0.5f);
+    for (int k = 0; k < 30; ++k) {
+        const size_t offset = static_cast<size_t>((uniform(rng) * 0.5f + 0.5f) * kSampleRate * 0.060);
+        const float decay = std::exp(-static_cast<float>(offset) / (kSampleRate * 0.02f));
+        taps.emplace_back(direct + offset, 0.2f * decay * uniform(rng));
+    }
+    std::vector<float> near(far.size());
+    for (size_t i = 0; i < far.size(); ++i) {
+        float echo = 0.0f;
+        for (const auto& tap : taps) {
+            if (i >= tap.first) {
+                echo += tap.second * far[i - tap.first];
+            }
+        }
+        near[i] = echo + 0.0005f * noise(rng);
+    }
+    return near;
+}
+
+double Energy(const std::vector<float>& samples, size_t begin, size_t end) {
+    double sum = 0.0;
+    for (size_t i = begin; i < end; ++i) {
+        sum += static_cast<double>(samples[i]) * samples[i];
+    }
+    return sum;
+}
+
+// 单声道远端/近端按块交替送入，返回后半段输出相对输入的能量比（dB，正值为衰减）
+double Attenuation(const std::vector<float>& far, const std::vector<float>& near) {
+    EchoCancellationStage stage;
+    EchoCancellationStage::Options options;
+    options.sampleRate = kSampleRate;
+    options.renderChannels = 1;
+    options.captureChannels = 1;
+    CHECK(stage.Initialize(options));
+
+    std::vector<float> capture = near;
+    for (size_t offset = 0; offset < capture.size(); offset += kBlockFrames) {
+        const size_t count = std::min(kBlockFrames, capture.size() - offset);
+        stage.AnalyzeRender(far.data() + offset, count);
+        float* channel = capture.data() + offset;
+        stage.ProcessCapture(&channel, count);
+    }
+    CHECK(stage.GetStats().captureFrames == capture.size() / (kSampleRate / 100));
+
+    // 跳过前一半的收敛期，输出相对输入延迟 LatencyFrames() 帧
+    const size_t latency = stage.LatencyFrames();
+    const size_t begin = capture.size() / 2;
+    const double in = Energy(near, begin - latency, capture.size() - latency);
+    const double out = Energy(capture, begin, capture.size());
+    return 10.0 * std::log10((in + 1e-12) / (out + 1e-12));
+}
+
+} // namespace
+
+int main() {
+    Logger::init();
+    Logger::setLevel(Logger::Level::WARN);
+    const size_t frames = static_cast<size_t>(kSampleRate * kSeconds);
+
+    const std::vector<float> far = Speech(frames, 1234);
+    const double erle = Attenuation(far, Echo(far));
+    printf("回声路径 ERLE: %.1f dB（下限 %.1f dB）\n", erle, kMinErleDb);
+    CHECK(erle >= kMinErleDb);
+
+    const double nearLoss = Attenuation(std::vector<float>(frames, 0.0f), Speech(frames, 5678));
+    printf("远端静音时近端衰减: %.1f dB（上限 %.1f dB）\n", nearLoss, kMaxNearEndLossDb);
+    CHECK(std::fabs(nearLoss) <= kMaxNearEndLossDb);
+
+    Logger::shutdown();
+    if (failures > 0) {
+        fprintf(stderr, "%d 项检查失败\n", failures);
+        return 1;
+    }
+    printf("通过\n");
+    return 0;
+}
@@ -0,0 +1,202 @@
+// StreamingWavWriter 单元测试
+// - 写入后用 WavFileReader 读回，float32 / int16 的格式、帧数和样本逐一比较
+// - BuildHeader 在 4GB 边界两侧分别生成 RIFF / RF64 头，写进稀疏文件后读回帧数
+// - 同一个写入器关闭后换格式重新打开；另有生产者线程在关闭、重新打开期间持续调用 Write()
+// 任一检查失败时返回非 0
+
+#include "logger.h"
+#include "streaming_wav_writer.h"
+#include "wav_file_reader.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(cond)                                                          \
+    do {                                                                     \
+        if (!(cond)) {                                                       \
+            fprintf(stderr, "%s:%d: 检查失败: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures;                                                      \
+        }                                                                    \
+    } while (0)
+
+uint32_t ReadU32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// int16 可以精确表示的样本值，按帧和声道区分
+std::vector<float> MakeSamples(size_t frames, size_t channels) {
+    std::vector<float> samples(frames * channels);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        samples[i] = static_cast<float>(static_cast<int>(i % 2001) - 1000) / 32768.0f;
+    }
+    return samples;
+}
+
+bool WriteFile(StreamingWavWriter& writer, const std::string& path, const StreamingWavWriter::Options& options,
+               const std::vector<float>& samples) {
+    if (!writer.Open(path, options)) {
+        return false;
+    }
+    // 分多次写入，总量远小于队列容量
+    const size_t frames = samples.size() / options.channels;
+    for (size_t offset = 0; offset < frames; offset += 480) {
+        const size_t n = std::min<size_t>(480, frames - offset);
+        if (!writer.Write(samples.data() + offset * options.channels, n)) {
+            return false;
+        }
+    }
+    writer.Close();
+    return true;
+}
+
+void CheckFile(const std::string& path, const StreamingWavWriter::Options& options,
+               const std::vector<float>& samples) {
+    WavFileReader reader;
+    CHECK(reader.Open(path));
+    if (!reader.IsOpen()) {
+        return;
+    }
+    const size_t frames = samples.size() / options.channels;
+    CHECK(reader.SampleRate() == static_cast<int>(options.sampleRate));
+    CHECK(reader.Channels() == options.channels);
+    CHECK(reader.Frames() == frames);
+    std::vector<float> read(samples.size());
+    CHECK(reader.Read(0, read.data(), frames) == frames);
+    CHECK(memcmp(read.data(), samples.data(), samples.size() * sizeof(float)) == 0);
+    // 文件长度是头部加数据，没有残留的预分配空间
+    const size_t bytesPerSample = options.format == StreamingWavWriter::SampleFormat::Float32 ? 4 : 2;
+    CHECK(std::filesystem::file_size(path) == StreamingWavWriter::kHeaderSize + samples.size() * bytesPerSample);
+}
+
+void TestRoundTrip(const std::filesystem::path& dir) {
+    StreamingWavWriter::Options options;
+    options.sampleRate = 48000;
+    options.channels = 2;
+    const std::vector<float> samples = MakeSamples(48000, options.channels);
+
+    StreamingWavWriter floatWriter;
+    options.format = StreamingWavWriter::SampleFormat::Float32;
+    CHECK(WriteFile(floatWriter, (dir / "float.wav").string(), options, samples));
+    CHECK(floatWriter.FramesWritten() == 48000);
+    CheckFile((dir / "float.wav").string(), options, samples);
+
+    StreamingWavWriter int16Writer;
+    options.format = StreamingWavWriter::SampleFormat::Int16;
+    CHECK(WriteFile(int16Writer, (dir / "int16.wav").string(), options, samples));
+    CheckFile((dir / "int16.wav").string(), options, samples);
+}
+
+// 单声道 int16 的头部写进稀疏文件，读回 RIFF 标记、长度和帧数
+void CheckLargeHeader(const std::string& path, uint64_t dataBytes, bool rf64) {
+    uint8_t header[StreamingWavWriter::kHeaderSize];
+    StreamingWavWriter::BuildHeader(header, 48000, 1, false, dataBytes);
+    CHECK(memcmp(header, rf64 ? "RF64" : "RIFF", 4) == 0);
+    CHECK(memcmp(header + 12, rf64 ? "ds64" : "JUNK", 4) == 0);
+    if (!rf64) {
+        CHECK(ReadU32(header + 4) == StreamingWavWriter::kHeaderSize - 8 + dataBytes);
+    }
+
+    const int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    const bool written = fd >= 0 && pwrite(fd, header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+                         ftruncate(fd, static_cast<off_t>(StreamingWavWriter::kHeaderSize + dataBytes)) == 0;
+    if (fd >= 0) {
+        close(fd);
+    }
+    if (!written) {
+        printf("跳过 %s: 文件系统不支持 4GB 的稀疏文件\n", path.c_str());
+        return;
+    }
+    WavFileReader reader;
+    CHECK(reader.Open(path));
+    CHECK(reader.Frames() == dataBytes / 2);
+    std::filesystem::remove(path);
+}
+
+void TestHeaderBoundary(const std::filesystem::path& dir) {
+    // RIFF 长度恰好是 32 位能表示的最大偶数，再多一帧就要切换到 RF64
+    const uint64_t limit = 0xFFFFFFFFull - (StreamingWavWriter::kHeaderSize - 8) - 1;
+    CheckLargeHeader((dir / "riff.wav").string(), limit, false);
+    CheckLargeHeader((dir / "rf64.wav").string(), limit + 2, true);
+
+    // 不足一帧的尾部不计入
+    uint8_t header[StreamingWavWriter::kHeaderSize];
+    StreamingWavWriter::BuildHeader(header, 48000, 2, true, 8 * 100 + 5);
+    CHECK(ReadU32(header + StreamingWavWriter::kHeaderSize - 4) == 800);
+}
+
+void TestReopen(const std::filesystem::path& dir) {
+    StreamingWavWriter writer;
+    StreamingWavWriter::Options stereo;
+    stereo.sampleRate = 48000;
+    stereo.channels = 2;
+    const std::vector<float> first = MakeSamples(4800, 2);
+    CHECK(WriteFile(writer, (dir / "first.wav").string(), stereo, first));
+
+    StreamingWavWriter::Options mono;
+    mono.sampleRate = 16000;
+    mono.channels = 1;
+    mono.format = StreamingWavWriter::SampleFormat::Int16;
+    const std::vector<float> second = MakeSamples(1600, 1);
+    CHECK(WriteFile(writer, (dir / "second.wav").string(), mono, second));
+
+    CheckFile((dir / "first.wav").string(), stereo, first);
+    CheckFile((dir / "second.wav").string(), mono, second);
+
+    // 生产者不停写入，主线程反复在单声道和 8 声道之间关闭、重新打开；
+    // Write() 不能用到已经释放的队列，也不能按旧的声道数写进新的队列
+    std::atomic<bool> running(true);
+    const std::vector<float> block = MakeSamples(480, 8);
+    std::thread producer([&] {
+        while (running.load(std::memory_order_relaxed)) {
+            writer.Write(block.data(), 480);
+            writer.QueuedFrames();
+        }
+    });
+    StreamingWavWriter::Options options;
+    options.queueMilliseconds = 50;
+    options.preallocateBytes = 0;
+    for (int i = 0; i < 200; ++i) {
+        options.channels = i % 2 == 0 ? 1 : 8;
+        CHECK(writer.Open((dir / "cycle.wav").string(), options));
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        writer.Close();
+    }
+    running.store(false, std::memory_order_relaxed);
+    producer.join();
+    CHECK(!writer.Write(block.data(), 480));
+    CHECK(writer.QueuedFrames() == 0);
+}
+
+} // namespace
+
+int main() {
+    Logger::init();
+    Logger::setLevel(Logger::Level::WARN);
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "streaming_wav_writer_test";
+    std::filesystem::create_directories(dir);
+
+    TestRoundTrip(dir);
+    TestHeaderBoundary(dir);
+    TestReopen(dir);
+
+    std::filesystem::remove_all(dir);
+    Logger::shutdown();
+    if (failures > 0) {
+        fprintf(stderr, "%d 项检查失败\n", failures);
+        return 1;
+    }
+    printf("通过\n");
+    return 0;
+}